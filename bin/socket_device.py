@@ -25,6 +25,9 @@ TYPE_CAN_DEVICE_RESPONSE               =  8
 TYPE_I2C_DEVICE_REQUEST                =  9
 TYPE_I2C_DEVICE_RESPONSE               = 10
 
+# Request type flag selecting binary framing of the device data.
+TYPE_BINARY                            = 0x100
+
 
 # Maps device type strings to request types.
 REQUEST_TYPE_FROM_STRING = {
@@ -55,9 +58,15 @@ class DeviceAlreadyInUseError(Exception):
 
 class SocketDevice(object):
 
-    def __init__(self, device_type, device_name, address=None, port=None):
+    def __init__(self,
+                 device_type,
+                 device_name,
+                 address=None,
+                 port=None,
+                 binary=False):
         self.device_type = device_type
         self.device_name = device_name
+        self.binary = binary
 
         if address is None:
             address = 'localhost'
@@ -112,6 +121,10 @@ class SocketDevice(object):
                   end='')
 
             request_type = REQUEST_TYPE_FROM_STRING[self.device_type]
+
+            if self.binary:
+                request_type |= TYPE_BINARY
+
             request = struct.pack('>II', request_type, len(self.device_name))
             request += self.device_name.encode('utf-8')
 
@@ -178,6 +191,25 @@ class SocketDevice(object):
 
         return buf
 
+    def write_frame(self, payload):
+        """Write given payload as a binary frame.
+
+        """
+
+        self.write(struct.pack('>H', len(payload)) + payload)
+
+    def read_frame(self):
+        """Read the payload of a binary frame.
+
+        """
+
+        header = self.read(2)
+
+        if len(header) != 2:
+            return b''
+
+        return self.read(struct.unpack('>H', header)[0])
+
     def readline(self):
         """Read a line.
 
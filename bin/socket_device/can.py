@@ -3,9 +3,8 @@
 # A stub of python-can.
 #
 
-import binascii
+import struct
 from socket_device import SocketDevice
-import re
 
 
 rc = {}
@@ -34,7 +33,7 @@ class interface(object):
         def __init__(self, device, *args, **kwargs):
             del args
             del kwargs
-            self.device = SocketDevice('can', device)
+            self.device = SocketDevice('can', device, binary=True)
             self.device.start()
 
         def send(self, message):
@@ -42,30 +41,22 @@ class interface(object):
 
             """
 
-            line = "id={:08x},extended={},size={},data=".format(
-                message.arbitration_id,
-                1 if message.extended_id else 0,
-                len(message.data))
-            line = line.encode('ascii')
-            line += binascii.hexlify(bytes(message.data))
-            line += b"\r\n"
+            payload = struct.pack('>IBB',
+                                  message.arbitration_id,
+                                  1 if message.extended_id else 0,
+                                  len(message.data))
+            payload += bytes(message.data)
 
-            self.device.write(line)
+            self.device.write_frame(payload)
 
         def recv(self):
             """Read a message from the application.
 
             """
 
-            line = self.device.readline()
-
-            line = line.strip(b'\r\n')
-            mo = re.match(rb'id=(\w{8}),extended=(\d),size=(\d),data=(\w+)',
-                          line)
-
-            arbitration_id = int(mo.group(1), 16)
-            extended_id = (mo.group(2) == b'1')
-            length = int(mo.group(3))
-            data = bytearray(binascii.unhexlify(mo.group(4)[0:2*length]))
+            payload = self.device.read_frame()
+            arbitration_id, flags, length = struct.unpack('>IBB', payload[:6])
+            extended_id = ((flags & 1) == 1)
+            data = bytearray(payload[6:6 + length])
 
             return Message(arbitration_id, extended_id, data)
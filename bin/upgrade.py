@@ -1,6 +1,8 @@
 #!/usr/bin/env python
 #
-# Append the upgrade binary header to given binart file.
+# Append the upgrade binary header to given binart file, optionally
+# compressing the data and/or encoding it as a delta against the
+# currently installed application.
 #
 
 import argparse
@@ -9,7 +11,219 @@ import struct
 import zlib
 
 
-def create_header(binary, description):
+ENCODING_RAW = 0x00
+ENCODING_LZ = 0x01
+ENCODING_DELTA = 0x02
+
+ENCODINGS = {
+    'raw': ENCODING_RAW,
+    'lz': ENCODING_LZ,
+    'delta': ENCODING_DELTA,
+    'delta-lz': ENCODING_DELTA | ENCODING_LZ
+}
+
+DELTA_OP_COPY = 0
+DELTA_OP_ADD = 1
+DELTA_OP_INSERT = 2
+DELTA_OP_SEEK = 3
+
+LZ_MIN_MATCH = 3
+LZ_MAX_CANDIDATES = 64
+
+DELTA_BLOCK_SIZE = 8
+
+
+def lz_encode(data, window_bits):
+    """LZSS encode given data. Each group of eight tokens is preceeded by
+    a flags byte, least significant bit first. A set bit is a literal
+    byte and a cleared bit is a big endian 16 bits match, with the
+    distance minus one in the upper `window_bits` bits and the length
+    minus three in the remaining bits.
+
+    """
+
+    length_bits = 16 - window_bits
+    window_size = (1 << window_bits)
+    max_length = (1 << length_bits) - 1 + LZ_MIN_MATCH
+    candidates = {}
+    encoded = bytearray()
+    tokens = bytearray()
+    flags = 0
+    number_of_tokens = 0
+    i = 0
+
+    def insert(position):
+        key = bytes(data[position:position + LZ_MIN_MATCH])
+        positions = candidates.setdefault(key, [])
+        positions.append(position)
+
+        if len(positions) > LZ_MAX_CANDIDATES:
+            del positions[0]
+
+    while i < len(data):
+        best_length = 0
+        best_distance = 0
+        key = bytes(data[i:i + LZ_MIN_MATCH])
+
+        for position in reversed(candidates.get(key, [])):
+            distance = i - position
+
+            if distance > window_size:
+                break
+
+            length = 0
+            limit = min(max_length, len(data) - i)
+
+            while (length < limit
+                   and data[position + length] == data[i + length]):
+                length += 1
+
+            if length > best_length:
+                best_length = length
+                best_distance = distance
+
+                if length == limit:
+                    break
+
+        if best_length >= LZ_MIN_MATCH:
+            value = (((best_distance - 1) << length_bits)
+                     | (best_length - LZ_MIN_MATCH))
+            tokens += struct.pack('>H', value)
+            length = best_length
+        else:
+            flags |= (1 << number_of_tokens)
+            tokens.append(data[i])
+            length = 1
+
+        for position in range(i, i + length):
+            insert(position)
+
+        i += length
+        number_of_tokens += 1
+
+        if number_of_tokens == 8:
+            encoded.append(flags)
+            encoded += tokens
+            flags = 0
+            number_of_tokens = 0
+            tokens = bytearray()
+
+    if number_of_tokens > 0:
+        encoded.append(flags)
+        encoded += tokens
+
+    return encoded
+
+
+def varint(value):
+    encoded = bytearray()
+
+    while value >= 0x80:
+        encoded.append((value & 0x7f) | 0x80)
+        value >>= 7
+
+    encoded.append(value)
+
+    return encoded
+
+
+def delta_encode(data, base):
+    """Encode given data as a sequence of operations on the base image:
+    copy from the base, add to the base, insert literal bytes and seek
+    in the base. Each operation is an operation byte followed by a
+    varint argument. Add and insert are followed by their data.
+
+    """
+
+    index = {}
+
+    for position in range(len(base) - DELTA_BLOCK_SIZE + 1):
+        index.setdefault(bytes(base[position:position + DELTA_BLOCK_SIZE]),
+                         position)
+
+    encoded = bytearray()
+    pending_op = None
+    pending = bytearray()
+    state = {'offset': 0}
+
+    def flush():
+        if pending:
+            encoded.append(pending_op)
+            encoded.extend(varint(len(pending)))
+            encoded.extend(pending)
+            del pending[:]
+
+    def seek(position):
+        distance = position - state['offset']
+
+        if distance != 0:
+            encoded.append(DELTA_OP_SEEK)
+
+            # Zigzag encode the signed distance.
+            if distance >= 0:
+                encoded.extend(varint(distance << 1))
+            else:
+                encoded.extend(varint((-distance << 1) - 1))
+
+            state['offset'] = position
+
+    i = 0
+
+    while i < len(data):
+        position = index.get(bytes(data[i:i + DELTA_BLOCK_SIZE]))
+
+        if position is not None:
+            length = DELTA_BLOCK_SIZE
+
+            while (i + length < len(data)
+                   and position + length < len(base)
+                   and data[i + length] == base[position + length]):
+                length += 1
+
+            flush()
+            seek(position)
+            encoded.append(DELTA_OP_COPY)
+            encoded.extend(varint(length))
+            state['offset'] += length
+            i += length
+            continue
+
+        # Add if the data is similar to the base at the current
+        # offset, otherwise insert.
+        offset = state['offset']
+        similar = sum([1
+                       for a, b in zip(data[i:i + DELTA_BLOCK_SIZE],
+                                       base[offset:offset + DELTA_BLOCK_SIZE])
+                       if a == b])
+
+        if similar >= DELTA_BLOCK_SIZE // 2:
+            op = DELTA_OP_ADD
+            value = ((data[i] - base[offset]) & 0xff)
+        else:
+            op = DELTA_OP_INSERT
+            value = data[i]
+
+        if op != pending_op:
+            flush()
+            pending_op = op
+
+        pending.append(value)
+
+        if op == DELTA_OP_ADD:
+            state['offset'] += 1
+
+        i += 1
+
+    flush()
+
+    return encoded
+
+
+def create_header(binary,
+                  description,
+                  encoding=ENCODING_RAW,
+                  window_bits=0,
+                  base=None):
     """Create the upgrade binary header for given binary data.
 
    SIZE       TYPE  DESCRIPTION
@@ -21,39 +235,118 @@ def create_header(binary, description):
       4   uint32_t  CRC32 of the header (not including this field)
      0+  uint8_t[]  data
 
+    Version 2 headers add the data encoding and delta base after the
+    data SHA1. The data size and SHA1 are those of the decoded data.
+
+   SIZE       TYPE  DESCRIPTION
+      4   uint32_t  header version (2)
+      4   uint32_t  header size in bytes
+      4   uint32_t  data size in bytes
+     20  uint8_t[]  SHA1 of the data
+      1    uint8_t  data encoding
+      1    uint8_t  LZ window size as a power of two
+      2  uint8_t[]  reserved (0)
+      4   uint32_t  delta base size in bytes
+     20  uint8_t[]  SHA1 of the delta base
+     1+   c-string  data description
+      4   uint32_t  CRC32 of the header (not including this field)
+     0+  uint8_t[]  encoded data
+
     """
 
-    description += '\0'
+    description = bytearray(description.encode('utf-8') + b'\0')
 
     if len(description) % 4 != 0:
-        description += (4 - (len(description) % 4)) * '\0'
+        description += (4 - (len(description) % 4)) * b'\0'
+
+    if encoding == ENCODING_RAW:
+        header = struct.pack('>III',
+                             1,
+                             36 + len(description),
+                             len(binary))
+        header += hashlib.sha1(binary).digest()
+    else:
+        if base is None:
+            base = bytearray()
+
+        header = struct.pack('>III',
+                             2,
+                             64 + len(description),
+                             len(binary))
+        header += hashlib.sha1(binary).digest()
+        header += struct.pack('>BBxxI', encoding, window_bits, len(base))
+        header += hashlib.sha1(base).digest()
 
-    header = struct.pack('>III',
-                         1,
-                         36 + len(description),
-                         len(binary))
-    header += hashlib.sha1(binary).digest()
     header += description
     header += struct.pack('>I', zlib.crc32(header) & 0xffffffff)
 
     return header
 
+
+def encode(binary, encoding, window_bits, base):
+    if encoding & ENCODING_DELTA:
+        binary = delta_encode(binary, base)
+
+    if encoding & ENCODING_LZ:
+        binary = lz_encode(binary, window_bits)
+
+    return binary
+
+
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument('-o', '--output')
     parser.add_argument('-d', '--description', default="")
+    parser.add_argument('-e', '--encoding',
+                        choices=sorted(ENCODINGS),
+                        default='raw',
+                        help='Data encoding (default: %(default)s).')
+    parser.add_argument('-w', '--window-bits',
+                        type=int,
+                        choices=range(8, 13),
+                        default=10,
+                        help=('LZ window size as a power of two. Must not be '
+                              'bigger than CONFIG_UPGRADE_LZ_WINDOW_BITS on '
+                              'the target (default: %(default)s).'))
+    parser.add_argument('-b', '--base',
+                        help=('Currently installed application to create '
+                              'a delta against.'))
     parser.add_argument('binary')
     args = parser.parse_args()
 
-    with open(args.binary) as fin:
-        binary = fin.read()
+    encoding = ENCODINGS[args.encoding]
+
+    if encoding & ENCODING_DELTA:
+        if args.base is None:
+            parser.error('--base is required for delta encodings')
+
+        with open(args.base, 'rb') as fin:
+            base = bytearray(fin.read())
+    else:
+        base = None
+
+    if encoding & ENCODING_LZ:
+        window_bits = args.window_bits
+    else:
+        window_bits = 0
+
+    with open(args.binary, 'rb') as fin:
+        binary = bytearray(fin.read())
 
-    header = create_header(binary, args.description)
+    header = create_header(binary,
+                           args.description,
+                           encoding,
+                           window_bits,
+                           base)
+    data = encode(binary, encoding, window_bits, base)
 
     with open(args.output, 'wb') as fout:
         fout.write(header)
-        fout.write(binary)
+        fout.write(data)
 
+    print('Created {} ({} of {} bytes after encoding).'.format(args.output,
+                                                              len(data),
+                                                              len(binary)))
 
 
 if __name__ == "__main__":
@@ -43,6 +43,57 @@
 #define EVENT_STOP        0x4
 #define EVENT_TIMEOUT     0x8
 
+/**
+ * Audio stream read callback.
+ */
+static ssize_t file_read(void *arg_p, void *buf_p, size_t size)
+{
+    return (fat16_file_read(arg_p, buf_p, size));
+}
+
+/**
+ * Open given song and start reading ahead from it.
+ */
+static int song_open(struct music_player_t *self_p, const char *path_p)
+{
+    if (fat16_file_open(self_p->fat16_p, &self_p->file, path_p, O_READ) != 0) {
+        return (-1);
+    }
+
+    strcpy(self_p->path, path_p);
+
+    return (audio_stream_open(&self_p->stream, file_read, &self_p->file));
+}
+
+/**
+ * Close the current song once the stream no longer reads from it.
+ */
+static int song_close(struct music_player_t *self_p)
+{
+    audio_stream_close(&self_p->stream);
+
+    return (fat16_file_close(&self_p->file));
+}
+
+/**
+ * Wait for the DAC to convert all frames and give them back to the
+ * stream.
+ */
+static void frames_release(struct music_player_t *self_p)
+{
+    int i;
+
+    dac_async_wait(self_p->dac_p);
+
+    for (i = 0; i < membersof(self_p->frames.converting); i++) {
+        if (self_p->frames.converting[i] != NULL) {
+            audio_stream_release_frame(&self_p->stream,
+                                       self_p->frames.converting[i]);
+            self_p->frames.converting[i] = NULL;
+        }
+    }
+}
+
 static int handle_event_play(struct music_player_t *self_p)
 {
     const char *path_p;
@@ -55,16 +106,14 @@ static int handle_event_play(struct music_player_t *self_p)
 
     case STATE_STOPPED:
         if ((path_p = self_p->cb.current_song_path_p(self_p->cb.arg_p)) != NULL) {
-            fat16_file_open(self_p->fat16_p, &self_p->file, path_p, O_READ);
-            strcpy(self_p->path, path_p);
+            song_open(self_p, path_p);
             self_p->state = STATE_PLAYING;
         }
         break;
 
     case STATE_IDLE:
         if ((path_p = self_p->cb.current_song_path_p(self_p->cb.arg_p)) != NULL) {
-            if (fat16_file_open(self_p->fat16_p, &self_p->file, path_p, O_READ) == 0) {
-                strcpy(self_p->path, path_p);
+            if (song_open(self_p, path_p) == 0) {
                 self_p->state = STATE_PLAYING;
             } else {
                 std_printf(FSTR("Failed to open %s\r\n"), path_p);
@@ -105,7 +154,8 @@ static int handle_event_stop(struct music_player_t *self_p)
 
     case STATE_PLAYING:
     case STATE_PAUSED:
-        fat16_file_close(&self_p->file);
+        frames_release(self_p);
+        song_close(self_p);
         self_p->state = STATE_STOPPED;
         break;
 
@@ -117,44 +167,47 @@ static int handle_event_stop(struct music_player_t *self_p)
 }
 
 /**
- * Read from the file for the current song and add samples to the
- * DAC. In case the song ends, open the next song as preparation for
- * the next call to this function.
+ * Add the next frame decoded by the audio stream reader thread to
+ * the DAC. In case the song ends, open the next song as preparation
+ * for the next call to this function.
  */
 static int play_chunk(struct music_player_t *self_p)
 {
     const char *path_p;
-    uint32_t *buf_p;
-    size_t size;
-    int i;
+    struct audio_stream_frame_t *frame_p;
+    ssize_t res;
+
+    res = audio_stream_read_frame(&self_p->stream, &frame_p);
+
+    if (res > 0) {
+        /* Add samples for DAC convertion. The DAC converts two
+           samples per word. */
+        dac_async_convert(self_p->dac_p,
+                          (uint32_t *)&frame_p->samples[0],
+                          res / 2);
+
+        /* The frame added before the previous one has been
+           converted once the DAC accepted this frame. */
+        if (self_p->frames.converting[0] != NULL) {
+            audio_stream_release_frame(&self_p->stream,
+                                       self_p->frames.converting[0]);
+        }
 
-    /* Read samples from the file. */
-    buf_p = self_p->samples.buf[self_p->samples.index];
-    self_p->samples.index++;
-    self_p->samples.index %= membersof(self_p->samples.buf);
-    size = fat16_file_read(&self_p->file,
-                           buf_p,
-                           sizeof(self_p->samples.buf[0]));
-
-    /* Optional down sampling of the read samples. */
-    if (self_p->down_sampling_mask != 0xfffffffful) {
-        for (i = 0; i < size / 4; i++) {
-            buf_p[i] &= self_p->down_sampling_mask;
+        self_p->frames.converting[0] = self_p->frames.converting[1];
+        self_p->frames.converting[1] = frame_p;
+    } else if (res != -EAGAIN) {
+        if (res < 0) {
+            std_printf(FSTR("Failed to decode %s\r\n"), self_p->path);
         }
-    }
 
-    if (size > 0) {
-        /* Add samples for DAC convertion. */
-        dac_async_convert(self_p->dac_p, buf_p, size / 4);
-    } else {
         /* Start playing the next file in the queue. */
-        fat16_file_close(&self_p->file);
+        song_close(self_p);
 
         if ((path_p = self_p->cb.next_song_path_p(self_p->cb.arg_p)) != NULL) {
-            strcpy(self_p->path, path_p);
-            std_printf(FSTR("Playing | %s\r\n"), self_p->path);
-            fat16_file_open(self_p->fat16_p, &self_p->file, path_p, O_READ);
+            std_printf(FSTR("Playing | %s\r\n"), path_p);
+            song_open(self_p, path_p);
         } else {
+            frames_release(self_p);
             self_p->state = STATE_IDLE;
         }
     }
@@ -231,21 +284,33 @@ int music_player_init(struct music_player_t *self_p,
                       void *arg_p)
 {
     self_p->state = STATE_IDLE;
-    self_p->down_sampling_mask = 0xfffffffful;
     self_p->fat16_p = fat16_p;
     self_p->dac_p = dac_p;
-    self_p->samples.index = 0;
+    self_p->frames.converting[0] = NULL;
+    self_p->frames.converting[1] = NULL;
     self_p->cb.current_song_path_p = current_song_path_p;
     self_p->cb.next_song_path_p = next_song_path_p;
     self_p->cb.arg_p = arg_p;
     self_p->thrd_p = NULL;
     event_init(&self_p->event);
-
-    return (0);
+    audio_stream_module_init();
+
+    return (audio_stream_init(&self_p->stream,
+                              &self_p->frames.buf[0],
+                              membersof(self_p->frames.buf),
+                              &self_p->read_ahead_buf[0],
+                              sizeof(self_p->read_ahead_buf),
+                              AUDIO_STREAM_FORMAT_DAC12));
 }
 
 int music_player_start(struct music_player_t *self_p)
 {
+    if (audio_stream_start(&self_p->stream,
+                           self_p->reader_stack,
+                           sizeof(self_p->reader_stack)) != 0) {
+        return (-1);
+    }
+
     self_p->thrd_p = thrd_spawn((void *(*)(void *))music_player_main,
                                 self_p,
                                 -30,
@@ -293,17 +358,10 @@ int music_player_song_stop(struct music_player_t *self_p)
 int music_player_set_bits_per_sample(struct music_player_t *self_p,
                                      int value)
 {
-    uint16_t mask;
-
-    value = (12 - value);
-    mask = ~((1 << value) - 1);
-
-    self_p->down_sampling_mask = (((uint32_t)mask << 16) | mask);
-
     log_object_print(NULL,
                      LOG_INFO,
-                     OSTR("down_sampling_mask = 0x%lx\r\n"),
-                     self_p->down_sampling_mask);
+                     OSTR("bits_per_sample = %d\r\n"),
+                     value);
 
-    return (0);
+    return (audio_stream_set_bits_per_sample(&self_p->stream, value));
 }
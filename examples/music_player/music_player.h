@@ -30,7 +30,7 @@
 
 #include "simba.h"
 
-#define SAMPLES_MAX      1024
+#define FRAMES_MAX          6
 
 #define SONG_PATH_MAX      64
 #define QUEUE_MAX           8
@@ -39,17 +39,18 @@ typedef const char *(*song_path_t)(void *arg_p);
 
 struct music_player_t {
     int state;
-    uint32_t down_sampling_mask;
     struct event_t event;
     struct timer_t timer;
     struct fat16_t *fat16_p;
     struct dac_driver_t *dac_p;
     char path[32];
     struct fat16_file_t file;
+    struct audio_stream_t stream;
     struct {
-        int index;
-        uint32_t buf[4][SAMPLES_MAX] __attribute__((aligned (8)));
-    } samples __attribute__((aligned (8)));
+        struct audio_stream_frame_t buf[FRAMES_MAX];
+        struct audio_stream_frame_t *converting[2];
+    } frames;
+    uint8_t read_ahead_buf[1024];
     struct {
         song_path_t current_song_path_p;
         song_path_t next_song_path_p;
@@ -57,6 +58,7 @@ struct music_player_t {
     } cb;
     struct thrd_t *thrd_p;
     THRD_STACK(stack, 1024);
+    THRD_STACK(reader_stack, 1536);
 };
 
 /**
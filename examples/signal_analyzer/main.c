@@ -30,97 +30,108 @@
 
 #include "simba.h"
 
-#define SAMPLE_TIMEOUT_IN_MICROSECONDS                     50
-#define TIMEOUTS_PER_REPORT                              1000
+#define SAMPLING_RATE                                   20000
+#define SAMPLES_PER_REPORT                               1000
+#define CHANNELS                                            8
 
-/**
- * Report of a measurement period.
- */
-struct report_t {
-    uint32_t high_count;
-    uint32_t low_count;
-    uint32_t rising_count;
+struct module_t {
+    struct fs_command_t cmd_pwm_measure;
+    struct capture_driver_t capture;
+    uint8_t buf[1024];
+#if defined(FAMILY_LINUX)
+    struct capture_pwm_source_t source;
+#endif
+    THRD_STACK(stack, 1024);
 };
 
-/**
- * PWM signal measurement pin.
- */
-struct pwm_pin_t {
-    struct pin_device_t *pin_device_p;
-    int previous_value;
-    struct report_t report;
-};
+static struct module_t module;
 
-struct module_t {
-    struct fs_command_t cmd_pwm_measure;
-    uint32_t timeout_count;
-    struct queue_t queue;
-    uint8_t buf[128];
-    struct pwm_pin_t pwm_pins[8];
+#if defined(FAMILY_LINUX)
+
+/* Simulated PWM signals; period and number of high samples. */
+static const uint32_t pwms[CHANNELS][2] = {
+    { 20, 5 },
+    { 40, 20 },
+    { 200, 20 },
+    { 400, 360 },
+    { 1, 1 },
+    { 1, 0 },
+    { 10, 5 },
+    { 80, 60 }
 };
 
-static struct module_t module = {
-    .pwm_pins = {
-        { .pin_device_p = &pin_d2_dev },
-        { .pin_device_p = &pin_d3_dev },
-        { .pin_device_p = &pin_d4_dev },
-        { .pin_device_p = &pin_d5_dev },
-        { .pin_device_p = &pin_d6_dev },
-        { .pin_device_p = &pin_d7_dev },
-        { .pin_device_p = &pin_d8_dev },
-        { .pin_device_p = &pin_d9_dev }
+static int source_init(void)
+{
+    int i;
+
+    capture_pwm_source_init(&module.source, CHANNELS);
+
+    for (i = 0; i < CHANNELS; i++) {
+        capture_pwm_source_set(&module.source, i, pwms[i][0], pwms[i][1]);
     }
+
+    return (capture_init(&module.capture,
+                         capture_pwm_source_read,
+                         &module.source,
+                         CHANNELS,
+                         SAMPLING_RATE,
+                         &module.buf[0],
+                         sizeof(module.buf),
+                         SAMPLES_PER_REPORT));
+}
+
+#else
+
+static struct pin_device_t *pin_devices[CHANNELS] = {
+    &pin_d2_dev,
+    &pin_d3_dev,
+    &pin_d4_dev,
+    &pin_d5_dev,
+    &pin_d6_dev,
+    &pin_d7_dev,
+    &pin_d8_dev,
+    &pin_d9_dev
 };
 
 /**
- * PWM measure timer callback. Reads input pin values, stores the data
- * in a report, and writes the report to a queue once the report
- * period is over.
+ * Read all PWM signal measurement pins. The pins are not on the same
+ * port on most boards, so they are read one by one. Read the input
+ * register of the port instead if all pins are on one port.
  */
-static void sample_timeout(void *arg_p)
+static uint8_t pins_read(void *arg_p)
 {
+    uint8_t value;
     int i;
-    int value;
 
-    /* Read the pin value and update the report for each pin. */
-    for (i = 0; i < membersof(module.pwm_pins); i++) {
-        value = pin_device_read(module.pwm_pins[i].pin_device_p);
+    value = 0;
 
-        if (value == 1) {
-            module.pwm_pins[i].report.high_count++;
-        } else {
-            module.pwm_pins[i].report.low_count++;
-        }
-
-        if ((value == 1) && (module.pwm_pins[i].previous_value == 0)) {
-            module.pwm_pins[i].report.rising_count++;
-        }
-
-        module.pwm_pins[i].previous_value = value;
+    for (i = 0; i < CHANNELS; i++) {
+        value |= (pin_device_read(pin_devices[i]) << i);
     }
 
-    module.timeout_count++;
-
-    /* Write the reports to the report queue when the report period is
-       over. */
-    if ((module.timeout_count % TIMEOUTS_PER_REPORT) == 0) {
-        queue_write_isr(&module.queue,
-                        &module.timeout_count,
-                        sizeof(module.timeout_count));
+    return (value);
+}
 
-        for (i = 0; i < membersof(module.pwm_pins); i++) {
-            queue_write_isr(&module.queue,
-                            &module.pwm_pins[i].report,
-                            sizeof(module.pwm_pins[0].report));
+static int source_init(void)
+{
+    int i;
 
-            /* Reset for next report period. */
-            module.pwm_pins[i].report.high_count = 0;
-            module.pwm_pins[i].report.low_count = 0;
-            module.pwm_pins[i].report.rising_count = 0;
-        }
+    for (i = 0; i < CHANNELS; i++) {
+        pin_device_set_mode(pin_devices[i], PIN_INPUT);
     }
+
+    return (capture_init(&module.capture,
+                         pins_read,
+                         NULL,
+                         CHANNELS,
+                         SAMPLING_RATE,
+                         &module.buf[0],
+                         sizeof(module.buf),
+                         SAMPLES_PER_REPORT));
 }
 
+#endif
+
 /**
  * File system command to measure duty cycle and frequency of up to
  * eight PWM signals.
@@ -133,14 +144,12 @@ static int cmd_pwm_measure_cb(int argc,
                               void *call_arg_p)
 {
     int i, j;
-    struct time_t timeout;
     char *delim_p;
-    struct report_t reports[8];
+    struct capture_report_t report;
     uint32_t time;
     int duty_cycle;
     int frequency;
     long iterations;
-    struct timer_t timer;
 
     if (argc > 2) {
         std_fprintf(chout_p, OSTR("Usage: %s [iterations]\r\n"), argv[0]);
@@ -157,38 +166,27 @@ static int cmd_pwm_measure_cb(int argc,
         iterations = 1;
     }
 
-    /* Initialization. */
-    queue_init(&module.queue, &module.buf[0], sizeof(module.buf));
-    module.timeout_count = 0;
-
-    for (i = 0; i < membersof(module.pwm_pins); i++) {
-        module.pwm_pins[i].report.high_count = 0;
-        module.pwm_pins[i].report.low_count = 0;
-        module.pwm_pins[i].report.rising_count = 0;
+    if (capture_start(&module.capture,
+                      module.stack,
+                      sizeof(module.stack)) != 0) {
+        return (-1);
     }
 
-    timeout.seconds = 0;
-    timeout.nanoseconds = 1000L * SAMPLE_TIMEOUT_IN_MICROSECONDS;
+    time = 0;
 
-    timer_init(&timer,
-               &timeout,
-               sample_timeout,
-               NULL,
-               TIMER_PERIODIC);
-    timer_start(&timer);
-
-    /* Wait for reports from the timer callback. */
+    /* Wait for reports from the capture worker thread. */
     for (i = 0; i < iterations; i++) {
-        queue_read(&module.queue, &time, sizeof(time));
-        queue_read(&module.queue, &reports[0], sizeof(reports));
+        capture_read_report(&module.capture, &report);
+        time += report.number_of_samples;
 
         std_fprintf(chout_p, OSTR("%lu: ["), time);
         delim_p = "";
 
-        for (j = 0; j < membersof(reports); j++, delim_p = ",") {
-            duty_cycle = ((100 * reports[j].high_count) / TIMEOUTS_PER_REPORT);
-            frequency = ((1000000 * reports[j].rising_count)
-                         / (TIMEOUTS_PER_REPORT * SAMPLE_TIMEOUT_IN_MICROSECONDS));
+        for (j = 0; j < CHANNELS; j++, delim_p = ",") {
+            duty_cycle = ((100 * report.channels[j].high)
+                          / report.number_of_samples);
+            frequency = ((report.channels[j].rising_edges * SAMPLING_RATE)
+                         / report.number_of_samples);
             std_fprintf(chout_p,
                         OSTR("%s(%d,%d)"),
                         delim_p,
@@ -199,24 +197,19 @@ static int cmd_pwm_measure_cb(int argc,
         std_fprintf(chout_p, OSTR("]\r\n"));
     }
 
-    /* Measurement complete, stop the timer. */
-    timer_stop(&timer);
+    /* Measurement complete, stop sampling. */
+    capture_stop(&module.capture);
 
     return (0);
 }
 
 int main()
 {
-    int i;
-
     sys_start();
 
     std_printf(sys_get_info());
 
-    /* Initialize the pins as inputs. */
-    for (i = 0; i < membersof(module.pwm_pins); i++) {
-        pin_device_set_mode(module.pwm_pins[i].pin_device_p, PIN_INPUT);
-    }
+    source_init();
 
     fs_command_init(&module.cmd_pwm_measure,
                     CSTR("/pwm/measure"),
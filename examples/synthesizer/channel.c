@@ -31,10 +31,15 @@
 #include "simba.h"
 #include "channel.h"
 
+/* Q15 gain of each note. Eight notes at full scale fill the output
+   range. */
+#define NOTE_GAIN (INT16_MAX / 8)
+
 int channel_init(struct channel_t *self_p,
                  int id,
-                 int32_t *buf_p,
-                 size_t length)
+                 const int16_t *buf_p,
+                 size_t length,
+                 int sample_rate)
 {
     self_p->id = id;
     self_p->state = CHANNEL_STATE_ON;
@@ -42,7 +47,12 @@ int channel_init(struct channel_t *self_p,
     self_p->waveform.buf_p = buf_p;
     self_p->waveform.length = length;
 
-    return (0);
+    return (dsp_oscillator_bank_init(&self_p->oscillator_bank,
+                                     buf_p,
+                                     length,
+                                     sample_rate,
+                                     &self_p->oscillators[0],
+                                     membersof(self_p->oscillators)));
 }
 
 struct note_t *channel_note_alloc(struct channel_t *self_p)
@@ -90,13 +100,18 @@ struct note_t *channel_note_iter_next(struct channel_t *self_p)
 }
 
 int channel_set_waveform(struct channel_t *self_p,
-                         int32_t *buf_p,
+                         const int16_t *buf_p,
                          size_t length)
 {
     self_p->waveform.buf_p = buf_p;
     self_p->waveform.length = length;
 
-    return (0);
+    return (dsp_oscillator_bank_init(&self_p->oscillator_bank,
+                                     buf_p,
+                                     length,
+                                     self_p->oscillator_bank.sample_rate,
+                                     &self_p->oscillators[0],
+                                     membersof(self_p->oscillators)));
 }
 
 int channel_set_state(struct channel_t *self_p,
@@ -113,11 +128,11 @@ int channel_get_id(struct channel_t *self_p)
 }
 
 int channel_process(struct channel_t *self_p,
-                    int32_t *samples_p,
-                    int32_t *buf_p,
+                    int16_t *samples_p,
+                    int16_t *buf_p,
                     size_t length)
 {
-    int i, j;
+    int i;
     struct note_t *note_p;
 
     if (self_p->state == CHANNEL_STATE_OFF) {
@@ -129,19 +144,20 @@ int channel_process(struct channel_t *self_p,
         note_p = &self_p->notes[i];
 
         oscillator_read(&note_p->oscillator,
+                        &self_p->oscillator_bank,
+                        i,
                         buf_p,
                         length);
 
-        if (envelope_apply(&note_p->envelope, buf_p, length) != length) {
+        if (dsp_envelope_apply(&note_p->envelope, buf_p, length) != length) {
             /* Free the note when the envelope ends. */
             self_p->notes[i] = self_p->notes[self_p->length - 1];
+            self_p->oscillators[i] = self_p->oscillators[self_p->length - 1];
             self_p->length--;
             i--;
         }
 
-        for (j = 0; j < length; j++) {
-            samples_p[j] += buf_p[j];
-        }
+        dsp_mix(samples_p, buf_p, NOTE_GAIN, length);
     }
 
     return (0);
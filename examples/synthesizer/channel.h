@@ -45,12 +45,15 @@ struct channel_t {
     int id;
     int state;
     struct note_t notes[8];
+    struct dsp_oscillator_t oscillators[8]; /* The oscillator of each
+                                             * note. */
+    struct dsp_oscillator_bank_t oscillator_bank;
     int length;
     struct {
         int pos;
     } iter;
     struct {
-        int32_t *buf_p;
+        const int16_t *buf_p;
         size_t length;
     } waveform;
 };
@@ -61,28 +64,31 @@ struct channel_t {
  * @param[in] self_p The channel to initialize.
  * @param[in] id Channel id.
  * @param[in] buf_p Waveform to use.
- * @param[in] length Length of the waveform.
+ * @param[in] length Length of the waveform. Must be a power of two.
+ * @param[in] sample_rate Sample rate.
  *
  * @return zero(0) or negative error code.
  */
 int channel_init(struct channel_t *self_p,
                  int id,
-                 int32_t *buf_p,
-                 size_t length);
+                 const int16_t *buf_p,
+                 size_t length,
+                 int sample_rate);
 
 /**
  * Do the signal processing.
  *
  * @param[in] self_p Initialize channel.
- * @param[in] samples_p Output sample buffer.
+ * @param[in,out] samples_p Output sample buffer to mix the notes
+ *                          into.
  * @param[in] buf_p Workspace buffer for the signal processing.
  * @param[in] length Number of members in sample buffers.
  *
  * @return zero(0) or negative error code.
  */
 int channel_process(struct channel_t *self_p,
-                    int32_t *samples_p,
-                    int32_t *buf_p,
+                    int16_t *samples_p,
+                    int16_t *buf_p,
                     size_t length);
 
 /**
@@ -90,12 +96,12 @@ int channel_process(struct channel_t *self_p,
  *
  * @param[in] self_p Initialize channel.
  * @param[in] buf_p Pointer to the waveform.
- * @param[in] length Length of the waveform.
+ * @param[in] length Length of the waveform. Must be a power of two.
  *
  * @return zero(0) or negative error code.
  */
 int channel_set_waveform(struct channel_t *self_p,
-                         int32_t *buf_p,
+                         const int16_t *buf_p,
                          size_t length);
 
 /**
@@ -79,8 +79,9 @@ static THRD_STACK(shell_stack, 1024);
 static struct uart_driver_t uart_midi;
 static uint8_t uart_midi_inbuf[32];
 
-static int32_t samples[4][SAMPLES_MAX];
-static int32_t buf[SAMPLES_MAX];
+static int16_t samples[SAMPLES_MAX];
+static uint32_t dac_samples[4][SAMPLES_MAX];
+static int16_t buf[SAMPLES_MAX];
 
 static struct synthesizer_t synthesizer;
 
@@ -130,7 +131,6 @@ static int note_on(struct channel_t *channel_p,
     if ((note_p = channel_note_alloc(channel_p)) != NULL) {
         note_init(note_p,
                   note,
-                  channel_p->waveform.buf_p,
                   channel_p->waveform.length,
                   frequency,
                   synthesizer.vibrato,
@@ -662,7 +662,8 @@ static int init(void)
         channel_init(&synthesizer.channels[i],
                      i,
                      waveform_square_256,
-                     membersof(waveform_square_256));
+                     membersof(waveform_square_256),
+                     SAMPLE_RATE);
     }
 
     synthesizer.vibrato = 0.0;
@@ -696,8 +697,8 @@ static int init(void)
 int main()
 {
     int i;
-    int32_t *samples_p;
-    int samples_index = 0;
+    uint32_t *dac_samples_p;
+    int dac_samples_index = 0;
     uint32_t mask;
     struct time_t timeout;
 
@@ -722,10 +723,7 @@ int main()
         event_read(&synthesizer.events, &mask, sizeof(mask));
 
         /* Prepare the sample buffer. */
-        samples_p = &samples[samples_index][0];
-        samples_index++;
-        samples_index %= membersof(samples);
-        memset(samples_p, 0, sizeof(samples[0]));
+        memset(&samples[0], 0, sizeof(samples));
 
         /* Calculate the next few samples and start the convertion in
          * the DAC. The smaller the buffer, the shorter the delay to
@@ -734,18 +732,23 @@ int main()
 
         for (i = 0; i < membersof(synthesizer.channels); i++) {
             channel_process(&synthesizer.channels[i],
-                            samples_p,
+                            &samples[0],
                             buf,
                             SAMPLES_MAX);
         }
 
         sem_give(&synthesizer.sem, 1);
 
+        /* Convert the samples to 12 bits unsigned DAC samples. */
+        dac_samples_p = &dac_samples[dac_samples_index][0];
+        dac_samples_index++;
+        dac_samples_index %= membersof(dac_samples);
+
         for (i = 0; i < SAMPLES_MAX; i++) {
-            samples_p[i] = ((samples_p[i] >> 7) + 2048);
+            dac_samples_p[i] = ((samples[i] >> 4) + 2048);
         }
 
-        dac_async_convert(&synthesizer.dac, (uint32_t *)samples_p, SAMPLES_MAX);
+        dac_async_convert(&synthesizer.dac, dac_samples_p, SAMPLES_MAX);
     }
 
     return (0);
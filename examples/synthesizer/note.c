@@ -33,7 +33,6 @@
 
 int note_init(struct note_t *self_p,
               int note,
-              int32_t *waveform_p,
               size_t length,
               float frequency,
               float vibrato,
@@ -45,24 +44,24 @@ int note_init(struct note_t *self_p,
     self_p->note = note;
 
     oscillator_init(&self_p->oscillator,
-                    waveform_p,
                     length,
                     frequency,
                     vibrato,
                     sample_rate);
 
-    return (envelope_init(&self_p->envelope,
-                          attack,
-                          decay,
-                          release));
+    return (dsp_envelope_init(&self_p->envelope,
+                              attack,
+                              decay,
+                              INT16_MAX,
+                              release));
 }
 
 int note_start(struct note_t *self_p)
 {
-    return (0);
+    return (dsp_envelope_start(&self_p->envelope));
 }
 
 int note_stop(struct note_t *self_p)
 {
-    return (envelope_set_phase_release(&self_p->envelope));
+    return (dsp_envelope_release(&self_p->envelope));
 }
@@ -33,19 +33,17 @@
 
 #include "simba.h"
 #include "oscillator.h"
-#include "envelope.h"
 
 struct note_t {
     int note;
     struct oscillator_t oscillator;
-    struct envelope_t envelope;
+    struct dsp_envelope_t envelope;
 };
 
 /**
  * Initialize a note with given configuration.
  *
  * @param[in] self_p The note to initialize.
- * @param[in] waveform_p Waveform to use.
  * @param[in] length Length of the waveform.
  * @param[in] frequency Note frequency.
  * @param[in] sample_rate Sample rate.
@@ -54,7 +52,6 @@ struct note_t {
  */
 int note_init(struct note_t *self_p,
               int note,
-              int32_t *waveform_p,
               size_t length,
               float frequency,
               float vibrato,
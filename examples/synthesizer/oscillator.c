@@ -31,34 +31,19 @@
 #include "simba.h"
 #include "oscillator.h"
 
-static q20_11_t
-frequency_to_phase_increment(float frequency,
-                             size_t waveform_length,
-                             int sample_rate)
-{
-    return FLOAT_TO_Q20_11(((frequency * waveform_length)
-                            / sample_rate));
-}
+/* The vibrato changes direction every this many samples. */
+#define VIBRATO_PERIOD 4096
 
 int oscillator_init(struct oscillator_t *self_p,
-                    int32_t *waveform_p,
                     size_t length,
                     float frequency,
                     float vibrato,
                     int sample_rate)
 {
-    self_p->sample_rate = sample_rate;
+    self_p->sample_rate_per_length = ((float)sample_rate / length);
     self_p->sample_counter = 0;
     self_p->frequency = frequency;
     self_p->vibrato.value = vibrato;
-    self_p->vibrato.phase_increment = FLOAT_TO_Q20_11(vibrato);
-    self_p->phase = 0;
-    self_p->phase_increment =
-        frequency_to_phase_increment(frequency,
-                                     length,
-                                     sample_rate);
-    self_p->waveform.length = length;
-    self_p->waveform.buf_p = waveform_p;
 
     return (0);
 }
@@ -67,10 +52,6 @@ int oscillator_set_frequency(struct oscillator_t *self_p,
                              float frequency)
 {
     self_p->frequency = frequency;
-    self_p->phase_increment =
-        frequency_to_phase_increment(frequency,
-                                     self_p->waveform.length,
-                                     self_p->sample_rate);
 
     return (0);
 }
@@ -83,32 +64,56 @@ int oscillator_set_vibrato(struct oscillator_t *self_p,
     }
 
     self_p->vibrato.value = vibrato;
-    self_p->vibrato.phase_increment = FLOAT_TO_Q20_11(vibrato);
 
     return (0);
 }
 
 int oscillator_read(struct oscillator_t *self_p,
-                    int32_t *samples_p,
+                    struct dsp_oscillator_bank_t *bank_p,
+                    int index,
+                    int16_t *samples_p,
                     size_t length)
 {
-    int i;
-    int index;
+    int res;
+    size_t size;
+    float frequency;
 
-    for (i = 0; i < length; i++) {
-        if ((self_p->sample_counter % 4096) == 0) {
+    while (length > 0) {
+        if ((self_p->sample_counter % VIBRATO_PERIOD) == 0) {
             self_p->vibrato.value *= -1.0;
-            self_p->vibrato.phase_increment =
-                FLOAT_TO_Q20_11(self_p->vibrato.value);
         }
 
-        self_p->phase += self_p->phase_increment;
-        self_p->phase += self_p->vibrato.phase_increment;
-        index = (((uint32_t)Q20_11_TO_INT(self_p->phase))
-                 % self_p->waveform.length);
-        samples_p[i] = self_p->waveform.buf_p[index];
+        /* Render up to the next vibrato direction change with a
+           constant frequency. */
+        size = (VIBRATO_PERIOD - (self_p->sample_counter % VIBRATO_PERIOD));
+
+        if (size > length) {
+            size = length;
+        }
+
+        frequency = (self_p->frequency
+                     + (self_p->vibrato.value
+                        * self_p->sample_rate_per_length));
+
+        if (frequency < 0.0) {
+            frequency = 0.0;
+        }
+
+        res = dsp_oscillator_bank_set(bank_p, index, frequency, INT16_MAX);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        res = dsp_oscillator_bank_render_one(bank_p, index, samples_p, size);
+
+        if (res != 0) {
+            return (res);
+        }
 
-        self_p->sample_counter++;
+        self_p->sample_counter += size;
+        samples_p += size;
+        length -= size;
     }
 
     return (0);
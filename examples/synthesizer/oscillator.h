@@ -32,40 +32,34 @@
 #define __OSCILLATOR_H__
 
 #include "simba.h"
-#include "types.h"
 
+/**
+ * The frequency of an oscillator in a DSP oscillator bank, with
+ * vibrato. The waveform is rendered by the oscillator bank of the
+ * channel.
+ */
 struct oscillator_t {
     float frequency;
-    int sample_rate;
+    float sample_rate_per_length; /* Waveform samples per output
+                                   * sample to Hz. */
     int sample_counter;
-    q20_11_t phase; /* Current phase in the waveform. */
-    q20_11_t phase_increment; /* The number of steps to increment the
-                               * phase to get the next sample in the
-                               * waveform. */
     struct {
-        float value;
-        q20_11_t phase_increment;
+        float value; /* Waveform samples per output sample. */
     } vibrato;
-    struct {
-        int length; /* Length (number of samples) in the waveform
-                     * cycle. */
-        int32_t *buf_p; /* Pointer to the waveform cycle. */
-    } waveform;
 };
 
 /**
- * Initialize a oscillator with given waveform and frequency.
+ * Initialize a oscillator with given frequency and vibrato.
  *
  * @param[in] self_p The oscillator to initialize.
- * @param[in] waveform_p Waveform to use.
  * @param[in] length Length of the waveform.
  * @param[in] frequency Oscillator frequency.
+ * @param[in] vibrato Vibrato in waveform samples per output sample.
  * @param[in] sample_rate Sample rate.
  *
  * @return zero(0) or negative error code.
  */
 int oscillator_init(struct oscillator_t *self_p,
-                    int32_t *waveform_p,
                     size_t length,
                     float frequency,
                     float vibrato,
@@ -94,16 +88,21 @@ int oscillator_set_vibrato(struct oscillator_t *self_p,
                            float vibrato);
 
 /**
- * Read the next samples from the oscillator.
+ * Read the next samples from the oscillator, which is given
+ * oscillator in given oscillator bank.
  *
  * @param[in] self_p The oscillator.
+ * @param[in] bank_p The oscillator bank.
+ * @param[in] index Index of the oscillator in the bank.
  * @param[out] samples_p Read samples.
  * @param[in] length Number of samples to read.
  *
  * @return zero(0) or negative error code.
  */
 int oscillator_read(struct oscillator_t *self_p,
-                    int32_t *samples_p,
+                    struct dsp_oscillator_bank_t *bank_p,
+                    int index,
+                    int16_t *samples_p,
                     size_t length);
 
 #endif
@@ -42,7 +42,7 @@
  *                 \    /        \    /
  *  -32767          `--´          `--´
  */
-static int32_t waveform_sine_256[] = {
+static const int16_t waveform_sine_256[] = {
     0, 804, 1608, 2411, 3212, 4011, 4808, 5602,
     6393, 7179, 7962, 8740, 9512, 10279, 11039, 11793,
     12540, 13279, 14010, 14733, 15446, 16151, 16846, 17531,
@@ -51,7 +51,7 @@ static int32_t waveform_sine_256[] = {
     27245, 27684, 28106, 28511, 28898, 29269, 29621, 29956,
     30273, 30572, 30852, 31114, 31357, 31581, 31785, 31971,
     32138, 32285, 32413, 32521, 32610, 32679, 32728, 32758,
-    32768, 32758, 32728, 32679, 32610, 32521, 32413, 32285,
+    32767, 32758, 32728, 32679, 32610, 32521, 32413, 32285,
     32138, 31971, 31785, 31581, 31357, 31114, 30852, 30572,
     30273, 29956, 29621, 29269, 28898, 28511, 28106, 27684,
     27245, 26790, 26319, 25832, 25330, 24812, 24279, 23732,
@@ -86,7 +86,7 @@ static int32_t waveform_sine_256[] = {
  *                |        |        |        |
  * -32767 --------+        +--------+        +--------
  */
-static int32_t waveform_square_256[] = {
+static const int16_t waveform_square_256[] = {
     -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
     -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
     -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
@@ -103,22 +103,22 @@ static int32_t waveform_square_256[] = {
     -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
     -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
     -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
-    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767
 };
 
 /**
@@ -130,7 +130,7 @@ static int32_t waveform_square_256[] = {
  *          /     | /     | /     | /     |  /     |
  * -32767 ´       ´       ´       ´       ´´       ´
  */
-static int32_t waveform_saw_256[] = {
+static const int16_t waveform_saw_256[] = {
     -32767, -32510, -32253, -31996, -31739, -31482, -31225, -30968,
     -30711, -30454, -30197, -29940, -29683, -29426, -29169, -28912,
     -28655, -28398, -28141, -27884, -27627, -27370, -27113, -26856,
@@ -162,7 +162,7 @@ static int32_t waveform_saw_256[] = {
     24801, 25058, 25315, 25572, 25829, 26086, 26343, 26600,
     26857, 27114, 27371, 27628, 27885, 28142, 28399, 28656,
     28913, 29170, 29427, 29684, 29941, 30198, 30455, 30712,
-    30969, 31226, 31483, 31740, 31997, 32254, 32511, 32768
+    30969, 31226, 31483, 31740, 31997, 32254, 32511, 32767
 };
 
 #endif
@@ -28,7 +28,7 @@
 # This file is part of the Simba project.
 #
 
-.PHONY: all generate build clean new run rerun run-debugger help
+.PHONY: all generate build clean new run rerun run-debugger help ubin
 
 VERSION ?= $(shell cat $(SIMBA_ROOT)/VERSION.txt)
 
@@ -63,6 +63,15 @@ EXE = $(BUILDDIR)/$(NAME).$(EXE_SUFFIX)
 BIN = $(BUILDDIR)/$(NAME).bin
 UBIN = $(BUILDDIR)/$(NAME).ubin
 UPGRADE_BINARY_DESCRIPTION ?= "$(shell date)"
+UPGRADE_BINARY_ENCODING ?= raw
+UPGRADE_BINARY_WINDOW_BITS ?= 10
+UPGRADE_BINARY_BASE ?=
+UPGRADE_BINARY_IMAGE ?= $(EXE)
+UPGRADE_PY ?= $(SIMBA_ROOT)/bin/upgrade.py
+UPGRADE_PY_ARGS = -d $(UPGRADE_BINARY_DESCRIPTION) \
+	-e $(UPGRADE_BINARY_ENCODING) \
+	-w $(UPGRADE_BINARY_WINDOW_BITS) \
+	$(UPGRADE_BINARY_BASE:%=-b %)
 HEX = $(BUILDDIR)/$(NAME).hex
 MAP = $(BUILDDIR)/$(NAME).map
 RUNLOG = $(BUILDDIR)/run.log
@@ -198,6 +207,9 @@ size-json:
 release:
 	env NASSERT=yes $(MAKE)
 
+ubin: all
+	$(UPGRADE_PY) $(UPGRADE_PY_ARGS) -o $(UBIN) $(UPGRADE_BINARY_IMAGE)
+
 $(EXE): $(OBJ) $(SIMBA_GEN_O)
 	@echo "LD $@"
 	$(CXX) $(LIBPATH:%=-L%) $(LDFLAGS) -Wl,--start-group $(LIB:%=-l%) $^ -Wl,--end-group -o $@
@@ -316,6 +328,7 @@ help:
 	@echo "  console                     Open a serial console on /dev/arduino with"
 	@echo "                              baudrate BAUDRATE."
 	@echo "  release                     Compile with NASSERT=yes."
+	@echo "  ubin                        all + Create an upgrade binary file."
 	@echo "  size                        Print application size information."
 	@echo "  stack-usage                 Print stack usage per function."
 	@echo "  backtrace                   Convert a list of space separated addresses in "
@@ -329,6 +342,9 @@ help:
 	@echo "  variable                    description"
 	@echo "--------------------------------------------------------------------------------"
 	@echo "  NASSERT                      yes - build without assertions"
+	@echo "  UPGRADE_BINARY_ENCODING      raw, lz, delta or delta-lz"
+	@echo "  UPGRADE_BINARY_BASE          installed application to create a"
+	@echo "                               delta against"
 	@IFS=$$'\n' ; for h in $(HELP_VARIABLES) ; do \
 	  echo $$h ; \
 	done
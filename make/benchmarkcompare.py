@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+#
+# Compare two benchmark result files created by 'make benchmark'. The
+# median time per operation is compared.
+#
+
+import sys
+import json
+import argparse
+
+
+def load(filename):
+    results = {}
+
+    with open(filename) as fin:
+        for line in fin:
+            line = line.strip()
+
+            if not line:
+                continue
+
+            result = json.loads(line)
+            results[result["name"]] = result
+
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compare two Simba benchmark result files.')
+    parser.add_argument("-t", "--threshold",
+                        type=float,
+                        default=5.0,
+                        help="Change in percent to highlight (default: 5).")
+    parser.add_argument("old", help="Baseline results.")
+    parser.add_argument("new", help="New results.")
+    args = parser.parse_args()
+
+    old = load(args.old)
+    new = load(args.new)
+    regressions = 0
+
+    print("{:<40} {:>10} {:>10} {:>9}".format("name",
+                                               "old p50 ns",
+                                               "new p50 ns",
+                                               "change"))
+
+    for name in sorted(set(old) | set(new)):
+        if name not in old or name not in new:
+            print("{:<40} {:>10} {:>10} {:>9}".format(
+                name,
+                old.get(name, {}).get("p50_ns", "-"),
+                new.get(name, {}).get("p50_ns", "-"),
+                "-"))
+            continue
+
+        old_ns = old[name]["p50_ns"]
+        new_ns = new[name]["p50_ns"]
+
+        if old_ns > 0:
+            change = 100.0 * (new_ns - old_ns) / old_ns
+        else:
+            change = 0.0
+
+        if change > args.threshold:
+            marker = " <-- slower"
+            regressions += 1
+        elif change < -args.threshold:
+            marker = " <-- faster"
+        else:
+            marker = ""
+
+        print("{:<40} {:>10} {:>10} {:>+8.1f}%{}".format(name,
+                                                         old_ns,
+                                                         new_ns,
+                                                         change,
+                                                         marker))
+
+    sys.exit(1 if regressions > 0 else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -64,7 +64,7 @@ LDFLAGS += -Wl,-static \
 RUNARGS = $(BIN)
 
 ESPTOOL_PY = $(SIMBA_ROOT)/3pp/esp32/esp-idf/components/esptool_py/esptool/esptool.py
-UPGRADE_PY = $(SIMBA_ROOT)/bin/upgrade.py
+UPGRADE_BINARY_IMAGE = $(BIN)
 
 build: $(BIN) $(UBIN)
 
@@ -74,6 +74,6 @@ $(BIN): $(EXE)
 
 $(UBIN): $(BIN)
 	@echo "Creating $@"
-	$(UPGRADE_PY) -d $(UPGRADE_BINARY_DESCRIPTION) -o $@ $<
+	$(UPGRADE_PY) $(UPGRADE_PY_ARGS) -o $@ $<
 
 include $(SIMBA_ROOT)/make/gnu.mk
@@ -0,0 +1,260 @@
+#!/usr/bin/env python
+#
+# Convert the output of the trace module dump command,
+# /debug/trace/dump, to Chrome trace JSON. Open the result in
+# chrome://tracing or https://ui.perfetto.dev.
+#
+
+import sys
+import re
+import json
+import argparse
+
+
+THREAD_STATES = [
+    "current",
+    "ready",
+    "suspended",
+    "resumed",
+    "terminated"
+]
+
+PID = 1
+
+# Pseudo thread ids of tracks not belonging to a thread.
+TID_ISR = 1
+TID_LOCK = 2
+TID_TIMER = 3
+TID_UNKNOWN = 4
+TID_FIRST_THREAD = 5
+
+RE_HEADER = re.compile(r"trace: cycles_per_second=(\d+) events=(\d+)")
+RE_THREAD = re.compile(r"thread: (0x[0-9a-fA-F]+) (.*)")
+RE_EVENT = re.compile(r"event: (\d+) (\w+) (\d+) (0x[0-9a-fA-F]+)")
+
+
+class Decoder(object):
+
+    def __init__(self):
+        self.cycles_per_second = 1000000
+        self.thread_names = {}
+        self.thread_tids = {}
+        self.events = []
+        self.trace_events = []
+        self.current = None
+        self.switch_timestamp = None
+        self.lock_timestamp = None
+        self.isr_timestamps = {}
+
+    def parse(self, lines):
+        for line in lines:
+            line = line.strip()
+            mo = RE_HEADER.search(line)
+
+            if mo:
+                self.cycles_per_second = int(mo.group(1))
+                continue
+
+            mo = RE_THREAD.search(line)
+
+            if mo:
+                self.thread_names[int(mo.group(1), 16)] = mo.group(2)
+                continue
+
+            mo = RE_EVENT.search(line)
+
+            if mo:
+                self.events.append((int(mo.group(1)),
+                                    mo.group(2),
+                                    int(mo.group(3)),
+                                    int(mo.group(4), 16)))
+
+    def unwrap_timestamps(self):
+        """The cycle counter is 32 bits and wraps around. Assume less than
+        one wrap between two consecutive events.
+
+        """
+
+        timestamps = []
+        offset = 0
+        previous = None
+
+        for timestamp, _, _, _ in self.events:
+            if previous is not None and timestamp < previous:
+                offset += (1 << 32)
+
+            previous = timestamp
+            timestamps.append(timestamp + offset)
+
+        if timestamps:
+            first = timestamps[0]
+            timestamps = [1000000.0 * (timestamp - first) / self.cycles_per_second
+                          for timestamp in timestamps]
+
+        return timestamps
+
+    def tid(self, thread):
+        if thread not in self.thread_tids:
+            tid = TID_FIRST_THREAD + len(self.thread_tids)
+            self.thread_tids[thread] = tid
+            name = self.thread_names.get(thread, '0x{:08x}'.format(thread))
+            self.metadata(tid, name)
+
+        return self.thread_tids[thread]
+
+    def metadata(self, tid, name):
+        self.trace_events.append({
+            "name": "thread_name",
+            "ph": "M",
+            "pid": PID,
+            "tid": tid,
+            "args": {"name": name}
+        })
+
+    def complete(self, name, tid, begin, end, args=None):
+        event = {
+            "name": name,
+            "ph": "X",
+            "pid": PID,
+            "tid": tid,
+            "ts": begin,
+            "dur": end - begin
+        }
+
+        if args:
+            event["args"] = args
+
+        self.trace_events.append(event)
+
+    def instant(self, name, tid, timestamp, args=None):
+        event = {
+            "name": name,
+            "ph": "i",
+            "s": "t",
+            "pid": PID,
+            "tid": tid,
+            "ts": timestamp
+        }
+
+        if args:
+            event["args"] = args
+
+        self.trace_events.append(event)
+
+    def current_tid(self):
+        if self.current is None:
+            return TID_UNKNOWN
+
+        return self.tid(self.current)
+
+    def decode(self):
+        self.metadata(TID_ISR, "isr")
+        self.metadata(TID_LOCK, "sys_lock")
+        self.metadata(TID_TIMER, "timers")
+        self.metadata(TID_UNKNOWN, "unknown thread")
+
+        timestamps = self.unwrap_timestamps()
+
+        for timestamp, event in zip(timestamps, self.events):
+            _, kind, info, arg = event
+
+            if kind == "switch":
+                if self.current is not None:
+                    if info < len(THREAD_STATES):
+                        state = THREAD_STATES[info]
+                    else:
+                        state = str(info)
+
+                    self.complete("running",
+                                  self.tid(self.current),
+                                  self.switch_timestamp,
+                                  timestamp,
+                                  {"out_state": state})
+
+                self.current = arg
+                self.switch_timestamp = timestamp
+            elif kind == "resume":
+                self.instant("resume", self.tid(arg), timestamp)
+            elif kind == "suspend":
+                if arg == 0xffffffff:
+                    timeout = "forever"
+                else:
+                    timeout = "{} ms".format(arg)
+
+                self.instant("suspend",
+                             self.current_tid(),
+                             timestamp,
+                             {"timeout": timeout})
+            elif kind == "timer":
+                self.instant("timer",
+                             TID_TIMER,
+                             timestamp,
+                             {"callback": "0x{:08x}".format(arg)})
+            elif kind == "lock":
+                self.lock_timestamp = timestamp
+            elif kind == "unlock":
+                if self.lock_timestamp is not None:
+                    self.complete("locked",
+                                  TID_LOCK,
+                                  self.lock_timestamp,
+                                  timestamp)
+                    self.lock_timestamp = None
+            elif kind == "isr_enter":
+                self.isr_timestamps[info] = timestamp
+            elif kind == "isr_exit":
+                if info in self.isr_timestamps:
+                    self.complete("isr {}".format(info),
+                                  TID_ISR,
+                                  self.isr_timestamps.pop(info),
+                                  timestamp)
+            elif kind == "marker":
+                self.instant("marker {}".format(info),
+                             self.current_tid(),
+                             timestamp,
+                             {"value": arg})
+            else:
+                self.instant(kind,
+                             self.current_tid(),
+                             timestamp,
+                             {"object": "0x{:08x}".format(arg),
+                              "info": info})
+
+        if self.current is not None and timestamps:
+            self.complete("running",
+                          self.tid(self.current),
+                          self.switch_timestamp,
+                          timestamps[-1])
+
+        return {"traceEvents": self.trace_events,
+                "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert a Simba trace dump to Chrome trace JSON.')
+    parser.add_argument("infile",
+                        help="Output of /debug/trace/dump, or - for stdin.")
+    parser.add_argument("-o", "--outfile",
+                        help="Output file (default: stdout).")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+
+    if args.infile == "-":
+        decoder.parse(sys.stdin)
+    else:
+        with open(args.infile) as fin:
+            decoder.parse(fin)
+
+    trace = decoder.decode()
+
+    if args.outfile:
+        with open(args.outfile, "w") as fout:
+            json.dump(trace, fout)
+    else:
+        json.dump(trace, sys.stdout)
+        sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()
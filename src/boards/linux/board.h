@@ -67,6 +67,8 @@
 #define pin_dac0_dev pin_device[10]
 #define pin_dac1_dev pin_device[11]
 
+#define flash_0_dev flash_device[0]
+
 /**
  * Convert given pin string to the pin number.
  *
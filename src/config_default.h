@@ -41,6 +41,7 @@
 #define PORT_HAS_HX711
 #define PORT_HAS_GNSS
 #define PORT_HAS_HD44780
+#define PORT_HAS_CAPTURE
 
 /**
  * Used to include driver header files and the c-file source.
@@ -297,6 +298,15 @@
 #    define CONFIG_LINUX_SOCKET_DEVICE                      0
 #endif
 
+/**
+ * Use SocketCAN network interfaces as CAN devices on linux, instead
+ * of the socket device TCP bridge. Received frames are timestamped in
+ * microseconds, by hardware if supported by the interface.
+ */
+#ifndef CONFIG_LINUX_SOCKETCAN
+#    define CONFIG_LINUX_SOCKETCAN                          0
+#endif
+
 /**
  * Enable the adc driver.
  */
@@ -835,6 +845,17 @@
 #    endif
 #endif
 
+/**
+ * Enable the capture driver.
+ */
+#ifndef CONFIG_CAPTURE
+#    if defined(CONFIG_MINIMAL_SYSTEM) || !defined(PORT_HAS_CAPTURE)
+#        define CONFIG_CAPTURE                              0
+#    else
+#        define CONFIG_CAPTURE                              1
+#    endif
+#endif
+
 /**
  * GNSS driver debug log mask.
  */
@@ -951,6 +972,18 @@
 #    endif
 #endif
 
+/**
+ * Initialize the trace module at system startup. Only used if
+ * ``CONFIG_TRACE`` is set.
+ */
+#ifndef CONFIG_MODULE_INIT_TRACE
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_MODULE_INIT_TRACE                    0
+#    else
+#        define CONFIG_MODULE_INIT_TRACE                    1
+#    endif
+#endif
+
 /**
  * Initialize the chan module at system startup.
  */
@@ -1546,6 +1579,25 @@
 #    endif
 #endif
 
+/**
+ * Trace module debug file system commands.
+ */
+#ifndef CONFIG_TRACE_FS_COMMANDS
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO) || defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_TRACE_FS_COMMANDS                    0
+#    else
+#        define CONFIG_TRACE_FS_COMMANDS                    1
+#    endif
+#endif
+
+/**
+ * Flash device the upgrade module programs uploads into on Linux. An
+ * upload must fit in ``CONFIG_FLASH_LINUX_DEVICE_SIZE`` bytes.
+ */
+#ifndef CONFIG_UPGRADE_FLASH_DEVICE_INDEX
+#    define CONFIG_UPGRADE_FLASH_DEVICE_INDEX               0
+#endif
+
 /**
  * Debug file system command to enter the application.
  */
@@ -1574,6 +1626,32 @@
 #    define CONFIG_UPGRADE_FS_COMMAND_BOOTLOADER_ENTER      1
 #endif
 
+/**
+ * Size of the largest LZ window, as a power of two, accepted in an
+ * upgrade binary file. The upload path keeps a window of this size in
+ * RAM. Valid values are 8 to 12, or 0 to disable LZ decoding.
+ */
+#ifndef CONFIG_UPGRADE_LZ_WINDOW_BITS
+#    define CONFIG_UPGRADE_LZ_WINDOW_BITS                   10
+#endif
+
+/**
+ * Maximum number of ISO-TP consecutive frames written to the CAN
+ * driver in a single write by an ISO-TP session. The frames are
+ * allocated on the stack of the transmitting thread.
+ */
+#ifndef CONFIG_ISOTP_TX_FRAMES_MAX
+#    define CONFIG_ISOTP_TX_FRAMES_MAX                      8
+#endif
+
+/**
+ * Time in milliseconds an ISO-TP session waits for a flow control
+ * frame from the peer before the transmission is aborted.
+ */
+#ifndef CONFIG_ISOTP_TIMEOUT_MS
+#    define CONFIG_ISOTP_TIMEOUT_MS                         1000
+#endif
+
 /**
  * The maximum length of an absolute path in the file system.
  */
@@ -1743,6 +1821,33 @@
 #    define CONFIG_SETTINGS_BLOB                            1
 #endif
 
+/**
+ * Keep a copy of the settings area in RAM and index the settings by
+ * name. Reads are served from RAM, and writes are written to the
+ * non-volatile memory by ``settings_commit()`` or by the committer
+ * thread.
+ */
+#ifndef CONFIG_SETTINGS_CACHE
+#    define CONFIG_SETTINGS_CACHE                           0
+#endif
+
+/**
+ * Number of slots in the settings name index. Must be a power of
+ * two, and bigger than the number of settings for the index to be
+ * used.
+ */
+#ifndef CONFIG_SETTINGS_CACHE_INDEX_SIZE
+#    define CONFIG_SETTINGS_CACHE_INDEX_SIZE               32
+#endif
+
+/**
+ * Milliseconds from the latest settings write until the committer
+ * thread writes the modified settings to the non-volatile memory.
+ */
+#ifndef CONFIG_SETTINGS_CACHE_COMMIT_DELAY_MS
+#    define CONFIG_SETTINGS_CACHE_COMMIT_DELAY_MS         500
+#endif
+
 /**
  * Maximum number of characters in a shell command.
  */
@@ -1769,6 +1874,18 @@
 #    endif
 #endif
 
+/**
+ * Size of the shell input reader buffer. Input available in the
+ * input channel is read in chunks of up to this size.
+ */
+#ifndef CONFIG_SHELL_READER_BUFFER_SIZE
+#    if CONFIG_SHELL_MINIMAL == 1
+#        define CONFIG_SHELL_READER_BUFFER_SIZE                 4
+#    else
+#        define CONFIG_SHELL_READER_BUFFER_SIZE                32
+#    endif
+#endif
+
 /**
  * The shell prompt string.
  */
@@ -2020,7 +2137,8 @@
  * Non-volatile software EEPROM chunk size. Must be a power of two.
  */
 #ifndef CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE
-#    define CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE (CONFIG_NVM_SIZE + 8)
+#    define CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE                           \
+    (CONFIG_NVM_SIZE + 8 + CONFIG_EEPROM_SOFT_LOG_SIZE)
 #endif
 
 /**
@@ -2211,6 +2329,15 @@
 #    define CONFIG_RE_DEBUG_LOG_MASK                       -1
 #endif
 
+/**
+ * Compile suitable regular expression patterns to a bit-parallel
+ * automaton that matches in linear time, if the compiled buffer is big
+ * enough. Other patterns are matched by the backtracking interpreter.
+ */
+#ifndef CONFIG_RE_AUTOMATON
+#    define CONFIG_RE_AUTOMATON                             1
+#endif
+
 /**
  * Each thread has a list of environment variables associated with
  * it. A typical example of an environment variable is "CWD" - Current
@@ -2265,6 +2392,21 @@
 #    endif
 #endif
 
+/**
+ * Per thread scheduler statistics; number of voluntary and
+ * involuntary context switches, time spent ready but not running
+ * (with a latency histogram) and time spent blocked. The time is
+ * measured with the monotonic clock on Linux and derived from the
+ * system cycle counter on other ports.
+ */
+#ifndef CONFIG_THRD_SCHEDULER_STATISTICS
+#    if defined(CONFIG_MINIMAL_SYSTEM) || !defined(ARCH_LINUX)
+#        define CONFIG_THRD_SCHEDULER_STATISTICS            0
+#    else
+#        define CONFIG_THRD_SCHEDULER_STATISTICS            1
+#    endif
+#endif
+
 /**
  * Enable the thread stack heap allocator.
  */
@@ -2351,6 +2493,61 @@
 #    endif
 #endif
 
+/**
+ * Default number of warmup samples in a benchmark. Warmup samples are
+ * executed but not measured.
+ */
+#ifndef CONFIG_BENCHMARK_WARMUP
+#    define CONFIG_BENCHMARK_WARMUP                         2
+#endif
+
+/**
+ * Maximum, and default, number of measured samples in a benchmark.
+ */
+#ifndef CONFIG_BENCHMARK_SAMPLES_MAX
+#    define CONFIG_BENCHMARK_SAMPLES_MAX                   32
+#endif
+
+/**
+ * Default number of iterations per benchmark sample.
+ */
+#ifndef CONFIG_BENCHMARK_ITERATIONS
+#    define CONFIG_BENCHMARK_ITERATIONS                  1000
+#endif
+
+/**
+ * Number of 16 bits samples in an audio stream frame. Should be a
+ * multiple of 32 for frames to be completely filled by all decoders.
+ */
+#ifndef CONFIG_AUDIO_STREAM_FRAME_SAMPLES
+#    define CONFIG_AUDIO_STREAM_FRAME_SAMPLES             512
+#endif
+
+/**
+ * Use the SIMD instructions of the CPU, if any, in the DSP module;
+ * SSE2 on x86, NEON on ARM Cortex-A and the DSP extension on ARM
+ * Cortex-M4 and M7. The result is the same with and without SIMD.
+ *
+ * Enabled by default on x86 only. The NEON and DSP extension
+ * variants have not yet been verified on target.
+ */
+#ifndef CONFIG_DSP_SIMD
+#    if defined(__SSE2__)
+#        define CONFIG_DSP_SIMD                             1
+#    else
+#        define CONFIG_DSP_SIMD                             0
+#    endif
+#endif
+
+/**
+ * Number of samples processed at a time by the DSP module. Filters
+ * and oscillator banks use stack or state buffers of this many
+ * samples.
+ */
+#ifndef CONFIG_DSP_BLOCK_SIZE
+#    define CONFIG_DSP_BLOCK_SIZE                          64
+#endif
+
 /**
  * Sleep in the test harness before executing the first testcase.
  */
@@ -2386,12 +2583,29 @@
 
 /**
  * Size of the HTTP server request buffer. This buffer is used when
- * parsing received HTTP request headers.
+ * parsing received HTTP request headers, and buffers the start of the
+ * request body.
  */
 #ifndef CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE
 #    define CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE        128
 #endif
 
+/**
+ * Size of the streaming JSON reader buffer. The document available in
+ * the channel is read in chunks of up to this size.
+ */
+#ifndef CONFIG_JSON_READER_BUFFER_SIZE
+#    define CONFIG_JSON_READER_BUFFER_SIZE                 32
+#endif
+
+/**
+ * Size of the MQTT client transport reader buffer. Small messages
+ * available in the transport channel are read in one chunk.
+ */
+#ifndef CONFIG_MQTT_CLIENT_READER_BUFFER_SIZE
+#    define CONFIG_MQTT_CLIENT_READER_BUFFER_SIZE          64
+#endif
+
 /**
  * Use lookup tables for CRC calculations. It is faster, but uses more
  * memory.
@@ -2459,6 +2673,40 @@
 #    endif
 #endif
 
+/**
+ * Profile the system lock hold time per call site and the worst case
+ * system tick interrupt entry latency. Adds a cycle counter read to
+ * each ``sys_lock()`` and ``sys_unlock()`` call.
+ */
+#ifndef CONFIG_SYS_LOCK_PROFILE
+#    define CONFIG_SYS_LOCK_PROFILE                         0
+#endif
+
+/**
+ * Maximum number of system lock call sites in the lock profiler. Call
+ * sites that do not fit are accounted to a common entry with address
+ * zero.
+ */
+#ifndef CONFIG_SYS_LOCK_PROFILE_SITES_MAX
+#    define CONFIG_SYS_LOCK_PROFILE_SITES_MAX               32
+#endif
+
+/**
+ * Record scheduler, timer, interrupt and synchronization events in
+ * the trace module ring buffer. All trace hooks are removed by the
+ * preprocessor when this is zero.
+ */
+#ifndef CONFIG_TRACE
+#    define CONFIG_TRACE                                    0
+#endif
+
+/**
+ * Number of events in the trace ring buffer. Must be a power of two.
+ */
+#ifndef CONFIG_TRACE_EVENTS_MAX
+#    define CONFIG_TRACE_EVENTS_MAX                         256
+#endif
+
 /**
  * The external oscillator frequency in Hertz.
  */
@@ -2473,6 +2721,43 @@
 #    define CONFIG_FLASH_DEVICE_SEMAPHORE                   1
 #endif
 
+/**
+ * Size of each emulated flash device on Linux.
+ */
+#ifndef CONFIG_FLASH_LINUX_DEVICE_SIZE
+#    define CONFIG_FLASH_LINUX_DEVICE_SIZE                  16384
+#endif
+
+/**
+ * Emulated flash sector size on Linux. A sector is the smallest
+ * erasable unit.
+ */
+#ifndef CONFIG_FLASH_LINUX_SECTOR_SIZE
+#    define CONFIG_FLASH_LINUX_SECTOR_SIZE                  4096
+#endif
+
+/**
+ * Emulated flash page size on Linux. A page is the unit of
+ * programming latency.
+ */
+#ifndef CONFIG_FLASH_LINUX_PAGE_SIZE
+#    define CONFIG_FLASH_LINUX_PAGE_SIZE                    256
+#endif
+
+/**
+ * Emulated time in microseconds to erase one flash sector on Linux.
+ */
+#ifndef CONFIG_FLASH_LINUX_ERASE_SECTOR_US
+#    define CONFIG_FLASH_LINUX_ERASE_SECTOR_US              0
+#endif
+
+/**
+ * Emulated time in microseconds to program one flash page on Linux.
+ */
+#ifndef CONFIG_FLASH_LINUX_WRITE_PAGE_US
+#    define CONFIG_FLASH_LINUX_WRITE_PAGE_US                0
+#endif
+
 /**
  * Semaphore protected software eeprom accesses.
  */
@@ -2490,6 +2775,17 @@
 #    define CONFIG_EEPROM_SOFT_CRC  CONFIG_EEPROM_SOFT_CRC_32
 #endif
 
+/**
+ * Size in bytes of the record log at the end of each software eeprom
+ * chunk. Small writes are appended to the log as records instead of
+ * rewriting the whole chunk, and the chunk is compacted into a new
+ * chunk when the log is full. Set to zero(0) to rewrite the chunk on
+ * every write. Must be a multiple of 8.
+ */
+#ifndef CONFIG_EEPROM_SOFT_LOG_SIZE
+#    define CONFIG_EEPROM_SOFT_LOG_SIZE                     0
+#endif
+
 /**
  * Configuration validation.
  */
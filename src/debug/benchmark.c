@@ -0,0 +1,237 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static uint32_t cycles_to_ns(uint64_t cycles, uint32_t divisor)
+{
+    return ((cycles * 1000000000ull)
+            / ((uint64_t)sys_get_cycles_per_second() * divisor));
+}
+
+static void sort(uint32_t *values_p, int length)
+{
+    int i;
+    int j;
+    uint32_t value;
+
+    for (i = 1; i < length; i++) {
+        value = values_p[i];
+
+        for (j = i; (j > 0) && (values_p[j - 1] > value); j--) {
+            values_p[j] = values_p[j - 1];
+        }
+
+        values_p[j] = value;
+    }
+}
+
+/**
+ * Nearest rank percentile of given sorted samples.
+ */
+static uint32_t percentile(uint32_t *values_p, int length, int percent)
+{
+    int index;
+
+    index = DIV_CEIL(percent * length, 100) - 1;
+
+    if (index < 0) {
+        index = 0;
+    }
+
+    return (values_p[index]);
+}
+
+static void print_result(struct benchmark_t *self_p,
+                         const char *name_p)
+{
+    uint64_t total;
+    uint32_t operations;
+    int i;
+
+    total = 0;
+
+    for (i = 0; i < self_p->samples; i++) {
+        total += self_p->cycles[i];
+    }
+
+    if (total == 0) {
+        total = 1;
+    }
+
+    operations = (self_p->samples * self_p->iterations);
+    sort(&self_p->cycles[0], self_p->samples);
+
+    std_printf(OSTR("benchmark: {\"name\": \"%s\", "
+                    "\"operations\": %lu, "
+                    "\"ns_per_op\": %lu, "
+                    "\"ops_per_second\": %lu, "
+                    "\"min_ns\": %lu, "
+                    "\"p50_ns\": %lu, "
+                    "\"p90_ns\": %lu, "
+                    "\"p99_ns\": %lu, "
+                    "\"max_ns\": %lu}\r\n"),
+               name_p,
+               (unsigned long)operations,
+               (unsigned long)cycles_to_ns(total, operations),
+               (unsigned long)(((uint64_t)operations
+                                * sys_get_cycles_per_second()) / total),
+               (unsigned long)cycles_to_ns(self_p->cycles[0],
+                                           self_p->iterations),
+               (unsigned long)cycles_to_ns(percentile(&self_p->cycles[0],
+                                                      self_p->samples,
+                                                      50),
+                                           self_p->iterations),
+               (unsigned long)cycles_to_ns(percentile(&self_p->cycles[0],
+                                                      self_p->samples,
+                                                      90),
+                                           self_p->iterations),
+               (unsigned long)cycles_to_ns(percentile(&self_p->cycles[0],
+                                                      self_p->samples,
+                                                      99),
+                                           self_p->iterations),
+               (unsigned long)cycles_to_ns(self_p->cycles[self_p->samples - 1],
+                                           self_p->iterations));
+}
+
+int benchmark_init(struct benchmark_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->warmup = CONFIG_BENCHMARK_WARMUP;
+    self_p->samples = CONFIG_BENCHMARK_SAMPLES_MAX;
+    self_p->iterations = CONFIG_BENCHMARK_ITERATIONS;
+    self_p->sample = 0;
+
+    return (0);
+}
+
+int benchmark_run(struct benchmark_t *self_p,
+                  struct benchmark_case_t *cases_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(cases_p != NULL, EINVAL);
+
+    int err;
+    int total, passed, failed, skipped;
+
+    total = 0;
+    passed = 0;
+    failed = 0;
+    skipped = 0;
+
+#if !defined(ARCH_LINUX)
+    thrd_sleep_ms(CONFIG_HARNESS_SLEEP_MS);
+#endif
+
+    std_printf(OSTR("\r\n"));
+    std_printf(OSTR("=============================== BENCHMARK BEGIN ================================\r\n\r\n"));
+    std_printf(sys_get_info());
+    std_printf(OSTR("\r\n"));
+
+    while (cases_p->callback != NULL) {
+        benchmark_init(self_p);
+
+        std_printf(OSTR("enter: %s\r\n"), cases_p->name_p);
+
+        err = cases_p->callback(self_p);
+
+        /* All samples must have been measured. */
+        if ((err == 0)
+            && (self_p->sample != self_p->warmup + self_p->samples)) {
+            std_printf(OSTR("No BENCHMARK() loop executed.\r\n"));
+            err = -1;
+        }
+
+        if (err < 0) {
+            failed++;
+            std_printf(OSTR("exit: %s: FAILED\r\n\r\n"), cases_p->name_p);
+        } else if (err == 0) {
+            passed++;
+            print_result(self_p, cases_p->name_p);
+            std_printf(OSTR("exit: %s: PASSED\r\n\r\n"), cases_p->name_p);
+        } else {
+            skipped++;
+            std_printf(OSTR("exit: %s: SKIPPED\r\n\r\n"), cases_p->name_p);
+        }
+
+        total++;
+        cases_p++;
+    }
+
+    std_printf(OSTR("benchmark report: total(%d), passed(%d), "
+                    "failed(%d), skipped(%d)\r\n\r\n"),
+               total, passed, failed, skipped);
+
+    std_printf(OSTR("================================ BENCHMARK END (%s) ============================\r\n\r\n"),
+               ((passed + skipped) == total ? "PASSED" : "FAILED"));
+
+    sys_stop(failed);
+
+    return (0);
+}
+
+void benchmark_sample_begin(struct benchmark_t *self_p)
+{
+    if (self_p->samples > CONFIG_BENCHMARK_SAMPLES_MAX) {
+        self_p->samples = CONFIG_BENCHMARK_SAMPLES_MAX;
+    }
+
+    if (self_p->samples < 1) {
+        self_p->samples = 1;
+    }
+
+    if (self_p->iterations < 1) {
+        self_p->iterations = 1;
+    }
+
+    self_p->sample = -1;
+}
+
+int benchmark_sample_next(struct benchmark_t *self_p)
+{
+    uint32_t now;
+
+    now = sys_get_cycles();
+
+    if (self_p->sample >= self_p->warmup) {
+        self_p->cycles[self_p->sample - self_p->warmup] = (now - self_p->start);
+    }
+
+    self_p->sample++;
+
+    if (self_p->sample == self_p->warmup + self_p->samples) {
+        return (0);
+    }
+
+    self_p->start = sys_get_cycles();
+
+    return (1);
+}
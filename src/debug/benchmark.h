@@ -0,0 +1,139 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DEBUG_BENCHMARK_H__
+#define __DEBUG_BENCHMARK_H__
+
+#include "simba.h"
+
+/**
+ * Execute the following statement or block repeatedly and measure
+ * its execution time. The block is executed ``iterations`` times per
+ * sample, for ``warmup`` + ``samples`` samples.
+ *
+ * .. code-block:: c
+ *
+ *    BENCHMARK(benchmark_p) {
+ *        queue_write(&queue, &value, sizeof(value));
+ *        queue_read(&queue, &value, sizeof(value));
+ *    }
+ *
+ * A benchmark function should only contain one ``BENCHMARK()``
+ * loop. Setup and teardown code outside the loop is not measured.
+ */
+#define BENCHMARK(benchmark_p)                                          \
+    for (benchmark_sample_begin(benchmark_p);                           \
+         benchmark_sample_next(benchmark_p) == 1;)                      \
+        for ((benchmark_p)->iteration = 0;                              \
+             (benchmark_p)->iteration < (benchmark_p)->iterations;      \
+             (benchmark_p)->iteration++)
+
+struct benchmark_t;
+
+/**
+ * The benchmark function callback.
+ *
+ * @param[in] benchmark_p The benchmark object.
+ *
+ * @return zero(0) if the benchmark was executed, a negative error
+ *         code if the benchmark failed, and a positive value if the
+ *         benchmark was skipped.
+ */
+typedef int (*benchmark_cb_t)(struct benchmark_t *benchmark_p);
+
+struct benchmark_case_t {
+    benchmark_cb_t callback;
+    const char *name_p;
+};
+
+struct benchmark_t {
+    /** Number of unmeasured samples. May be changed by the benchmark
+        callback before the ``BENCHMARK()`` loop. */
+    int warmup;
+    /** Number of measured samples, at most
+        ``CONFIG_BENCHMARK_SAMPLES_MAX``. */
+    int samples;
+    /** Number of iterations per sample. */
+    int iterations;
+    /** Current iteration in the current sample. */
+    int iteration;
+    int sample;
+    uint32_t start;
+    uint32_t cycles[CONFIG_BENCHMARK_SAMPLES_MAX];
+};
+
+/**
+ * Initialize given benchmark harness.
+ *
+ * @param[in] self_p Benchmark harness to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int benchmark_init(struct benchmark_t *self_p);
+
+/**
+ * Run given benchmarks and write one result line per benchmark to
+ * standard output. Each result line starts with ``benchmark:`` and
+ * is followed by a JSON object with the keys ``name``,
+ * ``operations``, ``ns_per_op``, ``ops_per_second``, ``min_ns``,
+ * ``p50_ns``, ``p90_ns``, ``p99_ns`` and ``max_ns``. The percentiles
+ * are of the mean time per operation in each sample.
+ *
+ * @param[in] self_p Benchmark harness.
+ * @param[in] cases_p An array of benchmarks to run. The last element
+ *                    in the array must have ``callback`` and
+ *                    ``name_p`` set to NULL.
+ *
+ * @return zero(0) or negative error code.
+ */
+int benchmark_run(struct benchmark_t *self_p,
+                  struct benchmark_case_t *cases_p);
+
+/**
+ * Start a benchmark loop. Used by the ``BENCHMARK()`` macro.
+ *
+ * @param[in] self_p Benchmark harness.
+ *
+ * @return void
+ */
+void benchmark_sample_begin(struct benchmark_t *self_p);
+
+/**
+ * End the current sample and start the next one, if any. Used by the
+ * ``BENCHMARK()`` macro.
+ *
+ * @param[in] self_p Benchmark harness.
+ *
+ * @return true(1) if another sample should be executed, otherwise
+ *         false(0).
+ */
+int benchmark_sample_next(struct benchmark_t *self_p);
+
+#endif
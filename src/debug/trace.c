@@ -0,0 +1,291 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_TRACE == 1
+
+#if (CONFIG_TRACE_EVENTS_MAX & (CONFIG_TRACE_EVENTS_MAX - 1)) != 0
+#    error "CONFIG_TRACE_EVENTS_MAX must be a power of two."
+#endif
+
+struct module_t {
+    int8_t initialized;
+    int8_t enabled;
+    int mask;
+    /* Total number of written events. The ring buffer index is the
+       least significant bits. */
+    uint32_t head;
+    struct trace_event_t events[CONFIG_TRACE_EVENTS_MAX];
+#if CONFIG_TRACE_FS_COMMANDS == 1
+    struct fs_command_t cmd_start;
+    struct fs_command_t cmd_stop;
+    struct fs_command_t cmd_dump;
+#endif
+};
+
+static FAR const char type_switch[] = "switch";
+static FAR const char type_resume[] = "resume";
+static FAR const char type_suspend[] = "suspend";
+static FAR const char type_timer[] = "timer";
+static FAR const char type_lock[] = "lock";
+static FAR const char type_unlock[] = "unlock";
+static FAR const char type_isr_enter[] = "isr_enter";
+static FAR const char type_isr_exit[] = "isr_exit";
+static FAR const char type_sem_take[] = "sem_take";
+static FAR const char type_sem_give[] = "sem_give";
+static FAR const char type_mutex_lock[] = "mutex_lock";
+static FAR const char type_mutex_unlock[] = "mutex_unlock";
+static FAR const char type_marker[] = "marker";
+
+/* Event type strings array. */
+static const char FAR *type_as_string[] = {
+    type_switch,
+    type_resume,
+    type_suspend,
+    type_timer,
+    type_lock,
+    type_unlock,
+    type_isr_enter,
+    type_isr_exit,
+    type_sem_take,
+    type_sem_give,
+    type_mutex_lock,
+    type_mutex_unlock,
+    type_marker
+};
+
+/* The module state. */
+static struct module_t module = {
+    .mask = TRACE_ALL
+};
+
+#if CONFIG_TRACE_FS_COMMANDS == 1
+
+/**
+ * The shell command callback for "/debug/trace/start".
+ */
+static int cmd_start_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (trace_start());
+}
+
+/**
+ * The shell command callback for "/debug/trace/stop".
+ */
+static int cmd_stop_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (trace_stop());
+}
+
+/**
+ * The shell command callback for "/debug/trace/dump".
+ */
+static int cmd_dump_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (trace_dump(out_p));
+}
+
+#endif
+
+int trace_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#if CONFIG_TRACE_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_start,
+                    CSTR("/debug/trace/start"),
+                    cmd_start_cb,
+                    NULL);
+    fs_command_register(&module.cmd_start);
+
+    fs_command_init(&module.cmd_stop,
+                    CSTR("/debug/trace/stop"),
+                    cmd_stop_cb,
+                    NULL);
+    fs_command_register(&module.cmd_stop);
+
+    fs_command_init(&module.cmd_dump,
+                    CSTR("/debug/trace/dump"),
+                    cmd_dump_cb,
+                    NULL);
+    fs_command_register(&module.cmd_dump);
+#endif
+
+    return (0);
+}
+
+int trace_start(void)
+{
+    module.enabled = 0;
+    module.head = 0;
+    module.enabled = 1;
+
+    return (0);
+}
+
+int trace_stop(void)
+{
+    module.enabled = 0;
+
+    return (0);
+}
+
+int trace_set_mask(int mask)
+{
+    int old;
+
+    old = module.mask;
+    module.mask = mask;
+
+    return (old);
+}
+
+void RAM_CODE trace_write(int type, int info, uint32_t arg)
+{
+    struct trace_event_t *event_p;
+    uint32_t index;
+
+    if ((module.enabled == 0) || ((module.mask & (1 << type)) == 0)) {
+        return;
+    }
+
+    /* Reserve a slot. An interrupt or another thread writing an event
+       in between gets the next slot. */
+    index = __atomic_fetch_add(&module.head, 1, __ATOMIC_RELAXED);
+    event_p = &module.events[index & (CONFIG_TRACE_EVENTS_MAX - 1)];
+    event_p->timestamp = sys_get_cycles();
+    event_p->type = type;
+    event_p->reserved = 0;
+    event_p->info = info;
+    event_p->arg = arg;
+}
+
+void trace_marker(int id, uint32_t value)
+{
+    trace_write(TRACE_MARKER, id, value);
+}
+
+ssize_t trace_read(struct trace_event_t *events_p, size_t length)
+{
+    ASSERTN(events_p != NULL, EINVAL);
+
+    uint32_t head;
+    uint32_t index;
+    size_t i;
+
+    head = module.head;
+
+    if (head > CONFIG_TRACE_EVENTS_MAX) {
+        index = (head - CONFIG_TRACE_EVENTS_MAX);
+    } else {
+        index = 0;
+    }
+
+    for (i = 0; (i < length) && (index != head); i++, index++) {
+        events_p[i] = module.events[index & (CONFIG_TRACE_EVENTS_MAX - 1)];
+    }
+
+    return (i);
+}
+
+int trace_dump(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct trace_event_t event;
+    struct thrd_t *thrd_p;
+    int8_t enabled;
+    uint32_t head;
+    uint32_t index;
+
+    enabled = module.enabled;
+    module.enabled = 0;
+    head = module.head;
+
+    if (head > CONFIG_TRACE_EVENTS_MAX) {
+        index = (head - CONFIG_TRACE_EVENTS_MAX);
+    } else {
+        index = 0;
+    }
+
+    std_fprintf(chan_p,
+                OSTR("trace: cycles_per_second=%lu events=%lu written=%lu\r\n"),
+                (unsigned long)sys_get_cycles_per_second(),
+                (unsigned long)(head - index),
+                (unsigned long)head);
+
+    thrd_p = thrd_get_next(NULL);
+
+    while (thrd_p != NULL) {
+        std_fprintf(chan_p,
+                    OSTR("thread: 0x%08lx %s\r\n"),
+                    (unsigned long)(uint32_t)(uintptr_t)thrd_p,
+                    thrd_p->name_p);
+        thrd_p = thrd_get_next(thrd_p);
+    }
+
+    while (index != head) {
+        event = module.events[index & (CONFIG_TRACE_EVENTS_MAX - 1)];
+        std_fprintf(chan_p,
+                    OSTR("event: %lu %s %u 0x%08lx\r\n"),
+                    (unsigned long)event.timestamp,
+                    type_as_string[event.type],
+                    (unsigned int)event.info,
+                    (unsigned long)event.arg);
+        index++;
+    }
+
+    module.enabled = enabled;
+
+    return (0);
+}
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DEBUG_TRACE_H__
+#define __DEBUG_TRACE_H__
+
+#include "simba.h"
+
+/* Event types. */
+
+/** A context switch. Info is the state of the thread that was
+    swapped out and argument is the thread swapped in. */
+#define TRACE_SWITCH                 0
+/** A thread was resumed. Argument is the resumed thread. */
+#define TRACE_RESUME                 1
+/** The current thread suspended itself. Argument is the timeout in
+    milliseconds, or -1 for no timeout. */
+#define TRACE_SUSPEND                2
+/** A timer expired. Argument is the timer callback. */
+#define TRACE_TIMER                  3
+/** The system lock was taken. */
+#define TRACE_LOCK                   4
+/** The system lock was released. */
+#define TRACE_UNLOCK                 5
+/** Interrupt service routine entry. Info is the interrupt number. */
+#define TRACE_ISR_ENTER              6
+/** Interrupt service routine exit. Info is the interrupt number. */
+#define TRACE_ISR_EXIT               7
+/** A semaphore was taken. Argument is the semaphore. */
+#define TRACE_SEM_TAKE               8
+/** A semaphore was given. Argument is the semaphore. */
+#define TRACE_SEM_GIVE               9
+/** A mutex was locked. Argument is the mutex. */
+#define TRACE_MUTEX_LOCK            10
+/** A mutex was unlocked. Argument is the mutex. */
+#define TRACE_MUTEX_UNLOCK          11
+/** A user marker. Info and argument are user defined. */
+#define TRACE_MARKER                12
+
+/** Number of event types. */
+#define TRACE_MAX                   13
+
+/** Interrupt number of the system tick interrupt. */
+#define TRACE_ISR_SYS_TICK           0
+
+/** Create an event mask with given event type set. */
+#define TRACE_MASK(type) (1 << (TRACE_ ## type))
+
+/** Set all event types. */
+#define TRACE_ALL        ((1 << TRACE_MAX) - 1)
+
+/**
+ * Record an event of given type. Expands to nothing if
+ * ``CONFIG_TRACE`` is zero, so the arguments are not evaluated in
+ * that case.
+ */
+#if CONFIG_TRACE == 1
+#    define TRACE_EVENT(type, info, arg)                        \
+    trace_write(TRACE_ ## type, info, (uint32_t)(uintptr_t)(arg))
+#else
+#    define TRACE_EVENT(type, info, arg)
+#endif
+
+/**
+ * A trace event. Thread, semaphore and mutex arguments are stored as
+ * the 32 least significant bits of their addresses.
+ */
+struct trace_event_t {
+    uint32_t timestamp;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t info;
+    uint32_t arg;
+};
+
+/**
+ * Initialize the trace module. This function must be called before
+ * calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_module_init(void);
+
+/**
+ * Clear the ring buffer and start recording events.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_start(void);
+
+/**
+ * Stop recording events. Recorded events are kept until the next
+ * call to `trace_start()`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_stop(void);
+
+/**
+ * Only record event types in given mask. All event types are
+ * recorded by default.
+ *
+ * @param[in] mask Event type mask, for example ``TRACE_MASK(SWITCH) |
+ *                 TRACE_MASK(RESUME)``.
+ *
+ * @return Old mask.
+ */
+int trace_set_mask(int mask);
+
+/**
+ * Record an event in the ring buffer. The oldest event is
+ * overwritten if the buffer is full. This function does not take the
+ * system lock and may be called from any context.
+ *
+ * @param[in] type Event type.
+ * @param[in] info Event type specific 16 bits value.
+ * @param[in] arg Event type specific 32 bits value.
+ *
+ * @return void
+ */
+void trace_write(int type, int info, uint32_t arg);
+
+/**
+ * Record a user marker.
+ *
+ * @param[in] id Marker identifier.
+ * @param[in] value Marker value.
+ *
+ * @return void
+ */
+void trace_marker(int id, uint32_t value);
+
+/**
+ * Copy recorded events, oldest first, to given buffer. Recording
+ * should be stopped when calling this function.
+ *
+ * @param[out] events_p Buffer to copy events to.
+ * @param[in] length Maximum number of events to copy.
+ *
+ * @return Number of copied events or negative error code.
+ */
+ssize_t trace_read(struct trace_event_t *events_p, size_t length);
+
+/**
+ * Write all recorded events and the names of all threads in text
+ * format to given channel. Recording is stopped during the dump. The
+ * output is converted to Chrome trace JSON by
+ * ``make/tracedecoder.py``.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_dump(void *chan_p);
+
+#endif
@@ -0,0 +1,487 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_CAPTURE == 1
+
+/**
+ * Load eight samples, the first sample in the least significant
+ * byte.
+ */
+static uint64_t load_samples(const uint8_t *buf_p)
+{
+    uint64_t value;
+    int i;
+
+    value = 0;
+
+    for (i = 7; i >= 0; i--) {
+        value <<= 8;
+        value |= buf_p[i];
+    }
+
+    return (value);
+}
+
+/**
+ * Transpose given 8x8 bit matrix, one row per byte. Bit N in byte M
+ * of the result is bit M in byte N of given matrix.
+ */
+static uint64_t transpose_8x8(uint64_t value)
+{
+    uint64_t t;
+
+    t = ((value ^ (value >> 7)) & 0x00aa00aa00aa00aaull);
+    value ^= (t ^ (t << 7));
+    t = ((value ^ (value >> 14)) & 0x0000cccc0000ccccull);
+    value ^= (t ^ (t << 14));
+    t = ((value ^ (value >> 28)) & 0x00000000f0f0f0f0ull);
+    value ^= (t ^ (t << 28));
+
+    return (value);
+}
+
+static int popcount(uint64_t value)
+{
+    return (__builtin_popcountll(value));
+}
+
+/**
+ * Split a block of samples into one bit plane per channel. Bit N in
+ * a plane is sample N of the channel.
+ */
+static void split_block(const uint8_t *samples_p,
+                        uint64_t *planes_p,
+                        int number_of_channels)
+{
+    uint64_t value;
+    int group;
+    int channel;
+
+    for (channel = 0; channel < number_of_channels; channel++) {
+        planes_p[channel] = 0;
+    }
+
+    for (group = 0; group < CAPTURE_BLOCK_SIZE / 8; group++) {
+        value = transpose_8x8(load_samples(&samples_p[8 * group]));
+
+        for (channel = 0; channel < number_of_channels; channel++) {
+            planes_p[channel] |= (((value >> (8 * channel)) & 0xff)
+                                  << (8 * group));
+        }
+    }
+}
+
+/**
+ * Write the current report to the report queue, unless the queue is
+ * full, and start a new report.
+ */
+static void write_report(struct capture_driver_t *self_p)
+{
+    struct capture_report_t *report_p;
+    uint32_t overruns;
+
+    report_p = &self_p->analysis.report;
+    overruns = __atomic_load_n(&self_p->ring.overruns, __ATOMIC_RELAXED);
+    report_p->overruns = (overruns - self_p->analysis.overruns);
+    self_p->analysis.overruns = overruns;
+
+    if (spsc_queue_unused_size(&self_p->reports.queue) >= sizeof(*report_p)) {
+        spsc_queue_write(&self_p->reports.queue, report_p, sizeof(*report_p));
+    }
+
+    memset(report_p, 0, sizeof(*report_p));
+}
+
+/**
+ * Add the high samples and edges of the samples in given mask to the
+ * current report.
+ */
+static void count(struct capture_driver_t *self_p,
+                  const uint64_t *planes_p,
+                  const uint64_t *delayed_p,
+                  uint64_t mask)
+{
+    struct capture_channel_report_t *channel_p;
+    int i;
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        channel_p = &self_p->analysis.report.channels[i];
+        channel_p->high += popcount(planes_p[i] & mask);
+        channel_p->rising_edges += popcount(planes_p[i]
+                                            & ~delayed_p[i]
+                                            & mask);
+        channel_p->falling_edges += popcount(~planes_p[i]
+                                             & delayed_p[i]
+                                             & mask);
+    }
+
+    self_p->analysis.report.number_of_samples += popcount(mask);
+}
+
+/**
+ * Count high samples and edges of all channels in given block of
+ * samples. A report period ends at most once per block.
+ */
+static void analyze_block(struct capture_driver_t *self_p,
+                          const uint8_t *samples_p)
+{
+    uint64_t planes[CAPTURE_CHANNELS_MAX];
+    uint64_t delayed[CAPTURE_CHANNELS_MAX];
+    uint64_t mask;
+    uint32_t left;
+    int i;
+
+    /* The first sample has no edge. */
+    if (!self_p->analysis.started) {
+        self_p->analysis.previous = samples_p[0];
+        self_p->analysis.started = 1;
+    }
+
+    split_block(samples_p, &planes[0], self_p->number_of_channels);
+
+    /* Bit N is sample N - 1. */
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        delayed[i] = ((planes[i] << 1)
+                      | ((self_p->analysis.previous >> i) & 1));
+    }
+
+    self_p->analysis.previous = samples_p[CAPTURE_BLOCK_SIZE - 1];
+    left = (self_p->analysis.samples_per_report
+            - self_p->analysis.report.number_of_samples);
+
+    if (left > CAPTURE_BLOCK_SIZE) {
+        count(self_p, &planes[0], &delayed[0], ~0ull);
+    } else if (left == CAPTURE_BLOCK_SIZE) {
+        count(self_p, &planes[0], &delayed[0], ~0ull);
+        write_report(self_p);
+    } else {
+        mask = ((1ull << left) - 1);
+        count(self_p, &planes[0], &delayed[0], mask);
+        write_report(self_p);
+        count(self_p, &planes[0], &delayed[0], ~mask);
+    }
+}
+
+/**
+ * Discard all samples in the ring buffer and the current report. May
+ * only be called by the consumer of the ring buffer.
+ */
+static void reset(struct capture_driver_t *self_p)
+{
+    __atomic_store_n(&self_p->ring.tail,
+                     __atomic_load_n(&self_p->ring.head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+    self_p->analysis.started = 0;
+    self_p->analysis.overruns = __atomic_load_n(&self_p->ring.overruns,
+                                                __ATOMIC_RELAXED);
+    memset(&self_p->analysis.report, 0, sizeof(self_p->analysis.report));
+}
+
+static void *worker_main(struct capture_driver_t *self_p)
+{
+    thrd_set_name("capture");
+
+    while (1) {
+        sem_take(&self_p->sem, NULL);
+
+        if (__atomic_load_n(&self_p->stop.requested, __ATOMIC_ACQUIRE)) {
+            reset(self_p);
+            __atomic_store_n(&self_p->stop.requested, 0, __ATOMIC_RELEASE);
+            sem_give(&self_p->stop.sem, 1);
+        } else {
+            capture_analyze(self_p);
+        }
+    }
+
+    return (NULL);
+}
+
+int capture_init(struct capture_driver_t *self_p,
+                 capture_read_t read,
+                 void *arg_p,
+                 int number_of_channels,
+                 long sampling_rate,
+                 void *buf_p,
+                 size_t size,
+                 uint32_t samples_per_report)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(read != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    if ((number_of_channels < 1)
+        || (number_of_channels > CAPTURE_CHANNELS_MAX)
+        || (sampling_rate < 0)
+        || (size < CAPTURE_BLOCK_SIZE)
+        || ((size & (size - 1)) != 0)
+        || (samples_per_report < CAPTURE_BLOCK_SIZE)) {
+        return (-EINVAL);
+    }
+
+    self_p->read = read;
+    self_p->arg_p = arg_p;
+    self_p->number_of_channels = number_of_channels;
+    self_p->sampling_rate = sampling_rate;
+    self_p->ring.buf_p = buf_p;
+    self_p->ring.mask = (size - 1);
+    self_p->ring.head = 0;
+    self_p->ring.tail = 0;
+    self_p->ring.overruns = 0;
+    self_p->analysis.started = 0;
+    self_p->analysis.previous = 0;
+    self_p->analysis.samples_per_report = samples_per_report;
+    self_p->analysis.overruns = 0;
+    memset(&self_p->analysis.report, 0, sizeof(self_p->analysis.report));
+    spsc_queue_init(&self_p->reports.queue,
+                    &self_p->reports.buf[0],
+                    sizeof(self_p->reports.buf));
+    self_p->stop.requested = 0;
+    sem_init(&self_p->stop.sem, 1, 1);
+    sem_init(&self_p->sem, 1, 1);
+    self_p->thrd_p = NULL;
+
+    return (0);
+}
+
+int capture_start(struct capture_driver_t *self_p,
+                  void *stack_p,
+                  size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+    struct time_t timeout;
+
+    if (self_p->thrd_p == NULL) {
+        self_p->thrd_p = thrd_spawn((void *(*)(void *))worker_main,
+                                    self_p,
+                                    0,
+                                    stack_p,
+                                    stack_size);
+
+        if (self_p->thrd_p == NULL) {
+            return (-1);
+        }
+    }
+
+    if (self_p->sampling_rate > 0) {
+        timeout.seconds = (1 / self_p->sampling_rate);
+        timeout.nanoseconds = ((1000000000L / self_p->sampling_rate)
+                               % 1000000000L);
+        timer_init(&self_p->timer,
+                   &timeout,
+                   (void (*)(void *))capture_sample_isr,
+                   self_p,
+                   TIMER_PERIODIC);
+        timer_start(&self_p->timer);
+    }
+
+    return (0);
+}
+
+int capture_stop(struct capture_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct capture_report_t report;
+
+    if (self_p->sampling_rate > 0) {
+        timer_stop(&self_p->timer);
+    }
+
+    /* The worker thread is the consumer of the ring buffer, so let it
+       discard the samples. */
+    if (self_p->thrd_p != NULL) {
+        __atomic_store_n(&self_p->stop.requested, 1, __ATOMIC_RELEASE);
+        sem_give(&self_p->sem, 1);
+        sem_take(&self_p->stop.sem, NULL);
+    } else {
+        reset(self_p);
+    }
+
+    while (spsc_queue_size(&self_p->reports.queue) > 0) {
+        spsc_queue_read(&self_p->reports.queue, &report, sizeof(report));
+    }
+
+    return (0);
+}
+
+RAM_CODE void capture_sample_isr(struct capture_driver_t *self_p)
+{
+    size_t head;
+    size_t tail;
+
+    head = self_p->ring.head;
+    tail = __atomic_load_n(&self_p->ring.tail, __ATOMIC_ACQUIRE);
+
+    if ((head - tail) > self_p->ring.mask) {
+        self_p->ring.overruns++;
+
+        return;
+    }
+
+    self_p->ring.buf_p[head & self_p->ring.mask] =
+        self_p->read(self_p->arg_p);
+    head++;
+    __atomic_store_n(&self_p->ring.head, head, __ATOMIC_RELEASE);
+
+    /* Wake the worker thread once per block. */
+    if ((head % CAPTURE_BLOCK_SIZE) == 0) {
+        sem_give_isr(&self_p->sem, 1);
+    }
+}
+
+size_t capture_analyze(struct capture_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint8_t block[CAPTURE_BLOCK_SIZE];
+    uint8_t *block_p;
+    size_t head;
+    size_t tail;
+    size_t offset;
+    size_t size;
+    size_t analyzed;
+
+    tail = self_p->ring.tail;
+    analyzed = 0;
+
+    while (1) {
+        head = __atomic_load_n(&self_p->ring.head, __ATOMIC_ACQUIRE);
+
+        if ((head - tail) < CAPTURE_BLOCK_SIZE) {
+            break;
+        }
+
+        /* Blocks are only aligned in the ring buffer until samples
+           are lost or discarded. */
+        offset = (tail & self_p->ring.mask);
+        block_p = &self_p->ring.buf_p[offset];
+        size = (self_p->ring.mask + 1 - offset);
+
+        if (size < CAPTURE_BLOCK_SIZE) {
+            memcpy(&block[0], block_p, size);
+            memcpy(&block[size],
+                   &self_p->ring.buf_p[0],
+                   CAPTURE_BLOCK_SIZE - size);
+            block_p = &block[0];
+        }
+
+        analyze_block(self_p, block_p);
+        tail += CAPTURE_BLOCK_SIZE;
+        __atomic_store_n(&self_p->ring.tail, tail, __ATOMIC_RELEASE);
+        analyzed += CAPTURE_BLOCK_SIZE;
+    }
+
+    return (analyzed);
+}
+
+int capture_read_report(struct capture_driver_t *self_p,
+                        struct capture_report_t *report_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(report_p != NULL, EINVAL);
+
+    spsc_queue_read(&self_p->reports.queue, report_p, sizeof(*report_p));
+
+    return (0);
+}
+
+int capture_pwm_source_init(struct capture_pwm_source_t *self_p,
+                            int number_of_channels)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+
+    if ((number_of_channels < 1)
+        || (number_of_channels > CAPTURE_CHANNELS_MAX)) {
+        return (-EINVAL);
+    }
+
+    self_p->number_of_channels = number_of_channels;
+
+    for (i = 0; i < number_of_channels; i++) {
+        self_p->channels[i].period = 1;
+        self_p->channels[i].high = 0;
+        self_p->channels[i].position = 0;
+    }
+
+    return (0);
+}
+
+int capture_pwm_source_set(struct capture_pwm_source_t *self_p,
+                           int channel,
+                           uint32_t period,
+                           uint32_t high)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if ((channel < 0)
+        || (channel >= self_p->number_of_channels)
+        || (period == 0)
+        || (high > period)) {
+        return (-EINVAL);
+    }
+
+    self_p->channels[channel].period = period;
+    self_p->channels[channel].high = high;
+    self_p->channels[channel].position = 0;
+
+    return (0);
+}
+
+uint8_t capture_pwm_source_read(void *arg_p)
+{
+    struct capture_pwm_source_t *self_p;
+    uint8_t value;
+    int i;
+
+    self_p = arg_p;
+    value = 0;
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        if (self_p->channels[i].position < self_p->channels[i].high) {
+            value |= (1 << i);
+        }
+
+        self_p->channels[i].position++;
+
+        if (self_p->channels[i].position == self_p->channels[i].period) {
+            self_p->channels[i].position = 0;
+        }
+    }
+
+    return (value);
+}
+
+#endif
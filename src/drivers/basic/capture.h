@@ -0,0 +1,253 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_CAPTURE_H__
+#define __DRIVERS_CAPTURE_H__
+
+#include "simba.h"
+
+/** Maximum number of channels in a capture. */
+#define CAPTURE_CHANNELS_MAX                                8
+
+/** Number of samples analyzed at a time by the worker thread. */
+#define CAPTURE_BLOCK_SIZE                                 64
+
+/**
+ * Read all channels in one operation, typically a port input
+ * register. Called from interrupt context once per sample.
+ *
+ * @param[in] arg_p Argument given to `capture_init()`.
+ *
+ * @return Channel values. Bit N is the value of channel N.
+ */
+typedef uint8_t (*capture_read_t)(void *arg_p);
+
+/**
+ * Measurement of a channel during a report period.
+ */
+struct capture_channel_report_t {
+    /** Number of samples the channel was high. */
+    uint32_t high;
+    /** Number of low to high transitions. */
+    uint32_t rising_edges;
+    /** Number of high to low transitions. */
+    uint32_t falling_edges;
+};
+
+/**
+ * Measurement of all channels during a report period.
+ */
+struct capture_report_t {
+    /** Number of samples in the report period. */
+    uint32_t number_of_samples;
+    /** Number of samples lost since the previous report as the ring
+        buffer was full. */
+    uint32_t overruns;
+    struct capture_channel_report_t channels[CAPTURE_CHANNELS_MAX];
+};
+
+struct capture_driver_t {
+    capture_read_t read;
+    void *arg_p;
+    int number_of_channels;
+    long sampling_rate;
+    struct {
+        uint8_t *buf_p;
+        size_t mask;
+        /* Written by the sampling interrupt only. */
+        size_t head;
+        /* Written by the worker thread only. */
+        size_t tail;
+        uint32_t overruns;
+    } ring;
+    struct {
+        int started;
+        uint8_t previous;
+        uint32_t samples_per_report;
+        uint32_t overruns;
+        struct capture_report_t report;
+    } analysis;
+    struct {
+        struct spsc_queue_t queue;
+        /* Room for two reports. */
+        uint8_t buf[256];
+    } reports;
+    struct {
+        int requested;
+        struct sem_t sem;
+    } stop;
+    struct sem_t sem;
+    struct timer_t timer;
+    struct thrd_t *thrd_p;
+};
+
+/**
+ * A simulated signal source with one PWM signal per channel, used
+ * instead of input pins to test and benchmark the capture driver.
+ */
+struct capture_pwm_source_t {
+    int number_of_channels;
+    struct {
+        uint32_t period;
+        uint32_t high;
+        uint32_t position;
+    } channels[CAPTURE_CHANNELS_MAX];
+};
+
+/**
+ * Initialize given capture driver object.
+ *
+ * Samples are stored in a ring buffer, one byte per sample, until
+ * analyzed by the worker thread. A report is written for each
+ * `samples_per_report` analyzed samples.
+ *
+ * @param[out] self_p Driver object to initialize.
+ * @param[in] read Channels read function.
+ * @param[in] arg_p Argument passed to the read function.
+ * @param[in] number_of_channels Number of channels, 1 to
+ *                               `CAPTURE_CHANNELS_MAX`.
+ * @param[in] sampling_rate Sampling rate in Hertz, or zero(0) if
+ *                          the application calls
+ *                          `capture_sample_isr()` itself.
+ * @param[in] buf_p Ring buffer.
+ * @param[in] size Ring buffer size in bytes. Must be a power of two
+ *                 and at least `CAPTURE_BLOCK_SIZE`.
+ * @param[in] samples_per_report Number of samples per report. Must
+ *                               be at least `CAPTURE_BLOCK_SIZE`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int capture_init(struct capture_driver_t *self_p,
+                 capture_read_t read,
+                 void *arg_p,
+                 int number_of_channels,
+                 long sampling_rate,
+                 void *buf_p,
+                 size_t size,
+                 uint32_t samples_per_report);
+
+/**
+ * Spawn the worker thread, if not already spawned, and start
+ * sampling at the sampling rate given to `capture_init()`.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] stack_p Worker thread stack.
+ * @param[in] stack_size Worker thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int capture_start(struct capture_driver_t *self_p,
+                  void *stack_p,
+                  size_t stack_size);
+
+/**
+ * Stop sampling. Samples not yet analyzed, the current report and
+ * all unread reports are discarded, so the first report after the
+ * next `capture_start()` only contains new samples.
+ *
+ * @param[in] self_p Started driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int capture_stop(struct capture_driver_t *self_p);
+
+/**
+ * Read all channels and store the sample in the ring buffer. Called
+ * by the sampling timer started by `capture_start()`, or by the
+ * application from a hardware timer interrupt if the sampling rate
+ * is zero(0).
+ *
+ * @param[in] self_p Initialized driver object.
+ */
+void capture_sample_isr(struct capture_driver_t *self_p);
+
+/**
+ * Analyze all complete blocks of samples in the ring buffer. Called
+ * by the worker thread, or by the application if the worker thread
+ * is not started.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return Number of analyzed samples.
+ */
+size_t capture_analyze(struct capture_driver_t *self_p);
+
+/**
+ * Read the next report. Blocks until a report is available. Reports
+ * are discarded if not read before the next two are written.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[out] report_p Read report.
+ *
+ * @return zero(0) or negative error code.
+ */
+int capture_read_report(struct capture_driver_t *self_p,
+                        struct capture_report_t *report_p);
+
+/**
+ * Initialize given simulated signal source with all channels low.
+ *
+ * @param[out] self_p Source to initialize.
+ * @param[in] number_of_channels Number of channels, 1 to
+ *                               `CAPTURE_CHANNELS_MAX`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int capture_pwm_source_init(struct capture_pwm_source_t *self_p,
+                            int number_of_channels);
+
+/**
+ * Set the PWM signal of given channel. The signal is high during the
+ * first `high` samples of each period.
+ *
+ * @param[in] self_p Initialized source.
+ * @param[in] channel Channel to set.
+ * @param[in] period Period in samples.
+ * @param[in] high Number of high samples in each period, 0 to
+ *                 `period`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int capture_pwm_source_set(struct capture_pwm_source_t *self_p,
+                           int channel,
+                           uint32_t period,
+                           uint32_t high);
+
+/**
+ * Read function of the simulated signal source, passed to
+ * `capture_init()` with the source as argument.
+ *
+ * @param[in] arg_p Initialized source.
+ *
+ * @return Channel values.
+ */
+uint8_t capture_pwm_source_read(void *arg_p);
+
+#endif
@@ -35,8 +35,23 @@
 #define CAN_PORT_SPEED_500KBPS                            (1)
 #define CAN_PORT_SPEED_250KBPS                            (2)
 
+/**
+ * A SocketCAN receive filter. A received frame matches the filter if
+ * (frame id & mask) == (id & mask), and the frame format is the
+ * filter format.
+ */
+struct can_port_filter_t {
+    uint32_t id;
+    uint32_t mask;
+    int extended_frame;
+};
+
 struct can_device_t {
     struct can_driver_t *drv_p;
+#if CONFIG_LINUX_SOCKETCAN == 1
+    /* SocketCAN network interface name, or NULL for can<index>. */
+    const char *interface_p;
+#endif
 };
 
 struct can_driver_t {
@@ -44,6 +59,45 @@ struct can_driver_t {
     struct can_device_t *dev_p;
     struct queue_t chin;
     struct sem_t sem;
+#if CONFIG_LINUX_SOCKETCAN == 1
+    int socket;
+    struct {
+        volatile int stopped;
+        int event; /* Eventfd waking the reader on stop. */
+    } reader;
+    struct {
+        const struct can_port_filter_t *filters_p;
+        size_t length;
+    } filters;
+#endif
 };
 
+/**
+ * Bind given CAN device to given SocketCAN network interface, for
+ * example ``vcan0``. Must be called before starting a driver of the
+ * device. Devices are bound to ``can<index>`` by default.
+ *
+ * @param[in] dev_p CAN device.
+ * @param[in] name_p Network interface name.
+ *
+ * @return zero(0) or negative error code.
+ */
+int can_port_set_interface(struct can_device_t *dev_p, const char *name_p);
+
+/**
+ * Only receive frames matching any of given filters. The filters are
+ * applied by the kernel. Given array must be valid as long as the
+ * driver is started.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] filters_p Array of filters.
+ * @param[in] length Number of filters in the array. Zero(0) to
+ *                   receive all frames.
+ *
+ * @return zero(0) or negative error code.
+ */
+int can_port_set_filters(struct can_driver_t *self_p,
+                         const struct can_port_filter_t *filters_p,
+                         size_t length);
+
 #endif
@@ -28,6 +28,59 @@
  * This file is part of the Simba project.
  */
 
+#if CONFIG_LINUX_SOCKETCAN == 1
+
+#include "socketcan.h"
+
+static ssize_t write_cb(void *arg_p,
+                        const void *buf_p,
+                        size_t size)
+{
+    return (socketcan_write(arg_p, buf_p, size));
+}
+
+static int can_port_module_init()
+{
+    return (0);
+}
+
+static int can_port_init(struct can_driver_t *self_p,
+                         struct can_device_t *dev_p,
+                         uint32_t speed)
+{
+    return (socketcan_init(self_p));
+}
+
+static int can_port_start(struct can_driver_t *self_p)
+{
+    return (socketcan_start(self_p));
+}
+
+static int can_port_stop(struct can_driver_t *self_p)
+{
+    return (socketcan_stop(self_p));
+}
+
+int can_port_set_interface(struct can_device_t *dev_p, const char *name_p)
+{
+    ASSERTN(dev_p != NULL, EINVAL);
+    ASSERTN(name_p != NULL, EINVAL);
+
+    return (socketcan_set_interface(dev_p, name_p));
+}
+
+int can_port_set_filters(struct can_driver_t *self_p,
+                         const struct can_port_filter_t *filters_p,
+                         size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((filters_p != NULL) || (length == 0), EINVAL);
+
+    return (socketcan_set_filters(self_p, filters_p, length));
+}
+
+#else
+
 #include "socket_device.h"
 
 static ssize_t write_cb(void *arg_p,
@@ -79,3 +132,17 @@ static int can_port_stop(struct can_driver_t *self_p)
 
     return (0);
 }
+
+int can_port_set_interface(struct can_device_t *dev_p, const char *name_p)
+{
+    return (-ENOSYS);
+}
+
+int can_port_set_filters(struct can_driver_t *self_p,
+                         const struct can_port_filter_t *filters_p,
+                         size_t length)
+{
+    return (-ENOSYS);
+}
+
+#endif
@@ -33,6 +33,8 @@
 
 struct flash_device_t {
     struct sem_t sem;
+    /** Emulated flash memory. */
+    uint8_t memory[CONFIG_FLASH_LINUX_DEVICE_SIZE];
 };
 
 struct flash_driver_t {
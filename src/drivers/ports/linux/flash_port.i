@@ -28,8 +28,32 @@
  * This file is part of the Simba project.
  */
 
+/* The flash memory is emulated in RAM, with configurable erase and
+   program latencies. */
+
+/**
+ * Returns zero(0) if given range is within the emulated memory.
+ */
+static int check_range(uintptr_t addr, size_t size)
+{
+    if ((addr > CONFIG_FLASH_LINUX_DEVICE_SIZE)
+        || (size > CONFIG_FLASH_LINUX_DEVICE_SIZE - addr)) {
+        return (-EINVAL);
+    }
+
+    return (0);
+}
+
 int flash_port_module_init(void)
 {
+    int i;
+
+    for (i = 0; i < FLASH_DEVICE_MAX; i++) {
+        memset(&flash_device[i].memory[0],
+               0xff,
+               sizeof(flash_device[i].memory));
+    }
+
     return (0);
 }
 
@@ -38,6 +62,12 @@ ssize_t flash_port_read(struct flash_driver_t *self_p,
                         size_t src,
                         size_t size)
 {
+    if (check_range(src, size) != 0) {
+        return (-EINVAL);
+    }
+
+    memcpy(dst_p, &self_p->dev_p->memory[src], size);
+
     return (size);
 }
 
@@ -46,6 +76,21 @@ ssize_t flash_port_write(struct flash_driver_t *self_p,
                          const void *src_p,
                          size_t size)
 {
+    size_t pages;
+
+    if (check_range(dst, size) != 0) {
+        return (-EINVAL);
+    }
+
+    pages = (DIV_CEIL(dst + size, CONFIG_FLASH_LINUX_PAGE_SIZE)
+             - (dst / CONFIG_FLASH_LINUX_PAGE_SIZE));
+
+    if (CONFIG_FLASH_LINUX_WRITE_PAGE_US > 0) {
+        thrd_sleep_us(pages * CONFIG_FLASH_LINUX_WRITE_PAGE_US);
+    }
+
+    memcpy(&self_p->dev_p->memory[dst], src_p, size);
+
     return (size);
 }
 
@@ -53,5 +98,26 @@ static int flash_port_erase(struct flash_driver_t *self_p,
                             uintptr_t addr,
                             uint32_t size)
 {
+    size_t begin;
+    size_t end;
+
+    if (check_range(addr, size) != 0) {
+        return (-EINVAL);
+    }
+
+    /* Erase all sectors part of given range. */
+    begin = (addr / CONFIG_FLASH_LINUX_SECTOR_SIZE);
+    end = DIV_CEIL(addr + size, CONFIG_FLASH_LINUX_SECTOR_SIZE);
+
+    if (CONFIG_FLASH_LINUX_ERASE_SECTOR_US > 0) {
+        thrd_sleep_us((end - begin) * CONFIG_FLASH_LINUX_ERASE_SECTOR_US);
+    }
+
+    memset(&self_p->dev_p->memory[begin * CONFIG_FLASH_LINUX_SECTOR_SIZE],
+           0xff,
+           MIN(end * CONFIG_FLASH_LINUX_SECTOR_SIZE,
+               CONFIG_FLASH_LINUX_DEVICE_SIZE)
+           - begin * CONFIG_FLASH_LINUX_SECTOR_SIZE);
+
     return (0);
 }
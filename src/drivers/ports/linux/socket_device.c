@@ -31,9 +31,13 @@
 #include "socket_device.h"
 
 #include <pthread.h>
+#include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 #include <netdb.h>
 
 /**
@@ -51,6 +55,32 @@
 #define TYPE_I2C_DEVICE_REQUEST                           (9)
 #define TYPE_I2C_DEVICE_RESPONSE                         (10)
 
+/**
+ * Request type flag selecting length-prefixed binary framing of the
+ * device data, instead of the text protocol.
+ */
+#define TYPE_BINARY                                   (0x100)
+
+/**
+ * Binary framing.
+ */
+#define FRAME_HEADER_SIZE                                 (2)
+#define CAN_FRAME_PAYLOAD_SIZE_MIN                        (6)
+#define CAN_FRAME_PAYLOAD_SIZE_MAX   (CAN_FRAME_PAYLOAD_SIZE_MIN + 8)
+#define CAN_FRAME_FLAGS_EXTENDED                       (0x01)
+#define I2C_FRAME_PAYLOAD_SIZE_MIN                        (2)
+
+/**
+ * Length of the fixed part of a CAN text line,
+ * "id=%08x,extended=%d,size=%d,data=".
+ */
+#define CAN_LINE_HEADER_SIZE                             (35)
+#define CAN_LINE_SIZE_MAX            (CAN_LINE_HEADER_SIZE + 16 + 2 + 1)
+
+#define CLIENT_INPUT_BUFFER_SIZE                       (1024)
+#define REQUEST_CLIENTS_MAX                               (8)
+#define EVENTS_MAX                                       (16)
+
 /**
  * Convert given device pointer to its index.
  */
@@ -63,6 +93,7 @@
 struct module_t {
     int8_t initialized;
     pthread_t thrd;
+    int epoll;
 };
 
 /**
@@ -84,147 +115,165 @@ struct device_response_t {
 };
 
 /**
- * The client types.
+ * An accepted client waiting for its device request to be
+ * received. The request is read as data arrives, without blocking
+ * other clients.
  */
-struct uart_client_t {
-    int socket;
-    struct uart_device_t *dev_p;
-    char name[64];
-    pthread_t thrd;
-};
-
-struct pin_client_t {
+struct request_client_t {
     int socket;
-    struct pin_device_t *dev_p;
-    char name[64];
-    pthread_t thrd;
+    size_t size;
+    struct device_request_t request;
 };
 
-struct pwm_client_t {
-    int socket;
-    struct pwm_device_t *dev_p;
-    char name[64];
-    pthread_t thrd;
-};
+struct client_t;
 
-struct can_client_t {
-    int socket;
-    struct can_device_t *dev_p;
-    char name[64];
-    pthread_t thrd;
-};
+/**
+ * Handle received data. Returns the number of consumed bytes, or
+ * negative error code to close the connection.
+ */
+typedef ssize_t (*client_input_fn_t)(struct client_t *self_p);
 
-struct i2c_client_t {
+/**
+ * A connected client of any device type.
+ */
+struct client_t {
     int socket;
-    struct i2c_device_t *dev_p;
+    int binary;
+    const char *type_p;
+    void *dev_p;
+    client_input_fn_t input;
+    size_t payload_left;
     char name[64];
-    pthread_t thrd;
+    struct {
+        uint8_t buf[CLIENT_INPUT_BUFFER_SIZE];
+        size_t size;
+    } input_buffer;
 };
 
-static struct uart_client_t uart_clients[UART_DEVICE_MAX];
-static struct pin_client_t pin_clients[PIN_DEVICE_MAX];
-static struct pwm_client_t pwm_clients[PWM_DEVICE_MAX];
-static struct can_client_t can_clients[CAN_DEVICE_MAX];
-static struct i2c_client_t i2c_clients[I2C_DEVICE_MAX];
+static struct client_t uart_clients[UART_DEVICE_MAX];
+static struct client_t pin_clients[PIN_DEVICE_MAX];
+static struct client_t pwm_clients[PWM_DEVICE_MAX];
+static struct client_t can_clients[CAN_DEVICE_MAX];
+static struct client_t i2c_clients[I2C_DEVICE_MAX];
+static struct request_client_t request_clients[REQUEST_CLIENTS_MAX];
 static struct module_t module;
 
 /**
- * Handle a UART client connection.
+ * Find the next complete binary frame in given buffer.
+ *
+ * @return Size of the frame including its header, zero(0) if no
+ *         complete frame is available.
  */
-static void *uart_client_main(void *arg_p)
+static size_t next_frame(const uint8_t *buf_p,
+                         size_t size,
+                         const uint8_t **payload_pp,
+                         size_t *payload_size_p)
 {
-    struct uart_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
+    size_t payload_size;
 
-    client_p = arg_p;
+    if (size < FRAME_HEADER_SIZE) {
+        return (0);
+    }
 
-    printf("socket_device: uart device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    payload_size = ((buf_p[0] << 8) | buf_p[1]);
 
-    while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
+    if (size < FRAME_HEADER_SIZE + payload_size) {
+        return (0);
+    }
 
-        if (size != sizeof(byte)) {
-            break;
-        }
+    *payload_pp = &buf_p[FRAME_HEADER_SIZE];
+    *payload_size_p = payload_size;
 
-        sys_lock();
+    return (FRAME_HEADER_SIZE + payload_size);
+}
 
-        if (client_p->dev_p->drv_p != NULL) {
-            queue_write_isr(&client_p->dev_p->drv_p->base,
-                            &byte,
-                            sizeof(byte));
-        }
+/**
+ * Get the payload size of the binary frame at given offset in the
+ * input buffer of given client.
+ *
+ * @return Payload size, or -1 if the frame header has not been
+ *         received.
+ */
+static ssize_t peek_payload_size(struct client_t *self_p, size_t offset)
+{
+    const uint8_t *buf_p;
 
-        sys_unlock();
+    if (self_p->input_buffer.size - offset < FRAME_HEADER_SIZE) {
+        return (-1);
     }
 
-    close(client_p->socket);
-    client_p->socket = -2;
-
-    printf("socket_device: uart device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    buf_p = &self_p->input_buffer.buf[offset];
 
-    return (NULL);
+    return ((buf_p[0] << 8) | buf_p[1]);
 }
 
-static int handle_uart_device_request(struct device_request_t *request_p,
-                                      int client)
+/**
+ * Find the next binary frame payload in the input buffer of given
+ * client, starting at given offset. Frames larger than the input
+ * buffer are returned in pieces as their data is received.
+ *
+ * @return Number of consumed bytes, zero(0) if no payload is
+ *         available.
+ */
+static size_t next_payload(struct client_t *self_p,
+                           size_t offset,
+                           const uint8_t **payload_pp,
+                           size_t *payload_size_p)
 {
-    struct device_response_t response;
-    int res;
-    long index;
-    char *device_p;
+    const uint8_t *buf_p;
+    size_t size;
+    size_t header_size;
 
-    res = 0;
+    buf_p = &self_p->input_buffer.buf[offset];
+    size = (self_p->input_buffer.size - offset);
+    header_size = 0;
 
-    /* Parse the device name. */
-    device_p = (char *)&request_p->device[0];
+    if (self_p->payload_left == 0) {
+        if (size < FRAME_HEADER_SIZE) {
+            return (0);
+        }
 
-    if (std_strtol(device_p, &index) == NULL) {
-        index = -1;
+        self_p->payload_left = ((buf_p[0] << 8) | buf_p[1]);
+        header_size = FRAME_HEADER_SIZE;
     }
 
-    /* Prepare the response. */
-    response.header.type = htonl(TYPE_UART_DEVICE_RESPONSE);
-    response.header.size = htonl(4);
+    *payload_pp = &buf_p[header_size];
+    *payload_size_p = MIN(self_p->payload_left, size - header_size);
+    self_p->payload_left -= *payload_size_p;
 
-    if ((index < 0) || (index >= UART_DEVICE_MAX)) {
-        response.result = -ENODEV;
-    } else if (uart_clients[index].socket >= 0) {
-        response.result = -EADDRINUSE;
-    } else {
-        if (uart_clients[index].socket == -2) {
-            pthread_join(uart_clients[index].thrd, NULL);
-            uart_clients[index].socket = -1;
-        }
+    return (header_size + *payload_size_p);
+}
 
-        response.result = 0;
-    }
+/**
+ * Write all given data to given socket.
+ *
+ * @return zero(0) or -1 on failure.
+ */
+static int write_all(int socket, struct iovec *iov_p, int iovcnt)
+{
+    ssize_t res;
 
-    /* Send the response. */
-    response.result = htonl(response.result);
-    res = write(client, &response, sizeof(response));
+    while (iovcnt > 0) {
+        res = writev(socket, iov_p, iovcnt);
 
-    if (response.result != 0) {
-        return (-1);
-    }
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return (-1);
+        }
 
-    /* Start the client thread if everything went well so far. */
-    if (res == sizeof(response)) {
-        uart_clients[index].socket = client;
-        uart_clients[index].dev_p = &uart_device[index];
-        strcpy(&uart_clients[index].name[0], device_p);
-        res = pthread_create(&uart_clients[index].thrd,
-                             NULL,
-                             uart_client_main,
-                             &uart_clients[index]);
+        /* Skip written buffers after a short write. */
+        while ((iovcnt > 0) && (res >= iov_p->iov_len)) {
+            res -= iov_p->iov_len;
+            iov_p++;
+            iovcnt--;
+        }
 
-        if (res != 0) {
-            fprintf(stderr, "error: creating uart device thread\n");
+        if (iovcnt > 0) {
+            iov_p->iov_base = ((uint8_t *)iov_p->iov_base + res);
+            iov_p->iov_len -= res;
         }
     }
 
@@ -232,483 +281,630 @@ static int handle_uart_device_request(struct device_request_t *request_p,
 }
 
 /**
- * Handle a pin client connection.
+ * Write all data in given buffer to given socket.
+ *
+ * @return zero(0) or -1 on failure.
  */
-static void *pin_client_main(void *arg_p)
+static int write_buf(int socket, const void *buf_p, size_t size)
 {
-    struct pin_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
+    struct iovec iov;
 
-    client_p = arg_p;
+    iov.iov_base = (void *)buf_p;
+    iov.iov_len = size;
 
-    printf("socket_device: pin device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
-
-    while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
+    return (write_all(socket, &iov, 1));
+}
 
-        if (size != sizeof(byte)) {
-            break;
-        }
+/**
+ * Write given payload to the client, framed if the client uses the
+ * binary protocol. The optional prefix is written before the buffer,
+ * in the same frame.
+ */
+static ssize_t client_write(struct client_t *self_p,
+                            const void *prefix_p,
+                            size_t prefix_size,
+                            const void *buf_p,
+                            size_t size)
+{
+    struct iovec iov[3];
+    uint8_t header[FRAME_HEADER_SIZE];
+    int iovcnt;
+
+    iovcnt = 0;
+
+    if (self_p->binary == 1) {
+        header[0] = ((prefix_size + size) >> 8);
+        header[1] = (prefix_size + size);
+        iov[iovcnt].iov_base = &header[0];
+        iov[iovcnt].iov_len = sizeof(header);
+        iovcnt++;
+    }
 
-        /* Discard input data for now. */
+    if (prefix_size > 0) {
+        iov[iovcnt].iov_base = (void *)prefix_p;
+        iov[iovcnt].iov_len = prefix_size;
+        iovcnt++;
     }
 
-    close(client_p->socket);
-    client_p->socket = -2;
+    iov[iovcnt].iov_base = (void *)buf_p;
+    iov[iovcnt].iov_len = size;
+    iovcnt++;
 
-    printf("socket_device: pin device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    if (write_all(self_p->socket, &iov[0], iovcnt) != 0) {
+        return (-1);
+    }
 
-    return (NULL);
+    return (size);
 }
 
-static int handle_pin_device_request(struct device_request_t *request_p,
-                                      int client)
+/**
+ * Write all received UART data to the driver input queue.
+ */
+static ssize_t uart_client_input(struct client_t *self_p)
 {
-    struct device_response_t response;
-    int res;
-    long index;
-    char *device_p;
-
-    res = 0;
-
-    /* Parse the device name. */
-    device_p = (char *)&request_p->device[0];
-
-    index = board_pin_string_to_device_index(device_p);
+    struct uart_device_t *dev_p;
+    uint8_t buf[CLIENT_INPUT_BUFFER_SIZE];
+    const uint8_t *payload_p;
+    size_t payload_size;
+    size_t offset;
+    size_t size;
+    size_t frame_size;
+
+    dev_p = self_p->dev_p;
+
+    if (self_p->binary == 0) {
+        payload_p = &self_p->input_buffer.buf[0];
+        size = self_p->input_buffer.size;
+        offset = size;
+    } else {
+        /* Gather all received payload data. */
+        size = 0;
+        offset = 0;
 
-    if (index < 0) {
-        if (std_strtol(device_p, &index) == NULL) {
-            index = -1;
-        }
-    }
+        while (1) {
+            frame_size = next_payload(self_p,
+                                      offset,
+                                      &payload_p,
+                                      &payload_size);
 
-    /* Prepare the response. */
-    response.header.type = htonl(TYPE_PIN_DEVICE_RESPONSE);
-    response.header.size = htonl(4);
+            if (frame_size == 0) {
+                break;
+            }
 
-    if ((index < 0) || (index >= PIN_DEVICE_MAX)) {
-        response.result = -ENODEV;
-    } else if (pin_clients[index].socket >= 0) {
-        response.result = -EADDRINUSE;
-    } else {
-        if (pin_clients[index].socket == -2) {
-            pthread_join(pin_clients[index].thrd, NULL);
-            pin_clients[index].socket = -1;
+            memcpy(&buf[size], payload_p, payload_size);
+            size += payload_size;
+            offset += frame_size;
         }
 
-        response.result = 0;
-    }
-
-    /* Send the response. */
-    response.result = htonl(response.result);
-    res = write(client, &response, sizeof(response));
-
-    if (response.result != 0) {
-        return (-1);
+        payload_p = &buf[0];
     }
 
-    /* Start the client thread if everything went well so far. */
-    if (res == sizeof(response)) {
-        pin_clients[index].socket = client;
-        pin_clients[index].dev_p = &pin_device[index];
-        strcpy(&pin_clients[index].name[0], device_p);
-        res = pthread_create(&pin_clients[index].thrd,
-                             NULL,
-                             pin_client_main,
-                             &pin_clients[index]);
+    if (size > 0) {
+        sys_lock();
 
-        if (res != 0) {
-            fprintf(stderr, "error: creating pin device thread\n");
+        if (dev_p->drv_p != NULL) {
+            queue_write_isr(&dev_p->drv_p->base, payload_p, size);
         }
+
+        sys_unlock();
     }
 
-    return (0);
+    return (offset);
 }
 
-#if CONFIG_PWM == 1
-
 /**
- * Handle a pwm client connection.
+ * Discard all received data.
  */
-static void *pwm_client_main(void *arg_p)
+static ssize_t discard_client_input(struct client_t *self_p)
 {
-    struct pwm_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
+    const uint8_t *payload_p;
+    size_t payload_size;
+    size_t offset;
+    size_t frame_size;
 
-    client_p = arg_p;
+    if (self_p->binary == 0) {
+        return (self_p->input_buffer.size);
+    }
 
-    printf("socket_device: pwm device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    offset = 0;
 
     while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
+        frame_size = next_payload(self_p,
+                                  offset,
+                                  &payload_p,
+                                  &payload_size);
 
-        if (size != sizeof(byte)) {
+        if (frame_size == 0) {
             break;
         }
 
-        /* Discard input data for now. */
+        offset += frame_size;
     }
 
-    close(client_p->socket);
-    client_p->socket = -2;
-
-    printf("socket_device: pwm device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
-
-    return (NULL);
+    return (offset);
 }
 
-static int handle_pwm_device_request(struct device_request_t *request_p,
-                                      int client)
+/**
+ * Parse a CAN frame on the text format
+ * "id=<id>,extended=<extended>,size=<size>,data=<data>\r\n".
+ *
+ * @return Size of the line, zero(0) if no complete line is available,
+ *         or -1 if the line is malformed.
+ */
+static ssize_t parse_can_line(const uint8_t *buf_p,
+                              size_t size,
+                              struct can_frame_t *frame_p)
 {
-    struct device_response_t response;
-    int res;
-    long index;
-    char *device_p;
-    struct pwm_device_t *dev_p;
+    char header[CAN_LINE_HEADER_SIZE + 1];
+    char byte[5];
+    unsigned int id;
+    int extended_frame;
+    int frame_size;
+    size_t line_size;
+    long value;
+    size_t i;
 
-    res = 0;
+    if (size < CAN_LINE_HEADER_SIZE) {
+        return (0);
+    }
 
-    /* Parse the device name. */
-    device_p = (char *)&request_p->device[0];
+    memcpy(&header[0], buf_p, CAN_LINE_HEADER_SIZE);
+    header[CAN_LINE_HEADER_SIZE] = '\0';
 
-    index = board_pin_string_to_device_index(device_p);
+    if (sscanf(&header[0],
+               "id=%08x,extended=%d,size=%d,data=",
+               &id,
+               &extended_frame,
+               &frame_size) != 3) {
+        return (-1);
+    }
 
-    if (index >= 0) {
-        dev_p = pwm_pin_to_device(&pin_device[index]);
+    if ((extended_frame != 0) && (extended_frame != 1)) {
+        return (-1);
+    }
 
-        if (dev_p == NULL) {
-            index = -1;
-        } else {
-            index = PWM_INDEX(dev_p);
-        }
-    } else {
-        if (std_strtol(device_p, &index) == NULL) {
-            index = -1;
-        }
+    if ((frame_size < 0) || (frame_size > 8)) {
+        return (-1);
     }
 
-    /* Prepare the response. */
-    response.header.type = htonl(TYPE_PWM_DEVICE_RESPONSE);
-    response.header.size = htonl(4);
+    line_size = (CAN_LINE_HEADER_SIZE + 2 * frame_size + 2);
 
-    if ((index < 0) || (index >= PWM_DEVICE_MAX)) {
-        response.result = -ENODEV;
-    } else if (pwm_clients[index].socket >= 0) {
-        response.result = -EADDRINUSE;
-    } else {
-        if (pwm_clients[index].socket == -2) {
-            pthread_join(pwm_clients[index].thrd, NULL);
-            pwm_clients[index].socket = -1;
+    if (size < line_size) {
+        return (0);
+    }
+
+    frame_p->id = id;
+    frame_p->extended_frame = extended_frame;
+    frame_p->size = frame_size;
+
+    byte[0] = '0';
+    byte[1] = 'x';
+    byte[4] = '\0';
+
+    for (i = 0; i < frame_size; i++) {
+        byte[2] = buf_p[CAN_LINE_HEADER_SIZE + 2 * i];
+        byte[3] = buf_p[CAN_LINE_HEADER_SIZE + 2 * i + 1];
+
+        if (std_strtol(&byte[0], &value) == NULL) {
+            return (-1);
         }
 
-        response.result = 0;
+        frame_p->data.u8[i] = value;
     }
 
-    /* Send the response. */
-    response.result = htonl(response.result);
-    res = write(client, &response, sizeof(response));
+    return (line_size);
+}
 
-    if (response.result != 0) {
+/**
+ * Parse a CAN frame in a binary frame payload; 4 bytes id, 1 byte
+ * flags, 1 byte size and size bytes data.
+ */
+static int parse_can_payload(const uint8_t *buf_p,
+                             size_t size,
+                             struct can_frame_t *frame_p)
+{
+    if (size < CAN_FRAME_PAYLOAD_SIZE_MIN) {
         return (-1);
     }
 
-    /* Start the client thread if everything went well so far. */
-    if (res == sizeof(response)) {
-        pwm_clients[index].socket = client;
-        pwm_clients[index].dev_p = &pwm_device[index];
-        strcpy(&pwm_clients[index].name[0], device_p);
-        res = pthread_create(&pwm_clients[index].thrd,
-                             NULL,
-                             pwm_client_main,
-                             &pwm_clients[index]);
-
-        if (res != 0) {
-            fprintf(stderr, "error: creating pwm device thread\n");
-        }
+    if ((buf_p[5] > 8) || (size != CAN_FRAME_PAYLOAD_SIZE_MIN + buf_p[5])) {
+        return (-1);
     }
 
+    frame_p->id = ((buf_p[0] << 24)
+                   | (buf_p[1] << 16)
+                   | (buf_p[2] << 8)
+                   | buf_p[3]);
+    frame_p->extended_frame = ((buf_p[4] & CAN_FRAME_FLAGS_EXTENDED) != 0);
+    frame_p->size = buf_p[5];
+    memcpy(&frame_p->data.u8[0], &buf_p[6], frame_p->size);
+
     return (0);
 }
 
-#endif
-
 /**
- * Handle a can client connection.
+ * Parse all complete CAN frames and write them to the driver input
+ * queue at once.
  */
-static void *can_client_main(void *arg_p)
+static ssize_t can_client_input(struct client_t *self_p)
 {
-    struct can_client_t *client_p;
+    struct can_device_t *dev_p;
+    struct can_frame_t frames[CLIENT_INPUT_BUFFER_SIZE
+                              / CAN_FRAME_PAYLOAD_SIZE_MIN];
+    const uint8_t *payload_p;
+    const uint8_t *end_p;
+    size_t payload_size;
+    size_t offset;
     ssize_t size;
-    char buf[64];
-    struct can_frame_t frame;
-    int frame_size;
-    long value;
-    size_t i;
-    int extended_frame;
-
-    client_p = arg_p;
+    ssize_t frame_size;
+    int number_of_frames;
 
-    printf("socket_device: can device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    dev_p = self_p->dev_p;
+    offset = 0;
+    number_of_frames = 0;
 
     while (1) {
-        size = read(client_p->socket, &buf[0], 35);
-
-        if (size == 0) {
-            break;
-        } else if (size != 35) {
-            printf("warning: bad can line size %d\n", (int)size);
-            fflush(stdout);
-            continue;
-        }
-
-        size = sscanf(&buf[0],
-                      "id=%08x,extended=%d,size=%d,data=",
-                      &frame.id,
-                      &extended_frame,
-                      &frame_size);
-
-        frame.extended_frame = extended_frame;
+        if (self_p->binary == 1) {
+            /* Skip frames too big to be CAN frames piece by piece,
+               since they may not fit in the input buffer. */
+            frame_size = -1;
+
+            if (self_p->payload_left == 0) {
+                frame_size = peek_payload_size(self_p, offset);
+
+                if (frame_size > CAN_FRAME_PAYLOAD_SIZE_MAX) {
+                    printf("warning: bad can frame of size %u\n",
+                           (unsigned int)frame_size);
+                    fflush(stdout);
+                }
+            }
 
-        if (size != 3) {
-            printf("warning: bad can message received: %s\n", &buf[0]);
-            fflush(stdout);
-            continue;
-        }
+            if ((self_p->payload_left > 0)
+                || (frame_size > CAN_FRAME_PAYLOAD_SIZE_MAX)) {
+                size = next_payload(self_p, offset, &payload_p, &payload_size);
 
-        if ((frame.extended_frame != 0) && (frame.extended_frame != 1)) {
-            printf("warning: bad can message exteneded frame: %d\n",
-                   frame.extended_frame);
-            fflush(stdout);
-            continue;
-        }
+                if (size == 0) {
+                    break;
+                }
 
-        if (frame_size > 8) {
-            printf("warning: bad can message size: %d\n", frame_size);
-            fflush(stdout);
-            continue;
-        }
+                offset += size;
+                continue;
+            }
 
-        frame.size = frame_size;
+            size = next_frame(&self_p->input_buffer.buf[offset],
+                              self_p->input_buffer.size - offset,
+                              &payload_p,
+                              &payload_size);
+
+            if ((size > 0)
+                && (parse_can_payload(payload_p,
+                                      payload_size,
+                                      &frames[number_of_frames]) != 0)) {
+                printf("warning: bad can frame of size %u\n",
+                       (unsigned int)payload_size);
+                fflush(stdout);
+                offset += size;
+                continue;
+            }
+        } else {
+            size = parse_can_line(&self_p->input_buffer.buf[offset],
+                                  self_p->input_buffer.size - offset,
+                                  &frames[number_of_frames]);
 
-        /* Read the data, one byte at a time. */
-        buf[0] = '0';
-        buf[1] = 'x';
-        buf[4] = '\0';
+            if (size == -1) {
+                printf("warning: bad can line received\n");
+                fflush(stdout);
 
-        for (i = 0; i < frame_size; i++) {
-            size = read(client_p->socket, &buf[2], 2);
+                /* Skip to the next line. */
+                end_p = memchr(&self_p->input_buffer.buf[offset],
+                               '\n',
+                               self_p->input_buffer.size - offset);
 
-            if (size == 0) {
-                break;
-            } else if (size != 2) {
-                printf("warning: bad can line size %d\n", (int)size);
-                fflush(stdout);
-                size = -1;
-                break;
-            }
+                if (end_p == NULL) {
+                    offset = self_p->input_buffer.size;
+                } else {
+                    offset = (end_p - &self_p->input_buffer.buf[0] + 1);
+                }
 
-            if (std_strtol(&buf[0], &value) == NULL) {
-                size = -1;
-                break;
+                continue;
             }
-
-            frame.data.u8[i] = value;
         }
 
         if (size == 0) {
             break;
-        } else if (size == -1) {
-            continue;
         }
 
-        /* Read the line terminator. */
-        read(client_p->socket, &buf[0], 2);
+        offset += size;
+        number_of_frames++;
+    }
 
+    if (number_of_frames > 0) {
         sys_lock();
 
-        if (client_p->dev_p->drv_p != NULL) {
-            queue_write_isr(&client_p->dev_p->drv_p->chin,
-                            &frame,
-                            sizeof(frame));
+        if (dev_p->drv_p != NULL) {
+            queue_write_isr(&dev_p->drv_p->chin,
+                            &frames[0],
+                            number_of_frames * sizeof(frames[0]));
         }
 
         sys_unlock();
     }
 
-    close(client_p->socket);
-    client_p->socket = -2;
-
-    printf("socket_device: can device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
-
-    return (NULL);
+    return (offset);
 }
 
-static int handle_can_device_request(struct device_request_t *request_p,
-                                      int client)
+/**
+ * Read available data from given client and pass it to the client
+ * input handler.
+ *
+ * @return zero(0) or negative error code if the connection shall be
+ *         closed.
+ */
+static int handle_client_input(struct client_t *self_p)
 {
-    struct device_response_t response;
-    int res;
-    long index;
-    char *device_p;
-
-    res = 0;
-
-    /* Parse the device name. */
-    device_p = (char *)&request_p->device[0];
-
-    if (std_strtol(device_p, &index) == NULL) {
-        index = -1;
-    }
+    ssize_t size;
 
-    /* Prepare the response. */
-    response.header.type = htonl(TYPE_CAN_DEVICE_RESPONSE);
-    response.header.size = htonl(4);
+    size = recv(self_p->socket,
+                &self_p->input_buffer.buf[self_p->input_buffer.size],
+                sizeof(self_p->input_buffer.buf) - self_p->input_buffer.size,
+                MSG_DONTWAIT);
 
-    if ((index < 0) || (index >= CAN_DEVICE_MAX)) {
-        response.result = -ENODEV;
-    } else if (can_clients[index].socket >= 0) {
-        response.result = -EADDRINUSE;
-    } else {
-        if (can_clients[index].socket == -2) {
-            pthread_join(can_clients[index].thrd, NULL);
-            can_clients[index].socket = -1;
+    if (size < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return (0);
         }
 
-        response.result = 0;
+        return (-1);
+    } else if (size == 0) {
+        return (-1);
     }
 
-    /* Send the response. */
-    response.result = htonl(response.result);
-    res = write(client, &response, sizeof(response));
+    self_p->input_buffer.size += size;
+    size = self_p->input(self_p);
 
-    if (response.result != 0) {
+    if (size < 0) {
         return (-1);
     }
 
-    /* Start the client thread if everything went well so far. */
-    if (res == sizeof(response)) {
-        can_clients[index].socket = client;
-        can_clients[index].dev_p = &can_device[index];
-        strcpy(&can_clients[index].name[0], device_p);
-        res = pthread_create(&can_clients[index].thrd,
-                             NULL,
-                             can_client_main,
-                             &can_clients[index]);
+    self_p->input_buffer.size -= size;
 
-        if (res != 0) {
-            fprintf(stderr, "error: creating can device thread\n");
-        }
+    if ((size == 0)
+        && (self_p->input_buffer.size == sizeof(self_p->input_buffer.buf))) {
+        printf("warning: socket_device: %s device %s input buffer full\n",
+               self_p->type_p,
+               &self_p->name[0]);
+        fflush(stdout);
+
+        return (-1);
     }
 
+    memmove(&self_p->input_buffer.buf[0],
+            &self_p->input_buffer.buf[size],
+            self_p->input_buffer.size);
+
     return (0);
 }
 
-/**
- * Handle a i2c client connection.
- */
-static void *i2c_client_main(void *arg_p)
+static void close_client(struct client_t *self_p)
 {
-    struct i2c_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
+    epoll_ctl(module.epoll, EPOLL_CTL_DEL, self_p->socket, NULL);
+    close(self_p->socket);
+    self_p->socket = -1;
 
-    client_p = arg_p;
-
-    printf("socket_device: i2c device %s connected\n",
-           &client_p->name[0]);
+    printf("socket_device: %s device %s disconnected\n",
+           self_p->type_p,
+           &self_p->name[0]);
     fflush(stdout);
+}
 
-    while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
+static long parse_device_index(const char *device_p)
+{
+    long index;
 
-        if (size == 0) {
-            break;
-        }
+    if (std_strtol(device_p, &index) == NULL) {
+        index = -1;
+    }
+
+    return (index);
+}
+
+static long parse_pin_device_index(const char *device_p)
+{
+    long index;
+
+    index = board_pin_string_to_device_index(device_p);
 
-        /* Discard input data for now. */
+    if (index < 0) {
+        index = parse_device_index(device_p);
     }
 
-    close(client_p->socket);
-    client_p->socket = -2;
+    return (index);
+}
 
-    printf("socket_device: i2c device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+#if CONFIG_PWM == 1
 
-    return (NULL);
+static long parse_pwm_device_index(const char *device_p)
+{
+    long index;
+    struct pwm_device_t *dev_p;
+
+    index = board_pin_string_to_device_index(device_p);
+
+    if (index >= 0) {
+        dev_p = pwm_pin_to_device(&pin_device[index]);
+
+        if (dev_p == NULL) {
+            index = -1;
+        } else {
+            index = PWM_INDEX(dev_p);
+        }
+    } else {
+        index = parse_device_index(device_p);
+    }
+
+    return (index);
 }
 
-static int handle_i2c_device_request(struct device_request_t *request_p,
-                                     int client)
+#endif
+
+/**
+ * Find the client and the device of given request, and connect the
+ * client.
+ */
+static int handle_device_request(struct device_request_t *request_p,
+                                 int client)
 {
     struct device_response_t response;
+    struct client_t *client_p;
+    void *dev_p;
+    const char *type_p;
+    client_input_fn_t input;
+    struct epoll_event event;
     int res;
     long index;
     char *device_p;
+    int type;
 
-    res = 0;
+    client_p = NULL;
+    dev_p = NULL;
+    type_p = NULL;
+    input = discard_client_input;
+    type = (request_p->header.type & ~TYPE_BINARY);
 
     /* Parse the device name. */
     device_p = (char *)&request_p->device[0];
 
-    if (std_strtol(device_p, &index) == NULL) {
-        index = -1;
+    switch (type) {
+
+    case TYPE_UART_DEVICE_REQUEST:
+        type_p = "uart";
+        input = uart_client_input;
+        index = parse_device_index(device_p);
+
+        if ((index >= 0) && (index < UART_DEVICE_MAX)) {
+            client_p = &uart_clients[index];
+            dev_p = &uart_device[index];
+        }
+
+        break;
+
+    case TYPE_PIN_DEVICE_REQUEST:
+        type_p = "pin";
+        index = parse_pin_device_index(device_p);
+
+        if ((index >= 0) && (index < PIN_DEVICE_MAX)) {
+            client_p = &pin_clients[index];
+            dev_p = &pin_device[index];
+        }
+
+        break;
+
+#if CONFIG_PWM == 1
+    case TYPE_PWM_DEVICE_REQUEST:
+        type_p = "pwm";
+        index = parse_pwm_device_index(device_p);
+
+        if ((index >= 0) && (index < PWM_DEVICE_MAX)) {
+            client_p = &pwm_clients[index];
+            dev_p = &pwm_device[index];
+        }
+
+        break;
+#endif
+
+    case TYPE_CAN_DEVICE_REQUEST:
+        type_p = "can";
+        input = can_client_input;
+        index = parse_device_index(device_p);
+
+        if ((index >= 0) && (index < CAN_DEVICE_MAX)) {
+            client_p = &can_clients[index];
+            dev_p = &can_device[index];
+        }
+
+        break;
+
+    case TYPE_I2C_DEVICE_REQUEST:
+        type_p = "i2c";
+        index = parse_device_index(device_p);
+
+        if ((index >= 0) && (index < I2C_DEVICE_MAX)) {
+            client_p = &i2c_clients[index];
+            dev_p = &i2c_device[index];
+        }
+
+        break;
+
+    default:
+        /* Send the response. */
+        response.header.type = htonl(TYPE_UNSUPPORTED_TYPE);
+        response.header.size = htonl(0);
+        write_buf(client, &response.header, sizeof(response.header));
+
+        return (-1);
     }
 
     /* Prepare the response. */
-    response.header.type = htonl(TYPE_I2C_DEVICE_RESPONSE);
+    response.header.type = htonl(request_p->header.type + 1);
     response.header.size = htonl(4);
 
-    if ((index < 0) || (index >= I2C_DEVICE_MAX)) {
+    if (client_p == NULL) {
         response.result = -ENODEV;
-    } else if (i2c_clients[index].socket >= 0) {
+    } else if (client_p->socket >= 0) {
         response.result = -EADDRINUSE;
     } else {
-        if (i2c_clients[index].socket == -2) {
-            pthread_join(i2c_clients[index].thrd, NULL);
-            i2c_clients[index].socket = -1;
-        }
-
         response.result = 0;
     }
 
-    /* Send the response. */
     response.result = htonl(response.result);
-    res = write(client, &response, sizeof(response));
 
     if (response.result != 0) {
+        write_buf(client, &response, sizeof(response));
+
         return (-1);
     }
 
-    /* Start the client thread if everything went well so far. */
-    if (res == sizeof(response)) {
-        i2c_clients[index].socket = client;
-        i2c_clients[index].dev_p = &i2c_device[index];
-        strcpy(&i2c_clients[index].name[0], device_p);
-        res = pthread_create(&i2c_clients[index].thrd,
-                             NULL,
-                             i2c_client_main,
-                             &i2c_clients[index]);
+    client_p->binary = ((request_p->header.type & TYPE_BINARY) != 0);
+    client_p->type_p = type_p;
+    client_p->dev_p = dev_p;
+    client_p->input = input;
+    client_p->payload_left = 0;
+    client_p->input_buffer.size = 0;
+    strcpy(&client_p->name[0], device_p);
 
-        if (res != 0) {
-            fprintf(stderr, "error: creating i2c device thread\n");
-        }
+    event.events = EPOLLIN;
+    event.data.ptr = client_p;
+
+    if (epoll_ctl(module.epoll, EPOLL_CTL_ADD, client, &event) != 0) {
+        perror("socket_device: epoll_ctl");
+
+        return (-1);
+    }
+
+    /* Send the response and connect the client under the system lock,
+       so device data is neither written before the response nor lost
+       once the client has received it. */
+    sys_lock();
+    res = write_buf(client, &response, sizeof(response));
+
+    if (res == 0) {
+        client_p->socket = client;
+    }
+
+    sys_unlock();
+
+    if (res != 0) {
+        epoll_ctl(module.epoll, EPOLL_CTL_DEL, client, NULL);
+
+        return (-1);
     }
 
+    printf("socket_device: %s device %s connected%s\n",
+           type_p,
+           &client_p->name[0],
+           client_p->binary == 1 ? " (binary)" : "");
+    fflush(stdout);
+
     return (0);
 }
 
@@ -786,15 +982,172 @@ static int setup_listener(void)
 }
 
 /**
- * Entry function of the socket device listener thread.
+ * Accept a client. Its device request is read by
+ * handle_request_input() once data is available.
  */
-static void *listener_main(void *arg_p)
+static void handle_accept(int listener)
 {
-    int listener;
     int client;
+    struct request_client_t *request_client_p;
+    struct epoll_event event;
+    int i;
+
+    client = accept(listener, NULL, NULL);
+
+    if (client == -1) {
+        perror("socket_device: accept");
+
+        return;
+    }
+
+    request_client_p = NULL;
+
+    for (i = 0; i < membersof(request_clients); i++) {
+        if (request_clients[i].socket == -1) {
+            request_client_p = &request_clients[i];
+            break;
+        }
+    }
+
+    if (request_client_p == NULL) {
+        printf("warning: socket_device: too many pending clients\n");
+        fflush(stdout);
+        close(client);
+
+        return;
+    }
+
+    /* Never block the thread on a client that sends nothing. */
+    if (fcntl(client, F_SETFL, O_NONBLOCK) != 0) {
+        perror("socket_device: fcntl");
+        close(client);
+
+        return;
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = request_client_p;
+
+    if (epoll_ctl(module.epoll, EPOLL_CTL_ADD, client, &event) != 0) {
+        perror("socket_device: epoll_ctl");
+        close(client);
+
+        return;
+    }
+
+    request_client_p->socket = client;
+    request_client_p->size = 0;
+}
+
+/**
+ * Read available device request data from given pending client, and
+ * connect the client to its device once the complete request has
+ * been received.
+ */
+static void handle_request_input(struct request_client_t *self_p)
+{
+    struct device_request_t *request_p;
+    uint8_t *buf_p;
+    size_t request_size;
     ssize_t size;
-    struct device_request_t request;
-    struct header_t response;
+    int client;
+
+    request_p = &self_p->request;
+    buf_p = (uint8_t *)request_p;
+    request_size = sizeof(request_p->header);
+
+    if (self_p->size >= sizeof(request_p->header)) {
+        request_size += ntohl(request_p->header.size);
+    }
+
+    size = read(self_p->socket,
+                &buf_p[self_p->size],
+                request_size - self_p->size);
+
+    if (size < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return;
+        }
+
+        perror("socket_device: read request");
+
+        goto err;
+    } else if (size == 0) {
+        goto err;
+    }
+
+    self_p->size += size;
+
+    if (self_p->size == sizeof(request_p->header)) {
+        /* Validate the device name size. */
+        if (ntohl(request_p->header.size) >= sizeof(request_p->device)) {
+            printf("warning: socket_device: bad request device name "
+                   "size %u\n",
+                   (unsigned int)ntohl(request_p->header.size));
+            fflush(stdout);
+
+            goto err;
+        }
+
+        request_size += ntohl(request_p->header.size);
+    }
+
+    if (self_p->size < request_size) {
+        return;
+    }
+
+    /* The complete request has been received. */
+    epoll_ctl(module.epoll, EPOLL_CTL_DEL, self_p->socket, NULL);
+    client = self_p->socket;
+    self_p->socket = -1;
+
+    /* Host byte order. */
+    request_p->header.type = ntohl(request_p->header.type);
+    request_p->header.size = ntohl(request_p->header.size);
+    request_p->device[request_p->header.size] = '\0';
+
+    /* Device data is written with blocking writes, and only read
+       when epoll reports that data is available. */
+    if (fcntl(client, F_SETFL, 0) != 0) {
+        perror("socket_device: fcntl");
+        close(client);
+
+        return;
+    }
+
+    if (handle_device_request(request_p, client) != 0) {
+        close(client);
+    }
+
+    return;
+
+ err:
+    epoll_ctl(module.epoll, EPOLL_CTL_DEL, self_p->socket, NULL);
+    close(self_p->socket);
+    self_p->socket = -1;
+}
+
+/**
+ * Returns true(1) if given epoll event data belongs to a client
+ * waiting for its device request to be received.
+ */
+static int is_request_client(void *data_p)
+{
+    return ((data_p >= (void *)&request_clients[0])
+            && (data_p < (void *)&request_clients[REQUEST_CLIENTS_MAX]));
+}
+
+/**
+ * Entry function of the socket device thread. Accepts clients and
+ * reads from all connected clients.
+ */
+static void *listener_main(void *arg_p)
+{
+    int listener;
+    struct epoll_event event;
+    struct epoll_event events[EVENTS_MAX];
+    struct client_t *client_p;
+    int i;
     int res;
 
     listener = setup_listener();
@@ -806,71 +1159,51 @@ static void *listener_main(void *arg_p)
         return (NULL);
     }
 
-    printf("info: socket_device: listening for clients on TCP port 47000\n");
-    fflush(stdout);
+    module.epoll = epoll_create1(0);
 
-    while (1) {
-        client = accept(listener, NULL, NULL);
+    if (module.epoll == -1) {
+        perror("socket_device: epoll_create1");
+        close(listener);
 
-        if (client == -1) {
-            perror("socket_device: accept");
-            continue;
-        }
+        return (NULL);
+    }
 
-        /* Read the request header. */
-        size = read(client, &request.header, sizeof(request.header));
+    /* The listener has no client. */
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
 
-        if (size != sizeof(request.header)) {
-            perror("socket_device: read request");
-            close(client);
-            continue;
-        }
+    if (epoll_ctl(module.epoll, EPOLL_CTL_ADD, listener, &event) != 0) {
+        perror("socket_device: epoll_ctl");
+        close(module.epoll);
+        close(listener);
 
-        /* Host byte order. */
-        request.header.type = ntohl(request.header.type);
-        request.header.size = ntohl(request.header.size);
+        return (NULL);
+    }
 
-        /* Validate the size. */
-        if (request.header.size >= sizeof(request.device)) {
-            perror("socket_device: read request size");
-            close(client);
-            continue;
-        }
+    printf("info: socket_device: listening for clients on TCP port 47000\n");
+    fflush(stdout);
+
+    while (1) {
+        res = epoll_wait(module.epoll, &events[0], membersof(events), -1);
 
-        /* Read the device name. */
-        size = read(client, &request.device[0], request.header.size);
+        if (res == -1) {
+            if (errno != EINTR) {
+                perror("socket_device: epoll_wait");
+            }
 
-        if (size != request.header.size) {
-            perror("socket_device: read request device name size");
-            close(client);
             continue;
         }
 
-        request.device[request.header.size] = '\0';
+        for (i = 0; i < res; i++) {
+            client_p = events[i].data.ptr;
 
-        /* Handle the request type. */
-        if (request.header.type == TYPE_UART_DEVICE_REQUEST) {
-            res = handle_uart_device_request(&request, client);
-        } else if (request.header.type == TYPE_PIN_DEVICE_REQUEST) {
-            res = handle_pin_device_request(&request, client);
-#if CONFIG_PWM == 1
-        } else if (request.header.type == TYPE_PWM_DEVICE_REQUEST) {
-            res = handle_pwm_device_request(&request, client);
-#endif
-        } else if (request.header.type == TYPE_CAN_DEVICE_REQUEST) {
-            res = handle_can_device_request(&request, client);
-        } else if (request.header.type == TYPE_I2C_DEVICE_REQUEST) {
-            res = handle_i2c_device_request(&request, client);
-        } else {
-            /* Send the response. */
-            response.type = htonl(TYPE_UNSUPPORTED_TYPE);
-            response.size = htonl(0);
-            write(client, &response, sizeof(response));
-            res = -1;
-        }
-
-        if (res != 0) {
-            close(client);
+            if (client_p == NULL) {
+                handle_accept(listener);
+            } else if (is_request_client(client_p)) {
+                handle_request_input(events[i].data.ptr);
+            } else if (handle_client_input(client_p) != 0) {
+                close_client(client_p);
+            }
         }
     }
 
@@ -908,12 +1241,16 @@ int socket_device_module_init()
         i2c_clients[i].socket = -1;
     }
 
+    for (i = 0; i < membersof(request_clients); i++) {
+        request_clients[i].socket = -1;
+    }
+
 #if CONFIG_LINUX_SOCKET_DEVICE == 1
 
     res = pthread_create(&module.thrd, NULL, listener_main, NULL);
 
     if (res != 0) {
-        fprintf(stderr, "error: creating uart device thread\n");
+        fprintf(stderr, "error: creating socket device thread\n");
     }
 
 #else
@@ -941,7 +1278,11 @@ ssize_t socket_device_uart_device_write_isr(
     const void *buf_p,
     size_t size)
 {
-    return (write(uart_clients[UART_INDEX(dev_p)].socket, buf_p, size));
+    return (client_write(&uart_clients[UART_INDEX(dev_p)],
+                         NULL,
+                         0,
+                         buf_p,
+                         size));
 }
 
 int socket_device_is_pin_device_connected_isr(
@@ -958,7 +1299,11 @@ ssize_t socket_device_pin_device_write_isr(const struct pin_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
-    return (write(pin_clients[PIN_INDEX(dev_p)].socket, buf_p, size));
+    return (client_write(&pin_clients[PIN_INDEX(dev_p)],
+                         NULL,
+                         0,
+                         buf_p,
+                         size));
 }
 
 int socket_device_is_pwm_device_connected_isr(
@@ -975,7 +1320,11 @@ ssize_t socket_device_pwm_device_write_isr(const struct pwm_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
-    return (write(pwm_clients[PWM_INDEX(dev_p)].socket, buf_p, size));
+    return (client_write(&pwm_clients[PWM_INDEX(dev_p)],
+                         NULL,
+                         0,
+                         buf_p,
+                         size));
 }
 
 int socket_device_is_can_device_connected_isr(
@@ -992,44 +1341,61 @@ ssize_t socket_device_can_device_write_isr(const struct can_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
+    struct client_t *client_p;
     const struct can_frame_t *frame_p;
-    char buf[64];
-    ssize_t res;
-    int socket;
+    char buf[512];
+    size_t buf_size;
     size_t i;
+    size_t j;
 
-    socket = can_clients[CAN_INDEX(dev_p)].socket;
-
+    client_p = &can_clients[CAN_INDEX(dev_p)];
     frame_p = (struct can_frame_t *)buf_p;
+    buf_size = 0;
 
-    /* Format the line to send to the client. */
-    sprintf(&buf[0],
-            "id=%08x,extended=%d,size=%d,data=",
-            frame_p->id,
-            (int)frame_p->extended_frame,
-            (int)frame_p->size);
-
-    res = write(socket, &buf[0], strlen(&buf[0]));
-
-    if (res != strlen(&buf[0])) {
-        return (-1);
-    }
+    /* Encode all frames and write them at once. */
+    for (i = 0; i < size / sizeof(*frame_p); i++, frame_p++) {
+        if (buf_size > sizeof(buf) - CAN_LINE_SIZE_MAX) {
+            if (write_buf(client_p->socket, &buf[0], buf_size) != 0) {
+                return (-1);
+            }
 
-    /* Write the data, one byte at a time. */
-    for (i = 0; i < frame_p->size; i++) {
-        sprintf(&buf[0], "%02x", frame_p->data.u8[i]);
+            buf_size = 0;
+        }
 
-        res = write(socket, &buf[0], 2);
+        if (client_p->binary == 1) {
+            buf[buf_size++] = 0;
+            buf[buf_size++] = (CAN_FRAME_PAYLOAD_SIZE_MIN + frame_p->size);
+            buf[buf_size++] = (frame_p->id >> 24);
+            buf[buf_size++] = (frame_p->id >> 16);
+            buf[buf_size++] = (frame_p->id >> 8);
+            buf[buf_size++] = frame_p->id;
+            buf[buf_size++] = (frame_p->extended_frame == 1
+                               ? CAN_FRAME_FLAGS_EXTENDED
+                               : 0);
+            buf[buf_size++] = frame_p->size;
+            memcpy(&buf[buf_size], &frame_p->data.u8[0], frame_p->size);
+            buf_size += frame_p->size;
+        } else {
+            buf_size += sprintf(&buf[buf_size],
+                                "id=%08x,extended=%d,size=%d,data=",
+                                (unsigned int)frame_p->id,
+                                (int)frame_p->extended_frame,
+                                (int)frame_p->size);
+
+            for (j = 0; j < frame_p->size; j++) {
+                buf_size += sprintf(&buf[buf_size],
+                                    "%02x",
+                                    frame_p->data.u8[j]);
+            }
 
-        if (res != 2) {
-            return (-1);
+            buf_size += sprintf(&buf[buf_size], "\r\n");
         }
     }
 
-    res = write(socket, "\r\n", 2);
-
-    if (res != 2) {
-        return (-1);
+    if (buf_size > 0) {
+        if (write_buf(client_p->socket, &buf[0], buf_size) != 0) {
+            return (-1);
+        }
     }
 
     return (size);
@@ -1050,39 +1416,46 @@ ssize_t socket_device_i2c_device_write_isr(const struct i2c_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
-    char buf[64];
-    ssize_t res;
-    int socket;
+    struct client_t *client_p;
+    char buf[128];
+    uint8_t header[I2C_FRAME_PAYLOAD_SIZE_MIN];
+    size_t line_size;
     size_t i;
     const uint8_t *byte_p;
 
-    socket = i2c_clients[I2C_INDEX(dev_p)].socket;
-
-    /* Write the address. */
-    sprintf(&buf[0], "address=%04x,size=%04lx,data=", address, size);
+    client_p = &i2c_clients[I2C_INDEX(dev_p)];
 
-    res = write(socket, &buf[0], strlen(&buf[0]));
+    if (client_p->binary == 1) {
+        header[0] = (address >> 8);
+        header[1] = address;
 
-    if (res != strlen(&buf[0])) {
-        return (-1);
+        return (client_write(client_p, &header[0], sizeof(header), buf_p, size));
     }
 
-    /* Write the data, one byte at a time. */
+    /* Write the address. */
+    line_size = sprintf(&buf[0],
+                        "address=%04x,size=%04lx,data=",
+                        address,
+                        (unsigned long)size);
+
+    /* Write the data, many bytes at a time. */
     byte_p = buf_p;
 
     for (i = 0; i < size; i++) {
-        sprintf(&buf[0], "%02x", byte_p[i]);
-
-        res = write(socket, &buf[0], 2);
+        if (line_size > sizeof(buf) - 3) {
+            if (write_buf(client_p->socket, &buf[0], line_size) != 0) {
+                return (-1);
+            }
 
-        if (res != 2) {
-            return (-1);
+            line_size = 0;
         }
+
+        line_size += sprintf(&buf[line_size], "%02x", byte_p[i]);
     }
 
-    res = write(socket, "\r\n", 2);
+    line_size += sprintf(&buf[line_size], "\r\n");
 
-    if (res != 2) {
+    if (write_buf(client_p->socket, &buf[0], line_size) != 0) {
         return (-1);
     }
 
@@ -0,0 +1,482 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#define _GNU_SOURCE
+
+#include "simba.h"
+
+#if CONFIG_LINUX_SOCKETCAN == 1 && CONFIG_CAN == 1
+
+#include "socketcan.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+
+/* Maximum number of frames per recvmmsg() and sendmmsg() call. */
+#define FRAMES_MAX                                       32
+
+struct scm_timestamps_t {
+    struct timespec software;
+    struct timespec deprecated;
+    struct timespec hardware;
+};
+
+static pthread_t reader_threads[CAN_DEVICE_MAX];
+
+#if CONFIG_CAN_FRAME_TIMESTAMP == 1
+
+/**
+ * Returns the reception timestamp in microseconds of given message,
+ * preferably the hardware timestamp.
+ */
+static uint32_t message_timestamp(struct msghdr *message_p)
+{
+    struct cmsghdr *cmsg_p;
+    struct scm_timestamps_t *timestamps_p;
+    struct timespec *timestamp_p;
+
+    for (cmsg_p = CMSG_FIRSTHDR(message_p);
+         cmsg_p != NULL;
+         cmsg_p = CMSG_NXTHDR(message_p, cmsg_p)) {
+        if ((cmsg_p->cmsg_level != SOL_SOCKET)
+            || (cmsg_p->cmsg_type != SO_TIMESTAMPING)) {
+            continue;
+        }
+
+        timestamps_p = (struct scm_timestamps_t *)CMSG_DATA(cmsg_p);
+        timestamp_p = &timestamps_p->hardware;
+
+        if ((timestamp_p->tv_sec == 0) && (timestamp_p->tv_nsec == 0)) {
+            timestamp_p = &timestamps_p->software;
+        }
+
+        return (timestamp_p->tv_sec * 1000000 + timestamp_p->tv_nsec / 1000);
+    }
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Read frames from the SocketCAN socket and write them to the input
+ * channel, many frames at a time. Returns when the driver is
+ * stopped, never while holding the system lock.
+ */
+static void *reader_main(void *arg_p)
+{
+    struct can_driver_t *self_p;
+    struct can_frame socket_frames[FRAMES_MAX];
+    struct can_frame_t frames[FRAMES_MAX];
+    struct mmsghdr messages[FRAMES_MAX];
+    struct iovec iovecs[FRAMES_MAX];
+    char controls[FRAMES_MAX][CMSG_SPACE(sizeof(struct scm_timestamps_t))];
+    struct pollfd fds[2];
+    int number_of_frames;
+    size_t size;
+    int i;
+
+    self_p = arg_p;
+
+    for (i = 0; i < FRAMES_MAX; i++) {
+        iovecs[i].iov_base = &socket_frames[i];
+        iovecs[i].iov_len = sizeof(socket_frames[i]);
+        memset(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    fds[0].fd = self_p->socket;
+    fds[0].events = POLLIN;
+    fds[1].fd = self_p->reader.event;
+    fds[1].events = POLLIN;
+
+    while (self_p->reader.stopped == 0) {
+        if (poll(&fds[0], membersof(fds), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        if ((self_p->reader.stopped == 1) || (fds[1].revents != 0)) {
+            break;
+        }
+
+        if ((fds[0].revents & POLLIN) == 0) {
+            break;
+        }
+
+        for (i = 0; i < FRAMES_MAX; i++) {
+            messages[i].msg_hdr.msg_control = &controls[i][0];
+            messages[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+        }
+
+        number_of_frames = recvmmsg(self_p->socket,
+                                    &messages[0],
+                                    FRAMES_MAX,
+                                    MSG_DONTWAIT,
+                                    NULL);
+
+        if (number_of_frames <= 0) {
+            if ((number_of_frames == -1)
+                && ((errno == EINTR)
+                    || (errno == EAGAIN)
+                    || (errno == EWOULDBLOCK))) {
+                continue;
+            }
+
+            break;
+        }
+
+        for (i = 0; i < number_of_frames; i++) {
+            frames[i].extended_frame =
+                ((socket_frames[i].can_id & CAN_EFF_FLAG) != 0);
+            frames[i].rtr = ((socket_frames[i].can_id & CAN_RTR_FLAG) != 0);
+
+            if (frames[i].extended_frame == 1) {
+                frames[i].id = (socket_frames[i].can_id & CAN_EFF_MASK);
+            } else {
+                frames[i].id = (socket_frames[i].can_id & CAN_SFF_MASK);
+            }
+
+            frames[i].size = MIN(socket_frames[i].can_dlc, 8);
+#if CONFIG_CAN_FRAME_TIMESTAMP == 1
+            frames[i].timestamp = message_timestamp(&messages[i].msg_hdr);
+#endif
+            memcpy(&frames[i].data.u8[0],
+                   &socket_frames[i].data[0],
+                   frames[i].size);
+        }
+
+        sys_lock();
+
+        /* Drop the frames that do not fit in the input channel. */
+        size = MIN(number_of_frames * sizeof(frames[0]),
+                   queue_unused_size_isr(&self_p->chin));
+        size -= (size % sizeof(frames[0]));
+
+        if (size > 0) {
+            queue_write_isr(&self_p->chin, &frames[0], size);
+
+            /* Resume any polling thread. */
+            if (chan_is_polled_isr(&self_p->base)) {
+                thrd_resume_isr(self_p->base.reader_p, 0);
+                self_p->base.reader_p = NULL;
+            }
+        }
+
+        sys_unlock();
+    }
+
+    return (NULL);
+}
+
+/**
+ * Write frames to the SocketCAN socket, many frames at a time.
+ */
+ssize_t socketcan_write(void *arg_p,
+                        const void *buf_p,
+                        size_t size)
+{
+    struct can_driver_t *self_p;
+    const struct can_frame_t *frame_p;
+    struct can_frame socket_frames[FRAMES_MAX];
+    struct mmsghdr messages[FRAMES_MAX];
+    struct iovec iovecs[FRAMES_MAX];
+    size_t left;
+    int number_of_frames;
+    int i;
+    int res;
+
+    self_p = arg_p;
+    frame_p = buf_p;
+    left = (size / sizeof(*frame_p));
+
+    while (left > 0) {
+        number_of_frames = MIN(left, FRAMES_MAX);
+
+        for (i = 0; i < number_of_frames; i++, frame_p++) {
+            memset(&socket_frames[i], 0, sizeof(socket_frames[i]));
+            socket_frames[i].can_id = frame_p->id;
+
+            if (frame_p->extended_frame == 1) {
+                socket_frames[i].can_id &= CAN_EFF_MASK;
+                socket_frames[i].can_id |= CAN_EFF_FLAG;
+            } else {
+                socket_frames[i].can_id &= CAN_SFF_MASK;
+            }
+
+            if (frame_p->rtr == 1) {
+                socket_frames[i].can_id |= CAN_RTR_FLAG;
+            }
+
+            socket_frames[i].can_dlc = MIN(frame_p->size, 8);
+            memcpy(&socket_frames[i].data[0],
+                   &frame_p->data.u8[0],
+                   socket_frames[i].can_dlc);
+            iovecs[i].iov_base = &socket_frames[i];
+            iovecs[i].iov_len = sizeof(socket_frames[i]);
+            memset(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        i = 0;
+
+        while (i < number_of_frames) {
+            res = sendmmsg(self_p->socket,
+                           &messages[i],
+                           number_of_frames - i,
+                           0);
+
+            if (res <= 0) {
+                if ((res == -1) && (errno == EINTR)) {
+                    continue;
+                }
+
+                return (-EIO);
+            }
+
+            i += res;
+        }
+
+        left -= number_of_frames;
+    }
+
+    return (size);
+}
+
+static int apply_filters(struct can_driver_t *self_p)
+{
+    struct can_filter filters[self_p->filters.length];
+    const struct can_port_filter_t *filter_p;
+    size_t i;
+
+    for (i = 0; i < self_p->filters.length; i++) {
+        filter_p = &self_p->filters.filters_p[i];
+
+        if (filter_p->extended_frame == 1) {
+            filters[i].can_id = ((filter_p->id & CAN_EFF_MASK) | CAN_EFF_FLAG);
+            filters[i].can_mask = ((filter_p->mask & CAN_EFF_MASK)
+                                   | CAN_EFF_FLAG);
+        } else {
+            filters[i].can_id = (filter_p->id & CAN_SFF_MASK);
+            filters[i].can_mask = ((filter_p->mask & CAN_SFF_MASK)
+                                   | CAN_EFF_FLAG);
+        }
+    }
+
+    if (setsockopt(self_p->socket,
+                   SOL_CAN_RAW,
+                   CAN_RAW_FILTER,
+                   &filters[0],
+                   sizeof(filters)) != 0) {
+        return (-errno);
+    }
+
+    return (0);
+}
+
+int socketcan_init(struct can_driver_t *self_p)
+{
+    self_p->socket = -1;
+    self_p->reader.event = -1;
+    self_p->filters.filters_p = NULL;
+    self_p->filters.length = 0;
+
+    return (0);
+}
+
+int socketcan_start(struct can_driver_t *self_p)
+{
+    struct ifreq ifr;
+    struct sockaddr_can addr;
+    struct can_device_t *dev_p;
+    int flags;
+    int res;
+
+    dev_p = self_p->dev_p;
+
+    if (dev_p->interface_p == NULL) {
+        snprintf(&ifr.ifr_name[0],
+                 sizeof(ifr.ifr_name),
+                 "can%d",
+                 (int)(dev_p - &can_device[0]));
+    } else {
+        strncpy(&ifr.ifr_name[0], dev_p->interface_p, sizeof(ifr.ifr_name));
+        ifr.ifr_name[sizeof(ifr.ifr_name) - 1] = '\0';
+    }
+
+    self_p->socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    if (self_p->socket == -1) {
+        perror("can_port: socket");
+
+        return (-ENETDOWN);
+    }
+
+    if (ioctl(self_p->socket, SIOCGIFINDEX, &ifr) != 0) {
+        fprintf(stderr, "can_port: no interface %s\n", &ifr.ifr_name[0]);
+
+        goto err;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(self_p->socket, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("can_port: bind");
+
+        goto err;
+    }
+
+    if (self_p->filters.length > 0) {
+        if (apply_filters(self_p) != 0) {
+            perror("can_port: filters");
+
+            goto err;
+        }
+    }
+
+#if CONFIG_CAN_FRAME_TIMESTAMP == 1
+    flags = (SOF_TIMESTAMPING_RX_HARDWARE
+             | SOF_TIMESTAMPING_RAW_HARDWARE
+             | SOF_TIMESTAMPING_RX_SOFTWARE
+             | SOF_TIMESTAMPING_SOFTWARE);
+
+    /* Timestamps are optional. */
+    (void)setsockopt(self_p->socket,
+                     SOL_SOCKET,
+                     SO_TIMESTAMPING,
+                     &flags,
+                     sizeof(flags));
+#else
+    (void)flags;
+#endif
+
+    self_p->reader.event = eventfd(0, 0);
+
+    if (self_p->reader.event == -1) {
+        perror("can_port: eventfd");
+
+        goto err;
+    }
+
+    self_p->reader.stopped = 0;
+    dev_p->drv_p = self_p;
+    res = pthread_create(&reader_threads[dev_p - &can_device[0]],
+                         NULL,
+                         reader_main,
+                         self_p);
+
+    if (res != 0) {
+        dev_p->drv_p = NULL;
+
+        goto err;
+    }
+
+    return (0);
+
+ err:
+    if (self_p->reader.event != -1) {
+        close(self_p->reader.event);
+        self_p->reader.event = -1;
+    }
+
+    close(self_p->socket);
+    self_p->socket = -1;
+
+    return (-ENETDOWN);
+}
+
+int socketcan_stop(struct can_driver_t *self_p)
+{
+    struct can_device_t *dev_p;
+    uint64_t value;
+
+    dev_p = self_p->dev_p;
+
+    if (self_p->socket != -1) {
+        /* Wake the reader and let it return by itself, as it may be
+           holding the system lock. */
+        self_p->reader.stopped = 1;
+        value = 1;
+
+        if (write(self_p->reader.event, &value, sizeof(value))
+            != sizeof(value)) {
+            perror("can_port: eventfd write");
+        }
+
+        pthread_join(reader_threads[dev_p - &can_device[0]], NULL);
+        close(self_p->reader.event);
+        self_p->reader.event = -1;
+        close(self_p->socket);
+        self_p->socket = -1;
+    }
+
+    dev_p->drv_p = NULL;
+
+    return (0);
+}
+
+int socketcan_set_interface(struct can_device_t *dev_p, const char *name_p)
+{
+    dev_p->interface_p = name_p;
+
+    return (0);
+}
+
+int socketcan_set_filters(struct can_driver_t *self_p,
+                          const struct can_port_filter_t *filters_p,
+                          size_t length)
+{
+    self_p->filters.filters_p = filters_p;
+    self_p->filters.length = length;
+
+    if (self_p->socket == -1) {
+        return (0);
+    }
+
+    return (apply_filters(self_p));
+}
+
+#endif
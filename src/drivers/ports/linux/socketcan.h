@@ -0,0 +1,89 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_SOCKETCAN_H__
+#define __DRIVERS_SOCKETCAN_H__
+
+#include "simba.h"
+
+/**
+ * Initialize given CAN driver for SocketCAN.
+ *
+ * @param[in] self_p CAN driver.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socketcan_init(struct can_driver_t *self_p);
+
+/**
+ * Open a raw SocketCAN socket bound to the network interface of the
+ * driver device, and start reading frames from it.
+ *
+ * @param[in] self_p CAN driver.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socketcan_start(struct can_driver_t *self_p);
+
+/**
+ * Stop reading frames and close the socket.
+ *
+ * @param[in] self_p CAN driver.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socketcan_stop(struct can_driver_t *self_p);
+
+/**
+ * Write given CAN frames to the socket.
+ *
+ * @param[in] arg_p CAN driver.
+ * @param[in] buf_p Array of CAN frames.
+ * @param[in] size Size of the array in bytes.
+ *
+ * @return Number of bytes written or negative error code.
+ */
+ssize_t socketcan_write(void *arg_p,
+                        const void *buf_p,
+                        size_t size);
+
+/**
+ * See `can_port_set_interface()`.
+ */
+int socketcan_set_interface(struct can_device_t *dev_p, const char *name_p);
+
+/**
+ * See `can_port_set_filters()`.
+ */
+int socketcan_set_filters(struct can_driver_t *self_p,
+                          const struct can_port_filter_t *filters_p,
+                          size_t length);
+
+#endif
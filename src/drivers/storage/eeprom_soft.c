@@ -45,6 +45,28 @@ struct chunk_header_t {
     uint16_t valid;
 } PACKED;
 
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+
+#define RECORD_HEADER_SIZE       sizeof(struct record_header_t)
+
+/**
+ * Size of a record with given data size. The data is padded to a
+ * multiple of eight bytes.
+ */
+#define RECORD_SIZE(size) (RECORD_HEADER_SIZE + (((size) + 7) & ~7))
+
+/**
+ * A record in the log. The crc is calculated over offset, size and
+ * data.
+ */
+struct record_header_t {
+    uint16_t offset;
+    uint16_t size;
+    uint32_t crc;
+} PACKED;
+
+#endif
+
 /**
  * Calculate the crc of the chunk at given address.
  */
@@ -63,7 +85,7 @@ static uint32_t calculate_chunk_crc(struct eeprom_soft_driver_t *self_p,
 
     offset = CHUNK_HEADER_SIZE;
 
-    while (offset < self_p->chunk_size) {
+    while (offset < CHUNK_HEADER_SIZE + self_p->eeprom_size) {
         size = flash_read(self_p->flash_p,
                           &buf[0],
                           address + offset,
@@ -222,11 +244,13 @@ static int write_header(struct eeprom_soft_driver_t *self_p,
 {
     ssize_t size;
     struct chunk_header_t header;
+    uint32_t crc;
 
-    if (calculate_chunk_crc(self_p, &header.crc, chunk_address) != 0) {
+    if (calculate_chunk_crc(self_p, &crc, chunk_address) != 0) {
         return (-1);
     }
 
+    header.crc = crc;
     header.revision = revision;
     header.valid = VALID_PATTERN;
 
@@ -242,6 +266,332 @@ static int write_header(struct eeprom_soft_driver_t *self_p,
     return (0);
 }
 
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+
+/**
+ * Update given crc with given data.
+ */
+static uint32_t update_record_crc(uint32_t crc,
+                                  const void *buf_p,
+                                  size_t size)
+{
+#if CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_32
+    return (crc_32(crc, buf_p, size));
+#elif CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_CCITT
+    return (crc_ccitt(crc, buf_p, size));
+#endif
+}
+
+/**
+ * Calculate the crc of the record offset and size.
+ */
+static uint32_t calculate_record_header_crc(uint16_t offset, uint16_t size)
+{
+    uint32_t crc;
+
+#if CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_32
+    crc = 0;
+#elif CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_CCITT
+    crc = 0xffff;
+#endif
+
+    crc = update_record_crc(crc, &offset, sizeof(offset));
+
+    return (update_record_crc(crc, &size, sizeof(size)));
+}
+
+/**
+ * Calculate the crc of the record with given header at given flash
+ * address.
+ */
+static int calculate_record_crc(struct eeprom_soft_driver_t *self_p,
+                                uint32_t *crc_p,
+                                uintptr_t address,
+                                uint16_t offset,
+                                uint16_t size)
+{
+    uint8_t buf[8];
+    size_t left;
+    size_t n;
+    uint32_t crc;
+
+    crc = calculate_record_header_crc(offset, size);
+    address += RECORD_HEADER_SIZE;
+    left = size;
+
+    while (left > 0) {
+        n = MIN(left, sizeof(buf));
+
+        if (flash_read(self_p->flash_p, &buf[0], address, n) != n) {
+            return (-1);
+        }
+
+        crc = update_record_crc(crc, &buf[0], n);
+        address += n;
+        left -= n;
+    }
+
+    *crc_p = crc;
+
+    return (0);
+}
+
+/**
+ * Address of the first record in the log of given chunk.
+ */
+static uintptr_t log_begin(struct eeprom_soft_driver_t *self_p,
+                           uintptr_t chunk_address)
+{
+    return (chunk_address + CHUNK_HEADER_SIZE + self_p->eeprom_size);
+}
+
+/**
+ * Reset the log for given, newly written, chunk.
+ */
+static void log_reset(struct eeprom_soft_driver_t *self_p,
+                      uintptr_t chunk_address)
+{
+    self_p->log.address = log_begin(self_p, chunk_address);
+    self_p->log.dirty = 0;
+    self_p->log.length = 0;
+}
+
+/**
+ * Add a record to the in-RAM index. Records completely overwritten
+ * by the new record are removed from the index.
+ */
+static void log_index_add(struct eeprom_soft_driver_t *self_p,
+                          uint16_t offset,
+                          uint16_t size,
+                          uintptr_t address)
+{
+    struct eeprom_soft_record_t *record_p;
+    int i;
+    int length;
+
+    length = 0;
+
+    for (i = 0; i < self_p->log.length; i++) {
+        record_p = &self_p->log.records[i];
+
+        if ((record_p->offset >= offset)
+            && (record_p->offset + record_p->size <= offset + size)) {
+            continue;
+        }
+
+        self_p->log.records[length++] = *record_p;
+    }
+
+    record_p = &self_p->log.records[length];
+    record_p->offset = offset;
+    record_p->size = size;
+    record_p->address = address;
+    self_p->log.length = (length + 1);
+}
+
+/**
+ * Replay the log of the current chunk into the in-RAM index. A torn
+ * or corrupt record ends the log and marks it dirty, forcing a
+ * compaction on next write.
+ */
+static int log_mount(struct eeprom_soft_driver_t *self_p)
+{
+    struct record_header_t header;
+    uintptr_t address;
+    uintptr_t end;
+    uint32_t crc;
+    uint16_t offset;
+    uint16_t size;
+
+    log_reset(self_p, self_p->current.chunk_address);
+    address = self_p->log.address;
+    end = (self_p->current.chunk_address + self_p->chunk_size);
+
+    while (address + RECORD_HEADER_SIZE <= end) {
+        if (flash_read(self_p->flash_p,
+                       &header,
+                       address,
+                       sizeof(header)) != sizeof(header)) {
+            return (-1);
+        }
+
+        offset = header.offset;
+        size = header.size;
+
+        /* End of log. */
+        if ((offset == 0xffff)
+            && (size == 0xffff)
+            && (header.crc == 0xffffffff)) {
+            break;
+        }
+
+        if ((size == 0)
+            || (offset + size > self_p->eeprom_size)
+            || (address + RECORD_SIZE(size) > end)
+            || (self_p->log.length == EEPROM_SOFT_LOG_RECORDS_MAX)) {
+            self_p->log.dirty = 1;
+            break;
+        }
+
+        if (calculate_record_crc(self_p, &crc, address, offset, size) != 0) {
+            return (-1);
+        }
+
+        if (crc != header.crc) {
+            self_p->log.dirty = 1;
+            break;
+        }
+
+        log_index_add(self_p, offset, size, address + RECORD_HEADER_SIZE);
+        address += RECORD_SIZE(size);
+
+#if CONFIG_PREEMPTIVE_SCHEDULER == 0
+        thrd_yield();
+#endif
+    }
+
+    self_p->log.address = address;
+
+    return (0);
+}
+
+/**
+ * Returns true(1) if a record with given size fits in the log of the
+ * current chunk, otherwise false(0).
+ */
+static int log_has_space(struct eeprom_soft_driver_t *self_p, size_t size)
+{
+    uintptr_t end;
+
+    if (self_p->log.dirty == 1) {
+        return (0);
+    }
+
+    if (self_p->log.length == EEPROM_SOFT_LOG_RECORDS_MAX) {
+        return (0);
+    }
+
+    end = (self_p->current.chunk_address + self_p->chunk_size);
+
+    return (self_p->log.address + RECORD_SIZE(size) <= end);
+}
+
+/**
+ * Append a record to the log of the current chunk. The header is
+ * written before the data so a torn write is detected by the crc
+ * when the log is replayed.
+ */
+static ssize_t log_append(struct eeprom_soft_driver_t *self_p,
+                          uintptr_t dst,
+                          const void *src_p,
+                          size_t size)
+{
+    struct record_header_t header;
+    uint8_t buf[8];
+    uintptr_t address;
+    const uint8_t *u8_src_p;
+    size_t left;
+    size_t n;
+    uint32_t crc;
+
+    crc = calculate_record_header_crc(dst, size);
+    crc = update_record_crc(crc, src_p, size);
+    header.offset = dst;
+    header.size = size;
+    header.crc = crc;
+    address = self_p->log.address;
+
+    /* Always mark the log dirty on failure. */
+    self_p->log.dirty = 1;
+
+    if (flash_write(self_p->flash_p,
+                    address,
+                    &header,
+                    sizeof(header)) != sizeof(header)) {
+        return (-1);
+    }
+
+    address += RECORD_HEADER_SIZE;
+    u8_src_p = src_p;
+    left = size;
+
+    while (left > 0) {
+        n = MIN(left, sizeof(buf));
+        memset(&buf[0], 0xff, sizeof(buf));
+        memcpy(&buf[0], u8_src_p, n);
+
+        if (flash_write(self_p->flash_p,
+                        address,
+                        &buf[0],
+                        sizeof(buf)) != sizeof(buf)) {
+            return (-1);
+        }
+
+        address += sizeof(buf);
+        u8_src_p += n;
+        left -= n;
+    }
+
+    log_index_add(self_p,
+                  dst,
+                  size,
+                  self_p->log.address + RECORD_HEADER_SIZE);
+    self_p->log.address = address;
+    self_p->log.dirty = 0;
+
+    return (size);
+}
+
+#endif
+
+/**
+ * Read from the current chunk, including any log records.
+ */
+static ssize_t read_inner(struct eeprom_soft_driver_t *self_p,
+                          void *dst_p,
+                          uintptr_t src,
+                          size_t size)
+{
+    ssize_t res;
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+    struct eeprom_soft_record_t *record_p;
+    uintptr_t begin;
+    uintptr_t end;
+    int i;
+#endif
+
+    res = flash_read(self_p->flash_p,
+                     dst_p,
+                     self_p->current.chunk_address + CHUNK_HEADER_SIZE + src,
+                     size);
+
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+    if (res != size) {
+        return (res);
+    }
+
+    /* Apply the records in the order they were written. */
+    for (i = 0; i < self_p->log.length; i++) {
+        record_p = &self_p->log.records[i];
+        begin = MAX(src, record_p->offset);
+        end = MIN(src + size, record_p->offset + record_p->size);
+
+        if (begin >= end) {
+            continue;
+        }
+
+        if (flash_read(self_p->flash_p,
+                       (uint8_t *)dst_p + (begin - src),
+                       record_p->address + (begin - record_p->offset),
+                       end - begin) != (end - begin)) {
+            return (-1);
+        }
+    }
+#endif
+
+    return (res);
+}
+
 static ssize_t write_inner(struct eeprom_soft_driver_t *self_p,
                            uintptr_t dst,
                            const void *src_p,
@@ -264,6 +614,13 @@ static ssize_t write_inner(struct eeprom_soft_driver_t *self_p,
         return (-EINVAL);
     }
 
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+    if (log_has_space(self_p, size) == 1) {
+        return (log_append(self_p, dst, src_p, size));
+    }
+#endif
+
+    /* Compact the current chunk and given data into a new chunk. */
     if (get_blank_chunk(self_p, &block_p, &chunk_address) != 0) {
         return (-1);
     }
@@ -273,10 +630,7 @@ static ssize_t write_inner(struct eeprom_soft_driver_t *self_p,
 
     for (offset = 0; offset < self_p->eeprom_size; offset += sizeof(buf)) {
         /* Read from old chunk. */
-        if (flash_read(self_p->flash_p,
-                       &buf[0],
-                       self_p->current.chunk_address + CHUNK_HEADER_SIZE + offset,
-                       sizeof(buf)) != sizeof(buf)) {
+        if (read_inner(self_p, &buf[0], offset, sizeof(buf)) != sizeof(buf)) {
             return (-1);
         }
 
@@ -324,6 +678,10 @@ static ssize_t write_inner(struct eeprom_soft_driver_t *self_p,
     self_p->current.chunk_address = chunk_address;
     self_p->current.revision = revision;
 
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+    log_reset(self_p, chunk_address);
+#endif
+
     return (size);
 }
 
@@ -342,12 +700,16 @@ int eeprom_soft_init(struct eeprom_soft_driver_t *self_p,
     ASSERTN(flash_p != NULL, EINVAL);
     ASSERTN(blocks_p != NULL, EINVAL);
     ASSERTN(number_of_blocks >= 2, EINVAL);
+    ASSERTN(chunk_size > CHUNK_HEADER_SIZE + CONFIG_EEPROM_SOFT_LOG_SIZE,
+            EINVAL);
 
     self_p->flash_p = flash_p;
     self_p->blocks_p = blocks_p;
     self_p->number_of_blocks = number_of_blocks;
     self_p->chunk_size = chunk_size;
-    self_p->eeprom_size = (chunk_size - CHUNK_HEADER_SIZE);
+    self_p->eeprom_size = (chunk_size
+                           - CHUNK_HEADER_SIZE
+                           - CONFIG_EEPROM_SOFT_LOG_SIZE);
     self_p->current.block_p = NULL;
     self_p->current.chunk_address = 0xffffffff;
 
@@ -435,6 +797,10 @@ int eeprom_soft_mount(struct eeprom_soft_driver_t *self_p)
             self_p->current.chunk_address = latest_chunk_address;
             self_p->current.revision = latest_revision;
             res = 0;
+
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+            res = log_mount(self_p);
+#endif
         }
     }
 
@@ -463,8 +829,7 @@ ssize_t eeprom_soft_read(struct eeprom_soft_driver_t *self_p,
     sem_take(&self_p->sem, NULL);
 #endif
 
-    src += (self_p->current.chunk_address + CHUNK_HEADER_SIZE);
-    res = flash_read(self_p->flash_p, dst_p, src, size);
+    res = read_inner(self_p, dst_p, src, size);
 
 #if CONFIG_EEPROM_SOFT_SEMAPHORE == 1
     sem_give(&self_p->sem, 1);
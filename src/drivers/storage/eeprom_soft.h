@@ -33,11 +33,30 @@
 
 #include "simba.h"
 
+/**
+ * Maximum number of records in the log of a chunk. A record is at
+ * least 16 bytes.
+ */
+#define EEPROM_SOFT_LOG_RECORDS_MAX (CONFIG_EEPROM_SOFT_LOG_SIZE / 16)
+
 struct eeprom_soft_block_t {
     uintptr_t address;
     size_t size;
 };
 
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+
+/**
+ * In-RAM index entry of a log record.
+ */
+struct eeprom_soft_record_t {
+    uint16_t offset;
+    uint16_t size;
+    uintptr_t address;
+};
+
+#endif
+
 struct eeprom_soft_driver_t {
     struct flash_driver_t *flash_p;
     const struct eeprom_soft_block_t *blocks_p;
@@ -49,6 +68,14 @@ struct eeprom_soft_driver_t {
         uintptr_t chunk_address;
         uint16_t revision;
     } current;
+#if CONFIG_EEPROM_SOFT_LOG_SIZE > 0
+    struct {
+        uintptr_t address;
+        int dirty;
+        int length;
+        struct eeprom_soft_record_t records[EEPROM_SOFT_LOG_RECORDS_MAX];
+    } log;
+#endif
 #if CONFIG_EEPROM_SOFT_SEMAPHORE == 1
     struct sem_t sem;
 #endif
@@ -74,8 +101,11 @@ int eeprom_soft_module_init(void);
  * @param[in] number_of_blocks Number of blocks.
  * @param[in] chunk_size Chunk size in bytes. This is the size of the
  *                       EEPROM. Eight bytes of the chunk will be used
- *                       to store metadata, so only `chunk_size - 8`
- *                       bytes are available to the user.
+ *                       to store metadata and
+ *                       `CONFIG_EEPROM_SOFT_LOG_SIZE` bytes for the
+ *                       record log, so only `chunk_size - 8 -
+ *                       CONFIG_EEPROM_SOFT_LOG_SIZE` bytes are
+ *                       available to the user.
  *
  * @return zero(0) or negative error code.
  */
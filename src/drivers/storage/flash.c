@@ -133,4 +133,285 @@ int flash_erase(struct flash_driver_t *self_p,
     return (res);
 }
 
+/**
+ * Put given job last in the job queue, waiting for a free slot if
+ * full. Called with the mutex locked.
+ */
+static void async_job_put(struct flash_async_t *self_p,
+                          int type,
+                          int buffer,
+                          uintptr_t addr,
+                          size_t size)
+{
+    struct flash_async_job_t *job_p;
+
+    while (self_p->jobs.count == self_p->jobs.length) {
+        cond_wait(&self_p->done_cond, &self_p->mutex, NULL);
+    }
+
+    job_p = &self_p->jobs.buf_p[(self_p->jobs.head + self_p->jobs.count)
+                                % self_p->jobs.length];
+    job_p->type = type;
+    job_p->buffer = buffer;
+    job_p->addr = addr;
+    job_p->size = size;
+    self_p->jobs.count++;
+    cond_signal(&self_p->jobs_cond);
+}
+
+/**
+ * Queue the current buffer for programming, if it contains any data,
+ * and switch to the other buffer. Called with the mutex locked.
+ */
+static void async_buffer_submit(struct flash_async_t *self_p)
+{
+    int current;
+
+    current = self_p->buffers.current;
+
+    if (self_p->buffers.offset == 0) {
+        return;
+    }
+
+    self_p->buffers.busy[current] = 1;
+    async_job_put(self_p,
+                  FLASH_ASYNC_JOB_TYPE_WRITE,
+                  current,
+                  self_p->buffers.addr,
+                  self_p->buffers.offset);
+    self_p->buffers.current = (current ^ 1);
+    self_p->buffers.offset = 0;
+}
+
+static int async_job_execute(struct flash_async_t *self_p,
+                             struct flash_async_job_t *job_p)
+{
+    ssize_t res;
+
+    if (job_p->type == FLASH_ASYNC_JOB_TYPE_WRITE) {
+        res = flash_write(self_p->drv_p,
+                          job_p->addr,
+                          self_p->buffers.buf_p[(int)job_p->buffer],
+                          job_p->size);
+
+        if (res == (ssize_t)job_p->size) {
+            res = 0;
+        } else if (res >= 0) {
+            res = -EIO;
+        }
+    } else {
+        res = flash_erase(self_p->drv_p, job_p->addr, job_p->size);
+    }
+
+    return (res);
+}
+
+static void *async_main(void *arg_p)
+{
+    struct flash_async_t *self_p;
+    struct flash_async_job_t job;
+    int res;
+
+    self_p = arg_p;
+    thrd_set_name("flash_async");
+
+    mutex_lock(&self_p->mutex);
+
+    while (1) {
+        while (self_p->jobs.count == 0) {
+            cond_wait(&self_p->jobs_cond, &self_p->mutex, NULL);
+        }
+
+        /* The job stays in the queue until completed, so a sync
+           waits for it. */
+        job = self_p->jobs.buf_p[self_p->jobs.head];
+        mutex_unlock(&self_p->mutex);
+
+        res = async_job_execute(self_p, &job);
+
+        if (self_p->callback != NULL) {
+            self_p->callback(self_p->arg_p,
+                             job.type,
+                             job.addr,
+                             job.size,
+                             res);
+        }
+
+        mutex_lock(&self_p->mutex);
+
+        if ((res != 0) && (self_p->res == 0)) {
+            self_p->res = res;
+        }
+
+        if (job.type == FLASH_ASYNC_JOB_TYPE_WRITE) {
+            self_p->buffers.busy[(int)job.buffer] = 0;
+        }
+
+        self_p->jobs.head = ((self_p->jobs.head + 1) % self_p->jobs.length);
+        self_p->jobs.count--;
+        cond_broadcast(&self_p->done_cond);
+    }
+
+    return (NULL);
+}
+
+int flash_async_init(struct flash_async_t *self_p,
+                     struct flash_driver_t *drv_p,
+                     struct flash_async_job_t *jobs_p,
+                     size_t length,
+                     void *buf_p,
+                     size_t size,
+                     void *stack_p,
+                     size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(drv_p != NULL, EINVAL);
+    ASSERTN(jobs_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size >= 2, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+    self_p->drv_p = drv_p;
+    self_p->jobs.buf_p = jobs_p;
+    self_p->jobs.length = length;
+    self_p->jobs.head = 0;
+    self_p->jobs.count = 0;
+    self_p->buffers.size = (size / 2);
+    self_p->buffers.buf_p[0] = buf_p;
+    self_p->buffers.buf_p[1] = &((uint8_t *)buf_p)[self_p->buffers.size];
+    self_p->buffers.busy[0] = 0;
+    self_p->buffers.busy[1] = 0;
+    self_p->buffers.current = 0;
+    self_p->buffers.addr = 0;
+    self_p->buffers.offset = 0;
+    self_p->callback = NULL;
+    self_p->arg_p = NULL;
+    self_p->res = 0;
+    self_p->stack_p = stack_p;
+    self_p->stack_size = stack_size;
+    self_p->thrd_p = NULL;
+    mutex_init(&self_p->mutex);
+    cond_init(&self_p->jobs_cond);
+    cond_init(&self_p->done_cond);
+
+    return (0);
+}
+
+int flash_async_set_callback(struct flash_async_t *self_p,
+                             flash_async_callback_t callback,
+                             void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+
+    return (0);
+}
+
+int flash_async_start(struct flash_async_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->thrd_p = thrd_spawn(async_main,
+                                self_p,
+                                0,
+                                self_p->stack_p,
+                                self_p->stack_size);
+
+    return (self_p->thrd_p != NULL ? 0 : -1);
+}
+
+ssize_t flash_async_write(struct flash_async_t *self_p,
+                          uintptr_t dst,
+                          const void *src_p,
+                          size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    const uint8_t *u8_src_p;
+    size_t left;
+    size_t chunk_size;
+    int current;
+
+    u8_src_p = src_p;
+    left = size;
+
+    mutex_lock(&self_p->mutex);
+
+    while (left > 0) {
+        /* Start a new buffer for non-contiguous data. */
+        if ((self_p->buffers.offset > 0)
+            && (dst != self_p->buffers.addr + self_p->buffers.offset)) {
+            async_buffer_submit(self_p);
+        }
+
+        current = self_p->buffers.current;
+
+        /* Wait for the buffer to be programmed. */
+        while (self_p->buffers.busy[current] == 1) {
+            cond_wait(&self_p->done_cond, &self_p->mutex, NULL);
+        }
+
+        if (self_p->buffers.offset == 0) {
+            self_p->buffers.addr = dst;
+        }
+
+        chunk_size = MIN(left, self_p->buffers.size - self_p->buffers.offset);
+        memcpy(&self_p->buffers.buf_p[current][self_p->buffers.offset],
+               u8_src_p,
+               chunk_size);
+        self_p->buffers.offset += chunk_size;
+        u8_src_p += chunk_size;
+        dst += chunk_size;
+        left -= chunk_size;
+
+        if (self_p->buffers.offset == self_p->buffers.size) {
+            async_buffer_submit(self_p);
+        }
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (size);
+}
+
+int flash_async_erase(struct flash_async_t *self_p,
+                      uintptr_t addr,
+                      size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    mutex_lock(&self_p->mutex);
+    async_buffer_submit(self_p);
+    async_job_put(self_p, FLASH_ASYNC_JOB_TYPE_ERASE, -1, addr, size);
+    mutex_unlock(&self_p->mutex);
+
+    return (0);
+}
+
+int flash_async_sync(struct flash_async_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    mutex_lock(&self_p->mutex);
+    async_buffer_submit(self_p);
+
+    while (self_p->jobs.count > 0) {
+        cond_wait(&self_p->done_cond, &self_p->mutex, NULL);
+    }
+
+    res = self_p->res;
+    self_p->res = 0;
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
 #endif
@@ -34,6 +34,64 @@
 #include "simba.h"
 #include "flash_port.h"
 
+/* Asynchronous flash job types. */
+#define FLASH_ASYNC_JOB_TYPE_WRITE                          0
+#define FLASH_ASYNC_JOB_TYPE_ERASE                          1
+
+/**
+ * Called by the asynchronous flash writer thread when a job has been
+ * completed.
+ *
+ * @param[in] arg_p Callback argument.
+ * @param[in] type Job type, ``FLASH_ASYNC_JOB_TYPE_*``.
+ * @param[in] addr Job flash memory address.
+ * @param[in] size Job size in bytes.
+ * @param[in] res Job result, zero(0) or negative error code.
+ */
+typedef void (*flash_async_callback_t)(void *arg_p,
+                                       int type,
+                                       uintptr_t addr,
+                                       size_t size,
+                                       int res);
+
+struct flash_async_job_t {
+    int8_t type;
+    int8_t buffer;
+    uintptr_t addr;
+    size_t size;
+};
+
+/**
+ * Write-behind service performing writes and erases in a separate
+ * thread.
+ */
+struct flash_async_t {
+    struct flash_driver_t *drv_p;
+    struct {
+        struct flash_async_job_t *buf_p;
+        size_t length;
+        size_t head;
+        size_t count;
+    } jobs;
+    struct {
+        uint8_t *buf_p[2];
+        int8_t busy[2];
+        size_t size;
+        int8_t current;
+        uintptr_t addr;
+        size_t offset;
+    } buffers;
+    flash_async_callback_t callback;
+    void *arg_p;
+    int res;
+    struct mutex_t mutex;
+    struct cond_t jobs_cond;
+    struct cond_t done_cond;
+    void *stack_p;
+    size_t stack_size;
+    struct thrd_t *thrd_p;
+};
+
 extern struct flash_device_t flash_device[FLASH_DEVICE_MAX];
 
 /**
@@ -101,4 +159,96 @@ int flash_erase(struct flash_driver_t *self_p,
                 uintptr_t addr,
                 size_t size);
 
+/**
+ * Initialize given asynchronous flash writer. Writes are copied to
+ * one of two buffers, and a full buffer is programmed by the writer
+ * thread while the other buffer is filled. Erases are queued in the
+ * same job queue to keep the order of all operations.
+ *
+ * @param[out] self_p Asynchronous flash writer to initialize.
+ * @param[in] drv_p Initialized flash driver to write and erase with.
+ * @param[in] jobs_p Job queue buffer.
+ * @param[in] length Number of jobs in the job queue buffer.
+ * @param[in] buf_p Write buffer, split into two equally sized
+ *                  buffers. A multiple of two times the flash page
+ *                  size is recommended.
+ * @param[in] size Write buffer size in bytes.
+ * @param[in] stack_p Writer thread stack.
+ * @param[in] stack_size Writer thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_async_init(struct flash_async_t *self_p,
+                     struct flash_driver_t *drv_p,
+                     struct flash_async_job_t *jobs_p,
+                     size_t length,
+                     void *buf_p,
+                     size_t size,
+                     void *stack_p,
+                     size_t stack_size);
+
+/**
+ * Set the callback called by the writer thread when a job has been
+ * completed. Must be called before starting the writer.
+ *
+ * @param[in] self_p Initialized asynchronous flash writer.
+ * @param[in] callback Job completion callback, or NULL.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_async_set_callback(struct flash_async_t *self_p,
+                             flash_async_callback_t callback,
+                             void *arg_p);
+
+/**
+ * Start the writer thread of given asynchronous flash writer.
+ *
+ * @param[in] self_p Initialized asynchronous flash writer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_async_start(struct flash_async_t *self_p);
+
+/**
+ * Copy given data to the write buffer. Returns as soon as the data
+ * has been copied, which only waits for the flash if both buffers
+ * are being programmed. Non-contiguous writes start a new buffer.
+ *
+ * @param[in] self_p Started asynchronous flash writer.
+ * @param[in] dst Address in flash memory to write to.
+ * @param[in] src_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of buffered bytes or negative error code.
+ */
+ssize_t flash_async_write(struct flash_async_t *self_p,
+                          uintptr_t dst,
+                          const void *src_p,
+                          size_t size);
+
+/**
+ * Queue an erase of all sectors part of given memory range, after
+ * all previous writes.
+ *
+ * @param[in] self_p Started asynchronous flash writer.
+ * @param[in] addr Address in flash memory to erase from.
+ * @param[in] size Number of bytes to erase.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_async_erase(struct flash_async_t *self_p,
+                      uintptr_t addr,
+                      size_t size);
+
+/**
+ * Wait for all buffered writes and queued erases to complete.
+ *
+ * @param[in] self_p Started asynchronous flash writer.
+ *
+ * @return zero(0) if all jobs since the previous sync were
+ *         successful, otherwise the first negative error code.
+ */
+int flash_async_sync(struct flash_async_t *self_p);
+
 #endif
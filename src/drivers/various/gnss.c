@@ -51,49 +51,34 @@ static int get_data_age(struct time_t *timestamp_p)
 }
 
 /**
- * Read a single byte from the transport channel.
- *
- * @return zero(0) or negative error code.
- */
-static int read_byte(struct gnss_driver_t *self_p,
-                     char *byte_p)
-{
-    int res;
-
-    res = chan_read(self_p->chin_p,
-                    byte_p,
-                    sizeof(*byte_p));
-
-    if (res == 0) {
-        res = -EIO;
-    }
-
-    return (res);
-}
-
-/**
- * Find the start of an NMEA sentence (dollar sign).
+ * Find the start of an NMEA sentence (dollar sign). Bytes before it
+ * are discarded.
  */
 static int find_sentence_start(struct gnss_driver_t *self_p)
 {
-    int res;
-    char byte;
+    ssize_t res;
+    char *buf_p;
 
     while (1) {
-        res = read_byte(self_p, &byte);
+        res = chan_reader_read_until(&self_p->reader, '$', &buf_p);
 
-        if (res != sizeof(byte)) {
-            return (res);
+        if (res > 0) {
+            break;
         }
 
-        if (byte == '$') {
-            self_p->nmea.input.buf[0] = '$';
-            self_p->nmea.input.size = 1;
-            DLOG(DEBUG, "NMEA sentence start found.\r\n");
-            break;
+        if (res != -ENOMEM) {
+            return (res);
         }
+
+        /* No dollar sign in the full reader buffer. */
+        chan_reader_skip(&self_p->reader,
+                         chan_reader_buffered(&self_p->reader));
     }
 
+    self_p->nmea.input.buf[0] = '$';
+    self_p->nmea.input.size = 1;
+    DLOG(DEBUG, "NMEA sentence start found.\r\n");
+
     return (0);
 }
 
@@ -102,31 +87,32 @@ static int find_sentence_start(struct gnss_driver_t *self_p)
  */
 static int read_until_sentence_end(struct gnss_driver_t *self_p)
 {
-    int res;
-    char byte;
+    ssize_t res;
+    char *buf_p;
 
-    while (1) {
-        res = read_byte(self_p, &byte);
+    res = chan_reader_read_until(&self_p->reader, '\n', &buf_p);
 
-        if (res != sizeof(byte)) {
-            return (res);
-        }
+    if (res == -ENOMEM) {
+        /* No linefeed in the full reader buffer. */
+        chan_reader_skip(&self_p->reader,
+                         chan_reader_buffered(&self_p->reader));
+        self_p->nmea.input.size = 0;
 
-        /* Space for the read character and a null-termination. */
-        if ((self_p->nmea.input.size + 1) == sizeof(self_p->nmea.input.buf)) {
-            self_p->nmea.input.size = 0;
-            return (-ENOMEM);
-        }
-
-        self_p->nmea.input.buf[self_p->nmea.input.size] = byte;
-        self_p->nmea.input.size++;
+        return (res);
+    } else if (res < 0) {
+        return (res);
+    }
 
-        if (byte == '\n') {
-            self_p->nmea.input.buf[self_p->nmea.input.size] = '\0';
-            break;
-        }
+    /* Space for the read characters and a null-termination. */
+    if ((self_p->nmea.input.size + res) >= sizeof(self_p->nmea.input.buf)) {
+        self_p->nmea.input.size = 0;
+        return (-ENOMEM);
     }
 
+    memcpy(&self_p->nmea.input.buf[self_p->nmea.input.size], buf_p, res);
+    self_p->nmea.input.size += res;
+    self_p->nmea.input.buf[self_p->nmea.input.size] = '\0';
+
     return (0);
 }
 
@@ -333,6 +319,10 @@ int gnss_init(struct gnss_driver_t *self_p,
     self_p->gga_timestamp.seconds = -1;
     self_p->position.timestamp_p = &self_p->rmc_timestamp;
     self_p->nmea.input.size = 0;
+    chan_reader_init(&self_p->reader,
+                     chin_p,
+                     &self_p->reader_buf[0],
+                     sizeof(self_p->reader_buf));
 
 #if CONFIG_GNSS_DEBUG_LOG_MASK > -1
     log_object_init(&self_p->log, "gnss", CONFIG_GNSS_DEBUG_LOG_MASK);
@@ -54,6 +54,10 @@ struct gnss_driver_t {
         } input;
         struct nmea_sentence_t decoded;
     } nmea;
+    struct chan_reader_t reader;
+    /* Room for the longest sentence after the dollar sign, plus one
+       byte to detect too long sentences. */
+    char reader_buf[NMEA_SENTENCE_SIZE_MAX - 1];
 #if CONFIG_GNSS_DEBUG_LOG_MASK > -1
     struct log_object_t log;
 #endif
@@ -218,17 +218,19 @@ static ssize_t dump_string(struct dump_t *state_p,
 {
     int i;
 
-    std_fprintf(state_p->out_p, FSTR("\""));
-
     for (i = 0; i < token_p->size; i++) {
         if (!isprint((int)token_p->buf_p[i])) {
             return (-1);
         }
+    }
 
-        std_fprintf(state_p->out_p, FSTR("%c"), token_p->buf_p[i]);
+    chan_write(state_p->out_p, "\"", 1);
+
+    if (token_p->size > 0) {
+        chan_write(state_p->out_p, token_p->buf_p, token_p->size);
     }
 
-    std_fprintf(state_p->out_p, FSTR("\""));
+    chan_write(state_p->out_p, "\"", 1);
 
     return (token_p->size + 2);
 }
@@ -239,11 +241,7 @@ static ssize_t dump_string(struct dump_t *state_p,
 static ssize_t dump_primitive(struct dump_t *state_p,
                               struct json_tok_t *token_p)
 {
-    int i;
-
-    for (i = 0; i < token_p->size; i++) {
-        std_fprintf(state_p->out_p, FSTR("%c"), token_p->buf_p[i]);
-    }
+    chan_write(state_p->out_p, token_p->buf_p, token_p->size);
 
     return (token_p->size);
 }
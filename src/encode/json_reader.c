@@ -0,0 +1,672 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define STATE_VALUE                                         0
+#define STATE_KEY                                           1
+#define STATE_AFTER_VALUE                                   2
+#define STATE_DONE                                          3
+
+/**
+ * Read one character from the channel through the reader. Returns -1
+ * at the end of the input.
+ */
+static int read_char(struct json_reader_t *self_p)
+{
+    int c;
+
+    if (self_p->unget != -1) {
+        c = self_p->unget;
+        self_p->unget = -1;
+
+        return (c);
+    }
+
+    c = chan_reader_getc(&self_p->reader);
+
+    if (c < 0) {
+        return (-1);
+    }
+
+    return (c);
+}
+
+/**
+ * Read the next character that is not white space.
+ */
+static int read_token_char(struct json_reader_t *self_p)
+{
+    int c;
+
+    do {
+        c = read_char(self_p);
+    } while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+
+    return (c);
+}
+
+/**
+ * Append given character to the value buffer.
+ */
+static int append(struct json_reader_t *self_p, char c)
+{
+    if (self_p->discard == 1) {
+        return (0);
+    }
+
+    if (self_p->length + 1 >= self_p->size) {
+        return (-ENOMEM);
+    }
+
+    self_p->buf_p[self_p->length++] = c;
+    self_p->buf_p[self_p->length] = '\0';
+
+    return (0);
+}
+
+static int hex_to_int(int c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return (c - '0');
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return (c - 'a' + 10);
+    } else if ((c >= 'A') && (c <= 'F')) {
+        return (c - 'A' + 10);
+    }
+
+    return (-1);
+}
+
+/**
+ * Read an \uXXXX escape sequence and append it UTF-8 encoded. Only
+ * code points in the basic multilingual plane are supported.
+ */
+static int read_unicode_escape(struct json_reader_t *self_p)
+{
+    int i;
+    int digit;
+    int code_point;
+    int res;
+
+    code_point = 0;
+
+    for (i = 0; i < 4; i++) {
+        digit = hex_to_int(read_char(self_p));
+
+        if (digit == -1) {
+            return (-EPROTO);
+        }
+
+        code_point = (16 * code_point + digit);
+    }
+
+    if (code_point < 0x80) {
+        return (append(self_p, code_point));
+    } else if (code_point < 0x800) {
+        res = append(self_p, 0xc0 | (code_point >> 6));
+    } else {
+        res = append(self_p, 0xe0 | (code_point >> 12));
+
+        if (res != 0) {
+            return (res);
+        }
+
+        res = append(self_p, 0x80 | ((code_point >> 6) & 0x3f));
+    }
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (append(self_p, 0x80 | (code_point & 0x3f)));
+}
+
+/**
+ * Read a string into the value buffer. The opening quote has already
+ * been read.
+ */
+static int read_string(struct json_reader_t *self_p)
+{
+    int c;
+    int res;
+
+    while (1) {
+        c = read_char(self_p);
+
+        if (c == '"') {
+            return (0);
+        } else if (c == '\\') {
+            c = read_char(self_p);
+
+            switch (c) {
+
+            case '"':
+            case '\\':
+            case '/':
+                break;
+
+            case 'b':
+                c = '\b';
+                break;
+
+            case 'f':
+                c = '\f';
+                break;
+
+            case 'n':
+                c = '\n';
+                break;
+
+            case 'r':
+                c = '\r';
+                break;
+
+            case 't':
+                c = '\t';
+                break;
+
+            case 'u':
+                res = read_unicode_escape(self_p);
+
+                if (res != 0) {
+                    return (res);
+                }
+
+                continue;
+
+            default:
+                return (-EPROTO);
+            }
+        } else if ((c == -1) || (c < ' ')) {
+            return (-EPROTO);
+        }
+
+        res = append(self_p, c);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+}
+
+/**
+ * Read a number into the value buffer. The first character has
+ * already been read.
+ */
+static int read_number(struct json_reader_t *self_p, int c)
+{
+    int res;
+
+    while (((c >= '0') && (c <= '9'))
+           || (c == '-')
+           || (c == '+')
+           || (c == '.')
+           || (c == 'e')
+           || (c == 'E')) {
+        res = append(self_p, c);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        c = read_char(self_p);
+    }
+
+    /* The first character after the number belongs to the next
+       token. */
+    self_p->unget = c;
+
+    return (0);
+}
+
+/**
+ * Read the rest of given literal. The first character has already
+ * been read.
+ */
+static int read_literal(struct json_reader_t *self_p,
+                        const char *literal_p,
+                        int event)
+{
+    while (*literal_p != '\0') {
+        if (read_char(self_p) != *literal_p++) {
+            return (-EPROTO);
+        }
+    }
+
+    return (event);
+}
+
+static int push(struct json_reader_t *self_p, int is_object)
+{
+    if (self_p->depth == JSON_READER_DEPTH_MAX) {
+        return (-ENOMEM);
+    }
+
+    if (is_object) {
+        self_p->objects |= (1ul << self_p->depth);
+    } else {
+        self_p->objects &= ~(1ul << self_p->depth);
+    }
+
+    self_p->depth++;
+    self_p->first = 1;
+
+    return (0);
+}
+
+static int is_in_object(struct json_reader_t *self_p)
+{
+    return ((self_p->objects >> (self_p->depth - 1)) & 1);
+}
+
+/**
+ * End of a value. The document is complete if the value is not in an
+ * object or array.
+ */
+static void value_end(struct json_reader_t *self_p)
+{
+    if (self_p->depth == 0) {
+        self_p->state = STATE_DONE;
+    } else {
+        self_p->state = STATE_AFTER_VALUE;
+    }
+}
+
+/**
+ * Close the innermost object or array.
+ */
+static int pop(struct json_reader_t *self_p, int event)
+{
+    self_p->depth--;
+    value_end(self_p);
+
+    return (event);
+}
+
+static int read_value(struct json_reader_t *self_p, int c)
+{
+    int res;
+
+    switch (c) {
+
+    case '{':
+        res = push(self_p, 1);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        self_p->state = STATE_KEY;
+
+        return (JSON_READER_OBJECT_BEGIN);
+
+    case '[':
+        res = push(self_p, 0);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        self_p->state = STATE_VALUE;
+
+        return (JSON_READER_ARRAY_BEGIN);
+
+    case ']':
+        /* Only an empty array may end where a value is expected. */
+        if ((self_p->depth == 0)
+            || is_in_object(self_p)
+            || (self_p->first == 0)) {
+            return (-EPROTO);
+        }
+
+        return (pop(self_p, JSON_READER_ARRAY_END));
+
+    case '"':
+        res = read_string(self_p);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        value_end(self_p);
+
+        return (JSON_READER_STRING);
+
+    case 't':
+        value_end(self_p);
+
+        return (read_literal(self_p, "rue", JSON_READER_TRUE));
+
+    case 'f':
+        value_end(self_p);
+
+        return (read_literal(self_p, "alse", JSON_READER_FALSE));
+
+    case 'n':
+        value_end(self_p);
+
+        return (read_literal(self_p, "ull", JSON_READER_NULL));
+
+    default:
+        if (!(((c >= '0') && (c <= '9')) || (c == '-'))) {
+            return (-EPROTO);
+        }
+
+        res = read_number(self_p, c);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        value_end(self_p);
+
+        return (JSON_READER_NUMBER);
+    }
+}
+
+static int read_key(struct json_reader_t *self_p, int c)
+{
+    int res;
+
+    if (c == '}') {
+        /* Only an empty object may end where a key is expected. */
+        if (self_p->first == 0) {
+            return (-EPROTO);
+        }
+
+        return (pop(self_p, JSON_READER_OBJECT_END));
+    }
+
+    if (c != '"') {
+        return (-EPROTO);
+    }
+
+    res = read_string(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (read_token_char(self_p) != ':') {
+        return (-EPROTO);
+    }
+
+    self_p->state = STATE_VALUE;
+
+    return (JSON_READER_KEY);
+}
+
+static int read_after_value(struct json_reader_t *self_p, int c)
+{
+    if (c == ',') {
+        self_p->first = 0;
+
+        if (is_in_object(self_p)) {
+            return (read_key(self_p, read_token_char(self_p)));
+        } else {
+            return (read_value(self_p, read_token_char(self_p)));
+        }
+    } else if ((c == '}') && is_in_object(self_p)) {
+        return (pop(self_p, JSON_READER_OBJECT_END));
+    } else if ((c == ']') && !is_in_object(self_p)) {
+        return (pop(self_p, JSON_READER_ARRAY_END));
+    }
+
+    return (-EPROTO);
+}
+
+/**
+ * Returns true(1) if given path segment is an array index, otherwise
+ * false(0).
+ */
+static int is_index(const char *segment_p, size_t length)
+{
+    size_t i;
+
+    if (length == 0) {
+        return (0);
+    }
+
+    for (i = 0; i < length; i++) {
+        if (!isdigit((int)segment_p[i])) {
+            return (0);
+        }
+    }
+
+    return (1);
+}
+
+/**
+ * Find given key in the object which begin event was just read.
+ */
+static int find_key(struct json_reader_t *self_p,
+                    const char *key_p,
+                    size_t length)
+{
+    int event;
+
+    while (1) {
+        event = json_reader_next(self_p);
+
+        if (event != JSON_READER_KEY) {
+            if (event == JSON_READER_OBJECT_END) {
+                return (-ENOENT);
+            }
+
+            return (event < 0 ? event : -EPROTO);
+        }
+
+        if ((self_p->length == length)
+            && (strncmp(self_p->buf_p, key_p, length) == 0)) {
+            return (0);
+        }
+
+        event = json_reader_skip(self_p);
+
+        if (event < 0) {
+            return (event);
+        }
+    }
+}
+
+/**
+ * Skip given number of elements in the array which begin event was
+ * just read.
+ */
+static int find_index(struct json_reader_t *self_p, long index)
+{
+    int event;
+
+    while (index > 0) {
+        event = json_reader_skip(self_p);
+
+        if (event < 0) {
+            return (event);
+        }
+
+        if (event == JSON_READER_ARRAY_END) {
+            return (-ENOENT);
+        }
+
+        index--;
+    }
+
+    return (0);
+}
+
+int json_reader_init(struct json_reader_t *self_p,
+                     void *chan_p,
+                     char *buf_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    chan_reader_init(&self_p->reader,
+                     chan_p,
+                     &self_p->reader_buf[0],
+                     sizeof(self_p->reader_buf));
+    self_p->state = STATE_VALUE;
+    self_p->unget = -1;
+    self_p->depth = 0;
+    self_p->first = 1;
+    self_p->discard = 0;
+    self_p->objects = 0;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->length = 0;
+    buf_p[0] = '\0';
+
+    return (0);
+}
+
+int json_reader_next(struct json_reader_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int c;
+
+    if (self_p->state == STATE_DONE) {
+        return (JSON_READER_END);
+    }
+
+    self_p->length = 0;
+    self_p->buf_p[0] = '\0';
+    c = read_token_char(self_p);
+
+    if (c == -1) {
+        return (-EPROTO);
+    }
+
+    switch (self_p->state) {
+
+    case STATE_KEY:
+        return (read_key(self_p, c));
+
+    case STATE_AFTER_VALUE:
+        return (read_after_value(self_p, c));
+
+    default:
+        return (read_value(self_p, c));
+    }
+}
+
+int json_reader_skip(struct json_reader_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int event;
+    int res;
+    int depth;
+
+    self_p->discard = 1;
+    event = json_reader_next(self_p);
+    res = event;
+
+    if ((event == JSON_READER_OBJECT_BEGIN)
+        || (event == JSON_READER_ARRAY_BEGIN)) {
+        depth = (self_p->depth - 1);
+
+        while (self_p->depth > depth) {
+            res = json_reader_next(self_p);
+
+            if (res < 0) {
+                break;
+            }
+        }
+    }
+
+    self_p->discard = 0;
+
+    if (res < 0) {
+        return (res);
+    }
+
+    return (event);
+}
+
+int json_reader_find(struct json_reader_t *self_p, const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    int event;
+    int res;
+    const char *end_p;
+    size_t length;
+    long index;
+
+    while (*path_p != '\0') {
+        end_p = strchr(path_p, '.');
+
+        if (end_p == NULL) {
+            end_p = (path_p + strlen(path_p));
+        }
+
+        length = (end_p - path_p);
+        event = json_reader_next(self_p);
+
+        if (event < 0) {
+            return (event);
+        }
+
+        if (event == JSON_READER_OBJECT_BEGIN) {
+            res = find_key(self_p, path_p, length);
+        } else if ((event == JSON_READER_ARRAY_BEGIN)
+                   && is_index(path_p, length)) {
+            std_strtol(path_p, &index);
+            res = find_index(self_p, index);
+        } else {
+            res = -ENOENT;
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+
+        path_p = end_p;
+
+        if (*path_p == '.') {
+            path_p++;
+        }
+    }
+
+    event = json_reader_next(self_p);
+
+    /* Index out of range. */
+    if (event == JSON_READER_ARRAY_END) {
+        return (-ENOENT);
+    }
+
+    return (event);
+}
@@ -0,0 +1,164 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __ENCODE_JSON_READER_H__
+#define __ENCODE_JSON_READER_H__
+
+#include "simba.h"
+
+/**
+ * Maximum nesting depth of objects and arrays.
+ */
+#define JSON_READER_DEPTH_MAX                                       32
+
+/**
+ * Events returned by `json_reader_next()`.
+ */
+enum json_reader_event_t {
+    /** End of the document. */
+    JSON_READER_END = 0,
+
+    /** Start of an object, ``{``. */
+    JSON_READER_OBJECT_BEGIN = 1,
+
+    /** End of an object, ``}``. */
+    JSON_READER_OBJECT_END = 2,
+
+    /** Start of an array, ``[``. */
+    JSON_READER_ARRAY_BEGIN = 3,
+
+    /** End of an array, ``]``. */
+    JSON_READER_ARRAY_END = 4,
+
+    /** An object key. The unescaped key is in the value buffer. */
+    JSON_READER_KEY = 5,
+
+    /** A string. The unescaped string is in the value buffer. */
+    JSON_READER_STRING = 6,
+
+    /** A number. The number as text is in the value buffer. */
+    JSON_READER_NUMBER = 7,
+
+    /** The literal ``true``. */
+    JSON_READER_TRUE = 8,
+
+    /** The literal ``false``. */
+    JSON_READER_FALSE = 9,
+
+    /** The literal ``null``. */
+    JSON_READER_NULL = 10
+};
+
+/**
+ * Streaming JSON reader. Reads the document from a channel in chunks
+ * and never stores more than one key or value. Data following the
+ * document may be buffered in the reader, read it from ``reader``.
+ */
+struct json_reader_t {
+    struct chan_reader_t reader;
+    char reader_buf[CONFIG_JSON_READER_BUFFER_SIZE];
+    int state;
+    int unget;
+    int depth;
+    int first;
+    int discard;
+    /** Bit i is set if nesting level i is an object. */
+    uint32_t objects;
+    /** Buffer with the last key or value, null terminated. */
+    char *buf_p;
+    size_t size;
+    /** Length of the string in the value buffer. */
+    size_t length;
+};
+
+/**
+ * Initialize given JSON reader object.
+ *
+ * @param[out] self_p Reader object to initialize.
+ * @param[in] chan_p Channel to read the document from.
+ * @param[in] buf_p Value buffer. Keys, strings and numbers are
+ *                  stored in this buffer, so it must be big enough
+ *                  for the longest key or value, including the null
+ *                  termination.
+ * @param[in] size Value buffer size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_reader_init(struct json_reader_t *self_p,
+                     void *chan_p,
+                     char *buf_p,
+                     size_t size);
+
+/**
+ * Read the next event from the document.
+ *
+ * @param[in] self_p Initialized reader object.
+ *
+ * @return An event, ``JSON_READER_*``, or negative error code. The
+ *         error code is -EPROTO on malformed input and -ENOMEM if a
+ *         key or value does not fit in the value buffer or the
+ *         document is nested too deep.
+ */
+int json_reader_next(struct json_reader_t *self_p);
+
+/**
+ * Read and discard the next value, including all children of an
+ * object or array. Use after a ``JSON_READER_KEY`` event to skip the
+ * value of an unwanted key. Skipped strings are not stored and may
+ * be of any length.
+ *
+ * @param[in] self_p Initialized reader object.
+ *
+ * @return The first event of the skipped value, or negative error
+ *         code. ``JSON_READER_OBJECT_END`` or
+ *         ``JSON_READER_ARRAY_END`` is returned if there are no more
+ *         values in the current object or array.
+ */
+int json_reader_skip(struct json_reader_t *self_p);
+
+/**
+ * Read the document until given path is found and read its
+ * value. The path is relative to the next value in the document, and
+ * consists of object keys and array indexes separated by ``.``, for
+ * example ``"boards.2.name"``. An empty path matches the next value.
+ *
+ * Values are found in document order, so several values in the same
+ * document must be searched for in the order they appear. Use
+ * `json_reader_next()` to continue reading after the found value.
+ *
+ * @param[in] self_p Initialized reader object.
+ * @param[in] path_p Path to find.
+ *
+ * @return The first event of the found value, or negative error
+ *         code. The error code is -ENOENT if the path was not found.
+ */
+int json_reader_find(struct json_reader_t *self_p, const char *path_p);
+
+#endif
@@ -0,0 +1,433 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/**
+ * Write buffered data to the channel.
+ */
+static int flush(struct json_writer_t *self_p)
+{
+    if (self_p->chan_p == NULL) {
+        return (-ENOMEM);
+    }
+
+    if (self_p->pos == 0) {
+        return (0);
+    }
+
+    if (chan_write(self_p->chan_p,
+                   self_p->buf_p,
+                   self_p->pos) != self_p->pos) {
+        return (-EIO);
+    }
+
+    self_p->flushed += self_p->pos;
+    self_p->pos = 0;
+
+    return (0);
+}
+
+/**
+ * Append given data to the output buffer, flushing it when full.
+ */
+static int append(struct json_writer_t *self_p,
+                  const char *buf_p,
+                  size_t size)
+{
+    size_t n;
+    int res;
+
+    while (size > 0) {
+        if (self_p->pos == self_p->size) {
+            res = flush(self_p);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        n = MIN(size, self_p->size - self_p->pos);
+        memcpy(&self_p->buf_p[self_p->pos], buf_p, n);
+        self_p->pos += n;
+        buf_p += n;
+        size -= n;
+    }
+
+    return (0);
+}
+
+static int append_char(struct json_writer_t *self_p, char c)
+{
+    return (append(self_p, &c, 1));
+}
+
+/**
+ * Write a comma before all but the first member of an object or
+ * array.
+ */
+static int value_begin(struct json_writer_t *self_p)
+{
+    uint32_t mask;
+
+    if (self_p->after_key == 1) {
+        self_p->after_key = 0;
+
+        return (0);
+    }
+
+    if (self_p->depth == 0) {
+        return (0);
+    }
+
+    mask = (1ul << (self_p->depth - 1));
+
+    if (self_p->first & mask) {
+        self_p->first &= ~mask;
+
+        return (0);
+    }
+
+    return (append_char(self_p, ','));
+}
+
+static int container_begin(struct json_writer_t *self_p, char c)
+{
+    int res;
+
+    if (self_p->depth == JSON_WRITER_DEPTH_MAX) {
+        return (-ENOMEM);
+    }
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->first |= (1ul << self_p->depth);
+    self_p->depth++;
+
+    return (append_char(self_p, c));
+}
+
+static int container_end(struct json_writer_t *self_p, char c)
+{
+    ASSERTN(self_p->depth > 0, EINVAL);
+
+    self_p->depth--;
+
+    return (append_char(self_p, c));
+}
+
+/**
+ * Write given string with quotes and escaped characters. Runs of
+ * characters not needing escaping are appended in bulk.
+ */
+static int write_string(struct json_writer_t *self_p, const char *value_p)
+{
+    const char *begin_p;
+    char escape[6];
+    size_t size;
+    int res;
+    unsigned char c;
+
+    res = append_char(self_p, '"');
+
+    if (res != 0) {
+        return (res);
+    }
+
+    begin_p = value_p;
+
+    while (1) {
+        c = *value_p;
+
+        if ((c >= ' ') && (c != '"') && (c != '\\')) {
+            value_p++;
+            continue;
+        }
+
+        res = append(self_p, begin_p, value_p - begin_p);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if (c == '\0') {
+            break;
+        }
+
+        size = 2;
+        escape[0] = '\\';
+
+        switch (c) {
+
+        case '"':
+        case '\\':
+            escape[1] = c;
+            break;
+
+        case '\b':
+            escape[1] = 'b';
+            break;
+
+        case '\f':
+            escape[1] = 'f';
+            break;
+
+        case '\n':
+            escape[1] = 'n';
+            break;
+
+        case '\r':
+            escape[1] = 'r';
+            break;
+
+        case '\t':
+            escape[1] = 't';
+            break;
+
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = "0123456789abcdef"[c >> 4];
+            escape[5] = "0123456789abcdef"[c & 0xf];
+            size = 6;
+            break;
+        }
+
+        res = append(self_p, &escape[0], size);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        value_p++;
+        begin_p = value_p;
+    }
+
+    return (append_char(self_p, '"'));
+}
+
+int json_writer_init(struct json_writer_t *self_p,
+                     void *chan_p,
+                     char *buf_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pos = 0;
+    self_p->depth = 0;
+    self_p->first = 0;
+    self_p->after_key = 0;
+    self_p->flushed = 0;
+
+    return (0);
+}
+
+int json_writer_object_begin(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (container_begin(self_p, '{'));
+}
+
+int json_writer_object_end(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (container_end(self_p, '}'));
+}
+
+int json_writer_array_begin(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (container_begin(self_p, '['));
+}
+
+int json_writer_array_end(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (container_end(self_p, ']'));
+}
+
+int json_writer_key(struct json_writer_t *self_p, const char *key_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(key_p != NULL, EINVAL);
+
+    int res;
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = write_string(self_p, key_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->after_key = 1;
+
+    return (append_char(self_p, ':'));
+}
+
+int json_writer_string(struct json_writer_t *self_p, const char *value_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+
+    int res;
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (write_string(self_p, value_p));
+}
+
+int json_writer_integer(struct json_writer_t *self_p, long value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    char buf[24];
+    char *buf_p;
+    unsigned long uvalue;
+    int res;
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Format the number backwards from the end of the buffer. */
+    buf_p = &buf[sizeof(buf)];
+
+    if (value < 0) {
+        uvalue = -(unsigned long)value;
+    } else {
+        uvalue = value;
+    }
+
+    do {
+        *--buf_p = ('0' + (uvalue % 10));
+        uvalue /= 10;
+    } while (uvalue > 0);
+
+    if (value < 0) {
+        *--buf_p = '-';
+    }
+
+    return (append(self_p, buf_p, &buf[sizeof(buf)] - buf_p));
+}
+
+int json_writer_boolean(struct json_writer_t *self_p, int value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (value) {
+        return (append(self_p, "true", 4));
+    } else {
+        return (append(self_p, "false", 5));
+    }
+}
+
+int json_writer_null(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (append(self_p, "null", 4));
+}
+
+int json_writer_raw(struct json_writer_t *self_p,
+                    const char *buf_p,
+                    size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int res;
+
+    res = value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (append(self_p, buf_p, size));
+}
+
+ssize_t json_writer_flush(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    if (self_p->chan_p != NULL) {
+        res = flush(self_p);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    return (self_p->flushed + self_p->pos);
+}
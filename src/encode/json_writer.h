@@ -0,0 +1,186 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __ENCODE_JSON_WRITER_H__
+#define __ENCODE_JSON_WRITER_H__
+
+#include "simba.h"
+
+/**
+ * Maximum nesting depth of objects and arrays.
+ */
+#define JSON_WRITER_DEPTH_MAX                                       32
+
+/**
+ * Buffered JSON writer. Commas and colons are inserted
+ * automatically, and strings are escaped.
+ */
+struct json_writer_t {
+    void *chan_p;
+    char *buf_p;
+    size_t size;
+    size_t pos;
+    int depth;
+    /** Bit i is set if nesting level i has no members yet. */
+    uint32_t first;
+    int after_key;
+    /** Number of bytes written to the channel. */
+    size_t flushed;
+};
+
+/**
+ * Initialize given JSON writer object.
+ *
+ * @param[out] self_p Writer object to initialize.
+ * @param[in] chan_p Channel to flush the buffer to when it is full,
+ *                   or NULL to only write to the buffer.
+ * @param[in] buf_p Output buffer.
+ * @param[in] size Output buffer size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_init(struct json_writer_t *self_p,
+                     void *chan_p,
+                     char *buf_p,
+                     size_t size);
+
+/**
+ * Start an object, ``{``.
+ *
+ * @param[in] self_p Initialized writer object.
+ *
+ * @return zero(0) or negative error code. The error code is -ENOMEM
+ *         if the output buffer is full and there is no channel, or if
+ *         the document is nested too deep.
+ */
+int json_writer_object_begin(struct json_writer_t *self_p);
+
+/**
+ * End an object, ``}``.
+ *
+ * @param[in] self_p Initialized writer object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_object_end(struct json_writer_t *self_p);
+
+/**
+ * Start an array, ``[``.
+ *
+ * @param[in] self_p Initialized writer object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_array_begin(struct json_writer_t *self_p);
+
+/**
+ * End an array, ``]``.
+ *
+ * @param[in] self_p Initialized writer object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_array_end(struct json_writer_t *self_p);
+
+/**
+ * Write an object key. Must be followed by a value.
+ *
+ * @param[in] self_p Initialized writer object.
+ * @param[in] key_p Null terminated key.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_key(struct json_writer_t *self_p, const char *key_p);
+
+/**
+ * Write given null terminated string, escaped.
+ *
+ * @param[in] self_p Initialized writer object.
+ * @param[in] value_p String to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_string(struct json_writer_t *self_p, const char *value_p);
+
+/**
+ * Write given integer.
+ *
+ * @param[in] self_p Initialized writer object.
+ * @param[in] value Integer to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_integer(struct json_writer_t *self_p, long value);
+
+/**
+ * Write ``true`` or ``false``.
+ *
+ * @param[in] self_p Initialized writer object.
+ * @param[in] value Boolean to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_boolean(struct json_writer_t *self_p, int value);
+
+/**
+ * Write ``null``.
+ *
+ * @param[in] self_p Initialized writer object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_null(struct json_writer_t *self_p);
+
+/**
+ * Write given value as is, for example a number formatted by the
+ * caller.
+ *
+ * @param[in] self_p Initialized writer object.
+ * @param[in] buf_p Value to write.
+ * @param[in] size Value size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_raw(struct json_writer_t *self_p,
+                    const char *buf_p,
+                    size_t size);
+
+/**
+ * Write buffered data to the channel. Does nothing if there is no
+ * channel.
+ *
+ * @param[in] self_p Initialized writer object.
+ *
+ * @return Total number of bytes written by the writer, to the
+ *         channel and the buffer, or negative error code.
+ */
+ssize_t json_writer_flush(struct json_writer_t *self_p);
+
+#endif
@@ -56,55 +56,63 @@ static const FAR char bad_request_header[] =
     "\r\n"
     "Failed to parse the HTTP header.";
 
-static int read_initial_request_line(void *chan_p,
-                                     char *buf_p,
-                                     struct http_server_request_t *request_p)
+/**
+ * Read a line ending with "\r\n" from given reader. The line ending is
+ * replaced by a null-termination.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int read_line(struct chan_reader_t *reader_p, char **line_pp)
 {
-    char *action_p = NULL;
-    char *path_p = NULL;
-    char *proto_p = NULL;
-    size_t size;
+    ssize_t res;
 
-    *buf_p++ = '\0';
-    action_p = buf_p;
-    size = 0;
+    res = chan_reader_readline(reader_p, line_pp);
 
-    while (1) {
-        if (size == CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE) {
-            return (-ENOMEM);
-        }
+    if (res < 0) {
+        return (res);
+    }
 
-        if (chan_read(chan_p, buf_p, sizeof(*buf_p)) != sizeof(*buf_p)) {
-            return (-EIO);
-        }
+    if ((res < 2) || ((*line_pp)[res - 2] != '\r')) {
+        return (-1);
+    }
 
-        buf_p++;
+    (*line_pp)[res - 2] = '\0';
 
-        /* The line ending is "\r\n". */
-        if ((buf_p[-2] == '\r') && (buf_p[-1] == '\n')) {
-            buf_p[-2] = '\0';
-            break;
-        }
+    return (0);
+}
 
-        /* Action and path has ' ' as terminator. */
-        if (buf_p[-1] == ' ') {
-            buf_p[-1] = '\0';
+static int read_initial_request_line(struct chan_reader_t *reader_p,
+                                     struct http_server_request_t *request_p)
+{
+    int res;
+    char *action_p;
+    char *path_p;
+    char *proto_p;
+    size_t size;
 
-            if (path_p == NULL) {
-                path_p = buf_p;
-            } else if (proto_p == NULL) {
-                proto_p = buf_p;
-            }
-        }
+    res = read_line(reader_p, &action_p);
 
-        size++;
+    if (res != 0) {
+        return (res);
     }
 
+    /* Action and path has ' ' as terminator. */
+    path_p = strchr(action_p, ' ');
+
+    if (path_p == NULL) {
+        return (-1);
+    }
+
+    *path_p++ = '\0';
+    proto_p = strchr(path_p, ' ');
+
     /* Path and protocol are mandatory. */
-    if ((path_p == NULL) || (proto_p == NULL)) {
+    if (proto_p == NULL) {
         return (-1);
     }
 
+    *proto_p++ = '\0';
+
     log_object_print(NULL,
                      LOG_DEBUG,
                      OSTR("%s %s %s\r\n"), action_p, path_p, proto_p);
@@ -125,46 +133,25 @@ static int read_initial_request_line(void *chan_p,
     return (0);
 }
 
-static int read_header_line(void *chan_p,
-                            char *buf_p,
+static int read_header_line(struct chan_reader_t *reader_p,
                             char **header_pp,
                             char **value_pp)
 {
-    size_t size;
-    *buf_p++ = '\0';
-    *header_pp = buf_p;
-    *value_pp = NULL;
-    size = 0;
-
-    while (1) {
-        if (size == CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE) {
-            return (-ENOMEM);
-        }
-
-        if (chan_read(chan_p, buf_p, sizeof(*buf_p)) != sizeof(*buf_p)) {
-            return (-EIO);
-        }
-
-        buf_p++;
-
-        /* The line ending is "\r\n". */
-        if ((buf_p[-2] == '\r') && (buf_p[-1] == '\n')) {
-            buf_p[-2] = '\0';
-            break;
-        }
+    int res;
 
-        /* Value starts after ': '. */
-        if ((buf_p[-2] == ':') && (buf_p[-1] == ' ')) {
-            if (*value_pp == NULL) {
-                buf_p[-2] = '\0';
-                *value_pp = buf_p;
-            }
-        }
+    res = read_line(reader_p, header_pp);
 
-        size++;
+    if (res != 0) {
+        return (res);
     }
 
+    /* Value starts after ': '. */
+    *value_pp = strstr(*header_pp, ": ");
+
     if (*value_pp != NULL) {
+        **value_pp = '\0';
+        *value_pp += 2;
+
         return (0);
     } else {
         /* Empty line. */
@@ -173,19 +160,16 @@ static int read_header_line(void *chan_p,
 }
 
 static int read_request(struct http_server_t *self_p,
-                        struct http_server_connection_t *connection_p,
+                        struct chan_reader_t *reader_p,
                         struct http_server_request_t *request_p)
 {
     int res;
-    char buf[CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE];
     char *header_p;
     char *value_p;
     size_t size;
 
     /* Read the intial line in the request. */
-    res = read_initial_request_line(connection_p->chan_p,
-                                    buf,
-                                    request_p);
+    res = read_initial_request_line(reader_p, request_p);
 
     if (res != 0) {
         return (res);
@@ -195,10 +179,7 @@ static int read_request(struct http_server_t *self_p,
 
     /* Read the header lines. */
     while (1) {
-        res = read_header_line(connection_p->chan_p,
-                               buf,
-                               &header_p,
-                               &value_p);
+        res = read_header_line(reader_p, &header_p, &value_p);
 
         if (res == 1) {
             break;
@@ -267,26 +248,35 @@ static int handle_request(struct http_server_t *self_p,
     int res;
     struct http_server_request_t request;
     http_server_route_callback_t callback;
+    struct chan_reader_t reader;
+    char buf[CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE];
+
+    /* Read the request through a buffered reader, also used by the
+       callback to read the body. */
+    chan_reader_init(&reader, connection_p->chan_p, &buf[0], sizeof(buf));
+    connection_p->chan_p = &reader;
 
     /* Read the HTTP request. */
-    res = read_request(self_p, connection_p, &request);
+    res = read_request(self_p, &reader, &request);
 
     if (res != 0) {
         /* Reply with a Bad Request if the header could not be read.*/
         std_fprintf(connection_p->chan_p, bad_request_header);
+    } else {
+        /* Find the callback for given path. */
+        callback = find_route_callback(self_p, request.path);
 
-        return (res);
-    }
-
-    /* Find the callback for given path. */
-    callback = find_route_callback(self_p, request.path);
+        if (callback == NULL) {
+            callback = self_p->on_no_route;
+        }
 
-    if (callback == NULL) {
-        callback = self_p->on_no_route;
+        /* Call the callback and write the response if requested. */
+        res = callback(connection_p, &request);
     }
 
-    /* Call the callback and write the response if requested. */
-    return (callback(connection_p, &request));
+    connection_p->chan_p = reader.chan_p;
+
+    return (res);
 }
 
 /**
@@ -234,8 +234,9 @@ int http_server_stop(struct http_server_t *self_p);
  * @param[in] response_p Current response. If ``buf_p`` in the
  *                       response to NULL this function will only
  *                       write the HTTP header, including the size, to
- *                       the socket. After this function returns write
- *                       the payload by calling `socket_write()`.
+ *                       the connection channel. After this function
+ *                       returns write the payload by calling
+ *                       `chan_write()` on ``connection_p->chan_p``.
  *
  * @return zero(0) or negative error code.
  */
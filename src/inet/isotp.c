@@ -47,6 +47,22 @@ enum state_t {
     state_flow_control_frame_received_t
 };
 
+#define FLOW_STATUS_CONTINUE_TO_SEND               0
+#define FLOW_STATUS_WAIT                           1
+#define FLOW_STATUS_OVERFLOW                       2
+
+static const struct time_t rx_timeout = {
+    .seconds = (CONFIG_ISOTP_TIMEOUT_MS / 1000),
+    .nanoseconds = ((CONFIG_ISOTP_TIMEOUT_MS % 1000) * 1000000)
+};
+
+enum session_tx_state_t {
+    session_tx_state_idle_t = 0,
+    session_tx_state_wait_for_flow_control_t,
+    session_tx_state_transmitting_t,
+    session_tx_state_overflow_t
+};
+
 static ssize_t handle_input_idle(struct isotp_t *self_p,
                                  const uint8_t *buf_p,
                                  size_t size)
@@ -339,3 +355,686 @@ ssize_t isotp_output(struct isotp_t *self_p,
 
     return (res);
 }
+
+#ifdef PORT_HAS_CAN
+
+static void *pool_alloc(struct isotp_engine_t *self_p)
+{
+    void *buf_p;
+
+    mutex_lock(&self_p->mutex);
+    buf_p = self_p->pool.free_p;
+
+    if (buf_p != NULL) {
+        self_p->pool.free_p = *(void **)buf_p;
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (buf_p);
+}
+
+static void pool_free(struct isotp_engine_t *self_p, void *buf_p)
+{
+    mutex_lock(&self_p->mutex);
+    *(void **)buf_p = self_p->pool.free_p;
+    self_p->pool.free_p = buf_p;
+    mutex_unlock(&self_p->mutex);
+}
+
+static void frame_init(struct isotp_session_t *self_p,
+                       struct can_frame_t *frame_p,
+                       size_t size)
+{
+    frame_p->id = self_p->tx_id;
+    frame_p->extended_frame =
+        ((self_p->flags & ISOTP_FLAGS_EXTENDED_FRAME) ? 1 : 0);
+    frame_p->rtr = 0;
+    frame_p->size = size;
+}
+
+static ssize_t frames_write(struct isotp_engine_t *self_p,
+                            const struct can_frame_t *frames_p,
+                            size_t length)
+{
+    ssize_t res;
+
+    mutex_lock(&self_p->output_mutex);
+    res = chan_write(self_p->chout_p,
+                     frames_p,
+                     length * sizeof(*frames_p));
+    mutex_unlock(&self_p->output_mutex);
+
+    return (res);
+}
+
+static void write_flow_control(struct isotp_session_t *self_p,
+                               int flow_status)
+{
+    struct can_frame_t frame;
+
+    frame_init(self_p, &frame, 3);
+    frame.data.u8[0] = ((TYPE_FLOW_CONTROL_FRAME << 4) | flow_status);
+    frame.data.u8[1] = self_p->flow_control.block_size;
+    frame.data.u8[2] = self_p->flow_control.separation_time;
+    frames_write(self_p->engine_p, &frame, 1);
+}
+
+/**
+ * Called from interrupt context when no consecutive frame has been
+ * received in time. The engine thread aborts the reception.
+ */
+static void rx_timer_cb(void *arg_p)
+{
+    struct isotp_session_t *self_p;
+
+    self_p = arg_p;
+    self_p->rx.expired = 1;
+    self_p->engine_p->rx_expired = 1;
+}
+
+/**
+ * (Re)start the reception timer of given session.
+ */
+static void rx_timer_start(struct isotp_session_t *self_p)
+{
+    sys_lock();
+    timer_stop_isr(&self_p->rx.timer);
+    self_p->rx.expired = 0;
+    timer_start_isr(&self_p->rx.timer);
+    sys_unlock();
+}
+
+static void rx_timer_stop(struct isotp_session_t *self_p)
+{
+    sys_lock();
+    timer_stop_isr(&self_p->rx.timer);
+    self_p->rx.expired = 0;
+    sys_unlock();
+}
+
+static void rx_abort(struct isotp_session_t *self_p)
+{
+    if (self_p->rx.buf_p != NULL) {
+        rx_timer_stop(self_p);
+        pool_free(self_p->engine_p, self_p->rx.buf_p);
+        self_p->rx.buf_p = NULL;
+    }
+}
+
+/**
+ * Abort all receptions which timed out waiting for a consecutive
+ * frame, returning their buffers to the pool.
+ */
+static void rx_abort_expired(struct isotp_engine_t *self_p)
+{
+    struct isotp_session_t *session_p;
+
+    self_p->rx_expired = 0;
+
+    /* Sessions are only added to the head of the list, so it can be
+       traversed without the mutex, which is taken by rx_abort(). */
+    mutex_lock(&self_p->mutex);
+    session_p = self_p->sessions_p;
+    mutex_unlock(&self_p->mutex);
+
+    while (session_p != NULL) {
+        if (session_p->rx.expired == 1) {
+            rx_abort(session_p);
+        }
+
+        session_p = session_p->next_p;
+    }
+}
+
+static void rx_complete(struct isotp_session_t *self_p)
+{
+    uint8_t *buf_p;
+
+    rx_timer_stop(self_p);
+    buf_p = self_p->rx.buf_p;
+    self_p->rx.buf_p = NULL;
+
+    if (self_p->callback != NULL) {
+        self_p->callback(self_p->arg_p, self_p, buf_p, self_p->rx.size);
+    } else {
+        pool_free(self_p->engine_p, buf_p);
+    }
+}
+
+static void rx_single_frame(struct isotp_session_t *self_p,
+                            const struct can_frame_t *frame_p)
+{
+    size_t size;
+
+    size = (frame_p->data.u8[0] & 0x0f);
+
+    if ((size == 0) || (size > 7) || (size >= frame_p->size)) {
+        return;
+    }
+
+    /* A new message aborts any ongoing reception. */
+    rx_abort(self_p);
+
+    self_p->rx.buf_p = pool_alloc(self_p->engine_p);
+
+    if (self_p->rx.buf_p == NULL) {
+        return;
+    }
+
+    memcpy(self_p->rx.buf_p, &frame_p->data.u8[1], size);
+    self_p->rx.size = size;
+    rx_complete(self_p);
+}
+
+static void rx_first_frame(struct isotp_session_t *self_p,
+                           const struct can_frame_t *frame_p)
+{
+    size_t size;
+
+    if (frame_p->size != 8) {
+        return;
+    }
+
+    size = (((frame_p->data.u8[0] & 0x0f) << 8) | frame_p->data.u8[1]);
+
+    if (size < 8) {
+        return;
+    }
+
+    rx_abort(self_p);
+
+    if (size <= self_p->engine_p->pool.size) {
+        self_p->rx.buf_p = pool_alloc(self_p->engine_p);
+    }
+
+    if (self_p->rx.buf_p == NULL) {
+        if (!(self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL)) {
+            write_flow_control(self_p, FLOW_STATUS_OVERFLOW);
+        }
+
+        return;
+    }
+
+    memcpy(self_p->rx.buf_p, &frame_p->data.u8[2], 6);
+    self_p->rx.size = size;
+    self_p->rx.offset = 6;
+    self_p->rx.next_index = 1;
+    self_p->rx.block_counter = 0;
+    rx_timer_start(self_p);
+
+    if (!(self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL)) {
+        write_flow_control(self_p, FLOW_STATUS_CONTINUE_TO_SEND);
+    }
+}
+
+static void rx_consecutive_frame(struct isotp_session_t *self_p,
+                                 const struct can_frame_t *frame_p)
+{
+    size_t size;
+
+    if (self_p->rx.buf_p == NULL) {
+        return;
+    }
+
+    if ((frame_p->data.u8[0] & 0x0f) != self_p->rx.next_index) {
+        rx_abort(self_p);
+
+        return;
+    }
+
+    if (frame_p->size < 2) {
+        return;
+    }
+
+    size = MIN(frame_p->size - 1u, self_p->rx.size - self_p->rx.offset);
+    memcpy(&self_p->rx.buf_p[self_p->rx.offset], &frame_p->data.u8[1], size);
+    self_p->rx.offset += size;
+    self_p->rx.next_index++;
+    self_p->rx.next_index %= 16;
+
+    if (self_p->rx.offset == self_p->rx.size) {
+        rx_complete(self_p);
+
+        return;
+    }
+
+    rx_timer_start(self_p);
+
+    if (self_p->flow_control.block_size > 0) {
+        self_p->rx.block_counter++;
+
+        if ((self_p->rx.block_counter == self_p->flow_control.block_size)
+            && !(self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL)) {
+            self_p->rx.block_counter = 0;
+            write_flow_control(self_p, FLOW_STATUS_CONTINUE_TO_SEND);
+        }
+    }
+}
+
+static void rx_flow_control_frame(struct isotp_session_t *self_p,
+                                  const struct can_frame_t *frame_p)
+{
+    struct isotp_engine_t *engine_p;
+
+    if (frame_p->size < 3) {
+        return;
+    }
+
+    engine_p = self_p->engine_p;
+    mutex_lock(&engine_p->mutex);
+
+    if (self_p->tx.state == session_tx_state_wait_for_flow_control_t) {
+        switch (frame_p->data.u8[0] & 0x0f) {
+
+        case FLOW_STATUS_CONTINUE_TO_SEND:
+            self_p->tx.block_size = frame_p->data.u8[1];
+            self_p->tx.separation_time = frame_p->data.u8[2];
+            self_p->tx.state = session_tx_state_transmitting_t;
+            break;
+
+        case FLOW_STATUS_OVERFLOW:
+            self_p->tx.state = session_tx_state_overflow_t;
+            break;
+
+        default:
+            /* Wait restarts the timeout. */
+            break;
+        }
+
+        cond_broadcast(&engine_p->cond);
+    }
+
+    mutex_unlock(&engine_p->mutex);
+}
+
+static struct isotp_session_t *
+session_find(struct isotp_engine_t *self_p,
+             const struct can_frame_t *frame_p)
+{
+    struct isotp_session_t *session_p;
+    int extended_frame;
+
+    mutex_lock(&self_p->mutex);
+    session_p = self_p->sessions_p;
+
+    while (session_p != NULL) {
+        extended_frame =
+            ((session_p->flags & ISOTP_FLAGS_EXTENDED_FRAME) ? 1 : 0);
+
+        if ((session_p->rx_id == frame_p->id)
+            && (extended_frame == frame_p->extended_frame)) {
+            break;
+        }
+
+        session_p = session_p->next_p;
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (session_p);
+}
+
+static void *engine_main(void *arg_p)
+{
+    struct isotp_engine_t *self_p;
+    struct isotp_session_t *session_p;
+    struct can_frame_t frame;
+
+    self_p = arg_p;
+    thrd_set_name("isotp");
+
+    while (1) {
+        chan_read(self_p->chin_p, &frame, sizeof(frame));
+
+        if (self_p->rx_expired == 1) {
+            rx_abort_expired(self_p);
+        }
+
+        if ((frame.rtr == 1) || (frame.size == 0)) {
+            continue;
+        }
+
+        session_p = session_find(self_p, &frame);
+
+        if (session_p == NULL) {
+            continue;
+        }
+
+        switch (frame.data.u8[0] >> 4) {
+
+        case TYPE_SINGLE_FRAME:
+            rx_single_frame(session_p, &frame);
+            break;
+
+        case TYPE_FIRST_FRAME:
+            rx_first_frame(session_p, &frame);
+            break;
+
+        case TYPE_CONSECUTIVE_FRAME:
+            rx_consecutive_frame(session_p, &frame);
+            break;
+
+        case TYPE_FLOW_CONTROL_FRAME:
+            rx_flow_control_frame(session_p, &frame);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * Wait for a flow control frame from the peer. Called with the
+ * engine mutex locked.
+ */
+static int tx_wait_for_flow_control(struct isotp_session_t *self_p)
+{
+    struct isotp_engine_t *engine_p;
+    struct time_t timeout;
+
+    engine_p = self_p->engine_p;
+    timeout.seconds = (CONFIG_ISOTP_TIMEOUT_MS / 1000);
+    timeout.nanoseconds = ((CONFIG_ISOTP_TIMEOUT_MS % 1000) * 1000000);
+
+    while (self_p->tx.state == session_tx_state_wait_for_flow_control_t) {
+        if (cond_wait(&engine_p->cond, &engine_p->mutex, &timeout) != 0) {
+            if (self_p->tx.state
+                == session_tx_state_wait_for_flow_control_t) {
+                return (-ETIMEDOUT);
+            }
+        }
+    }
+
+    if (self_p->tx.state == session_tx_state_overflow_t) {
+        return (-ENOBUFS);
+    }
+
+    return (0);
+}
+
+static void tx_separation_time_sleep(uint8_t separation_time)
+{
+    if (separation_time == 0) {
+        return;
+    }
+
+    if (separation_time <= 0x7f) {
+        thrd_sleep_us(1000L * separation_time);
+    } else if ((separation_time >= 0xf1) && (separation_time <= 0xf9)) {
+        thrd_sleep_us(100L * (separation_time - 0xf0));
+    } else {
+        /* Reserved values are interpreted as the maximum. */
+        thrd_sleep_us(127000L);
+    }
+}
+
+static ssize_t tx_consecutive_frames(struct isotp_session_t *self_p,
+                                     const uint8_t *buf_p,
+                                     size_t size)
+{
+    struct isotp_engine_t *engine_p;
+    struct can_frame_t frames[CONFIG_ISOTP_TX_FRAMES_MAX];
+    size_t offset;
+    size_t length;
+    size_t chunk_size;
+    int index;
+    int block_counter;
+    int res;
+    int end_of_block;
+
+    engine_p = self_p->engine_p;
+    offset = 6;
+    index = 1;
+
+    while (offset < size) {
+        mutex_lock(&engine_p->mutex);
+        res = tx_wait_for_flow_control(self_p);
+        mutex_unlock(&engine_p->mutex);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        block_counter = 0;
+
+        do {
+            /* Batch frames only if the peer accepts them back to
+               back. */
+            length = 0;
+            end_of_block = 0;
+
+            do {
+                chunk_size = MIN(size - offset, 7);
+                frame_init(self_p, &frames[length], chunk_size + 1);
+                frames[length].data.u8[0] =
+                    ((TYPE_CONSECUTIVE_FRAME << 4) | index);
+                memcpy(&frames[length].data.u8[1],
+                       &buf_p[offset],
+                       chunk_size);
+                offset += chunk_size;
+                index = ((index + 1) % 16);
+                length++;
+                block_counter++;
+
+                if ((self_p->tx.block_size > 0)
+                    && (block_counter == self_p->tx.block_size)) {
+                    end_of_block = 1;
+                }
+            } while ((offset < size)
+                     && (end_of_block == 0)
+                     && (length < membersof(frames))
+                     && (self_p->tx.separation_time == 0));
+
+            /* The flow control frame may arrive as soon as the last
+               frame in the block is written. */
+            if (end_of_block && (offset < size)) {
+                mutex_lock(&engine_p->mutex);
+                self_p->tx.state = session_tx_state_wait_for_flow_control_t;
+                mutex_unlock(&engine_p->mutex);
+            }
+
+            if (frames_write(engine_p, &frames[0], length)
+                != (ssize_t)(length * sizeof(frames[0]))) {
+                return (-EIO);
+            }
+
+            if (offset < size) {
+                tx_separation_time_sleep(self_p->tx.separation_time);
+            }
+        } while ((offset < size) && (end_of_block == 0));
+    }
+
+    return (0);
+}
+
+int isotp_engine_init(struct isotp_engine_t *self_p,
+                      void *chin_p,
+                      void *chout_p,
+                      void *pool_p,
+                      size_t pool_size,
+                      size_t buffer_size,
+                      void *stack_p,
+                      size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chin_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+    ASSERTN(pool_p != NULL, EINVAL);
+    ASSERTN(buffer_size >= 8, EINVAL);
+    ASSERTN(buffer_size % sizeof(void *) == 0, EINVAL);
+    ASSERTN(pool_size >= buffer_size, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+    uint8_t *buf_p;
+    size_t i;
+
+    self_p->chin_p = chin_p;
+    self_p->chout_p = chout_p;
+    self_p->pool.size = MIN(buffer_size, 4095);
+    self_p->pool.free_p = NULL;
+    buf_p = pool_p;
+
+    for (i = 0; i < pool_size / buffer_size; i++) {
+        *(void **)buf_p = self_p->pool.free_p;
+        self_p->pool.free_p = buf_p;
+        buf_p += buffer_size;
+    }
+
+    self_p->sessions_p = NULL;
+    self_p->rx_expired = 0;
+    mutex_init(&self_p->mutex);
+    mutex_init(&self_p->output_mutex);
+    cond_init(&self_p->cond);
+    self_p->stack_p = stack_p;
+    self_p->stack_size = stack_size;
+    self_p->thrd_p = NULL;
+
+    return (0);
+}
+
+int isotp_engine_start(struct isotp_engine_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->thrd_p = thrd_spawn(engine_main,
+                                self_p,
+                                0,
+                                self_p->stack_p,
+                                self_p->stack_size);
+
+    return (self_p->thrd_p != NULL ? 0 : -1);
+}
+
+int isotp_engine_buffer_free(struct isotp_engine_t *self_p, uint8_t *buf_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    pool_free(self_p, buf_p);
+
+    return (0);
+}
+
+int isotp_session_init(struct isotp_session_t *self_p,
+                       struct isotp_engine_t *engine_p,
+                       uint32_t rx_id,
+                       uint32_t tx_id,
+                       int flags,
+                       isotp_session_callback_t callback,
+                       void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(engine_p != NULL, EINVAL);
+
+    self_p->engine_p = engine_p;
+    self_p->rx_id = rx_id;
+    self_p->tx_id = tx_id;
+    self_p->flags = flags;
+    self_p->flow_control.block_size = 0;
+    self_p->flow_control.separation_time = 0;
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+    self_p->rx.buf_p = NULL;
+    self_p->rx.expired = 0;
+    timer_init(&self_p->rx.timer,
+               &rx_timeout,
+               rx_timer_cb,
+               self_p,
+               0);
+    self_p->tx.state = session_tx_state_idle_t;
+
+    mutex_lock(&engine_p->mutex);
+    self_p->next_p = engine_p->sessions_p;
+    engine_p->sessions_p = self_p;
+    mutex_unlock(&engine_p->mutex);
+
+    return (0);
+}
+
+int isotp_session_set_flow_control(struct isotp_session_t *self_p,
+                                   uint8_t block_size,
+                                   uint8_t separation_time)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->flow_control.block_size = block_size;
+    self_p->flow_control.separation_time = separation_time;
+
+    return (0);
+}
+
+ssize_t isotp_session_write(struct isotp_session_t *self_p,
+                            const void *buf_p,
+                            size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+    ASSERTN(size <= 4095, EINVAL);
+
+    struct isotp_engine_t *engine_p;
+    struct can_frame_t frame;
+    const uint8_t *u8_buf_p;
+    int res;
+
+    engine_p = self_p->engine_p;
+    u8_buf_p = buf_p;
+
+    /* Flow control frames are received by the engine thread, so it
+       must not wait for them itself, for example in a session
+       callback. */
+    if ((size >= 8)
+        && !(self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL)
+        && (thrd_self() == engine_p->thrd_p)) {
+        return (-EDEADLK);
+    }
+
+    mutex_lock(&engine_p->mutex);
+
+    if (self_p->tx.state != session_tx_state_idle_t) {
+        mutex_unlock(&engine_p->mutex);
+
+        return (-EBUSY);
+    }
+
+    if (self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL) {
+        self_p->tx.block_size = 0;
+        self_p->tx.separation_time = 0;
+        self_p->tx.state = session_tx_state_transmitting_t;
+    } else {
+        self_p->tx.state = session_tx_state_wait_for_flow_control_t;
+    }
+
+    mutex_unlock(&engine_p->mutex);
+
+    if (size < 8) {
+        frame_init(self_p, &frame, size + 1);
+        frame.data.u8[0] = ((TYPE_SINGLE_FRAME << 4) | size);
+        memcpy(&frame.data.u8[1], u8_buf_p, size);
+    } else {
+        frame_init(self_p, &frame, 8);
+        frame.data.u8[0] = ((TYPE_FIRST_FRAME << 4) | (size >> 8));
+        frame.data.u8[1] = size;
+        memcpy(&frame.data.u8[2], u8_buf_p, 6);
+    }
+
+    if (frames_write(engine_p, &frame, 1) != sizeof(frame)) {
+        res = -EIO;
+    } else if (size < 8) {
+        res = 0;
+    } else {
+        res = tx_consecutive_frames(self_p, u8_buf_p, size);
+    }
+
+    mutex_lock(&engine_p->mutex);
+    self_p->tx.state = session_tx_state_idle_t;
+    mutex_unlock(&engine_p->mutex);
+
+    return (res == 0 ? (ssize_t)size : res);
+}
+
+#endif
@@ -34,6 +34,7 @@
 #include "simba.h"
 
 #define ISOTP_FLAGS_NO_FLOW_CONTROL            (1 << 0)
+#define ISOTP_FLAGS_EXTENDED_FRAME             (1 << 1)
 
 struct isotp_t {
     uint8_t *message_p;
@@ -47,6 +48,82 @@ struct isotp_t {
     } message;
 };
 
+#ifdef PORT_HAS_CAN
+
+struct isotp_session_t;
+
+/**
+ * Called by the engine thread when a session has received a
+ * message. The message buffer belongs to the callee until released
+ * with `isotp_engine_buffer_free()`, which may be done after the
+ * callback has returned.
+ *
+ * The engine does not receive frames while the callback runs, so the
+ * callback must not block. A reply that fits in a single frame may be
+ * written with `isotp_session_write()` from the callback, but a
+ * multi-frame reply must be written by another thread, as it waits
+ * for flow control frames from the peer. `isotp_session_write()`
+ * returns -EDEADLK if called from the callback with a multi-frame
+ * message on a session using flow control.
+ *
+ * @param[in] arg_p Session callback argument.
+ * @param[in] session_p Session the message was received on.
+ * @param[in] buf_p Received message, in a buffer from the engine
+ *                  buffer pool.
+ * @param[in] size Message size in bytes.
+ */
+typedef void (*isotp_session_callback_t)(void *arg_p,
+                                         struct isotp_session_t *session_p,
+                                         uint8_t *buf_p,
+                                         size_t size);
+
+struct isotp_session_t {
+    struct isotp_engine_t *engine_p;
+    uint32_t rx_id;
+    uint32_t tx_id;
+    int flags;
+    struct {
+        uint8_t block_size;
+        uint8_t separation_time;
+    } flow_control;
+    isotp_session_callback_t callback;
+    void *arg_p;
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+        size_t offset;
+        int next_index;
+        int block_counter;
+        struct timer_t timer;
+        volatile int expired;
+    } rx;
+    struct {
+        int state;
+        uint8_t block_size;
+        uint8_t separation_time;
+    } tx;
+    struct isotp_session_t *next_p;
+};
+
+struct isotp_engine_t {
+    void *chin_p;
+    void *chout_p;
+    struct {
+        size_t size;
+        void *free_p;
+    } pool;
+    struct isotp_session_t *sessions_p;
+    volatile int rx_expired;
+    struct mutex_t mutex;
+    struct mutex_t output_mutex;
+    struct cond_t cond;
+    void *stack_p;
+    size_t stack_size;
+    struct thrd_t *thrd_p;
+};
+
+#endif
+
 /**
  * Initialize given ISO-TP object. An object can _either_ be used to
  * transmit or receive an ISO-TP message. Once `isotp_input()` or
@@ -110,4 +187,136 @@ ssize_t isotp_output(struct isotp_t *self_p,
                      uint8_t *buf_p,
                      size_t *size_p);
 
+#ifdef PORT_HAS_CAN
+
+/**
+ * Initialize given ISO-TP engine. The engine serves any number of
+ * concurrent, full-duplex sessions on one CAN bus. It reads CAN
+ * frames from given input channel in its own thread and dispatches
+ * them to the session with matching reception id. Frames not
+ * belonging to any session are discarded.
+ *
+ * Received multi-frame messages are reassembled in place in buffers
+ * from given buffer pool, which are passed to the session callback
+ * without copying. A peer sending a message when the pool is empty,
+ * or a message larger than the pool buffers, is answered with an
+ * overflow flow control frame. A reception is aborted if the next
+ * consecutive frame is not received within
+ * ``CONFIG_ISOTP_TIMEOUT_MS``, and its buffer is returned to the pool
+ * before the next frame is handled.
+ *
+ * @param[in] self_p Engine to initialize.
+ * @param[in] chin_p Input channel of CAN frames, usually a CAN
+ *                   driver.
+ * @param[in] chout_p Output channel of CAN frames, usually the same
+ *                    CAN driver.
+ * @param[in] pool_p Buffer pool memory, aligned to a pointer.
+ * @param[in] pool_size Size of the buffer pool in bytes.
+ * @param[in] buffer_size Size of each buffer in the pool. Must be a
+ *                        multiple of the pointer size. The largest
+ *                        ISO-TP message is 4095 bytes.
+ * @param[in] stack_p Engine thread stack.
+ * @param[in] stack_size Engine thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_engine_init(struct isotp_engine_t *self_p,
+                      void *chin_p,
+                      void *chout_p,
+                      void *pool_p,
+                      size_t pool_size,
+                      size_t buffer_size,
+                      void *stack_p,
+                      size_t stack_size);
+
+/**
+ * Start the engine thread.
+ *
+ * @param[in] self_p Initialized engine.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_engine_start(struct isotp_engine_t *self_p);
+
+/**
+ * Return given message buffer, passed to a session callback, to the
+ * engine buffer pool.
+ *
+ * @param[in] self_p Initialized engine.
+ * @param[in] buf_p Message buffer to free.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_engine_buffer_free(struct isotp_engine_t *self_p, uint8_t *buf_p);
+
+/**
+ * Initialize given session and add it to given engine. The session
+ * receives frames with id `rx_id` and transmits frames with id
+ * `tx_id`. Reception and transmission are independent of each other,
+ * so a message may be received while another is transmitted.
+ *
+ * @param[in] self_p Session to initialize.
+ * @param[in] engine_p Engine to add the session to.
+ * @param[in] rx_id CAN id of frames from the peer.
+ * @param[in] tx_id CAN id of frames to the peer.
+ * @param[in] flags Configuration flags. A combination of
+ *                  ``ISOTP_FLAGS_NO_FLOW_CONTROL`` and
+ *                  ``ISOTP_FLAGS_EXTENDED_FRAME``.
+ * @param[in] callback Called when a message has been received.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_session_init(struct isotp_session_t *self_p,
+                       struct isotp_engine_t *engine_p,
+                       uint32_t rx_id,
+                       uint32_t tx_id,
+                       int flags,
+                       isotp_session_callback_t callback,
+                       void *arg_p);
+
+/**
+ * Set the block size (BS) and minimum separation time (STmin) the
+ * peer is requested to use when transmitting to given session. Both
+ * default to zero(0), that is, all consecutive frames as fast as
+ * possible.
+ *
+ * @param[in] self_p Initialized session.
+ * @param[in] block_size Number of consecutive frames between flow
+ *                       control frames, or zero(0) for no limit.
+ * @param[in] separation_time Encoded ISO-TP STmin; 0x00-0x7f
+ *                            milliseconds, or 0xf1-0xf9 for 100-900
+ *                            microseconds.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_session_set_flow_control(struct isotp_session_t *self_p,
+                                   uint8_t block_size,
+                                   uint8_t separation_time);
+
+/**
+ * Transmit given message to the peer of given session. Blocks until
+ * all frames have been written to the output channel. Consecutive
+ * frames are written in batches of up to
+ * ``CONFIG_ISOTP_TX_FRAMES_MAX`` frames, unless the peer requested a
+ * separation time.
+ *
+ * @param[in] self_p Initialized session.
+ * @param[in] buf_p Message to transmit.
+ * @param[in] size Message size in bytes, at most 4095.
+ *
+ * @return Number of transmitted bytes or negative error code. The
+ *         error code is -EBUSY if a message is already being
+ *         transmitted on the session, -ETIMEDOUT if the peer did not
+ *         send a flow control frame in time, -ENOBUFS if the peer
+ *         answered with an overflow flow control frame and -EDEADLK
+ *         if a multi-frame message is written from a session
+ *         callback.
+ */
+ssize_t isotp_session_write(struct isotp_session_t *self_p,
+                            const void *buf_p,
+                            size_t size);
+
+#endif
+
 #endif
@@ -135,10 +135,12 @@ static int read_fixed_header(struct mqtt_client_t *self_p,
                              int *flags_p,
                              size_t *size_p)
 {
-    uint8_t byte;
+    int byte;
     long multiplier;
 
-    if (chan_read(self_p->transport.in_p, &byte, 1) != 1) {
+    byte = chan_reader_getc(&self_p->transport.reader);
+
+    if (byte < 0) {
         return (-EIO);
     }
 
@@ -150,7 +152,9 @@ static int read_fixed_header(struct mqtt_client_t *self_p,
     *size_p = 0;
 
     do {
-        if (chan_read(self_p->transport.in_p, &byte, 1) != 1) {
+        byte = chan_reader_getc(&self_p->transport.reader);
+
+        if (byte < 0) {
             return (-EIO);
         }
 
@@ -173,6 +177,12 @@ static int handle_control_connect(struct mqtt_client_t *self_p)
     int res = 0;
     uint8_t buf[12];
 
+    /* Discard data buffered from a previous connection. */
+    chan_reader_init(&self_p->transport.reader,
+                     self_p->transport.in_p,
+                     &self_p->transport.reader_buf[0],
+                     sizeof(self_p->transport.reader_buf));
+
     /* Write the fixed header. */
     res = write_fixed_header(self_p, MQTT_CONNECT, 0, 12);
 
@@ -221,7 +231,7 @@ static int handle_response_connack(struct mqtt_client_t *self_p,
         return (-EMSGSIZE);
     }
 
-    if (chan_read(self_p->transport.in_p, &buf[0], size) != size) {
+    if (chan_reader_read(&self_p->transport.reader, &buf[0], size) != size) {
         return (-EIO);
     }
 
@@ -378,7 +388,7 @@ static int handle_response_puback(struct mqtt_client_t *self_p,
         return (-EMSGSIZE);
     }
 
-    if (chan_read(self_p->transport.in_p, &buf[0], size) != size) {
+    if (chan_reader_read(&self_p->transport.reader, &buf[0], size) != size) {
         return (-EIO);
     }
 
@@ -471,7 +481,7 @@ static int handle_response_suback(struct mqtt_client_t *self_p,
         return (-EMSGSIZE);
     }
 
-    if (chan_read(self_p->transport.in_p, &buf[0], size) != size) {
+    if (chan_reader_read(&self_p->transport.reader, &buf[0], size) != size) {
         return (-EIO);
     }
 
@@ -561,7 +571,7 @@ static int handle_response_unsuback(struct mqtt_client_t *self_p,
         return (-EMSGSIZE);
     }
 
-    if (chan_read(self_p->transport.in_p, &buf[0], size) != size) {
+    if (chan_reader_read(&self_p->transport.reader, &buf[0], size) != size) {
         return (-EIO);
     }
 
@@ -576,6 +586,205 @@ static int handle_response_unsuback(struct mqtt_client_t *self_p,
     return (0);
 }
 
+/**
+ * Read and drop the payload of a published message no callback was
+ * found for.
+ */
+static int discard_payload(struct mqtt_client_t *self_p,
+                           size_t size)
+{
+    uint8_t buf[16];
+    size_t n;
+
+    while (size > 0) {
+        n = MIN(size, sizeof(buf));
+
+        if (chan_reader_read(&self_p->transport.reader, &buf[0], n) != n) {
+            return (-EIO);
+        }
+
+        size -= n;
+    }
+
+    return (0);
+}
+
+/**
+ * Hash given topic level of a child to given parent node.
+ */
+static size_t topic_level_hash(struct mqtt_topic_table_t *self_p,
+                               struct mqtt_topic_node_t *parent_p,
+                               const char *level_p,
+                               size_t size)
+{
+    uint32_t hash;
+
+    /* FNV-1a, seeded with the parent node address. */
+    hash = (2166136261UL ^ (uint32_t)(uintptr_t)parent_p);
+
+    while (size > 0) {
+        hash ^= (uint8_t)*level_p++;
+        hash *= 16777619UL;
+        size--;
+    }
+
+    return (hash % self_p->buckets_max);
+}
+
+/**
+ * Find the child of given parent node with given topic level.
+ */
+static struct mqtt_topic_node_t *topic_child_get(
+    struct mqtt_topic_table_t *self_p,
+    struct mqtt_topic_node_t *parent_p,
+    const char *level_p,
+    size_t size)
+{
+    struct mqtt_topic_node_t *node_p;
+
+    node_p = self_p->buckets_p[topic_level_hash(self_p,
+                                                parent_p,
+                                                level_p,
+                                                size)].list_p;
+
+    while (node_p != NULL) {
+        if ((node_p->parent_p == parent_p)
+            && (node_p->size == size)
+            && (memcmp(node_p->level_p, level_p, size) == 0)) {
+            return (node_p);
+        }
+
+        node_p = node_p->next_p;
+    }
+
+    return (NULL);
+}
+
+/**
+ * Find or create the child of given parent node with given topic
+ * level.
+ */
+static struct mqtt_topic_node_t *topic_child_add(
+    struct mqtt_topic_table_t *self_p,
+    struct mqtt_topic_node_t *parent_p,
+    const char *level_p,
+    size_t size)
+{
+    struct mqtt_topic_node_t *node_p;
+    struct mqtt_topic_bucket_t *bucket_p;
+    int is_plus;
+
+    is_plus = ((size == 1) && (level_p[0] == '+'));
+
+    if (is_plus) {
+        node_p = parent_p->plus_p;
+    } else {
+        node_p = topic_child_get(self_p, parent_p, level_p, size);
+    }
+
+    if (node_p != NULL) {
+        return (node_p);
+    }
+
+    if (self_p->nodes_used == self_p->nodes_max) {
+        return (NULL);
+    }
+
+    node_p = &self_p->nodes_p[self_p->nodes_used];
+    self_p->nodes_used++;
+
+    node_p->next_p = NULL;
+    node_p->parent_p = parent_p;
+    node_p->plus_p = NULL;
+    node_p->level_p = level_p;
+    node_p->size = size;
+    node_p->on_publish = NULL;
+    node_p->on_publish_multi = NULL;
+
+    if (is_plus) {
+        parent_p->plus_p = node_p;
+    } else {
+        bucket_p = &self_p->buckets_p[topic_level_hash(self_p,
+                                                       parent_p,
+                                                       level_p,
+                                                       size)];
+        node_p->next_p = bucket_p->list_p;
+        bucket_p->list_p = node_p;
+    }
+
+    return (node_p);
+}
+
+static mqtt_on_publish_t topic_find(struct mqtt_topic_table_t *self_p,
+                                    struct mqtt_topic_node_t *node_p,
+                                    const char *topic_p);
+
+/**
+ * Match the remaining topic levels, if any, against given node.
+ */
+static mqtt_on_publish_t topic_find_child(struct mqtt_topic_table_t *self_p,
+                                          struct mqtt_topic_node_t *node_p,
+                                          const char *end_p)
+{
+    if (*end_p == '\0') {
+        /* A filter "a/#" also matches the topic "a". */
+        if (node_p->on_publish != NULL) {
+            return (node_p->on_publish);
+        }
+
+        return (node_p->on_publish_multi);
+    }
+
+    return (topic_find(self_p, node_p, end_p + 1));
+}
+
+/**
+ * Find the most specific filter matching given topic, starting at
+ * given node.
+ */
+static mqtt_on_publish_t topic_find(struct mqtt_topic_table_t *self_p,
+                                    struct mqtt_topic_node_t *node_p,
+                                    const char *topic_p)
+{
+    mqtt_on_publish_t on_publish;
+    struct mqtt_topic_node_t *child_p;
+    const char *end_p;
+
+    end_p = topic_p;
+
+    while ((*end_p != '/') && (*end_p != '\0')) {
+        end_p++;
+    }
+
+    /* Exact match. */
+    child_p = topic_child_get(self_p, node_p, topic_p, end_p - topic_p);
+
+    if (child_p != NULL) {
+        on_publish = topic_find_child(self_p, child_p, end_p);
+
+        if (on_publish != NULL) {
+            return (on_publish);
+        }
+    }
+
+    /* Wildcards does not match topics starting with '$'. */
+    if ((node_p == &self_p->root) && (topic_p[0] == '$')) {
+        return (NULL);
+    }
+
+    /* Single level wildcard. */
+    if (node_p->plus_p != NULL) {
+        on_publish = topic_find_child(self_p, node_p->plus_p, end_p);
+
+        if (on_publish != NULL) {
+            return (on_publish);
+        }
+    }
+
+    /* Multi level wildcard. */
+    return (node_p->on_publish_multi);
+}
+
 /**
  * Handle the publish message from the server.
  */
@@ -589,9 +798,11 @@ static int handle_publish(struct mqtt_client_t *self_p,
     uint8_t buf[2];
     uint8_t qos;
     char topic[128];
+    mqtt_on_publish_t on_publish;
+    mqtt_on_publish_t on_publish_match;
 
     /* Read the variable header. */
-    if (chan_read(self_p->transport.in_p, buf, 2) != 2) {
+    if (chan_reader_read(&self_p->transport.reader, buf, 2) != 2) {
         return (-EIO);
     }
 
@@ -602,9 +813,9 @@ static int handle_publish(struct mqtt_client_t *self_p,
     }
 
     /* Read the topic. */
-    if (chan_read(self_p->transport.in_p,
-                  topic,
-                  topic_size) != topic_size) {
+    if (chan_reader_read(&self_p->transport.reader,
+                         topic,
+                         topic_size) != topic_size) {
         return (-EIO);
     }
 
@@ -621,7 +832,7 @@ static int handle_publish(struct mqtt_client_t *self_p,
         payload_size = (size - topic_size - 2);
     } else {
         /* Read the packet identifier. */
-        if (chan_read(self_p->transport.in_p, buf, 2) != 2) {
+        if (chan_reader_read(&self_p->transport.reader, buf, 2) != 2) {
             return (-EIO);
         }
 
@@ -645,10 +856,25 @@ static int handle_publish(struct mqtt_client_t *self_p,
         payload_size = (size - topic_size - 4);
     }
 
-    if (self_p->on_publish(self_p,
-                           topic,
-                           self_p->transport.in_p,
-                           payload_size) != 0) {
+    on_publish = self_p->on_publish;
+
+    if (self_p->topic_table_p != NULL) {
+        on_publish_match = mqtt_topic_table_get(self_p->topic_table_p,
+                                                topic);
+
+        if (on_publish_match != NULL) {
+            on_publish = on_publish_match;
+        }
+    }
+
+    if (on_publish == NULL) {
+        return (discard_payload(self_p, payload_size));
+    }
+
+    if (on_publish(self_p,
+                   topic,
+                   &self_p->transport.reader,
+                   payload_size) != 0) {
         return (-1);
     }
 
@@ -821,10 +1047,15 @@ int mqtt_client_init(struct mqtt_client_t *self_p,
     self_p->message.type = CONTROL_NONE;
     self_p->transport.out_p = transport_out_p;
     self_p->transport.in_p = transport_in_p;
+    chan_reader_init(&self_p->transport.reader,
+                     transport_in_p,
+                     &self_p->transport.reader_buf[0],
+                     sizeof(self_p->transport.reader_buf));
     queue_init(&self_p->control.out, NULL, 0);
     queue_init(&self_p->control.in, NULL, 0);
     self_p->on_publish = on_publish;
     self_p->on_error = on_error;
+    self_p->topic_table_p = NULL;
 
     return (0);
 }
@@ -904,6 +1135,117 @@ int mqtt_client_unsubscribe(struct mqtt_client_t *self_p,
                             sizeof(message_p)));
 }
 
+int mqtt_client_set_topic_table(struct mqtt_client_t *self_p,
+                                struct mqtt_topic_table_t *table_p)
+{
+    ASSERTN(self_p != NULL, EINVAL)
+
+    self_p->topic_table_p = table_p;
+
+    return (0);
+}
+
+int mqtt_topic_table_init(struct mqtt_topic_table_t *self_p,
+                          struct mqtt_topic_bucket_t *buckets_p,
+                          size_t buckets_max,
+                          struct mqtt_topic_node_t *nodes_p,
+                          size_t nodes_max)
+{
+    ASSERTN(self_p != NULL, EINVAL)
+    ASSERTN(buckets_p != NULL, EINVAL)
+    ASSERTN(buckets_max > 0, EINVAL)
+    ASSERTN(nodes_p != NULL, EINVAL)
+
+    size_t i;
+
+    self_p->root.next_p = NULL;
+    self_p->root.parent_p = NULL;
+    self_p->root.plus_p = NULL;
+    self_p->root.level_p = NULL;
+    self_p->root.size = 0;
+    self_p->root.on_publish = NULL;
+    self_p->root.on_publish_multi = NULL;
+    self_p->buckets_p = buckets_p;
+    self_p->buckets_max = buckets_max;
+    self_p->nodes_p = nodes_p;
+    self_p->nodes_max = nodes_max;
+    self_p->nodes_used = 0;
+
+    for (i = 0; i < buckets_max; i++) {
+        buckets_p[i].list_p = NULL;
+    }
+
+    return (0);
+}
+
+int mqtt_topic_table_add(struct mqtt_topic_table_t *self_p,
+                         const char *filter_p,
+                         mqtt_on_publish_t on_publish)
+{
+    ASSERTN(self_p != NULL, EINVAL)
+    ASSERTN(filter_p != NULL, EINVAL)
+    ASSERTN(on_publish != NULL, EINVAL)
+
+    struct mqtt_topic_node_t *node_p;
+    const char *end_p;
+    size_t size;
+
+    node_p = &self_p->root;
+
+    while (1) {
+        end_p = filter_p;
+
+        while ((*end_p != '/') && (*end_p != '\0')) {
+            end_p++;
+        }
+
+        size = (end_p - filter_p);
+
+        /* The multi level wildcard must be the last level. */
+        if ((size == 1) && (filter_p[0] == '#')) {
+            if (*end_p != '\0') {
+                return (-EINVAL);
+            }
+
+            node_p->on_publish_multi = on_publish;
+
+            return (0);
+        }
+
+        /* Wildcards must occupy an entire level. */
+        if ((size > 1)
+            && ((memchr(filter_p, '+', size) != NULL)
+                || (memchr(filter_p, '#', size) != NULL))) {
+            return (-EINVAL);
+        }
+
+        node_p = topic_child_add(self_p, node_p, filter_p, size);
+
+        if (node_p == NULL) {
+            return (-ENOMEM);
+        }
+
+        if (*end_p == '\0') {
+            break;
+        }
+
+        filter_p = (end_p + 1);
+    }
+
+    node_p->on_publish = on_publish;
+
+    return (0);
+}
+
+mqtt_on_publish_t mqtt_topic_table_get(struct mqtt_topic_table_t *self_p,
+                                       const char *topic_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL)
+    ASSERTNRN(topic_p != NULL, EINVAL)
+
+    return (topic_find(self_p, &self_p->root, topic_p));
+}
+
 void *mqtt_client_main(void *arg_p)
 {
     struct mqtt_client_t *self_p = arg_p;
@@ -919,7 +1261,12 @@ void *mqtt_client_main(void *arg_p)
     chan_list_add(&list, self_p->transport.in_p);
 
     while (1) {
-        chan_p = chan_list_poll(&list, NULL);
+        /* Buffered server data is not seen by the poll. */
+        if (chan_reader_buffered(&self_p->transport.reader) > 0) {
+            chan_p = self_p->transport.in_p;
+        } else {
+            chan_p = chan_list_poll(&list, NULL);
+        }
 
         if (chan_p == &self_p->control.in) {
             res = read_control_message(self_p);
@@ -75,6 +75,37 @@ typedef size_t (*mqtt_on_publish_t)(struct mqtt_client_t *client_p,
 typedef int (*mqtt_on_error_t)(struct mqtt_client_t *client_p,
                                int error);
 
+/**
+ * A node in the topic filter trie. Each node represents one topic
+ * level of one or more filters.
+ */
+struct mqtt_topic_node_t {
+    struct mqtt_topic_node_t *next_p;
+    struct mqtt_topic_node_t *parent_p;
+    struct mqtt_topic_node_t *plus_p;
+    const char *level_p;
+    size_t size;
+    mqtt_on_publish_t on_publish;
+    mqtt_on_publish_t on_publish_multi;
+};
+
+struct mqtt_topic_bucket_t {
+    struct mqtt_topic_node_t *list_p;
+};
+
+/**
+ * Topic filter dispatch table. Maps topic filters, optionally with
+ * ``+`` and ``#`` wildcards, to on-publish callbacks.
+ */
+struct mqtt_topic_table_t {
+    struct mqtt_topic_node_t root;
+    struct mqtt_topic_bucket_t *buckets_p;
+    size_t buckets_max;
+    struct mqtt_topic_node_t *nodes_p;
+    size_t nodes_max;
+    size_t nodes_used;
+};
+
 /**
  * MQTT client.
  */
@@ -89,6 +120,8 @@ struct mqtt_client_t {
     struct {
         void *out_p;
         void *in_p;
+        struct chan_reader_t reader;
+        uint8_t reader_buf[CONFIG_MQTT_CLIENT_READER_BUFFER_SIZE];
     } transport;
     struct {
         struct queue_t out;
@@ -96,6 +129,7 @@ struct mqtt_client_t {
     } control;
     mqtt_on_publish_t on_publish;
     mqtt_on_error_t on_error;
+    struct mqtt_topic_table_t *topic_table_p;
 };
 
 /**
@@ -122,7 +156,10 @@ struct mqtt_application_message_t {
  * @param[in] chout_p Output channel for client to server packets.
  * @param[in] chin_p Input channel for server to client packets.
  * @param[in] on_publish On-publish callback function. Called when the
- *                       server publishes a message.
+ *                       server publishes a message that is not
+ *                       matched by the topic table, if any. May be
+ *                       NULL if a topic table is used, in which case
+ *                       unmatched messages are discarded.
  * @param[in] on_error On-error callback function. Called when an error
  *                     occurs. If NULL, a default handler is used.
  *
@@ -211,4 +248,78 @@ int mqtt_client_subscribe(struct mqtt_client_t *self_p,
 int mqtt_client_unsubscribe(struct mqtt_client_t *self_p,
                             struct mqtt_application_message_t *message_p);
 
+/**
+ * Use given topic table to dispatch messages published by the
+ * server. The callback of the most specific matching filter is
+ * called, where an exact topic level is preferred over ``+``, which
+ * is preferred over ``#``. Must be called before the client thread
+ * is started.
+ *
+ * @param[in] self_p MQTT client.
+ * @param[in] table_p Topic table, or NULL to call the on-publish
+ *                    callback given to `mqtt_client_init()` for all
+ *                    messages.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_client_set_topic_table(struct mqtt_client_t *self_p,
+                                struct mqtt_topic_table_t *table_p);
+
+/**
+ * Initialize given topic table. No memory is allocated, all nodes
+ * are taken from given nodes array.
+ *
+ * @param[out] self_p Topic table to initialize.
+ * @param[in] buckets_p Array of buckets.
+ * @param[in] buckets_max Number of entries in `buckets_p`. Should be
+ *                        in the order of the number of nodes.
+ * @param[in] nodes_p Array of nodes.
+ * @param[in] nodes_max Number of entries in `nodes_p`. One node is
+ *                      used for each unique topic level prefix among
+ *                      the added filters.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_topic_table_init(struct mqtt_topic_table_t *self_p,
+                          struct mqtt_topic_bucket_t *buckets_p,
+                          size_t buckets_max,
+                          struct mqtt_topic_node_t *nodes_p,
+                          size_t nodes_max);
+
+/**
+ * Add given topic filter to given topic table. Overwrites the
+ * callback if the filter is already present in the table.
+ *
+ * @param[in] self_p Topic table.
+ * @param[in] filter_p Topic filter, for example ``"sensors/+/temp"``
+ *                     or ``"sensors/#"``. Only a reference to the
+ *                     filter string is stored in the table.
+ * @param[in] on_publish Callback called for matching messages.
+ *
+ * @return zero(0), -EINVAL if the filter is malformed or -ENOMEM if
+ *         the table is out of nodes.
+ */
+int mqtt_topic_table_add(struct mqtt_topic_table_t *self_p,
+                         const char *filter_p,
+                         mqtt_on_publish_t on_publish);
+
+/**
+ * Find the callback of the most specific filter matching given topic
+ * name. Each topic level is looked up by hash, so the time does not
+ * depend on the number of filters in the table. A level without a
+ * matching filter below it is retried with the ``+`` and then the
+ * ``#`` wildcard filter, so in the worst case, with both an exact and
+ * a ``+`` filter at every level, the time grows exponentially with
+ * the number of topic levels. With only exact filters, or only
+ * wildcard filters, the time is proportional to the number of topic
+ * levels.
+ *
+ * @param[in] self_p Topic table.
+ * @param[in] topic_p Topic name.
+ *
+ * @return Callback or NULL if no filter matches given topic.
+ */
+mqtt_on_publish_t mqtt_topic_table_get(struct mqtt_topic_table_t *self_p,
+                                       const char *topic_p);
+
 #endif
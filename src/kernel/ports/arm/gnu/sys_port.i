@@ -87,11 +87,56 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (0);
 }
 
-static int sys_port_get_time_into_tick()
+/**
+ * The system tick timer counts down from LOAD to zero once per system
+ * tick.
+ */
+static uint32_t sys_port_get_cycles(void)
 {
-    return (0);
+    uint32_t load;
+    uint32_t lsb;
+    uint32_t ticks;
+    uint32_t value;
+
+    load = (ARM_ST->LOAD + 1);
+
+    /* Retry if the system tick interrupt occurred during the read. */
+    do {
+        lsb = __atomic_load_n(&module.tick.lsb, __ATOMIC_RELAXED);
+        ticks = lsb;
+        value = ARM_ST->VAL;
+
+        /* The timer has been reloaded but the system tick interrupt
+           is not yet serviced, for example because interrupts are
+           disabled. The value may have been read before the reload,
+           so read it again and add the pending tick. */
+        if (ARM_SCB->ICSR & SCB_ICSR_PENDSTSET) {
+            value = ARM_ST->VAL;
+            ticks++;
+        }
+    } while (lsb != __atomic_load_n(&module.tick.lsb, __ATOMIC_RELAXED));
+
+    return (ticks * load + (load - 1 - value));
+}
+
+static uint32_t sys_port_get_cycles_per_second(void)
+{
+    return ((ARM_ST->LOAD + 1) * CONFIG_SYSTEM_TICK_FREQUENCY);
 }
 
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+/**
+ * Cycles since the system tick timer reached zero, called first in
+ * the system tick interrupt handler.
+ */
+static uint32_t sys_port_get_tick_latency(void)
+{
+    return (ARM_ST->LOAD - ARM_ST->VAL);
+}
+
+#endif
+
 static void sys_port_lock(void)
 {
     asm volatile("cpsid i" : : : "memory");
@@ -113,21 +113,30 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (0);
 }
 
-static long sys_port_get_time_into_tick()
+static uint32_t sys_port_get_cycles(void)
 {
-    long cpu_cycles;
+    return (module.tick.lsb * CPU_CYCLES_PER_SYS_TICK
+            + CPU_CYCLES_PER_TIMER_TICK * (uint32_t)TCNT1);
+}
 
-    cpu_cycles = (CPU_CYCLES_PER_TIMER_TICK * (uint32_t)TCNT1);
+static uint32_t sys_port_get_cycles_per_second(void)
+{
+    return (F_CPU);
+}
 
-    /* Did the counter wrap around to zero, but the system tick
-       interrupt handler has not been executed? */
-    if (TIFR1 & _BV(TOV1)) {
-        cpu_cycles += CPU_CYCLES_PER_SYS_TICK;
-    }
+#if CONFIG_SYS_LOCK_PROFILE == 1
 
-    return (1000ul * (cpu_cycles / (F_CPU / 1000000ul)));
+/**
+ * Cycles since timer 1 matched the compare value, called first in the
+ * system tick interrupt handler.
+ */
+static uint32_t sys_port_get_tick_latency(void)
+{
+    return (CPU_CYCLES_PER_TIMER_TICK * (uint32_t)TCNT1);
 }
 
+#endif
+
 static void sys_port_lock(void)
 {
     asm volatile ("cli" ::: "memory");
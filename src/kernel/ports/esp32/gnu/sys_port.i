@@ -98,11 +98,29 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (0);
 }
 
-static int sys_port_get_time_into_tick()
+static uint32_t sys_port_get_cycles(void)
+{
+    uint32_t ccount;
+
+    asm volatile("rsr %0, ccount" : "=a" (ccount));
+
+    return (ccount);
+}
+
+static uint32_t sys_port_get_cycles_per_second(void)
+{
+    return (F_CPU);
+}
+
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+static uint32_t sys_port_get_tick_latency(void)
 {
     return (0);
 }
 
+#endif
+
 static void RAM_CODE sys_port_lock(void)
 {
     portDISABLE_INTERRUPTS();
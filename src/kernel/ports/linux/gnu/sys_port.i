@@ -36,14 +36,33 @@ struct sys_port_t {
     pthread_t thrd;
     pthread_mutex_t mutex;
     pthread_cond_t cond;
+#if CONFIG_SYS_LOCK_PROFILE == 1
+    struct timespec tick_deadline;
+#endif
 };
 
 static struct sys_port_t sys_port;
 
+#if CONFIG_SYS_MEASURE_INTERRUPT_LOAD == 1
+
+static uint32_t sys_port_get_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint32_t)now.tv_sec * 1000000UL + now.tv_nsec / 1000);
+}
+
+#endif
+
 static void *sys_port_ticker(void *arg)
 {
     struct timespec abstimeout;
     struct timespec now;
+#if CONFIG_SYS_MEASURE_INTERRUPT_LOAD == 1
+    uint32_t start;
+#endif
 
     pthread_mutex_init(&sys_port.mutex, NULL);
     pthread_cond_init (&sys_port.cond, NULL);
@@ -59,7 +78,17 @@ static void *sys_port_ticker(void *arg)
 
         abstimeout.tv_nsec = ((now.tv_nsec + 10000000L) % 1000000000L);
         pthread_cond_timedwait(&sys_port.cond, &sys_port.mutex, &abstimeout);
+#if CONFIG_SYS_LOCK_PROFILE == 1
+        sys_port.tick_deadline = abstimeout;
+#endif
+
+#if CONFIG_SYS_MEASURE_INTERRUPT_LOAD == 1
+        start = sys_port_get_time_us();
         sys_tick_isr();
+        sys.interrupt.time += (sys_port_get_time_us() - start);
+#else
+        sys_tick_isr();
+#endif
     }
 
     return (NULL);
@@ -87,11 +116,46 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (0);
 }
 
-static int sys_port_get_time_into_tick()
+static uint32_t sys_port_get_cycles(void)
 {
-    return (0);
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint32_t)now.tv_sec * 1000000000UL + now.tv_nsec);
+}
+
+static uint32_t sys_port_get_cycles_per_second(void)
+{
+    return (1000000000UL);
 }
 
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+/**
+ * Nanoseconds from the tick deadline until the ticker thread calls
+ * the system tick handler.
+ */
+static uint32_t sys_port_get_tick_latency(void)
+{
+    struct timespec now;
+    int64_t latency;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    latency = ((int64_t)(now.tv_sec - sys_port.tick_deadline.tv_sec)
+               * 1000000000L
+               + (now.tv_nsec - sys_port.tick_deadline.tv_nsec));
+
+    if (latency < 0) {
+        latency = 0;
+    }
+
+    return (latency);
+}
+
+#endif
+
 static void sys_port_lock(void)
 {
     pthread_mutex_lock(&mutex);
@@ -127,9 +191,25 @@ int sys_port_module_init(void)
 
 static cpu_usage_t sys_port_interrupt_cpu_usage_get(void)
 {
+#if CONFIG_SYS_MEASURE_INTERRUPT_LOAD == 1
+    uint32_t period;
+
+    period = (sys_port_get_time_us() - sys.interrupt.start);
+
+    if (period == 0) {
+        return (0);
+    }
+
+    return (((cpu_usage_t)100 * sys.interrupt.time) / period);
+#else
     return (0);
+#endif
 }
 
 static void sys_port_interrupt_cpu_usage_reset(void)
 {
+#if CONFIG_SYS_MEASURE_INTERRUPT_LOAD == 1
+    sys.interrupt.start = sys_port_get_time_us();
+    sys.interrupt.time = 0;
+#endif
 }
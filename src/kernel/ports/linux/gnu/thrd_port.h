@@ -46,6 +46,15 @@ struct thrd_port_t {
     pthread_cond_t cond;
     void *(*main)(void *arg);
     void *arg;
+#if CONFIG_THRD_CPU_USAGE == 1
+    struct {
+        uint32_t start;
+        struct {
+            uint32_t start;
+            uint32_t time;
+        } period;
+    } cpu;
+#endif
 };
 
 #endif
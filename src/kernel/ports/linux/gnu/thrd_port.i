@@ -141,23 +141,77 @@ static void thrd_port_tick(void)
     pthread_mutex_unlock(&idle.mutex);
 }
 
+#if CONFIG_THRD_CPU_USAGE == 1 || CONFIG_THRD_SCHEDULER_STATISTICS == 1
+
+/**
+ * A free running microsecond counter. The monotonic clock is used
+ * rather than the thread CPU time clock since a Simba thread
+ * occupies the (simulated) CPU from the time it is swapped in until
+ * it is swapped out, even when the underlying pthread is blocked in
+ * a system call.
+ */
+static uint32_t thrd_port_get_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint32_t)now.tv_sec * 1000000UL + now.tv_nsec / 1000);
+}
+
+#endif
+
 static void thrd_port_cpu_usage_start(struct thrd_t *thrd_p)
 {
+#if CONFIG_THRD_CPU_USAGE == 1
+    thrd_p->port.cpu.start = thrd_port_get_time_us();
+#endif
 }
 
 static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 {
+#if CONFIG_THRD_CPU_USAGE == 1
+    thrd_p->port.cpu.period.time += (thrd_port_get_time_us()
+                                     - thrd_p->port.cpu.start);
+#endif
 }
 
-#if CONFIG_MONITOR_THREAD == 1
+#if CONFIG_MONITOR_THREAD == 1 && CONFIG_THRD_CPU_USAGE == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
 {
-    return (0);
+    uint32_t now;
+    uint32_t time;
+    uint32_t period;
+
+    now = thrd_port_get_time_us();
+    time = thrd_p->port.cpu.period.time;
+
+    /* Include the time the current thread has been running. */
+    if (thrd_p == thrd_self()) {
+        time += (now - thrd_p->port.cpu.start);
+    }
+
+    period = (now - thrd_p->port.cpu.period.start);
+
+    if (period == 0) {
+        return (0);
+    }
+
+    return (((cpu_usage_t)100 * time) / period);
 }
 
 static void thrd_port_cpu_usage_reset(struct thrd_t *thrd_p)
 {
+    uint32_t now;
+
+    now = thrd_port_get_time_us();
+    thrd_p->port.cpu.period.start = now;
+    thrd_p->port.cpu.period.time = 0;
+
+    if (thrd_p == thrd_self()) {
+        thrd_p->port.cpu.start = now;
+    }
 }
 
 #endif
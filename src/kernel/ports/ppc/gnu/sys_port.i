@@ -183,15 +183,25 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (depth);
 }
 
-static int32_t sys_port_get_time_into_tick()
+static uint32_t sys_port_get_cycles(void)
 {
-    uint32_t count;
+    return (SPC5_STM->CNT);
+}
+
+static uint32_t sys_port_get_cycles_per_second(void)
+{
+    return (F_CPU);
+}
 
-    count = (SPC5_STM->CNT - (SPC5_STM->CHANNELS[0].CMP - SYS_TICK_COUNT));
+#if CONFIG_SYS_LOCK_PROFILE == 1
 
-    return (1000 * (count / (F_CPU / 1000000)));
+static uint32_t sys_port_get_tick_latency(void)
+{
+    return (0);
 }
 
+#endif
+
 static void sys_port_lock(void)
 {
     asm volatile("wrteei 0");
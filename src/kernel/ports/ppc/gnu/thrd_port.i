@@ -141,6 +141,15 @@ static void thrd_port_cpu_usage_reset(struct thrd_t *thrd_p)
 
 #endif
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+
+static uint32_t thrd_port_get_time_us(void)
+{
+    return (thrd_get_time_us_from_cycles());
+}
+
+#endif
+
 static const void *thrd_port_get_bottom_of_stack(struct thrd_t *thrd_p)
 {
     char dummy;
@@ -34,6 +34,11 @@
 #define SECONDS_PER_MSB (INT_MAX / CONFIG_SYSTEM_TICK_FREQUENCY)
 #define TICKS_PER_MSB   (SECONDS_PER_MSB * CONFIG_SYSTEM_TICK_FREQUENCY)
 
+#define NANOSECONDS_PER_TICK                                    \
+    (1000000000UL / CONFIG_SYSTEM_TICK_FREQUENCY)
+#define NANOSECONDS_PER_TICK_REMAINDER                          \
+    (1000000000UL % CONFIG_SYSTEM_TICK_FREQUENCY)
+
 #if CONFIG_SYS_LOG_MASK > 0
 #    define LOG_OBJECT_PRINT(...) log_object_print(__VA_ARGS__)
 #else
@@ -46,9 +51,46 @@ struct tick_t {
     uint32_t lsb;
 };
 
+/* The uptime at the latest system tick, and the cycle counter value
+   when it was taken. Written by the system tick interrupt handler
+   only. Readers do not take the system lock, but retry if the
+   sequence counter is odd or changed during the read. */
+struct clock_t {
+    uint32_t sequence;
+    uint32_t seconds;
+    uint32_t nanoseconds;
+    uint32_t cycles;
+    uint32_t remainder;
+    /* Cycle counter to nanoseconds conversion, set once the port is
+       initialized. */
+    uint32_t cycles_per_tick;
+    uint64_t multiplier;
+};
+
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+struct lock_profile_t {
+    void *address_p;
+    uint32_t start;
+    /* Histogram bucket limits in cycles. */
+    uint32_t limits[SYS_LOCK_PROFILE_HISTOGRAM_MAX - 1];
+    uint32_t interrupt_latency_max;
+    struct sys_lock_profile_site_t sites[CONFIG_SYS_LOCK_PROFILE_SITES_MAX];
+#if CONFIG_SYS_FS_COMMANDS == 1
+    struct fs_counter_t max_hold_us;
+    struct fs_counter_t max_interrupt_latency_us;
+#endif
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
     struct tick_t tick;
+    struct clock_t clock;
+#if CONFIG_SYS_LOCK_PROFILE == 1
+    struct lock_profile_t lock_profile;
+#endif
 #if CONFIG_SYS_RESET_CAUSE == 1
     enum sys_reset_cause_t reset_cause;
 #endif
@@ -60,6 +102,9 @@ struct module_t {
     struct fs_command_t cmd_reboot;
     struct fs_command_t cmd_backtrace;
     struct fs_command_t cmd_reset_cause;
+#    if CONFIG_SYS_LOCK_PROFILE == 1
+    struct fs_command_t cmd_lock_profile;
+#    endif
 #endif
 };
 
@@ -118,8 +163,54 @@ extern void time_tick_isr(void);
 extern void timer_tick_isr(void);
 extern void thrd_tick_isr(void);
 
+static uint32_t sys_port_get_cycles(void);
+
+#if CONFIG_SYS_LOCK_PROFILE == 1
+static void lock_profile_interrupt_latency(void);
+#endif
+
+/**
+ * Advance the uptime one system tick.
+ */
+static void RAM_CODE clock_tick(void)
+{
+    struct clock_t *clock_p;
+    uint32_t sequence;
+
+    clock_p = &module.clock;
+    sequence = clock_p->sequence;
+    __atomic_store_n(&clock_p->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    clock_p->nanoseconds += NANOSECONDS_PER_TICK;
+
+#if NANOSECONDS_PER_TICK_REMAINDER != 0
+    clock_p->remainder += NANOSECONDS_PER_TICK_REMAINDER;
+
+    if (clock_p->remainder >= CONFIG_SYSTEM_TICK_FREQUENCY) {
+        clock_p->remainder -= CONFIG_SYSTEM_TICK_FREQUENCY;
+        clock_p->nanoseconds++;
+    }
+#endif
+
+    if (clock_p->nanoseconds >= 1000000000UL) {
+        clock_p->nanoseconds -= 1000000000UL;
+        clock_p->seconds++;
+    }
+
+    clock_p->cycles = sys_port_get_cycles();
+
+    __atomic_store_n(&clock_p->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
 static void RAM_CODE sys_tick_isr(void)
 {
+    TRACE_EVENT(ISR_ENTER, TRACE_ISR_SYS_TICK, 0);
+
+#if CONFIG_SYS_LOCK_PROFILE == 1
+    lock_profile_interrupt_latency();
+#endif
+
     module.tick.lsb++;
 
     if (module.tick.lsb == TICKS_PER_MSB) {
@@ -127,24 +218,196 @@ static void RAM_CODE sys_tick_isr(void)
         module.tick.lsb = 0;
     }
 
+    clock_tick();
     timer_tick_isr();
     thrd_tick_isr();
+
+    TRACE_EVENT(ISR_EXIT, TRACE_ISR_SYS_TICK, 0);
 }
 
 #include "sys_port.i"
 
-static void tick_to_time(struct time_t *time_p,
-                         struct tick_t *tick_p)
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+    return (((uint64_t)cycles * 1000000) / sys_port_get_cycles_per_second());
+}
+
+static void lock_profile_init(void)
+{
+    struct lock_profile_t *profile_p;
+    uint32_t limit;
+    int i;
+
+    profile_p = &module.lock_profile;
+    limit = DIV_CEIL(sys_port_get_cycles_per_second(), 1000000);
+
+    for (i = 0; i < SYS_LOCK_PROFILE_HISTOGRAM_MAX - 1; i++) {
+        profile_p->limits[i] = limit;
+        limit *= 10;
+    }
+
+    profile_p->interrupt_latency_max = 0;
+    memset(&profile_p->sites[0], 0, sizeof(profile_p->sites));
+}
+
+/**
+ * Find the call site entry of given address. The last entry collects
+ * all call sites that do not fit in the table.
+ */
+static struct sys_lock_profile_site_t *lock_profile_site(void *address_p)
+{
+    struct sys_lock_profile_site_t *site_p;
+    int i;
+    int index;
+
+    index = (((uintptr_t)address_p >> 2)
+             % (CONFIG_SYS_LOCK_PROFILE_SITES_MAX - 1));
+
+    for (i = 0; i < CONFIG_SYS_LOCK_PROFILE_SITES_MAX - 1; i++) {
+        site_p = &module.lock_profile.sites[index];
+
+        if (site_p->address_p == address_p) {
+            return (site_p);
+        }
+
+        if (site_p->address_p == NULL) {
+            site_p->address_p = address_p;
+
+            return (site_p);
+        }
+
+        index++;
+
+        if (index == CONFIG_SYS_LOCK_PROFILE_SITES_MAX - 1) {
+            index = 0;
+        }
+    }
+
+    return (&module.lock_profile.sites[CONFIG_SYS_LOCK_PROFILE_SITES_MAX - 1]);
+}
+
+/**
+ * Account the hold time of the system lock to the call site that
+ * took it. Called with the system lock taken.
+ */
+static void lock_profile_update(void)
+{
+    struct lock_profile_t *profile_p;
+    struct sys_lock_profile_site_t *site_p;
+    uint32_t cycles;
+#if CONFIG_SYS_FS_COMMANDS == 1
+    uint32_t us;
+#endif
+    int i;
+
+    profile_p = &module.lock_profile;
+    cycles = (sys_port_get_cycles() - profile_p->start);
+    site_p = lock_profile_site(profile_p->address_p);
+
+    site_p->count++;
+    site_p->total += cycles;
+
+    if (cycles > site_p->max) {
+        site_p->max = cycles;
+
+#if CONFIG_SYS_FS_COMMANDS == 1
+        us = cycles_to_us(cycles);
+
+        if (us > profile_p->max_hold_us.value) {
+            profile_p->max_hold_us.value = us;
+        }
+#endif
+    }
+
+    for (i = 0; i < SYS_LOCK_PROFILE_HISTOGRAM_MAX - 1; i++) {
+        if (cycles < profile_p->limits[i]) {
+            break;
+        }
+    }
+
+    site_p->histogram[i]++;
+}
+
+/**
+ * Called first in the system tick interrupt handler.
+ */
+static void RAM_CODE lock_profile_interrupt_latency(void)
+{
+    struct lock_profile_t *profile_p;
+    uint32_t latency;
+
+    profile_p = &module.lock_profile;
+    latency = sys_port_get_tick_latency();
+
+    if (latency > profile_p->interrupt_latency_max) {
+        profile_p->interrupt_latency_max = latency;
+
+#if CONFIG_SYS_FS_COMMANDS == 1
+        profile_p->max_interrupt_latency_us.value = cycles_to_us(latency);
+#endif
+    }
+}
+
+#endif
+
+static void clock_init(void)
 {
-    uint32_t lsb_seconds;
-    uint32_t lsb_ticks;
+    uint32_t cycles_per_second;
 
-    lsb_seconds = (tick_p->lsb / CONFIG_SYSTEM_TICK_FREQUENCY);
-    lsb_ticks = (tick_p->lsb - (CONFIG_SYSTEM_TICK_FREQUENCY * lsb_seconds));
+    cycles_per_second = sys_port_get_cycles_per_second();
+    module.clock.cycles_per_tick = (cycles_per_second
+                                    / CONFIG_SYSTEM_TICK_FREQUENCY);
+    module.clock.multiplier = ((1000000000ULL << 32) / cycles_per_second);
+}
+
+/**
+ * Read the uptime without taking the system lock. The time since the
+ * latest system tick is interpolated using the cycle counter.
+ */
+static void RAM_CODE clock_read(struct time_t *time_p)
+{
+    struct clock_t *clock_p;
+    uint32_t sequence;
+    uint32_t seconds;
+    uint32_t nanoseconds;
+    uint32_t cycles;
+    uint32_t into_tick;
+
+    clock_p = &module.clock;
+
+    do {
+        sequence = __atomic_load_n(&clock_p->sequence, __ATOMIC_ACQUIRE);
+        seconds = clock_p->seconds;
+        nanoseconds = clock_p->nanoseconds;
+        cycles = (sys_port_get_cycles() - clock_p->cycles);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (((sequence & 1) == 1)
+             || (__atomic_load_n(&clock_p->sequence, __ATOMIC_RELAXED)
+                 != sequence));
+
+    /* Never interpolate past the next tick to keep the clock
+       monotonic if the tick interrupt is late. */
+    if (cycles > clock_p->cycles_per_tick) {
+        cycles = clock_p->cycles_per_tick;
+    }
+
+    into_tick = ((cycles * clock_p->multiplier) >> 32);
 
-    time_p->seconds = (tick_p->msb * SECONDS_PER_MSB + lsb_seconds);
-    time_p->nanoseconds = (1000 * ((1000000UL * lsb_ticks)
-                                   / CONFIG_SYSTEM_TICK_FREQUENCY));
+    if (into_tick >= NANOSECONDS_PER_TICK) {
+        into_tick = (NANOSECONDS_PER_TICK - 1);
+    }
+
+    nanoseconds += into_tick;
+
+    if (nanoseconds >= 1000000000UL) {
+        nanoseconds -= 1000000000UL;
+        seconds++;
+    }
+
+    time_p->seconds = seconds;
+    time_p->nanoseconds = nanoseconds;
 }
 
 static void init_drivers(void)
@@ -395,6 +658,64 @@ static int cmd_backtrace_cb(int argc,
     return (0);
 }
 
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+static int cmd_lock_profile_cb(int argc,
+                               const char *argv[],
+                               void *out_p,
+                               void *in_p,
+                               void *arg_p,
+                               void *call_arg_p)
+{
+    struct sys_lock_profile_site_t sites[8];
+    ssize_t length;
+    ssize_t i;
+    int j;
+
+    if (argc == 2) {
+        if (strcmp(argv[1], "reset") != 0) {
+            std_fprintf(out_p, OSTR("Usage: lock_profile [reset]\r\n"));
+
+            return (-EINVAL);
+        }
+
+        return (sys_lock_profile_reset());
+    }
+
+    length = sys_lock_profile_read(&sites[0], membersof(sites));
+
+    std_fprintf(out_p,
+                OSTR("   ADDRESS     COUNT  MAX-US  AVG-US"
+                     "    <1US   <10US  <100US    <1MS   <10MS  >=10MS\r\n"));
+
+    for (i = 0; i < length; i++) {
+        std_fprintf(out_p,
+                    OSTR("0x%08lx %9lu %7lu %7lu"),
+                    (unsigned long)(uintptr_t)sites[i].address_p,
+                    (unsigned long)sites[i].count,
+                    (unsigned long)cycles_to_us(sites[i].max),
+                    (unsigned long)cycles_to_us(sites[i].total
+                                                / sites[i].count));
+
+        for (j = 0; j < SYS_LOCK_PROFILE_HISTOGRAM_MAX; j++) {
+            std_fprintf(out_p,
+                        OSTR(" %7lu"),
+                        (unsigned long)sites[i].histogram[j]);
+        }
+
+        std_fprintf(out_p, OSTR("\r\n"));
+    }
+
+    std_fprintf(out_p,
+                OSTR("Maximum interrupt latency: %lu us\r\n"),
+                (unsigned long)cycles_to_us(
+                    sys_lock_profile_interrupt_latency_max()));
+
+    return (0);
+}
+
+#endif
+
 static int cmd_reset_cause_cb(int argc,
                               const char *argv[],
                               void *out_p,
@@ -462,9 +783,43 @@ int sys_module_init(void)
                     cmd_reset_cause_cb,
                     NULL);
     fs_command_register(&module.cmd_reset_cause);
+
+#    if CONFIG_SYS_LOCK_PROFILE == 1
+    fs_command_init(&module.cmd_lock_profile,
+                    CSTR("/kernel/sys/lock_profile"),
+                    cmd_lock_profile_cb,
+                    NULL);
+    fs_command_register(&module.cmd_lock_profile);
+
+    fs_counter_init(&module.lock_profile.max_hold_us,
+                    FSTR("/kernel/sys/lock/max_hold_us"),
+                    0);
+    fs_counter_register(&module.lock_profile.max_hold_us);
+
+    fs_counter_init(&module.lock_profile.max_interrupt_latency_us,
+                    FSTR("/kernel/sys/interrupt/max_latency_us"),
+                    0);
+    fs_counter_register(&module.lock_profile.max_interrupt_latency_us);
+#    endif
+#endif
+
+    int res;
+
+    /* Interpolate from now until the first system tick. */
+    module.clock.cycles = sys_port_get_cycles();
+
+    res = sys_port_module_init();
+
+    /* The cycle counter frequency is known after the port is
+       initialized. */
+    sys_port_lock();
+    clock_init();
+#if CONFIG_SYS_LOCK_PROFILE == 1
+    lock_profile_init();
 #endif
+    sys_port_unlock();
 
-    return (sys_port_module_init());
+    return (res);
 }
 
 int sys_start(void)
@@ -490,6 +845,9 @@ int sys_start(void)
 #if CONFIG_MODULE_INIT_LOG == 1
     log_module_init();
 #endif
+#if CONFIG_TRACE == 1 && CONFIG_MODULE_INIT_TRACE == 1
+    trace_module_init();
+#endif
 #if CONFIG_MODULE_INIT_CHAN == 1
     chan_module_init();
 #endif
@@ -627,36 +985,27 @@ int sys_uptime(struct time_t *uptime_p)
 {
     ASSERTN(uptime_p != NULL, EINVAL);
 
-    struct tick_t tick;
-    struct time_t offset;
-
-    offset.seconds = 0;
+    clock_read(uptime_p);
 
-    sys_lock();
-    tick = module.tick;
-    offset.nanoseconds = sys_port_get_time_into_tick();
-    sys_unlock();
-
-    tick_to_time(uptime_p, &tick);
-
-    return (time_add(uptime_p, uptime_p, &offset));
+    return (0);
 }
 
 int sys_uptime_isr(struct time_t *uptime_p)
 {
     ASSERTN(uptime_p != NULL, EINVAL);
 
-    struct tick_t tick;
-    struct time_t offset;
+    clock_read(uptime_p);
 
-    offset.seconds = 0;
+    return (0);
+}
 
-    tick = module.tick;
-    offset.nanoseconds = sys_port_get_time_into_tick();
+uint64_t sys_uptime_ns(void)
+{
+    struct time_t uptime;
 
-    tick_to_time(uptime_p, &tick);
+    clock_read(&uptime);
 
-    return (time_add(uptime_p, uptime_p, &offset));
+    return ((uint64_t)uptime.seconds * 1000000000UL + uptime.nanoseconds);
 }
 
 void sys_set_on_fatal_callback(sys_on_fatal_fn_t callback)
@@ -695,10 +1044,19 @@ void *sys_get_stdout()
 void sys_lock()
 {
     sys_port_lock();
+#if CONFIG_SYS_LOCK_PROFILE == 1
+    module.lock_profile.address_p = __builtin_return_address(0);
+    module.lock_profile.start = sys_port_get_cycles();
+#endif
+    TRACE_EVENT(LOCK, 0, 0);
 }
 
 void sys_unlock()
 {
+    TRACE_EVENT(UNLOCK, 0, 0);
+#if CONFIG_SYS_LOCK_PROFILE == 1
+    lock_profile_update();
+#endif
     sys_port_unlock();
 }
 
@@ -732,6 +1090,96 @@ void sys_interrupt_cpu_usage_reset()
     sys_port_interrupt_cpu_usage_reset();
 }
 
+uint32_t RAM_CODE sys_get_cycles()
+{
+    return (sys_port_get_cycles());
+}
+
+uint32_t sys_get_cycles_per_second()
+{
+    return (sys_port_get_cycles_per_second());
+}
+
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+ssize_t sys_lock_profile_read(struct sys_lock_profile_site_t *sites_p,
+                              size_t length)
+{
+    ASSERTN(sites_p != NULL, EINVAL);
+
+    struct sys_lock_profile_site_t *site_p;
+    size_t i;
+    int j;
+    int best;
+    int previous;
+
+    previous = -1;
+
+    /* Use the port lock directly to not profile the profiler. */
+    sys_port_lock();
+
+    /* Selection sort on the maximum hold time, ties in table
+       order. */
+    for (i = 0; i < length; i++) {
+        best = -1;
+
+        for (j = 0; j < CONFIG_SYS_LOCK_PROFILE_SITES_MAX; j++) {
+            site_p = &module.lock_profile.sites[j];
+
+            if (site_p->count == 0) {
+                continue;
+            }
+
+            /* Skip already copied call sites. */
+            if (previous != -1) {
+                if (site_p->max > sites_p[i - 1].max) {
+                    continue;
+                }
+
+                if ((site_p->max == sites_p[i - 1].max) && (j <= previous)) {
+                    continue;
+                }
+            }
+
+            if ((best == -1)
+                || (site_p->max > module.lock_profile.sites[best].max)) {
+                best = j;
+            }
+        }
+
+        if (best == -1) {
+            break;
+        }
+
+        sites_p[i] = module.lock_profile.sites[best];
+        previous = best;
+    }
+
+    sys_port_unlock();
+
+    return (i);
+}
+
+uint32_t sys_lock_profile_interrupt_latency_max()
+{
+    return (module.lock_profile.interrupt_latency_max);
+}
+
+int sys_lock_profile_reset()
+{
+    sys_port_lock();
+    lock_profile_init();
+#if CONFIG_SYS_FS_COMMANDS == 1
+    module.lock_profile.max_hold_us.value = 0;
+    module.lock_profile.max_interrupt_latency_us.value = 0;
+#endif
+    sys_port_unlock();
+
+    return (0);
+}
+
+#endif
+
 far_string_t sys_reset_cause_as_string(enum sys_reset_cause_t reset_cause)
 {
     return (reset_cause_string_map[reset_cause]);
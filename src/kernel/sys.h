@@ -47,6 +47,10 @@ typedef uint32_t cpu_usage_t;
 
 typedef void (*sys_on_fatal_fn_t)(int error) __attribute__ ((noreturn));
 
+/** Number of hold time histogram buckets in the lock profiler; <1
+    us, <10 us, <100 us, <1 ms, <10 ms and >=10 ms. */
+#define SYS_LOCK_PROFILE_HISTOGRAM_MAX                     6
+
 /**
  * System reset causes.
  */
@@ -84,6 +88,20 @@ static inline void st2t(sys_tick_t tick, struct time_t *time_p)
                             / CONFIG_SYSTEM_TICK_FREQUENCY) * 1000);
 }
 
+/**
+ * System lock hold time statistics of a call site.
+ */
+struct sys_lock_profile_site_t {
+    /** Return address of the ``sys_lock()`` call. */
+    void *address_p;
+    uint32_t count;
+    /** Maximum hold time in cycles. */
+    uint32_t max;
+    /** Total hold time in cycles. */
+    uint64_t total;
+    uint32_t histogram[SYS_LOCK_PROFILE_HISTOGRAM_MAX];
+};
+
 struct sys_t {
     sys_on_fatal_fn_t on_fatal_callback;
     void *stdin_p;
@@ -171,7 +189,10 @@ int sys_backtrace(void **buf_p, size_t size);
 enum sys_reset_cause_t sys_reset_cause(void);
 
 /**
- * Get the system uptime.
+ * Get the system uptime. The uptime is read without taking the
+ * system lock, and the time since the latest system tick is
+ * interpolated using the cycle counter, giving a resolution of one
+ * cycle counter period instead of one system tick.
  *
  * @param[out] uptime_p System uptime.
  *
@@ -189,6 +210,14 @@ int sys_uptime(struct time_t *uptime_p);
  */
 int sys_uptime_isr(struct time_t *uptime_p);
 
+/**
+ * Get the system uptime in nanoseconds. Same as ``sys_uptime()``, but
+ * as a 64 bits integer that is cheap to subtract and compare.
+ *
+ * @return System uptime in nanoseconds.
+ */
+uint64_t sys_uptime_ns(void);
+
 /**
  * Set the on-fatal-callback function to given callback.
  *
@@ -294,6 +323,55 @@ cpu_usage_t sys_interrupt_cpu_usage_get(void);
  */
 void sys_interrupt_cpu_usage_reset(void);
 
+/**
+ * Get the current value of the free running cycle counter. The
+ * counter wraps around when it reaches its maximum value, so only
+ * differences between two readings are meaningful.
+ *
+ * This function may be called from interrupt context and with the
+ * system lock taken.
+ *
+ * @return Cycle counter value.
+ */
+uint32_t sys_get_cycles(void);
+
+/**
+ * Get the cycle counter frequency.
+ *
+ * @return Number of cycles per second.
+ */
+uint32_t sys_get_cycles_per_second(void);
+
+/**
+ * Copy the system lock profile of the call sites with the longest
+ * maximum hold time, longest first, to given buffer. Only available
+ * if ``CONFIG_SYS_LOCK_PROFILE`` is set.
+ *
+ * @param[out] sites_p Buffer to copy the call sites to.
+ * @param[in] length Maximum number of call sites to copy.
+ *
+ * @return Number of copied call sites or negative error code.
+ */
+ssize_t sys_lock_profile_read(struct sys_lock_profile_site_t *sites_p,
+                              size_t length);
+
+/**
+ * Get the worst case system tick interrupt entry latency since the
+ * last reset. Only measured on ports with a tick timer that can be
+ * read in the interrupt handler, zero otherwise.
+ *
+ * @return Latency in cycles.
+ */
+uint32_t sys_lock_profile_interrupt_latency_max(void);
+
+/**
+ * Clear the system lock profile and the worst case interrupt
+ * latency.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_lock_profile_reset(void);
+
 /**
  * Get the reset cause as a far string.
  */
@@ -65,6 +65,13 @@ struct module_t {
     struct fs_command_t cmd_monitor_set_period_ms;
     struct fs_command_t cmd_monitor_set_print;
 #endif
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1 && !defined(ARCH_LINUX)
+    struct {
+        uint32_t cycles;
+        uint32_t remainder;
+        uint32_t time_us;
+    } clock;
+#endif
 };
 
 static struct module_t module;
@@ -145,6 +152,37 @@ static void thrd_reschedule(void);
 
 void terminate(void);
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1 && !defined(ARCH_LINUX)
+
+/**
+ * Microseconds derived from the system cycle counter, for ports
+ * without a microsecond clock. Called with the system lock taken, at
+ * least once per cycle counter wrap around for the time to be
+ * correct.
+ */
+static uint32_t thrd_get_time_us_from_cycles(void)
+{
+    uint32_t cycles;
+    uint32_t cycles_per_us;
+    uint32_t elapsed;
+
+    cycles = sys_get_cycles();
+    cycles_per_us = (sys_get_cycles_per_second() / 1000000);
+
+    if (cycles_per_us == 0) {
+        cycles_per_us = 1;
+    }
+
+    elapsed = (cycles - module.clock.cycles + module.clock.remainder);
+    module.clock.cycles = cycles;
+    module.clock.time_us += (elapsed / cycles_per_us);
+    module.clock.remainder = (elapsed % cycles_per_us);
+
+    return (module.clock.time_us);
+}
+
+#endif
+
 #include "thrd_port.i"
 
 #if CONFIG_MONITOR_THREAD == 1 && CONFIG_THRD_CPU_USAGE == 1
@@ -154,6 +192,82 @@ void terminate(void);
 /* Stacks. */
 static THRD_STACK(idle_thrd_stack, CONFIG_THRD_IDLE_STACK_SIZE);
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+
+static void statistics_init(struct thrd_t *thrd_p)
+{
+    memset(&thrd_p->statistics.switches,
+           0,
+           sizeof(thrd_p->statistics.switches));
+    memset(&thrd_p->statistics.ready, 0, sizeof(thrd_p->statistics.ready));
+    memset(&thrd_p->statistics.blocked,
+           0,
+           sizeof(thrd_p->statistics.blocked));
+}
+
+/**
+ * Given thread has been made ready to run. Stop measuring the time
+ * it was blocked, and start measuring the scheduling latency.
+ */
+static void statistics_ready(struct thrd_t *thrd_p)
+{
+    uint32_t now;
+
+    now = thrd_port_get_time_us();
+
+    if (thrd_p->statistics.blocked.active == 1) {
+        thrd_p->statistics.blocked.time_us +=
+            (now - thrd_p->statistics.blocked.timestamp);
+        thrd_p->statistics.blocked.active = 0;
+    }
+
+    thrd_p->statistics.ready.timestamp = now;
+}
+
+/**
+ * Account a context switch from given out thread to given in thread.
+ */
+static void statistics_swap(struct thrd_t *in_p,
+                            struct thrd_t *out_p)
+{
+    uint32_t now;
+    uint32_t latency;
+    uint32_t limit;
+    int i;
+
+    now = thrd_port_get_time_us();
+
+    /* Scheduling latency of the in thread. */
+    latency = (now - in_p->statistics.ready.timestamp);
+    in_p->statistics.ready.time_us += latency;
+
+    if (latency > in_p->statistics.ready.max_us) {
+        in_p->statistics.ready.max_us = latency;
+    }
+
+    i = 0;
+    limit = 10;
+
+    while ((i < THRD_LATENCY_HISTOGRAM_MAX - 1) && (latency >= limit)) {
+        i++;
+        limit *= 10;
+    }
+
+    in_p->statistics.ready.histogram[i]++;
+
+    /* A thread that is still ready when swapped out was yielded or
+       preempted, otherwise it blocked. */
+    if (out_p->state == THRD_STATE_READY) {
+        out_p->statistics.switches.involuntary++;
+    } else {
+        out_p->statistics.switches.voluntary++;
+        out_p->statistics.blocked.timestamp = now;
+        out_p->statistics.blocked.active = 1;
+    }
+}
+
+#endif
+
 /**
  * The thread is terminated.
  */
@@ -223,6 +337,10 @@ static void on_suspend_timer_expired(void *arg_p)
  */
 static void scheduler_ready_push(struct thrd_t *thrd_p)
 {
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+    statistics_ready(thrd_p);
+#endif
+
     thrd_prio_list_push_isr(&module.scheduler.ready, &thrd_p->scheduler.elem);
 }
 
@@ -258,6 +376,10 @@ static void thrd_reschedule(void)
 
     if (in_p != out_p) {
         module.scheduler.current_p = in_p;
+        TRACE_EVENT(SWITCH, out_p->state, in_p);
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+        statistics_swap(in_p, out_p);
+#endif
         thrd_port_cpu_usage_stop(out_p);
         thrd_port_cpu_usage_start(in_p);
         thrd_port_swap(in_p, out_p);
@@ -329,6 +451,10 @@ static int cmd_list_cb(int argc,
 #if CONFIG_THRD_SCHEDULED == 1
                      "   SCHEDULED"
 #endif
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+                     "  VOLUNTARY  INVOLUNTARY  READY-MS  BLOCKED-MS"
+                     "  MAX-LATENCY-US"
+#endif
 #if CONFIG_PROFILE_STACK == 1
                      "  MAX-STACK-USAGE"
 #endif
@@ -345,6 +471,9 @@ static int cmd_list_cb(int argc,
 #if CONFIG_THRD_SCHEDULED == 1
                          " %11u"
 #endif
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+                         " %10u %12u %9u %11u %15u"
+#endif
 #if CONFIG_PROFILE_STACK == 1
                          "    %6d/%6d"
 #endif
@@ -361,6 +490,13 @@ static int cmd_list_cb(int argc,
 #if CONFIG_THRD_SCHEDULED == 1
                     (unsigned int)thrd_p->statistics.scheduled,
 #endif
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+                    (unsigned int)thrd_p->statistics.switches.voluntary,
+                    (unsigned int)thrd_p->statistics.switches.involuntary,
+                    (unsigned int)(thrd_p->statistics.ready.time_us / 1000),
+                    (unsigned int)(thrd_p->statistics.blocked.time_us / 1000),
+                    (unsigned int)thrd_p->statistics.ready.max_us,
+#endif
 #if CONFIG_PROFILE_STACK == 1
                     thrd_get_used_stack(thrd_p),
                     (int)thrd_p->stack_size,
@@ -477,6 +613,10 @@ int thrd_module_init(void)
     thrd_p->statistics.scheduled = 0;
 #endif
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+    statistics_init(thrd_p);
+#endif
+
 #if CONFIG_THRD_ENV == 1
     thrd_p->env.variables_p = NULL;
     thrd_p->env.number_of_variables = 0;
@@ -572,6 +712,10 @@ struct thrd_t *thrd_spawn(void *(*main)(void *),
     thrd_p->statistics.scheduled = 0;
 #endif
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+    statistics_init(thrd_p);
+#endif
+
 #if CONFIG_THRD_ENV == 1
     thrd_p->env.variables_p = NULL;
     thrd_p->env.number_of_variables = 0;
@@ -709,6 +853,15 @@ struct thrd_t *thrd_get_by_name(const char *name_p)
     return (NULL);
 }
 
+struct thrd_t *thrd_get_next(struct thrd_t *thrd_p)
+{
+    if (thrd_p == NULL) {
+        return (module.threads_p);
+    }
+
+    return (thrd_p->next_p);
+}
+
 int thrd_set_log_mask(struct thrd_t *thrd_p, int mask)
 {
     ASSERTN(thrd_p != NULL, EINVAL);
@@ -850,6 +1003,13 @@ int thrd_suspend_isr(const struct time_t *timeout_p)
 
     thrd_p = thrd_self();
 
+    TRACE_EVENT(SUSPEND,
+                0,
+                (timeout_p == NULL
+                 ? -1
+                 : (timeout_p->seconds * 1000
+                    + timeout_p->nanoseconds / 1000000)));
+
     /* Immediatly return if the thread is already resumed. */
     if (thrd_p->state == THRD_STATE_RESUMED) {
         thrd_p->state = THRD_STATE_READY;
@@ -882,6 +1042,8 @@ int thrd_resume_isr(struct thrd_t *thrd_p, int err)
 {
     int res;
 
+    TRACE_EVENT(RESUME, 0, thrd_p);
+
     res = 0;
     thrd_p->err = err;
 
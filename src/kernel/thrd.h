@@ -70,6 +70,13 @@
     } while (0)
 
 
+/**
+ * Number of buckets in the scheduling latency histogram. Bucket n
+ * counts latencies below 10^(n+1) microseconds, except the last
+ * bucket that counts all longer latencies.
+ */
+#define THRD_LATENCY_HISTOGRAM_MAX                          6
+
 /**
  * A thread environment variable.
  */
@@ -111,6 +118,23 @@ struct thrd_t {
 #endif
 #if CONFIG_THRD_SCHEDULED == 1
         uint32_t scheduled;
+#endif
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+        struct {
+            uint32_t voluntary;
+            uint32_t involuntary;
+        } switches;
+        struct {
+            uint32_t timestamp;
+            uint64_t time_us;
+            uint32_t max_us;
+            uint32_t histogram[THRD_LATENCY_HISTOGRAM_MAX];
+        } ready;
+        struct {
+            uint32_t timestamp;
+            uint64_t time_us;
+            int8_t active;
+        } blocked;
 #endif
     } statistics;
 #if CONFIG_THRD_ENV == 1
@@ -259,6 +283,15 @@ const char *thrd_get_name(void);
  */
 struct thrd_t *thrd_get_by_name(const char *name_p);
 
+/**
+ * Iterate over all threads in the system.
+ *
+ * @param[in] thrd_p Previous thread, or NULL to get the first thread.
+ *
+ * @return Next thread or NULL if there are no more threads.
+ */
+struct thrd_t *thrd_get_next(struct thrd_t *thrd_p);
+
 /**
  * Set the log mask of given thread.
  *
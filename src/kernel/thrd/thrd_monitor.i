@@ -132,6 +132,36 @@ static int update_cpu_usage(int print)
     return (0);
 }
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+
+/**
+ * Print the scheduling latency histogram of all threads.
+ */
+static void print_latency_histograms(void)
+{
+    struct thrd_t *thrd_p;
+    int i;
+
+    std_printf(FSTR("\r\n                NAME      <10us     <100us"
+                    "       <1ms      <10ms     <100ms    >=100ms\r\n"));
+
+    thrd_p = module.threads_p;
+
+    while (thrd_p != NULL) {
+        std_printf(FSTR("%20s"), thrd_p->name_p);
+
+        for (i = 0; i < THRD_LATENCY_HISTOGRAM_MAX; i++) {
+            std_printf(FSTR(" %10u"),
+                       (unsigned int)thrd_p->statistics.ready.histogram[i]);
+        }
+
+        std_printf(FSTR("\r\n"));
+        thrd_p = thrd_p->next_p;
+    }
+}
+
+#endif
+
 /**
  * The monitor thread monitors the cpu usage of all threads.
  */
@@ -163,6 +193,12 @@ static void *monitor_thrd(void *arg_p)
         }
 
         update_cpu_usage(print);
+
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+        if (print == 1) {
+            print_latency_histograms();
+        }
+#endif
     }
 
     return (NULL);
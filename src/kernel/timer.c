@@ -135,6 +135,7 @@ void RAM_CODE timer_tick_isr(void)
         while (module.head_p->delta == 0) {
             timer_p = module.head_p;
             module.head_p = timer_p->next_p;
+            TRACE_EVENT(TIMER, 0, timer_p->callback);
             timer_p->callback(timer_p->arg_p);
 
             /* Re-set periodic timers. */
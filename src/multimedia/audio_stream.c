@@ -0,0 +1,865 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Consumer states. */
+#define STATE_IDLE                                          0
+#define STATE_OPEN                                          1
+#define STATE_ENDED                                         2
+
+#define CODEC_RAW                                           0
+#define CODEC_PCM8                                          1
+#define CODEC_PCM16                                         2
+#define CODEC_IMA_ADPCM                                     3
+
+/* WAV format tags. */
+#define WAVE_FORMAT_PCM                                0x0001
+#define WAVE_FORMAT_IMA_ADPCM                          0x0011
+
+struct module_t {
+    int initialized;
+    struct fs_counter_t underruns;
+    struct fs_counter_t frames;
+    struct fs_counter_t level;
+    struct fs_counter_t bytes_read;
+};
+
+static struct module_t module;
+
+static const int16_t adpcm_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34,
+    37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494,
+    544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552,
+    1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428,
+    4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086,
+    29794, 32767
+};
+
+static const int8_t adpcm_index_table[8] = {
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static uint16_t read_u16(const uint8_t *buf_p)
+{
+    return (buf_p[0] | ((uint16_t)buf_p[1] << 8));
+}
+
+static uint32_t read_u32(const uint8_t *buf_p)
+{
+    return (read_u16(buf_p) | ((uint32_t)read_u16(&buf_p[2]) << 16));
+}
+
+static size_t input_available(struct audio_stream_t *self_p)
+{
+    return (self_p->input.end - self_p->input.pos);
+}
+
+/**
+ * Move any unread data to the beginning of the read ahead buffer and
+ * fill the rest of it from the source.
+ *
+ * @return Number of bytes read, zero(0) at end of file, or negative
+ *         error code.
+ */
+static ssize_t input_fill(struct audio_stream_t *self_p)
+{
+    ssize_t size;
+
+    self_p->input.end -= self_p->input.pos;
+    memmove(self_p->input.buf_p,
+            &self_p->input.buf_p[self_p->input.pos],
+            self_p->input.end);
+    self_p->input.pos = 0;
+
+    if (self_p->input.end == self_p->input.size) {
+        return (-ENOMEM);
+    }
+
+    size = self_p->input.read(self_p->input.arg_p,
+                              &self_p->input.buf_p[self_p->input.end],
+                              self_p->input.size - self_p->input.end);
+
+    if (size > 0) {
+        self_p->input.end += size;
+        fs_counter_increment(&module.bytes_read, size);
+    }
+
+    return (size);
+}
+
+/**
+ * Wait for at least given number of bytes in the read ahead buffer.
+ *
+ * @return Pointer to the data, or NULL at end of file or on error.
+ */
+static uint8_t *input_require(struct audio_stream_t *self_p, size_t size)
+{
+    while (input_available(self_p) < size) {
+        if (input_fill(self_p) <= 0) {
+            return (NULL);
+        }
+    }
+
+    return (&self_p->input.buf_p[self_p->input.pos]);
+}
+
+static int input_skip(struct audio_stream_t *self_p, size_t size)
+{
+    size_t available;
+
+    while (size > 0) {
+        if (input_available(self_p) == 0) {
+            if (input_fill(self_p) <= 0) {
+                return (-EPROTO);
+            }
+        }
+
+        available = MIN(size, input_available(self_p));
+        self_p->input.pos += available;
+        size -= available;
+    }
+
+    return (0);
+}
+
+/**
+ * Parse the WAV header, if any, up to the beginning of the sample
+ * data.
+ */
+static int decoder_open(struct audio_stream_t *self_p)
+{
+    uint8_t *buf_p;
+    uint32_t size;
+    int format;
+    int bits_per_sample;
+
+    self_p->input.pos = 0;
+    self_p->input.end = 0;
+    self_p->decoder.codec = CODEC_RAW;
+    self_p->decoder.channels = 2;
+    self_p->decoder.block_align = 0;
+    self_p->decoder.block_left = 0;
+    self_p->decoder.left = SIZE_MAX;
+
+    buf_p = input_require(self_p, 12);
+
+    if ((buf_p == NULL)
+        || (memcmp(&buf_p[0], "RIFF", 4) != 0)
+        || (memcmp(&buf_p[8], "WAVE", 4) != 0)) {
+        return (0);
+    }
+
+    self_p->input.pos += 12;
+    format = -1;
+    bits_per_sample = 0;
+
+    while (1) {
+        buf_p = input_require(self_p, 8);
+
+        if (buf_p == NULL) {
+            return (-EPROTO);
+        }
+
+        size = read_u32(&buf_p[4]);
+        self_p->input.pos += 8;
+
+        if (memcmp(&buf_p[0], "data", 4) == 0) {
+            break;
+        }
+
+        if (memcmp(&buf_p[0], "fmt ", 4) == 0) {
+            if (size < 16) {
+                return (-EPROTO);
+            }
+
+            buf_p = input_require(self_p, 16);
+
+            if (buf_p == NULL) {
+                return (-EPROTO);
+            }
+
+            format = read_u16(&buf_p[0]);
+            self_p->decoder.channels = read_u16(&buf_p[2]);
+            self_p->decoder.sample_rate = read_u32(&buf_p[4]);
+            self_p->decoder.block_align = read_u16(&buf_p[12]);
+            bits_per_sample = read_u16(&buf_p[14]);
+            self_p->input.pos += 16;
+            size -= 16;
+        }
+
+        /* Chunks are padded to an even size. */
+        if (input_skip(self_p, size + (size & 1)) != 0) {
+            return (-EPROTO);
+        }
+    }
+
+    if ((self_p->decoder.channels < 1) || (self_p->decoder.channels > 2)) {
+        return (-EPROTO);
+    }
+
+    if ((format == WAVE_FORMAT_PCM) && (bits_per_sample == 8)) {
+        self_p->decoder.codec = CODEC_PCM8;
+    } else if ((format == WAVE_FORMAT_PCM) && (bits_per_sample == 16)) {
+        self_p->decoder.codec = CODEC_PCM16;
+    } else if ((format == WAVE_FORMAT_IMA_ADPCM)
+               && (bits_per_sample == 4)
+               && (self_p->decoder.block_align
+                   > 4 * self_p->decoder.channels)) {
+        self_p->decoder.codec = CODEC_IMA_ADPCM;
+    } else {
+        return (-EPROTO);
+    }
+
+    self_p->decoder.left = size;
+
+    return (0);
+}
+
+static void decode_raw(struct audio_stream_t *self_p,
+                       int16_t *samples_p,
+                       size_t length)
+{
+    memcpy(samples_p,
+           &self_p->input.buf_p[self_p->input.pos],
+           sizeof(*samples_p) * length);
+}
+
+static void decode_pcm8(struct audio_stream_t *self_p,
+                        int16_t *samples_p,
+                        size_t length)
+{
+    const uint8_t *buf_p;
+    size_t i;
+
+    buf_p = &self_p->input.buf_p[self_p->input.pos];
+
+    for (i = 0; i < length; i++) {
+        samples_p[i] = (((int16_t)buf_p[i] - 128) << 8);
+    }
+}
+
+static void decode_pcm16(struct audio_stream_t *self_p,
+                         int16_t *samples_p,
+                         size_t length)
+{
+    const uint8_t *buf_p;
+    size_t i;
+
+    buf_p = &self_p->input.buf_p[self_p->input.pos];
+
+    for (i = 0; i < length; i++) {
+        samples_p[i] = read_u16(&buf_p[2 * i]);
+    }
+}
+
+static int16_t decode_ima_adpcm_nibble(struct audio_stream_t *self_p,
+                                       int channel,
+                                       int nibble)
+{
+    int32_t predictor;
+    int32_t step;
+    int32_t difference;
+    int index;
+
+    predictor = self_p->decoder.adpcm[channel].predictor;
+    index = self_p->decoder.adpcm[channel].index;
+    step = adpcm_step_table[index];
+    difference = (step >> 3);
+
+    if (nibble & 1) {
+        difference += (step >> 2);
+    }
+
+    if (nibble & 2) {
+        difference += (step >> 1);
+    }
+
+    if (nibble & 4) {
+        difference += step;
+    }
+
+    if (nibble & 8) {
+        predictor -= difference;
+    } else {
+        predictor += difference;
+    }
+
+    if (predictor > 32767) {
+        predictor = 32767;
+    } else if (predictor < -32768) {
+        predictor = -32768;
+    }
+
+    index += adpcm_index_table[nibble & 7];
+
+    if (index < 0) {
+        index = 0;
+    } else if (index > 88) {
+        index = 88;
+    }
+
+    self_p->decoder.adpcm[channel].predictor = predictor;
+    self_p->decoder.adpcm[channel].index = index;
+
+    return (predictor);
+}
+
+/**
+ * Decode the header of an IMA ADPCM block; the first sample and the
+ * step index of each channel.
+ */
+static void decode_ima_adpcm_header(struct audio_stream_t *self_p,
+                                    int16_t *samples_p)
+{
+    const uint8_t *buf_p;
+    int channel;
+
+    buf_p = &self_p->input.buf_p[self_p->input.pos];
+
+    for (channel = 0; channel < self_p->decoder.channels; channel++) {
+        self_p->decoder.adpcm[channel].predictor = read_u16(&buf_p[0]);
+        self_p->decoder.adpcm[channel].index = MIN(buf_p[2], 88);
+        samples_p[channel] = self_p->decoder.adpcm[channel].predictor;
+        buf_p += 4;
+    }
+}
+
+/**
+ * Decode IMA ADPCM block data; groups of four bytes, or eight
+ * samples, per channel. The low nibble of each byte is decoded
+ * first.
+ */
+static void decode_ima_adpcm(struct audio_stream_t *self_p,
+                             int16_t *samples_p,
+                             size_t length)
+{
+    const uint8_t *buf_p;
+    int channels;
+    int channel;
+    size_t i;
+    int j;
+
+    channels = self_p->decoder.channels;
+    buf_p = &self_p->input.buf_p[self_p->input.pos];
+
+    for (i = 0; i < length; i += (8 * channels)) {
+        for (channel = 0; channel < channels; channel++) {
+            for (j = 0; j < 4; j++) {
+                samples_p[i + channels * (2 * j) + channel] =
+                    decode_ima_adpcm_nibble(self_p, channel, buf_p[j] & 0xf);
+                samples_p[i + channels * (2 * j + 1) + channel] =
+                    decode_ima_adpcm_nibble(self_p, channel, buf_p[j] >> 4);
+            }
+
+            buf_p += 4;
+        }
+    }
+}
+
+/**
+ * Decode as many samples as possible from the read ahead buffer.
+ *
+ * @return Number of decoded samples, zero(0) at end of data or if
+ *         there is no room for more samples, or -EAGAIN if more
+ *         input is needed.
+ */
+static ssize_t decode(struct audio_stream_t *self_p,
+                      int16_t *samples_p,
+                      size_t length)
+{
+    size_t unit_size;
+    size_t unit_length;
+    size_t size;
+    size_t units;
+    int channels;
+    int header;
+
+    channels = self_p->decoder.channels;
+    size = self_p->decoder.left;
+    header = 0;
+
+    switch (self_p->decoder.codec) {
+
+    case CODEC_PCM8:
+        unit_size = channels;
+        unit_length = channels;
+        break;
+
+    case CODEC_PCM16:
+        unit_size = (2 * channels);
+        unit_length = channels;
+        break;
+
+    case CODEC_IMA_ADPCM:
+        unit_size = (4 * channels);
+
+        if (self_p->decoder.block_left == 0) {
+            header = 1;
+            unit_length = channels;
+        } else {
+            size = self_p->decoder.block_left;
+            unit_length = (8 * channels);
+        }
+
+        break;
+
+    default:
+        unit_size = 2;
+        unit_length = 1;
+        break;
+    }
+
+    /* Ignore trailing bytes that are not a complete unit. */
+    if (size < unit_size) {
+        self_p->decoder.left = 0;
+
+        return (0);
+    }
+
+    if (length < unit_length) {
+        return (0);
+    }
+
+    if (input_available(self_p) < unit_size) {
+        return (-EAGAIN);
+    }
+
+    if (header == 1) {
+        units = 1;
+    } else {
+        units = MIN(MIN(size, input_available(self_p)) / unit_size,
+                    length / unit_length);
+    }
+
+    length = (units * unit_length);
+    size = (units * unit_size);
+
+    switch (self_p->decoder.codec) {
+
+    case CODEC_PCM8:
+        decode_pcm8(self_p, samples_p, length);
+        break;
+
+    case CODEC_PCM16:
+        decode_pcm16(self_p, samples_p, length);
+        break;
+
+    case CODEC_IMA_ADPCM:
+        if (header == 1) {
+            decode_ima_adpcm_header(self_p, samples_p);
+            self_p->decoder.block_left = MIN(self_p->decoder.block_align,
+                                             self_p->decoder.left);
+        } else {
+            decode_ima_adpcm(self_p, samples_p, length);
+        }
+
+        self_p->decoder.block_left -= size;
+        break;
+
+    default:
+        decode_raw(self_p, samples_p, length);
+        break;
+    }
+
+    self_p->input.pos += size;
+    self_p->decoder.left -= size;
+
+    return (length);
+}
+
+/**
+ * Convert given signed 16 bits sample to an unsigned 12 bits DAC
+ * sample.
+ */
+static uint16_t to_dac12(int16_t sample, uint16_t mask)
+{
+    return (((uint16_t)(sample ^ 0x8000) >> 4) & mask);
+}
+
+/**
+ * Convert given decoded samples in place to the output format.
+ *
+ * @return Number of samples in the output format.
+ */
+static int convert(struct audio_stream_t *self_p,
+                   int16_t *samples_p,
+                   size_t length)
+{
+    uint16_t *words_p;
+    uint16_t mask;
+    uint16_t word;
+    size_t i;
+
+    words_p = (uint16_t *)samples_p;
+    mask = __atomic_load_n(&self_p->mask, __ATOMIC_RELAXED);
+
+    if ((self_p->format == AUDIO_STREAM_FORMAT_PCM16)
+        || (self_p->decoder.codec == CODEC_RAW)) {
+        /* Keep the channel tag of raw DAC samples. */
+        if (self_p->format == AUDIO_STREAM_FORMAT_DAC12) {
+            mask |= 0xf000;
+        }
+
+        if (mask != 0xffff) {
+            for (i = 0; i < length; i++) {
+                words_p[i] &= mask;
+            }
+        }
+    } else if (self_p->decoder.channels == 2) {
+        for (i = 0; i < length; i += 2) {
+            word = to_dac12(samples_p[i], mask);
+            words_p[i] = (to_dac12(samples_p[i + 1], mask) | 0x1000);
+            words_p[i + 1] = word;
+        }
+    } else {
+        /* Expand from the end, as each sample becomes two. */
+        for (i = length; i > 0; i--) {
+            word = to_dac12(samples_p[i - 1], mask);
+            words_p[2 * i - 1] = word;
+            words_p[2 * i - 2] = (word | 0x1000);
+        }
+
+        length *= 2;
+    }
+
+    return (length);
+}
+
+/**
+ * Decode the next frame.
+ *
+ * @return Number of samples in the frame, zero(0) at end of stream,
+ *         or negative error code.
+ */
+static int fill_frame(struct audio_stream_t *self_p,
+                      struct audio_stream_frame_t *frame_p)
+{
+    size_t length;
+    size_t size;
+    ssize_t res;
+
+    length = 0;
+    size = CONFIG_AUDIO_STREAM_FRAME_SAMPLES;
+
+    /* Mono samples are duplicated in the DAC format. */
+    if ((self_p->format == AUDIO_STREAM_FORMAT_DAC12)
+        && (self_p->decoder.codec != CODEC_RAW)
+        && (self_p->decoder.channels == 1)) {
+        size /= 2;
+    }
+
+    while (length < size) {
+        res = decode(self_p, &frame_p->samples[length], size - length);
+
+        if (res == -EAGAIN) {
+            res = input_fill(self_p);
+
+            if (res < 0) {
+                return (res);
+            } else if (res == 0) {
+                /* Truncated data. */
+                self_p->decoder.left = 0;
+                break;
+            }
+        } else if (res == 0) {
+            break;
+        } else {
+            length += res;
+        }
+    }
+
+    return (convert(self_p, &frame_p->samples[0], length));
+}
+
+/**
+ * The reader thread. Reads ahead and decodes frames while there are
+ * free frames, and ends each stream with an empty frame, or a frame
+ * with an error code.
+ */
+static void *reader_main(void *arg_p)
+{
+    struct audio_stream_t *self_p;
+    struct audio_stream_frame_t *frame_p;
+    uint8_t index;
+    int res;
+
+    self_p = arg_p;
+    thrd_set_name("audio_stream");
+
+    while (1) {
+        sem_take(&self_p->sem, NULL);
+        res = decoder_open(self_p);
+
+        while (1) {
+            spsc_queue_read(&self_p->queues.free, &index, sizeof(index));
+            frame_p = &self_p->frames_p[index];
+
+            if (res >= 0) {
+                if (__atomic_load_n(&self_p->stopping, __ATOMIC_ACQUIRE)) {
+                    res = 0;
+                } else {
+                    res = fill_frame(self_p, frame_p);
+                }
+            }
+
+            frame_p->length = res;
+            spsc_queue_write(&self_p->queues.full, &index, sizeof(index));
+
+            if (res <= 0) {
+                break;
+            }
+        }
+    }
+
+    return (NULL);
+}
+
+int audio_stream_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    fs_counter_init(&module.underruns,
+                    FSTR("/multimedia/audio_stream/underruns"),
+                    0);
+    fs_counter_register(&module.underruns);
+
+    fs_counter_init(&module.frames,
+                    FSTR("/multimedia/audio_stream/frames"),
+                    0);
+    fs_counter_register(&module.frames);
+
+    fs_counter_init(&module.level,
+                    FSTR("/multimedia/audio_stream/level"),
+                    0);
+    fs_counter_register(&module.level);
+
+    fs_counter_init(&module.bytes_read,
+                    FSTR("/multimedia/audio_stream/bytes_read"),
+                    0);
+    fs_counter_register(&module.bytes_read);
+
+    return (0);
+}
+
+int audio_stream_init(struct audio_stream_t *self_p,
+                      struct audio_stream_frame_t *frames_p,
+                      int length,
+                      void *buf_p,
+                      size_t size,
+                      int format)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frames_p != NULL, EINVAL);
+    ASSERTN((length > 0) && (length <= AUDIO_STREAM_FRAMES_MAX), EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size >= 16, EINVAL);
+    ASSERTN((format == AUDIO_STREAM_FORMAT_PCM16)
+            || (format == AUDIO_STREAM_FORMAT_DAC12), EINVAL);
+
+    uint8_t index;
+
+    self_p->frames_p = frames_p;
+    self_p->state = STATE_IDLE;
+    self_p->started = 0;
+    self_p->stopping = 0;
+    self_p->format = format;
+    self_p->input.buf_p = buf_p;
+    self_p->input.size = size;
+    self_p->input.pos = 0;
+    self_p->input.end = 0;
+    self_p->thrd_p = NULL;
+    audio_stream_set_bits_per_sample(self_p,
+                                     (format == AUDIO_STREAM_FORMAT_PCM16
+                                      ? 16
+                                      : 12));
+    spsc_queue_init(&self_p->queues.full,
+                    &self_p->queues.full_buf[0],
+                    sizeof(self_p->queues.full_buf));
+    spsc_queue_init(&self_p->queues.free,
+                    &self_p->queues.free_buf[0],
+                    sizeof(self_p->queues.free_buf));
+
+    for (index = 0; index < length; index++) {
+        spsc_queue_write(&self_p->queues.free, &index, sizeof(index));
+    }
+
+    return (sem_init(&self_p->sem, 1, 1));
+}
+
+int audio_stream_start(struct audio_stream_t *self_p,
+                       void *stack_p,
+                       size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+    self_p->thrd_p = thrd_spawn(reader_main,
+                                self_p,
+                                0,
+                                stack_p,
+                                stack_size);
+
+    return (self_p->thrd_p != NULL ? 0 : -1);
+}
+
+int audio_stream_open(struct audio_stream_t *self_p,
+                      audio_stream_read_t read,
+                      void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(read != NULL, EINVAL);
+
+    if (self_p->state == STATE_OPEN) {
+        return (-EBUSY);
+    }
+
+    self_p->input.read = read;
+    self_p->input.arg_p = arg_p;
+    self_p->state = STATE_OPEN;
+    self_p->started = 0;
+    __atomic_store_n(&self_p->stopping, 0, __ATOMIC_RELEASE);
+
+    return (sem_give(&self_p->sem, 1));
+}
+
+int audio_stream_close(struct audio_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint8_t index;
+    int length;
+
+    if (self_p->state == STATE_OPEN) {
+        __atomic_store_n(&self_p->stopping, 1, __ATOMIC_RELEASE);
+
+        /* Give all frames back to the reader thread until it has
+           ended the stream. */
+        do {
+            spsc_queue_read(&self_p->queues.full, &index, sizeof(index));
+            length = self_p->frames_p[index].length;
+            spsc_queue_write(&self_p->queues.free, &index, sizeof(index));
+        } while (length > 0);
+    }
+
+    self_p->state = STATE_IDLE;
+
+    return (0);
+}
+
+int audio_stream_read_frame(struct audio_stream_t *self_p,
+                            struct audio_stream_frame_t **frame_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frame_pp != NULL, EINVAL);
+
+    struct audio_stream_frame_t *frame_p;
+    size_t level;
+    uint8_t index;
+    int length;
+
+    if (self_p->state != STATE_OPEN) {
+        return (0);
+    }
+
+    level = spsc_queue_size(&self_p->queues.full);
+
+    if (level == 0) {
+        if (self_p->started == 1) {
+            fs_counter_increment(&module.underruns, 1);
+        }
+
+        return (-EAGAIN);
+    }
+
+    spsc_queue_read(&self_p->queues.full, &index, sizeof(index));
+    frame_p = &self_p->frames_p[index];
+    length = frame_p->length;
+
+    if (length <= 0) {
+        self_p->state = STATE_ENDED;
+        spsc_queue_write(&self_p->queues.free, &index, sizeof(index));
+
+        return (length);
+    }
+
+    self_p->started = 1;
+    fs_counter_increment(&module.frames, 1);
+    fs_counter_increment(&module.level, level - 1);
+    *frame_pp = frame_p;
+
+    return (length);
+}
+
+int audio_stream_release_frame(struct audio_stream_t *self_p,
+                               struct audio_stream_frame_t *frame_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frame_p != NULL, EINVAL);
+
+    uint8_t index;
+
+    index = (frame_p - self_p->frames_p);
+    spsc_queue_write(&self_p->queues.free, &index, sizeof(index));
+
+    return (0);
+}
+
+int audio_stream_set_bits_per_sample(struct audio_stream_t *self_p,
+                                     int value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int bits;
+    uint16_t mask;
+
+    if (self_p->format == AUDIO_STREAM_FORMAT_PCM16) {
+        bits = 16;
+    } else {
+        bits = 12;
+    }
+
+    if ((value < 0) || (value > bits)) {
+        return (-EINVAL);
+    }
+
+    mask = ((1 << bits) - 1);
+    mask &= ~((1 << (bits - value)) - 1);
+    __atomic_store_n(&self_p->mask, mask, __ATOMIC_RELAXED);
+
+    return (0);
+}
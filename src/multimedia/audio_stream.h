@@ -0,0 +1,228 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __MULTIMEDIA_AUDIO_STREAM_H__
+#define __MULTIMEDIA_AUDIO_STREAM_H__
+
+#include "simba.h"
+
+/** Maximum number of frames in an audio stream. */
+#define AUDIO_STREAM_FRAMES_MAX                            16
+
+/** Signed 16 bits samples, interleaved if stereo. */
+#define AUDIO_STREAM_FORMAT_PCM16                           0
+
+/**
+ * Unsigned 12 bits stereo DAC samples. The second channel comes
+ * first in each pair of samples, with bit 12 set, as expected by the
+ * SAM DAC in tag mode. Mono streams are played on both channels.
+ */
+#define AUDIO_STREAM_FORMAT_DAC12                           1
+
+/**
+ * Read up to given number of bytes from the stream source.
+ *
+ * @param[in] arg_p Argument given to `audio_stream_open()`.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Maximum number of bytes to read.
+ *
+ * @return Number of bytes read, zero(0) at end of file, or negative
+ *         error code.
+ */
+typedef ssize_t (*audio_stream_read_t)(void *arg_p,
+                                       void *buf_p,
+                                       size_t size);
+
+/**
+ * A frame of decoded samples, given to the DAC in one conversion.
+ */
+struct audio_stream_frame_t {
+    /** Number of samples in the frame. */
+    int length;
+    int16_t samples[CONFIG_AUDIO_STREAM_FRAME_SAMPLES];
+};
+
+struct audio_stream_t {
+    struct audio_stream_frame_t *frames_p;
+    int state;
+    int started;
+    int stopping;
+    uint16_t mask;
+    int format;
+    struct {
+        audio_stream_read_t read;
+        void *arg_p;
+        uint8_t *buf_p;
+        size_t size;
+        size_t pos;
+        size_t end;
+    } input;
+    struct {
+        int codec;
+        int channels;
+        int sample_rate;
+        size_t block_align;
+        size_t block_left;
+        size_t left;
+        struct {
+            int16_t predictor;
+            int8_t index;
+        } adpcm[2];
+    } decoder;
+    struct {
+        struct spsc_queue_t full;
+        struct spsc_queue_t free;
+        uint8_t full_buf[AUDIO_STREAM_FRAMES_MAX];
+        uint8_t free_buf[AUDIO_STREAM_FRAMES_MAX];
+    } queues;
+    struct sem_t sem;
+    struct thrd_t *thrd_p;
+};
+
+/**
+ * Initialize the audio stream module. This function must be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_module_init(void);
+
+/**
+ * Initialize given audio stream.
+ *
+ * @param[out] self_p Audio stream to initialize.
+ * @param[in] frames_p Frames to decode into.
+ * @param[in] length Number of frames, at most
+ *                   ``AUDIO_STREAM_FRAMES_MAX``.
+ * @param[in] buf_p Read ahead buffer of the reader thread.
+ * @param[in] size Size of the read ahead buffer, at least 16
+ *                 bytes. Bigger buffers gives fewer and larger
+ *                 reads.
+ * @param[in] format Output sample format, one of
+ *                   ``AUDIO_STREAM_FORMAT_*``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_init(struct audio_stream_t *self_p,
+                      struct audio_stream_frame_t *frames_p,
+                      int length,
+                      void *buf_p,
+                      size_t size,
+                      int format);
+
+/**
+ * Start the reader thread of given audio stream.
+ *
+ * @param[in] self_p Audio stream.
+ * @param[in] stack_p Reader thread stack.
+ * @param[in] stack_size Reader thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_start(struct audio_stream_t *self_p,
+                       void *stack_p,
+                       size_t stack_size);
+
+/**
+ * Start streaming from given source. The reader thread reads ahead
+ * and decodes the source into frames until all frames are full.
+ *
+ * The source is a WAV file with 8 or 16 bits PCM, or 4 bits IMA
+ * ADPCM, samples, or, if it does not start with a RIFF header, raw
+ * samples in the output format.
+ *
+ * The source must not be closed until the end of the stream is read
+ * or `audio_stream_close()` returns.
+ *
+ * @param[in] self_p Audio stream.
+ * @param[in] read Source read function.
+ * @param[in] arg_p Source read function argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_open(struct audio_stream_t *self_p,
+                      audio_stream_read_t read,
+                      void *arg_p);
+
+/**
+ * Stop streaming. All frames read with `audio_stream_read_frame()`
+ * must have been released before calling this function.
+ *
+ * @param[in] self_p Audio stream.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_close(struct audio_stream_t *self_p);
+
+/**
+ * Get the next decoded frame, without waiting. The frame must be
+ * released with `audio_stream_release_frame()` once the samples are
+ * no longer needed, for example when the DAC has converted them.
+ *
+ * @param[in] self_p Audio stream.
+ * @param[out] frame_pp The frame.
+ *
+ * @return Number of samples in the frame, zero(0) at end of stream,
+ *         -EAGAIN if the reader thread has not decoded the next frame
+ *         yet, or other negative error code if the source could not
+ *         be decoded. No frame is
+ *         returned unless the number of samples is positive.
+ */
+int audio_stream_read_frame(struct audio_stream_t *self_p,
+                            struct audio_stream_frame_t **frame_pp);
+
+/**
+ * Give given frame back to the reader thread.
+ *
+ * @param[in] self_p Audio stream.
+ * @param[in] frame_p Frame to release.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_release_frame(struct audio_stream_t *self_p,
+                               struct audio_stream_frame_t *frame_p);
+
+/**
+ * Reduce the number of bits per sample in frames decoded from now
+ * on, by clearing the least significant bits. The output format has
+ * 16 (PCM16) or 12 (DAC12) bits by default.
+ *
+ * @param[in] self_p Audio stream.
+ * @param[in] value Number of bits per sample.
+ *
+ * @return zero(0) or negative error code.
+ */
+int audio_stream_set_bits_per_sample(struct audio_stream_t *self_p,
+                                     int value);
+
+#endif
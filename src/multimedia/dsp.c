@@ -0,0 +1,700 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define ENVELOPE_PHASE_IDLE                                 0
+#define ENVELOPE_PHASE_ATTACK                               1
+#define ENVELOPE_PHASE_DECAY                                2
+#define ENVELOPE_PHASE_SUSTAIN                              3
+#define ENVELOPE_PHASE_RELEASE                              4
+
+/* Maximum envelope level, a Q15 gain of 1.0 in the upper 16 bits. */
+#define ENVELOPE_LEVEL_MAX                         0x7fff0000L
+
+static int16_t saturate(int32_t value)
+{
+    if (value > 32767) {
+        value = 32767;
+    } else if (value < -32768) {
+        value = -32768;
+    }
+
+    return (value);
+}
+
+/* The generic kernels. The SIMD ports use them for the samples that
+   do not fill a vector, and must give the same result. */
+
+static void mix_generic(int16_t *dst_p,
+                        const int16_t *src_p,
+                        int16_t gain,
+                        size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        dst_p[i] = saturate(dst_p[i]
+                            + saturate(((int32_t)src_p[i] * gain) >> 15));
+    }
+}
+
+static void gain_generic(int16_t *samples_p, int16_t gain, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        samples_p[i] = saturate(((int32_t)samples_p[i] * gain) >> 15);
+    }
+}
+
+static void saturate_generic(int16_t *dst_p,
+                             const int32_t *src_p,
+                             size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        dst_p[i] = saturate(src_p[i]);
+    }
+}
+
+static int32_t dot_generic(const int16_t *x_p, const int16_t *h_p, int length)
+{
+    int32_t sum;
+    int i;
+
+    sum = 0;
+
+    for (i = 0; i < length; i++) {
+        sum += ((int32_t)x_p[i] * h_p[i]);
+    }
+
+    return (sum);
+}
+
+#if (CONFIG_DSP_SIMD == 1) && defined(__SSE2__)
+#    include "dsp/sse2.i"
+#elif (CONFIG_DSP_SIMD == 1) && defined(__ARM_NEON)
+#    include "dsp/neon.i"
+#elif (CONFIG_DSP_SIMD == 1) && (defined(__ARM_ARCH_7EM__)         \
+                                  || defined(__ARM_FEATURE_DSP))
+#    include "dsp/arm_dsp.i"
+#else
+#    define mix_port mix_generic
+#    define gain_port gain_generic
+#    define saturate_port saturate_generic
+#    define dot_port dot_generic
+#endif
+
+/**
+ * Render given oscillator and add it to given accumulator.
+ */
+static void oscillator_render(struct dsp_oscillator_t *self_p,
+                              const int16_t *wavetable_p,
+                              int shift,
+                              int32_t *accumulator_p,
+                              size_t length)
+{
+    uint32_t phase;
+    uint32_t increment;
+    int32_t gain;
+    size_t i;
+
+    phase = self_p->phase;
+    increment = self_p->increment;
+    gain = self_p->gain;
+
+    for (i = 0; i < length; i++) {
+        accumulator_p[i] += ((wavetable_p[phase >> shift] * gain) >> 15);
+        phase += increment;
+    }
+
+    self_p->phase = phase;
+}
+
+/**
+ * Apply the envelope level to given samples while ramping it towards
+ * given target.
+ *
+ * @return Number of samples before the target was reached.
+ */
+static size_t envelope_ramp(struct dsp_envelope_t *self_p,
+                            int16_t *samples_p,
+                            size_t length,
+                            int32_t step,
+                            int32_t target)
+{
+    int32_t level;
+    size_t i;
+
+    level = self_p->level;
+
+    for (i = 0; i < length; i++) {
+        if (level == target) {
+            break;
+        }
+
+        samples_p[i] = ((samples_p[i] * (level >> 16)) >> 15);
+
+        if (level < target) {
+            if (target - level <= step) {
+                level = target;
+            } else {
+                level += step;
+            }
+        } else {
+            if (level - target <= step) {
+                level = target;
+            } else {
+                level -= step;
+            }
+        }
+    }
+
+    self_p->level = level;
+
+    return (i);
+}
+
+static int32_t envelope_step(int32_t distance, size_t length)
+{
+    if (length == 0) {
+        return (ENVELOPE_LEVEL_MAX);
+    }
+
+    return (MAX(distance / (int32_t)MIN(length, 0x7fffffffL), 1));
+}
+
+static int float_to_q14(float value, int16_t *q14_p)
+{
+    int32_t q14;
+
+    if ((value < -2.0f) || (value >= 2.0f)) {
+        return (-EINVAL);
+    }
+
+    if (value >= 0.0f) {
+        q14 = (value * 16384.0f + 0.5f);
+    } else {
+        q14 = (value * 16384.0f - 0.5f);
+    }
+
+    *q14_p = saturate(q14);
+
+    return (0);
+}
+
+int dsp_mix(int16_t *dst_p,
+            const int16_t *src_p,
+            int16_t gain,
+            size_t length)
+{
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    mix_port(dst_p, src_p, gain, length);
+
+    return (0);
+}
+
+int dsp_gain(int16_t *samples_p, int16_t gain, size_t length)
+{
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    gain_port(samples_p, gain, length);
+
+    return (0);
+}
+
+int dsp_oscillator_bank_init(struct dsp_oscillator_bank_t *self_p,
+                             const int16_t *wavetable_p,
+                             size_t wavetable_length,
+                             int sample_rate,
+                             struct dsp_oscillator_t *oscillators_p,
+                             int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(wavetable_p != NULL, EINVAL);
+    ASSERTN(sample_rate > 0, EINVAL);
+    ASSERTN(oscillators_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    if ((wavetable_length < 2)
+        || ((wavetable_length & (wavetable_length - 1)) != 0)) {
+        return (-EINVAL);
+    }
+
+    self_p->wavetable_p = wavetable_p;
+    self_p->shift = 32;
+
+    while (wavetable_length > 1) {
+        self_p->shift--;
+        wavetable_length >>= 1;
+    }
+
+    self_p->sample_rate = sample_rate;
+    self_p->oscillators_p = oscillators_p;
+    self_p->length = length;
+    memset(oscillators_p, 0, sizeof(*oscillators_p) * length);
+
+    return (0);
+}
+
+int dsp_oscillator_bank_set(struct dsp_oscillator_bank_t *self_p,
+                            int index,
+                            float frequency,
+                            int16_t gain)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((index >= 0) && (index < self_p->length), EINVAL);
+
+    if ((frequency < 0.0f) || (2.0f * frequency >= self_p->sample_rate)) {
+        return (-EINVAL);
+    }
+
+    self_p->oscillators_p[index].increment =
+        (frequency * (4294967296.0f / self_p->sample_rate));
+    self_p->oscillators_p[index].gain = gain;
+
+    return (0);
+}
+
+int dsp_oscillator_bank_render(struct dsp_oscillator_bank_t *self_p,
+                               int16_t *samples_p,
+                               size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    int32_t accumulator[CONFIG_DSP_BLOCK_SIZE];
+    struct dsp_oscillator_t *oscillator_p;
+    size_t size;
+    int i;
+
+    while (length > 0) {
+        size = MIN(length, CONFIG_DSP_BLOCK_SIZE);
+        memset(&accumulator[0], 0, sizeof(accumulator[0]) * size);
+
+        for (i = 0; i < self_p->length; i++) {
+            oscillator_p = &self_p->oscillators_p[i];
+
+            if (oscillator_p->gain == 0) {
+                continue;
+            }
+
+            oscillator_render(oscillator_p,
+                              self_p->wavetable_p,
+                              self_p->shift,
+                              &accumulator[0],
+                              size);
+        }
+
+        saturate_port(samples_p, &accumulator[0], size);
+        samples_p += size;
+        length -= size;
+    }
+
+    return (0);
+}
+
+int dsp_oscillator_bank_render_one(struct dsp_oscillator_bank_t *self_p,
+                                   int index,
+                                   int16_t *samples_p,
+                                   size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((index >= 0) && (index < self_p->length), EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    struct dsp_oscillator_t *oscillator_p;
+    uint32_t phase;
+    uint32_t increment;
+    int32_t gain;
+    size_t i;
+
+    oscillator_p = &self_p->oscillators_p[index];
+    phase = oscillator_p->phase;
+    increment = oscillator_p->increment;
+    gain = oscillator_p->gain;
+
+    /* A single oscillator never overflows, so no saturation is
+       needed. */
+    for (i = 0; i < length; i++) {
+        samples_p[i] = ((self_p->wavetable_p[phase >> self_p->shift] * gain)
+                        >> 15);
+        phase += increment;
+    }
+
+    oscillator_p->phase = phase;
+
+    return (0);
+}
+
+int dsp_envelope_init(struct dsp_envelope_t *self_p,
+                      size_t attack,
+                      size_t decay,
+                      int16_t sustain,
+                      size_t release)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(sustain >= 0, EINVAL);
+
+    self_p->phase = ENVELOPE_PHASE_IDLE;
+    self_p->level = 0;
+    self_p->sustain = ((int32_t)sustain << 16);
+    self_p->attack = envelope_step(ENVELOPE_LEVEL_MAX, attack);
+    self_p->decay = envelope_step(ENVELOPE_LEVEL_MAX - self_p->sustain,
+                                  decay);
+    self_p->release = envelope_step(ENVELOPE_LEVEL_MAX, release);
+
+    return (0);
+}
+
+int dsp_envelope_start(struct dsp_envelope_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->phase = ENVELOPE_PHASE_ATTACK;
+
+    return (0);
+}
+
+int dsp_envelope_release(struct dsp_envelope_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->phase != ENVELOPE_PHASE_IDLE) {
+        self_p->phase = ENVELOPE_PHASE_RELEASE;
+    }
+
+    return (0);
+}
+
+ssize_t dsp_envelope_apply(struct dsp_envelope_t *self_p,
+                           int16_t *samples_p,
+                           size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    size_t i;
+
+    i = 0;
+
+    while (i < length) {
+        switch (self_p->phase) {
+
+        case ENVELOPE_PHASE_ATTACK:
+            i += envelope_ramp(self_p,
+                               &samples_p[i],
+                               length - i,
+                               self_p->attack,
+                               ENVELOPE_LEVEL_MAX);
+
+            if (self_p->level == ENVELOPE_LEVEL_MAX) {
+                self_p->phase = ENVELOPE_PHASE_DECAY;
+            }
+
+            break;
+
+        case ENVELOPE_PHASE_DECAY:
+            i += envelope_ramp(self_p,
+                               &samples_p[i],
+                               length - i,
+                               self_p->decay,
+                               self_p->sustain);
+
+            if (self_p->level == self_p->sustain) {
+                self_p->phase = ENVELOPE_PHASE_SUSTAIN;
+            }
+
+            break;
+
+        case ENVELOPE_PHASE_SUSTAIN:
+            gain_port(&samples_p[i], self_p->level >> 16, length - i);
+            i = length;
+            break;
+
+        case ENVELOPE_PHASE_RELEASE:
+            i += envelope_ramp(self_p,
+                               &samples_p[i],
+                               length - i,
+                               self_p->release,
+                               0);
+
+            if (self_p->level == 0) {
+                self_p->phase = ENVELOPE_PHASE_IDLE;
+            }
+
+            break;
+
+        default:
+            memset(&samples_p[i], 0, sizeof(*samples_p) * (length - i));
+
+            return (i);
+        }
+    }
+
+    return (length);
+}
+
+int dsp_envelope_is_active(struct dsp_envelope_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->phase != ENVELOPE_PHASE_IDLE);
+}
+
+int dsp_fir_init(struct dsp_fir_t *self_p,
+                 const int16_t *coefficients_p,
+                 int length,
+                 int16_t *state_p,
+                 size_t state_length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(coefficients_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+    ASSERTN(state_p != NULL, EINVAL);
+
+    int i;
+
+    if (state_length < DSP_FIR_STATE_LENGTH(length)) {
+        return (-EINVAL);
+    }
+
+    /* The coefficients are stored in reverse order so that each
+       output sample is the dot product of the coefficients and
+       consecutive input samples. */
+    self_p->coefficients_p = state_p;
+    self_p->history_p = &state_p[length];
+    self_p->length = length;
+
+    for (i = 0; i < length; i++) {
+        self_p->coefficients_p[i] = coefficients_p[length - 1 - i];
+    }
+
+    memset(self_p->history_p,
+           0,
+           sizeof(*state_p) * (length - 1 + CONFIG_DSP_BLOCK_SIZE));
+
+    return (0);
+}
+
+int dsp_fir_filter(struct dsp_fir_t *self_p,
+                   int16_t *dst_p,
+                   const int16_t *src_p,
+                   size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    int16_t *history_p;
+    size_t size;
+    size_t i;
+    int taps;
+
+    history_p = self_p->history_p;
+    taps = self_p->length;
+
+    while (length > 0) {
+        size = MIN(length, CONFIG_DSP_BLOCK_SIZE);
+
+        /* Append the input samples to the last taps - 1 samples of
+           the previous block. */
+        memcpy(&history_p[taps - 1], src_p, sizeof(*src_p) * size);
+
+        for (i = 0; i < size; i++) {
+            dst_p[i] = saturate(dot_port(&history_p[i],
+                                         self_p->coefficients_p,
+                                         taps) >> 15);
+        }
+
+        memmove(&history_p[0],
+                &history_p[size],
+                sizeof(*history_p) * (taps - 1));
+        dst_p += size;
+        src_p += size;
+        length -= size;
+    }
+
+    return (0);
+}
+
+int dsp_biquad_init(struct dsp_biquad_t *self_p,
+                    float b0,
+                    float b1,
+                    float b2,
+                    float a1,
+                    float a2)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if ((float_to_q14(b0, &self_p->b0) != 0)
+        || (float_to_q14(b1, &self_p->b1) != 0)
+        || (float_to_q14(b2, &self_p->b2) != 0)
+        || (float_to_q14(a1, &self_p->a1) != 0)
+        || (float_to_q14(a2, &self_p->a2) != 0)) {
+        return (-EINVAL);
+    }
+
+    self_p->x1 = 0;
+    self_p->x2 = 0;
+    self_p->y1 = 0;
+    self_p->y2 = 0;
+
+    return (0);
+}
+
+int dsp_biquad_filter(struct dsp_biquad_t *self_p,
+                      int16_t *dst_p,
+                      const int16_t *src_p,
+                      size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    int64_t sum;
+    int16_t x0;
+    int16_t x1;
+    int16_t x2;
+    int16_t y1;
+    int16_t y2;
+    size_t i;
+
+    x1 = self_p->x1;
+    x2 = self_p->x2;
+    y1 = self_p->y1;
+    y2 = self_p->y2;
+
+    /* Each output sample depends on the previous ones, so there is
+       nothing to vectorize. */
+    for (i = 0; i < length; i++) {
+        x0 = src_p[i];
+        sum = ((int32_t)self_p->b0 * x0);
+        sum += ((int32_t)self_p->b1 * x1);
+        sum += ((int32_t)self_p->b2 * x2);
+        sum -= ((int32_t)self_p->a1 * y1);
+        sum -= ((int32_t)self_p->a2 * y2);
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = saturate(sum >> 14);
+        dst_p[i] = y1;
+    }
+
+    self_p->x1 = x1;
+    self_p->x2 = x2;
+    self_p->y1 = y1;
+    self_p->y2 = y2;
+
+    return (0);
+}
+
+int dsp_resampler_init(struct dsp_resampler_t *self_p,
+                       int input_rate,
+                       int output_rate)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(input_rate > 0, EINVAL);
+    ASSERTN(output_rate > 0, EINVAL);
+
+    uint64_t step;
+
+    step = (((uint64_t)input_rate << 16) / output_rate);
+
+    if ((step == 0) || (step > 0xffffffffULL)) {
+        return (-EINVAL);
+    }
+
+    self_p->position = 0;
+    self_p->step = step;
+    self_p->previous = 0;
+
+    return (0);
+}
+
+ssize_t dsp_resampler_process(struct dsp_resampler_t *self_p,
+                              int16_t *dst_p,
+                              size_t size,
+                              const int16_t *src_p,
+                              size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    uint64_t position;
+    uint64_t end;
+    size_t index;
+    int32_t a;
+    int32_t b;
+    int32_t fraction;
+    size_t i;
+
+    if (length == 0) {
+        return (0);
+    }
+
+    position = self_p->position;
+    end = ((uint64_t)length << 16);
+
+    if (position < end) {
+        if (DIV_CEIL(end - position, self_p->step) > size) {
+            return (-ENOMEM);
+        }
+    }
+
+    /* Index zero(0) is the last sample of the previous input, and
+       index n is input sample n - 1. */
+    i = 0;
+
+    while (position < end) {
+        index = (position >> 16);
+
+        if (index == 0) {
+            a = self_p->previous;
+        } else {
+            a = src_p[index - 1];
+        }
+
+        b = src_p[index];
+        fraction = ((position & 0xffff) >> 1);
+        dst_p[i++] = (a + (((b - a) * fraction) >> 15));
+        position += self_p->step;
+    }
+
+    self_p->position = (position - end);
+    self_p->previous = src_p[length - 1];
+
+    return (i);
+}
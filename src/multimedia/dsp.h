@@ -0,0 +1,377 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __MULTIMEDIA_DSP_H__
+#define __MULTIMEDIA_DSP_H__
+
+#include "simba.h"
+
+/**
+ * Length of the state buffer of a FIR filter with given number of
+ * coefficients.
+ */
+#define DSP_FIR_STATE_LENGTH(length)                    \
+    (2 * (length) - 1 + CONFIG_DSP_BLOCK_SIZE)
+
+/**
+ * A wavetable oscillator. The phase is a 32 bits unsigned fraction of
+ * the wavetable period.
+ */
+struct dsp_oscillator_t {
+    uint32_t phase;
+    uint32_t increment;
+    int16_t gain;
+};
+
+/**
+ * A bank of oscillators playing the same wavetable.
+ */
+struct dsp_oscillator_bank_t {
+    const int16_t *wavetable_p;
+    int shift;
+    int sample_rate;
+    struct dsp_oscillator_t *oscillators_p;
+    int length;
+};
+
+/**
+ * An attack, decay, sustain and release envelope generator. The level
+ * is a Q15 gain in the upper 16 bits.
+ */
+struct dsp_envelope_t {
+    int phase;
+    int32_t level;
+    int32_t attack;
+    int32_t decay;
+    int32_t sustain;
+    int32_t release;
+};
+
+/**
+ * A finite impulse response filter.
+ */
+struct dsp_fir_t {
+    int16_t *coefficients_p;
+    int16_t *history_p;
+    int length;
+};
+
+/**
+ * A second order infinite impulse response filter, or biquad, in
+ * direct form I with Q14 coefficients.
+ */
+struct dsp_biquad_t {
+    int16_t b0;
+    int16_t b1;
+    int16_t b2;
+    int16_t a1;
+    int16_t a2;
+    int16_t x1;
+    int16_t x2;
+    int16_t y1;
+    int16_t y2;
+};
+
+/**
+ * A linear interpolation sample rate converter. The position and
+ * step are Q16 numbers of input samples.
+ */
+struct dsp_resampler_t {
+    uint32_t position;
+    uint32_t step;
+    int16_t previous;
+};
+
+/**
+ * Mix given source samples multiplied by given gain into given
+ * destination samples, saturating the result to 16 bits.
+ *
+ * @param[in,out] dst_p Samples to mix into.
+ * @param[in] src_p Samples to mix.
+ * @param[in] gain Q15 gain of the source samples.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_mix(int16_t *dst_p,
+            const int16_t *src_p,
+            int16_t gain,
+            size_t length);
+
+/**
+ * Multiply given samples by given gain, saturating the result to 16
+ * bits.
+ *
+ * @param[in,out] samples_p Samples.
+ * @param[in] gain Q15 gain.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_gain(int16_t *samples_p, int16_t gain, size_t length);
+
+/**
+ * Initialize given oscillator bank. All oscillators are silent after
+ * initialization.
+ *
+ * @param[out] self_p Oscillator bank to initialize.
+ * @param[in] wavetable_p One period of the waveform.
+ * @param[in] wavetable_length Number of samples in the waveform. Must
+ *                             be a power of two.
+ * @param[in] sample_rate Output sample rate in Hz.
+ * @param[in] oscillators_p Oscillators in the bank.
+ * @param[in] length Number of oscillators.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_oscillator_bank_init(struct dsp_oscillator_bank_t *self_p,
+                             const int16_t *wavetable_p,
+                             size_t wavetable_length,
+                             int sample_rate,
+                             struct dsp_oscillator_t *oscillators_p,
+                             int length);
+
+/**
+ * Set the frequency and gain of given oscillator in given bank. The
+ * phase is left unchanged to avoid clicks.
+ *
+ * @param[in] self_p Oscillator bank.
+ * @param[in] index Oscillator index.
+ * @param[in] frequency Frequency in Hz.
+ * @param[in] gain Q15 gain. Zero(0) silences the oscillator.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_oscillator_bank_set(struct dsp_oscillator_bank_t *self_p,
+                            int index,
+                            float frequency,
+                            int16_t gain);
+
+/**
+ * Render given number of samples of the sum of all oscillators in
+ * given bank. The sum is accumulated with 32 bits precision and
+ * saturated to 16 bits.
+ *
+ * @param[in] self_p Oscillator bank.
+ * @param[out] samples_p Rendered samples.
+ * @param[in] length Number of samples to render.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_oscillator_bank_render(struct dsp_oscillator_bank_t *self_p,
+                               int16_t *samples_p,
+                               size_t length);
+
+/**
+ * Render given number of samples of a single oscillator in given
+ * bank, for example to apply an envelope to it before it is mixed
+ * with other oscillators using `dsp_mix()`.
+ *
+ * @param[in] self_p Oscillator bank.
+ * @param[in] index Oscillator index.
+ * @param[out] samples_p Rendered samples.
+ * @param[in] length Number of samples to render.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_oscillator_bank_render_one(struct dsp_oscillator_bank_t *self_p,
+                                   int index,
+                                   int16_t *samples_p,
+                                   size_t length);
+
+/**
+ * Initialize given envelope generator. The envelope is idle until
+ * started.
+ *
+ * @param[out] self_p Envelope to initialize.
+ * @param[in] attack Attack time in samples.
+ * @param[in] decay Decay time in samples.
+ * @param[in] sustain Q15 sustain level.
+ * @param[in] release Release time in samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_envelope_init(struct dsp_envelope_t *self_p,
+                      size_t attack,
+                      size_t decay,
+                      int16_t sustain,
+                      size_t release);
+
+/**
+ * Start the attack phase of given envelope, from its current level.
+ *
+ * @param[in] self_p Envelope.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_envelope_start(struct dsp_envelope_t *self_p);
+
+/**
+ * Start the release phase of given envelope.
+ *
+ * @param[in] self_p Envelope.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_envelope_release(struct dsp_envelope_t *self_p);
+
+/**
+ * Apply given envelope to given samples. Samples after the end of
+ * the release phase are set to zero(0).
+ *
+ * @param[in] self_p Envelope.
+ * @param[in,out] samples_p Samples.
+ * @param[in] length Number of samples.
+ *
+ * @return Number of samples before the envelope became idle, that
+ *         is, length if the envelope is still active, or negative
+ *         error code.
+ */
+ssize_t dsp_envelope_apply(struct dsp_envelope_t *self_p,
+                           int16_t *samples_p,
+                           size_t length);
+
+/**
+ * Check if given envelope is active.
+ *
+ * @param[in] self_p Envelope.
+ *
+ * @return true(1) if the envelope is active, otherwise false(0).
+ */
+int dsp_envelope_is_active(struct dsp_envelope_t *self_p);
+
+/**
+ * Initialize given FIR filter. The sum of the absolute values of the
+ * coefficients must be less than 2.0.
+ *
+ * @param[out] self_p FIR filter to initialize.
+ * @param[in] coefficients_p Q15 filter coefficients, or impulse
+ *                           response.
+ * @param[in] length Number of coefficients.
+ * @param[in] state_p State buffer of
+ *                    ``DSP_FIR_STATE_LENGTH(length)`` samples.
+ * @param[in] state_length Number of samples in the state buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fir_init(struct dsp_fir_t *self_p,
+                 const int16_t *coefficients_p,
+                 int length,
+                 int16_t *state_p,
+                 size_t state_length);
+
+/**
+ * Filter given samples using given FIR filter.
+ *
+ * @param[in] self_p FIR filter.
+ * @param[out] dst_p Filtered samples. May be the same buffer as
+ *                   src_p.
+ * @param[in] src_p Samples to filter.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fir_filter(struct dsp_fir_t *self_p,
+                   int16_t *dst_p,
+                   const int16_t *src_p,
+                   size_t length);
+
+/**
+ * Initialize given biquad filter with given coefficients, normalized
+ * so that a0 is 1.0. The coefficients must be in the range -2.0 to
+ * 2.0.
+ *
+ * @param[out] self_p Biquad filter to initialize.
+ * @param[in] b0 Feed forward coefficient b0.
+ * @param[in] b1 Feed forward coefficient b1.
+ * @param[in] b2 Feed forward coefficient b2.
+ * @param[in] a1 Feedback coefficient a1.
+ * @param[in] a2 Feedback coefficient a2.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_biquad_init(struct dsp_biquad_t *self_p,
+                    float b0,
+                    float b1,
+                    float b2,
+                    float a1,
+                    float a2);
+
+/**
+ * Filter given samples using given biquad filter.
+ *
+ * @param[in] self_p Biquad filter.
+ * @param[out] dst_p Filtered samples. May be the same buffer as
+ *                   src_p.
+ * @param[in] src_p Samples to filter.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_biquad_filter(struct dsp_biquad_t *self_p,
+                      int16_t *dst_p,
+                      const int16_t *src_p,
+                      size_t length);
+
+/**
+ * Initialize given sample rate converter.
+ *
+ * @param[out] self_p Sample rate converter to initialize.
+ * @param[in] input_rate Input sample rate in Hz.
+ * @param[in] output_rate Output sample rate in Hz.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_resampler_init(struct dsp_resampler_t *self_p,
+                       int input_rate,
+                       int output_rate);
+
+/**
+ * Convert given input samples to the output sample rate. The output
+ * is delayed one input sample.
+ *
+ * @param[in] self_p Sample rate converter.
+ * @param[out] dst_p Output samples.
+ * @param[in] size Size of the output buffer in samples. Must be
+ *                 big enough for all output samples, that is, about
+ *                 ``length * output_rate / input_rate + 2`` samples.
+ * @param[in] src_p Input samples.
+ * @param[in] length Number of input samples.
+ *
+ * @return Number of output samples, or -ENOMEM if the output buffer
+ *         is too small, in which case no input samples are consumed.
+ */
+ssize_t dsp_resampler_process(struct dsp_resampler_t *self_p,
+                              int16_t *dst_p,
+                              size_t size,
+                              const int16_t *src_p,
+                              size_t length);
+
+#endif
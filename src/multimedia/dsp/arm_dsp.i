@@ -0,0 +1,162 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+/* The DSP extension instructions are written in inline assembly as
+   the ACLE intrinsics in arm_acle.h are only available in GCC 10 and
+   later. */
+
+static inline int32_t smulbb(int32_t a, int32_t b)
+{
+    int32_t res;
+
+    asm("smulbb %0, %1, %2" : "=r" (res) : "r" (a), "r" (b));
+
+    return (res);
+}
+
+static inline int32_t smultb(int32_t a, int32_t b)
+{
+    int32_t res;
+
+    asm("smultb %0, %1, %2" : "=r" (res) : "r" (a), "r" (b));
+
+    return (res);
+}
+
+/**
+ * Shift given value 15 bits to the right and saturate it to 16 bits.
+ */
+static inline int32_t ssat16_asr15(int32_t value)
+{
+    int32_t res;
+
+    asm("ssat %0, #16, %1, asr #15" : "=r" (res) : "r" (value));
+
+    return (res);
+}
+
+static inline int32_t qadd16(int32_t a, int32_t b)
+{
+    int32_t res;
+
+    asm("qadd16 %0, %1, %2" : "=r" (res) : "r" (a), "r" (b));
+
+    return (res);
+}
+
+static inline int32_t smlad(int32_t a, int32_t b, int32_t acc)
+{
+    int32_t res;
+
+    asm("smlad %0, %1, %2, %3"
+        : "=r" (res)
+        : "r" (a), "r" (b), "r" (acc));
+
+    return (res);
+}
+
+/* Two samples are packed into each 32 bits word. The words are
+   copied with memcpy() as the sample buffers are only 16 bits
+   aligned, which the Cortex-M4 and M7 handle in a single load or
+   store. */
+
+static inline int32_t load_pair(const int16_t *samples_p)
+{
+    int32_t pair;
+
+    memcpy(&pair, samples_p, sizeof(pair));
+
+    return (pair);
+}
+
+static inline void store_pair(int16_t *samples_p, int32_t pair)
+{
+    memcpy(samples_p, &pair, sizeof(pair));
+}
+
+/**
+ * Multiply both Q15 numbers in given pair by given gain, saturating
+ * the products to 16 bits.
+ */
+static inline int32_t mul_q15_pair(int32_t pair, int32_t gain)
+{
+    uint32_t low;
+    uint32_t high;
+
+    low = ssat16_asr15(smulbb(pair, gain));
+    high = ssat16_asr15(smultb(pair, gain));
+
+    return ((low & 0xffff) | (high << 16));
+}
+
+static void mix_port(int16_t *dst_p,
+                     const int16_t *src_p,
+                     int16_t gain,
+                     size_t length)
+{
+    size_t i;
+
+    for (i = 0; i + 2 <= length; i += 2) {
+        store_pair(&dst_p[i],
+                   qadd16(load_pair(&dst_p[i]),
+                          mul_q15_pair(load_pair(&src_p[i]), gain)));
+    }
+
+    mix_generic(&dst_p[i], &src_p[i], gain, length - i);
+}
+
+static void gain_port(int16_t *samples_p, int16_t gain, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i + 2 <= length; i += 2) {
+        store_pair(&samples_p[i],
+                   mul_q15_pair(load_pair(&samples_p[i]), gain));
+    }
+
+    gain_generic(&samples_p[i], gain, length - i);
+}
+
+/* The compiler uses the ssat instruction for the generic kernel. */
+#define saturate_port saturate_generic
+
+static int32_t dot_port(const int16_t *x_p, const int16_t *h_p, int length)
+{
+    int32_t sum;
+    int i;
+
+    sum = 0;
+
+    for (i = 0; i + 2 <= length; i += 2) {
+        sum = smlad(load_pair(&x_p[i]), load_pair(&h_p[i]), sum);
+    }
+
+    return (sum + dot_generic(&x_p[i], &h_p[i], length - i));
+}
@@ -0,0 +1,100 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include <arm_neon.h>
+
+static void mix_port(int16_t *dst_p,
+                     const int16_t *src_p,
+                     int16_t gain,
+                     size_t length)
+{
+    int16x8_t gains;
+    int16x8_t products;
+    size_t i;
+
+    gains = vdupq_n_s16(gain);
+
+    /* vqdmulh gives the saturated product shifted 15 bits, just as the
+       generic kernel. */
+    for (i = 0; i + 8 <= length; i += 8) {
+        products = vqdmulhq_s16(vld1q_s16(&src_p[i]), gains);
+        vst1q_s16(&dst_p[i], vqaddq_s16(vld1q_s16(&dst_p[i]), products));
+    }
+
+    mix_generic(&dst_p[i], &src_p[i], gain, length - i);
+}
+
+static void gain_port(int16_t *samples_p, int16_t gain, size_t length)
+{
+    int16x8_t gains;
+    size_t i;
+
+    gains = vdupq_n_s16(gain);
+
+    for (i = 0; i + 8 <= length; i += 8) {
+        vst1q_s16(&samples_p[i], vqdmulhq_s16(vld1q_s16(&samples_p[i]), gains));
+    }
+
+    gain_generic(&samples_p[i], gain, length - i);
+}
+
+static void saturate_port(int16_t *dst_p,
+                          const int32_t *src_p,
+                          size_t length)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= length; i += 8) {
+        vst1q_s16(&dst_p[i],
+                  vcombine_s16(vqmovn_s32(vld1q_s32(&src_p[i])),
+                               vqmovn_s32(vld1q_s32(&src_p[i + 4]))));
+    }
+
+    saturate_generic(&dst_p[i], &src_p[i], length - i);
+}
+
+static int32_t dot_port(const int16_t *x_p, const int16_t *h_p, int length)
+{
+    int32x4_t sums;
+    int32x2_t sum;
+    int i;
+
+    sums = vdupq_n_s32(0);
+
+    for (i = 0; i + 4 <= length; i += 4) {
+        sums = vmlal_s16(sums, vld1_s16(&x_p[i]), vld1_s16(&h_p[i]));
+    }
+
+    sum = vadd_s32(vget_low_s32(sums), vget_high_s32(sums));
+    sum = vpadd_s32(sum, sum);
+
+    return (vget_lane_s32(sum, 0)
+            + dot_generic(&x_p[i], &h_p[i], length - i));
+}
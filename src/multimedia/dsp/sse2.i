@@ -0,0 +1,122 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include <emmintrin.h>
+
+/**
+ * Multiply eight Q15 numbers, saturating the products to 16 bits.
+ */
+static inline __m128i mul_q15(__m128i a, __m128i b)
+{
+    __m128i low;
+    __m128i high;
+
+    low = _mm_mullo_epi16(a, b);
+    high = _mm_mulhi_epi16(a, b);
+
+    return (_mm_packs_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(low, high), 15),
+                            _mm_srai_epi32(_mm_unpackhi_epi16(low, high), 15)));
+}
+
+static void mix_port(int16_t *dst_p,
+                     const int16_t *src_p,
+                     int16_t gain,
+                     size_t length)
+{
+    __m128i gains;
+    __m128i products;
+    __m128i samples;
+    size_t i;
+
+    gains = _mm_set1_epi16(gain);
+
+    for (i = 0; i + 8 <= length; i += 8) {
+        products = mul_q15(_mm_loadu_si128((const __m128i *)&src_p[i]), gains);
+        samples = _mm_loadu_si128((const __m128i *)&dst_p[i]);
+        _mm_storeu_si128((__m128i *)&dst_p[i],
+                         _mm_adds_epi16(samples, products));
+    }
+
+    mix_generic(&dst_p[i], &src_p[i], gain, length - i);
+}
+
+static void gain_port(int16_t *samples_p, int16_t gain, size_t length)
+{
+    __m128i gains;
+    __m128i samples;
+    size_t i;
+
+    gains = _mm_set1_epi16(gain);
+
+    for (i = 0; i + 8 <= length; i += 8) {
+        samples = _mm_loadu_si128((const __m128i *)&samples_p[i]);
+        _mm_storeu_si128((__m128i *)&samples_p[i], mul_q15(samples, gains));
+    }
+
+    gain_generic(&samples_p[i], gain, length - i);
+}
+
+static void saturate_port(int16_t *dst_p,
+                          const int32_t *src_p,
+                          size_t length)
+{
+    __m128i low;
+    __m128i high;
+    size_t i;
+
+    for (i = 0; i + 8 <= length; i += 8) {
+        low = _mm_loadu_si128((const __m128i *)&src_p[i]);
+        high = _mm_loadu_si128((const __m128i *)&src_p[i + 4]);
+        _mm_storeu_si128((__m128i *)&dst_p[i], _mm_packs_epi32(low, high));
+    }
+
+    saturate_generic(&dst_p[i], &src_p[i], length - i);
+}
+
+static int32_t dot_port(const int16_t *x_p, const int16_t *h_p, int length)
+{
+    __m128i sums;
+    int i;
+
+    sums = _mm_setzero_si128();
+
+    for (i = 0; i + 8 <= length; i += 8) {
+        sums = _mm_add_epi32(
+            sums,
+            _mm_madd_epi16(_mm_loadu_si128((const __m128i *)&x_p[i]),
+                           _mm_loadu_si128((const __m128i *)&h_p[i])));
+    }
+
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, 0x4e));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, 0xb1));
+
+    return (_mm_cvtsi128_si32(sums)
+            + dot_generic(&x_p[i], &h_p[i], length - i));
+}
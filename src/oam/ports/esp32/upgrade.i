@@ -293,6 +293,23 @@ static int upgrade_port_application_is_valid(int quick)
     }
 }
 
+static int upgrade_port_application_read(void *dst_p,
+                                         size_t src,
+                                         size_t size)
+{
+    /* The upload overwrites the application, so it can not be used
+       as delta base. */
+    return (-1);
+}
+
+static int upgrade_port_start_programmer(void *buf_p,
+                                         size_t size,
+                                         void *stack_p,
+                                         size_t stack_size)
+{
+    return (-ENOSYS);
+}
+
 static int upgrade_port_binary_upload_begin()
 {
     application.partition_p = get_application_partition();
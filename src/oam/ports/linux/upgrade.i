@@ -28,12 +28,109 @@
  * This file is part of the Simba project.
  */
 
+#include <errno.h>
+
+/* The application is stored in a file, followed by its SHA1 and
+   size. An upload is programmed into an emulated flash device, and
+   copied to a slot file that replaces the application file once
+   verified. */
+#define UPGRADE_SLOT_FILENAME "upgrade_slot.bin"
+#define UPGRADE_APPLICATION_FILENAME "upgrade_application.bin"
+
 struct module_port_t {
     int stay_in_bootloader;
+    FILE *slot_p;
+    FILE *application_p;
+    struct flash_driver_t flash;
+    size_t offset;
+    struct {
+        struct flash_async_t flash;
+        struct flash_async_job_t jobs[4];
+        int started;
+    } programmer;
 };
 
 static struct module_port_t module_port;
 
+/**
+ * Read the SHA1 and size stored after the application.
+ */
+static int application_trailer_read(FILE *file_p,
+                                    uint8_t *sha1_p,
+                                    uint32_t *size_p)
+{
+    long file_size;
+
+    if (fseek(file_p, 0, SEEK_END) != 0) {
+        return (-1);
+    }
+
+    file_size = ftell(file_p);
+
+    if (file_size < (long)(20 + sizeof(*size_p))) {
+        return (-1);
+    }
+
+    if (fseek(file_p, file_size - 20 - sizeof(*size_p), SEEK_SET) != 0) {
+        return (-1);
+    }
+
+    if (fread(sha1_p, 20, 1, file_p) != 1) {
+        return (-1);
+    }
+
+    if (fread(size_p, sizeof(*size_p), 1, file_p) != 1) {
+        return (-1);
+    }
+
+    if (*size_p != file_size - 20 - sizeof(*size_p)) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+static int application_sha1(FILE *file_p, uint8_t *dst_p, size_t size)
+{
+    struct sha1_t sha1;
+    uint8_t buf[256];
+    size_t chunk_size;
+
+    if (fseek(file_p, 0, SEEK_SET) != 0) {
+        return (-1);
+    }
+
+    sha1_init(&sha1);
+
+    while (size > 0) {
+        chunk_size = MIN(size, sizeof(buf));
+
+        if (fread(&buf[0], chunk_size, 1, file_p) != 1) {
+            return (-1);
+        }
+
+        sha1_update(&sha1, &buf[0], chunk_size);
+        size -= chunk_size;
+    }
+
+    sha1_digest(&sha1, dst_p);
+
+    return (0);
+}
+
+static void files_close(void)
+{
+    if (module_port.slot_p != NULL) {
+        fclose(module_port.slot_p);
+        module_port.slot_p = NULL;
+    }
+
+    if (module_port.application_p != NULL) {
+        fclose(module_port.application_p);
+        module_port.application_p = NULL;
+    }
+}
+
 static int upgrade_port_bootloader_enter()
 {
     return (-1);
@@ -65,26 +162,262 @@ static int upgrade_port_application_enter()
 
 static int upgrade_port_application_erase()
 {
+    if ((remove(UPGRADE_APPLICATION_FILENAME) != 0) && (errno != ENOENT)) {
+        return (-1);
+    }
+
     return (0);
 }
 
-static int upgrade_port_application_is_valid()
+static int upgrade_port_application_is_valid(int quick)
 {
+    FILE *file_p;
+    uint8_t expected_sha1[20];
+    uint8_t sha1[20];
+    uint32_t size;
+    int res;
+
+    file_p = fopen(UPGRADE_APPLICATION_FILENAME, "rb");
+
+    if (file_p == NULL) {
+        return (0);
+    }
+
+    res = 0;
+
+    if (application_trailer_read(file_p, &expected_sha1[0], &size) == 0) {
+        if (quick == 1) {
+            res = 1;
+        } else if (application_sha1(file_p, &sha1[0], size) == 0) {
+            res = (memcmp(&sha1[0], &expected_sha1[0], sizeof(sha1)) == 0);
+        }
+    }
+
+    fclose(file_p);
+
+    return (res);
+}
+
+static int upgrade_port_application_read(void *dst_p,
+                                         size_t src,
+                                         size_t size)
+{
+    if (module_port.application_p == NULL) {
+        return (-1);
+    }
+
+    if (fseek(module_port.application_p, src, SEEK_SET) != 0) {
+        return (-1);
+    }
+
+    if (fread(dst_p, size, 1, module_port.application_p) != 1) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Copy given number of bytes of the programmed upload to the slot
+ * file.
+ */
+static int slot_write(size_t size)
+{
+    uint8_t buf[256];
+    size_t offset;
+    size_t chunk_size;
+
+    module_port.slot_p = fopen(UPGRADE_SLOT_FILENAME, "wb+");
+
+    if (module_port.slot_p == NULL) {
+        return (-1);
+    }
+
+    for (offset = 0; offset < size; offset += chunk_size) {
+        chunk_size = MIN(size - offset, sizeof(buf));
+
+        if (flash_read(&module_port.flash,
+                       &buf[0],
+                       offset,
+                       chunk_size) != chunk_size) {
+            return (-1);
+        }
+
+        if (fwrite(&buf[0], 1, chunk_size, module_port.slot_p)
+            != chunk_size) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+static int upgrade_port_start_programmer(void *buf_p,
+                                         size_t size,
+                                         void *stack_p,
+                                         size_t stack_size)
+{
+    int res;
+
+    if (module_port.programmer.started == 1) {
+        return (-EALREADY);
+    }
+
+    res = flash_async_init(&module_port.programmer.flash,
+                           &module_port.flash,
+                           &module_port.programmer.jobs[0],
+                           membersof(module_port.programmer.jobs),
+                           buf_p,
+                           size,
+                           stack_p,
+                           stack_size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = flash_async_start(&module_port.programmer.flash);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    module_port.programmer.started = 1;
+
     return (0);
 }
 
 static int upgrade_port_binary_upload_begin()
 {
+    /* Files are left open and data may still be programmed after a
+       failed upload. */
+    files_close();
+
+    if (module_port.programmer.started == 1) {
+        flash_async_sync(&module_port.programmer.flash);
+    }
+
+    if (flash_init(&module_port.flash,
+                   &flash_device[CONFIG_UPGRADE_FLASH_DEVICE_INDEX]) != 0) {
+        return (-1);
+    }
+
+    module_port.offset = 0;
+
+    /* The installed application is the base of delta uploads. */
+    module_port.application_p = fopen(UPGRADE_APPLICATION_FILENAME, "rb");
+
     return (0);
 }
 
 static int upgrade_port_binary_upload(const void *buf_p,
                                       size_t size)
 {
+    if (size > CONFIG_FLASH_LINUX_DEVICE_SIZE - module_port.offset) {
+        return (-1);
+    }
+
+    /* Erase the whole device before the first write. */
+    if (module_port.programmer.started == 1) {
+        if (module_port.offset == 0) {
+            flash_async_erase(&module_port.programmer.flash,
+                              0,
+                              CONFIG_FLASH_LINUX_DEVICE_SIZE);
+        }
+
+        if (flash_async_write(&module_port.programmer.flash,
+                              module_port.offset,
+                              buf_p,
+                              size) != size) {
+            return (-1);
+        }
+    } else {
+        if (module_port.offset == 0) {
+            if (flash_erase(&module_port.flash,
+                            0,
+                            CONFIG_FLASH_LINUX_DEVICE_SIZE) != 0) {
+                return (-1);
+            }
+        }
+
+        if (flash_write(&module_port.flash,
+                        module_port.offset,
+                        buf_p,
+                        size) != size) {
+            return (-1);
+        }
+    }
+
+    module_port.offset += size;
+
     return (0);
 }
 
 static int upgrade_port_binary_upload_end()
 {
+    uint8_t sha1[20];
+    int res;
+
+    /* Wait for all programming to complete. */
+    if (module_port.programmer.started == 1) {
+        if (flash_async_sync(&module_port.programmer.flash) != 0) {
+            files_close();
+
+            return (-1);
+        }
+    }
+
+    if (module_port.offset == 0) {
+        files_close();
+
+        return (0);
+    }
+
+    res = -1;
+
+    if (slot_write(module_port.offset) != 0) {
+        files_close();
+
+        return (-1);
+    }
+
+    /* Never replace the application with a bad upload. */
+    if (application_sha1(module_port.slot_p,
+                         &sha1[0],
+                         module.header.size) != 0) {
+        files_close();
+
+        return (-1);
+    }
+
+    if (memcmp(&sha1[0], &module.header.sha1[0], sizeof(sha1)) != 0) {
+        files_close();
+
+        return (-1);
+    }
+
+    if ((fseek(module_port.slot_p, module.header.size, SEEK_SET) == 0)
+        && (fwrite(&module.header.sha1[0],
+                   sizeof(module.header.sha1),
+                   1,
+                   module_port.slot_p) == 1)
+        && (fwrite(&module.header.size,
+                   sizeof(module.header.size),
+                   1,
+                   module_port.slot_p) == 1)
+        && (fflush(module_port.slot_p) == 0)) {
+        res = 0;
+    }
+
+    files_close();
+
+    if (res != 0) {
+        return (-1);
+    }
+
+    if (rename(UPGRADE_SLOT_FILENAME, UPGRADE_APPLICATION_FILENAME) != 0) {
+        return (-1);
+    }
+
     return (0);
 }
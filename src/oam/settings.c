@@ -30,8 +30,42 @@
 
 #include "simba.h"
 
+#if CONFIG_SETTINGS_CACHE == 1
+
+#define INDEX_MASK                  (CONFIG_SETTINGS_CACHE_INDEX_SIZE - 1)
+#define INDEX_NAME_MAX                                     40
+
+struct cache_t {
+    int8_t loaded;
+    struct mutex_t mutex;
+    /* Setting indexes in the settings array, hashed by name. -1 if
+       the slot is free. Only used if all settings fit in the
+       index. */
+    struct {
+        int8_t enabled;
+        int16_t slots[CONFIG_SETTINGS_CACHE_INDEX_SIZE];
+    } index;
+    /* Modified part of the shadow, not yet written to the non-volatile
+       memory. Empty if begin equals end. */
+    struct {
+        size_t begin;
+        size_t end;
+    } dirty;
+    struct {
+        struct timer_t timer;
+        struct sem_t sem;
+        struct thrd_t *thrd_p;
+    } committer;
+    uint8_t shadow[CONFIG_SETTINGS_AREA_SIZE];
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
+#if CONFIG_SETTINGS_CACHE == 1
+    struct cache_t cache;
+#endif
 #if CONFIG_SETTINGS_FS_COMMAND_LIST == 1
     struct fs_command_t cmd_list;
 #endif
@@ -54,6 +88,180 @@ const FAR struct setting_t settings[] __attribute__ ((weak)) = {
 const FAR uint8_t settings_default[CONFIG_SETTINGS_AREA_SIZE]
 __attribute__ ((weak)) = { 0xff, };
 
+#if CONFIG_SETTINGS_CACHE == 1
+
+static uint32_t hash_name(const char *name_p)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+
+    while (*name_p != '\0') {
+        hash ^= (uint8_t)*name_p++;
+        hash *= 16777619UL;
+    }
+
+    return (hash);
+}
+
+/**
+ * Add all settings to the name index, or leave it disabled if they do
+ * not fit.
+ */
+static void index_init(struct cache_t *cache_p)
+{
+    const FAR struct setting_t *setting_p;
+    char name[INDEX_NAME_MAX + 1];
+    int i;
+    int slot;
+
+    for (i = 0; i < membersof(cache_p->index.slots); i++) {
+        cache_p->index.slots[i] = -1;
+    }
+
+    setting_p = &settings[0];
+
+    for (i = 0; setting_p->name_p != NULL; i++, setting_p++) {
+        /* Keep at least one free slot to terminate the lookups. */
+        if (i == CONFIG_SETTINGS_CACHE_INDEX_SIZE - 1) {
+            return;
+        }
+
+        if (std_strlen(setting_p->name_p) > INDEX_NAME_MAX) {
+            return;
+        }
+
+        std_strcpy(&name[0], setting_p->name_p);
+        slot = (hash_name(&name[0]) & INDEX_MASK);
+
+        while (cache_p->index.slots[slot] != -1) {
+            slot = ((slot + 1) & INDEX_MASK);
+        }
+
+        cache_p->index.slots[slot] = i;
+    }
+
+    cache_p->index.enabled = 1;
+}
+
+static const FAR struct setting_t *index_find(struct cache_t *cache_p,
+                                              const char *name_p)
+{
+    const FAR struct setting_t *setting_p;
+    int slot;
+
+    slot = (hash_name(name_p) & INDEX_MASK);
+
+    while (cache_p->index.slots[slot] != -1) {
+        setting_p = &settings[cache_p->index.slots[slot]];
+
+        if (std_strcmp(name_p, setting_p->name_p) == 0) {
+            return (setting_p);
+        }
+
+        slot = ((slot + 1) & INDEX_MASK);
+    }
+
+    return (NULL);
+}
+
+/**
+ * Read the settings area into the shadow on first use, as the
+ * non-volatile memory may not be mounted when the module is
+ * initialized. Called with the cache mutex locked.
+ */
+static int cache_load(struct cache_t *cache_p)
+{
+    if (cache_p->loaded == 1) {
+        return (0);
+    }
+
+    if (nvm_read(&cache_p->shadow[0],
+                 0,
+                 sizeof(cache_p->shadow)) != sizeof(cache_p->shadow)) {
+        return (-EIO);
+    }
+
+    cache_p->loaded = 1;
+
+    return (0);
+}
+
+/**
+ * Write the dirty part of the shadow to the non-volatile memory.
+ * Called with the cache mutex locked.
+ */
+static int cache_commit(struct cache_t *cache_p)
+{
+    size_t begin;
+    size_t size;
+
+    begin = cache_p->dirty.begin;
+    size = (cache_p->dirty.end - begin);
+
+    if (size == 0) {
+        return (0);
+    }
+
+    if (nvm_write(begin, &cache_p->shadow[begin], size) != size) {
+        return (-EIO);
+    }
+
+    cache_p->dirty.begin = 0;
+    cache_p->dirty.end = 0;
+
+    return (0);
+}
+
+static void on_commit_timeout(void *arg_p)
+{
+    struct cache_t *cache_p;
+
+    cache_p = arg_p;
+    sem_give_isr(&cache_p->committer.sem, 1);
+}
+
+static void *committer_main(void *arg_p)
+{
+    struct cache_t *cache_p;
+
+    thrd_set_name("settings");
+
+    cache_p = arg_p;
+
+    while (1) {
+        sem_take(&cache_p->committer.sem, NULL);
+        settings_commit();
+    }
+
+    return (NULL);
+}
+
+#endif
+
+static const FAR struct setting_t *find_setting(const char *name_p)
+{
+    const FAR struct setting_t *setting_p;
+
+#if CONFIG_SETTINGS_CACHE == 1
+    if (module.cache.index.enabled == 1) {
+        return (index_find(&module.cache, name_p));
+    }
+#endif
+
+    setting_p = &settings[0];
+
+    while (setting_p->name_p != NULL) {
+        if (std_strcmp(name_p, setting_p->name_p) == 0) {
+            return (setting_p);
+        }
+
+        setting_p++;
+    }
+
+    return (NULL);
+}
+
 #if CONFIG_SETTINGS_FS_COMMAND_LIST == 1
 
 static int cmd_list_cb(int argc,
@@ -171,63 +379,58 @@ static int cmd_read_cb(int argc,
         return (-EINVAL);
     }
 
-    /* Find the setting in the settings array. */
-    setting_p = &settings[0];
+    setting_p = find_setting(argv[1]);
 
-    while (setting_p->name_p != NULL) {
-        if (std_strcmp(argv[1], setting_p->name_p) == 0) {
-            switch (setting_p->type) {
+    if (setting_p == NULL) {
+        std_fprintf(chout_p, OSTR("%s: setting not found\r\n"), argv[1]);
 
-            case setting_type_int32_t:
-                int32 = 0;
-                settings_read(&int32, setting_p->address, setting_p->size);
-                std_fprintf(chout_p, OSTR("%ld\r\n"), (long)int32);
-                break;
+        return (-EINVAL);
+    }
 
-            case setting_type_string_t:
-                for (i = 0; i < setting_p->size; i++) {
-                    buf[0] = '\0';
-                    settings_read(&buf[0], setting_p->address + i, 1);
+    switch (setting_p->type) {
 
-                    if (buf[0] == '\0') {
-                        break;
-                    }
+    case setting_type_int32_t:
+        int32 = 0;
+        settings_read(&int32, setting_p->address, setting_p->size);
+        std_fprintf(chout_p, OSTR("%ld\r\n"), (long)int32);
+        break;
 
-                    std_fprintf(chout_p, OSTR("%c"), buf[0]);
-                }
+    case setting_type_string_t:
+        for (i = 0; i < setting_p->size; i++) {
+            buf[0] = '\0';
+            settings_read(&buf[0], setting_p->address + i, 1);
 
-                std_fprintf(chout_p, OSTR("\r\n"));
+            if (buf[0] == '\0') {
                 break;
+            }
 
-#if CONFIG_SETTINGS_BLOB == 1
+            std_fprintf(chout_p, OSTR("%c"), buf[0]);
+        }
 
-            case setting_type_blob_t:
-                for (i = 0; i < setting_p->size; i++) {
-                    buf[0] = 0;
-                    settings_read(&buf[0], setting_p->address + i, 1);
-                    std_fprintf(chout_p, OSTR("%02x"), buf[0] & 0xff);
-                }
+        std_fprintf(chout_p, OSTR("\r\n"));
+        break;
 
-                std_fprintf(chout_p, OSTR("\r\n"));
-                break;
+#if CONFIG_SETTINGS_BLOB == 1
 
-#endif
+    case setting_type_blob_t:
+        for (i = 0; i < setting_p->size; i++) {
+            buf[0] = 0;
+            settings_read(&buf[0], setting_p->address + i, 1);
+            std_fprintf(chout_p, OSTR("%02x"), buf[0] & 0xff);
+        }
 
-            default:
-                std_fprintf(chout_p,
-                            OSTR("bad setting type %d\r\n"),
-                            setting_p->type);
-            }
+        std_fprintf(chout_p, OSTR("\r\n"));
+        break;
 
-            return (0);
-        }
+#endif
 
-        setting_p++;
+    default:
+        std_fprintf(chout_p,
+                    OSTR("bad setting type %d\r\n"),
+                    setting_p->type);
     }
 
-    std_fprintf(chout_p, OSTR("%s: setting not found\r\n"), argv[1]);
-
-    return (-EINVAL);
+    return (0);
 }
 
 #endif
@@ -255,101 +458,96 @@ static int cmd_write_cb(int argc,
         return (-EINVAL);
     }
 
-    /* Find the setting in the settings array. */
-    setting_p = &settings[0];
+    setting_p = find_setting(argv[1]);
 
-    while (setting_p->name_p != NULL) {
-        if (std_strcmp(argv[1], setting_p->name_p) == 0) {
-            switch (setting_p->type) {
+    if (setting_p == NULL) {
+        std_fprintf(chout_p, OSTR("%s: setting not found\r\n"), argv[1]);
 
-            case setting_type_int32_t:
-                if (std_strtol(argv[2], &value) == NULL) {
-                    return (-EINVAL);
-                }
+        return (-EINVAL);
+    }
 
-                /* Range check. */
-                if ((value > 2147483647) || (value < -2147483648)) {
-                    std_fprintf(chout_p,
-                                OSTR("%ld: value out of range\r\n"),
-                                value);
-                    return (-EINVAL);
-                }
+    switch (setting_p->type) {
 
-                int32 = (int32_t)value;
-                settings_write(setting_p->address, &int32, setting_p->size);
-                break;
+    case setting_type_int32_t:
+        if (std_strtol(argv[2], &value) == NULL) {
+            return (-EINVAL);
+        }
 
-            case setting_type_string_t:
-                /* Range check. */
-                if (strlen(argv[2]) >= setting_p->size) {
-                    std_fprintf(chout_p,
-                                OSTR("%s: string too long\r\n"),
-                                argv[2]);
-                    return (-EINVAL);
-                }
+        /* Range check. */
+        if ((value > 2147483647) || (value < -2147483648)) {
+            std_fprintf(chout_p,
+                        OSTR("%ld: value out of range\r\n"),
+                        value);
+            return (-EINVAL);
+        }
 
-                settings_write(setting_p->address, argv[2], setting_p->size);
-                break;
+        int32 = (int32_t)value;
+        settings_write(setting_p->address, &int32, setting_p->size);
+        break;
 
-#if CONFIG_SETTINGS_BLOB == 1
+    case setting_type_string_t:
+        /* Range check. */
+        if (strlen(argv[2]) >= setting_p->size) {
+            std_fprintf(chout_p,
+                        OSTR("%s: string too long\r\n"),
+                        argv[2]);
+            return (-EINVAL);
+        }
 
-            case setting_type_blob_t:
-                /* Range check. */
-                size = DIV_CEIL(strlen(argv[2]), 2);
+        settings_write(setting_p->address, argv[2], setting_p->size);
+        break;
 
-                if (size != setting_p->size) {
-                    std_fprintf(chout_p,
-                                OSTR("%u: bad blob data length\r\n"),
-                                size);
-                    return (-EINVAL);
-                }
+#if CONFIG_SETTINGS_BLOB == 1
 
-                /* For odd number of bytes the check will fail since
-                   the null termination is not a hexadecimal digit. */
-                for (i = 0; i < 2 * size; i += 2) {
-                    if (!(isxdigit((int)argv[2][i])
-                          && isxdigit((int)argv[2][i + 1]))) {
-                        std_fprintf(chout_p,
-                                    OSTR("%s: bad blob data\r\n"),
-                                    argv[2]);
-                        return (-EINVAL);
-                    }
-                }
+    case setting_type_blob_t:
+        /* Range check. */
+        size = DIV_CEIL(strlen(argv[2]), 2);
 
-                /* For std_strtol(). */
-                buf[0] = '0';
-                buf[1] = 'x';
-                buf[4] = '\0';
+        if (size != setting_p->size) {
+            std_fprintf(chout_p,
+                        OSTR("%u: bad blob data length\r\n"),
+                        size);
+            return (-EINVAL);
+        }
 
-                /* argv pointers shall not be const in the furute. */
-                buf_p = (char *)argv[2];
+        /* For odd number of bytes the check will fail since the null
+           termination is not a hexadecimal digit. */
+        for (i = 0; i < 2 * size; i += 2) {
+            if (!(isxdigit((int)argv[2][i])
+                  && isxdigit((int)argv[2][i + 1]))) {
+                std_fprintf(chout_p,
+                            OSTR("%s: bad blob data\r\n"),
+                            argv[2]);
+                return (-EINVAL);
+            }
+        }
 
-                for (i = 0; i < size; i++) {
-                    memcpy(&buf[2], &argv[2][2 * i], 2);
-                    (void)std_strtol(&buf[0], &value);
-                    *buf_p++ = value;
-                }
+        /* For std_strtol(). */
+        buf[0] = '0';
+        buf[1] = 'x';
+        buf[4] = '\0';
 
-                settings_write(setting_p->address, argv[2], size);
-                break;
+        /* argv pointers shall not be const in the furute. */
+        buf_p = (char *)argv[2];
 
-#endif
+        for (i = 0; i < size; i++) {
+            memcpy(&buf[2], &argv[2][2 * i], 2);
+            (void)std_strtol(&buf[0], &value);
+            *buf_p++ = value;
+        }
 
-            default:
-                std_fprintf(chout_p,
-                            OSTR("bad setting type %d\r\n"),
-                            setting_p->type);
-            }
+        settings_write(setting_p->address, argv[2], size);
+        break;
 
-            return (0);
-        }
+#endif
 
-        setting_p++;
+    default:
+        std_fprintf(chout_p,
+                    OSTR("bad setting type %d\r\n"),
+                    setting_p->type);
     }
 
-    std_fprintf(chout_p, OSTR("%s: setting not found\r\n"), argv[1]);
-
-    return (-EINVAL);
+    return (0);
 }
 
 #endif
@@ -395,15 +593,86 @@ int settings_module_init(void)
     fs_command_register(&module.cmd_write);
 #endif
 
+#if CONFIG_SETTINGS_CACHE == 1
+    struct time_t timeout;
+
+    mutex_init(&module.cache.mutex);
+    index_init(&module.cache);
+    timeout.seconds = (CONFIG_SETTINGS_CACHE_COMMIT_DELAY_MS / 1000);
+    timeout.nanoseconds =
+        ((CONFIG_SETTINGS_CACHE_COMMIT_DELAY_MS % 1000) * 1000000);
+    timer_init(&module.cache.committer.timer,
+               &timeout,
+               on_commit_timeout,
+               &module.cache,
+               0);
+    sem_init(&module.cache.committer.sem, 1, 1);
+#endif
+
     return (nvm_module_init());
 }
 
+int settings_start_committer(void *stack_p, size_t stack_size)
+{
+    ASSERTN(stack_p != NULL, EINVAL);
+
+#if CONFIG_SETTINGS_CACHE == 1
+    module.cache.committer.thrd_p = thrd_spawn(committer_main,
+                                               &module.cache,
+                                               0,
+                                               stack_p,
+                                               stack_size);
+
+    return (module.cache.committer.thrd_p != NULL ? 0 : -1);
+#else
+    return (0);
+#endif
+}
+
+int settings_commit(void)
+{
+#if CONFIG_SETTINGS_CACHE == 1
+    int res;
+
+    mutex_lock(&module.cache.mutex);
+    res = cache_commit(&module.cache);
+    mutex_unlock(&module.cache.mutex);
+
+    return (res);
+#else
+    return (0);
+#endif
+}
+
 ssize_t settings_read(void *dst_p, size_t src, size_t size)
 {
     ASSERTN(dst_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+#if CONFIG_SETTINGS_CACHE == 1
+    struct cache_t *cache_p;
+    ssize_t res;
+
+    if ((src > CONFIG_SETTINGS_AREA_SIZE)
+        || (size > CONFIG_SETTINGS_AREA_SIZE - src)) {
+        return (-EINVAL);
+    }
+
+    cache_p = &module.cache;
+    mutex_lock(&cache_p->mutex);
+    res = cache_load(cache_p);
+
+    if (res == 0) {
+        memcpy(dst_p, &cache_p->shadow[src], size);
+        res = size;
+    }
+
+    mutex_unlock(&cache_p->mutex);
+
+    return (res);
+#else
     return (nvm_read(dst_p, src, size));
+#endif
 }
 
 ssize_t settings_write(size_t dst, const void *src_p, size_t size)
@@ -411,7 +680,46 @@ ssize_t settings_write(size_t dst, const void *src_p, size_t size)
     ASSERTN(src_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+#if CONFIG_SETTINGS_CACHE == 1
+    struct cache_t *cache_p;
+    ssize_t res;
+
+    if ((dst > CONFIG_SETTINGS_AREA_SIZE)
+        || (size > CONFIG_SETTINGS_AREA_SIZE - dst)) {
+        return (-EINVAL);
+    }
+
+    cache_p = &module.cache;
+    mutex_lock(&cache_p->mutex);
+    res = cache_load(cache_p);
+
+    if (res == 0) {
+        memcpy(&cache_p->shadow[dst], src_p, size);
+
+        /* Merge with the dirty range. */
+        if (cache_p->dirty.begin == cache_p->dirty.end) {
+            cache_p->dirty.begin = dst;
+            cache_p->dirty.end = (dst + size);
+        } else {
+            cache_p->dirty.begin = MIN(cache_p->dirty.begin, dst);
+            cache_p->dirty.end = MAX(cache_p->dirty.end, dst + size);
+        }
+
+        /* Restart the commit delay. */
+        if (cache_p->committer.thrd_p != NULL) {
+            timer_stop(&cache_p->committer.timer);
+            timer_start(&cache_p->committer.timer);
+        }
+
+        res = size;
+    }
+
+    mutex_unlock(&cache_p->mutex);
+
+    return (res);
+#else
     return (nvm_write(dst, src_p, size));
+#endif
 }
 
 ssize_t settings_read_by_name(const char *name_p,
@@ -424,22 +732,13 @@ ssize_t settings_read_by_name(const char *name_p,
 
     const FAR struct setting_t *setting_p;
 
-    /* Find the setting in the settings array. */
-    setting_p = &settings[0];
-
-    while (setting_p->name_p != NULL) {
-        if (std_strcmp(name_p, setting_p->name_p) == 0) {
-            if (size > setting_p->size) {
-                return (-1);
-            }
-
-            return (settings_read(dst_p, setting_p->address, size));
-        }
+    setting_p = find_setting(name_p);
 
-        setting_p++;
+    if ((setting_p == NULL) || (size > setting_p->size)) {
+        return (-1);
     }
 
-    return (-1);
+    return (settings_read(dst_p, setting_p->address, size));
 }
 
 ssize_t settings_write_by_name(const char *name_p,
@@ -452,26 +751,38 @@ ssize_t settings_write_by_name(const char *name_p,
 
     const FAR struct setting_t *setting_p;
 
-    /* Find the setting in the settings array. */
-    setting_p = &settings[0];
+    setting_p = find_setting(name_p);
 
-    while (setting_p->name_p != NULL) {
-        if (std_strcmp(name_p, setting_p->name_p) == 0) {
-            if (size > setting_p->size) {
-                return (-1);
-            }
-
-            return (settings_write(setting_p->address, src_p, size));
-        }
-
-        setting_p++;
+    if ((setting_p == NULL) || (size > setting_p->size)) {
+        return (-1);
     }
 
-    return (-1);
+    return (settings_write(setting_p->address, src_p, size));
 }
 
 int settings_reset()
 {
+#if CONFIG_SETTINGS_CACHE == 1
+    struct cache_t *cache_p;
+    size_t i;
+    int res;
+
+    cache_p = &module.cache;
+    mutex_lock(&cache_p->mutex);
+
+    /* Replace the shadow and write all of it at once. */
+    for (i = 0; i < sizeof(cache_p->shadow); i++) {
+        cache_p->shadow[i] = settings_default[i];
+    }
+
+    cache_p->loaded = 1;
+    cache_p->dirty.begin = 0;
+    cache_p->dirty.end = sizeof(cache_p->shadow);
+    res = cache_commit(cache_p);
+    mutex_unlock(&cache_p->mutex);
+
+    return (res);
+#else
     size_t i;
     size_t size;
     size_t offset;
@@ -501,4 +812,5 @@ int settings_reset()
     }
 
     return (0);
+#endif
 }
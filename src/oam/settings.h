@@ -62,6 +62,19 @@ struct setting_t {
  */
 int settings_module_init(void);
 
+/**
+ * Start a thread that writes modified settings to the non-volatile
+ * memory ``CONFIG_SETTINGS_CACHE_COMMIT_DELAY_MS`` milliseconds after
+ * the latest write. Only used if ``CONFIG_SETTINGS_CACHE`` is 1,
+ * otherwise all writes are written immediately.
+ *
+ * @param[in] stack_p Committer thread stack.
+ * @param[in] stack_size Committer thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int settings_start_committer(void *stack_p, size_t stack_size);
+
 /**
  * Read the value of given setting by address.
  *
@@ -110,6 +123,15 @@ ssize_t settings_write_by_name(const char *name_p,
                                const void *src_p,
                                size_t size);
 
+/**
+ * Write all modified settings to the non-volatile memory in a single
+ * write. Only needed if ``CONFIG_SETTINGS_CACHE`` is 1, otherwise all
+ * writes are written immediately.
+ *
+ * @return zero(0) or negative error code.
+ */
+int settings_commit(void);
+
 /**
  * Overwrite all settings with their default values.
  *
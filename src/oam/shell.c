@@ -96,6 +96,26 @@ static int is_shell_command(const char *line_p)
             || shell_command_compare(line_p, FSTR("help"), 4));
 }
 
+/**
+ * Read one character from the input channel through the reader.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int read_char(struct shell_t *self_p, char *c_p)
+{
+    int res;
+
+    res = chan_reader_getc(&self_p->reader);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    *c_p = res;
+
+    return (0);
+}
+
 /**
  * Unused command callback. Logout handling in shell_main().
  */
@@ -479,7 +499,7 @@ static int read_line(struct shell_t *self_p,
     self_p->newline_received = 0;
 
     while (self_p->newline_received == 0) {
-        if (chan_read(self_p->chin_p, &c, sizeof(c)) != sizeof(c)) {
+        if (read_char(self_p, &c) != 0) {
             return (-EIO);
         }
 
@@ -753,7 +773,7 @@ static int handle_ctrl_r(struct shell_t *self_p)
                      "\x1b[3D"));
 
     while (1) {
-        if (chan_read(self_p->chin_p, &c, sizeof(c)) != sizeof(c)) {
+        if (read_char(self_p, &c) != 0) {
             return (-EIO);
         }
 
@@ -821,16 +841,12 @@ static int handle_ctrl_r(struct shell_t *self_p)
                     self_p->newline_received = 1;
                 } else {
                     if (c == ALT) {
-                        if (chan_read(self_p->chin_p,
-                                      &c,
-                                      sizeof(c)) != sizeof(c)) {
+                        if (read_char(self_p, &c) != 0) {
                             return (-EIO);
                         }
 
                         if (c != 'd') {
-                            if (chan_read(self_p->chin_p,
-                                          &c,
-                                          sizeof(c)) != sizeof(c)) {
+                            if (read_char(self_p, &c) != 0) {
                                 return (-EIO);
                             }
                         }
@@ -852,7 +868,7 @@ static int handle_alt(struct shell_t *self_p)
 {
     char c, *buf_p;
 
-    if (chan_read(self_p->chin_p, &c, sizeof(c)) != sizeof(c)) {
+    if (read_char(self_p, &c) != 0) {
         return (-EIO);
     }
 
@@ -871,9 +887,7 @@ static int handle_alt(struct shell_t *self_p)
         break;
 
     case 'O':
-        if (chan_read(self_p->chin_p,
-                      &c,
-                      sizeof(c)) != sizeof(c)) {
+        if (read_char(self_p, &c) != 0) {
             return (-EIO);
         }
 
@@ -895,9 +909,7 @@ static int handle_alt(struct shell_t *self_p)
         break;
 
     case '[':
-        if (chan_read(self_p->chin_p,
-                      &c,
-                      sizeof(c)) != sizeof(c)) {
+        if (read_char(self_p, &c) != 0) {
             return (-EIO);
         }
 
@@ -1075,7 +1087,7 @@ static int read_command(struct shell_t *self_p)
     self_p->newline_received = 0;
 
     while (1) {
-        if (chan_read(self_p->chin_p, &c, sizeof(c)) != sizeof(c)) {
+        if (read_char(self_p, &c) != 0) {
             return (-EIO);
         }
 
@@ -1198,6 +1210,10 @@ int shell_init(struct shell_t *self_p,
     self_p->chin_p = chin_p;
     self_p->chout_p = chout_p;
     self_p->arg_p = arg_p;
+    chan_reader_init(&self_p->reader,
+                     chin_p,
+                     &self_p->reader_buf[0],
+                     sizeof(self_p->reader_buf));
     self_p->name_p = name_p;
     self_p->username_p = username_p;
     self_p->password_p = password_p;
@@ -1252,13 +1268,13 @@ void *shell_main(void *arg_p)
                 /* Just print a prompt. */
             } else if (is_shell_command(stripped_line_p) == 1) {
                 (void)fs_call(stripped_line_p,
-                              self_p->chin_p,
+                              &self_p->reader,
                               self_p->chout_p,
                               self_p);
                 continue;
             } else {
                 res = fs_call(stripped_line_p,
-                              self_p->chin_p,
+                              &self_p->reader,
                               self_p->chout_p,
                               self_p->arg_p);
 
@@ -57,6 +57,8 @@ struct shell_t {
     int carriage_return_received;
     int newline_received;
     int authorized;
+    struct chan_reader_t reader;
+    char reader_buf[CONFIG_SHELL_READER_BUFFER_SIZE];
 
 #if CONFIG_SHELL_MINIMAL == 0
 
@@ -30,9 +30,30 @@
 
 #include "simba.h"
 
+/* LZ decoder states. */
+#define LZ_STATE_TOKEN                                      0
+#define LZ_STATE_MATCH                                      1
+
+#define LZ_MIN_MATCH                                        3
+
+/* Delta operations. */
+#define DELTA_OP_COPY                                       0
+#define DELTA_OP_ADD                                        1
+#define DELTA_OP_INSERT                                     2
+#define DELTA_OP_SEEK                                       3
+
+/* Delta decoder states. */
+#define DELTA_STATE_OP                                      0
+#define DELTA_STATE_VALUE                                   1
+#define DELTA_STATE_DATA                                    2
+
 struct upgrade_binary_header_t {
     uint32_t size;
     uint8_t sha1[20];
+    uint8_t encoding;
+    uint8_t window_bits;
+    uint32_t base_size;
+    uint8_t base_sha1[20];
     char description[128];
 };
 
@@ -41,7 +62,27 @@ struct module_t {
     uint8_t buf[256];
     ssize_t header_size;
     size_t offset;
+    int8_t failed;
     struct upgrade_binary_header_t header;
+    struct sha1_t sha1;
+    uint32_t decoded_size;
+#if CONFIG_UPGRADE_LZ_WINDOW_BITS > 0
+    struct {
+        uint8_t window[1 << CONFIG_UPGRADE_LZ_WINDOW_BITS];
+        size_t pos;
+        int8_t state;
+        uint8_t flags;
+        uint8_t flags_left;
+        uint8_t match_high;
+    } lz;
+#endif
+    struct {
+        int8_t state;
+        uint8_t op;
+        uint8_t shift;
+        uint32_t value;
+        uint32_t offset;
+    } delta;
 #if CONFIG_UPGRADE_FS_COMMAND_BOOTLOADER_ENTER == 1
     struct fs_command_t cmd_bootloader_enter;
 #endif
@@ -60,42 +101,593 @@ static struct module_t module;
 
 #include "upgrade.i"
 
+static uint32_t read_u32(const uint8_t *src_p)
+{
+    return (((uint32_t)src_p[0] << 24)
+            | ((uint32_t)src_p[1] << 16)
+            | ((uint32_t)src_p[2] << 8)
+            | src_p[3]);
+}
+
 static int binary_header_parse(struct upgrade_binary_header_t *header_p,
                                uint8_t *src_p,
                                size_t size)
 {
     uint32_t version;
     uint32_t crc;
+    size_t description_offset;
 
-    version = ((src_p[0] << 24)
-               | (src_p[1] << 16)
-               | (src_p[2] << 8)
-               | src_p[3]);
+    version = read_u32(&src_p[0]);
+
+    if (version == 1) {
+        description_offset = 32;
+    } else if (version == 2) {
+        description_offset = 60;
+    } else {
+        return (-1);
+    }
 
-    if (version != 1) {
+    if (size < description_offset + 8) {
         return (-1);
     }
 
-    crc = ((src_p[size - 4] << 24)
-           | (src_p[size - 3] << 16)
-           | (src_p[size - 2] << 8)
-           | src_p[size - 1]);
+    crc = read_u32(&src_p[size - 4]);
 
     if (crc_32(0, src_p, size - 4) != crc) {
         return (-1);
     }
 
-    header_p->size = ((src_p[8] << 24)
-                      | (src_p[9] << 16)
-                      | (src_p[10] << 8)
-                      | src_p[11]);
+    header_p->size = read_u32(&src_p[8]);
     memcpy(&header_p->sha1[0], &src_p[12], sizeof(header_p->sha1));
 
-    if (strlen((char *)&src_p[32]) >= sizeof(header_p->description)) {
+    if (version == 1) {
+        header_p->encoding = UPGRADE_BINARY_ENCODING_RAW;
+        header_p->window_bits = 0;
+        header_p->base_size = 0;
+    } else {
+        header_p->encoding = src_p[32];
+        header_p->window_bits = src_p[33];
+        header_p->base_size = read_u32(&src_p[36]);
+        memcpy(&header_p->base_sha1[0],
+               &src_p[40],
+               sizeof(header_p->base_sha1));
+    }
+
+    if (strlen((char *)&src_p[description_offset])
+        >= sizeof(header_p->description)) {
+        return (-1);
+    }
+
+    strcpy(&header_p->description[0], (char *)&src_p[description_offset]);
+
+    return (0);
+}
+
+/**
+ * Returns zero(0) if this build can decode given encoding.
+ */
+static int binary_header_check_encoding(
+    struct upgrade_binary_header_t *header_p)
+{
+    if ((header_p->encoding & ~(UPGRADE_BINARY_ENCODING_LZ
+                                | UPGRADE_BINARY_ENCODING_DELTA)) != 0) {
+        return (-1);
+    }
+
+    if (header_p->encoding & UPGRADE_BINARY_ENCODING_LZ) {
+        if ((header_p->window_bits < 8)
+            || (header_p->window_bits > CONFIG_UPGRADE_LZ_WINDOW_BITS)) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Hash decoded data and write it to the application area.
+ */
+static int output_write(const void *buf_p, size_t size)
+{
+    if (size > module.header.size - module.decoded_size) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("decoded upgrade data bigger than %u bytes\r\n"),
+                         module.header.size);
+        return (-1);
+    }
+
+    sha1_update(&module.sha1, (void *)buf_p, size);
+    module.decoded_size += size;
+
+    return (upgrade_port_binary_upload(buf_p, size));
+}
+
+/**
+ * Write all buffered decoded data.
+ */
+static int output_flush(void)
+{
+    int res;
+
+    if (module.offset == 0) {
+        return (0);
+    }
+
+    res = output_write(&module.buf[0], module.offset);
+    module.offset = 0;
+
+    return (res);
+}
+
+/**
+ * Get free space in the output buffer, writing buffered data if it
+ * is full. Commit used space by increasing `module.offset`.
+ */
+static int output_reserve(uint8_t **buf_pp, size_t *size_p)
+{
+    if (module.offset == sizeof(module.buf)) {
+        if (output_flush() != 0) {
+            return (-1);
+        }
+    }
+
+    *buf_pp = &module.buf[module.offset];
+    *size_p = (sizeof(module.buf) - module.offset);
+
+    return (0);
+}
+
+#if CONFIG_UPGRADE_LZ_WINDOW_BITS > 0
+
+static int output_append(const uint8_t *buf_p, size_t size)
+{
+    uint8_t *dst_p;
+    size_t chunk_size;
+
+    while (size > 0) {
+        if (output_reserve(&dst_p, &chunk_size) != 0) {
+            return (-1);
+        }
+
+        chunk_size = MIN(chunk_size, size);
+        memcpy(dst_p, buf_p, chunk_size);
+        module.offset += chunk_size;
+        buf_p += chunk_size;
+        size -= chunk_size;
+    }
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Read from the delta base at the current base offset.
+ */
+static int base_read(uint8_t *dst_p, size_t size)
+{
+    if (size > module.header.base_size - module.delta.offset) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade delta outside base\r\n"));
+        return (-1);
+    }
+
+    if (upgrade_port_application_read(dst_p,
+                                      module.delta.offset,
+                                      size) != 0) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("failed to read upgrade delta base\r\n"));
+        return (-1);
+    }
+
+    module.delta.offset += size;
+
+    return (0);
+}
+
+/**
+ * Verify that the installed application is the base the delta was
+ * created against.
+ */
+static int base_verify(void)
+{
+    size_t chunk_size;
+    uint8_t sha1[20];
+
+    sha1_init(&module.sha1);
+    module.delta.offset = 0;
+
+    while (module.delta.offset < module.header.base_size) {
+        chunk_size = MIN(sizeof(module.buf),
+                         module.header.base_size - module.delta.offset);
+
+        if (base_read(&module.buf[0], chunk_size) != 0) {
+            return (-1);
+        }
+
+        sha1_update(&module.sha1, &module.buf[0], chunk_size);
+    }
+
+    sha1_digest(&module.sha1, &sha1[0]);
+    module.delta.offset = 0;
+
+    if (memcmp(&sha1[0],
+               &module.header.base_sha1[0],
+               sizeof(sha1)) != 0) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("installed application is not the upgrade "
+                              "delta base\r\n"));
+        return (-1);
+    }
+
+    return (0);
+}
+
+static int delta_copy(void)
+{
+    uint8_t *dst_p;
+    size_t size;
+
+    while (module.delta.value > 0) {
+        if (output_reserve(&dst_p, &size) != 0) {
+            return (-1);
+        }
+
+        size = MIN(size, module.delta.value);
+
+        if (base_read(dst_p, size) != 0) {
+            return (-1);
+        }
+
+        module.offset += size;
+        module.delta.value -= size;
+    }
+
+    return (0);
+}
+
+static int delta_seek(void)
+{
+    int32_t distance;
+
+    /* Zigzag decode. */
+    distance = ((module.delta.value >> 1)
+                ^ -(int32_t)(module.delta.value & 1));
+
+    if ((distance < -(int32_t)module.delta.offset)
+        || (distance > (int32_t)(module.header.base_size
+                                 - module.delta.offset))) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade delta seek outside base\r\n"));
         return (-1);
     }
 
-    strcpy(&header_p->description[0], (char *)&src_p[32]);
+    module.delta.offset += distance;
+
+    return (0);
+}
+
+/**
+ * Execute current operation once its argument is decoded.
+ */
+static int delta_op_execute(void)
+{
+    int res;
+
+    res = 0;
+    module.delta.state = DELTA_STATE_OP;
+
+    switch (module.delta.op) {
+
+    case DELTA_OP_COPY:
+        res = delta_copy();
+        break;
+
+    case DELTA_OP_SEEK:
+        res = delta_seek();
+        break;
+
+    default:
+        if (module.delta.value > 0) {
+            module.delta.state = DELTA_STATE_DATA;
+        }
+
+        break;
+    }
+
+    return (res);
+}
+
+/**
+ * Copy inserted data or add data to the base.
+ */
+static ssize_t delta_data(const uint8_t *buf_p, size_t size)
+{
+    uint8_t *dst_p;
+    size_t chunk_size;
+    size_t i;
+
+    if (output_reserve(&dst_p, &chunk_size) != 0) {
+        return (-1);
+    }
+
+    chunk_size = MIN(chunk_size, MIN(size, module.delta.value));
+
+    if (module.delta.op == DELTA_OP_ADD) {
+        if (base_read(dst_p, chunk_size) != 0) {
+            return (-1);
+        }
+
+        for (i = 0; i < chunk_size; i++) {
+            dst_p[i] += buf_p[i];
+        }
+    } else {
+        memcpy(dst_p, buf_p, chunk_size);
+    }
+
+    module.offset += chunk_size;
+    module.delta.value -= chunk_size;
+
+    if (module.delta.value == 0) {
+        module.delta.state = DELTA_STATE_OP;
+    }
+
+    return (chunk_size);
+}
+
+/**
+ * Decode a stream of delta operations. Each operation is an operation
+ * byte followed by a varint argument, and, for add and insert, the
+ * data.
+ */
+static int delta_decode(const uint8_t *buf_p, size_t size)
+{
+    ssize_t res;
+    uint8_t byte;
+
+    while (size > 0) {
+        if (module.delta.state == DELTA_STATE_DATA) {
+            res = delta_data(buf_p, size);
+
+            if (res < 0) {
+                return (-1);
+            }
+
+            buf_p += res;
+            size -= res;
+            continue;
+        }
+
+        byte = *buf_p++;
+        size--;
+
+        if (module.delta.state == DELTA_STATE_OP) {
+            if (byte > DELTA_OP_SEEK) {
+                log_object_print(NULL,
+                                 LOG_ERROR,
+                                 OSTR("bad upgrade delta operation %u\r\n"),
+                                 byte);
+                return (-1);
+            }
+
+            module.delta.op = byte;
+            module.delta.value = 0;
+            module.delta.shift = 0;
+            module.delta.state = DELTA_STATE_VALUE;
+        } else {
+            if (module.delta.shift > 28) {
+                return (-1);
+            }
+
+            module.delta.value |= ((uint32_t)(byte & 0x7f)
+                                   << module.delta.shift);
+            module.delta.shift += 7;
+
+            if ((byte & 0x80) == 0) {
+                if (delta_op_execute() != 0) {
+                    return (-1);
+                }
+            }
+        }
+    }
+
+    return (0);
+}
+
+#if CONFIG_UPGRADE_LZ_WINDOW_BITS > 0
+
+/**
+ * Pass LZ decoded data to the next stage.
+ */
+static int lz_output(const uint8_t *buf_p, size_t size)
+{
+    if (module.header.encoding & UPGRADE_BINARY_ENCODING_DELTA) {
+        return (delta_decode(buf_p, size));
+    } else {
+        return (output_append(buf_p, size));
+    }
+}
+
+/**
+ * Decode a LZSS stream. Eight tokens are preceeded by a flags byte,
+ * least significant bit first. A set bit is a literal byte and a
+ * cleared bit a big endian 16 bits match, with the distance minus one
+ * in the upper window bits and the length minus three in the lower
+ * bits.
+ */
+static int lz_decode(const uint8_t *buf_p, size_t size)
+{
+    uint8_t decoded[32];
+    size_t decoded_size;
+    size_t window_mask;
+    size_t length_bits;
+    uint16_t value;
+    size_t distance;
+    size_t length;
+    uint8_t byte;
+
+    window_mask = ((1 << module.header.window_bits) - 1);
+    length_bits = (16 - module.header.window_bits);
+    decoded_size = 0;
+
+    while (size > 0) {
+        byte = *buf_p++;
+        size--;
+
+        if (module.lz.flags_left == 0) {
+            module.lz.flags = byte;
+            module.lz.flags_left = 8;
+            continue;
+        }
+
+        if (module.lz.flags & 1) {
+            length = 1;
+            distance = 0;
+        } else if (module.lz.state == LZ_STATE_TOKEN) {
+            module.lz.match_high = byte;
+            module.lz.state = LZ_STATE_MATCH;
+            continue;
+        } else {
+            value = ((module.lz.match_high << 8) | byte);
+            distance = ((value >> length_bits) + 1);
+            length = ((value & ((1 << length_bits) - 1)) + LZ_MIN_MATCH);
+            module.lz.state = LZ_STATE_TOKEN;
+
+            if (distance > module.lz.pos) {
+                log_object_print(NULL,
+                                 LOG_ERROR,
+                                 OSTR("upgrade LZ match before start\r\n"));
+                return (-1);
+            }
+        }
+
+        module.lz.flags >>= 1;
+        module.lz.flags_left--;
+
+        while (length > 0) {
+            if (distance > 0) {
+                byte = module.lz.window[(module.lz.pos - distance)
+                                        & window_mask];
+            }
+
+            module.lz.window[module.lz.pos & window_mask] = byte;
+            module.lz.pos++;
+            decoded[decoded_size++] = byte;
+            length--;
+
+            if (decoded_size == sizeof(decoded)) {
+                if (lz_output(&decoded[0], decoded_size) != 0) {
+                    return (-1);
+                }
+
+                decoded_size = 0;
+            }
+        }
+    }
+
+    return (lz_output(&decoded[0], decoded_size));
+}
+
+#endif
+
+/**
+ * Decode given upgrade binary data and write it to the application
+ * area.
+ */
+static int data_decode(const uint8_t *buf_p, size_t size)
+{
+#if CONFIG_UPGRADE_LZ_WINDOW_BITS > 0
+    if (module.header.encoding & UPGRADE_BINARY_ENCODING_LZ) {
+        return (lz_decode(buf_p, size));
+    }
+#endif
+
+    if (module.header.encoding & UPGRADE_BINARY_ENCODING_DELTA) {
+        return (delta_decode(buf_p, size));
+    }
+
+    return (output_write(buf_p, size));
+}
+
+static int data_begin(void)
+{
+    if (binary_header_check_encoding(&module.header) != 0) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("unsupported upgrade file encoding %u with "
+                              "window bits %u\r\n"),
+                         module.header.encoding,
+                         module.header.window_bits);
+        return (-1);
+    }
+
+    if (module.header.encoding & UPGRADE_BINARY_ENCODING_DELTA) {
+        if (base_verify() != 0) {
+            return (-1);
+        }
+    }
+
+    /* The header buffer is reused as output buffer. */
+    module.offset = 0;
+    module.decoded_size = 0;
+    sha1_init(&module.sha1);
+#if CONFIG_UPGRADE_LZ_WINDOW_BITS > 0
+    module.lz.pos = 0;
+    module.lz.state = LZ_STATE_TOKEN;
+    module.lz.flags_left = 0;
+#endif
+    module.delta.state = DELTA_STATE_OP;
+    module.delta.offset = 0;
+
+    return (0);
+}
+
+static int data_end(void)
+{
+    uint8_t sha1[20];
+
+#if CONFIG_UPGRADE_LZ_WINDOW_BITS > 0
+    if (module.lz.state != LZ_STATE_TOKEN) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("truncated upgrade LZ data\r\n"));
+        return (-1);
+    }
+#endif
+
+    if (module.delta.state != DELTA_STATE_OP) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("truncated upgrade delta\r\n"));
+        return (-1);
+    }
+
+    if (output_flush() != 0) {
+        return (-1);
+    }
+
+    if (module.decoded_size != module.header.size) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade data size %u, but expected %u\r\n"),
+                         module.decoded_size,
+                         module.header.size);
+        return (-1);
+    }
+
+    sha1_digest(&module.sha1, &sha1[0]);
+
+    if (memcmp(&sha1[0], &module.header.sha1[0], sizeof(sha1)) != 0) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade data SHA1 mismatch\r\n"));
+        return (-1);
+    }
 
     return (0);
 }
@@ -259,16 +851,31 @@ int upgrade_application_is_valid(int quick)
     return (upgrade_port_application_is_valid(quick));
 }
 
+int upgrade_start_programmer(void *buf_p,
+                             size_t size,
+                             void *stack_p,
+                             size_t stack_size)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+    return (upgrade_port_start_programmer(buf_p, size, stack_p, stack_size));
+}
+
 int upgrade_binary_upload_begin()
 {
     module.header_size = -1;
     module.offset = 0;
+    module.failed = 0;
 
     return (upgrade_port_binary_upload_begin());
 }
 
-int upgrade_binary_upload(const void *buf_p,
-                          size_t size)
+/**
+ * Parse the header and decode the data in given upgrade binary file
+ * chunk.
+ */
+static int binary_upload(const void *buf_p, size_t size)
 {
     size_t chunk_size;
 
@@ -314,25 +921,54 @@ int upgrade_binary_upload(const void *buf_p,
 
         log_object_print(NULL,
                          LOG_INFO,
-                         OSTR("parsed upgrade file header description '%s'"
-                              " and data size %u\r\n"),
+                         OSTR("parsed upgrade file header description '%s',"
+                              " data size %u and encoding %u\r\n"),
                          module.header.description,
-                         module.header.size);
+                         module.header.size,
+                         module.header.encoding);
 
         chunk_size = (module.header_size - (module.offset - chunk_size));
         size -= chunk_size;
         buf_p += chunk_size;
         module.header_size = 0;
 
+        if (data_begin() != 0) {
+            return (-1);
+        }
+
         if (size == 0) {
             return (0);
         }
     }
 
-    return (upgrade_port_binary_upload(buf_p, size));
+    return (data_decode(buf_p, size));
+}
+
+int upgrade_binary_upload(const void *buf_p,
+                          size_t size)
+{
+    if (module.failed == 1) {
+        return (-1);
+    }
+
+    if (binary_upload(buf_p, size) != 0) {
+        module.failed = 1;
+
+        return (-1);
+    }
+
+    return (0);
 }
 
 int upgrade_binary_upload_end()
 {
+    /* Verify the decoded data if the header was received. The port
+       must not accept a failed upload. */
+    if ((module.failed == 0) && (module.header_size == 0)) {
+        if (data_end() != 0) {
+            return (-1);
+        }
+    }
+
     return (upgrade_port_binary_upload_end());
 }
@@ -33,6 +33,14 @@
 
 #include "simba.h"
 
+/**
+ * Upgrade binary file data encodings. The LZ and delta encodings may
+ * be combined, in which case the delta stream is LZ compressed.
+ */
+#define UPGRADE_BINARY_ENCODING_RAW                       0x00
+#define UPGRADE_BINARY_ENCODING_LZ                        0x01
+#define UPGRADE_BINARY_ENCODING_DELTA                     0x02
+
 /**
  * Initialize the upgrade module. This function must be called before
  * calling any other function in this module.
@@ -104,6 +112,28 @@ int upgrade_application_erase(void);
  */
 int upgrade_application_is_valid(int quick);
 
+/**
+ * Program uploaded data in a separate thread using an asynchronous
+ * flash writer, overlapping programming of the application area with
+ * the transfer and decoding of the following data. Programming
+ * errors are returned by `upgrade_binary_upload_end()`.
+ *
+ * Only supported on Linux, where the upload is programmed into an
+ * emulated flash device.
+ *
+ * @param[in] buf_p Write buffer, split into two equally sized
+ *                  buffers.
+ * @param[in] size Write buffer size in bytes.
+ * @param[in] stack_p Programming thread stack.
+ * @param[in] stack_size Programming thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int upgrade_start_programmer(void *buf_p,
+                             size_t size,
+                             void *stack_p,
+                             size_t stack_size);
+
 /**
  * Begin an upload transaction of a .ubin file.
  *
@@ -112,7 +142,11 @@ int upgrade_application_is_valid(int quick);
 int upgrade_binary_upload_begin(void);
 
 /**
- * Add data to current upload transaction.
+ * Add data to current upload transaction. Encoded data is decoded
+ * while streamed to the application area, using a constant amount of
+ * memory. A delta is applied to the currently installed application,
+ * which is verified against the SHA1 in the header before any data
+ * is written.
  *
  * @param[in] buf_p Buffer to write.
  * @param[in] size Size of the buffer.
@@ -123,7 +157,8 @@ int upgrade_binary_upload(const void *buf_p,
                           size_t size);
 
 /**
- * End current upload transaction.
+ * End current upload transaction. The SHA1 of the decoded data is
+ * compared to the SHA1 in the header, if a header was received.
  *
  * @return zero(0) or negative error code.
  */
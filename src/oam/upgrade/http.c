@@ -232,9 +232,9 @@ static int http_request_upload(struct http_server_connection_t *connection_p,
             return (-1);
         }
 
-        if (chan_write(&connection_p->socket,
+        if (chan_write(connection_p->chan_p,
                        "HTTP/1.1 100 Continue\r\n\r\n",
-                       29) != 29) {
+                       25) != 25) {
             return (-1);
         }
     }
@@ -250,7 +250,7 @@ static int http_request_upload(struct http_server_connection_t *connection_p,
                 size = left;
             }
 
-            if (chan_read(&connection_p->socket, &buf[0], size) == size) {
+            if (chan_read(connection_p->chan_p, &buf[0], size) == size) {
                 res = upgrade_binary_upload(&buf[0], size);
                 left -= size;
             } else {
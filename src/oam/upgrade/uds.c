@@ -775,7 +775,17 @@ static int handle_request_transfer_exit(struct upgrade_uds_t *self_p,
         return (-1);
     }
 
-    upgrade_binary_upload_end();
+    /* Waits for the data to be programmed if the upgrade programmer
+       is started. */
+    if (upgrade_binary_upload_end() != 0) {
+        self_p->state = UDS_STATE_IDLE;
+        ignore_and_write_negative_response(self_p,
+                                           0,
+                                           REQUEST_TRANSFER_EXIT,
+                                           GENERAL_PROGRAMMING_FAILURE);
+
+        return (-1);
+    }
 
     self_p->state = UDS_STATE_IDLE;
 
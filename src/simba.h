@@ -93,6 +93,7 @@ extern "C" {
 #include "sync/sem.h"
 
 #include "sync/chan.h"
+#include "sync/chan_reader.h"
 #include "kernel/sys.h"
 #include "kernel/timer.h"
 #include "kernel/thrd.h"
@@ -100,6 +101,7 @@ extern "C" {
 #include "sync/mutex.h"
 #include "sync/cond.h"
 #include "sync/queue.h"
+#include "sync/spsc_queue.h"
 #include "sync/event.h"
 #include "sync/rwlock.h"
 #include "sync/bus.h"
@@ -119,6 +121,7 @@ extern "C" {
 #include "oam/nvm.h"
 
 #include "debug/log.h"
+#include "debug/trace.h"
 
 #include "text/color.h"
 #include "text/re.h"
@@ -128,6 +131,8 @@ extern "C" {
 
 #include "encode/base64.h"
 #include "encode/json.h"
+#include "encode/json_reader.h"
+#include "encode/json_writer.h"
 #include "encode/nmea.h"
 
 #include "hash/crc.h"
@@ -265,12 +270,18 @@ extern "C" {
 #ifdef PORT_HAS_HD44780
 #    include "drivers/displays/hd44780.h"
 #endif
+#ifdef PORT_HAS_CAPTURE
+#    include "drivers/basic/capture.h"
+#endif
 
 #include "inet/isotp.h"
 
 #include "debug/harness.h"
+#include "debug/benchmark.h"
 
 #include "multimedia/midi.h"
+#include "multimedia/dsp.h"
+#include "multimedia/audio_stream.h"
 
 #include "inet/socket.h"
 
@@ -32,7 +32,7 @@
 ifeq ($(TYPE),suite)
   ALLOC_SRC += heap.c
   COLLECTIONS_SRC += circular_buffer.c binary_tree.c
-  DEBUG_SRC += log.c harness.c
+  DEBUG_SRC += log.c harness.c trace.c
   DRIVERS_SRC += storage/flash.c network/uart.c
   ENCODE_SRC +=
   HASH_SRC +=
@@ -43,7 +43,7 @@ ifeq ($(TYPE),suite)
   OAM_SRC += console.c settings.c nvm.c
   FILESYSTEMS_SRC += fs.c
   SPIFFS_SRC +=
-  SYNC_SRC += chan.c queue.c rwlock.c sem.c mutex.c bus.c event.c
+  SYNC_SRC += chan.c chan_reader.c queue.c rwlock.c sem.c mutex.c cond.c bus.c event.c spsc_queue.c
   TEXT_SRC += std.c
   SCIENCE_SRC +=
 
@@ -94,7 +94,9 @@ SRC += $(COLLECTIONS_SRC:%=$(SIMBA_ROOT)/src/collections/%)
 
 # Debug package.
 DEBUG_SRC ?= log.c \
-	     harness.c
+	     harness.c \
+	     benchmark.c \
+	     trace.c
 
 SRC += $(DEBUG_SRC:%=$(SIMBA_ROOT)/src/debug/%)
 
@@ -105,6 +107,7 @@ DRIVERS_SRC ?= \
 	basic/adc.c \
 	basic/analog_input_pin.c \
 	basic/analog_output_pin.c \
+	basic/capture.c \
 	basic/chipid.c \
 	basic/dac.c \
 	basic/exti.c \
@@ -154,12 +157,15 @@ SRC += $(DRIVERS_SRC:%=$(SIMBA_ROOT)/src/drivers/%)
 
 ifeq ($(FAMILY),linux)
 SRC += $(SIMBA_ROOT)/src/drivers/ports/linux/socket_device.c
+SRC += $(SIMBA_ROOT)/src/drivers/ports/linux/socketcan.c
 endif
 
 # Encode package.
 ENCODE_SRC ?= \
 	base64.c \
 	json.c \
+	json_reader.c \
+	json_writer.c \
 	nmea.c
 
 SRC += $(ENCODE_SRC:%=$(SIMBA_ROOT)/src/encode/%)
@@ -333,7 +339,10 @@ KERNEL_SRC ?= $(KERNEL_SRC_TMP)
 SRC += $(KERNEL_SRC:%=$(SIMBA_ROOT)/src/kernel/%)
 
 # Multimedia package.
-MULTIMEDIA_SRC ?= midi.c
+MULTIMEDIA_SRC ?= \
+	audio_stream.c \
+	dsp.c \
+	midi.c
 
 SRC += $(MULTIMEDIA_SRC:%=$(SIMBA_ROOT)/src/multimedia/%)
 
@@ -382,12 +391,14 @@ SRC += $(SPIFFS_SRC:%=$(SIMBA_ROOT)/%)
 # Sync package.
 SYNC_SRC ?= bus.c \
 	    chan.c \
+	    chan_reader.c \
 	    cond.c \
 	    event.c \
 	    mutex.c \
 	    queue.c \
 	    rwlock.c \
-	    sem.c
+	    sem.c \
+	    spsc_queue.c
 
 SRC += $(SYNC_SRC:%=$(SIMBA_ROOT)/src/sync/%)
 
@@ -30,6 +30,250 @@
 
 #include "simba.h"
 
+/**
+ * Get the current snapshot and mark it as used by the calling writer.
+ */
+static struct bus_snapshot_t *snapshot_get(struct bus_t *self_p)
+{
+    struct bus_snapshot_t *snapshot_p;
+
+    while (1) {
+        snapshot_p = __atomic_load_n(&self_p->snapshot.current_p,
+                                     __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&snapshot_p->readers, 1, __ATOMIC_SEQ_CST);
+
+        /* The snapshot may have been replaced before it was
+           marked. */
+        if (__atomic_load_n(&self_p->snapshot.current_p,
+                            __ATOMIC_SEQ_CST) == snapshot_p) {
+            break;
+        }
+
+        (void)__atomic_sub_fetch(&snapshot_p->readers, 1, __ATOMIC_SEQ_CST);
+    }
+
+    return (snapshot_p);
+}
+
+/**
+ * Leave given snapshot. Resumes any attach or detach waiting for the
+ * last writer to leave it.
+ */
+static void snapshot_put(struct bus_t *self_p,
+                         struct bus_snapshot_t *snapshot_p)
+{
+    if (__atomic_sub_fetch(&snapshot_p->readers, 1, __ATOMIC_SEQ_CST) != 0) {
+        return;
+    }
+
+    if (__atomic_load_n(&self_p->snapshot.thrd_p, __ATOMIC_SEQ_CST) == NULL) {
+        return;
+    }
+
+    sys_lock();
+
+    if ((self_p->snapshot.thrd_p != NULL)
+        && (__atomic_load_n(&self_p->snapshot.grace_p->readers,
+                            __ATOMIC_SEQ_CST) == 0)) {
+        thrd_resume_isr(self_p->snapshot.thrd_p, 0);
+        self_p->snapshot.thrd_p = NULL;
+    }
+
+    sys_unlock();
+}
+
+/**
+ * Wait for all writers to leave given snapshot.
+ */
+static void snapshot_wait(struct bus_t *self_p,
+                          struct bus_snapshot_t *snapshot_p)
+{
+    sys_lock();
+
+    self_p->snapshot.grace_p = snapshot_p;
+
+    while (1) {
+        __atomic_store_n(&self_p->snapshot.thrd_p,
+                         thrd_self(),
+                         __ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&snapshot_p->readers, __ATOMIC_SEQ_CST) == 0) {
+            break;
+        }
+
+        thrd_suspend_isr(NULL);
+    }
+
+    __atomic_store_n(&self_p->snapshot.thrd_p, NULL, __ATOMIC_SEQ_CST);
+
+    sys_unlock();
+}
+
+/**
+ * Returns the snapshot to build the next listener array in, once all
+ * writers have left it.
+ */
+static struct bus_snapshot_t *snapshot_next(struct bus_t *self_p)
+{
+    struct bus_snapshot_t *snapshot_p;
+
+    if (self_p->snapshot.current_p == &self_p->snapshot.buffers[0]) {
+        snapshot_p = &self_p->snapshot.buffers[1];
+    } else {
+        snapshot_p = &self_p->snapshot.buffers[0];
+    }
+
+    snapshot_wait(self_p, snapshot_p);
+
+    return (snapshot_p);
+}
+
+static void snapshot_publish(struct bus_t *self_p,
+                             struct bus_snapshot_t *snapshot_p)
+{
+    __atomic_store_n(&self_p->snapshot.current_p,
+                     snapshot_p,
+                     __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Returns the index of the first listener in given snapshot with an
+ * id greater than or equal to given id.
+ */
+static size_t snapshot_lower_bound(struct bus_snapshot_t *snapshot_p,
+                                   int id)
+{
+    size_t low;
+    size_t high;
+    size_t middle;
+
+    low = 0;
+    high = snapshot_p->length;
+
+    while (low < high) {
+        middle = (low + high) / 2;
+
+        if (snapshot_p->listeners_pp[middle]->id < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return (low);
+}
+
+static int snapshot_attach(struct bus_t *self_p,
+                           struct bus_listener_t *listener_p)
+{
+    struct bus_snapshot_t *current_p;
+    struct bus_snapshot_t *next_p;
+    size_t index;
+
+    current_p = self_p->snapshot.current_p;
+
+    if (current_p->length == self_p->snapshot.max) {
+        return (-ENOMEM);
+    }
+
+    next_p = snapshot_next(self_p);
+
+    index = snapshot_lower_bound(current_p, listener_p->id);
+
+    /* Insert after all listeners with the same id. */
+    while ((index < current_p->length)
+           && (current_p->listeners_pp[index]->id == listener_p->id)) {
+        index++;
+    }
+
+    memcpy(&next_p->listeners_pp[0],
+           &current_p->listeners_pp[0],
+           index * sizeof(next_p->listeners_pp[0]));
+    next_p->listeners_pp[index] = listener_p;
+    memcpy(&next_p->listeners_pp[index + 1],
+           &current_p->listeners_pp[index],
+           (current_p->length - index) * sizeof(next_p->listeners_pp[0]));
+    next_p->length = (current_p->length + 1);
+
+    snapshot_publish(self_p, next_p);
+
+    return (0);
+}
+
+static int snapshot_detatch(struct bus_t *self_p,
+                            struct bus_listener_t *listener_p)
+{
+    struct bus_snapshot_t *current_p;
+    struct bus_snapshot_t *next_p;
+    size_t index;
+
+    current_p = self_p->snapshot.current_p;
+    index = snapshot_lower_bound(current_p, listener_p->id);
+
+    while (index < current_p->length) {
+        if (current_p->listeners_pp[index] == listener_p) {
+            break;
+        }
+
+        index++;
+    }
+
+    if (index == current_p->length) {
+        return (-1);
+    }
+
+    next_p = snapshot_next(self_p);
+
+    memcpy(&next_p->listeners_pp[0],
+           &current_p->listeners_pp[0],
+           index * sizeof(next_p->listeners_pp[0]));
+    memcpy(&next_p->listeners_pp[index],
+           &current_p->listeners_pp[index + 1],
+           (current_p->length - index - 1) * sizeof(next_p->listeners_pp[0]));
+    next_p->length = (current_p->length - 1);
+
+    snapshot_publish(self_p, next_p);
+
+    /* Writers may still use the detached listener. */
+    snapshot_wait(self_p, current_p);
+
+    return (0);
+}
+
+/**
+ * Write given message to given listener.
+ *
+ * @return true(1) if the listener received the message, otherwise
+ *         false(0).
+ */
+static int deliver(struct bus_t *self_p,
+                   struct bus_listener_t *listener_p,
+                   const void *buf_p,
+                   size_t size)
+{
+    ssize_t res;
+
+    if (self_p->delivery == BUS_DELIVERY_BLOCKING) {
+        ((struct chan_t *)listener_p->chan_p)->write(listener_p->chan_p,
+                                                     buf_p,
+                                                     size);
+
+        return (1);
+    }
+
+    sys_lock();
+
+    res = chan_write_isr(listener_p->chan_p, buf_p, size);
+
+    if (res != (ssize_t)size) {
+        listener_p->dropped++;
+    }
+
+    sys_unlock();
+
+    return (res == (ssize_t)size);
+}
+
 int bus_module_init()
 {
     return (0);
@@ -41,6 +285,57 @@ int bus_init(struct bus_t *self_p)
 
     binary_tree_init(&self_p->listeners);
     rwlock_init(&self_p->rwlock);
+    self_p->delivery = BUS_DELIVERY_BLOCKING;
+    self_p->snapshot.current_p = NULL;
+    self_p->snapshot.max = 0;
+    self_p->snapshot.thrd_p = NULL;
+    self_p->snapshot.grace_p = NULL;
+
+    return (0);
+}
+
+int bus_set_snapshot_buffer(struct bus_t *self_p,
+                            void *buf_p,
+                            size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    size_t max;
+    struct bus_listener_t **listeners_pp;
+
+    if (self_p->listeners.root_p != NULL) {
+        return (-EBUSY);
+    }
+
+    if (self_p->snapshot.current_p != NULL) {
+        if (self_p->snapshot.current_p->length > 0) {
+            return (-EBUSY);
+        }
+    }
+
+    listeners_pp = buf_p;
+    max = (size / (2 * sizeof(*listeners_pp)));
+
+    self_p->snapshot.buffers[0].listeners_pp = &listeners_pp[0];
+    self_p->snapshot.buffers[0].length = 0;
+    self_p->snapshot.buffers[0].readers = 0;
+    self_p->snapshot.buffers[1].listeners_pp = &listeners_pp[max];
+    self_p->snapshot.buffers[1].length = 0;
+    self_p->snapshot.buffers[1].readers = 0;
+    self_p->snapshot.max = max;
+    self_p->snapshot.current_p = &self_p->snapshot.buffers[0];
+
+    return (0);
+}
+
+int bus_set_delivery(struct bus_t *self_p, int delivery)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((delivery == BUS_DELIVERY_BLOCKING)
+            || (delivery == BUS_DELIVERY_NON_BLOCKING), EINVAL);
+
+    self_p->delivery = delivery;
 
     return (0);
 }
@@ -56,6 +351,7 @@ int bus_listener_init(struct bus_listener_t *self_p,
     self_p->id = id;
     self_p->chan_p = chan_p;
     self_p->next_p = NULL;
+    self_p->dropped = 0;
 
     return (0);
 }
@@ -66,13 +362,19 @@ int bus_attach(struct bus_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(listener_p != NULL, EINVAL);
 
+    int res;
     struct bus_listener_t *head_p;
 
+    res = 0;
+
     rwlock_writer_take(&self_p->rwlock);
 
-    /* Try to insert the node into the tree. It fails if there already
-     * is a node with the same key (id).*/
-    if (binary_tree_insert(&self_p->listeners, &listener_p->base) != 0) {
+    if (self_p->snapshot.current_p != NULL) {
+        res = snapshot_attach(self_p, listener_p);
+    } else if (binary_tree_insert(&self_p->listeners,
+                                  &listener_p->base) != 0) {
+        /* The insert fails if there already is a node with the same
+         * key (id).*/
         head_p = (struct bus_listener_t *)binary_tree_search(
             &self_p->listeners, listener_p->id);
 
@@ -82,7 +384,7 @@ int bus_attach(struct bus_t *self_p,
 
     rwlock_writer_give(&self_p->rwlock);
 
-    return (0);
+    return (res);
 }
 
 int bus_detatch(struct bus_t *self_p,
@@ -96,6 +398,13 @@ int bus_detatch(struct bus_t *self_p,
 
     rwlock_writer_take(&self_p->rwlock);
 
+    if (self_p->snapshot.current_p != NULL) {
+        res = snapshot_detatch(self_p, listener_p);
+        rwlock_writer_give(&self_p->rwlock);
+
+        return (res);
+    }
+
     head_p = (struct bus_listener_t *)binary_tree_search(
         &self_p->listeners, listener_p->id);
 
@@ -141,18 +450,38 @@ int bus_write(struct bus_t *self_p,
 
     int number_of_receivers;
     struct bus_listener_t *curr_p;
+    struct bus_snapshot_t *snapshot_p;
+    size_t index;
+
+    number_of_receivers = 0;
+
+    if (self_p->snapshot.current_p != NULL) {
+        snapshot_p = snapshot_get(self_p);
+        index = snapshot_lower_bound(snapshot_p, id);
+
+        while (index < snapshot_p->length) {
+            curr_p = snapshot_p->listeners_pp[index];
+
+            if (curr_p->id != id) {
+                break;
+            }
+
+            number_of_receivers += deliver(self_p, curr_p, buf_p, size);
+            index++;
+        }
+
+        snapshot_put(self_p, snapshot_p);
+
+        return (number_of_receivers);
+    }
 
     rwlock_reader_take(&self_p->rwlock);
 
     curr_p = (struct bus_listener_t *)binary_tree_search(
         &self_p->listeners, id);
-    number_of_receivers = 0;
 
     while (curr_p != NULL) {
-        ((struct chan_t *)curr_p->chan_p)->write(curr_p->chan_p,
-                                                 buf_p,
-                                                 size);
-        number_of_receivers++;
+        number_of_receivers += deliver(self_p, curr_p, buf_p, size);
         curr_p = curr_p->next_p;
     }
 
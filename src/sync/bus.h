@@ -33,9 +33,44 @@
 
 #include "simba.h"
 
+/**
+ * Write messages to listener channels with their write function. The
+ * writer blocks if a listener channel is full. This is the default
+ * delivery policy.
+ */
+#define BUS_DELIVERY_BLOCKING                                  0
+
+/**
+ * Write messages to listener channels with their write isr function,
+ * and never block. A message that does not fit in a listener channel
+ * is counted as dropped in the listener. All listener channels must
+ * implement the write isr function.
+ */
+#define BUS_DELIVERY_NON_BLOCKING                              1
+
+/**
+ * An immutable array of listeners sorted by id.
+ */
+struct bus_snapshot_t {
+    struct bus_listener_t **listeners_pp;
+    size_t length;
+    /* Number of writers using the snapshot. */
+    int readers;
+};
+
 struct bus_t {
     struct rwlock_t rwlock;
     struct binary_tree_t listeners;
+    int delivery;
+    struct {
+        struct bus_snapshot_t buffers[2];
+        struct bus_snapshot_t *current_p;
+        size_t max;
+        /* Attach or detach waiting for writers to leave a
+           snapshot. */
+        struct thrd_t *thrd_p;
+        struct bus_snapshot_t *grace_p;
+    } snapshot;
 };
 
 struct bus_listener_t {
@@ -43,6 +78,8 @@ struct bus_listener_t {
     int id;
     void *chan_p;
     struct bus_listener_t *next_p;
+    /* Number of messages dropped with non-blocking delivery. */
+    uint32_t dropped;
 };
 
 /**
@@ -65,6 +102,42 @@ int bus_module_init(void);
  */
 int bus_init(struct bus_t *self_p);
 
+/**
+ * Use listener snapshots in given bus. Must be called before any
+ * listener is attached to the bus.
+ *
+ * Attach and detach publish a new, immutable array of the attached
+ * listeners sorted by id. Writers binary search the current array
+ * without taking any lock, so a writer never waits for an attach or
+ * a detach. The array replaced by an attach or a detach is reused
+ * once all writers have left it. `bus_detatch()` waits for that
+ * before returning, so a detached listener is never written to after
+ * it has returned.
+ *
+ * @param[in] self_p Bus.
+ * @param[in] buf_p Buffer for two listener arrays.
+ * @param[in] size Size of the buffer in bytes. At most size / (2 *
+ *                 sizeof(void *)) listeners can be attached to the
+ *                 bus.
+ *
+ * @return zero(0) or negative error code.
+ */
+int bus_set_snapshot_buffer(struct bus_t *self_p,
+                            void *buf_p,
+                            size_t size);
+
+/**
+ * Set the message delivery policy of given bus.
+ *
+ * @param[in] self_p Bus.
+ * @param[in] delivery Delivery policy, one of
+ *                     ``BUS_DELIVERY_BLOCKING`` and
+ *                     ``BUS_DELIVERY_NON_BLOCKING``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int bus_set_delivery(struct bus_t *self_p, int delivery);
+
 /**
  * Initialize given listener to receive messages with given id, after
  * the listener is attached to the bus. A listener can only receive
@@ -89,7 +162,8 @@ int bus_listener_init(struct bus_listener_t *self_p,
  * @param[in] self_p Bus to attach the listener to.
  * @param[in] listener_p Listener to attach to the bus.
  *
- * @return zero(0) or negative error code.
+ * @return zero(0) or negative error code. -ENOMEM if the snapshot
+ *         buffer is full.
  */
 int bus_attach(struct bus_t *self_p,
                struct bus_listener_t *listener_p);
@@ -117,7 +191,8 @@ int bus_detatch(struct bus_t *self_p,
  * @param[in] size Number of bytes to write.
  *
  * @return Number of listeners that received the message, or negative
- *         error code.
+ *         error code. Listeners that dropped the message are not
+ *         counted.
  */
 int bus_write(struct bus_t *self_p,
               int id,
@@ -30,7 +30,8 @@
 
 #include "simba.h"
 
-#define CHAN_LIST_POLLING 0x1
+#define CHAN_LIST_POLLING                                 0x1
+#define CHAN_LIST_EDGE_TRIGGERED                          0x2
 
 static const struct chan_t null = {
     .read = chan_read_null,
@@ -64,6 +65,8 @@ int chan_init(struct chan_t *self_p,
     self_p->write_filter_isr_cb = NULL;
     self_p->reader_p = NULL;
     self_p->list_p = NULL;
+    self_p->ready_next_p = NULL;
+    self_p->ready = 0;
 
     return (0);
 }
@@ -100,6 +103,127 @@ int chan_set_write_isr_cb(struct chan_t *self_p,
     return (0);
 }
 
+/**
+ * Append given channel to the ready queue of given list, if not
+ * already in it.
+ */
+static RAM_CODE void ready_push_isr(struct chan_list_t *list_p,
+                                    struct chan_t *chan_p)
+{
+    if (chan_p->ready == 1) {
+        return;
+    }
+
+    chan_p->ready = 1;
+    chan_p->ready_next_p = NULL;
+
+    if (list_p->ready.tail_p == NULL) {
+        list_p->ready.head_p = chan_p;
+    } else {
+        list_p->ready.tail_p->ready_next_p = chan_p;
+    }
+
+    list_p->ready.tail_p = chan_p;
+}
+
+/**
+ * Remove the first channel from the ready queue of given list.
+ */
+static struct chan_t *ready_pop_isr(struct chan_list_t *list_p)
+{
+    struct chan_t *chan_p;
+
+    chan_p = list_p->ready.head_p;
+
+    if (chan_p != NULL) {
+        list_p->ready.head_p = chan_p->ready_next_p;
+
+        if (list_p->ready.head_p == NULL) {
+            list_p->ready.tail_p = NULL;
+        }
+
+        chan_p->ready_next_p = NULL;
+        chan_p->ready = 0;
+    }
+
+    return (chan_p);
+}
+
+/**
+ * Remove given channel from the ready queue of given list.
+ */
+static void ready_remove_isr(struct chan_list_t *list_p,
+                             struct chan_t *chan_p)
+{
+    struct chan_t *prev_p;
+
+    if (chan_p->ready == 0) {
+        return;
+    }
+
+    if (list_p->ready.head_p == chan_p) {
+        (void)ready_pop_isr(list_p);
+
+        return;
+    }
+
+    prev_p = list_p->ready.head_p;
+
+    while (prev_p->ready_next_p != chan_p) {
+        prev_p = prev_p->ready_next_p;
+    }
+
+    prev_p->ready_next_p = chan_p->ready_next_p;
+
+    if (list_p->ready.tail_p == chan_p) {
+        list_p->ready.tail_p = prev_p;
+    }
+
+    chan_p->ready_next_p = NULL;
+    chan_p->ready = 0;
+}
+
+/**
+ * Move up to given length ready channels from the ready queue to given
+ * array. Level-triggered channels without data are dropped from the
+ * queue, and the returned ones are added back to its tail to be
+ * polled again until read empty.
+ *
+ * @return Number of ready channels.
+ */
+static size_t ready_collect_isr(struct chan_list_t *list_p,
+                                void **chans_pp,
+                                size_t length)
+{
+    struct chan_t *chan_p;
+    size_t i;
+    size_t n;
+
+    n = 0;
+
+    while (n < length) {
+        chan_p = ready_pop_isr(list_p);
+
+        if (chan_p == NULL) {
+            break;
+        }
+
+        if ((list_p->flags & CHAN_LIST_EDGE_TRIGGERED)
+            || (chan_p->size(chan_p) > 0)) {
+            chans_pp[n] = chan_p;
+            n++;
+        }
+    }
+
+    if ((list_p->flags & CHAN_LIST_EDGE_TRIGGERED) == 0) {
+        for (i = 0; i < n; i++) {
+            ready_push_isr(list_p, chans_pp[i]);
+        }
+    }
+
+    return (n);
+}
+
 int chan_list_init(struct chan_list_t *list_p,
                    void *workspace_p,
                    size_t size)
@@ -113,6 +237,28 @@ int chan_list_init(struct chan_list_t *list_p,
     list_p->chans_pp = workspace_p;
     list_p->len = 0;
     list_p->flags = 0;
+    list_p->ready.head_p = NULL;
+    list_p->ready.tail_p = NULL;
+    list_p->thrd_p = NULL;
+
+    return (0);
+}
+
+int chan_list_set_mode(struct chan_list_t *list_p, int mode)
+{
+    ASSERTN(list_p != NULL, EINVAL);
+    ASSERTN((mode == CHAN_LIST_MODE_LEVEL_TRIGGERED)
+            || (mode == CHAN_LIST_MODE_EDGE_TRIGGERED), EINVAL);
+
+    sys_lock();
+
+    if (mode == CHAN_LIST_MODE_EDGE_TRIGGERED) {
+        list_p->flags |= CHAN_LIST_EDGE_TRIGGERED;
+    } else {
+        list_p->flags &= ~CHAN_LIST_EDGE_TRIGGERED;
+    }
+
+    sys_unlock();
 
     return (0);
 }
@@ -129,8 +275,13 @@ int chan_list_destroy(struct chan_list_t *list_p)
     for (i = 0; i < list_p->len; i++) {
         chan_p = list_p->chans_pp[i];
         chan_p->list_p = NULL;
+        chan_p->ready_next_p = NULL;
+        chan_p->ready = 0;
     }
 
+    list_p->ready.head_p = NULL;
+    list_p->ready.tail_p = NULL;
+
     sys_unlock();
 
     return (0);
@@ -260,6 +411,11 @@ int chan_list_add(struct chan_list_t *list_p, void *chan_p)
         list_p->chans_pp[list_p->len] = chan_p;
         list_p->len++;
         ((struct chan_t *)chan_p)->list_p = list_p;
+
+        /* Data written before the channel was added. */
+        if (((struct chan_t *)chan_p)->size(chan_p) > 0) {
+            ready_push_isr(list_p, chan_p);
+        }
     }
 
     sys_unlock();
@@ -281,6 +437,7 @@ int chan_list_remove(struct chan_list_t *list_p, void *chan_p)
         if (list_p->chans_pp[i] == chan_p) {
             list_p->len--;
             list_p->chans_pp[i] = list_p->chans_pp[list_p->len];
+            ready_remove_isr(list_p, chan_p);
             ((struct chan_t *)chan_p)->list_p = NULL;
             res = 0;
             break;
@@ -297,48 +454,49 @@ void *chan_list_poll(struct chan_list_t *list_p,
 {
     ASSERTNRN(list_p != NULL, EINVAL);
 
-    struct chan_t *chan_p = NULL;
-    size_t i;
+    void *chan_p;
 
-    sys_lock();
+    if (chan_list_poll_many(list_p, &chan_p, 1, timeout_p) <= 0) {
+        chan_p = NULL;
+    }
 
-    while (1) {
-        /* Check if data is available on any channel. */
-        for (i = 0; i < list_p->len; i++) {
-            chan_p = list_p->chans_pp[i];
+    return (chan_p);
+}
 
-            if (chan_p->size(chan_p) > 0) {
-                goto out;
-            }
-        }
+ssize_t chan_list_poll_many(struct chan_list_t *list_p,
+                            void **chans_pp,
+                            size_t length,
+                            const struct time_t *timeout_p)
+{
+    ASSERTN(list_p != NULL, EINVAL);
+    ASSERTN(chans_pp != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    ssize_t n;
 
-        /* Add the thread as a reader on all channels.*/
-        list_p->flags = CHAN_LIST_POLLING;
+    sys_lock();
+
+    while (1) {
+        n = ready_collect_isr(list_p, chans_pp, length);
 
-        for (i = 0; i < list_p->len; i++) {
-            chan_p = list_p->chans_pp[i];
-            chan_p->reader_p = thrd_self();
+        if (n > 0) {
+            break;
         }
 
         /* No data was available, wait for data to be written to one
            of the channels. */
-        if (thrd_suspend_isr(timeout_p) == -ETIMEDOUT) {
-            for (i = 0; i < list_p->len; i++) {
-                chan_p = list_p->chans_pp[i];
-                chan_p->reader_p = NULL;
-            }
+        list_p->thrd_p = thrd_self();
+        list_p->flags |= CHAN_LIST_POLLING;
 
-            list_p->flags = 0;
-            chan_p = NULL;
-
-            goto out;
+        if (thrd_suspend_isr(timeout_p) == -ETIMEDOUT) {
+            list_p->flags &= ~CHAN_LIST_POLLING;
+            break;
         }
     }
 
- out:
     sys_unlock();
 
-    return (chan_p);
+    return (n);
 }
 
 void *chan_poll(void *chan_p, const struct time_t *timeout_p)
@@ -387,26 +545,22 @@ int chan_control_null(void *self_p, int operation)
 
 RAM_CODE int chan_is_polled_isr(struct chan_t *self_p)
 {
-    int i;
-    int res;
-    struct chan_t *chan_p;
+    struct chan_list_t *list_p;
 
-    res = 0;
+    list_p = self_p->list_p;
 
-    if (self_p->list_p != NULL) {
-        if (self_p->list_p->flags & CHAN_LIST_POLLING) {
-            res = 1;
-            self_p->list_p->flags = 0;
+    if (list_p == NULL) {
+        return (0);
+    }
 
-            for (i = 0; i < self_p->list_p->len; i++) {
-                chan_p = self_p->list_p->chans_pp[i];
+    ready_push_isr(list_p, self_p);
 
-                if (self_p != chan_p) {
-                    chan_p->reader_p = NULL;
-                }
-            }
-        }
+    if ((list_p->flags & CHAN_LIST_POLLING) == 0) {
+        return (0);
     }
 
-    return (res);
+    list_p->flags &= ~CHAN_LIST_POLLING;
+    self_p->reader_p = list_p->thrd_p;
+
+    return (1);
 }
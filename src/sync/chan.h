@@ -124,11 +124,31 @@ typedef int (*chan_write_filter_fn_t)(void *self_p,
  */
 typedef size_t (*chan_size_fn_t)(void *self_p);
 
+/**
+ * Level-triggered polling. A channel is returned by the poll
+ * functions as long as it has data available. This is the default.
+ */
+#define CHAN_LIST_MODE_LEVEL_TRIGGERED                      0
+
+/**
+ * Edge-triggered polling. A channel is returned by the poll functions
+ * once per write to it, whether or not the data has been read.
+ */
+#define CHAN_LIST_MODE_EDGE_TRIGGERED                       1
+
 struct chan_list_t {
     struct chan_t **chans_pp;
     size_t max;
     size_t len;
     int flags;
+    /* Channels written to since they were last returned by a
+       poll. */
+    struct {
+        struct chan_t *head_p;
+        struct chan_t *tail_p;
+    } ready;
+    /* Thread waiting in a poll function. */
+    struct thrd_t *thrd_p;
 };
 
 /**
@@ -146,6 +166,10 @@ struct chan_t {
     struct thrd_t *reader_p;
     /* Used by the reader when polling channels. */
     struct chan_list_t *list_p;
+    /* Next channel in the list ready queue. */
+    struct chan_t *ready_next_p;
+    /* true(1) if in the list ready queue, otherwise false(0). */
+    int ready;
 };
 
 /**
@@ -338,7 +362,11 @@ ssize_t chan_write_isr(void *self_p,
 
 /**
  * Check if a channel is polled. May only be called from isr or with
- * the system lock taken (see `sys_lock()`).
+ * the system lock taken (see `sys_lock()`). Channel implementations
+ * must call this function when data is written to the channel, as it
+ * also adds the channel to the ready queue of its list. If true(1) is
+ * returned, the polling thread is stored in the ``reader_p`` member
+ * of given channel, and the caller must resume it.
  *
  * @param[in] self_p Channel to check.
  *
@@ -352,6 +380,9 @@ int chan_is_polled_isr(struct chan_t *self_p);
  * least one channel, the poll function returns and the application
  * can read from the channel with data.
  *
+ * Channels are added to a ready queue in the list when written to, so
+ * polling does not depend on the number of channels in the list.
+ *
  * @param[in] list_p List to initialize.
  * @param[in] workspace_p Workspace for internal use.
  * @param[in] size Size of the workspace in bytes.
@@ -362,6 +393,18 @@ int chan_list_init(struct chan_list_t *list_p,
                    void *workspace_p,
                    size_t size);
 
+/**
+ * Set the poll mode of given list, either
+ * `CHAN_LIST_MODE_LEVEL_TRIGGERED` or
+ * `CHAN_LIST_MODE_EDGE_TRIGGERED`.
+ *
+ * @param[in] list_p List to set the mode of.
+ * @param[in] mode Poll mode.
+ *
+ * @return zero(0) or negative error code.
+ */
+int chan_list_set_mode(struct chan_list_t *list_p, int mode);
+
 /**
  * Destroy an initialized list of channels.
  *
@@ -405,6 +448,25 @@ int chan_list_remove(struct chan_list_t *list_p, void *chan_p);
 void *chan_list_poll(struct chan_list_t *list_p,
                      const struct time_t *timeout_p);
 
+/**
+ * Poll given list of channels for events. Blocks until at least one
+ * of the channels in the list has data ready to be read or an timeout
+ * occurs, and then returns all ready channels, up to given length.
+ *
+ * @param[in] list_p List of channels to poll.
+ * @param[out] chans_pp Array of ready channels.
+ * @param[in] length Length of the ready channels array.
+ * @param[in] timeout_p Time to wait for data on any channel before a
+ *                      timeout occurs. Set to NULL to wait forever.
+ *
+ * @return Number of ready channels, zero(0) on timeout, or negative
+ *         error code.
+ */
+ssize_t chan_list_poll_many(struct chan_list_t *list_p,
+                            void **chans_pp,
+                            size_t length,
+                            const struct time_t *timeout_p);
+
 /**
  * Poll given channel for events. Blocks until the channel has data
  * ready to be read or an timeout occurs.
@@ -0,0 +1,297 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static ssize_t base_read(void *self_p, void *buf_p, size_t size)
+{
+    return (chan_reader_read(self_p, buf_p, size));
+}
+
+static ssize_t base_write(void *self_p, const void *buf_p, size_t size)
+{
+    return (chan_write(((struct chan_reader_t *)self_p)->chan_p,
+                       buf_p,
+                       size));
+}
+
+static size_t base_size(void *self_p)
+{
+    struct chan_reader_t *reader_p;
+
+    reader_p = self_p;
+
+    return ((reader_p->length - reader_p->pos)
+            + chan_size(reader_p->chan_p));
+}
+
+static int base_control(void *self_p, int operation)
+{
+    return (chan_control(((struct chan_reader_t *)self_p)->chan_p,
+                         operation));
+}
+
+/**
+ * Read at least one byte from the channel into the reader buffer. Read
+ * as many bytes as the channel has available, if they fit.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+static ssize_t fill(struct chan_reader_t *self_p)
+{
+    ssize_t res;
+    size_t size;
+
+    if (self_p->pos == self_p->length) {
+        self_p->pos = 0;
+        self_p->length = 0;
+    } else if ((self_p->length == self_p->size) && (self_p->pos > 0)) {
+        self_p->length -= self_p->pos;
+        memmove(self_p->buf_p, &self_p->buf_p[self_p->pos], self_p->length);
+        self_p->pos = 0;
+    }
+
+    if (self_p->length == self_p->size) {
+        return (-ENOMEM);
+    }
+
+    size = chan_size(self_p->chan_p);
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    size = MIN(size, self_p->size - self_p->length);
+    res = chan_read(self_p->chan_p, &self_p->buf_p[self_p->length], size);
+
+    if (res <= 0) {
+        return (res == 0 ? -EIO : res);
+    }
+
+    self_p->length += res;
+
+    return (res);
+}
+
+int chan_reader_init(struct chan_reader_t *self_p,
+                     void *chan_p,
+                     void *buf_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    chan_init(&self_p->base, base_read, base_write, base_size);
+    chan_set_control_cb(&self_p->base, base_control);
+    self_p->chan_p = chan_p;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pos = 0;
+    self_p->length = 0;
+
+    return (0);
+}
+
+ssize_t chan_reader_read(struct chan_reader_t *self_p,
+                         void *buf_p,
+                         size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    char *b_p;
+    size_t left;
+    size_t n;
+    ssize_t res;
+
+    b_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        n = (self_p->length - self_p->pos);
+
+        if (n == 0) {
+            /* Read directly into the destination buffer if there is
+               nothing more to buffer, or if the chunk is big. */
+            if ((left >= self_p->size)
+                || (chan_size(self_p->chan_p) <= left)) {
+                res = chan_read(self_p->chan_p, b_p, left);
+
+                if (res <= 0) {
+                    return (res == 0 ? -EIO : res);
+                }
+
+                b_p += res;
+                left -= res;
+                continue;
+            }
+
+            res = fill(self_p);
+
+            if (res < 0) {
+                return (res);
+            }
+
+            continue;
+        }
+
+        n = MIN(n, left);
+        memcpy(b_p, &self_p->buf_p[self_p->pos], n);
+        self_p->pos += n;
+        b_p += n;
+        left -= n;
+    }
+
+    return (size - left);
+}
+
+int chan_reader_getc(struct chan_reader_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    if (self_p->pos == self_p->length) {
+        res = fill(self_p);
+
+        if (res < 0) {
+            return (res);
+        }
+    }
+
+    return ((uint8_t)self_p->buf_p[self_p->pos++]);
+}
+
+ssize_t chan_reader_peek(struct chan_reader_t *self_p,
+                         char **buf_pp,
+                         size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_pp != NULL, EINVAL);
+    ASSERTN(size <= self_p->size, EINVAL);
+
+    ssize_t res;
+
+    while ((self_p->length - self_p->pos) < size) {
+        res = fill(self_p);
+
+        if (res < 0) {
+            return (res);
+        }
+    }
+
+    *buf_pp = &self_p->buf_p[self_p->pos];
+
+    return (self_p->length - self_p->pos);
+}
+
+ssize_t chan_reader_read_until(struct chan_reader_t *self_p,
+                               char delimiter,
+                               char **buf_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_pp != NULL, EINVAL);
+
+    char *delimiter_p;
+    size_t scanned;
+    ssize_t res;
+
+    /* Number of bytes after pos already searched for the
+       delimiter. */
+    scanned = 0;
+
+    while (1) {
+        delimiter_p = memchr(&self_p->buf_p[self_p->pos + scanned],
+                             delimiter,
+                             self_p->length - self_p->pos - scanned);
+
+        if (delimiter_p != NULL) {
+            *buf_pp = &self_p->buf_p[self_p->pos];
+            res = (delimiter_p - *buf_pp + 1);
+            self_p->pos += res;
+
+            return (res);
+        }
+
+        scanned = (self_p->length - self_p->pos);
+
+        if (scanned == self_p->size) {
+            return (-ENOMEM);
+        }
+
+        res = fill(self_p);
+
+        if (res < 0) {
+            return (res);
+        }
+    }
+}
+
+ssize_t chan_reader_readline(struct chan_reader_t *self_p,
+                             char **line_pp)
+{
+    return (chan_reader_read_until(self_p, '\n', line_pp));
+}
+
+ssize_t chan_reader_skip(struct chan_reader_t *self_p, size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    size_t left;
+    size_t n;
+    ssize_t res;
+
+    left = size;
+
+    while (left > 0) {
+        if (self_p->pos == self_p->length) {
+            res = fill(self_p);
+
+            if (res < 0) {
+                return (res);
+            }
+        }
+
+        n = MIN(self_p->length - self_p->pos, left);
+        self_p->pos += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+size_t chan_reader_buffered(struct chan_reader_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->length - self_p->pos);
+}
@@ -0,0 +1,164 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_CHAN_READER_H__
+#define __SYNC_CHAN_READER_H__
+
+#include "simba.h"
+
+/**
+ * A buffered reader of a channel. Data is read from the channel in
+ * chunks into the reader buffer, and handed to the user as pointers
+ * into the buffer, without copying.
+ *
+ * The reader is a channel itself. Reading from it returns buffered
+ * data first, writes and control operations are forwarded to the
+ * underlying channel. Pass it to code that reads from the same
+ * channel to not lose buffered data. Do not poll the reader, poll the
+ * underlying channel if `chan_reader_buffered()` returns zero(0).
+ */
+struct chan_reader_t {
+    struct chan_t base;
+    void *chan_p;
+    char *buf_p;
+    size_t size;
+    size_t pos;
+    size_t length;
+};
+
+/**
+ * Initialize given reader. Buffered data is discarded if the reader
+ * was already initialized.
+ *
+ * @param[out] self_p Reader to initialize.
+ * @param[in] chan_p Channel to read from.
+ * @param[in] buf_p Reader buffer.
+ * @param[in] size Size of the reader buffer. Also the maximum length
+ *                 of a line or peeked data.
+ *
+ * @return zero(0) or negative error code.
+ */
+int chan_reader_init(struct chan_reader_t *self_p,
+                     void *chan_p,
+                     void *buf_p,
+                     size_t size);
+
+/**
+ * Read exactly given number of bytes into given buffer.
+ *
+ * @param[in] self_p Initialized reader.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Number of bytes to read.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+ssize_t chan_reader_read(struct chan_reader_t *self_p,
+                         void *buf_p,
+                         size_t size);
+
+/**
+ * Read one character.
+ *
+ * @param[in] self_p Initialized reader.
+ *
+ * @return The read character as an unsigned char casted to an int, or
+ *         negative error code.
+ */
+int chan_reader_getc(struct chan_reader_t *self_p);
+
+/**
+ * Wait for at least given number of bytes in the reader buffer, and
+ * get a pointer to them. The data is not consumed.
+ *
+ * @param[in] self_p Initialized reader.
+ * @param[out] buf_pp Pointer to the buffered data. Valid until the
+ *                    next call on the reader.
+ * @param[in] size Minimum number of bytes. Must not be bigger than the
+ *                 reader buffer.
+ *
+ * @return Number of buffered bytes, at least given size, or negative
+ *         error code.
+ */
+ssize_t chan_reader_peek(struct chan_reader_t *self_p,
+                         char **buf_pp,
+                         size_t size);
+
+/**
+ * Read until given delimiter. The data, including the delimiter, is
+ * consumed.
+ *
+ * @param[in] self_p Initialized reader.
+ * @param[in] delimiter Delimiter to read until.
+ * @param[out] buf_pp Pointer to the data. Valid until the next call
+ *                    on the reader. It is not null terminated, but
+ *                    may be modified by the caller.
+ *
+ * @return Number of bytes, including the delimiter, -ENOMEM if the
+ *         reader buffer is full without a delimiter, or other negative
+ *         error code.
+ */
+ssize_t chan_reader_read_until(struct chan_reader_t *self_p,
+                               char delimiter,
+                               char **buf_pp);
+
+/**
+ * Read a line ending with a newline. Same as
+ * `chan_reader_read_until()` with ``'\n'`` as delimiter.
+ *
+ * @param[in] self_p Initialized reader.
+ * @param[out] line_pp Pointer to the line.
+ *
+ * @return Length of the line, including the newline, or negative
+ *         error code.
+ */
+ssize_t chan_reader_readline(struct chan_reader_t *self_p,
+                             char **line_pp);
+
+/**
+ * Skip given number of bytes.
+ *
+ * @param[in] self_p Initialized reader.
+ * @param[in] size Number of bytes to skip.
+ *
+ * @return Number of skipped bytes or negative error code.
+ */
+ssize_t chan_reader_skip(struct chan_reader_t *self_p, size_t size);
+
+/**
+ * Get the number of bytes in the reader buffer. These bytes can be
+ * read without blocking or reading from the underlying channel.
+ *
+ * @param[in] self_p Initialized reader.
+ *
+ * @return Number of buffered bytes.
+ */
+size_t chan_reader_buffered(struct chan_reader_t *self_p);
+
+#endif
@@ -77,6 +77,8 @@ int mutex_lock_isr(struct mutex_t *self_p)
         self_p->is_locked = 1;
     }
 
+    TRACE_EVENT(MUTEX_LOCK, 0, self_p);
+
     return (0);
 }
 
@@ -84,6 +86,8 @@ int mutex_unlock_isr(struct mutex_t *self_p)
 {
     struct thrd_prio_list_elem_t *elem_p;
 
+    TRACE_EVENT(MUTEX_UNLOCK, 0, self_p);
+
     elem_p = thrd_prio_list_pop_isr(&self_p->waiters);
 
     if (elem_p != NULL) {
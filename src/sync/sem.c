@@ -73,6 +73,8 @@ int sem_take(struct sem_t *self_p,
         self_p->count++;
     }
 
+    TRACE_EVENT(SEM_TAKE, err, self_p);
+
     sys_unlock();
 
     return (err);
@@ -96,6 +98,8 @@ int sem_give_isr(struct sem_t *self_p,
 {
     struct thrd_prio_list_elem_t *elem_p;
 
+    TRACE_EVENT(SEM_GIVE, count, self_p);
+
     self_p->count -= count;
 
     if (self_p->count < 0) {
@@ -0,0 +1,250 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static void copy_in(struct spsc_queue_t *self_p,
+                    size_t pos,
+                    const char *buf_p,
+                    size_t size)
+{
+    size_t offset;
+    size_t n;
+
+    offset = (pos & self_p->mask);
+    n = MIN(size, self_p->mask + 1 - offset);
+    memcpy(&self_p->buf_p[offset], buf_p, n);
+    memcpy(&self_p->buf_p[0], &buf_p[n], size - n);
+}
+
+static void copy_out(struct spsc_queue_t *self_p,
+                     size_t pos,
+                     char *buf_p,
+                     size_t size)
+{
+    size_t offset;
+    size_t n;
+
+    offset = (pos & self_p->mask);
+    n = MIN(size, self_p->mask + 1 - offset);
+    memcpy(buf_p, &self_p->buf_p[offset], n);
+    memcpy(&buf_p[n], &self_p->buf_p[0], size - n);
+}
+
+/**
+ * Resume the consumer and any polling thread. Called from isr or with
+ * the system lock taken.
+ */
+static RAM_CODE void resume_reader_isr(struct spsc_queue_t *self_p)
+{
+    if (chan_is_polled_isr(&self_p->base)) {
+        thrd_resume_isr(self_p->base.reader_p, 0);
+        self_p->base.reader_p = NULL;
+    }
+
+    if (self_p->base.reader_p != NULL) {
+        thrd_resume_isr(self_p->base.reader_p, 0);
+        self_p->base.reader_p = NULL;
+    }
+}
+
+/**
+ * Copy data into the buffer and publish it to the consumer. Given
+ * resume flag is set to true(1) if the consumer or a polling thread
+ * may be waiting for data.
+ *
+ * @return Number of written bytes.
+ */
+static RAM_CODE size_t write_buffer(struct spsc_queue_t *self_p,
+                                    const void *buf_p,
+                                    size_t size,
+                                    int *resume_p)
+{
+    size_t head;
+    size_t tail;
+    size_t n;
+    struct thrd_t *reader_p;
+
+    head = self_p->head;
+    tail = __atomic_load_n(&self_p->tail, __ATOMIC_ACQUIRE);
+    n = MIN(size, self_p->mask + 1 - (head - tail));
+    *resume_p = 0;
+
+    if (n == 0) {
+        return (0);
+    }
+
+    copy_in(self_p, head, buf_p, n);
+    __atomic_store_n(&self_p->head, head + n, __ATOMIC_SEQ_CST);
+
+    /* The queue was empty. The consumer stores itself as reader
+       before checking the head index, so either it sees the new data,
+       or it is seen here. A polled queue must be added to the ready
+       queue of its list. */
+    tail = __atomic_load_n(&self_p->tail, __ATOMIC_SEQ_CST);
+
+    if (tail == head) {
+        reader_p = __atomic_load_n(&self_p->base.reader_p, __ATOMIC_SEQ_CST);
+
+        if ((reader_p != NULL) || (self_p->base.list_p != NULL)) {
+            *resume_p = 1;
+        }
+    }
+
+    return (n);
+}
+
+int spsc_queue_init(struct spsc_queue_t *self_p,
+                    void *buf_p,
+                    size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+    ASSERTN((size & (size - 1)) == 0, EINVAL);
+
+    chan_init(&self_p->base,
+              (chan_read_fn_t)spsc_queue_read,
+              (chan_write_fn_t)spsc_queue_write,
+              (chan_size_fn_t)spsc_queue_size);
+    chan_set_write_isr_cb(&self_p->base,
+                          (chan_write_fn_t)spsc_queue_write_isr);
+    self_p->buf_p = buf_p;
+    self_p->mask = (size - 1);
+    self_p->head = 0;
+    self_p->tail = 0;
+
+    return (0);
+}
+
+ssize_t spsc_queue_read(struct spsc_queue_t *self_p,
+                        void *buf_p,
+                        size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    char *c_buf_p;
+    size_t left;
+    size_t head;
+    size_t tail;
+    size_t n;
+
+    c_buf_p = buf_p;
+    left = size;
+
+    while (1) {
+        tail = self_p->tail;
+        head = __atomic_load_n(&self_p->head, __ATOMIC_ACQUIRE);
+        n = MIN(left, head - tail);
+
+        if (n > 0) {
+            copy_out(self_p, tail, c_buf_p, n);
+            __atomic_store_n(&self_p->tail, tail + n, __ATOMIC_SEQ_CST);
+            c_buf_p += n;
+            left -= n;
+        }
+
+        if (left == 0) {
+            break;
+        }
+
+        /* The queue is empty. Wait for the producer unless it wrote
+           data after the check above. */
+        sys_lock();
+
+        __atomic_store_n(&self_p->base.reader_p,
+                         thrd_self(),
+                         __ATOMIC_SEQ_CST);
+        head = __atomic_load_n(&self_p->head, __ATOMIC_SEQ_CST);
+
+        if (head == self_p->tail) {
+            thrd_suspend_isr(NULL);
+        }
+
+        self_p->base.reader_p = NULL;
+
+        sys_unlock();
+    }
+
+    return (size);
+}
+
+ssize_t spsc_queue_write(struct spsc_queue_t *self_p,
+                         const void *buf_p,
+                         size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    size_t n;
+    int resume;
+
+    n = write_buffer(self_p, buf_p, size, &resume);
+
+    if (resume == 1) {
+        sys_lock();
+        resume_reader_isr(self_p);
+        sys_unlock();
+    }
+
+    return (n);
+}
+
+RAM_CODE ssize_t spsc_queue_write_isr(struct spsc_queue_t *self_p,
+                                      const void *buf_p,
+                                      size_t size)
+{
+    size_t n;
+    int resume;
+
+    n = write_buffer(self_p, buf_p, size, &resume);
+
+    if (resume == 1) {
+        resume_reader_isr(self_p);
+    }
+
+    return (n);
+}
+
+size_t spsc_queue_size(struct spsc_queue_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (__atomic_load_n(&self_p->head, __ATOMIC_ACQUIRE)
+            - __atomic_load_n(&self_p->tail, __ATOMIC_ACQUIRE));
+}
+
+size_t spsc_queue_unused_size(struct spsc_queue_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->mask + 1 - spsc_queue_size(self_p));
+}
@@ -40,10 +40,178 @@ int configfile_init(struct configfile_t *self_p,
 
     self_p->buf_p = buf_p;
     self_p->size = size;
+    self_p->index.properties_p = NULL;
+    self_p->index.length = 0;
 
     return (0);
 }
 
+static uint32_t hash_property(const char *section_p, const char *name_p)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+
+    while (*section_p != '\0') {
+        hash ^= (uint8_t)*section_p++;
+        hash *= 16777619UL;
+    }
+
+    /* Separate the section and property names. */
+    hash *= 16777619UL;
+
+    while (*name_p != '\0') {
+        hash ^= (uint8_t)*name_p++;
+        hash *= 16777619UL;
+    }
+
+    return (hash);
+}
+
+static struct configfile_property_t *find_property(struct configfile_t *self_p,
+                                                   const char *section_p,
+                                                   const char *property_p)
+{
+    struct configfile_property_t *properties_p;
+    struct configfile_property_t *entry_p;
+    uint32_t hash;
+    int i;
+
+    properties_p = self_p->index.properties_p;
+    hash = hash_property(section_p, property_p);
+    i = properties_p[hash % self_p->index.length].first;
+
+    while (i != -1) {
+        entry_p = &properties_p[i];
+
+        if ((entry_p->hash == hash)
+            && (strcmp(entry_p->name_p, property_p) == 0)
+            && (strcmp(entry_p->section_p, section_p) == 0)) {
+            return (entry_p);
+        }
+
+        i = entry_p->next;
+    }
+
+    return (NULL);
+}
+
+int configfile_index(struct configfile_t *self_p,
+                     struct configfile_property_t *properties_p,
+                     int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(properties_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    struct configfile_property_t *entry_p;
+    char *buf_p;
+    char *line_p;
+    char *end_p;
+    char *separator_p;
+    const char *section_p;
+    int count;
+    int res;
+    int i;
+
+    buf_p = self_p->buf_p;
+    section_p = NULL;
+    count = 0;
+    res = 0;
+
+    /* Only lines terminated by a newline are parsed, as in
+       configfile_get(). */
+    while ((end_p = strchr(buf_p, '\n')) != NULL) {
+        *end_p = '\0';
+        line_p = std_strip(buf_p, NULL);
+        buf_p = (end_p + 1);
+
+        if ((*line_p == '\0') || (*line_p == '#') || (*line_p == ';')) {
+            /* Empty or commented line. */
+        } else if (*line_p == '[') {
+            /* Section. */
+            line_p++;
+            end_p = strchr(line_p, ']');
+
+            if (end_p != NULL) {
+                *end_p = '\0';
+            }
+
+            section_p = line_p;
+        } else if (section_p != NULL) {
+            /* Property. */
+            separator_p = strpbrk(line_p, ":=");
+
+            if (separator_p == NULL) {
+                continue;
+            }
+
+            if (count == length) {
+                res = -ENOMEM;
+                break;
+            }
+
+            *separator_p = '\0';
+            entry_p = &properties_p[count];
+            entry_p->section_p = section_p;
+            entry_p->name_p = std_strip(line_p, NULL);
+            entry_p->value_p = std_strip(separator_p + 1, NULL);
+            entry_p->hash = hash_property(section_p, entry_p->name_p);
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        return (res);
+    }
+
+    /* Chain the properties into count hash buckets. Insert them in
+       reverse order so the first of any duplicates is found. */
+    for (i = 0; i < count; i++) {
+        properties_p[i].first = -1;
+    }
+
+    for (i = count - 1; i >= 0; i--) {
+        entry_p = &properties_p[properties_p[i].hash % count];
+        properties_p[i].next = entry_p->first;
+        entry_p->first = i;
+    }
+
+    self_p->index.properties_p = properties_p;
+    self_p->index.length = count;
+
+    return (res == 0 ? count : res);
+}
+
+struct configfile_property_t *configfile_get_next(struct configfile_t *self_p,
+                                                  const char *section_p,
+                                                  struct configfile_property_t *property_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(section_p != NULL, EINVAL);
+
+    struct configfile_property_t *end_p;
+
+    end_p = &self_p->index.properties_p[self_p->index.length];
+
+    if (property_p == NULL) {
+        property_p = self_p->index.properties_p;
+    } else {
+        property_p++;
+    }
+
+    while (property_p < end_p) {
+        if ((property_p->section_p == section_p)
+            || (strcmp(property_p->section_p, section_p) == 0)) {
+            return (property_p);
+        }
+
+        property_p++;
+    }
+
+    return (NULL);
+}
+
 int configfile_set(struct configfile_t *self_p,
                    const char *section_p,
                    const char *property_p,
@@ -71,6 +239,17 @@ char *configfile_get(struct configfile_t *self_p,
     int first_length;
     int section_end_found;
     char *buf_p, *first_p;
+    struct configfile_property_t *entry_p;
+
+    if (self_p->index.length > 0) {
+        entry_p = find_property(self_p, section_p, property_p);
+
+        if ((entry_p == NULL) || (strlen(entry_p->value_p) >= length)) {
+            return (NULL);
+        }
+
+        return (strcpy(value_p, entry_p->value_p));
+    }
 
     in_correct_section = 0;
     buf_p = self_p->buf_p;
@@ -202,6 +381,31 @@ char *configfile_get(struct configfile_t *self_p,
     return (NULL);
 }
 
+/**
+ * Get given property value from the index, or copy it to given buffer
+ * if the configuration file is not indexed.
+ */
+static const char *get_value(struct configfile_t *self_p,
+                             const char *section_p,
+                             const char *property_p,
+                             char *buf_p,
+                             int length)
+{
+    struct configfile_property_t *entry_p;
+
+    if (self_p->index.length == 0) {
+        return (configfile_get(self_p, section_p, property_p, buf_p, length));
+    }
+
+    entry_p = find_property(self_p, section_p, property_p);
+
+    if (entry_p == NULL) {
+        return (NULL);
+    }
+
+    return (entry_p->value_p);
+}
+
 int configfile_get_long(struct configfile_t *self_p,
                         const char *section_p,
                         const char *property_p,
@@ -209,14 +413,17 @@ int configfile_get_long(struct configfile_t *self_p,
 {
     char buf[16];
     const char *next_p;
+    const char *string_p;
 
     /* Get the property value as a string. */
-    if (configfile_get(self_p, section_p, property_p, buf, sizeof(buf)) == NULL) {
+    string_p = get_value(self_p, section_p, property_p, buf, sizeof(buf));
+
+    if (string_p == NULL) {
         return (-1);
     }
 
     /* Convert the property value string to a long. */
-    next_p = std_strtol(buf, value_p);
+    next_p = std_strtol(string_p, value_p);
 
     if ((next_p == NULL) || (*next_p != '\0')) {
         return (-1);
@@ -232,15 +439,18 @@ int configfile_get_float(struct configfile_t *self_p,
 {
     char buf[32];
     const char *next_p;
+    const char *string_p;
     double value;
 
     /* Get the property value as a string. */
-    if (configfile_get(self_p, section_p, property_p, buf, sizeof(buf)) == NULL) {
+    string_p = get_value(self_p, section_p, property_p, buf, sizeof(buf));
+
+    if (string_p == NULL) {
         return (-1);
     }
 
     /* Convert the property value string to a float. */
-    next_p = std_strtod(buf, &value);
+    next_p = std_strtod(string_p, &value);
     *value_p = value;
 
     if ((next_p == NULL) || (*next_p != '\0')) {
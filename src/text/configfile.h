@@ -33,9 +33,30 @@
 
 #include "simba.h"
 
+/**
+ * A property in the configuration file index.
+ */
+struct configfile_property_t {
+    /** Section name. */
+    const char *section_p;
+    /** Property name. */
+    const char *name_p;
+    /** Property value. */
+    const char *value_p;
+    uint32_t hash;
+    /* First property in the hash bucket of this index. */
+    int first;
+    /* Next property in the same hash bucket. */
+    int next;
+};
+
 struct configfile_t {
     char *buf_p;
     size_t size;
+    struct {
+        struct configfile_property_t *properties_p;
+        int length;
+    } index;
 };
 
 /**
@@ -52,6 +73,42 @@ int configfile_init(struct configfile_t *self_p,
                     char *buf_p,
                     size_t size);
 
+/**
+ * Parse the configuration file once and index all its properties by
+ * section and name. All get functions use the index after this
+ * function has been called, instead of parsing the configuration
+ * file on every call.
+ *
+ * The configuration file contents is modified, as section names,
+ * property names and values are null terminated in place.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[out] properties_p Array to store the indexed properties in.
+ * @param[in] length Length of the properties array.
+ *
+ * @return Number of indexed properties, or negative error code. On
+ *         -ENOMEM only the first ``length`` properties are indexed.
+ */
+int configfile_index(struct configfile_t *self_p,
+                     struct configfile_property_t *properties_p,
+                     int length);
+
+/**
+ * Get the next indexed property in given section. The properties are
+ * returned in the order they appear in the configuration file.
+ *
+ * @param[in] self_p Indexed parser.
+ * @param[in] section_p Section to iterate.
+ * @param[in] property_p Previous property, or NULL to get the first
+ *                       property in the section.
+ *
+ * @return Next property in given section, or NULL if there are no
+ *         more properties.
+ */
+struct configfile_property_t *configfile_get_next(struct configfile_t *self_p,
+                                                  const char *section_p,
+                                                  struct configfile_property_t *property_p);
+
 /**
  * Set the value of given property in given section.
  *
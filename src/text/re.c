@@ -164,6 +164,28 @@ enum op_code_t {
 
 #define NON_GREEDY_OFFSET                 3
 
+/* The compiled pattern contains an automaton. Stored in the flags
+   byte. */
+#define FLAGS_AUTOMATON                0x80
+
+/* Maximum number of positions in an automaton. One bit in the state
+   is used as the accept bit. */
+#define AUTOMATON_POSITIONS_MAX          31
+
+/* Maximum length of the literal prefix and the required literal. */
+#define AUTOMATON_LITERAL_MAX            15
+
+/* Automaton header layout. */
+#define AUTOMATON_ACCEPT                  0
+#define AUTOMATON_PREFIX_SIZE             1
+#define AUTOMATON_LITERAL_SIZE            2
+#define AUTOMATON_LITERAL_OFFSET          3
+#define AUTOMATON_LOOP                    4
+#define AUTOMATON_OPTIONAL                8
+#define AUTOMATON_INITIAL                12
+#define AUTOMATON_HEADER_SIZE            16
+#define AUTOMATON_CLASS_MAP_SIZE        256
+
 struct compile_t {
     char *compiled_p;
     const char *pattern_p;
@@ -181,6 +203,22 @@ struct match_t {
     size_t *number_of_groups_p;
 };
 
+#if CONFIG_RE_AUTOMATON == 1
+
+/**
+ * A pattern of single character atoms, each matched once, optionally,
+ * or repeatedly. Each atom is one position in the bit-parallel
+ * automaton.
+ */
+struct automaton_t {
+    const char *atoms[AUTOMATON_POSITIONS_MAX];
+    uint32_t loop;
+    uint32_t optional;
+    int length;
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
 #if CONFIG_RE_DEBUG_LOG_MASK > -1
@@ -558,6 +596,48 @@ static int compile_return(struct compile_t *self_p)
     return (0);
 }
 
+#if CONFIG_RE_AUTOMATON == 1
+
+static int automaton_compile(char *automaton_p,
+                             const char *code_p,
+                             char flags,
+                             size_t left);
+
+/**
+ * Compile an automaton after the op codes if the pattern is supported
+ * and the automaton fits in the compile buffer. The op codes are moved
+ * to make room for the automaton offset.
+ */
+static void compile_automaton(struct compile_t *self_p)
+{
+    char *begin_p;
+    size_t code_size;
+    int res;
+
+    begin_p = self_p->compiled_begin_p;
+    code_size = (self_p->compiled_p - &begin_p[1]);
+
+    if (self_p->compiled_left < 2) {
+        return;
+    }
+
+    res = automaton_compile(&self_p->compiled_p[2],
+                            &begin_p[1],
+                            begin_p[0],
+                            self_p->compiled_left - 2);
+
+    if (res < 0) {
+        return;
+    }
+
+    memmove(&begin_p[3], &begin_p[1], code_size);
+    begin_p[0] |= FLAGS_AUTOMATON;
+    begin_p[1] = (((code_size + 3) >> 8) & 0xff);
+    begin_p[2] = ((code_size + 3) & 0xff);
+}
+
+#endif
+
 static int compile_text(struct compile_t *self_p)
 {
     if (self_p->compiled_left < 1) {
@@ -916,7 +996,7 @@ static int match_set(struct match_t *self_p)
     self_p->compiled_p += 2;
     compiled_end_p = (self_p->compiled_p + code_size);
 
-    while (*self_p->compiled_p != OP_CODE_RETURN) {
+    while (self_p->compiled_p < compiled_end_p) {
         if (*self_p->compiled_p++ == OP_CODE_SET_SINGLE) {
             switch (*self_p->compiled_p++) {
 
@@ -1062,6 +1142,518 @@ static ssize_t match(struct match_t *self_p)
     }
 }
 
+#if CONFIG_RE_AUTOMATON == 1
+
+/**
+ * @return Size of the atom op code at given position, or negative
+ *         error code if it is not a single character atom.
+ */
+static int automaton_atom_size(const char *code_p)
+{
+    switch (code_p[0]) {
+
+    case OP_CODE_TEXT:
+        return (2);
+
+    case OP_CODE_DOT:
+    case OP_CODE_WHITESPACE:
+    case OP_CODE_DECIMAL_DIGIT:
+    case OP_CODE_ALPHANUMERIC:
+        return (1);
+
+    case OP_CODE_SET:
+        return (3 + (((uint8_t)code_p[1] << 8) | (uint8_t)code_p[2]));
+
+    default:
+        return (-1);
+    }
+}
+
+/**
+ * @return true(1) if given character is matched by given atom,
+ *         otherwise false(0).
+ */
+static int automaton_atom_match(const char *atom_p, char flags, char c)
+{
+    struct match_t state;
+    int res;
+
+    state.compiled_p = &atom_p[1];
+    state.flags = flags;
+    state.buf_p = &c;
+    state.buf_left = 1;
+    state.groups_p = NULL;
+    state.number_of_groups_p = NULL;
+
+    switch (atom_p[0]) {
+
+    case OP_CODE_TEXT:
+        res = match_text(&state);
+        break;
+
+    case OP_CODE_DOT:
+        res = match_dot(&state);
+        break;
+
+    case OP_CODE_WHITESPACE:
+        res = match_whitespace(&state);
+        break;
+
+    case OP_CODE_DECIMAL_DIGIT:
+        res = match_decimal_digit(&state);
+        break;
+
+    case OP_CODE_ALPHANUMERIC:
+        res = match_alphanumeric(&state);
+        break;
+
+    default:
+        res = match_set(&state);
+        break;
+    }
+
+    return (res == 1);
+}
+
+static int automaton_add(struct automaton_t *self_p,
+                         const char *atom_p,
+                         int loop,
+                         int optional)
+{
+    if (self_p->length == AUTOMATON_POSITIONS_MAX) {
+        return (-1);
+    }
+
+    self_p->atoms[self_p->length] = atom_p;
+
+    if (loop == 1) {
+        self_p->loop |= (1UL << self_p->length);
+    }
+
+    if (optional == 1) {
+        self_p->optional |= (1UL << self_p->length);
+    }
+
+    self_p->length++;
+
+    return (0);
+}
+
+/**
+ * Parse given compiled op codes into automaton positions. Only
+ * patterns of single character atoms with greedy repetitions are
+ * accepted, as the longest match is then equal to the backtracking
+ * match. Everything else is left to the interpreter.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int automaton_parse(struct automaton_t *self_p,
+                           const char *code_p)
+{
+    int res;
+    int size;
+    int code_size;
+    int members;
+    int op_code;
+    const char *atom_p;
+
+    self_p->loop = 0;
+    self_p->optional = 0;
+    self_p->length = 0;
+
+    while (1) {
+        op_code = code_p[0];
+
+        if (op_code == OP_CODE_RETURN) {
+            return (0);
+        }
+
+        size = automaton_atom_size(code_p);
+
+        if (size > 0) {
+            res = automaton_add(self_p, code_p, 0, 0);
+            code_p += size;
+        } else {
+            code_size = (((uint8_t)code_p[1] << 8) | (uint8_t)code_p[2]);
+
+            switch (op_code) {
+
+            case OP_CODE_ZERO_OR_ONE:
+                atom_p = &code_p[3];
+
+                if (automaton_atom_size(atom_p) != code_size) {
+                    return (-1);
+                }
+
+                res = automaton_add(self_p, atom_p, 0, 1);
+                code_p += (3 + code_size);
+                break;
+
+            case OP_CODE_ZERO_OR_MORE:
+            case OP_CODE_ONE_OR_MORE:
+                atom_p = &code_p[3];
+                size = automaton_atom_size(atom_p);
+
+                if ((size != code_size - 1)
+                    || (atom_p[size] != OP_CODE_RETURN)) {
+                    return (-1);
+                }
+
+                res = automaton_add(self_p,
+                                    atom_p,
+                                    1,
+                                    op_code == OP_CODE_ZERO_OR_MORE);
+                code_p += (3 + code_size);
+                break;
+
+            case OP_CODE_MEMBERS:
+                members = (((uint8_t)code_p[3] << 8) | (uint8_t)code_p[4]);
+                atom_p = &code_p[5];
+                size = automaton_atom_size(atom_p);
+
+                if ((size != code_size - 1)
+                    || (atom_p[size] != OP_CODE_RETURN)) {
+                    return (-1);
+                }
+
+                res = 0;
+
+                while ((members > 0) && (res == 0)) {
+                    res = automaton_add(self_p, atom_p, 0, 0);
+                    members--;
+                }
+
+                code_p += (5 + code_size);
+                break;
+
+            default:
+                /* Anchors, non-greedy repetitions, alternatives and
+                   groups are not supported. */
+                return (-1);
+            }
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+}
+
+/**
+ * Add positions reachable by skipping optional positions to given
+ * state.
+ */
+static uint32_t automaton_closure(uint32_t state, uint32_t optional)
+{
+    uint32_t next;
+
+    while (1) {
+        next = (state | ((state & optional) << 1));
+
+        if (next == state) {
+            return (state);
+        }
+
+        state = next;
+    }
+}
+
+static int is_mandatory_text(struct automaton_t *self_p,
+                             int position)
+{
+    return ((self_p->atoms[position][0] == OP_CODE_TEXT)
+            && !((self_p->loop | self_p->optional) & (1UL << position)));
+}
+
+/**
+ * Write the literal prefix and the longest required literal to given
+ * automaton header. Case-insensitive patterns have no literals.
+ *
+ * @return Number of bytes written after the header, or negative error
+ *         code.
+ */
+static int automaton_compile_literals(struct automaton_t *self_p,
+                                      char *automaton_p,
+                                      char flags,
+                                      size_t left)
+{
+    int i;
+    int prefix_size;
+    int offset;
+    int begin;
+    int literal_begin;
+    int literal_size;
+    int literal_offset;
+    char *buf_p;
+
+    prefix_size = 0;
+    literal_size = 0;
+    literal_begin = 0;
+    literal_offset = 0;
+
+    if (!(flags & RE_IGNORECASE)) {
+        while ((prefix_size < self_p->length)
+               && (prefix_size < AUTOMATON_LITERAL_MAX)
+               && is_mandatory_text(self_p, prefix_size)) {
+            prefix_size++;
+        }
+
+        /* Find the longest run of mandatory characters after the
+           prefix. */
+        offset = prefix_size;
+        i = prefix_size;
+
+        while (i < self_p->length) {
+            if (!is_mandatory_text(self_p, i)) {
+                if (!(self_p->optional & (1UL << i))) {
+                    offset++;
+                }
+
+                i++;
+                continue;
+            }
+
+            begin = i;
+
+            while ((i < self_p->length)
+                   && (i - begin < AUTOMATON_LITERAL_MAX)
+                   && is_mandatory_text(self_p, i)) {
+                i++;
+            }
+
+            if (i - begin > literal_size) {
+                literal_begin = begin;
+                literal_size = (i - begin);
+                literal_offset = offset;
+            }
+
+            offset += (i - begin);
+        }
+    }
+
+    if ((size_t)(prefix_size + literal_size) > left) {
+        return (-1);
+    }
+
+    automaton_p[AUTOMATON_PREFIX_SIZE] = prefix_size;
+    automaton_p[AUTOMATON_LITERAL_SIZE] = literal_size;
+    automaton_p[AUTOMATON_LITERAL_OFFSET] = literal_offset;
+    buf_p = &automaton_p[AUTOMATON_HEADER_SIZE];
+
+    for (i = 0; i < prefix_size; i++) {
+        *buf_p++ = self_p->atoms[i][1];
+    }
+
+    for (i = 0; i < literal_size; i++) {
+        *buf_p++ = self_p->atoms[literal_begin + i][1];
+    }
+
+    return (prefix_size + literal_size);
+}
+
+/**
+ * Compile the automaton of given op codes to given buffer. The
+ * character classes are stored as a map from character to class
+ * index, followed by one position mask per class.
+ *
+ * @return Size of the automaton, or negative error code.
+ */
+static int automaton_compile(char *automaton_p,
+                             const char *code_p,
+                             char flags,
+                             size_t left)
+{
+    struct automaton_t automaton;
+    int res;
+    int i;
+    int c;
+    int number_of_classes;
+    uint8_t *map_p;
+    char *masks_p;
+    uint32_t mask;
+    uint32_t initial;
+    size_t size;
+
+    if (automaton_parse(&automaton, code_p) != 0) {
+        return (-1);
+    }
+
+    if (left < AUTOMATON_HEADER_SIZE) {
+        return (-1);
+    }
+
+    res = automaton_compile_literals(&automaton,
+                                     automaton_p,
+                                     flags,
+                                     left - AUTOMATON_HEADER_SIZE);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    size = (AUTOMATON_HEADER_SIZE + res + AUTOMATON_CLASS_MAP_SIZE);
+
+    if (size > left) {
+        return (-1);
+    }
+
+    initial = automaton_closure(1UL << automaton_p[AUTOMATON_PREFIX_SIZE],
+                                automaton.optional);
+    automaton_p[AUTOMATON_ACCEPT] = automaton.length;
+    memcpy(&automaton_p[AUTOMATON_LOOP], &automaton.loop, 4);
+    memcpy(&automaton_p[AUTOMATON_OPTIONAL], &automaton.optional, 4);
+    memcpy(&automaton_p[AUTOMATON_INITIAL], &initial, 4);
+
+    map_p = (uint8_t *)&automaton_p[size - AUTOMATON_CLASS_MAP_SIZE];
+    masks_p = &automaton_p[size];
+    number_of_classes = 0;
+
+    for (c = 0; c < 256; c++) {
+        mask = 0;
+
+        for (i = 0; i < automaton.length; i++) {
+            if (automaton_atom_match(automaton.atoms[i], flags, c)) {
+                mask |= (1UL << i);
+            }
+        }
+
+        for (i = 0; i < number_of_classes; i++) {
+            if (memcmp(&masks_p[4 * i], &mask, 4) == 0) {
+                break;
+            }
+        }
+
+        if (i == number_of_classes) {
+            if ((i == 256) || (size + 4 > left)) {
+                return (-1);
+            }
+
+            memcpy(&masks_p[4 * i], &mask, 4);
+            number_of_classes++;
+            size += 4;
+        }
+
+        map_p[c] = i;
+    }
+
+    return (size);
+}
+
+/**
+ * @return true(1) if given literal is found in given buffer,
+ *         otherwise false(0).
+ */
+static int automaton_find_literal(const char *buf_p,
+                                  size_t size,
+                                  const char *literal_p,
+                                  size_t literal_size)
+{
+    const char *end_p;
+
+    if (size < literal_size) {
+        return (0);
+    }
+
+    end_p = &buf_p[size - literal_size + 1];
+
+    while (buf_p < end_p) {
+        buf_p = memchr(buf_p, literal_p[0], end_p - buf_p);
+
+        if (buf_p == NULL) {
+            return (0);
+        }
+
+        if (memcmp(buf_p, literal_p, literal_size) == 0) {
+            return (1);
+        }
+
+        buf_p++;
+    }
+
+    return (0);
+}
+
+/**
+ * Longest match from the beginning of given buffer using given
+ * automaton. Runs in linear time.
+ */
+static ssize_t automaton_match(const char *automaton_p,
+                               const char *buf_p,
+                               size_t size)
+{
+    const char *prefix_p;
+    const uint8_t *map_p;
+    const char *masks_p;
+    uint32_t accept;
+    uint32_t loop;
+    uint32_t optional;
+    uint32_t state;
+    uint32_t mask;
+    size_t prefix_size;
+    size_t literal_size;
+    size_t literal_offset;
+    size_t i;
+    ssize_t matched_size;
+
+    prefix_size = (uint8_t)automaton_p[AUTOMATON_PREFIX_SIZE];
+    literal_size = (uint8_t)automaton_p[AUTOMATON_LITERAL_SIZE];
+    literal_offset = (uint8_t)automaton_p[AUTOMATON_LITERAL_OFFSET];
+    prefix_p = &automaton_p[AUTOMATON_HEADER_SIZE];
+
+    /* Reject quickly on the literals. */
+    if (size < prefix_size) {
+        return (-1);
+    }
+
+    if (memcmp(buf_p, prefix_p, prefix_size) != 0) {
+        return (-1);
+    }
+
+    if (literal_size > 0) {
+        if (size < literal_offset) {
+            return (-1);
+        }
+
+        if (!automaton_find_literal(&buf_p[literal_offset],
+                                    size - literal_offset,
+                                    &prefix_p[prefix_size],
+                                    literal_size)) {
+            return (-1);
+        }
+    }
+
+    map_p = (const uint8_t *)&prefix_p[prefix_size + literal_size];
+    masks_p = (const char *)&map_p[AUTOMATON_CLASS_MAP_SIZE];
+    accept = (1UL << automaton_p[AUTOMATON_ACCEPT]);
+    memcpy(&loop, &automaton_p[AUTOMATON_LOOP], 4);
+    memcpy(&optional, &automaton_p[AUTOMATON_OPTIONAL], 4);
+    memcpy(&state, &automaton_p[AUTOMATON_INITIAL], 4);
+    matched_size = -1;
+
+    if (state & accept) {
+        matched_size = prefix_size;
+    }
+
+    for (i = prefix_size; i < size; i++) {
+        memcpy(&mask, &masks_p[4 * map_p[(uint8_t)buf_p[i]]], 4);
+        state &= mask;
+
+        if (state == 0) {
+            break;
+        }
+
+        state = ((state & loop) | automaton_closure(state << 1, optional));
+
+        if (state & accept) {
+            matched_size = (i + 1);
+        }
+    }
+
+    return (matched_size);
+}
+
+#endif
+
 int re_module_init()
 {
     if (module.initialized == 1) {
@@ -1159,6 +1751,9 @@ char *re_compile(char *compiled_p,
 
         case '\0':
             compile_return(&state);
+#if CONFIG_RE_AUTOMATON == 1
+            compile_automaton(&state);
+#endif
             return (state.compiled_begin_p);
 
         default:
@@ -1180,6 +1775,15 @@ ssize_t re_match(const char *compiled_p,
 {
     struct match_t state;
 
+#if CONFIG_RE_AUTOMATON == 1
+    if (compiled_p[0] & FLAGS_AUTOMATON) {
+        return (automaton_match(&compiled_p[(((uint8_t)compiled_p[1] << 8)
+                                             | (uint8_t)compiled_p[2])],
+                                buf_p,
+                                size));
+    }
+#endif
+
     /* Initialize the match state. */
     state.compiled_p = &compiled_p[1];
     state.flags = compiled_p[0];
@@ -97,6 +97,13 @@ int re_module_init(void);
  * - ``\\w``   - Alphanumerical characters ``[a-ZA-Z0-9_]``.
  * - ``\\s``   - Whitespace characters ``[ \t\r\n\f\v]``.
  *
+ * Patterns of single characters, sets and greedy repetitions are
+ * also compiled to a bit-parallel automaton that matches in linear
+ * time, if it fits in the compiled buffer. The automaton needs 272
+ * bytes, plus the literals and four bytes per distinct character
+ * class. Other patterns, and patterns whose automaton does not fit,
+ * are matched by a backtracking interpreter.
+ *
  * @param[out] compiled_p Compiled regular expression pattern.
  * @param[in] pattern_p Regular expression pattern.
  * @param[in] flags A combination of the flags ``RE_IGNORECASE``,
@@ -49,6 +49,8 @@ struct snprintf_output_t {
     size_t size_max;
 };
 
+typedef void (*std_write_t)(const char *buf_p, size_t size, void *arg_p);
+
 static char *skipwhite(const char *q_p)
 {
     char *p_p = (char *)q_p;
@@ -78,45 +80,59 @@ static int char_in_string(char c, const char *str_p)
 }
 
 /**
- * Put characters to buffer.
+ * Write given span to buffer.
  */
-static void sprintf_putc(char c, void *arg_p)
+static void sprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     char **dst_pp = arg_p;
 
-    *(*dst_pp)++ = c;
+    memcpy(*dst_pp, buf_p, size);
+    *dst_pp += size;
 }
 
 /**
- * Put characters to buffer.
+ * Write given span to buffer, truncating at the buffer end.
  */
-static void snprintf_putc(char c, void *arg_p)
+static void snprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     struct snprintf_output_t *output_p;
+    size_t left;
 
     output_p = arg_p;
 
     if (output_p->size < output_p->size_max) {
-        output_p->dst_p[output_p->size] = c;
+        left = (output_p->size_max - output_p->size);
+        memcpy(&output_p->dst_p[output_p->size], buf_p, MIN(size, left));
     }
 
-    output_p->size++;
+    output_p->size += size;
 }
 
 /**
- * Put characters to standard output.
+ * Write given span to standard output. Spans that do not fit in the
+ * output buffer are written directly to the channel.
  */
-static void fprintf_putc(char c, void *arg_p)
+static void fprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     struct buffered_output_t *output_p = arg_p;
 
-    output_p->buffer[output_p->pos++] = c;
-    output_p->size++;
+    output_p->size += size;
 
-    if (output_p->pos == membersof(output_p->buffer)) {
-        chan_write(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+    if (output_p->pos + size > membersof(output_p->buffer)) {
+        if (output_p->pos > 0) {
+            chan_write(output_p->chan_p, output_p->buffer, output_p->pos);
+            output_p->pos = 0;
+        }
+
+        if (size >= membersof(output_p->buffer)) {
+            chan_write(output_p->chan_p, buf_p, size);
+
+            return;
+        }
     }
+
+    memcpy(&output_p->buffer[output_p->pos], buf_p, size);
+    output_p->pos += size;
 }
 
 /**
@@ -131,20 +147,30 @@ static void output_flush(struct buffered_output_t *output_p)
 }
 
 /**
- * Put characters to standard output from interrupt context or with
+ * Write given span to standard output from interrupt context or with
  * the system lock taken.
  */
-static void fprintf_putc_isr(char c, void *arg_p)
+static void fprintf_write_isr(const char *buf_p, size_t size, void *arg_p)
 {
     struct buffered_output_t *output_p = arg_p;
 
-    output_p->buffer[output_p->pos++] = c;
-    output_p->size++;
+    output_p->size += size;
 
-    if (output_p->pos == membersof(output_p->buffer)) {
-        chan_write_isr(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+    if (output_p->pos + size > membersof(output_p->buffer)) {
+        if (output_p->pos > 0) {
+            chan_write_isr(output_p->chan_p, output_p->buffer, output_p->pos);
+            output_p->pos = 0;
+        }
+
+        if (size >= membersof(output_p->buffer)) {
+            chan_write_isr(output_p->chan_p, buf_p, size);
+
+            return;
+        }
     }
+
+    memcpy(&output_p->buffer[output_p->pos], buf_p, size);
+    output_p->pos += size;
 }
 
 /**
@@ -158,43 +184,72 @@ static void output_flush_isr(struct buffered_output_t *output_p)
     }
 }
 
-static void formats(void (*std_putc)(char c, void *arg_p),
+static void write_padding(std_write_t std_write,
+                          void *arg_p,
+                          char c,
+                          int width)
+{
+    static const char spaces[] = "                ";
+    static const char zeros[] = "0000000000000000";
+    const char *padding_p;
+    int size;
+
+    padding_p = ((c == '0') ? &zeros[0] : &spaces[0]);
+
+    while (width > 0) {
+        size = MIN(width, sizeof(spaces) - 1);
+        std_write(padding_p, size, arg_p);
+        width -= size;
+    }
+}
+
+static void formats(std_write_t std_write,
                     void *arg_p,
                     char *str_p,
                     char flags,
                     int width,
                     char negative_sign)
 {
-    char *s_p = str_p;
+    size_t size;
 
-    while (*s_p++ != '\0') {
-        width--;
-    }
+    size = strlen(str_p);
+    width -= size;
 
     /* Right justification. */
     if (flags != '-') {
         if ((negative_sign == 1) && (flags == '0')) {
-            std_putc(*str_p++, arg_p);
+            std_write(str_p++, 1, arg_p);
+            size--;
         }
 
-        while (width > 0) {
-            std_putc(flags, arg_p);
-            width--;
-        }
+        write_padding(std_write, arg_p, flags, width);
     }
 
     /* Number */
-    while (*str_p != '\0') {
-        std_putc(*str_p++, arg_p);
-    }
+    std_write(str_p, size, arg_p);
 
     /* Left justification. */
-    while (width > 0) {
-        std_putc(' ', arg_p);
-        width--;
+    if (flags == '-') {
+        write_padding(std_write, arg_p, ' ', width);
     }
 }
 
+/**
+ * Two decimal digits per entry, used to format integers two digits
+ * per division.
+ */
+static FAR const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 static char *formati(char c,
                      char *str_p,
                      char radix,
@@ -204,6 +259,7 @@ static char *formati(char c,
 {
     unsigned long value;
     char digit;
+    int i;
 
     /* Get argument. */
     if (length == 0) {
@@ -224,14 +280,31 @@ static char *formati(char c,
     }
 
     /* Format number into buffer. */
-    do {
-        digit = (char)(value % radix);
-        value /= radix;
-        if (digit > 9) {
-            digit += 39;
+    if (radix == 10) {
+        while (value >= 100) {
+            i = (2 * (value % 100));
+            value /= 100;
+            *--str_p = digit_pairs[i + 1];
+            *--str_p = digit_pairs[i];
         }
-        *--str_p = ('0' + digit);
-    } while (value > 0);
+
+        if (value >= 10) {
+            i = (2 * value);
+            *--str_p = digit_pairs[i + 1];
+            *--str_p = digit_pairs[i];
+        } else {
+            *--str_p = ('0' + value);
+        }
+    } else {
+        do {
+            digit = (char)(value % radix);
+            value /= radix;
+            if (digit > 9) {
+                digit += 39;
+            }
+            *--str_p = ('0' + digit);
+        } while (value > 0);
+    }
 
     if (*negative_sign_p == 1) {
         *--str_p = '-';
@@ -301,127 +374,248 @@ static char *formatf(char c,
 
 #endif
 
-static void vcprintf(void (*std_putc)(char c, void *arg_p),
-                     void *arg_p,
-                     far_string_t fmt_p,
-                     va_list *ap_p)
+/**
+ * Write the literal span starting at given format string position, up
+ * to the next conversion or the end of the format string.
+ */
+static far_string_t write_literal(std_write_t std_write,
+                                  void *arg_p,
+                                  far_string_t fmt_p)
 {
-    char c, flags, length, negative_sign, buf[VALUE_BUF_MAX], *s_p;
-    int width;
+    far_string_t begin_p;
 
-    buf[sizeof(buf) - 1] = '\0';
+    begin_p = fmt_p;
 
-    while ((c = *fmt_p++) != '\0') {
-        if (c != '%') {
-            std_putc(c, arg_p);
-            continue;
-        }
+    while ((*fmt_p != '%') && (*fmt_p != '\0')) {
+        fmt_p++;
+    }
 
-        /* Prototype: %[flags][width][length]specifier  */
+    if (fmt_p == begin_p) {
+        return (fmt_p);
+    }
 
-        /* Parse the flags. */
-        flags = ' ';
-        c = *fmt_p++;
+#if defined(FAR_SPECIAL_ADDRESS)
+    {
+        char buf[16];
+        size_t size;
 
-        if ((c == '0') || (c == '-')) {
-            flags = c;
-            c = *fmt_p++;
-        }
+        while (begin_p < fmt_p) {
+            size = 0;
 
-        /* Parse the width. */
-        width = 0;
+            while ((begin_p < fmt_p) && (size < sizeof(buf))) {
+                buf[size++] = *begin_p++;
+            }
 
-        while ((c >= '0') && (c <= '9')) {
-            width *= 10;
-            width += (c - '0');
-            c = *fmt_p++;
+            std_write(&buf[0], size, arg_p);
         }
+    }
+#else
+    std_write(begin_p, fmt_p - begin_p, arg_p);
+#endif
 
-        /* Parse the length. */
-        length = 0;
-
-        if (c == 'l') {
-            length = 1;
-            c = *fmt_p++;
-        }
+    return (fmt_p);
+}
 
-        if (c == '\0') {
-            break;
-        }
+/**
+ * Format one conversion.
+ */
+static void format_conversion(std_write_t std_write,
+                              void *arg_p,
+                              char c,
+                              char flags,
+                              int width,
+                              char length,
+                              va_list *ap_p)
+{
+    char negative_sign, buf[VALUE_BUF_MAX], *s_p;
 
-        /* Parse the specifier. */
-        negative_sign = 0;
+    buf[sizeof(buf) - 1] = '\0';
+    negative_sign = 0;
 
-        switch (c) {
+    switch (c) {
 
-        case 'S':
+    case 'S':
 #if defined(FAR_SPECIAL_ADDRESS)
-            {
-                FAR const char *far_string_p;
+        {
+            FAR const char *far_string_p;
+            char character;
 
-                far_string_p = va_arg(*ap_p, FAR const char*);
+            far_string_p = va_arg(*ap_p, FAR const char*);
 
-                if (far_string_p == NULL) {
-                    far_string_p = FSTR("(null)");
-                }
+            if (far_string_p == NULL) {
+                far_string_p = FSTR("(null)");
+            }
 
-                s_p = &buf[sizeof(buf) - 1];
-                width -= std_strlen(far_string_p);
+            s_p = &buf[sizeof(buf) - 1];
+            width -= std_strlen(far_string_p);
 
-                /* Right justification. */
-                if (flags != '-') {
-                    formats(std_putc, arg_p, s_p, flags, width, negative_sign);
-                }
+            /* Right justification. */
+            if (flags != '-') {
+                formats(std_write, arg_p, s_p, flags, width, negative_sign);
+            }
 
-                while (*far_string_p != '\0') {
-                    std_putc(*far_string_p++, arg_p);
-                }
+            while (*far_string_p != '\0') {
+                character = *far_string_p++;
+                std_write(&character, 1, arg_p);
+            }
 
-                /* Left justification. */
-                if (flags == '-') {
-                    formats(std_putc, arg_p, s_p, flags, width, negative_sign);
-                }
+            /* Left justification. */
+            if (flags == '-') {
+                formats(std_write, arg_p, s_p, flags, width, negative_sign);
             }
+        }
 
-            continue;
+        return;
 #endif
 
-        case 's':
-            s_p = va_arg(*ap_p, char*);
+    case 's':
+        s_p = va_arg(*ap_p, char*);
 
-            if (s_p == NULL) {
-                s_p = "(null)";
-            }
+        if (s_p == NULL) {
+            s_p = "(null)";
+        }
 
-            break;
+        break;
 
-        case 'c':
-            buf[sizeof(buf) - 2] = (char)va_arg(*ap_p, int);
-            s_p = &buf[sizeof(buf) - 2];
-            break;
+    case 'c':
+        buf[sizeof(buf) - 2] = (char)va_arg(*ap_p, int);
+        s_p = &buf[sizeof(buf) - 2];
+        break;
 
-        case 'i':
-        case 'd':
-        case 'u':
-            s_p = formati(c, &buf[sizeof(buf) - 1], 10, ap_p, length, &negative_sign);
-            break;
+    case 'i':
+    case 'd':
+    case 'u':
+        s_p = formati(c, &buf[sizeof(buf) - 1], 10, ap_p, length, &negative_sign);
+        break;
 
-        case 'x':
-            s_p = formati(c, &buf[sizeof(buf) - 1], 16, ap_p, length, &negative_sign);
-            break;
+    case 'x':
+        s_p = formati(c, &buf[sizeof(buf) - 1], 16, ap_p, length, &negative_sign);
+        break;
 
 #if CONFIG_FLOAT == 1
-        case 'f':
-            s_p = formatf(c, &buf[sizeof(buf) - 1], ap_p, length, &negative_sign);
-            break;
+    case 'f':
+        s_p = formatf(c, &buf[sizeof(buf) - 1], ap_p, length, &negative_sign);
+        break;
 #endif
 
-        default:
-            std_putc(c, arg_p);
-            continue;
+    default:
+        std_write(&c, 1, arg_p);
+        return;
+    }
+
+    formats(std_write, arg_p, s_p, flags, width, negative_sign);
+}
+
+/**
+ * Parse a conversion specification, excluding the leading '%'.
+ *
+ * @return Format string position after the specifier, or NULL if the
+ *         format string ended before the specifier.
+ */
+static far_string_t parse_conversion(far_string_t fmt_p,
+                                     char *flags_p,
+                                     int *width_p,
+                                     char *length_p,
+                                     char *specifier_p)
+{
+    char c;
+    int width;
+
+    /* Prototype: %[flags][width][length]specifier  */
+
+    /* Parse the flags. */
+    *flags_p = ' ';
+    c = *fmt_p++;
+
+    if ((c == '0') || (c == '-')) {
+        *flags_p = c;
+        c = *fmt_p++;
+    }
+
+    /* Parse the width. */
+    width = 0;
+
+    while ((c >= '0') && (c <= '9')) {
+        width *= 10;
+        width += (c - '0');
+        c = *fmt_p++;
+    }
+
+    *width_p = width;
+
+    /* Parse the length. */
+    *length_p = 0;
+
+    if (c == 'l') {
+        *length_p = 1;
+        c = *fmt_p++;
+    }
+
+    if (c == '\0') {
+        return (NULL);
+    }
+
+    *specifier_p = c;
+
+    return (fmt_p);
+}
+
+static void vcprintf(std_write_t std_write,
+                     void *arg_p,
+                     far_string_t fmt_p,
+                     va_list *ap_p)
+{
+    char c, flags, length;
+    int width;
+
+    while (1) {
+        fmt_p = write_literal(std_write, arg_p, fmt_p);
+
+        if (*fmt_p == '\0') {
+            break;
+        }
+
+        fmt_p = parse_conversion(fmt_p + 1, &flags, &width, &length, &c);
+
+        if (fmt_p == NULL) {
+            break;
+        }
+
+        format_conversion(std_write, arg_p, c, flags, width, length, ap_p);
+    }
+}
+
+/**
+ * Format using a precompiled format.
+ */
+static void vcprintf_format(std_write_t std_write,
+                            void *arg_p,
+                            struct std_format_t *format_p,
+                            va_list *ap_p)
+{
+    struct std_format_item_t *item_p;
+    int i;
+
+    for (i = 0; i < format_p->length; i++) {
+        item_p = &format_p->items_p[i];
+
+        if (item_p->literal_size > 0) {
+#if defined(FAR_SPECIAL_ADDRESS)
+            write_literal(std_write, arg_p, item_p->literal_p);
+#else
+            std_write(item_p->literal_p, item_p->literal_size, arg_p);
+#endif
         }
 
-        formats(std_putc, arg_p, s_p, flags, width, negative_sign);
+        if (item_p->specifier != '\0') {
+            format_conversion(std_write,
+                              arg_p,
+                              item_p->specifier,
+                              item_p->flags,
+                              item_p->width,
+                              item_p->length,
+                              ap_p);
+        }
     }
 }
 
@@ -430,7 +624,7 @@ static void cvcprintf(struct buffered_output_t *output_p,
                       va_list *ap_p)
 {
     chan_control(output_p->chan_p, CHAN_CONTROL_PRINTF_BEGIN);
-    vcprintf(fprintf_putc, output_p, fmt_p, ap_p);
+    vcprintf(fprintf_write, output_p, fmt_p, ap_p);
     output_flush(output_p);
     chan_control(output_p->chan_p, CHAN_CONTROL_PRINTF_END);
 }
@@ -493,10 +687,10 @@ ssize_t std_vsprintf(char *dst_p, far_string_t fmt_p, va_list *ap_p)
 
     char *d_p = dst_p;
 
-    vcprintf(sprintf_putc, &d_p, fmt_p, ap_p);
-    sprintf_putc('\0', &d_p);
+    vcprintf(sprintf_write, &d_p, fmt_p, ap_p);
+    *d_p = '\0';
 
-    return (d_p - dst_p - 1);
+    return (d_p - dst_p);
 }
 
 ssize_t std_vsnprintf(char *dst_p,
@@ -514,8 +708,8 @@ ssize_t std_vsnprintf(char *dst_p,
     output.size = 0;
     output.size_max = size;
 
-    vcprintf(snprintf_putc, &output, fmt_p, ap_p);
-    snprintf_putc('\0', &output);
+    vcprintf(snprintf_write, &output, fmt_p, ap_p);
+    snprintf_write("", 1, &output);
 
     return (output.size - 1);
 }
@@ -600,7 +794,7 @@ ssize_t std_printf_isr(far_string_t fmt_p, ...)
     output.chan_p = sys_get_stdout();
 
     va_start(ap, fmt_p);
-    vcprintf(fprintf_putc_isr, &output, fmt_p, &ap);
+    vcprintf(fprintf_write_isr, &output, fmt_p, &ap);
     output_flush_isr(&output);
     va_end(ap);
 
@@ -617,13 +811,134 @@ ssize_t std_fprintf_isr(void *chan_p, far_string_t fmt_p, ...)
     output.chan_p = chan_p;
 
     va_start(ap, fmt_p);
-    vcprintf(fprintf_putc_isr, &output, fmt_p, &ap);
+    vcprintf(fprintf_write_isr, &output, fmt_p, &ap);
     output_flush_isr(&output);
     va_end(ap);
 
     return (output.size);
 }
 
+int std_format_init(struct std_format_t *self_p,
+                    struct std_format_item_t *items_p,
+                    int length,
+                    far_string_t fmt_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(items_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+    ASSERTN(fmt_p != NULL, EINVAL);
+
+    struct std_format_item_t *item_p;
+    far_string_t literal_p;
+    int width;
+
+    self_p->items_p = items_p;
+    self_p->length = 0;
+
+    while (1) {
+        literal_p = fmt_p;
+
+        while ((*fmt_p != '%') && (*fmt_p != '\0')) {
+            fmt_p++;
+        }
+
+        if ((*fmt_p == '\0') && (fmt_p == literal_p)) {
+            break;
+        }
+
+        if (self_p->length == length) {
+            return (-ENOMEM);
+        }
+
+        item_p = &items_p[self_p->length];
+        item_p->literal_p = literal_p;
+        item_p->literal_size = (fmt_p - literal_p);
+        item_p->specifier = '\0';
+        self_p->length++;
+
+        if (*fmt_p == '\0') {
+            break;
+        }
+
+        fmt_p = parse_conversion(fmt_p + 1,
+                                 &item_p->flags,
+                                 &width,
+                                 &item_p->length,
+                                 &item_p->specifier);
+
+        if (fmt_p == NULL) {
+            item_p->specifier = '\0';
+            break;
+        }
+
+        item_p->width = width;
+    }
+
+    return (0);
+}
+
+ssize_t std_format_sprintf(struct std_format_t *self_p, char *dst_p, ...)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    va_list ap;
+    char *d_p = dst_p;
+
+    va_start(ap, dst_p);
+    vcprintf_format(sprintf_write, &d_p, self_p, &ap);
+    va_end(ap);
+    *d_p = '\0';
+
+    return (d_p - dst_p);
+}
+
+ssize_t std_format_snprintf(struct std_format_t *self_p,
+                            char *dst_p,
+                            size_t size,
+                            ...)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    va_list ap;
+    struct snprintf_output_t output;
+
+    output.dst_p = dst_p;
+    output.size = 0;
+    output.size_max = size;
+
+    va_start(ap, size);
+    vcprintf_format(snprintf_write, &output, self_p, &ap);
+    va_end(ap);
+    snprintf_write("", 1, &output);
+
+    return (output.size - 1);
+}
+
+ssize_t std_format_fprintf(struct std_format_t *self_p, void *chan_p, ...)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    va_list ap;
+    struct buffered_output_t output;
+
+    output.pos = 0;
+    output.size = 0;
+    output.chan_p = chan_p;
+
+    va_start(ap, chan_p);
+    chan_control(output.chan_p, CHAN_CONTROL_PRINTF_BEGIN);
+    vcprintf_format(fprintf_write, &output, self_p, &ap);
+    output_flush(&output);
+    chan_control(output.chan_p, CHAN_CONTROL_PRINTF_END);
+    va_end(ap);
+
+    return (output.size);
+}
+
 const char *std_strtolb(const char *str_p,
                         long *value_p,
                         int base)
@@ -34,6 +34,30 @@
 #include "simba.h"
 #include <stdarg.h>
 
+/**
+ * One conversion of a precompiled format string, including the
+ * literal text preceding it.
+ */
+struct std_format_item_t {
+    far_string_t literal_p;
+    uint16_t literal_size;
+    char flags;
+    char length;
+    uint8_t width;
+    /* Conversion specifier, or '\0' for a trailing literal. */
+    char specifier;
+};
+
+/**
+ * A format string parsed once by `std_format_init()` and then used
+ * many times by `std_format_sprintf()` and friends, saving the format
+ * string parsing in hot logging paths.
+ */
+struct std_format_t {
+    struct std_format_item_t *items_p;
+    int length;
+};
+
 /**
  * Initialize the std module. This function must be called before
  * calling any other function in this module.
@@ -207,6 +231,72 @@ ssize_t std_printf_isr(far_string_t fmt_p, ...);
  */
 ssize_t std_fprintf_isr(void *chan_p, far_string_t fmt_p, ...);
 
+/**
+ * Precompile given format string into given list of items. The format
+ * string is referenced, not copied, and must be valid as long as the
+ * precompiled format is used.
+ *
+ * The format string has the same syntax as in `std_sprintf()`.
+ *
+ * @param[out] self_p Precompiled format to initialize.
+ * @param[in] items_p Items buffer, one item per conversion plus one
+ *                    for trailing literal text.
+ * @param[in] length Number of items in the items buffer.
+ * @param[in] fmt_p Format string.
+ *
+ * @return zero(0) or negative error code.
+ */
+int std_format_init(struct std_format_t *self_p,
+                    struct std_format_item_t *items_p,
+                    int length,
+                    far_string_t fmt_p);
+
+/**
+ * Format and write data to destination buffer using given precompiled
+ * format. The output is identical to `std_sprintf()` with the
+ * original format string.
+ *
+ * @param[in] self_p Precompiled format.
+ * @param[out] dst_p Destination buffer. The formatted string is
+ *                   written to this buffer.
+ * @param[in] ... Variable arguments list.
+ *
+ * @return Length of the string written to the destination buffer, not
+ *         inclusing the null termination, or negative error code.
+ */
+ssize_t std_format_sprintf(struct std_format_t *self_p, char *dst_p, ...);
+
+/**
+ * Format and write data to given buffer using given precompiled
+ * format. The output is null terminated.
+ *
+ * @param[in] self_p Precompiled format.
+ * @param[out] dst_p Destination buffer. The formatted string is
+ *                   written to this buffer.
+ * @param[in] size Size of the destination buffer.
+ * @param[in] ... Variable arguments list.
+ *
+ * @return Length of the string written to the destination buffer, not
+ *         inclusing the null termination, or negative error code.
+ */
+ssize_t std_format_snprintf(struct std_format_t *self_p,
+                            char *dst_p,
+                            size_t size,
+                            ...);
+
+/**
+ * Format and write data to given channel using given precompiled
+ * format.
+ *
+ * @param[in] self_p Precompiled format.
+ * @param[in] chan_p Output channel.
+ * @param[in] ... Variable arguments list.
+ *
+ * @return Number of characters written to given channel or negative
+ *         error code.
+ */
+ssize_t std_format_fprintf(struct std_format_t *self_p, void *chan_p, ...);
+
 /**
  * Convert given string to an integer in given base.
  *
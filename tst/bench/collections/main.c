@@ -0,0 +1,191 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define KEYS_MAX                                          128
+
+static struct hash_map_bucket_t buckets[KEYS_MAX];
+static struct hash_map_entry_t entries[KEYS_MAX];
+static struct binary_tree_node_t nodes[KEYS_MAX];
+static uint32_t heap_buf[1024];
+
+static int hash_function(long key)
+{
+    return (key % KEYS_MAX);
+}
+
+/**
+ * A deterministic permutation of the keys 0 to KEYS_MAX - 1.
+ */
+static int key(int i)
+{
+    return ((i * 37) % KEYS_MAX);
+}
+
+static int bench_heap_alloc_free_fixed(struct benchmark_t *benchmark_p)
+{
+    struct heap_t heap;
+    void *buf_p;
+    size_t sizes[HEAP_FIXED_SIZES_MAX] = {
+        8, 16, 32, 64, 128, 256, 512, 1024
+    };
+
+    BTASSERT(heap_init(&heap, &heap_buf[0], sizeof(heap_buf), sizes) == 0);
+
+    BENCHMARK(benchmark_p) {
+        buf_p = heap_alloc(&heap, 24);
+        heap_free(&heap, buf_p);
+    }
+
+    return (0);
+}
+
+static int bench_heap_alloc_free_dynamic(struct benchmark_t *benchmark_p)
+{
+    struct heap_t heap;
+    void *bufs[4];
+    int i;
+    size_t sizes[HEAP_FIXED_SIZES_MAX] = {
+        8, 16, 32, 64, 64, 64, 64, 64
+    };
+
+    BTASSERT(heap_init(&heap, &heap_buf[0], sizeof(heap_buf), sizes) == 0);
+
+    /* Four buffers bigger than the biggest fixed size. */
+    BENCHMARK(benchmark_p) {
+        for (i = 0; i < 4; i++) {
+            bufs[i] = heap_alloc(&heap, 100 + 50 * i);
+        }
+
+        for (i = 0; i < 4; i++) {
+            heap_free(&heap, bufs[i]);
+        }
+    }
+
+    return (0);
+}
+
+static int bench_hash_map(struct benchmark_t *benchmark_p)
+{
+    struct hash_map_t map;
+    int i;
+
+    BTASSERT(hash_map_init(&map,
+                           &buckets[0],
+                           membersof(buckets),
+                           &entries[0],
+                           membersof(entries),
+                           hash_function) == 0);
+
+    /* Add, get and remove all keys. */
+    benchmark_p->iterations = 10;
+
+    BENCHMARK(benchmark_p) {
+        for (i = 0; i < KEYS_MAX; i++) {
+            hash_map_add(&map, key(i), &nodes[i]);
+        }
+
+        for (i = 0; i < KEYS_MAX; i++) {
+            hash_map_get(&map, i);
+        }
+
+        for (i = 0; i < KEYS_MAX; i++) {
+            hash_map_remove(&map, key(i));
+        }
+    }
+
+    return (0);
+}
+
+static int bench_binary_tree(struct benchmark_t *benchmark_p)
+{
+    struct binary_tree_t tree;
+    int i;
+
+    BTASSERT(binary_tree_init(&tree) == 0);
+
+    /* Insert, search and delete all keys. */
+    benchmark_p->iterations = 10;
+
+    BENCHMARK(benchmark_p) {
+        for (i = 0; i < KEYS_MAX; i++) {
+            nodes[i].key = key(i);
+            binary_tree_insert(&tree, &nodes[i]);
+        }
+
+        for (i = 0; i < KEYS_MAX; i++) {
+            binary_tree_search(&tree, i);
+        }
+
+        for (i = 0; i < KEYS_MAX; i++) {
+            binary_tree_delete(&tree, key(i));
+        }
+    }
+
+    return (0);
+}
+
+static int bench_circular_buffer(struct benchmark_t *benchmark_p)
+{
+    struct circular_buffer_t buffer;
+    char buf[256];
+    char data[48];
+
+    memset(&data[0], 0, sizeof(data));
+    BTASSERT(circular_buffer_init(&buffer, &buf[0], sizeof(buf)) == 0);
+
+    BENCHMARK(benchmark_p) {
+        circular_buffer_write(&buffer, &data[0], sizeof(data));
+        circular_buffer_read(&buffer, &data[0], sizeof(data));
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_heap_alloc_free_fixed, "heap_alloc_free_fixed" },
+        { bench_heap_alloc_free_dynamic, "heap_alloc_free_dynamic" },
+        { bench_hash_map, "hash_map_add_get_remove_128" },
+        { bench_binary_tree, "binary_tree_insert_search_delete_128" },
+        { bench_circular_buffer, "circular_buffer_write_read_48" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
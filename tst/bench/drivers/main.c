@@ -0,0 +1,195 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define CHANNELS                                            8
+
+/* Samples per benchmark operation. */
+#define SAMPLES                                          1024
+
+struct report_t {
+    uint32_t high_count;
+    uint32_t low_count;
+    uint32_t rising_count;
+};
+
+static struct capture_driver_t capture;
+static uint8_t buf[SAMPLES];
+
+/* Samples of the simulated source, read in a loop so that the
+   source itself is not benchmarked. */
+static uint8_t samples[SAMPLES];
+static size_t position;
+
+static void samples_init(void)
+{
+    struct capture_pwm_source_t source;
+    int i;
+
+    capture_pwm_source_init(&source, CHANNELS);
+
+    for (i = 0; i < CHANNELS; i++) {
+        capture_pwm_source_set(&source, i, 10 * (i + 1), 3 * (i + 1));
+    }
+
+    for (i = 0; i < SAMPLES; i++) {
+        samples[i] = capture_pwm_source_read(&source);
+    }
+}
+
+static uint8_t samples_read(void *arg_p)
+{
+    return (samples[position++ % SAMPLES]);
+}
+
+static void capture_init_samples(void)
+{
+    capture_init(&capture,
+                 samples_read,
+                 NULL,
+                 CHANNELS,
+                 0,
+                 &buf[0],
+                 sizeof(buf),
+                 SAMPLES);
+}
+
+/**
+ * Sample and measure one channel at a time, as done by the signal
+ * analyzer example before the capture driver was used.
+ */
+static int bench_per_sample(struct benchmark_t *benchmark_p)
+{
+    struct report_t reports[CHANNELS];
+    int previous[CHANNELS];
+    uint8_t sample;
+    int value;
+    int i;
+    int j;
+
+    memset(&reports[0], 0, sizeof(reports));
+    memset(&previous[0], 0, sizeof(previous));
+    benchmark_p->iterations = 10;
+
+    BENCHMARK(benchmark_p) {
+        for (i = 0; i < SAMPLES; i++) {
+            sample = samples_read(NULL);
+
+            for (j = 0; j < CHANNELS; j++) {
+                value = ((sample >> j) & 1);
+
+                if (value == 1) {
+                    reports[j].high_count++;
+                } else {
+                    reports[j].low_count++;
+                }
+
+                if ((value == 1) && (previous[j] == 0)) {
+                    reports[j].rising_count++;
+                }
+
+                previous[j] = value;
+            }
+        }
+    }
+
+    return (0);
+}
+
+static int bench_capture(struct benchmark_t *benchmark_p)
+{
+    int i;
+
+    capture_init_samples();
+    benchmark_p->iterations = 10;
+
+    BENCHMARK(benchmark_p) {
+        for (i = 0; i < SAMPLES; i++) {
+            capture_sample_isr(&capture);
+        }
+
+        capture_analyze(&capture);
+    }
+
+    return (0);
+}
+
+/**
+ * Analysis throughput, not including sampling.
+ */
+static int bench_analyze(struct benchmark_t *benchmark_p)
+{
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t samples;
+    int i;
+
+    capture_init_samples();
+    benchmark_p->iterations = 10;
+    samples = 0;
+    elapsed = 0;
+
+    BENCHMARK(benchmark_p) {
+        for (i = 0; i < SAMPLES; i++) {
+            capture_sample_isr(&capture);
+        }
+
+        start = sys_uptime_ns();
+        samples += capture_analyze(&capture);
+        elapsed += (sys_uptime_ns() - start);
+    }
+
+    if (elapsed > 0) {
+        std_printf(FSTR("samples per millisecond: %lu\r\n"),
+                   (unsigned long)((1000000ULL * samples) / elapsed));
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_per_sample, "per_sample" },
+        { bench_capture, "capture" },
+        { bench_analyze, "analyze" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+    samples_init();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
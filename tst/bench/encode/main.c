@@ -0,0 +1,228 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static const char document[] =
+    "{\"name\": \"simba\", \"version\": 14, \"boards\": [\"arduino_due\", "
+    "\"arduino_mega\", \"nano32\", \"linux\"], \"settings\": {\"a\": 1, "
+    "\"b\": true, \"c\": null, \"d\": -3.5, \"e\": [1, 2, 3, 4, 5]}}";
+
+static int bench_json_parse(struct benchmark_t *benchmark_p)
+{
+    struct json_t json;
+    struct json_tok_t tokens[32];
+
+    BTASSERT(json_init(&json, &tokens[0], membersof(tokens)) == 0);
+    BTASSERTI(json_parse(&json, &document[0], strlen(document)), >, 0);
+
+    BENCHMARK(benchmark_p) {
+        json_init(&json, &tokens[0], membersof(tokens));
+        json_parse(&json, &document[0], sizeof(document) - 1);
+    }
+
+    return (0);
+}
+
+static int bench_json_dumps(struct benchmark_t *benchmark_p)
+{
+    struct json_t json;
+    struct json_tok_t tokens[32];
+    char buf[256];
+
+    BTASSERT(json_init(&json, &tokens[0], membersof(tokens)) == 0);
+    BTASSERTI(json_parse(&json, &document[0], strlen(document)), >, 0);
+
+    BENCHMARK(benchmark_p) {
+        json_dumps(&json, NULL, &buf[0]);
+    }
+
+    return (0);
+}
+
+/**
+ * A channel reading from the document.
+ */
+struct document_t {
+    struct chan_t base;
+    size_t pos;
+};
+
+static ssize_t document_read(void *chan_p, void *buf_p, size_t size)
+{
+    struct document_t *document_p;
+
+    document_p = chan_p;
+
+    if (document_p->pos + size > sizeof(document) - 1) {
+        return (-1);
+    }
+
+    memcpy(buf_p, &document[document_p->pos], size);
+    document_p->pos += size;
+
+    return (size);
+}
+
+static size_t document_size(void *chan_p)
+{
+    struct document_t *document_p;
+
+    document_p = chan_p;
+
+    return (sizeof(document) - 1 - document_p->pos);
+}
+
+static int bench_json_reader_events(struct benchmark_t *benchmark_p)
+{
+    struct json_reader_t reader;
+    struct document_t chan;
+    char value[16];
+
+    chan_init(&chan.base, document_read, chan_write_null, document_size);
+
+    BENCHMARK(benchmark_p) {
+        chan.pos = 0;
+        json_reader_init(&reader, &chan, &value[0], sizeof(value));
+
+        while (json_reader_next(&reader) > 0);
+    }
+
+    return (0);
+}
+
+static int bench_json_reader_find(struct benchmark_t *benchmark_p)
+{
+    struct json_reader_t reader;
+    struct document_t chan;
+    char value[16];
+
+    chan_init(&chan.base, document_read, chan_write_null, document_size);
+
+    BENCHMARK(benchmark_p) {
+        chan.pos = 0;
+        json_reader_init(&reader, &chan, &value[0], sizeof(value));
+        json_reader_find(&reader, "settings.e.4");
+    }
+
+    return (0);
+}
+
+static int bench_json_writer(struct benchmark_t *benchmark_p)
+{
+    struct json_writer_t writer;
+    char buf[256];
+
+    BENCHMARK(benchmark_p) {
+        json_writer_init(&writer, NULL, &buf[0], sizeof(buf));
+        json_writer_object_begin(&writer);
+        json_writer_key(&writer, "name");
+        json_writer_string(&writer, "simba");
+        json_writer_key(&writer, "version");
+        json_writer_integer(&writer, 14);
+        json_writer_key(&writer, "boards");
+        json_writer_array_begin(&writer);
+        json_writer_string(&writer, "arduino_due");
+        json_writer_string(&writer, "arduino_mega");
+        json_writer_string(&writer, "nano32");
+        json_writer_string(&writer, "linux");
+        json_writer_array_end(&writer);
+        json_writer_key(&writer, "settings");
+        json_writer_object_begin(&writer);
+        json_writer_key(&writer, "a");
+        json_writer_integer(&writer, 1);
+        json_writer_key(&writer, "b");
+        json_writer_boolean(&writer, 1);
+        json_writer_key(&writer, "c");
+        json_writer_null(&writer);
+        json_writer_key(&writer, "d");
+        json_writer_raw(&writer, "-3.5", 4);
+        json_writer_key(&writer, "e");
+        json_writer_array_begin(&writer);
+        json_writer_integer(&writer, 1);
+        json_writer_integer(&writer, 2);
+        json_writer_integer(&writer, 3);
+        json_writer_integer(&writer, 4);
+        json_writer_integer(&writer, 5);
+        json_writer_array_end(&writer);
+        json_writer_object_end(&writer);
+        json_writer_object_end(&writer);
+        json_writer_flush(&writer);
+    }
+
+    return (0);
+}
+
+static int bench_base64_encode(struct benchmark_t *benchmark_p)
+{
+    char buf[256];
+
+    BENCHMARK(benchmark_p) {
+        base64_encode(&buf[0], &document[0], 144);
+    }
+
+    return (0);
+}
+
+static int bench_base64_decode(struct benchmark_t *benchmark_p)
+{
+    char encoded[256];
+    char decoded[192];
+
+    BTASSERT(base64_encode(&encoded[0], &document[0], 144) == 0);
+
+    BENCHMARK(benchmark_p) {
+        base64_decode(&decoded[0], &encoded[0], 192);
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_json_parse, "json_parse" },
+        { bench_json_dumps, "json_dumps" },
+        { bench_json_reader_events, "json_reader_events" },
+        { bench_json_reader_find, "json_reader_find" },
+        { bench_json_writer, "json_writer" },
+        { bench_base64_encode, "base64_encode_144" },
+        { bench_base64_decode, "base64_decode_192" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
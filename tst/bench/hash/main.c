@@ -28,90 +28,73 @@
  * This file is part of the Simba project.
  */
 
-static int upgrade_port_bootloader_enter()
-{
-    return (-1);
-}
-
-static int upgrade_port_bootloader_stay_set()
-{
-    static int counter = 0;
+#include "simba.h"
 
-    counter++;
+static uint8_t buf[1024];
 
-    if (counter == 1) {
-        return (0);
+static int bench_crc_32(struct benchmark_t *benchmark_p)
+{
+    BENCHMARK(benchmark_p) {
+        crc_32(0, &buf[0], sizeof(buf));
     }
 
-    return (-1);
+    return (0);
 }
 
-static int upgrade_port_bootloader_stay_clear()
+static int bench_crc_ccitt(struct benchmark_t *benchmark_p)
 {
-    static int counter = 0;
-
-    counter++;
-
-    if (counter == 1) {
-        return (0);
+    BENCHMARK(benchmark_p) {
+        crc_ccitt(0xffff, &buf[0], sizeof(buf));
     }
 
-    return (-1);
+    return (0);
 }
 
-static int upgrade_port_bootloader_stay_get()
+static int bench_crc_xmodem(struct benchmark_t *benchmark_p)
 {
-    static int counter = 0;
-
-    counter++;
-
-    if (counter == 1) {
-        return (1);
-    } else if (counter == 2) {
-        return (0);
+    BENCHMARK(benchmark_p) {
+        crc_xmodem(0, &buf[0], sizeof(buf));
     }
 
-    return (-1);
+    return (0);
 }
 
-static int upgrade_port_application_enter()
+static int bench_sha1(struct benchmark_t *benchmark_p)
 {
-    return (-1);
-}
+    struct sha1_t sha1;
+    uint8_t digest[20];
 
-static int upgrade_port_application_erase()
-{
-    return (0);
-}
+    benchmark_p->iterations = 100;
 
-static int upgrade_port_application_is_valid()
-{
-    return (0);
-}
+    BENCHMARK(benchmark_p) {
+        sha1_init(&sha1);
+        sha1_update(&sha1, &buf[0], sizeof(buf));
+        sha1_digest(&sha1, &digest[0]);
+    }
 
-static int upgrade_port_binary_upload_begin()
-{
     return (0);
 }
 
-static int upgrade_port_binary_upload(const void *buf_p,
-                                      size_t size)
+int main()
 {
-    static int counter = 0;
-
-    counter++;
-
-    if (counter == 1) {
-        BTASSERT(size == 2);
-        BTASSERT(memcmp(buf_p, "ab", 2) == 0);
-
-        return (0);
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_crc_32, "crc_32_1024" },
+        { bench_crc_ccitt, "crc_ccitt_1024" },
+        { bench_crc_xmodem, "crc_xmodem_1024" },
+        { bench_sha1, "sha1_1024" },
+        { NULL, NULL }
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
     }
 
-    return (-1);
-}
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
 
-static int upgrade_port_binary_upload_end()
-{
     return (0);
 }
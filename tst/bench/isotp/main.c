@@ -0,0 +1,186 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/**
+ * Two ISO-TP engines connected back to back through the reception
+ * queues of two Linux CAN drivers. Frames written by one engine are
+ * put in the reception queue of the other engine's driver.
+ */
+
+struct loopback_t {
+    struct chan_t base;
+    struct can_driver_t *peer_p;
+};
+
+static struct can_driver_t can[2];
+static struct can_frame_t can_rx_buf[2][64];
+static struct loopback_t loopback[2];
+static struct isotp_engine_t engine[2];
+static uint32_t pool[2][4][4096 / sizeof(uint32_t)];
+static THRD_STACK(engine_0_stack, 2048);
+static THRD_STACK(engine_1_stack, 2048);
+static struct isotp_session_t sender;
+static struct isotp_session_t receiver;
+static struct sem_t received;
+static uint8_t message[4095];
+
+static ssize_t loopback_write(void *self_p, const void *buf_p, size_t size)
+{
+    struct loopback_t *loopback_p;
+
+    loopback_p = self_p;
+
+    return (queue_write(&loopback_p->peer_p->chin, buf_p, size));
+}
+
+static void on_message(void *arg_p,
+                       struct isotp_session_t *session_p,
+                       uint8_t *buf_p,
+                       size_t size)
+{
+    isotp_engine_buffer_free(session_p->engine_p, buf_p);
+    sem_give(&received, 1);
+}
+
+static int start(void)
+{
+    int i;
+    void *stacks[2] = { engine_0_stack, engine_1_stack };
+
+    BTASSERT(sem_init(&received, 0, 1) == 0);
+
+    for (i = 0; i < 2; i++) {
+        BTASSERT(can_init(&can[i],
+                          &can_device[i],
+                          CAN_SPEED_1000KBPS,
+                          &can_rx_buf[i][0],
+                          sizeof(can_rx_buf[i])) == 0);
+        BTASSERT(can_start(&can[i]) == 0);
+        BTASSERT(chan_init(&loopback[i].base,
+                           chan_read_null,
+                           loopback_write,
+                           chan_size_null) == 0);
+        loopback[i].peer_p = &can[i ^ 1];
+        BTASSERT(isotp_engine_init(&engine[i],
+                                   &can[i],
+                                   &loopback[i],
+                                   &pool[i][0][0],
+                                   sizeof(pool[i]),
+                                   sizeof(pool[i][0]),
+                                   stacks[i],
+                                   sizeof(engine_0_stack)) == 0);
+    }
+
+    BTASSERT(isotp_session_init(&sender,
+                                &engine[0],
+                                0x7e8,
+                                0x7e0,
+                                0,
+                                NULL,
+                                NULL) == 0);
+    BTASSERT(isotp_session_init(&receiver,
+                                &engine[1],
+                                0x7e0,
+                                0x7e8,
+                                0,
+                                on_message,
+                                NULL) == 0);
+
+    for (i = 0; i < 2; i++) {
+        BTASSERT(isotp_engine_start(&engine[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int transfer(struct benchmark_t *benchmark_p,
+                    size_t size,
+                    uint8_t block_size)
+{
+    BTASSERT(isotp_session_set_flow_control(&receiver, block_size, 0) == 0);
+
+    if (size > 7) {
+        benchmark_p->iterations = 10;
+    }
+
+    BENCHMARK(benchmark_p) {
+        isotp_session_write(&sender, &message[0], size);
+        sem_take(&received, NULL);
+    }
+
+    return (0);
+}
+
+static int bench_transfer_7(struct benchmark_t *benchmark_p)
+{
+    return (transfer(benchmark_p, 7, 0));
+}
+
+static int bench_transfer_64(struct benchmark_t *benchmark_p)
+{
+    return (transfer(benchmark_p, 64, 0));
+}
+
+static int bench_transfer_4095(struct benchmark_t *benchmark_p)
+{
+    return (transfer(benchmark_p, 4095, 0));
+}
+
+static int bench_transfer_4095_block_size_8(struct benchmark_t *benchmark_p)
+{
+    return (transfer(benchmark_p, 4095, 8));
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_transfer_7, "isotp_transfer_7" },
+        { bench_transfer_64, "isotp_transfer_64" },
+        { bench_transfer_4095, "isotp_transfer_4095" },
+        { bench_transfer_4095_block_size_8,
+          "isotp_transfer_4095_block_size_8" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+    can_module_init();
+
+    if (start() != 0) {
+        return (1);
+    }
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
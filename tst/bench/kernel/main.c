@@ -0,0 +1,204 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static THRD_STACK(peer_stack, 1024);
+static struct thrd_t *main_p;
+static struct thrd_t *peer_p;
+static volatile int peer_mode;
+
+#define PEER_MODE_YIELD                                     0
+#define PEER_MODE_RESUME                                    1
+
+static void *peer_main(void *arg_p)
+{
+    thrd_set_name("peer");
+
+    while (1) {
+        if (peer_mode == PEER_MODE_YIELD) {
+            thrd_yield();
+        } else {
+            thrd_resume(main_p, 0);
+            thrd_suspend(NULL);
+        }
+    }
+
+    return (NULL);
+}
+
+static void on_timeout(void *arg_p)
+{
+}
+
+static int bench_thrd_yield(struct benchmark_t *benchmark_p)
+{
+    main_p = thrd_self();
+    peer_mode = PEER_MODE_YIELD;
+    peer_p = thrd_spawn(peer_main,
+                        NULL,
+                        thrd_get_prio(),
+                        peer_stack,
+                        sizeof(peer_stack));
+    BTASSERT(peer_p != NULL);
+
+    /* Two context switches per iteration. */
+    BENCHMARK(benchmark_p) {
+        thrd_yield();
+    }
+
+    return (0);
+}
+
+static int bench_thrd_resume_suspend(struct benchmark_t *benchmark_p)
+{
+    /* Reuse the peer thread from the yield benchmark. It resumes
+       this thread and suspends itself. */
+    BTASSERT(peer_p != NULL);
+    peer_mode = PEER_MODE_RESUME;
+    thrd_yield();
+
+    BENCHMARK(benchmark_p) {
+        thrd_resume(peer_p, 0);
+        thrd_suspend(NULL);
+    }
+
+    return (0);
+}
+
+static int bench_sys_lock(struct benchmark_t *benchmark_p)
+{
+    BENCHMARK(benchmark_p) {
+        sys_lock();
+        sys_unlock();
+    }
+
+    return (0);
+}
+
+static int bench_sys_uptime(struct benchmark_t *benchmark_p)
+{
+    struct time_t uptime;
+
+    BENCHMARK(benchmark_p) {
+        sys_uptime(&uptime);
+    }
+
+    return (0);
+}
+
+static int bench_sys_uptime_ns(struct benchmark_t *benchmark_p)
+{
+    uint64_t previous;
+    uint64_t now;
+    uint64_t resolution;
+
+    /* The smallest observed non-zero step between two reads. */
+    resolution = UINT64_MAX;
+    previous = sys_uptime_ns();
+
+    BENCHMARK(benchmark_p) {
+        now = sys_uptime_ns();
+
+        if ((now != previous) && (now - previous < resolution)) {
+            resolution = (now - previous);
+        }
+
+        previous = now;
+    }
+
+    std_printf(FSTR("sys_uptime_ns resolution: %lu ns\r\n"),
+               (unsigned long)resolution);
+
+    return (0);
+}
+
+static int bench_time_get(struct benchmark_t *benchmark_p)
+{
+    struct time_t now;
+
+    BENCHMARK(benchmark_p) {
+        time_get(&now);
+    }
+
+    return (0);
+}
+
+static int bench_timer_start_stop(struct benchmark_t *benchmark_p)
+{
+    struct timer_t timer;
+    struct time_t timeout;
+
+    timeout.seconds = 10;
+    timeout.nanoseconds = 0;
+    BTASSERT(timer_init(&timer, &timeout, on_timeout, NULL, 0) == 0);
+
+    BENCHMARK(benchmark_p) {
+        timer_start(&timer);
+        timer_stop(&timer);
+    }
+
+    return (0);
+}
+
+static int bench_fs_call(struct benchmark_t *benchmark_p)
+{
+    char command[32];
+
+    BENCHMARK(benchmark_p) {
+        strcpy(&command[0], "/kernel/sys/uptime");
+        fs_call(&command[0], NULL, chan_null(), NULL);
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_sys_lock, "sys_lock" },
+        { bench_sys_uptime, "sys_uptime" },
+        { bench_sys_uptime_ns, "sys_uptime_ns" },
+        { bench_time_get, "time_get" },
+        { bench_timer_start_stop, "timer_start_stop" },
+        { bench_fs_call, "fs_call" },
+        { bench_thrd_yield, "thrd_yield" },
+        { bench_thrd_resume_suspend, "thrd_resume_suspend" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
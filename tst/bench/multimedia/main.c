@@ -0,0 +1,244 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define SAMPLE_RATE                                     44100
+
+/* 10 ms of audio, as rendered by the synthesizer example. */
+#define BLOCK_SIZE                                        441
+
+#define VOICES                                             16
+
+static int16_t wavetable[256];
+static int16_t samples[BLOCK_SIZE];
+static int16_t voice[BLOCK_SIZE];
+
+static void fill(int16_t *buf_p, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        buf_p[i] = ((i * 7919) & 0xffff);
+    }
+}
+
+static int bench_mix(struct benchmark_t *benchmark_p)
+{
+    fill(&voice[0], membersof(voice));
+    memset(&samples[0], 0, sizeof(samples));
+
+    BENCHMARK(benchmark_p) {
+        dsp_mix(&samples[0], &voice[0], 8192, membersof(samples));
+    }
+
+    return (0);
+}
+
+static int bench_gain(struct benchmark_t *benchmark_p)
+{
+    fill(&samples[0], membersof(samples));
+
+    BENCHMARK(benchmark_p) {
+        dsp_gain(&samples[0], 32767, membersof(samples));
+    }
+
+    return (0);
+}
+
+static int bench_fir_32(struct benchmark_t *benchmark_p)
+{
+    struct dsp_fir_t fir;
+    int16_t coefficients[32];
+    int16_t state[DSP_FIR_STATE_LENGTH(32)];
+
+    fill(&coefficients[0], membersof(coefficients));
+    fill(&samples[0], membersof(samples));
+    dsp_fir_init(&fir,
+                 &coefficients[0],
+                 membersof(coefficients),
+                 &state[0],
+                 membersof(state));
+    benchmark_p->iterations = 100;
+
+    BENCHMARK(benchmark_p) {
+        dsp_fir_filter(&fir, &voice[0], &samples[0], membersof(samples));
+    }
+
+    return (0);
+}
+
+static int bench_biquad(struct benchmark_t *benchmark_p)
+{
+    struct dsp_biquad_t biquad;
+
+    fill(&samples[0], membersof(samples));
+    dsp_biquad_init(&biquad, 0.2f, 0.4f, 0.2f, -0.6f, 0.2f);
+
+    BENCHMARK(benchmark_p) {
+        dsp_biquad_filter(&biquad, &voice[0], &samples[0], membersof(samples));
+    }
+
+    return (0);
+}
+
+static int bench_resampler(struct benchmark_t *benchmark_p)
+{
+    struct dsp_resampler_t resampler;
+    int16_t output[2 * BLOCK_SIZE];
+
+    fill(&samples[0], membersof(samples));
+    dsp_resampler_init(&resampler, 22050, SAMPLE_RATE);
+
+    BENCHMARK(benchmark_p) {
+        dsp_resampler_process(&resampler,
+                              &output[0],
+                              membersof(output),
+                              &samples[0],
+                              membersof(samples));
+    }
+
+    return (0);
+}
+
+static int bench_oscillator_bank(struct benchmark_t *benchmark_p)
+{
+    struct dsp_oscillator_bank_t bank;
+    struct dsp_oscillator_t oscillators[VOICES];
+    int i;
+
+    dsp_oscillator_bank_init(&bank,
+                             &wavetable[0],
+                             membersof(wavetable),
+                             SAMPLE_RATE,
+                             &oscillators[0],
+                             membersof(oscillators));
+
+    for (i = 0; i < VOICES; i++) {
+        dsp_oscillator_bank_set(&bank,
+                                i,
+                                midi_note_to_frequency(MIDI_NOTE_A4 + i),
+                                32767 / VOICES);
+    }
+
+    benchmark_p->iterations = 100;
+
+    BENCHMARK(benchmark_p) {
+        dsp_oscillator_bank_render(&bank, &samples[0], membersof(samples));
+    }
+
+    return (0);
+}
+
+/**
+ * Render one synthesizer voice; an oscillator shaped by an envelope
+ * and mixed into the output. Each operation renders 10 ms of audio,
+ * so the number of voices that can be rendered per millisecond is
+ * the number of voices that can be played in real time.
+ */
+static int bench_voice(struct benchmark_t *benchmark_p)
+{
+    struct dsp_oscillator_bank_t bank;
+    struct dsp_oscillator_t oscillators[VOICES];
+    struct dsp_envelope_t envelopes[VOICES];
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t voices;
+    int i;
+
+    dsp_oscillator_bank_init(&bank,
+                             &wavetable[0],
+                             membersof(wavetable),
+                             SAMPLE_RATE,
+                             &oscillators[0],
+                             membersof(oscillators));
+
+    for (i = 0; i < VOICES; i++) {
+        dsp_oscillator_bank_set(&bank,
+                                i,
+                                midi_note_to_frequency(MIDI_NOTE_A4 + i),
+                                32767);
+        dsp_envelope_init(&envelopes[i],
+                          SAMPLE_RATE / 100,
+                          SAMPLE_RATE / 10,
+                          16384,
+                          SAMPLE_RATE / 10);
+        dsp_envelope_start(&envelopes[i]);
+    }
+
+    memset(&samples[0], 0, sizeof(samples));
+    benchmark_p->iterations = 100;
+    voices = 0;
+    start = sys_uptime_ns();
+
+    BENCHMARK(benchmark_p) {
+        i = (benchmark_p->iteration % VOICES);
+        dsp_oscillator_bank_render_one(&bank, i, &voice[0], membersof(voice));
+        dsp_envelope_apply(&envelopes[i], &voice[0], membersof(voice));
+        dsp_mix(&samples[0], &voice[0], 32767 / VOICES, membersof(samples));
+        voices++;
+    }
+
+    elapsed = (sys_uptime_ns() - start);
+
+    if (elapsed > 0) {
+        std_printf(FSTR("voices per millisecond: %lu\r\n"),
+                   (unsigned long)((1000000ULL * voices) / elapsed));
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_mix, "mix" },
+        { bench_gain, "gain" },
+        { bench_fir_32, "fir_32" },
+        { bench_biquad, "biquad" },
+        { bench_resampler, "resampler" },
+        { bench_oscillator_bank, "oscillator_bank" },
+        { bench_voice, "voice" },
+        { NULL, NULL }
+    };
+    int i;
+
+    for (i = 0; i < membersof(wavetable); i++) {
+        wavetable[i] = (i < membersof(wavetable) / 2 ? 32767 : -32768);
+    }
+
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
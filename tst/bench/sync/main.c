@@ -0,0 +1,449 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static THRD_STACK(peer_stack, 1024);
+static struct queue_t ping;
+static struct queue_t pong;
+static uint32_t ping_buf[4];
+static uint32_t pong_buf[4];
+
+static void *peer_main(void *arg_p)
+{
+    uint32_t value;
+
+    thrd_set_name("peer");
+
+    while (1) {
+        queue_read(&ping, &value, sizeof(value));
+        queue_write(&pong, &value, sizeof(value));
+    }
+
+    return (NULL);
+}
+
+static int bench_queue_ping_pong(struct benchmark_t *benchmark_p)
+{
+    uint32_t value;
+
+    BTASSERT(queue_init(&ping, &ping_buf[0], sizeof(ping_buf)) == 0);
+    BTASSERT(queue_init(&pong, &pong_buf[0], sizeof(pong_buf)) == 0);
+    BTASSERT(thrd_spawn(peer_main,
+                        NULL,
+                        0,
+                        peer_stack,
+                        sizeof(peer_stack)) != NULL);
+    value = 0;
+
+    BENCHMARK(benchmark_p) {
+        queue_write(&ping, &value, sizeof(value));
+        queue_read(&pong, &value, sizeof(value));
+        value++;
+    }
+
+    return (0);
+}
+
+static int bench_queue_write_read(struct benchmark_t *benchmark_p)
+{
+    struct queue_t queue;
+    uint32_t buf[4];
+    uint32_t value;
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    value = 0;
+
+    /* Buffered, no context switches. */
+    BENCHMARK(benchmark_p) {
+        queue_write(&queue, &value, sizeof(value));
+        queue_read(&queue, &value, sizeof(value));
+    }
+
+    return (0);
+}
+
+static uint8_t message_queue_buf[128];
+
+static int queue_write_read(struct benchmark_t *benchmark_p, size_t size)
+{
+    struct queue_t queue;
+    uint8_t message[64];
+
+    BTASSERT(queue_init(&queue,
+                        &message_queue_buf[0],
+                        sizeof(message_queue_buf)) == 0);
+    memset(&message[0], 0, sizeof(message));
+
+    BENCHMARK(benchmark_p) {
+        queue_write(&queue, &message[0], size);
+        queue_read(&queue, &message[0], size);
+    }
+
+    return (0);
+}
+
+static int spsc_queue_write_read(struct benchmark_t *benchmark_p,
+                                 size_t size)
+{
+    struct spsc_queue_t queue;
+    uint8_t message[64];
+
+    BTASSERT(spsc_queue_init(&queue,
+                             &message_queue_buf[0],
+                             sizeof(message_queue_buf)) == 0);
+    memset(&message[0], 0, sizeof(message));
+
+    BENCHMARK(benchmark_p) {
+        spsc_queue_write(&queue, &message[0], size);
+        spsc_queue_read(&queue, &message[0], size);
+    }
+
+    return (0);
+}
+
+static int bench_queue_write_read_1(struct benchmark_t *benchmark_p)
+{
+    return (queue_write_read(benchmark_p, 1));
+}
+
+static int bench_queue_write_read_8(struct benchmark_t *benchmark_p)
+{
+    return (queue_write_read(benchmark_p, 8));
+}
+
+static int bench_queue_write_read_64(struct benchmark_t *benchmark_p)
+{
+    return (queue_write_read(benchmark_p, 64));
+}
+
+static int bench_spsc_queue_write_read_1(struct benchmark_t *benchmark_p)
+{
+    return (spsc_queue_write_read(benchmark_p, 1));
+}
+
+static int bench_spsc_queue_write_read_8(struct benchmark_t *benchmark_p)
+{
+    return (spsc_queue_write_read(benchmark_p, 8));
+}
+
+static int bench_spsc_queue_write_read_64(struct benchmark_t *benchmark_p)
+{
+    return (spsc_queue_write_read(benchmark_p, 64));
+}
+
+#define LINE "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+
+static struct queue_t line_queue;
+static char line_queue_buf[128];
+
+static int bench_line_read_per_byte(struct benchmark_t *benchmark_p)
+{
+    char line[128];
+    size_t size;
+
+    BTASSERT(queue_init(&line_queue,
+                        &line_queue_buf[0],
+                        sizeof(line_queue_buf)) == 0);
+
+    BENCHMARK(benchmark_p) {
+        queue_write(&line_queue, LINE, sizeof(LINE) - 1);
+        size = 0;
+
+        do {
+            chan_read(&line_queue, &line[size], 1);
+            size++;
+        } while (line[size - 1] != '\n');
+    }
+
+    return (0);
+}
+
+static int bench_line_read_chan_reader(struct benchmark_t *benchmark_p)
+{
+    struct chan_reader_t reader;
+    char reader_buf[128];
+    char *line_p;
+
+    BTASSERT(queue_init(&line_queue,
+                        &line_queue_buf[0],
+                        sizeof(line_queue_buf)) == 0);
+    BTASSERT(chan_reader_init(&reader,
+                              &line_queue,
+                              &reader_buf[0],
+                              sizeof(reader_buf)) == 0);
+
+    BENCHMARK(benchmark_p) {
+        queue_write(&line_queue, LINE, sizeof(LINE) - 1);
+        chan_reader_readline(&reader, &line_p);
+    }
+
+    return (0);
+}
+
+#define POLL_CHANNELS_MAX 32
+
+static THRD_STACK(poll_peer_stack, 1024);
+static struct queue_t poll_trigger;
+static uint8_t poll_trigger_buf[4];
+static struct queue_t poll_queues[POLL_CHANNELS_MAX];
+static uint8_t poll_queues_buf[POLL_CHANNELS_MAX][4];
+static struct chan_list_t poll_list;
+static void *poll_workspace[POLL_CHANNELS_MAX];
+
+static void *poll_peer_main(void *arg_p)
+{
+    uint8_t value;
+
+    thrd_set_name("poll_peer");
+
+    while (1) {
+        queue_read(&poll_trigger, &value, sizeof(value));
+        queue_write(&poll_queues[value], &value, sizeof(value));
+    }
+
+    return (NULL);
+}
+
+static int init_poll_list(void)
+{
+    int i;
+
+    BTASSERT(chan_list_init(&poll_list,
+                            &poll_workspace[0],
+                            sizeof(poll_workspace)) == 0);
+
+    for (i = 0; i < POLL_CHANNELS_MAX; i++) {
+        BTASSERT(queue_init(&poll_queues[i],
+                            &poll_queues_buf[i][0],
+                            sizeof(poll_queues_buf[i])) == 0);
+        BTASSERT(chan_list_add(&poll_list, &poll_queues[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int bench_list_poll_ready(struct benchmark_t *benchmark_p)
+{
+    uint8_t value;
+    struct queue_t *queue_p;
+
+    BTASSERT(init_poll_list() == 0);
+    value = (POLL_CHANNELS_MAX - 1);
+
+    /* Data already available in the last channel, no context
+       switches. */
+    BENCHMARK(benchmark_p) {
+        queue_write(&poll_queues[value], &value, sizeof(value));
+        queue_p = chan_list_poll(&poll_list, NULL);
+        queue_read(queue_p, &value, sizeof(value));
+    }
+
+    BTASSERT(chan_list_destroy(&poll_list) == 0);
+
+    return (0);
+}
+
+static int bench_list_poll_wakeup(struct benchmark_t *benchmark_p)
+{
+    uint8_t value;
+    struct queue_t *queue_p;
+
+    BTASSERT(init_poll_list() == 0);
+    BTASSERT(queue_init(&poll_trigger,
+                        &poll_trigger_buf[0],
+                        sizeof(poll_trigger_buf)) == 0);
+    BTASSERT(thrd_spawn(poll_peer_main,
+                        NULL,
+                        0,
+                        poll_peer_stack,
+                        sizeof(poll_peer_stack)) != NULL);
+    value = (POLL_CHANNELS_MAX - 1);
+
+    /* The poller is suspended until the peer writes to a channel. */
+    BENCHMARK(benchmark_p) {
+        queue_write(&poll_trigger, &value, sizeof(value));
+        queue_p = chan_list_poll(&poll_list, NULL);
+        queue_read(queue_p, &value, sizeof(value));
+    }
+
+    BTASSERT(chan_list_destroy(&poll_list) == 0);
+
+    return (0);
+}
+
+#define BUS_LISTENERS_MAX 100
+
+static struct bus_t bus;
+static struct bus_listener_t bus_listeners[BUS_LISTENERS_MAX];
+static void *bus_snapshot_buf[2 * BUS_LISTENERS_MAX];
+
+/**
+ * Write to a bus with given number of listeners, all with different
+ * ids.
+ */
+static int bus_write_listeners(struct benchmark_t *benchmark_p,
+                               int number_of_listeners,
+                               int snapshot)
+{
+    int i;
+    uint32_t value;
+
+    BTASSERT(bus_init(&bus) == 0);
+
+    if (snapshot == 1) {
+        BTASSERT(bus_set_snapshot_buffer(&bus,
+                                         &bus_snapshot_buf[0],
+                                         sizeof(bus_snapshot_buf)) == 0);
+    }
+
+    for (i = 0; i < number_of_listeners; i++) {
+        BTASSERT(bus_listener_init(&bus_listeners[i], i, chan_null()) == 0);
+        BTASSERT(bus_attach(&bus, &bus_listeners[i]) == 0);
+    }
+
+    value = 0;
+
+    BENCHMARK(benchmark_p) {
+        bus_write(&bus, number_of_listeners - 1, &value, sizeof(value));
+    }
+
+    return (0);
+}
+
+static int bench_bus_write_1(struct benchmark_t *benchmark_p)
+{
+    return (bus_write_listeners(benchmark_p, 1, 0));
+}
+
+static int bench_bus_write_10(struct benchmark_t *benchmark_p)
+{
+    return (bus_write_listeners(benchmark_p, 10, 0));
+}
+
+static int bench_bus_write_100(struct benchmark_t *benchmark_p)
+{
+    return (bus_write_listeners(benchmark_p, 100, 0));
+}
+
+static int bench_bus_write_snapshot_1(struct benchmark_t *benchmark_p)
+{
+    return (bus_write_listeners(benchmark_p, 1, 1));
+}
+
+static int bench_bus_write_snapshot_10(struct benchmark_t *benchmark_p)
+{
+    return (bus_write_listeners(benchmark_p, 10, 1));
+}
+
+static int bench_bus_write_snapshot_100(struct benchmark_t *benchmark_p)
+{
+    return (bus_write_listeners(benchmark_p, 100, 1));
+}
+
+static int bench_sem_take_give(struct benchmark_t *benchmark_p)
+{
+    struct sem_t sem;
+
+    BTASSERT(sem_init(&sem, 0, 1) == 0);
+
+    BENCHMARK(benchmark_p) {
+        sem_take(&sem, NULL);
+        sem_give(&sem, 1);
+    }
+
+    return (0);
+}
+
+static int bench_mutex_lock_unlock(struct benchmark_t *benchmark_p)
+{
+    struct mutex_t mutex;
+
+    BTASSERT(mutex_init(&mutex) == 0);
+
+    BENCHMARK(benchmark_p) {
+        mutex_lock(&mutex);
+        mutex_unlock(&mutex);
+    }
+
+    return (0);
+}
+
+static int bench_event_write_read(struct benchmark_t *benchmark_p)
+{
+    struct event_t event;
+    uint32_t mask;
+
+    BTASSERT(event_init(&event) == 0);
+
+    BENCHMARK(benchmark_p) {
+        mask = 0x1;
+        event_write(&event, &mask, sizeof(mask));
+        event_read(&event, &mask, sizeof(mask));
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_sem_take_give, "sem_take_give" },
+        { bench_mutex_lock_unlock, "mutex_lock_unlock" },
+        { bench_event_write_read, "event_write_read" },
+        { bench_queue_write_read, "queue_write_read" },
+        { bench_queue_ping_pong, "queue_ping_pong" },
+        { bench_queue_write_read_1, "queue_write_read_1" },
+        { bench_queue_write_read_8, "queue_write_read_8" },
+        { bench_queue_write_read_64, "queue_write_read_64" },
+        { bench_spsc_queue_write_read_1, "spsc_queue_write_read_1" },
+        { bench_spsc_queue_write_read_8, "spsc_queue_write_read_8" },
+        { bench_spsc_queue_write_read_64, "spsc_queue_write_read_64" },
+        { bench_line_read_per_byte, "line_read_per_byte" },
+        { bench_line_read_chan_reader, "line_read_chan_reader" },
+        { bench_list_poll_ready, "list_poll_ready" },
+        { bench_list_poll_wakeup, "list_poll_wakeup" },
+        { bench_bus_write_1, "bus_write_1" },
+        { bench_bus_write_10, "bus_write_10" },
+        { bench_bus_write_100, "bus_write_100" },
+        { bench_bus_write_snapshot_1, "bus_write_snapshot_1" },
+        { bench_bus_write_snapshot_10, "bus_write_snapshot_10" },
+        { bench_bus_write_snapshot_100, "bus_write_snapshot_100" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
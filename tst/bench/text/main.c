@@ -0,0 +1,316 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static int bench_sprintf_integers(struct benchmark_t *benchmark_p)
+{
+    char buf[64];
+
+    BENCHMARK(benchmark_p) {
+        std_sprintf(&buf[0], FSTR("%d %u 0x%08x %ld"), -1234, 5678u, 0xbeef, 123456789L);
+    }
+
+    return (0);
+}
+
+static int bench_sprintf_strings(struct benchmark_t *benchmark_p)
+{
+    char buf[128];
+
+    BENCHMARK(benchmark_p) {
+        std_sprintf(&buf[0],
+                    FSTR("%s: %-10s|%10s\r\n"),
+                    "name",
+                    "left",
+                    "right");
+    }
+
+    return (0);
+}
+
+static int bench_sprintf_literal(struct benchmark_t *benchmark_p)
+{
+    char buf[128];
+
+    BENCHMARK(benchmark_p) {
+        std_sprintf(&buf[0],
+                    FSTR("A format string without any conversion "
+                         "specifiers at all.\r\n"));
+    }
+
+    return (0);
+}
+
+static int bench_fprintf_null(struct benchmark_t *benchmark_p)
+{
+    BENCHMARK(benchmark_p) {
+        std_fprintf(chan_null(), FSTR("%d %s\r\n"), 42, "forty two");
+    }
+
+    return (0);
+}
+
+#define LOG_LINE_FMT "%lu:%s:%s: connected to %s:%d in %d ms\r\n"
+#define LOG_LINE_ARGS 123456L, "info", "mqtt", "192.168.0.7", 1883, 12
+
+static int bench_sprintf_log_line(struct benchmark_t *benchmark_p)
+{
+    char buf[128];
+
+    BENCHMARK(benchmark_p) {
+        std_sprintf(&buf[0], FSTR(LOG_LINE_FMT), LOG_LINE_ARGS);
+    }
+
+    return (0);
+}
+
+static int bench_fprintf_log_line(struct benchmark_t *benchmark_p)
+{
+    BENCHMARK(benchmark_p) {
+        std_fprintf(chan_null(), FSTR(LOG_LINE_FMT), LOG_LINE_ARGS);
+    }
+
+    return (0);
+}
+
+static int bench_format_sprintf_log_line(struct benchmark_t *benchmark_p)
+{
+    char buf[128];
+    struct std_format_t format;
+    struct std_format_item_t items[8];
+
+    std_format_init(&format, &items[0], membersof(items), FSTR(LOG_LINE_FMT));
+
+    BENCHMARK(benchmark_p) {
+        std_format_sprintf(&format, &buf[0], LOG_LINE_ARGS);
+    }
+
+    return (0);
+}
+
+static int bench_format_fprintf_log_line(struct benchmark_t *benchmark_p)
+{
+    struct std_format_t format;
+    struct std_format_item_t items[8];
+
+    std_format_init(&format, &items[0], membersof(items), FSTR(LOG_LINE_FMT));
+
+    BENCHMARK(benchmark_p) {
+        std_format_fprintf(&format, chan_null(), LOG_LINE_ARGS);
+    }
+
+    return (0);
+}
+
+#define NMEA_PATTERN "\\$GP[A-Z]{3},\\d*\\.?\\d*,.*\\*[0-9A-F]{2}"
+#define NMEA_SENTENCE                                                   \
+    "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"
+
+static int bench_re_match(struct benchmark_t *benchmark_p,
+                          size_t compiled_size,
+                          const char *buf_p)
+{
+    char re[512];
+    size_t size;
+
+    re_compile(&re[0], NMEA_PATTERN, 0, compiled_size);
+    size = strlen(buf_p);
+
+    BENCHMARK(benchmark_p) {
+        re_match(&re[0], buf_p, size, NULL, NULL);
+    }
+
+    return (0);
+}
+
+static int bench_re_match_interpreter(struct benchmark_t *benchmark_p)
+{
+    return (bench_re_match(benchmark_p, 64, NMEA_SENTENCE));
+}
+
+static int bench_re_match_automaton(struct benchmark_t *benchmark_p)
+{
+    return (bench_re_match(benchmark_p, 512, NMEA_SENTENCE));
+}
+
+static int bench_re_reject_interpreter(struct benchmark_t *benchmark_p)
+{
+    return (bench_re_match(benchmark_p, 64, "$GNRMC,123519,A*6A"));
+}
+
+static int bench_re_reject_automaton(struct benchmark_t *benchmark_p)
+{
+    return (bench_re_match(benchmark_p, 512, "$GNRMC,123519,A*6A"));
+}
+
+static int bench_strtol(struct benchmark_t *benchmark_p)
+{
+    long value;
+
+    BENCHMARK(benchmark_p) {
+        std_strtol("-1234567", &value);
+    }
+
+    return (0);
+}
+
+#define CONFIGFILE_SECTIONS                                10
+#define CONFIGFILE_PROPERTIES                              10
+
+static char configfile_buf[4096];
+static char configfile_work_buf[4096];
+static struct configfile_property_t
+configfile_properties[CONFIGFILE_SECTIONS * CONFIGFILE_PROPERTIES];
+
+/**
+ * Create a configuration file with 100 properties and copy it to the
+ * work buffer.
+ */
+static size_t configfile_create(void)
+{
+    size_t size;
+    int i;
+    int j;
+
+    size = 0;
+
+    for (i = 0; i < CONFIGFILE_SECTIONS; i++) {
+        size += std_sprintf(&configfile_buf[size],
+                            FSTR("; comment\r\n[section_%d]\r\n"),
+                            i);
+
+        for (j = 0; j < CONFIGFILE_PROPERTIES; j++) {
+            size += std_sprintf(&configfile_buf[size],
+                                FSTR("property_%d = %d\r\n"),
+                                j,
+                                100 * i + j);
+        }
+    }
+
+    return (size + 1);
+}
+
+static int configfile_get_all(struct configfile_t *configfile_p)
+{
+    char section[16];
+    char property[16];
+    long value;
+    int i;
+    int j;
+
+    for (i = 0; i < CONFIGFILE_SECTIONS; i++) {
+        std_sprintf(&section[0], FSTR("section_%d"), i);
+
+        for (j = 0; j < CONFIGFILE_PROPERTIES; j++) {
+            std_sprintf(&property[0], FSTR("property_%d"), j);
+
+            if (configfile_get_long(configfile_p,
+                                    &section[0],
+                                    &property[0],
+                                    &value) != 0) {
+                return (-1);
+            }
+        }
+    }
+
+    return (0);
+}
+
+static int bench_configfile_get_all(struct benchmark_t *benchmark_p)
+{
+    struct configfile_t configfile;
+    size_t size;
+
+    size = configfile_create();
+    BTASSERT(configfile_init(&configfile, &configfile_buf[0], size) == 0);
+    BTASSERT(configfile_get_all(&configfile) == 0);
+    benchmark_p->iterations = 10;
+
+    BENCHMARK(benchmark_p) {
+        configfile_get_all(&configfile);
+    }
+
+    return (0);
+}
+
+static int bench_configfile_index_get_all(struct benchmark_t *benchmark_p)
+{
+    struct configfile_t configfile;
+    size_t size;
+
+    size = configfile_create();
+    benchmark_p->iterations = 10;
+
+    /* The index is created from a fresh copy of the file every
+       iteration, as it modifies the file contents. */
+    BENCHMARK(benchmark_p) {
+        memcpy(&configfile_work_buf[0], &configfile_buf[0], size);
+        configfile_init(&configfile, &configfile_work_buf[0], size);
+        configfile_index(&configfile,
+                         &configfile_properties[0],
+                         membersof(configfile_properties));
+        configfile_get_all(&configfile);
+    }
+
+    BTASSERT(configfile_get_all(&configfile) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct benchmark_t benchmark;
+    struct benchmark_case_t benchmark_cases[] = {
+        { bench_sprintf_integers, "sprintf_integers" },
+        { bench_sprintf_strings, "sprintf_strings" },
+        { bench_sprintf_literal, "sprintf_literal" },
+        { bench_fprintf_null, "fprintf_null" },
+        { bench_sprintf_log_line, "sprintf_log_line" },
+        { bench_fprintf_log_line, "fprintf_log_line" },
+        { bench_format_sprintf_log_line, "format_sprintf_log_line" },
+        { bench_format_fprintf_log_line, "format_fprintf_log_line" },
+        { bench_re_match_interpreter, "re_match_interpreter" },
+        { bench_re_match_automaton, "re_match_automaton" },
+        { bench_re_reject_interpreter, "re_reject_interpreter" },
+        { bench_re_reject_automaton, "re_reject_automaton" },
+        { bench_strtol, "strtol" },
+        { bench_configfile_get_all, "configfile_get_all" },
+        { bench_configfile_index_get_all, "configfile_index_get_all" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    benchmark_init(&benchmark);
+    benchmark_run(&benchmark, benchmark_cases);
+
+    return (0);
+}
@@ -0,0 +1,247 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct sem_t sem;
+static struct mutex_t mutex;
+static THRD_STACK(waiter_stack, 1024);
+
+static void *waiter_main(void *arg_p)
+{
+    thrd_set_name("waiter");
+
+    while (1) {
+        sem_take(&sem, NULL);
+        mutex_lock(&mutex);
+        mutex_unlock(&mutex);
+    }
+
+    return (NULL);
+}
+
+static struct trace_event_t *find_event(struct trace_event_t *events_p,
+                                        ssize_t length,
+                                        int type)
+{
+    ssize_t i;
+
+    for (i = 0; i < length; i++) {
+        if (events_p[i].type == type) {
+            return (&events_p[i]);
+        }
+    }
+
+    return (NULL);
+}
+
+int test_init(struct harness_t *harness_p)
+{
+    /* Call init two times. */
+    BTASSERT(trace_module_init() == 0);
+    BTASSERT(trace_module_init() == 0);
+
+    return (0);
+}
+
+int test_record(struct harness_t *harness_p)
+{
+    struct trace_event_t events[CONFIG_TRACE_EVENTS_MAX];
+    struct trace_event_t *event_p;
+    struct thrd_t *waiter_p;
+    ssize_t length;
+    ssize_t i;
+
+    BTASSERT(sem_init(&sem, 0, 1) == 0);
+    BTASSERT(mutex_init(&mutex) == 0);
+
+    /* Do not record system tick interrupts and the system lock. */
+    trace_set_mask(TRACE_MASK(SWITCH)
+                   | TRACE_MASK(RESUME)
+                   | TRACE_MASK(SUSPEND)
+                   | TRACE_MASK(SEM_TAKE)
+                   | TRACE_MASK(SEM_GIVE)
+                   | TRACE_MASK(MUTEX_LOCK)
+                   | TRACE_MASK(MUTEX_UNLOCK)
+                   | TRACE_MASK(MARKER));
+    BTASSERT(trace_start() == 0);
+
+    trace_marker(5, 0x12345678);
+
+    /* The waiter thread takes the semaphore once and then suspends
+       itself waiting for it. */
+    waiter_p = thrd_spawn(waiter_main,
+                          NULL,
+                          -1,
+                          waiter_stack,
+                          sizeof(waiter_stack));
+    BTASSERT(waiter_p != NULL);
+    BTASSERT(thrd_sleep_ms(10) == 0);
+
+    /* Resume the waiter thread. */
+    BTASSERT(sem_give(&sem, 1) == 0);
+    BTASSERT(thrd_sleep_ms(10) == 0);
+
+    BTASSERT(trace_stop() == 0);
+
+    length = trace_read(&events[0], membersof(events));
+    BTASSERTI(length, >, 0);
+
+    /* The marker is the first event. */
+    BTASSERTI(events[0].type, ==, TRACE_MARKER);
+    BTASSERTI(events[0].info, ==, 5);
+    BTASSERTI(events[0].arg, ==, 0x12345678);
+
+    /* The main thread sleeps 10 ms and then the waiter thread waits
+       forever on the semaphore. */
+    event_p = find_event(&events[0], length, TRACE_SUSPEND);
+    BTASSERT(event_p != NULL);
+    BTASSERTI(event_p->arg, ==, 10);
+    event_p = find_event(event_p + 1,
+                         length - (event_p + 1 - &events[0]),
+                         TRACE_SUSPEND);
+    BTASSERT(event_p != NULL);
+    BTASSERTI(event_p->arg, ==, 0xffffffff);
+
+    event_p = find_event(&events[0], length, TRACE_RESUME);
+    BTASSERT(event_p != NULL);
+    BTASSERTI(event_p->arg, ==, (uint32_t)(uintptr_t)waiter_p);
+
+    event_p = find_event(&events[0], length, TRACE_SEM_GIVE);
+    BTASSERT(event_p != NULL);
+    BTASSERTI(event_p->arg, ==, (uint32_t)(uintptr_t)&sem);
+
+    BTASSERT(find_event(&events[0], length, TRACE_SEM_TAKE) != NULL);
+    BTASSERT(find_event(&events[0], length, TRACE_MUTEX_LOCK) != NULL);
+    BTASSERT(find_event(&events[0], length, TRACE_MUTEX_UNLOCK) != NULL);
+
+    /* Switch to the waiter thread. */
+    event_p = find_event(&events[0], length, TRACE_SWITCH);
+    BTASSERT(event_p != NULL);
+    BTASSERTI(event_p->arg, ==, (uint32_t)(uintptr_t)waiter_p);
+
+    /* Timestamps are increasing. */
+    for (i = 1; i < length; i++) {
+        BTASSERTI((int32_t)(events[i].timestamp - events[i - 1].timestamp),
+                  >=,
+                  0);
+    }
+
+    return (0);
+}
+
+int test_overwrite(struct harness_t *harness_p)
+{
+    struct trace_event_t events[CONFIG_TRACE_EVENTS_MAX];
+    int i;
+
+    trace_set_mask(TRACE_MASK(MARKER));
+    BTASSERT(trace_start() == 0);
+
+    for (i = 0; i < CONFIG_TRACE_EVENTS_MAX + 10; i++) {
+        trace_marker(1, i);
+    }
+
+    BTASSERT(trace_stop() == 0);
+
+    /* Only the newest events are kept. */
+    BTASSERTI(trace_read(&events[0], membersof(events)),
+              ==,
+              CONFIG_TRACE_EVENTS_MAX);
+    BTASSERTI(events[0].arg, ==, 10);
+    BTASSERTI(events[CONFIG_TRACE_EVENTS_MAX - 1].arg,
+              ==,
+              CONFIG_TRACE_EVENTS_MAX + 9);
+
+    /* Nothing is recorded when stopped. */
+    trace_marker(1, 0);
+    BTASSERTI(trace_read(&events[0], 1), ==, 1);
+    BTASSERTI(events[0].arg, ==, 10);
+
+    /* Masked out types are not recorded. */
+    trace_set_mask(TRACE_MASK(SWITCH));
+    BTASSERT(trace_start() == 0);
+    trace_marker(1, 0);
+    BTASSERT(trace_stop() == 0);
+    BTASSERTI(trace_read(&events[0], membersof(events)), ==, 0);
+
+    return (0);
+}
+
+int test_fs(struct harness_t *harness_p)
+{
+    char buf[256];
+    struct queue_t queue;
+    char command[32];
+
+    trace_set_mask(TRACE_ALL);
+
+    strcpy(command, "/debug/trace/start");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    BTASSERT(thrd_sleep_ms(30) == 0);
+    strcpy(command, "/debug/trace/stop");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    /* Dump to standard output for the host tool. */
+    strcpy(command, "/debug/trace/dump");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    trace_set_mask(0);
+    BTASSERT(trace_start() == 0);
+    BTASSERT(trace_stop() == 0);
+    strcpy(command, "/debug/trace/dump");
+    BTASSERT(fs_call(command, NULL, &queue, NULL) == 0);
+    BTASSERTI(harness_expect(&queue,
+                             "trace: cycles_per_second=1000000000 "
+                             "events=0 written=0\r\n",
+                             NULL), ==, 56);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_init, "test_init" },
+        { test_record, "test_record" },
+        { test_overwrite, "test_overwrite" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
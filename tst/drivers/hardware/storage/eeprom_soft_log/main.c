@@ -0,0 +1,425 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define FLASH_ADDRESS                   0x0000
+#define FLASH_SIZE                       0x800
+#define CHUNK_SIZE                       0x100
+#define EEPROM_SIZE       (CHUNK_SIZE - 8 - CONFIG_EEPROM_SOFT_LOG_SIZE)
+#define LOG_ADDRESS                 (8 + EEPROM_SIZE)
+
+static uint8_t flash_buf[FLASH_SIZE];
+static size_t flash_bytes_written;
+
+static struct eeprom_soft_block_t blocks[2] = {
+    {
+        .address = FLASH_ADDRESS,
+        .size = FLASH_SIZE / 2
+    },
+    {
+        .address = FLASH_ADDRESS + FLASH_SIZE / 2,
+        .size = FLASH_SIZE / 2
+    }
+};
+
+static struct flash_driver_t flash;
+static struct eeprom_soft_driver_t eeprom_soft;
+
+static int test_init(struct harness_t *harness_p)
+{
+    BTASSERT(eeprom_soft_module_init() == 0);
+    BTASSERT(flash_init(&flash, &flash_device[0]) == 0);
+    BTASSERT(eeprom_soft_init(&eeprom_soft,
+                              &flash,
+                              &blocks[0],
+                              membersof(blocks),
+                              CHUNK_SIZE) == 0);
+    BTASSERT(eeprom_soft.eeprom_size == EEPROM_SIZE);
+    BTASSERT(eeprom_soft_format(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+
+    return (0);
+}
+
+static int test_append(struct harness_t *harness_p)
+{
+    uint32_t value;
+    uint8_t buf[12];
+
+    /* A small write is appended to the log as a 16 bytes record. */
+    flash_bytes_written = 0;
+    value = 0x12345678;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               16,
+                               &value,
+                               sizeof(value)) == sizeof(value));
+    BTASSERTI(flash_bytes_written, ==, 16);
+    BTASSERT(eeprom_soft.current.chunk_address == FLASH_ADDRESS);
+    BTASSERT(eeprom_soft.log.length == 1);
+
+    value = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              16,
+                              sizeof(value)) == sizeof(value));
+    BTASSERT(value == 0x12345678);
+
+    /* Overlapping records. The most recently written record wins. */
+    memset(&buf[0], 0xaa, sizeof(buf));
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               14,
+                               &buf[0],
+                               4) == 4);
+    BTASSERT(eeprom_soft.log.length == 2);
+
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              12,
+                              sizeof(buf)) == sizeof(buf));
+    BTASSERTM(&buf[0],
+              "\xff\xff\xaa\xaa\xaa\xaa\x34\x12\xff\xff\xff\xff",
+              sizeof(buf));
+
+    /* A record covering older records replaces them in the index. */
+    memset(&buf[0], 0x55, sizeof(buf));
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               12,
+                               &buf[0],
+                               sizeof(buf)) == sizeof(buf));
+    BTASSERT(eeprom_soft.log.length == 1);
+
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              12,
+                              sizeof(buf)) == sizeof(buf));
+    BTASSERTM(&buf[0],
+              "\x55\x55\x55\x55\x55\x55\x55\x55\x55\x55\x55\x55",
+              sizeof(buf));
+
+    return (0);
+}
+
+static int test_mount_replay(struct harness_t *harness_p)
+{
+    uint8_t buf[12];
+    uint16_t value;
+
+    value = 0xbeef;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               EEPROM_SIZE - 2,
+                               &value,
+                               sizeof(value)) == sizeof(value));
+
+    /* Mount replays the log into the in-RAM index. */
+    memset(&eeprom_soft.log, 0, sizeof(eeprom_soft.log));
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft.log.length == 2);
+    BTASSERT(eeprom_soft.log.dirty == 0);
+
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              12,
+                              sizeof(buf)) == sizeof(buf));
+    BTASSERTM(&buf[0],
+              "\x55\x55\x55\x55\x55\x55\x55\x55\x55\x55\x55\x55",
+              sizeof(buf));
+
+    value = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              EEPROM_SIZE - 2,
+                              sizeof(value)) == sizeof(value));
+    BTASSERT(value == 0xbeef);
+
+    return (0);
+}
+
+static int test_compact(struct harness_t *harness_p)
+{
+    uint8_t byte;
+    uint8_t buf[EEPROM_SIZE];
+    int i;
+
+    /* Fill the log. */
+    for (i = 0; eeprom_soft.current.chunk_address == FLASH_ADDRESS; i++) {
+        byte = i;
+        BTASSERT(eeprom_soft_write(&eeprom_soft,
+                                   32 + i,
+                                   &byte,
+                                   sizeof(byte)) == sizeof(byte));
+    }
+
+    /* The log had room for three more 16 bytes records. The fourth
+       write was compacted into the next chunk. */
+    BTASSERTI(i, ==, 4);
+    BTASSERT(eeprom_soft.current.chunk_address == FLASH_ADDRESS + CHUNK_SIZE);
+    BTASSERT(eeprom_soft.log.length == 0);
+    BTASSERT(eeprom_soft.log.address == (FLASH_ADDRESS
+                                         + CHUNK_SIZE
+                                         + LOG_ADDRESS));
+
+    /* All data is preserved. */
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              0,
+                              sizeof(buf)) == sizeof(buf));
+
+    for (i = 0; i < 12; i++) {
+        BTASSERTI(buf[i], ==, 0xff);
+    }
+
+    for (i = 12; i < 24; i++) {
+        BTASSERTI(buf[i], ==, 0x55);
+    }
+
+    for (i = 32; i < 36; i++) {
+        BTASSERTI(buf[i], ==, i - 32);
+    }
+
+    BTASSERTI(buf[EEPROM_SIZE - 2], ==, 0xef);
+    BTASSERTI(buf[EEPROM_SIZE - 1], ==, 0xbe);
+
+    /* The compacted chunk is mounted. */
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft.current.chunk_address == FLASH_ADDRESS + CHUNK_SIZE);
+    BTASSERT(eeprom_soft.log.length == 0);
+
+    return (0);
+}
+
+static int test_large_write(struct harness_t *harness_p)
+{
+    uint8_t buf[EEPROM_SIZE];
+    uintptr_t chunk_address;
+
+    memset(&buf[0], 0x11, sizeof(buf));
+    chunk_address = eeprom_soft.current.chunk_address;
+    BTASSERT(eeprom_soft_write(&eeprom_soft, 0, &buf[0], 1) == 1);
+    BTASSERT(eeprom_soft.log.length == 1);
+
+    /* A record not fitting in the log is written to a new chunk. */
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &buf[0],
+                               sizeof(buf)) == sizeof(buf));
+    BTASSERT(eeprom_soft.current.chunk_address == chunk_address + CHUNK_SIZE);
+
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              0,
+                              sizeof(buf)) == sizeof(buf));
+    BTASSERT(buf[0] == 0x11);
+    BTASSERT(buf[EEPROM_SIZE - 1] == 0x11);
+
+    return (0);
+}
+
+static int test_mount_torn_record(struct harness_t *harness_p)
+{
+    uint32_t value;
+    uintptr_t chunk_address;
+    uintptr_t record_address;
+
+    chunk_address = eeprom_soft.current.chunk_address;
+
+    value = 1;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &value,
+                               sizeof(value)) == sizeof(value));
+    record_address = eeprom_soft.log.address;
+    value = 2;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &value,
+                               sizeof(value)) == sizeof(value));
+
+    /* Corrupt the data of the second record, as if the write was
+       interrupted. */
+    flash_buf[record_address + 8] = 0xff;
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft.log.length == 1);
+    BTASSERT(eeprom_soft.log.dirty == 1);
+    BTASSERT(eeprom_soft.log.address == record_address);
+
+    value = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              0,
+                              sizeof(value)) == sizeof(value));
+    BTASSERT(value == 1);
+
+    /* Next write compacts the chunk. */
+    value = 3;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &value,
+                               sizeof(value)) == sizeof(value));
+    BTASSERT(eeprom_soft.current.chunk_address == chunk_address + CHUNK_SIZE);
+    BTASSERT(eeprom_soft.log.dirty == 0);
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    value = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              0,
+                              sizeof(value)) == sizeof(value));
+    BTASSERT(value == 3);
+
+    return (0);
+}
+
+static int test_write_amplification(struct harness_t *harness_p)
+{
+    uint32_t value;
+    int i;
+    size_t logical_bytes_written;
+
+    BTASSERT(eeprom_soft_format(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+
+    /* Update four bytes settings at various addresses. */
+    flash_bytes_written = 0;
+    logical_bytes_written = 0;
+
+    for (i = 0; i < 1000; i++) {
+        value = i;
+        BTASSERT(eeprom_soft_write(&eeprom_soft,
+                                   4 * ((7 * i) % (EEPROM_SIZE / 4)),
+                                   &value,
+                                   sizeof(value)) == sizeof(value));
+        logical_bytes_written += sizeof(value);
+    }
+
+    std_printf(FSTR("Flash bytes written per logical byte: %u/%u.\r\n"),
+               flash_bytes_written,
+               logical_bytes_written);
+
+    /* Rewriting the whole chunk on every write would write 62 flash
+       bytes per logical byte. */
+    BTASSERTI(flash_bytes_written / logical_bytes_written, <, 8);
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              4 * ((7 * 999) % (EEPROM_SIZE / 4)),
+                              sizeof(value)) == sizeof(value));
+    BTASSERTI(value, ==, 999);
+
+    return (0);
+}
+
+int __wrap_flash_module_init(void)
+{
+    return (0);
+}
+
+int __wrap_flash_init(struct flash_driver_t *self_p,
+                      struct flash_device_t *dev_p)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERT(dev_p != NULL);
+
+    memset(&flash_buf[0], 0, sizeof(flash_buf));
+
+    return (0);
+}
+
+ssize_t __wrap_flash_read(struct flash_driver_t *self_p,
+                          void *dst_p,
+                          uintptr_t src,
+                          size_t size)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERTI(src + size, <=, FLASH_SIZE);
+
+    memcpy(dst_p, &flash_buf[src], size);
+
+    return (size);
+}
+
+ssize_t __wrap_flash_write(struct flash_driver_t *self_p,
+                           uintptr_t dst,
+                           const void *src_p,
+                           size_t size)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERTI(dst + size, <=, FLASH_SIZE);
+
+    size_t i;
+
+    /* Flash bits can only be cleared. */
+    for (i = 0; i < size; i++) {
+        BTASSERTI(flash_buf[dst + i], ==, 0xff);
+    }
+
+    memcpy(&flash_buf[dst], src_p, size);
+    flash_bytes_written += size;
+
+    return (size);
+}
+
+int __wrap_flash_erase(struct flash_driver_t *self_p,
+                       uintptr_t addr,
+                       size_t size)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERTI(addr + size, <=, FLASH_SIZE);
+
+    memset(&flash_buf[addr], 0xff, size);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_init, "test_init" },
+        { test_append, "test_append" },
+        { test_mount_replay, "test_mount_replay" },
+        { test_compact, "test_compact" },
+        { test_large_write, "test_large_write" },
+        { test_mount_torn_record, "test_mount_torn_record" },
+        { test_write_amplification, "test_write_amplification" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
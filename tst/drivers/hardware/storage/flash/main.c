@@ -151,6 +151,186 @@ static int test_read_write(struct harness_t *harness_p)
     return (0);
 }
 
+#elif defined(ARCH_LINUX)
+
+/* Emulated link and flash latency, see the Makefile. */
+#define LINK_CHUNK_US                                   10000
+#define CHUNK_SIZE                              CONFIG_FLASH_LINUX_PAGE_SIZE
+#define NUMBER_OF_CHUNKS                                    8
+
+static THRD_STACK(async_stack, 2048);
+
+static struct flash_driver_t drv;
+static struct flash_async_t async;
+static struct flash_async_job_t jobs[4];
+static uint8_t buffers[2 * CHUNK_SIZE];
+static int number_of_writes;
+static int number_of_erases;
+
+static void on_complete(void *arg_p,
+                        int type,
+                        uintptr_t addr,
+                        size_t size,
+                        int res)
+{
+    if (res != 0) {
+        return;
+    }
+
+    if (type == FLASH_ASYNC_JOB_TYPE_WRITE) {
+        number_of_writes++;
+    } else {
+        number_of_erases++;
+    }
+}
+
+static long to_ms(struct time_t *time_p)
+{
+    return (1000L * time_p->seconds + time_p->nanoseconds / 1000000L);
+}
+
+static int test_read_write(struct harness_t *harness_p)
+{
+    char name[] = "Kalle kula";
+    char buf[16];
+    uint32_t address;
+
+    BTASSERT(flash_init(&drv, &flash_0_dev) == 0);
+
+    /* Write and read over a page boundary. */
+    address = (CONFIG_FLASH_LINUX_PAGE_SIZE - 2);
+
+    BTASSERT(flash_erase(&drv, address, sizeof(name)) == 0);
+    BTASSERT(flash_write(&drv, address, name, sizeof(name)) == sizeof(name));
+
+    memset(buf, 0, sizeof(buf));
+    BTASSERT(flash_read(&drv, buf, address, sizeof(buf)) == sizeof(buf));
+
+    BTASSERT(strcmp(name, buf) == 0);
+    BTASSERT(buf[15] == (char)0xff);
+
+    /* Outside the flash memory. */
+    BTASSERT(flash_read(&drv,
+                        buf,
+                        CONFIG_FLASH_LINUX_DEVICE_SIZE - 2,
+                        sizeof(buf)) == -EINVAL);
+
+    return (0);
+}
+
+static int test_async(struct harness_t *harness_p)
+{
+    uint8_t buf[64];
+    int i;
+
+    BTASSERT(flash_async_init(&async,
+                              &drv,
+                              &jobs[0],
+                              membersof(jobs),
+                              &buffers[0],
+                              sizeof(buffers),
+                              async_stack,
+                              sizeof(async_stack)) == 0);
+    BTASSERT(flash_async_set_callback(&async, on_complete, NULL) == 0);
+    BTASSERT(flash_async_start(&async) == 0);
+
+    /* Erase and write a sector, 64 bytes at a time. */
+    BTASSERT(flash_async_erase(&async, 0, CONFIG_FLASH_LINUX_SECTOR_SIZE) == 0);
+
+    for (i = 0; i < 16; i++) {
+        memset(&buf[0], i, sizeof(buf));
+        BTASSERT(flash_async_write(&async,
+                                   i * sizeof(buf),
+                                   &buf[0],
+                                   sizeof(buf)) == sizeof(buf));
+    }
+
+    /* A non-contiguous write starts a new buffer. */
+    BTASSERT(flash_async_write(&async, 2000, "foo", 3) == 3);
+    BTASSERT(flash_async_sync(&async) == 0);
+    BTASSERT(number_of_erases == 1);
+    BTASSERT(number_of_writes == 5);
+
+    for (i = 0; i < 16; i++) {
+        BTASSERT(flash_read(&drv,
+                            &buf[0],
+                            i * sizeof(buf),
+                            sizeof(buf)) == sizeof(buf));
+        BTASSERT(buf[0] == i);
+        BTASSERT(buf[sizeof(buf) - 1] == i);
+    }
+
+    BTASSERT(flash_read(&drv, &buf[0], 1023, 3) == 3);
+    BTASSERT(buf[0] == 15);
+    BTASSERT(buf[1] == 0xff);
+    BTASSERT(flash_read(&drv, &buf[0], 2000, 3) == 3);
+    BTASSERT(memcmp(&buf[0], "foo", 3) == 0);
+
+    /* Errors are reported by the sync. */
+    BTASSERT(flash_async_write(&async,
+                               CONFIG_FLASH_LINUX_DEVICE_SIZE - 1,
+                               "foo",
+                               3) == 3);
+    BTASSERT(flash_async_sync(&async) == -EINVAL);
+    BTASSERT(flash_async_sync(&async) == 0);
+
+    return (0);
+}
+
+/**
+ * Receive data over an emulated link and write it to flash. The
+ * asynchronous writer programs one chunk while the next is received,
+ * so the total time is close to the link time only.
+ */
+static int test_async_throughput(struct harness_t *harness_p)
+{
+    uint8_t buf[CHUNK_SIZE];
+    struct time_t start;
+    struct time_t stop;
+    struct time_t sync_time;
+    struct time_t async_time;
+    int i;
+
+    memset(&buf[0], 0x5a, sizeof(buf));
+
+    /* Synchronous. */
+    time_get(&start);
+
+    for (i = 0; i < NUMBER_OF_CHUNKS; i++) {
+        thrd_sleep_us(LINK_CHUNK_US);
+        BTASSERT(flash_write(&drv,
+                             i * sizeof(buf),
+                             &buf[0],
+                             sizeof(buf)) == sizeof(buf));
+    }
+
+    time_get(&stop);
+    time_subtract(&sync_time, &stop, &start);
+
+    /* Asynchronous. */
+    time_get(&start);
+
+    for (i = 0; i < NUMBER_OF_CHUNKS; i++) {
+        thrd_sleep_us(LINK_CHUNK_US);
+        BTASSERT(flash_async_write(&async,
+                                   i * sizeof(buf),
+                                   &buf[0],
+                                   sizeof(buf)) == sizeof(buf));
+    }
+
+    BTASSERT(flash_async_sync(&async) == 0);
+    time_get(&stop);
+    time_subtract(&async_time, &stop, &start);
+
+    std_printf(OSTR("synchronous: %ld ms, asynchronous: %ld ms\r\n"),
+               to_ms(&sync_time),
+               to_ms(&async_time));
+
+    BTASSERT(4 * to_ms(&async_time) < 3 * to_ms(&sync_time));
+
+    return (0);
+}
+
 #else
 
 static int test_read_write(struct harness_t *harness_p)
@@ -165,6 +345,10 @@ int main()
     struct harness_t harness;
     struct harness_testcase_t harness_testcases[] = {
         { test_read_write, "test_read_write" },
+#if defined(ARCH_LINUX)
+        { test_async, "test_async" },
+        { test_async_throughput, "test_async_throughput" },
+#endif
         { NULL, NULL }
     };
 
@@ -0,0 +1,411 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct capture_pwm_source_t source;
+static struct capture_driver_t capture;
+static uint8_t buf[256];
+static THRD_STACK(worker_stack, 1024);
+
+/* Period and number of high samples of each channel. */
+static const uint32_t pwms[8][2] = {
+    { 4, 1 },
+    { 10, 5 },
+    { 7, 3 },
+    { 64, 63 },
+    { 3, 0 },
+    { 1, 1 },
+    { 100, 25 },
+    { 33, 32 }
+};
+
+static int source_init(struct capture_pwm_source_t *source_p)
+{
+    int i;
+
+    if (capture_pwm_source_init(source_p, membersof(pwms)) != 0) {
+        return (-1);
+    }
+
+    for (i = 0; i < membersof(pwms); i++) {
+        if (capture_pwm_source_set(source_p,
+                                   i,
+                                   pwms[i][0],
+                                   pwms[i][1]) != 0) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+static void sample(struct capture_driver_t *capture_p, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        sys_lock();
+        capture_sample_isr(capture_p);
+        sys_unlock();
+    }
+}
+
+/**
+ * Measure given number of samples, starting at given sample, one
+ * sample at a time.
+ */
+static void measure(struct capture_report_t *report_p, int first, int count)
+{
+    struct capture_pwm_source_t reference;
+    int i;
+    int channel;
+    int value;
+    int previous;
+    int sample;
+
+    source_init(&reference);
+    memset(report_p, 0, sizeof(*report_p));
+    report_p->number_of_samples = count;
+    previous = 0;
+
+    for (i = 0; i < first + count; i++) {
+        sample = capture_pwm_source_read(&reference);
+
+        if (i == 0) {
+            previous = sample;
+        }
+
+        if (i < first) {
+            previous = sample;
+            continue;
+        }
+
+        for (channel = 0; channel < membersof(pwms); channel++) {
+            value = ((sample >> channel) & 1);
+
+            if (value == 1) {
+                report_p->channels[channel].high++;
+
+                if (((previous >> channel) & 1) == 0) {
+                    report_p->channels[channel].rising_edges++;
+                }
+            } else if (((previous >> channel) & 1) == 1) {
+                report_p->channels[channel].falling_edges++;
+            }
+        }
+
+        previous = sample;
+    }
+}
+
+static int test_init(struct harness_t *harness_p)
+{
+    BTASSERT(capture_pwm_source_init(&source, 0) == -EINVAL);
+    BTASSERT(capture_pwm_source_init(&source, 9) == -EINVAL);
+    BTASSERT(capture_pwm_source_init(&source, 2) == 0);
+    BTASSERT(capture_pwm_source_set(&source, 2, 4, 1) == -EINVAL);
+    BTASSERT(capture_pwm_source_set(&source, 0, 0, 0) == -EINVAL);
+    BTASSERT(capture_pwm_source_set(&source, 0, 4, 5) == -EINVAL);
+
+    /* Number of channels. */
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          9,
+                          0,
+                          &buf[0],
+                          sizeof(buf),
+                          256) == -EINVAL);
+
+    /* Ring buffer size. */
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          1,
+                          0,
+                          &buf[0],
+                          96,
+                          256) == -EINVAL);
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          1,
+                          0,
+                          &buf[0],
+                          32,
+                          256) == -EINVAL);
+
+    /* Samples per report. */
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          1,
+                          0,
+                          &buf[0],
+                          sizeof(buf),
+                          63) == -EINVAL);
+
+    return (0);
+}
+
+static int test_pwm_source(struct harness_t *harness_p)
+{
+    BTASSERT(capture_pwm_source_init(&source, 2) == 0);
+    BTASSERT(capture_pwm_source_set(&source, 0, 4, 1) == 0);
+    BTASSERT(capture_pwm_source_set(&source, 1, 3, 2) == 0);
+
+    BTASSERT(capture_pwm_source_read(&source) == 0x3);
+    BTASSERT(capture_pwm_source_read(&source) == 0x2);
+    BTASSERT(capture_pwm_source_read(&source) == 0x0);
+    BTASSERT(capture_pwm_source_read(&source) == 0x2);
+    BTASSERT(capture_pwm_source_read(&source) == 0x3);
+    BTASSERT(capture_pwm_source_read(&source) == 0x0);
+
+    return (0);
+}
+
+static int test_analyze(struct harness_t *harness_p)
+{
+    struct capture_report_t report;
+    struct capture_report_t expected;
+    int i;
+
+    BTASSERT(source_init(&source) == 0);
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          membersof(pwms),
+                          0,
+                          &buf[0],
+                          sizeof(buf),
+                          1024) == 0);
+
+    /* Only complete blocks are analyzed. */
+    sample(&capture, 100);
+    BTASSERT(capture_analyze(&capture) == 64);
+    BTASSERT(capture_analyze(&capture) == 0);
+
+    for (i = 0; i < 7; i++) {
+        sample(&capture, 128);
+        BTASSERT(capture_analyze(&capture) == 128);
+    }
+
+    sample(&capture, 28);
+    BTASSERT(capture_analyze(&capture) == 64);
+
+    /* Same result as when measured one sample at a time. */
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    measure(&expected, 0, 1024);
+    BTASSERT(report.number_of_samples == 1024);
+    BTASSERT(report.overruns == 0);
+    BTASSERTM(&report, &expected, sizeof(report));
+
+    /* A few known values. */
+    BTASSERT(report.channels[0].high == 256);
+    BTASSERT(report.channels[0].rising_edges == 255);
+    BTASSERT(report.channels[0].falling_edges == 256);
+    BTASSERT(report.channels[4].high == 0);
+    BTASSERT(report.channels[4].rising_edges == 0);
+    BTASSERT(report.channels[5].high == 1024);
+    BTASSERT(report.channels[5].falling_edges == 0);
+
+    return (0);
+}
+
+static int test_report_period(struct harness_t *harness_p)
+{
+    struct capture_report_t report;
+    struct capture_report_t expected;
+
+    BTASSERT(source_init(&source) == 0);
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          membersof(pwms),
+                          0,
+                          &buf[0],
+                          sizeof(buf),
+                          100) == 0);
+
+    /* Reports end within blocks. */
+    sample(&capture, 256);
+    BTASSERT(capture_analyze(&capture) == 256);
+
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    measure(&expected, 0, 100);
+    BTASSERTM(&report, &expected, sizeof(report));
+
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    measure(&expected, 100, 100);
+    BTASSERTM(&report, &expected, sizeof(report));
+
+    return (0);
+}
+
+static int test_overrun(struct harness_t *harness_p)
+{
+    struct capture_report_t report;
+
+    BTASSERT(capture_pwm_source_init(&source, 1) == 0);
+    BTASSERT(capture_pwm_source_set(&source, 0, 2, 1) == 0);
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          1,
+                          0,
+                          &buf[0],
+                          64,
+                          64) == 0);
+
+    /* The last 36 samples does not fit in the ring buffer. */
+    sample(&capture, 100);
+    BTASSERT(capture_analyze(&capture) == 64);
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    BTASSERT(report.number_of_samples == 64);
+    BTASSERT(report.overruns == 36);
+    BTASSERT(report.channels[0].high == 32);
+    BTASSERT(report.channels[0].rising_edges == 31);
+    BTASSERT(report.channels[0].falling_edges == 32);
+
+    sample(&capture, 64);
+    BTASSERT(capture_analyze(&capture) == 64);
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    BTASSERT(report.overruns == 0);
+    BTASSERT(report.channels[0].rising_edges == 32);
+
+    return (0);
+}
+
+static int test_worker(struct harness_t *harness_p)
+{
+    struct capture_report_t report;
+    struct capture_report_t expected;
+    int i;
+
+    BTASSERT(source_init(&source) == 0);
+    BTASSERT(capture_init(&capture,
+                          capture_pwm_source_read,
+                          &source,
+                          membersof(pwms),
+                          0,
+                          &buf[0],
+                          sizeof(buf),
+                          1024) == 0);
+    BTASSERT(capture_start(&capture,
+                           worker_stack,
+                           sizeof(worker_stack)) == 0);
+
+    /* The worker thread analyzes the samples, a ring buffer at a
+       time. */
+    for (i = 0; i < 4; i++) {
+        sample(&capture, 256);
+        thrd_sleep_ms(10);
+    }
+
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    measure(&expected, 0, 1024);
+    BTASSERTM(&report, &expected, sizeof(report));
+
+    /* Stopping discards the current report and the unread reports. */
+    for (i = 0; i < 5; i++) {
+        sample(&capture, 250);
+        thrd_sleep_ms(10);
+    }
+
+    BTASSERT(capture_stop(&capture) == 0);
+
+    /* Only new samples in the report after a restart. */
+    BTASSERT(source_init(&source) == 0);
+    BTASSERT(capture_start(&capture,
+                           worker_stack,
+                           sizeof(worker_stack)) == 0);
+
+    for (i = 0; i < 4; i++) {
+        sample(&capture, 256);
+        thrd_sleep_ms(10);
+    }
+
+    BTASSERT(capture_read_report(&capture, &report) == 0);
+    BTASSERTM(&report, &expected, sizeof(report));
+    BTASSERT(capture_stop(&capture) == 0);
+
+    return (0);
+}
+
+static int test_timer(struct harness_t *harness_p)
+{
+    struct capture_driver_t timer_capture;
+    struct capture_report_t report;
+    uint8_t timer_buf[64];
+    THRD_STACK(stack, 1024);
+
+    BTASSERT(capture_pwm_source_init(&source, 1) == 0);
+    BTASSERT(capture_pwm_source_set(&source, 0, 2, 1) == 0);
+    BTASSERT(capture_init(&timer_capture,
+                          capture_pwm_source_read,
+                          &source,
+                          1,
+                          CONFIG_SYSTEM_TICK_FREQUENCY,
+                          &timer_buf[0],
+                          sizeof(timer_buf),
+                          64) == 0);
+    BTASSERT(capture_start(&timer_capture, stack, sizeof(stack)) == 0);
+    BTASSERT(capture_read_report(&timer_capture, &report) == 0);
+    BTASSERT(capture_stop(&timer_capture) == 0);
+
+    BTASSERT(report.number_of_samples == 64);
+    BTASSERT(report.overruns == 0);
+    BTASSERT(report.channels[0].high == 32);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_init, "test_init" },
+        { test_pwm_source, "test_pwm_source" },
+        { test_analyze, "test_analyze" },
+        { test_report_period, "test_report_period" },
+        { test_overrun, "test_overrun" },
+        { test_worker, "test_worker" },
+        { test_timer, "test_timer" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
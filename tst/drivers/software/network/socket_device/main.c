@@ -0,0 +1,494 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+
+/* Device request types. */
+#define TYPE_UNSUPPORTED_TYPE                             (0)
+#define TYPE_UART_DEVICE_REQUEST                          (1)
+#define TYPE_CAN_DEVICE_REQUEST                           (7)
+#define TYPE_I2C_DEVICE_REQUEST                           (9)
+#define TYPE_BINARY                                   (0x100)
+
+static struct uart_driver_t uart[2];
+static uint8_t uart_rxbufs[2][4096];
+static struct can_driver_t can;
+static struct can_frame_t can_rxbuf[8];
+static struct i2c_driver_t i2c;
+static uint8_t buf[4096];
+
+/**
+ * Connect to the socket device TCP server. Retries while the server
+ * thread is starting.
+ */
+static int client_open(void)
+{
+    int sock;
+    int i;
+    struct sockaddr_in addr;
+    struct timeval timeout;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(47000);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (i = 0; i < 100; i++) {
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+
+        if (sock < 0) {
+            return (-1);
+        }
+
+        if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            /* Never hang the suite on a missing response. */
+            timeout.tv_sec = 2;
+            timeout.tv_usec = 0;
+            setsockopt(sock,
+                       SOL_SOCKET,
+                       SO_RCVTIMEO,
+                       &timeout,
+                       sizeof(timeout));
+
+            return (sock);
+        }
+
+        close(sock);
+        thrd_sleep_ms(10);
+    }
+
+    return (-1);
+}
+
+static int client_write(int sock, const void *buf_p, size_t size)
+{
+    if (write(sock, buf_p, size) != size) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Read exactly given number of bytes.
+ */
+static int client_read(int sock, void *buf_p, size_t size)
+{
+    ssize_t res;
+    uint8_t *u8_p;
+
+    u8_p = buf_p;
+
+    while (size > 0) {
+        res = read(sock, u8_p, size);
+
+        if (res <= 0) {
+            return (-1);
+        }
+
+        u8_p += res;
+        size -= res;
+    }
+
+    return (0);
+}
+
+static int client_write_request(int sock, int type, const char *device_p)
+{
+    uint32_t header[2];
+
+    header[0] = htonl(type);
+    header[1] = htonl(strlen(device_p));
+
+    if (client_write(sock, &header[0], sizeof(header)) != 0) {
+        return (-1);
+    }
+
+    return (client_write(sock, device_p, strlen(device_p)));
+}
+
+/**
+ * Request given device and return the result in the response.
+ */
+static int client_request(int sock, int type, const char *device_p)
+{
+    uint32_t response[3];
+
+    if (client_write_request(sock, type, device_p) != 0) {
+        return (-EIO);
+    }
+
+    if (client_read(sock, &response[0], sizeof(response)) != 0) {
+        return (-EIO);
+    }
+
+    if ((ntohl(response[0]) != type + 1) || (ntohl(response[1]) != 4)) {
+        return (-EPROTO);
+    }
+
+    return (ntohl(response[2]));
+}
+
+/**
+ * Connect to given device. Retries while a previous client of the
+ * device is being disconnected.
+ */
+static int client_connect(int type, const char *device_p)
+{
+    int sock;
+    int res;
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        sock = client_open();
+
+        if (sock < 0) {
+            return (-1);
+        }
+
+        res = client_request(sock, type, device_p);
+
+        if (res == 0) {
+            return (sock);
+        }
+
+        close(sock);
+
+        if (res != -EADDRINUSE) {
+            return (res);
+        }
+
+        thrd_sleep_ms(10);
+    }
+
+    return (-1);
+}
+
+static int test_init(struct harness_t *harness_p)
+{
+    int i;
+
+    for (i = 0; i < membersof(uart); i++) {
+        BTASSERT(uart_init(&uart[i],
+                           &uart_device[i + 1],
+                           115200,
+                           &uart_rxbufs[i][0],
+                           sizeof(uart_rxbufs[i])) == 0);
+        BTASSERT(uart_start(&uart[i]) == 0);
+    }
+
+    BTASSERT(can_init(&can,
+                      &can_device[0],
+                      CAN_SPEED_500KBPS,
+                      &can_rxbuf[0],
+                      sizeof(can_rxbuf)) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    BTASSERT(i2c_init(&i2c, &i2c_device[0], I2C_BAUDRATE_100KBPS, -1) == 0);
+    BTASSERT(i2c_start(&i2c) == 0);
+
+    return (0);
+}
+
+static int test_idle_clients(struct harness_t *harness_p)
+{
+    int idle[2];
+    int sock;
+    uint32_t type;
+
+    /* One client that sends nothing and one that sends part of the
+       request header. */
+    idle[0] = client_open();
+    BTASSERT(idle[0] >= 0);
+    idle[1] = client_open();
+    BTASSERT(idle[1] >= 0);
+    type = htonl(TYPE_UART_DEVICE_REQUEST);
+    BTASSERT(client_write(idle[1], &type, 3) == 0);
+
+    /* Other clients are still served. */
+    sock = client_connect(TYPE_UART_DEVICE_REQUEST, "1");
+    BTASSERT(sock >= 0);
+    close(sock);
+
+    /* The partial request is completed later. */
+    BTASSERT(client_write(idle[1], ((uint8_t *)&type) + 3, 1) == 0);
+    BTASSERT(client_write(idle[1], "\0\0\0\0", 4) == 0);
+    BTASSERT(client_read(idle[1], &buf[0], 12) == 0);
+    BTASSERT(memcmp(&buf[0],
+                    "\x00\x00\x00\x02\x00\x00\x00\x04\xff\xff\xff\xed",
+                    12) == 0);
+
+    close(idle[0]);
+    close(idle[1]);
+
+    return (0);
+}
+
+static int test_bad_requests(struct harness_t *harness_p)
+{
+    int sock;
+    int sock2;
+    uint32_t header[2];
+
+    /* Unsupported type. */
+    sock = client_open();
+    BTASSERT(sock >= 0);
+    BTASSERT(client_write_request(sock, 1000, "0") == 0);
+    BTASSERT(client_read(sock, &header[0], sizeof(header)) == 0);
+    BTASSERT(ntohl(header[0]) == TYPE_UNSUPPORTED_TYPE);
+    BTASSERT(ntohl(header[1]) == 0);
+    BTASSERT(read(sock, &buf[0], 1) == 0);
+    close(sock);
+
+    /* Too long device name. */
+    sock = client_open();
+    BTASSERT(sock >= 0);
+    header[0] = htonl(TYPE_UART_DEVICE_REQUEST);
+    header[1] = htonl(64);
+    BTASSERT(client_write(sock, &header[0], sizeof(header)) == 0);
+    BTASSERT(read(sock, &buf[0], 1) == 0);
+    close(sock);
+
+    /* Missing device. */
+    sock = client_open();
+    BTASSERT(sock >= 0);
+    BTASSERT(client_request(sock, TYPE_UART_DEVICE_REQUEST, "99") == -ENODEV);
+    close(sock);
+
+    /* Device already in use. */
+    sock = client_connect(TYPE_UART_DEVICE_REQUEST, "1");
+    BTASSERT(sock >= 0);
+    sock2 = client_open();
+    BTASSERT(sock2 >= 0);
+    BTASSERT(client_request(sock2,
+                            TYPE_UART_DEVICE_REQUEST,
+                            "1") == -EADDRINUSE);
+    close(sock2);
+    close(sock);
+
+    return (0);
+}
+
+static int test_uart_text(struct harness_t *harness_p)
+{
+    int sock;
+
+    sock = client_connect(TYPE_UART_DEVICE_REQUEST, "1");
+    BTASSERT(sock >= 0);
+
+    /* Client to device. */
+    BTASSERT(client_write(sock, "hello", 5) == 0);
+    BTASSERT(uart_read(&uart[0], &buf[0], 5) == 5);
+    BTASSERT(memcmp(&buf[0], "hello", 5) == 0);
+
+    /* Device to client. */
+    BTASSERT(uart_write(&uart[0], "world", 5) == 5);
+    BTASSERT(client_read(sock, &buf[0], 5) == 0);
+    BTASSERT(memcmp(&buf[0], "world", 5) == 0);
+
+    close(sock);
+
+    return (0);
+}
+
+static int test_uart_binary(struct harness_t *harness_p)
+{
+    int sock;
+    int i;
+    static uint8_t frames[2 + 2000 + 2 + 2];
+    static uint8_t data[2000];
+
+    sock = client_connect(TYPE_UART_DEVICE_REQUEST | TYPE_BINARY, "2");
+    BTASSERT(sock >= 0);
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    /* A frame larger than the server input buffer followed by a
+       small frame, written at once. */
+    frames[0] = (sizeof(data) >> 8);
+    frames[1] = (sizeof(data) & 0xff);
+    memcpy(&frames[2], &data[0], sizeof(data));
+    frames[2 + sizeof(data)] = 0;
+    frames[2 + sizeof(data) + 1] = 2;
+    frames[2 + sizeof(data) + 2] = 'o';
+    frames[2 + sizeof(data) + 3] = 'k';
+    BTASSERT(client_write(sock, &frames[0], sizeof(frames)) == 0);
+    BTASSERT(uart_read(&uart[1], &buf[0], sizeof(data)) == sizeof(data));
+    BTASSERT(memcmp(&buf[0], &data[0], sizeof(data)) == 0);
+    BTASSERT(uart_read(&uart[1], &buf[0], 2) == 2);
+    BTASSERT(memcmp(&buf[0], "ok", 2) == 0);
+
+    /* An empty frame. */
+    BTASSERT(client_write(sock, "\x00\x00\x00\x01" "a", 5) == 0);
+    BTASSERT(uart_read(&uart[1], &buf[0], 1) == 1);
+    BTASSERT(buf[0] == 'a');
+
+    /* Device to client. */
+    BTASSERT(uart_write(&uart[1], &data[0], 1500) == 1500);
+    BTASSERT(client_read(sock, &buf[0], 2 + 1500) == 0);
+    BTASSERT(buf[0] == (1500 >> 8));
+    BTASSERT(buf[1] == (1500 & 0xff));
+    BTASSERT(memcmp(&buf[2], &data[0], 1500) == 0);
+
+    close(sock);
+
+    return (0);
+}
+
+static int test_can_text(struct harness_t *harness_p)
+{
+    int sock;
+    struct can_frame_t frame;
+    const char *line_p;
+
+    sock = client_connect(TYPE_CAN_DEVICE_REQUEST, "0");
+    BTASSERT(sock >= 0);
+
+    /* A malformed line is skipped. */
+    BTASSERT(client_write(sock,
+                          "id=00000xyz,extended=0,size=1,data=00\r\n"
+                          "id=00000123,extended=1,size=2,data=0102\r\n",
+                          80) == 0);
+    BTASSERT(can_read(&can, &frame, sizeof(frame)) == sizeof(frame));
+    BTASSERT(frame.id == 0x123);
+    BTASSERT(frame.extended_frame == 1);
+    BTASSERT(frame.size == 2);
+    BTASSERT(frame.data.u8[0] == 0x01);
+    BTASSERT(frame.data.u8[1] == 0x02);
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = 0x456;
+    frame.size = 1;
+    frame.data.u8[0] = 0xab;
+    BTASSERT(can_write(&can, &frame, sizeof(frame)) == sizeof(frame));
+    line_p = "id=00000456,extended=0,size=1,data=ab\r\n";
+    BTASSERT(client_read(sock, &buf[0], strlen(line_p)) == 0);
+    BTASSERT(memcmp(&buf[0], line_p, strlen(line_p)) == 0);
+
+    close(sock);
+
+    return (0);
+}
+
+static int test_can_binary(struct harness_t *harness_p)
+{
+    int sock;
+    struct can_frame_t frames[2];
+    static uint8_t input[10 + 2 + 1200 + 16];
+    size_t size;
+
+    sock = client_connect(TYPE_CAN_DEVICE_REQUEST | TYPE_BINARY, "0");
+    BTASSERT(sock >= 0);
+
+    /* A standard frame, a frame too big to be a CAN frame and an
+       extended frame. */
+    size = 0;
+    memcpy(&input[size], "\x00\x08\x00\x00\x01\x23\x00\x02\x01\x02", 10);
+    size += 10;
+    input[size++] = (1200 >> 8);
+    input[size++] = (1200 & 0xff);
+    memset(&input[size], 0x55, 1200);
+    size += 1200;
+    memcpy(&input[size],
+           "\x00\x0e\x01\xab\xcd\xef\x01\x08\x01\x02\x03\x04\x05\x06\x07\x08",
+           16);
+    size += 16;
+    BTASSERT(client_write(sock, &input[0], size) == 0);
+
+    BTASSERT(can_read(&can, &frames[0], sizeof(frames)) == sizeof(frames));
+    BTASSERT(frames[0].id == 0x123);
+    BTASSERT(frames[0].extended_frame == 0);
+    BTASSERT(frames[0].size == 2);
+    BTASSERT(frames[0].data.u8[0] == 0x01);
+    BTASSERT(frames[0].data.u8[1] == 0x02);
+    BTASSERT(frames[1].id == 0x1abcdef);
+    BTASSERT(frames[1].extended_frame == 1);
+    BTASSERT(frames[1].size == 8);
+    BTASSERT(memcmp(&frames[1].data.u8[0],
+                    "\x01\x02\x03\x04\x05\x06\x07\x08",
+                    8) == 0);
+
+    /* Both frames are written to the client. */
+    BTASSERT(can_write(&can, &frames[0], sizeof(frames)) == sizeof(frames));
+    BTASSERT(client_read(sock, &buf[0], 10 + 16) == 0);
+    BTASSERT(memcmp(&buf[0], &input[0], 10) == 0);
+    BTASSERT(memcmp(&buf[10], &input[10 + 2 + 1200], 16) == 0);
+
+    close(sock);
+
+    return (0);
+}
+
+static int test_i2c_binary(struct harness_t *harness_p)
+{
+    int sock;
+
+    sock = client_connect(TYPE_I2C_DEVICE_REQUEST | TYPE_BINARY, "0");
+    BTASSERT(sock >= 0);
+
+    BTASSERT(i2c_write(&i2c, 0x57, "\x01\x02\x03", 3) == 3);
+    BTASSERT(client_read(sock, &buf[0], 7) == 0);
+    BTASSERT(memcmp(&buf[0], "\x00\x05\x00\x57\x01\x02\x03", 7) == 0);
+
+    close(sock);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_init, "test_init" },
+        { test_idle_clients, "test_idle_clients" },
+        { test_bad_requests, "test_bad_requests" },
+        { test_uart_text, "test_uart_text" },
+        { test_uart_binary, "test_uart_binary" },
+        { test_can_text, "test_can_text" },
+        { test_can_binary, "test_can_binary" },
+        { test_i2c_binary, "test_i2c_binary" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
@@ -0,0 +1,424 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+#include <net/if.h>
+#include <linux/can.h>
+
+/* The test runs against this virtual CAN interface, if it exists. */
+#define INTERFACE                                           "vcan0"
+
+static struct can_driver_t can;
+static struct can_frame_t rxbuf[128];
+static struct can_frame_t frames[100];
+static int peer = -1;
+
+/**
+ * Open a raw socket on the test interface, used as the other node on
+ * the bus.
+ */
+static int peer_open(void)
+{
+    int sock;
+    struct ifreq ifr;
+    struct sockaddr_can addr;
+    struct timeval timeout;
+
+    sock = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    if (sock < 0) {
+        return (-1);
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    strcpy(&ifr.ifr_name[0], INTERFACE);
+
+    if (ioctl(sock, SIOCGIFINDEX, &ifr) != 0) {
+        goto err;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        goto err;
+    }
+
+    /* Never hang the suite on a missing frame. */
+    timeout.tv_sec = 2;
+    timeout.tv_usec = 0;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    return (sock);
+
+ err:
+    close(sock);
+
+    return (-1);
+}
+
+static int peer_write(uint32_t can_id, const void *buf_p, size_t size)
+{
+    struct can_frame frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = can_id;
+    frame.can_dlc = size;
+    memcpy(&frame.data[0], buf_p, size);
+
+    if (write(peer, &frame, sizeof(frame)) != sizeof(frame)) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+static int peer_read(struct can_frame *frame_p)
+{
+    if (read(peer, frame_p, sizeof(*frame_p)) != sizeof(*frame_p)) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Read given number of frames from the driver, with a timeout.
+ */
+static int read_frames(struct can_frame_t *frames_p, int count)
+{
+    struct time_t timeout;
+    int i;
+
+    timeout.seconds = 2;
+    timeout.nanoseconds = 0;
+
+    for (i = 0; i < count; i++) {
+        if (chan_poll(&can, &timeout) == NULL) {
+            return (-ETIMEDOUT);
+        }
+
+        if (can_read(&can,
+                     &frames_p[i],
+                     sizeof(frames_p[i])) != sizeof(frames_p[i])) {
+            return (-EIO);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Returns true(1) if no frame is received within given time.
+ */
+static int no_frame_received(int ms)
+{
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 1000000L * ms;
+
+    return (chan_poll(&can, &timeout) == NULL);
+}
+
+/**
+ * Current time in microseconds, as SocketCAN software timestamps.
+ */
+static uint32_t now_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+static int test_init(struct harness_t *harness_p)
+{
+    peer = peer_open();
+
+    if (peer < 0) {
+        std_printf(OSTR("No " INTERFACE " interface. Create it with:\r\n"
+                        "  sudo modprobe vcan\r\n"
+                        "  sudo ip link add dev vcan0 type vcan\r\n"
+                        "  sudo ip link set up vcan0\r\n"));
+
+        return (1);
+    }
+
+    BTASSERT(can_port_set_interface(&can_device[0], INTERFACE) == 0);
+    BTASSERT(can_init(&can,
+                      &can_device[0],
+                      CAN_SPEED_500KBPS,
+                      &rxbuf[0],
+                      sizeof(rxbuf)) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    return (0);
+}
+
+static int test_read(struct harness_t *harness_p)
+{
+    if (peer < 0) {
+        return (1);
+    }
+
+    BTASSERT(peer_write(0x123, "\x01\x02", 2) == 0);
+    BTASSERT(peer_write(0x1abcdef | CAN_EFF_FLAG,
+                        "\x01\x02\x03\x04\x05\x06\x07\x08",
+                        8) == 0);
+    BTASSERT(peer_write(0x7ff | CAN_RTR_FLAG, "", 0) == 0);
+
+    BTASSERT(read_frames(&frames[0], 3) == 0);
+
+    BTASSERT(frames[0].id == 0x123);
+    BTASSERT(frames[0].extended_frame == 0);
+    BTASSERT(frames[0].rtr == 0);
+    BTASSERT(frames[0].size == 2);
+    BTASSERT(memcmp(&frames[0].data.u8[0], "\x01\x02", 2) == 0);
+
+    BTASSERT(frames[1].id == 0x1abcdef);
+    BTASSERT(frames[1].extended_frame == 1);
+    BTASSERT(frames[1].size == 8);
+    BTASSERT(memcmp(&frames[1].data.u8[0],
+                    "\x01\x02\x03\x04\x05\x06\x07\x08",
+                    8) == 0);
+
+    BTASSERT(frames[2].id == 0x7ff);
+    BTASSERT(frames[2].extended_frame == 0);
+    BTASSERT(frames[2].rtr == 1);
+    BTASSERT(frames[2].size == 0);
+
+    return (0);
+}
+
+static int test_write(struct harness_t *harness_p)
+{
+    struct can_frame frame;
+
+    if (peer < 0) {
+        return (1);
+    }
+
+    memset(&frames[0], 0, 3 * sizeof(frames[0]));
+    frames[0].id = 0x456;
+    frames[0].size = 3;
+    memcpy(&frames[0].data.u8[0], "\x0a\x0b\x0c", 3);
+    frames[1].id = 0x12345678;
+    frames[1].extended_frame = 1;
+    frames[1].size = 1;
+    frames[1].data.u8[0] = 0xff;
+    frames[2].id = 0x001;
+    frames[2].rtr = 1;
+
+    BTASSERT(can_write(&can,
+                       &frames[0],
+                       3 * sizeof(frames[0])) == 3 * sizeof(frames[0]));
+
+    BTASSERT(peer_read(&frame) == 0);
+    BTASSERT(frame.can_id == 0x456);
+    BTASSERT(frame.can_dlc == 3);
+    BTASSERT(memcmp(&frame.data[0], "\x0a\x0b\x0c", 3) == 0);
+
+    BTASSERT(peer_read(&frame) == 0);
+    BTASSERT(frame.can_id == (0x12345678 | CAN_EFF_FLAG));
+    BTASSERT(frame.can_dlc == 1);
+    BTASSERT(frame.data[0] == 0xff);
+
+    BTASSERT(peer_read(&frame) == 0);
+    BTASSERT(frame.can_id == (0x001 | CAN_RTR_FLAG));
+    BTASSERT(frame.can_dlc == 0);
+
+    /* Frames written by the driver are not received by itself. */
+    BTASSERT(no_frame_received(50));
+
+    return (0);
+}
+
+static int test_batching(struct harness_t *harness_p)
+{
+    struct can_frame frame;
+    uint8_t data;
+    int i;
+
+    if (peer < 0) {
+        return (1);
+    }
+
+    /* More frames than read by one recvmmsg() call. */
+    for (i = 0; i < membersof(frames); i++) {
+        data = i;
+        BTASSERT(peer_write(i, &data, 1) == 0);
+    }
+
+    BTASSERT(read_frames(&frames[0], membersof(frames)) == 0);
+
+    for (i = 0; i < membersof(frames); i++) {
+        BTASSERTI(frames[i].id, ==, i);
+        BTASSERTI(frames[i].data.u8[0], ==, i);
+    }
+
+    /* More frames than written by one sendmmsg() call. */
+    BTASSERT(can_write(&can, &frames[0], sizeof(frames)) == sizeof(frames));
+
+    for (i = 0; i < membersof(frames); i++) {
+        BTASSERT(peer_read(&frame) == 0);
+        BTASSERTI(frame.can_id, ==, i);
+        BTASSERTI(frame.data[0], ==, i);
+    }
+
+    return (0);
+}
+
+static int test_filters(struct harness_t *harness_p)
+{
+    static const struct can_port_filter_t filters[] = {
+        { .id = 0x100, .mask = 0x7f0, .extended_frame = 0 },
+        { .id = 0x1000000, .mask = 0x1fffffff, .extended_frame = 1 }
+    };
+
+    if (peer < 0) {
+        return (1);
+    }
+
+    BTASSERT(can_port_set_filters(&can, &filters[0], membersof(filters)) == 0);
+
+    BTASSERT(peer_write(0x200, "\x01", 1) == 0);
+    BTASSERT(peer_write(0x105, "\x02", 1) == 0);
+    BTASSERT(peer_write(0x105 | CAN_EFF_FLAG, "\x03", 1) == 0);
+    BTASSERT(peer_write(0x1000000 | CAN_EFF_FLAG, "\x04", 1) == 0);
+    BTASSERT(peer_write(0x1000001 | CAN_EFF_FLAG, "\x05", 1) == 0);
+
+    BTASSERT(read_frames(&frames[0], 2) == 0);
+    BTASSERT(frames[0].id == 0x105);
+    BTASSERT(frames[0].extended_frame == 0);
+    BTASSERT(frames[0].data.u8[0] == 0x02);
+    BTASSERT(frames[1].id == 0x1000000);
+    BTASSERT(frames[1].extended_frame == 1);
+    BTASSERT(frames[1].data.u8[0] == 0x04);
+    BTASSERT(no_frame_received(50));
+
+    /* Receive all frames again. */
+    BTASSERT(can_port_set_filters(&can, NULL, 0) == 0);
+    BTASSERT(peer_write(0x200, "\x06", 1) == 0);
+    BTASSERT(read_frames(&frames[0], 1) == 0);
+    BTASSERT(frames[0].id == 0x200);
+
+    return (0);
+}
+
+static int test_timestamps(struct harness_t *harness_p)
+{
+    uint32_t before;
+    uint32_t after;
+
+    if (peer < 0) {
+        return (1);
+    }
+
+    before = now_us();
+    BTASSERT(peer_write(0x001, "", 0) == 0);
+    thrd_sleep_ms(20);
+    BTASSERT(peer_write(0x002, "", 0) == 0);
+    BTASSERT(read_frames(&frames[0], 2) == 0);
+    after = now_us();
+
+    /* Reception times in microseconds, in order. */
+    BTASSERT((uint32_t)(frames[0].timestamp - before) <= after - before);
+    BTASSERT((uint32_t)(frames[1].timestamp - before) <= after - before);
+    BTASSERTI((uint32_t)(frames[1].timestamp - frames[0].timestamp),
+              >=,
+              15000);
+
+    return (0);
+}
+
+static int test_stop(struct harness_t *harness_p)
+{
+    struct time_t start;
+    struct time_t stop;
+    struct time_t diff;
+
+    if (peer < 0) {
+        return (1);
+    }
+
+    /* The reader is woken up and returns by itself. */
+    time_get(&start);
+    BTASSERT(can_stop(&can) == 0);
+    time_get(&stop);
+    time_subtract(&diff, &stop, &start);
+    BTASSERT(diff.seconds == 0);
+
+    /* Frames are not received while stopped. */
+    BTASSERT(peer_write(0x001, "", 0) == 0);
+    BTASSERT(no_frame_received(50));
+
+    /* The system lock is free and the driver can be restarted. */
+    sys_lock();
+    sys_unlock();
+    BTASSERT(can_start(&can) == 0);
+    BTASSERT(peer_write(0x002, "\x02", 1) == 0);
+    BTASSERT(read_frames(&frames[0], 1) == 0);
+    BTASSERT(frames[0].id == 0x002);
+    BTASSERT(can_stop(&can) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_init, "test_init" },
+        { test_read, "test_read" },
+        { test_write, "test_write" },
+        { test_batching, "test_batching" },
+        { test_filters, "test_filters" },
+        { test_timestamps, "test_timestamps" },
+        { test_stop, "test_stop" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
@@ -0,0 +1,317 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/**
+ * A channel reading from a string.
+ */
+struct string_t {
+    struct chan_t base;
+    const char *buf_p;
+    size_t pos;
+    size_t size;
+};
+
+static struct string_t string;
+static char value[16];
+
+static ssize_t string_read(void *chan_p, void *buf_p, size_t size)
+{
+    struct string_t *string_p;
+
+    string_p = chan_p;
+
+    if (string_p->pos + size > string_p->size) {
+        return (-1);
+    }
+
+    memcpy(buf_p, &string_p->buf_p[string_p->pos], size);
+    string_p->pos += size;
+
+    return (size);
+}
+
+static size_t string_size(void *chan_p)
+{
+    struct string_t *string_p;
+
+    string_p = chan_p;
+
+    return (string_p->size - string_p->pos);
+}
+
+static void string_init(const char *buf_p)
+{
+    chan_init(&string.base, string_read, chan_write_null, string_size);
+    string.buf_p = buf_p;
+    string.pos = 0;
+    string.size = strlen(buf_p);
+}
+
+static int reader_init(struct json_reader_t *reader_p, const char *buf_p)
+{
+    string_init(buf_p);
+
+    return (json_reader_init(reader_p, &string, &value[0], sizeof(value)));
+}
+
+static int test_events(struct harness_t *harness_p)
+{
+    struct json_reader_t reader;
+
+    BTASSERT(reader_init(&reader,
+                         "{\"a\": [1, -2.5e3, true, false, null],"
+                         " \"b\": {}, \"c\": [], \"d\": \"e\"}") == 0);
+
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_OBJECT_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTM(reader.buf_p, "a", 2);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_NUMBER);
+    BTASSERTM(reader.buf_p, "1", 2);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_NUMBER);
+    BTASSERTM(reader.buf_p, "-2.5e3", 7);
+    BTASSERTI(reader.length, ==, 6);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_TRUE);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_FALSE);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_NULL);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTM(reader.buf_p, "b", 2);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_OBJECT_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_OBJECT_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTM(reader.buf_p, "c", 2);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTM(reader.buf_p, "d", 2);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_STRING);
+    BTASSERTM(reader.buf_p, "e", 2);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_OBJECT_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_END);
+
+    /* A top level number. */
+    BTASSERT(reader_init(&reader, "  42") == 0);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_NUMBER);
+    BTASSERTM(reader.buf_p, "42", 3);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_END);
+
+    return (0);
+}
+
+static int test_string_escapes(struct harness_t *harness_p)
+{
+    struct json_reader_t reader;
+
+    BTASSERT(reader_init(&reader,
+                         "[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\", \"\\u0041\\u00e5\\u20ac\"]") == 0);
+
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_STRING);
+    BTASSERTI(reader.length, ==, 8);
+    BTASSERTM(reader.buf_p, "\"\\/\b\f\n\r\t", 9);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_STRING);
+    BTASSERTI(reader.length, ==, 6);
+    BTASSERTM(reader.buf_p, "A\xc3\xa5\xe2\x82\xac", 7);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_END);
+
+    return (0);
+}
+
+static int test_skip(struct harness_t *harness_p)
+{
+    struct json_reader_t reader;
+
+    /* Skipped strings may be longer than the value buffer. */
+    BTASSERT(reader_init(&reader,
+                         "{\"a\": {\"b\": [1, {\"c\": \"a very long string\"}]},"
+                         " \"d\": 5}") == 0);
+
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_OBJECT_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTI(json_reader_skip(&reader), ==, JSON_READER_OBJECT_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTM(reader.buf_p, "d", 2);
+    BTASSERTI(json_reader_skip(&reader), ==, JSON_READER_NUMBER);
+    BTASSERTI(json_reader_skip(&reader), ==, JSON_READER_OBJECT_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_END);
+
+    return (0);
+}
+
+static int test_find(struct harness_t *harness_p)
+{
+    struct json_reader_t reader;
+    long number;
+    const char *document_p;
+
+    document_p =
+        "{\"name\": \"simba\", \"boards\": [{\"name\": \"due\", \"pins\": 54},"
+        " {\"name\": \"nano32\", \"pins\": 32}], \"settings\": {\"a\": 1}}";
+
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, "boards.1.pins"), ==, JSON_READER_NUMBER);
+    BTASSERT(std_strtol(reader.buf_p, &number) != NULL);
+    BTASSERTI(number, ==, 32);
+
+    /* Continue reading after the found value. */
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_OBJECT_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_KEY);
+    BTASSERTM(reader.buf_p, "settings", 9);
+
+    /* A relative path. */
+    BTASSERTI(json_reader_find(&reader, "a"), ==, JSON_READER_NUMBER);
+    BTASSERTM(reader.buf_p, "1", 2);
+
+    /* Objects and arrays. */
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, "boards.0"), ==, JSON_READER_OBJECT_BEGIN);
+
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, ""), ==, JSON_READER_OBJECT_BEGIN);
+
+    /* Missing keys and indexes. */
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, "missing"), ==, -ENOENT);
+
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, "boards.2"), ==, -ENOENT);
+
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, "name.foo"), ==, -ENOENT);
+
+    BTASSERT(reader_init(&reader, document_p) == 0);
+    BTASSERTI(json_reader_find(&reader, "boards.name"), ==, -ENOENT);
+
+    return (0);
+}
+
+static int test_trailing_data(struct harness_t *harness_p)
+{
+    struct json_reader_t reader;
+    char buf[6];
+
+    /* The document spans several reader chunks. */
+    BTASSERT(reader_init(&reader,
+                         "[\"0123456789\", \"0123456789\", \"0123456789\"]"
+                         " tail") == 0);
+
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_STRING);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_STRING);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_STRING);
+    BTASSERTM(reader.buf_p, "0123456789", 11);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_END);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_END);
+
+    /* Data following the document is read from the reader. */
+    BTASSERTI(chan_read(&reader.reader, &buf[0], 5), ==, 5);
+    buf[5] = '\0';
+    BTASSERTM(&buf[0], " tail", 6);
+
+    return (0);
+}
+
+static int test_errors(struct harness_t *harness_p)
+{
+    struct json_reader_t reader;
+    int i;
+    int event;
+    static const char *documents[] = {
+        "",
+        "{",
+        "{\"a\" 1}",
+        "{\"a\": 1,}",
+        "[1,]",
+        "[1 2]",
+        "{1: 2}",
+        "[tru]",
+        "[\"\\x\"]",
+        "[\"\\u00g0\"]",
+        "[\"a\nb\"]",
+        "]",
+        "[}",
+        "{]"
+    };
+
+    for (i = 0; i < membersof(documents); i++) {
+        BTASSERT(reader_init(&reader, documents[i]) == 0);
+
+        do {
+            event = json_reader_next(&reader);
+        } while (event > 0);
+
+        BTASSERT(event == -EPROTO, "%d: %s", i, documents[i]);
+    }
+
+    /* The value buffer is too small. */
+    BTASSERT(reader_init(&reader, "[\"0123456789abcdef\"]") == 0);
+    BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_BEGIN);
+    BTASSERTI(json_reader_next(&reader), ==, -ENOMEM);
+
+    /* Too deep. */
+    BTASSERT(reader_init(&reader,
+                         "[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]]]"
+                         "]]]]]]]]]]]]]") == 0);
+
+    for (i = 0; i < JSON_READER_DEPTH_MAX; i++) {
+        BTASSERTI(json_reader_next(&reader), ==, JSON_READER_ARRAY_BEGIN);
+    }
+
+    BTASSERTI(json_reader_next(&reader), ==, -ENOMEM);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_events, "test_events" },
+        { test_string_escapes, "test_string_escapes" },
+        { test_skip, "test_skip" },
+        { test_find, "test_find" },
+        { test_trailing_data, "test_trailing_data" },
+        { test_errors, "test_errors" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
@@ -0,0 +1,163 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static int test_buffer(struct harness_t *harness_p)
+{
+    struct json_writer_t writer;
+    char buf[128];
+
+    BTASSERT(json_writer_init(&writer, NULL, &buf[0], sizeof(buf)) == 0);
+
+    BTASSERT(json_writer_object_begin(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "a") == 0);
+    BTASSERT(json_writer_array_begin(&writer) == 0);
+    BTASSERT(json_writer_integer(&writer, 1) == 0);
+    BTASSERT(json_writer_integer(&writer, -2147483647L - 1) == 0);
+    BTASSERT(json_writer_boolean(&writer, 1) == 0);
+    BTASSERT(json_writer_boolean(&writer, 0) == 0);
+    BTASSERT(json_writer_null(&writer) == 0);
+    BTASSERT(json_writer_raw(&writer, "2.5", 3) == 0);
+    BTASSERT(json_writer_array_end(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "b") == 0);
+    BTASSERT(json_writer_object_begin(&writer) == 0);
+    BTASSERT(json_writer_object_end(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "c") == 0);
+    BTASSERT(json_writer_array_begin(&writer) == 0);
+    BTASSERT(json_writer_array_end(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "d") == 0);
+    BTASSERT(json_writer_string(&writer, "e") == 0);
+    BTASSERT(json_writer_object_end(&writer) == 0);
+
+    BTASSERTI(json_writer_flush(&writer), ==, 63);
+    buf[63] = '\0';
+    BTASSERT(strcmp(&buf[0],
+                    "{\"a\":[1,-2147483648,true,false,null,2.5],"
+                    "\"b\":{},\"c\":[],\"d\":\"e\"}") == 0, "%s", buf);
+
+    return (0);
+}
+
+static int test_string_escapes(struct harness_t *harness_p)
+{
+    struct json_writer_t writer;
+    char buf[64];
+
+    BTASSERT(json_writer_init(&writer, NULL, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(json_writer_string(&writer, "a\"\\\b\f\n\r\t\x01z") == 0);
+    BTASSERTI(json_writer_flush(&writer), ==, 24);
+    buf[24] = '\0';
+    BTASSERT(strcmp(&buf[0],
+                    "\"a\\\"\\\\\\b\\f\\n\\r\\t\\u0001z\"") == 0, "%s", buf);
+
+    return (0);
+}
+
+static int test_buffer_full(struct harness_t *harness_p)
+{
+    struct json_writer_t writer;
+    char buf[8];
+
+    BTASSERT(json_writer_init(&writer, NULL, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(json_writer_array_begin(&writer) == 0);
+    BTASSERT(json_writer_string(&writer, "12345") == 0);
+    BTASSERT(json_writer_array_end(&writer) == -ENOMEM);
+
+    return (0);
+}
+
+static int test_channel(struct harness_t *harness_p)
+{
+    struct json_writer_t writer;
+    struct queue_t queue;
+    char queue_buf[128];
+    char buf[8];
+    char output[64];
+    int i;
+
+    /* A buffer smaller than the output is flushed to the channel
+       when full. */
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(json_writer_init(&writer, &queue, &buf[0], sizeof(buf)) == 0);
+
+    BTASSERT(json_writer_array_begin(&writer) == 0);
+
+    for (i = 0; i < 5; i++) {
+        BTASSERT(json_writer_string(&writer, "value") == 0);
+    }
+
+    BTASSERT(json_writer_array_end(&writer) == 0);
+    BTASSERTI(json_writer_flush(&writer), ==, 41);
+    BTASSERTI(queue_size(&queue), ==, 41);
+    BTASSERTI(queue_read(&queue, &output[0], 41), ==, 41);
+    output[41] = '\0';
+    BTASSERT(strcmp(&output[0],
+                    "[\"value\",\"value\",\"value\",\"value\",\"value\"]") == 0);
+
+    return (0);
+}
+
+static int test_depth(struct harness_t *harness_p)
+{
+    struct json_writer_t writer;
+    char buf[64];
+    int i;
+
+    BTASSERT(json_writer_init(&writer, NULL, &buf[0], sizeof(buf)) == 0);
+
+    for (i = 0; i < JSON_WRITER_DEPTH_MAX; i++) {
+        BTASSERT(json_writer_array_begin(&writer) == 0);
+    }
+
+    BTASSERT(json_writer_array_begin(&writer) == -ENOMEM);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_buffer, "test_buffer" },
+        { test_string_escapes, "test_string_escapes" },
+        { test_buffer_full, "test_buffer_full" },
+        { test_channel, "test_channel" },
+        { test_depth, "test_depth" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
@@ -638,7 +638,7 @@ static int test_https_stop(struct harness_t *harness_p)
     BTASSERT(ssl_close_counter == 6);
     BTASSERT(ssl_write_counter == 9);
     BTASSERT(ssl_read_counter == 730);
-    BTASSERT(ssl_size_counter == 0);
+    BTASSERT(ssl_size_counter == 730);
 
     return (0);
 #else
@@ -462,6 +462,431 @@ static int test_output_multi_frame_unexpected_non_flow_control(
     return (0);
 }
 
+struct message_t {
+    struct isotp_session_t *session_p;
+    uint8_t *buf_p;
+    size_t size;
+};
+
+static struct isotp_engine_t engine;
+static struct isotp_session_t session_a;
+static struct isotp_session_t session_b;
+static struct isotp_session_t session_c;
+static ssize_t reply_res[2];
+static struct queue_t chin;
+static struct queue_t chout;
+static struct queue_t messages;
+static struct can_frame_t chin_buf[16];
+static struct can_frame_t chout_buf[16];
+static struct message_t messages_buf[4];
+static uint32_t pool[2][64 / sizeof(uint32_t)];
+static THRD_STACK(engine_stack, 2048);
+
+/* One stack per writer thread, as a terminated thread's stack may not
+   be reused on Linux. */
+static THRD_STACK(writer_0_stack, 2048);
+static THRD_STACK(writer_1_stack, 2048);
+static THRD_STACK(writer_2_stack, 2048);
+static THRD_STACK(writer_3_stack, 2048);
+
+static struct {
+    struct isotp_session_t *session_p;
+    const char *buf_p;
+    size_t size;
+    ssize_t res;
+} writer;
+
+static void on_message(void *arg_p,
+                       struct isotp_session_t *session_p,
+                       uint8_t *buf_p,
+                       size_t size)
+{
+    struct message_t message;
+
+    message.session_p = session_p;
+    message.buf_p = buf_p;
+    message.size = size;
+    queue_write(&messages, &message, sizeof(message));
+}
+
+/**
+ * Reply to the received message from the engine thread.
+ */
+static void on_message_reply(void *arg_p,
+                             struct isotp_session_t *session_p,
+                             uint8_t *buf_p,
+                             size_t size)
+{
+    ssize_t *res_p;
+
+    res_p = arg_p;
+    res_p[0] = isotp_session_write(session_p, "foo", 3);
+    res_p[1] = isotp_session_write(session_p, "0123456789", 10);
+    isotp_engine_buffer_free(&engine, buf_p);
+    on_message(NULL, session_p, NULL, size);
+}
+
+static void *writer_main(void *arg_p)
+{
+    writer.res = isotp_session_write(writer.session_p,
+                                     writer.buf_p,
+                                     writer.size);
+
+    return (NULL);
+}
+
+static struct thrd_t *writer_start(struct isotp_session_t *session_p,
+                                   const char *buf_p,
+                                   size_t size,
+                                   void *stack_p)
+{
+    writer.session_p = session_p;
+    writer.buf_p = buf_p;
+    writer.size = size;
+    writer.res = 1;
+
+    return (thrd_spawn(writer_main,
+                       NULL,
+                       0,
+                       stack_p,
+                       sizeof(writer_0_stack)));
+}
+
+static void peer_write(uint32_t id, const char *data_p, size_t size)
+{
+    struct can_frame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.size = size;
+    memcpy(&frame.data.u8[0], data_p, size);
+    queue_write(&chin, &frame, sizeof(frame));
+}
+
+static int peer_read(uint32_t id, const char *data_p, size_t size)
+{
+    struct can_frame_t frame;
+
+    queue_read(&chout, &frame, sizeof(frame));
+
+    if ((frame.id != id) || (frame.size != size)) {
+        std_printf(FSTR("id: 0x%lx, size: %d\r\n"), frame.id, frame.size);
+
+        return (-1);
+    }
+
+    return (memcmp(&frame.data.u8[0], data_p, size));
+}
+
+static int test_engine_start(struct harness_t *harness_p)
+{
+    BTASSERT(queue_init(&chin, &chin_buf[0], sizeof(chin_buf)) == 0);
+    BTASSERT(queue_init(&chout, &chout_buf[0], sizeof(chout_buf)) == 0);
+    BTASSERT(queue_init(&messages,
+                        &messages_buf[0],
+                        sizeof(messages_buf)) == 0);
+    BTASSERT(isotp_engine_init(&engine,
+                               &chin,
+                               &chout,
+                               &pool[0][0],
+                               sizeof(pool),
+                               sizeof(pool[0]),
+                               engine_stack,
+                               sizeof(engine_stack)) == 0);
+    BTASSERT(isotp_session_init(&session_a,
+                                &engine,
+                                0x700,
+                                0x708,
+                                0,
+                                on_message,
+                                NULL) == 0);
+    BTASSERT(isotp_session_init(&session_b,
+                                &engine,
+                                0x701,
+                                0x709,
+                                0,
+                                on_message,
+                                NULL) == 0);
+    BTASSERT(isotp_engine_start(&engine) == 0);
+
+    return (0);
+}
+
+static int test_engine_receive_single_frame(struct harness_t *harness_p)
+{
+    struct message_t message;
+
+    /* Frames to unknown ids are discarded. */
+    peer_write(0x702, "\x03" "bar", 4);
+    peer_write(0x700, "\x03" "foo", 4);
+
+    BTASSERT(queue_read(&messages,
+                        &message,
+                        sizeof(message)) == sizeof(message));
+    BTASSERT(message.session_p == &session_a);
+    BTASSERT(message.size == 3);
+    BTASSERT(memcmp(message.buf_p, "foo", 3) == 0);
+    BTASSERT(isotp_engine_buffer_free(&engine, message.buf_p) == 0);
+
+    return (0);
+}
+
+static int test_engine_receive_block_size(struct harness_t *harness_p)
+{
+    struct message_t message;
+
+    BTASSERT(isotp_session_set_flow_control(&session_a, 2, 0) == 0);
+
+    /* A 27 bytes message; the first frame and three consecutive
+       frames, with a flow control frame after the first frame and
+       the second consecutive frame. */
+    peer_write(0x700, "\x10\x1b" "123456", 8);
+    BTASSERT(peer_read(0x708, "\x30\x02\x00", 3) == 0);
+    peer_write(0x700, "\x21" "7890abc", 8);
+    peer_write(0x700, "\x22" "defghij", 8);
+    BTASSERT(peer_read(0x708, "\x30\x02\x00", 3) == 0);
+    peer_write(0x700, "\x23" "klmnopq", 8);
+
+    BTASSERT(queue_read(&messages,
+                        &message,
+                        sizeof(message)) == sizeof(message));
+    BTASSERT(message.session_p == &session_a);
+    BTASSERT(message.size == 27);
+    BTASSERT(memcmp(message.buf_p, "1234567890abcdefghijklmnopq", 27) == 0);
+    BTASSERT(isotp_engine_buffer_free(&engine, message.buf_p) == 0);
+    BTASSERT(isotp_session_set_flow_control(&session_a, 0, 0) == 0);
+
+    return (0);
+}
+
+static int test_engine_transmit_block_size(struct harness_t *harness_p)
+{
+    struct thrd_t *thrd_p;
+
+    thrd_p = writer_start(&session_b,
+                          "1234567890abcdefghijklmnopqrst",
+                          30,
+                          writer_0_stack);
+    BTASSERT(thrd_p != NULL);
+
+    BTASSERT(peer_read(0x709, "\x10\x1e" "123456", 8) == 0);
+
+    /* Two frames per block. */
+    peer_write(0x701, "\x30\x02\x00", 3);
+    BTASSERT(peer_read(0x709, "\x21" "7890abc", 8) == 0);
+    BTASSERT(peer_read(0x709, "\x22" "defghij", 8) == 0);
+
+    /* The rest in one block. */
+    peer_write(0x701, "\x30\x00\x00", 3);
+    BTASSERT(peer_read(0x709, "\x23" "klmnopq", 8) == 0);
+    BTASSERT(peer_read(0x709, "\x24" "rst", 4) == 0);
+
+    BTASSERT(thrd_join(thrd_p) == 0);
+    BTASSERT(writer.res == 30);
+
+    return (0);
+}
+
+static int test_engine_full_duplex(struct harness_t *harness_p)
+{
+    struct thrd_t *thrd_p;
+    struct message_t message;
+
+    /* Start transmitting on session A. */
+    thrd_p = writer_start(&session_a,
+                          "ABCDEFGHIJKLMNOPQRST",
+                          20,
+                          writer_1_stack);
+    BTASSERT(thrd_p != NULL);
+    BTASSERT(peer_read(0x708, "\x10\x14" "ABCDEF", 8) == 0);
+
+    /* Start receiving on session A before the transmission is
+       complete. */
+    peer_write(0x700, "\x10\x0a" "abcdef", 8);
+    BTASSERT(peer_read(0x708, "\x30\x00\x00", 3) == 0);
+
+    /* Complete the transmission. */
+    peer_write(0x700, "\x30\x00\x00", 3);
+    BTASSERT(peer_read(0x708, "\x21" "GHIJKLM", 8) == 0);
+    BTASSERT(peer_read(0x708, "\x22" "NOPQRST", 8) == 0);
+    BTASSERT(thrd_join(thrd_p) == 0);
+    BTASSERT(writer.res == 20);
+
+    /* Complete the reception. */
+    peer_write(0x700, "\x21" "ghij", 5);
+    BTASSERT(queue_read(&messages,
+                        &message,
+                        sizeof(message)) == sizeof(message));
+    BTASSERT(message.session_p == &session_a);
+    BTASSERT(message.size == 10);
+    BTASSERT(memcmp(message.buf_p, "abcdefghij", 10) == 0);
+    BTASSERT(isotp_engine_buffer_free(&engine, message.buf_p) == 0);
+
+    return (0);
+}
+
+static int test_engine_multi_session(struct harness_t *harness_p)
+{
+    struct message_t message_a;
+    struct message_t message_b;
+
+    /* Interleaved frames of two messages. */
+    peer_write(0x700, "\x10\x0d" "aaaaaa", 8);
+    BTASSERT(peer_read(0x708, "\x30\x00\x00", 3) == 0);
+    peer_write(0x701, "\x10\x09" "bbbbbb", 8);
+    BTASSERT(peer_read(0x709, "\x30\x00\x00", 3) == 0);
+    peer_write(0x701, "\x21" "BBB", 4);
+    peer_write(0x700, "\x21" "AAAAAAA", 8);
+
+    BTASSERT(queue_read(&messages,
+                        &message_b,
+                        sizeof(message_b)) == sizeof(message_b));
+    BTASSERT(queue_read(&messages,
+                        &message_a,
+                        sizeof(message_a)) == sizeof(message_a));
+    BTASSERT(message_a.session_p == &session_a);
+    BTASSERT(message_a.size == 13);
+    BTASSERT(memcmp(message_a.buf_p, "aaaaaaAAAAAAA", 13) == 0);
+    BTASSERT(message_b.session_p == &session_b);
+    BTASSERT(message_b.size == 9);
+    BTASSERT(memcmp(message_b.buf_p, "bbbbbbBBB", 9) == 0);
+
+    /* Both pool buffers are in use. A third message is rejected. */
+    peer_write(0x700, "\x10\x09" "cccccc", 8);
+    BTASSERT(peer_read(0x708, "\x32\x00\x00", 3) == 0);
+
+    BTASSERT(isotp_engine_buffer_free(&engine, message_a.buf_p) == 0);
+    BTASSERT(isotp_engine_buffer_free(&engine, message_b.buf_p) == 0);
+
+    /* Too big for the pool buffers. */
+    peer_write(0x700, "\x10\x41" "cccccc", 8);
+    BTASSERT(peer_read(0x708, "\x32\x00\x00", 3) == 0);
+
+    return (0);
+}
+
+static int test_engine_transmit_overflow(struct harness_t *harness_p)
+{
+    struct thrd_t *thrd_p;
+
+    thrd_p = writer_start(&session_b,
+                          "0123456789",
+                          10,
+                          writer_2_stack);
+    BTASSERT(thrd_p != NULL);
+    BTASSERT(peer_read(0x709, "\x10\x0a" "012345", 8) == 0);
+    peer_write(0x701, "\x32\x00\x00", 3);
+    BTASSERT(thrd_join(thrd_p) == 0);
+    BTASSERT(writer.res == -ENOBUFS);
+
+    return (0);
+}
+
+static int test_engine_transmit_timeout(struct harness_t *harness_p)
+{
+    struct thrd_t *thrd_p;
+
+    thrd_p = writer_start(&session_b,
+                          "0123456789",
+                          10,
+                          writer_3_stack);
+    BTASSERT(thrd_p != NULL);
+    BTASSERT(peer_read(0x709, "\x10\x0a" "012345", 8) == 0);
+
+    /* A wait flow control frame does not complete the transmission. */
+    peer_write(0x701, "\x31\x00\x00", 3);
+    BTASSERT(thrd_join(thrd_p) == 0);
+    BTASSERT(writer.res == -ETIMEDOUT);
+
+    /* The session is idle again. */
+    BTASSERT(isotp_session_write(&session_b, "foo", 3) == 3);
+    BTASSERT(peer_read(0x709, "\x03" "foo", 4) == 0);
+
+    return (0);
+}
+
+static int test_engine_reply_from_callback(struct harness_t *harness_p)
+{
+    struct message_t message;
+
+    BTASSERT(isotp_session_init(&session_c,
+                                &engine,
+                                0x703,
+                                0x70b,
+                                0,
+                                on_message_reply,
+                                &reply_res[0]) == 0);
+
+    peer_write(0x703, "\x03" "bar", 4);
+    BTASSERT(queue_read(&messages,
+                        &message,
+                        sizeof(message)) == sizeof(message));
+    BTASSERT(message.session_p == &session_c);
+
+    /* A single frame reply is written, but a multi-frame reply is
+       rejected instead of waiting for a flow control frame that the
+       engine thread can not receive. */
+    BTASSERTI(reply_res[0], ==, 3);
+    BTASSERTI(reply_res[1], ==, -EDEADLK);
+    BTASSERT(peer_read(0x70b, "\x03" "foo", 4) == 0);
+    BTASSERTI(queue_size(&chout), ==, 0);
+
+    /* The session is idle again. */
+    BTASSERT(isotp_session_write(&session_c, "fie", 3) == 3);
+    BTASSERT(peer_read(0x70b, "\x03" "fie", 4) == 0);
+
+    return (0);
+}
+
+static int test_engine_receive_timeout(struct harness_t *harness_p)
+{
+    struct message_t message_a;
+    struct message_t message_b;
+    struct message_t message_c;
+
+    /* Abandon a reception on session A and B, using both pool
+       buffers. */
+    peer_write(0x700, "\x10\x0d" "aaaaaa", 8);
+    BTASSERT(peer_read(0x708, "\x30\x00\x00", 3) == 0);
+    peer_write(0x701, "\x10\x09" "bbbbbb", 8);
+    BTASSERT(peer_read(0x709, "\x30\x00\x00", 3) == 0);
+
+    /* The receptions time out and the buffers are returned to the
+       pool. A late consecutive frame is discarded. */
+    thrd_sleep_ms(2 * CONFIG_ISOTP_TIMEOUT_MS);
+    peer_write(0x700, "\x21" "AAAAAAA", 8);
+
+    /* A message on session C gets a pool buffer and is answered by
+       its callback. */
+    peer_write(0x703, "\x03" "bar", 4);
+    BTASSERT(peer_read(0x70b, "\x03" "foo", 4) == 0);
+    BTASSERT(queue_read(&messages,
+                        &message_c,
+                        sizeof(message_c)) == sizeof(message_c));
+    BTASSERT(message_c.session_p == &session_c);
+    BTASSERTI(queue_size(&messages), ==, 0);
+
+    /* Both buffers are free again. */
+    peer_write(0x700, "\x10\x0a" "abcdef", 8);
+    BTASSERT(peer_read(0x708, "\x30\x00\x00", 3) == 0);
+    peer_write(0x701, "\x10\x0a" "ghijkl", 8);
+    BTASSERT(peer_read(0x709, "\x30\x00\x00", 3) == 0);
+    peer_write(0x700, "\x21" "mnop", 5);
+    peer_write(0x701, "\x21" "qrst", 5);
+    BTASSERT(queue_read(&messages,
+                        &message_a,
+                        sizeof(message_a)) == sizeof(message_a));
+    BTASSERT(queue_read(&messages,
+                        &message_b,
+                        sizeof(message_b)) == sizeof(message_b));
+    BTASSERT(memcmp(message_a.buf_p, "abcdefmnop", 10) == 0);
+    BTASSERT(memcmp(message_b.buf_p, "ghijklqrst", 10) == 0);
+    BTASSERT(isotp_engine_buffer_free(&engine, message_a.buf_p) == 0);
+    BTASSERT(isotp_engine_buffer_free(&engine, message_b.buf_p) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_t harness;
@@ -488,6 +913,20 @@ int main()
           "test_input_bad_multi_frame_consecutive" },
         { test_output_multi_frame_unexpected_non_flow_control,
           "test_output_multi_frame_unexpected_non_flow_control" },
+        { test_engine_start, "test_engine_start" },
+        { test_engine_receive_single_frame,
+          "test_engine_receive_single_frame" },
+        { test_engine_receive_block_size,
+          "test_engine_receive_block_size" },
+        { test_engine_transmit_block_size,
+          "test_engine_transmit_block_size" },
+        { test_engine_full_duplex, "test_engine_full_duplex" },
+        { test_engine_multi_session, "test_engine_multi_session" },
+        { test_engine_transmit_overflow, "test_engine_transmit_overflow" },
+        { test_engine_transmit_timeout, "test_engine_transmit_timeout" },
+        { test_engine_reply_from_callback,
+          "test_engine_reply_from_callback" },
+        { test_engine_receive_timeout, "test_engine_receive_timeout" },
         { NULL, NULL }
     };
 
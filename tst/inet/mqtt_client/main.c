@@ -511,6 +511,245 @@ static int test_incoming_publish_qos2(struct harness_t *harness_p)
     return (0);
 }
 
+static size_t on_publish_a(struct mqtt_client_t *client_p,
+                           const char *topic_p,
+                           void *chin_p,
+                           size_t size)
+{
+    return (0);
+}
+
+static size_t on_publish_b(struct mqtt_client_t *client_p,
+                           const char *topic_p,
+                           void *chin_p,
+                           size_t size)
+{
+    return (0);
+}
+
+static size_t on_publish_c(struct mqtt_client_t *client_p,
+                           const char *topic_p,
+                           void *chin_p,
+                           size_t size)
+{
+    return (0);
+}
+
+static size_t on_publish_d(struct mqtt_client_t *client_p,
+                           const char *topic_p,
+                           void *chin_p,
+                           size_t size)
+{
+    return (0);
+}
+
+static size_t on_publish_table(struct mqtt_client_t *client_p,
+                               const char *topic_p,
+                               void *chin_p,
+                               size_t size)
+{
+    std_printf(OSTR("Table published topic '%s' of size %d.\r\n"),
+               topic_p,
+               size);
+
+    strncpy(&published_topic[0], topic_p, sizeof(published_topic));
+    chan_read(chin_p, &published_message[0], size);
+    published_message_size = size;
+
+    thrd_resume(self_p, 0);
+
+    return (0);
+}
+
+static int test_topic_table(struct harness_t *harness_p)
+{
+    struct mqtt_topic_table_t table;
+    struct mqtt_topic_bucket_t buckets[8];
+    struct mqtt_topic_node_t nodes[8];
+
+    BTASSERT(mqtt_topic_table_init(&table,
+                                   &buckets[0],
+                                   membersof(buckets),
+                                   &nodes[0],
+                                   membersof(nodes)) == 0);
+
+    /* Empty table. */
+    BTASSERT(mqtt_topic_table_get(&table, "foo/bar") == NULL);
+
+    /* Malformed filters. */
+    BTASSERTI(mqtt_topic_table_add(&table, "foo/#/bar", on_publish_a),
+              ==,
+              -EINVAL);
+    BTASSERTI(mqtt_topic_table_add(&table, "foo/b+", on_publish_a),
+              ==,
+              -EINVAL);
+    BTASSERTI(mqtt_topic_table_add(&table, "foo#", on_publish_a),
+              ==,
+              -EINVAL);
+
+    BTASSERT(mqtt_topic_table_add(&table, "foo/bar", on_publish_a) == 0);
+    BTASSERT(mqtt_topic_table_add(&table, "foo/+", on_publish_b) == 0);
+    BTASSERT(mqtt_topic_table_add(&table, "foo/#", on_publish_c) == 0);
+    BTASSERT(mqtt_topic_table_add(&table, "+/+/baz", on_publish_d) == 0);
+
+    /* The most specific filter wins. */
+    BTASSERT(mqtt_topic_table_get(&table, "foo/bar") == on_publish_a);
+    BTASSERT(mqtt_topic_table_get(&table, "foo/fie") == on_publish_b);
+    BTASSERT(mqtt_topic_table_get(&table, "foo/") == on_publish_b);
+    BTASSERT(mqtt_topic_table_get(&table, "foo/fie/fum") == on_publish_c);
+    BTASSERT(mqtt_topic_table_get(&table, "foo") == on_publish_c);
+    BTASSERT(mqtt_topic_table_get(&table, "foo/bar/baz") == on_publish_c);
+    BTASSERT(mqtt_topic_table_get(&table, "fie/bar/baz") == on_publish_d);
+    BTASSERT(mqtt_topic_table_get(&table, "fie/bar") == NULL);
+    BTASSERT(mqtt_topic_table_get(&table, "fie/bar/baz/") == NULL);
+    BTASSERT(mqtt_topic_table_get(&table, "fo") == NULL);
+
+    /* Overwrite an existing filter. */
+    BTASSERT(mqtt_topic_table_add(&table, "foo/bar", on_publish_d) == 0);
+    BTASSERT(mqtt_topic_table_get(&table, "foo/bar") == on_publish_d);
+
+    /* Wildcards does not match topics starting with '$'. */
+    BTASSERT(mqtt_topic_table_add(&table, "#", on_publish_a) == 0);
+    BTASSERT(mqtt_topic_table_get(&table, "fie") == on_publish_a);
+    BTASSERT(mqtt_topic_table_get(&table, "$SYS/bar/baz") == NULL);
+    BTASSERT(mqtt_topic_table_add(&table, "$SYS/#", on_publish_b) == 0);
+    BTASSERT(mqtt_topic_table_get(&table, "$SYS/bar/baz") == on_publish_b);
+
+    /* Out of nodes. */
+    BTASSERT(mqtt_topic_table_add(&table, "a", on_publish_a) == 0);
+    BTASSERTI(mqtt_topic_table_add(&table, "a/b", on_publish_a),
+              ==,
+              -ENOMEM);
+
+    return (0);
+}
+
+static int test_incoming_publish_topic_table(struct harness_t *harness_p)
+{
+    static struct mqtt_topic_table_t table;
+    static struct mqtt_topic_bucket_t buckets[4];
+    static struct mqtt_topic_node_t nodes[4];
+    uint8_t buf[16];
+    struct message_t message;
+
+    BTASSERT(mqtt_topic_table_init(&table,
+                                   &buckets[0],
+                                   membersof(buckets),
+                                   &nodes[0],
+                                   membersof(nodes)) == 0);
+    BTASSERT(mqtt_topic_table_add(&table, "foo/+", on_publish_table) == 0);
+    BTASSERT(mqtt_client_set_topic_table(&client, &table) == 0);
+
+    memset(&published_topic[0], 0, sizeof(published_topic));
+
+    /* A message not matching any filter is given to the default
+       callback. */
+    buf[0] = (3 << 4);
+    buf[1] = 12;
+    buf[2] = 0;
+    buf[3] = 7;
+    memcpy(&buf[4], "fie/bar", 7);
+    memcpy(&buf[11], "abc", 3);
+    message.buf_p = buf;
+    message.size = 14;
+    BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
+
+    thrd_suspend(NULL);
+
+    BTASSERTM(&published_topic[0], "fie/bar", 8);
+    BTASSERTM(&published_message[0], "abc", 3);
+
+    /* A matching message is given to the table callback. */
+    buf[0] = (3 << 4);
+    buf[1] = 12;
+    buf[2] = 0;
+    buf[3] = 7;
+    memcpy(&buf[4], "foo/baz", 7);
+    memcpy(&buf[11], "def", 3);
+    message.buf_p = buf;
+    message.size = 14;
+    BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
+
+    thrd_suspend(NULL);
+
+    BTASSERTM(&published_topic[0], "foo/baz", 8);
+    BTASSERTM(&published_message[0], "def", 3);
+    BTASSERT(published_message_size == 3);
+
+    BTASSERT(mqtt_client_set_topic_table(&client, NULL) == 0);
+
+    return (0);
+}
+
+static int test_topic_table_benchmark(struct harness_t *harness_p)
+{
+    static struct mqtt_topic_table_t table;
+    static struct mqtt_topic_bucket_t buckets[4096];
+    static struct mqtt_topic_node_t nodes[4096];
+    static char filters[1000][32];
+    char topic[32];
+    int i;
+    int j;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t diff;
+    long elapsed;
+
+    BTASSERT(mqtt_topic_table_init(&table,
+                                   &buckets[0],
+                                   membersof(buckets),
+                                   &nodes[0],
+                                   membersof(nodes)) == 0);
+
+    /* 1000 filters, of which one fourth use wildcards. */
+    for (i = 0; i < membersof(filters); i++) {
+        switch (i % 4) {
+
+        case 0:
+            std_sprintf(&filters[i][0], FSTR("gw/%d/+/temp"), i);
+            break;
+
+        case 1:
+            std_sprintf(&filters[i][0], FSTR("gw/%d/status/#"), i);
+            break;
+
+        default:
+            std_sprintf(&filters[i][0], FSTR("gw/%d/node/%d"), i, i % 8);
+            break;
+        }
+
+        BTASSERT(mqtt_topic_table_add(&table,
+                                      &filters[i][0],
+                                      on_publish_a) == 0);
+    }
+
+    time_get(&start);
+
+    for (i = 0; i < 100; i++) {
+        for (j = 0; j < membersof(filters); j++) {
+            std_sprintf(&topic[0], FSTR("gw/%d/node/%d"), j, j % 8);
+
+            if ((j % 4) >= 2) {
+                BTASSERT(mqtt_topic_table_get(&table, &topic[0]) != NULL);
+            } else {
+                BTASSERT(mqtt_topic_table_get(&table, &topic[0]) == NULL);
+            }
+        }
+    }
+
+    time_get(&stop);
+    time_subtract(&diff, &stop, &start);
+    elapsed = (diff.seconds * 1000000L + diff.nanoseconds / 1000L);
+
+    std_printf(OSTR("%d dispatches with %d filters in %ld us "
+                    "(including topic formatting).\r\n"),
+               100 * membersof(filters),
+               membersof(filters),
+               elapsed);
+
+    return (0);
+}
+
 static int test_disconnect(struct harness_t *harness_p)
 {
     struct message_t message;
@@ -543,6 +782,10 @@ int main()
         { test_incoming_publish_qos0, "test_incoming_publish_qos0" },
         { test_incoming_publish_qos1, "test_incoming_publish_qos1" },
         { test_incoming_publish_qos2, "test_incoming_publish_qos2" },
+        { test_topic_table, "test_topic_table" },
+        { test_incoming_publish_topic_table,
+          "test_incoming_publish_topic_table" },
+        { test_topic_table_benchmark, "test_topic_table_benchmark" },
         { test_disconnect, "test_disconnect" },
         { NULL, NULL }
     };
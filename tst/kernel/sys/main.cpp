@@ -153,6 +153,49 @@ int test_repeated_uptime(struct harness_t *harness_p)
     return (0);
 }
 
+int test_uptime_ns(struct harness_t *harness_p)
+{
+    struct time_t uptime;
+    uint64_t start;
+    uint64_t previous;
+    uint64_t now;
+    int64_t difference;
+    int changes;
+
+    /* Same clock as sys_uptime(). */
+    BTASSERT(sys_uptime(&uptime) == 0);
+    now = sys_uptime_ns();
+    difference = (now - ((uint64_t)uptime.seconds * 1000000000
+                         + uptime.nanoseconds));
+    BTASSERT(difference >= 0);
+    BTASSERT(difference < 1000000000 / CONFIG_SYSTEM_TICK_FREQUENCY);
+
+    /* Monotonic over a few system ticks. */
+    start = sys_uptime_ns();
+    previous = start;
+    changes = 0;
+
+    do {
+        now = sys_uptime_ns();
+        BTASSERT(now >= previous);
+
+        if (now != previous) {
+            changes++;
+        }
+
+        previous = now;
+    } while (now - start < 3 * (1000000000 / CONFIG_SYSTEM_TICK_FREQUENCY));
+
+    std_printf(OSTR("changes: %d\r\n"), changes);
+
+#if defined(ARCH_LINUX)
+    /* The time between the ticks is interpolated. */
+    BTASSERT(changes > 3);
+#endif
+
+    return (0);
+}
+
 int test_time(struct harness_t *harness_p)
 {
     int i;
@@ -356,6 +399,154 @@ int test_errno(struct harness_t *harness_p)
     return (0);
 }
 
+int test_cycles(struct harness_t *harness_p)
+{
+    uint32_t start;
+    uint32_t elapsed;
+
+    BTASSERTI(sys_get_cycles_per_second(), >, 0);
+
+    start = sys_get_cycles();
+    BTASSERT(thrd_sleep_ms(20) == 0);
+    elapsed = (sys_get_cycles() - start);
+
+    /* At least 15 ms. */
+    BTASSERTI(elapsed / (sys_get_cycles_per_second() / 1000), >=, 15);
+
+    return (0);
+}
+
+#if CONFIG_SYS_LOCK_PROFILE == 1
+
+static void hold_lock(uint32_t microseconds)
+{
+    uint32_t start;
+    uint32_t cycles;
+
+    cycles = ((sys_get_cycles_per_second() / 1000000) * microseconds);
+
+    sys_lock();
+
+    start = sys_get_cycles();
+
+    while ((sys_get_cycles() - start) < cycles);
+
+    sys_unlock();
+}
+
+int test_lock_profile(struct harness_t *harness_p)
+{
+    struct sys_lock_profile_site_t sites[CONFIG_SYS_LOCK_PROFILE_SITES_MAX];
+    ssize_t length;
+    ssize_t i;
+    uint32_t count;
+    int j;
+    char buf[48];
+
+    BTASSERT(sys_lock_profile_reset() == 0);
+    BTASSERTI(sys_lock_profile_interrupt_latency_max(), ==, 0);
+
+    hold_lock(3000);
+    hold_lock(10);
+    BTASSERT(thrd_sleep_ms(30) == 0);
+
+    length = sys_lock_profile_read(&sites[0], membersof(sites));
+    BTASSERTI(length, >, 0);
+
+    /* The call site in hold_lock() held the lock the longest. */
+    BTASSERTI(sites[0].max / (sys_get_cycles_per_second() / 1000000),
+              >=,
+              3000);
+    BTASSERTI(sites[0].count, >=, 2);
+    BTASSERTI(sites[0].histogram[4], >=, 1);
+
+    /* Sorted on maximum hold time and every lock is accounted. */
+    for (i = 0; i < length; i++) {
+        if (i > 0) {
+            BTASSERTI(sites[i].max, <=, sites[i - 1].max);
+        }
+
+        count = 0;
+
+        for (j = 0; j < SYS_LOCK_PROFILE_HISTOGRAM_MAX; j++) {
+            count += sites[i].histogram[j];
+        }
+
+        BTASSERTI(count, ==, sites[i].count);
+    }
+
+    BTASSERT(sys_lock_profile_read(&sites[0], 1) == 1);
+
+#if defined(ARCH_LINUX)
+    /* System ticks occured while sleeping. */
+    BTASSERTI(sys_lock_profile_interrupt_latency_max(), >, 0);
+#endif
+
+    strcpy(&buf[0], "/kernel/sys/lock_profile");
+    BTASSERT(fs_call(&buf[0], chan_null(), sys_get_stdout(), NULL) == 0);
+    strcpy(&buf[0], "/kernel/sys/lock/max_hold_us");
+    BTASSERT(fs_call(&buf[0], chan_null(), sys_get_stdout(), NULL) == 0);
+    strcpy(&buf[0], "/kernel/sys/lock_profile foo");
+    BTASSERT(fs_call(&buf[0], chan_null(), sys_get_stdout(), NULL) == -EINVAL);
+    strcpy(&buf[0], "/kernel/sys/lock_profile reset");
+    BTASSERT(fs_call(&buf[0], chan_null(), sys_get_stdout(), NULL) == 0);
+
+    return (0);
+}
+
+#if CONFIG_SYS_FS_COMMANDS == 1
+
+/**
+ * Read given counter into given buffer, which must be at least 17
+ * bytes.
+ */
+static int read_counter(const char *path_p, char *buf_p)
+{
+    struct queue_t qout;
+    char qoutbuf[32];
+    char command[48];
+
+    BTASSERT(queue_init(&qout, &qoutbuf[0], sizeof(qoutbuf)) == 0);
+    strcpy(&command[0], path_p);
+    BTASSERT(fs_call(&command[0], chan_null(), &qout, NULL) == 0);
+    BTASSERT(queue_read(&qout, buf_p, 18) == 18);
+    buf_p[16] = '\0';
+
+    return (0);
+}
+
+int test_lock_profile_reset_counters(struct harness_t *harness_p)
+{
+    char buf[18];
+
+    hold_lock(3000);
+    BTASSERT(thrd_sleep_ms(30) == 0);
+
+    BTASSERT(read_counter("/kernel/sys/lock/max_hold_us", &buf[0]) == 0);
+    BTASSERT(strcmp(&buf[0], "0000000000000000") != 0);
+
+#if defined(ARCH_LINUX)
+    BTASSERT(read_counter("/kernel/sys/interrupt/max_latency_us",
+                          &buf[0]) == 0);
+    BTASSERT(strcmp(&buf[0], "0000000000000000") != 0);
+#endif
+
+    /* Both counters are cleared by a reset. */
+    BTASSERT(sys_lock_profile_reset() == 0);
+
+    BTASSERT(read_counter("/kernel/sys/lock/max_hold_us", &buf[0]) == 0);
+    BTASSERT(strcmp(&buf[0], "0000000000000000") == 0);
+    BTASSERT(read_counter("/kernel/sys/interrupt/max_latency_us",
+                          &buf[0]) == 0);
+    BTASSERT(strcmp(&buf[0], "0000000000000000") == 0);
+
+    return (0);
+}
+
+#endif
+
+#endif
+
 int main()
 {
     struct harness_t harness;
@@ -367,6 +558,7 @@ int main()
         { test_uptime, "test_uptime" },
 #if !defined(BOARD_ARDUINO_NANO) && !defined(BOARD_ARDUINO_UNO) && !defined(BOARD_ARDUINO_PRO_MICRO)
         { test_repeated_uptime, "test_repeated_uptime" },
+        { test_uptime_ns, "test_uptime_ns" },
         { test_time, "test_time" },
 #endif
         { test_stdin, "test_stdin" },
@@ -375,6 +567,14 @@ int main()
         { test_div_ceil, "test_div_ceil" },
         { test_div_round, "test_div_round" },
         { test_reset_cause, "test_reset_cause" },
+        { test_cycles, "test_cycles" },
+#if CONFIG_SYS_LOCK_PROFILE == 1
+        { test_lock_profile, "test_lock_profile" },
+#    if CONFIG_SYS_FS_COMMANDS == 1
+        { test_lock_profile_reset_counters,
+          "test_lock_profile_reset_counters" },
+#    endif
+#endif
 #if !defined(BOARD_ARDUINO_NANO) && !defined(BOARD_ARDUINO_UNO) && !defined(BOARD_ARDUINO_PRO_MICRO)
         { test_errno, "test_errno" },
 #endif
@@ -315,6 +315,12 @@ int test_monitor_thread(struct harness_t *harness_p)
     strcpy(command, "/kernel/thrd/monitor/set_print 0");
     BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
 
+#if defined(ARCH_LINUX) && CONFIG_THRD_CPU_USAGE == 1
+    /* The idle thread has been running while this thread slept. */
+    BTASSERT(thrd_get_by_name("idle") != NULL);
+    BTASSERT(thrd_get_by_name("idle")->statistics.cpu.usage > 0);
+#endif
+
     /* Missing period. */
     strcpy(command, "/kernel/thrd/monitor/set_period_ms");
     BTASSERT(fs_call(command, NULL, chan_null(), NULL) == -EINVAL);
@@ -326,6 +332,73 @@ int test_monitor_thread(struct harness_t *harness_p)
     return (0);
 }
 
+#if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+
+static THRD_STACK(yielder_stack, 256);
+
+static void *yielder_main(void *arg_p)
+{
+    thrd_set_name("yielder");
+
+    return (NULL);
+}
+
+int test_scheduler_statistics(struct harness_t *harness_p)
+{
+    struct thrd_t *thrd_p;
+    struct thrd_t *yielder_p;
+    uint32_t voluntary;
+    uint32_t involuntary;
+    uint64_t blocked_time_us;
+    uint32_t latencies;
+    int i;
+    char command[32];
+
+    thrd_p = thrd_self();
+    voluntary = thrd_p->statistics.switches.voluntary;
+    involuntary = thrd_p->statistics.switches.involuntary;
+    blocked_time_us = thrd_p->statistics.blocked.time_us;
+
+    /* Sleeping is a voluntary context switch. */
+    BTASSERT(thrd_sleep_ms(20) == 0);
+    BTASSERTI(thrd_p->statistics.switches.voluntary, >, voluntary);
+    BTASSERTI(thrd_p->statistics.switches.involuntary, ==, involuntary);
+#if defined(ARCH_LINUX)
+    BTASSERTI(thrd_p->statistics.blocked.time_us - blocked_time_us,
+              >=,
+              15000);
+#endif
+
+    /* Yielding to a thread with the same priority is an involuntary
+       context switch. */
+    yielder_p = thrd_spawn(yielder_main,
+                           NULL,
+                           thrd_get_prio(),
+                           yielder_stack,
+                           sizeof(yielder_stack));
+    BTASSERT(yielder_p != NULL);
+    BTASSERT(thrd_yield() == 0);
+    BTASSERTI(thrd_p->statistics.switches.involuntary, ==, involuntary + 1);
+    BTASSERT(thrd_join(yielder_p) == 0);
+
+    /* The yielder thread was scheduled once. */
+    latencies = 0;
+
+    for (i = 0; i < THRD_LATENCY_HISTOGRAM_MAX; i++) {
+        latencies += yielder_p->statistics.ready.histogram[i];
+    }
+
+    BTASSERTI(latencies, ==, 1);
+    BTASSERTI(yielder_p->statistics.switches.voluntary, ==, 1);
+
+    strcpy(command, "/kernel/thrd/list");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    return (0);
+}
+
+#endif
+
 int test_stack_heap(struct harness_t *harness_p)
 {
     BTASSERT(thrd_stack_alloc(1) == NULL);
@@ -375,6 +448,9 @@ int main()
         { test_stack_top_bottom, "test_stack_top_bottom" },
 #    if CONFIG_MONITOR_THREAD == 1
         { test_monitor_thread, "test_monitor_thread" },
+#    endif
+#    if CONFIG_THRD_SCHEDULER_STATISTICS == 1
+        { test_scheduler_statistics, "test_scheduler_statistics" },
 #    endif
         { test_stack_heap, "test_stack_heap" },
         { test_prio_list, "test_prio_list" },
@@ -0,0 +1,591 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SOURCE_PATH                                     "source.wav"
+#define SINK_PATH                                       "dac.bin"
+
+/* One stream per output format. */
+static struct audio_stream_t pcm16_stream;
+static struct audio_stream_frame_t pcm16_frames[4];
+static uint8_t pcm16_buf[1024];
+static THRD_STACK(pcm16_stack, 2048);
+static struct audio_stream_t dac12_stream;
+static struct audio_stream_frame_t dac12_frames[2];
+static uint8_t dac12_buf[64];
+static THRD_STACK(dac12_stack, 2048);
+
+static uint8_t source_buf[8192];
+static uint16_t expected[8192];
+static uint16_t sink_buf[8192];
+
+static struct sem_t source_sem;
+static size_t source_left;
+
+static void write_u16(uint8_t *buf_p, uint16_t value)
+{
+    buf_p[0] = value;
+    buf_p[1] = (value >> 8);
+}
+
+static void write_u32(uint8_t *buf_p, uint32_t value)
+{
+    write_u16(&buf_p[0], value);
+    write_u16(&buf_p[2], value >> 16);
+}
+
+/**
+ * Create a WAV file with a LIST chunk before the data chunk.
+ */
+static size_t create_wav(uint8_t *buf_p,
+                         int format,
+                         int channels,
+                         int bits_per_sample,
+                         int block_align,
+                         const void *data_p,
+                         size_t size)
+{
+    memcpy(&buf_p[0], "RIFF", 4);
+    write_u32(&buf_p[4], 4 + 8 + 20 + 8 + 6 + 8 + size);
+    memcpy(&buf_p[8], "WAVE", 4);
+    memcpy(&buf_p[12], "fmt ", 4);
+    write_u32(&buf_p[16], 20);
+    write_u16(&buf_p[20], format);
+    write_u16(&buf_p[22], channels);
+    write_u32(&buf_p[24], 22050);
+    write_u32(&buf_p[28], 0);
+    write_u16(&buf_p[32], block_align);
+    write_u16(&buf_p[34], bits_per_sample);
+    write_u32(&buf_p[36], 0);
+    memcpy(&buf_p[40], "LIST", 4);
+    write_u32(&buf_p[44], 5);
+    memcpy(&buf_p[48], "INFO\0\0", 6);
+    memcpy(&buf_p[54], "data", 4);
+    write_u32(&buf_p[58], size);
+    memcpy(&buf_p[62], data_p, size);
+
+    return (62 + size);
+}
+
+static int write_file(const char *path_p, const void *buf_p, size_t size)
+{
+    FILE *file_p;
+
+    file_p = fopen(path_p, "wb");
+
+    if (file_p == NULL) {
+        return (-1);
+    }
+
+    if (fwrite(buf_p, 1, size, file_p) != size) {
+        fclose(file_p);
+
+        return (-1);
+    }
+
+    return (fclose(file_p));
+}
+
+/**
+ * Read from a file in small chunks to exercise the read ahead buffer.
+ */
+static ssize_t file_read(void *arg_p, void *buf_p, size_t size)
+{
+    return (fread(buf_p, 1, MIN(size, 37), arg_p));
+}
+
+/**
+ * Play given stream on a DAC that writes all samples to given file,
+ * and read the file back into given buffer.
+ *
+ * @return Number of samples played or negative error code.
+ */
+static ssize_t play(struct audio_stream_t *stream_p,
+                    FILE *source_p,
+                    uint16_t *buf_p,
+                    size_t length)
+{
+    struct audio_stream_frame_t *frame_p;
+    FILE *sink_p;
+    ssize_t size;
+    int res;
+
+    sink_p = fopen(SINK_PATH, "wb");
+
+    if (sink_p == NULL) {
+        return (-1);
+    }
+
+    if (audio_stream_open(stream_p, file_read, source_p) != 0) {
+        return (-1);
+    }
+
+    while (1) {
+        res = audio_stream_read_frame(stream_p, &frame_p);
+
+        if (res == -EAGAIN) {
+            thrd_sleep_us(1000);
+        } else if (res > 0) {
+            fwrite(&frame_p->samples[0], 2, res, sink_p);
+            audio_stream_release_frame(stream_p, frame_p);
+        } else {
+            break;
+        }
+    }
+
+    audio_stream_close(stream_p);
+    fclose(sink_p);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    sink_p = fopen(SINK_PATH, "rb");
+
+    if (sink_p == NULL) {
+        return (-1);
+    }
+
+    size = fread(buf_p, 2, length, sink_p);
+    fclose(sink_p);
+
+    return (size);
+}
+
+static ssize_t play_buf(struct audio_stream_t *stream_p,
+                        const void *buf_p,
+                        size_t size)
+{
+    FILE *source_p;
+    ssize_t res;
+
+    if (write_file(SOURCE_PATH, buf_p, size) != 0) {
+        return (-1);
+    }
+
+    source_p = fopen(SOURCE_PATH, "rb");
+
+    if (source_p == NULL) {
+        return (-1);
+    }
+
+    res = play(stream_p, source_p, &sink_buf[0], membersof(sink_buf));
+    fclose(source_p);
+
+    return (res);
+}
+
+static unsigned long long counter_get(const char *name_p)
+{
+    char path[64];
+    char buf[32];
+    struct queue_t queue;
+
+    queue_init(&queue, &buf[0], sizeof(buf));
+    std_sprintf(&path[0], FSTR("/multimedia/audio_stream/%s"), name_p);
+
+    if (fs_call(&path[0], NULL, &queue, NULL) != 0) {
+        return (-1);
+    }
+
+    memset(&path[0], 0, sizeof(path));
+    queue_read(&queue, &path[0], 16);
+
+    return (strtoull(&path[0], NULL, 16));
+}
+
+static int test_start(struct harness_t *harness_p)
+{
+    BTASSERT(audio_stream_module_init() == 0);
+    BTASSERT(audio_stream_module_init() == 0);
+    BTASSERT(sem_init(&source_sem, 1, 1) == 0);
+    BTASSERT(audio_stream_init(&pcm16_stream,
+                               &pcm16_frames[0],
+                               membersof(pcm16_frames),
+                               &pcm16_buf[0],
+                               sizeof(pcm16_buf),
+                               AUDIO_STREAM_FORMAT_PCM16) == 0);
+    BTASSERT(audio_stream_start(&pcm16_stream,
+                                pcm16_stack,
+                                sizeof(pcm16_stack)) == 0);
+    BTASSERT(audio_stream_init(&dac12_stream,
+                               &dac12_frames[0],
+                               membersof(dac12_frames),
+                               &dac12_buf[0],
+                               sizeof(dac12_buf),
+                               AUDIO_STREAM_FORMAT_DAC12) == 0);
+    BTASSERT(audio_stream_start(&dac12_stream,
+                                dac12_stack,
+                                sizeof(dac12_stack)) == 0);
+
+    return (0);
+}
+
+static int test_wav_pcm16(struct harness_t *harness_p)
+{
+    int16_t data[2000];
+    unsigned long long frames_before;
+    unsigned long long bytes_read_before;
+    size_t size;
+    int i;
+
+    for (i = 0; i < membersof(data); i++) {
+        data[i] = (31 * i - 30000);
+    }
+
+    /* The samples are little endian in the file. */
+    size = create_wav(&source_buf[0], 1, 2, 16, 4, &data[0], sizeof(data));
+    frames_before = counter_get("frames");
+    bytes_read_before = counter_get("bytes_read");
+
+    BTASSERT(play_buf(&pcm16_stream, &source_buf[0], size)
+             == membersof(data));
+    BTASSERTM(&sink_buf[0], &data[0], sizeof(data));
+
+    /* Three full frames and one partial. */
+    BTASSERT(counter_get("frames") == frames_before + 4);
+    BTASSERT(counter_get("bytes_read") == bytes_read_before + size);
+
+    return (0);
+}
+
+static int test_wav_pcm8_mono_dac12(struct harness_t *harness_p)
+{
+    uint8_t data[301];
+    size_t size;
+    int i;
+
+    for (i = 0; i < membersof(data); i++) {
+        data[i] = i;
+        expected[2 * i] = ((data[i] << 4) | 0x1000);
+        expected[2 * i + 1] = (data[i] << 4);
+    }
+
+    /* Odd sized data chunk. */
+    size = create_wav(&source_buf[0], 1, 1, 8, 1, &data[0], sizeof(data));
+
+    BTASSERT(play_buf(&dac12_stream, &source_buf[0], size)
+             == 2 * membersof(data));
+    BTASSERTM(&sink_buf[0], &expected[0], 4 * membersof(data));
+
+    return (0);
+}
+
+static int test_wav_pcm16_stereo_dac12(struct harness_t *harness_p)
+{
+    int16_t data[4];
+    size_t size;
+
+    data[0] = -32768;
+    data[1] = 32767;
+    data[2] = 0;
+    data[3] = 4096;
+    expected[0] = 0x1fff;
+    expected[1] = 0x0000;
+    expected[2] = 0x1900;
+    expected[3] = 0x0800;
+
+    size = create_wav(&source_buf[0], 1, 2, 16, 4, &data[0], sizeof(data));
+
+    BTASSERT(play_buf(&dac12_stream, &source_buf[0], size) == 4);
+    BTASSERTM(&sink_buf[0], &expected[0], 8);
+
+    /* Keep the four most significant bits. */
+    BTASSERT(audio_stream_set_bits_per_sample(&dac12_stream, 13) == -EINVAL);
+    BTASSERT(audio_stream_set_bits_per_sample(&dac12_stream, 4) == 0);
+    expected[0] = 0x1f00;
+    expected[2] = 0x1900;
+    BTASSERT(play_buf(&dac12_stream, &source_buf[0], size) == 4);
+    BTASSERTM(&sink_buf[0], &expected[0], 8);
+    BTASSERT(audio_stream_set_bits_per_sample(&dac12_stream, 12) == 0);
+
+    return (0);
+}
+
+static int16_t adpcm_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34,
+    37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494,
+    544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552,
+    1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428,
+    4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086,
+    29794, 32767
+};
+
+static int8_t adpcm_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+struct adpcm_encoder_t {
+    int32_t predictor;
+    int index;
+};
+
+/**
+ * Encode given sample and store the sample the decoder will
+ * reconstruct in the encoder.
+ */
+static int adpcm_encode(struct adpcm_encoder_t *self_p, int16_t sample)
+{
+    int32_t step;
+    int32_t difference;
+    int32_t delta;
+    int nibble;
+
+    step = adpcm_step_table[self_p->index];
+    difference = (sample - self_p->predictor);
+    nibble = 0;
+
+    if (difference < 0) {
+        nibble = 8;
+        difference = -difference;
+    }
+
+    delta = (step >> 3);
+
+    if (difference >= step) {
+        nibble |= 4;
+        difference -= step;
+        delta += step;
+    }
+
+    if (difference >= (step >> 1)) {
+        nibble |= 2;
+        difference -= (step >> 1);
+        delta += (step >> 1);
+    }
+
+    if (difference >= (step >> 2)) {
+        nibble |= 1;
+        delta += (step >> 2);
+    }
+
+    if (nibble & 8) {
+        self_p->predictor -= delta;
+    } else {
+        self_p->predictor += delta;
+    }
+
+    self_p->predictor = MAX(MIN(self_p->predictor, 32767), -32768);
+    self_p->index = MAX(MIN(self_p->index + adpcm_index_table[nibble], 88), 0);
+
+    return (nibble);
+}
+
+/**
+ * Stereo IMA ADPCM with 64 bytes blocks; a 4 bytes header and seven
+ * groups of four bytes, or 8 samples, per channel.
+ */
+static int test_wav_ima_adpcm(struct harness_t *harness_p)
+{
+    struct adpcm_encoder_t encoders[2];
+    uint8_t data[3 * 64 + 24];
+    int16_t sample;
+    size_t length;
+    size_t size;
+    size_t offset;
+    int block;
+    int channel;
+    int group;
+    int i;
+    int nibble;
+    int blocks;
+
+    memset(&encoders[0], 0, sizeof(encoders));
+    memset(&data[0], 0, sizeof(data));
+    length = 0;
+    offset = 0;
+    blocks = 4;
+
+    for (block = 0; block < blocks; block++) {
+        /* Header with the first sample. */
+        for (channel = 0; channel < 2; channel++) {
+            sample = (channel == 0 ? 1000 * block : -1000 * block);
+            encoders[channel].predictor = sample;
+            write_u16(&data[offset], sample);
+            data[offset + 2] = encoders[channel].index;
+            expected[length + channel] = sample;
+            offset += 4;
+        }
+
+        length += 2;
+
+        /* Seven groups in full blocks, and two in the last block. */
+        for (group = 0; group < (block < blocks - 1 ? 7 : 2); group++) {
+            for (channel = 0; channel < 2; channel++) {
+                for (i = 0; i < 8; i++) {
+                    sample = (4000 * ((i + group) % 5)
+                              * (channel == 0 ? 1 : -1));
+                    nibble = adpcm_encode(&encoders[channel], sample);
+                    data[offset + i / 2] |= (nibble << (4 * (i % 2)));
+                    expected[length + 2 * i + channel] =
+                        encoders[channel].predictor;
+                }
+
+                offset += 4;
+            }
+
+            length += 16;
+        }
+    }
+
+    BTASSERT(offset == sizeof(data));
+    size = create_wav(&source_buf[0], 0x11, 2, 4, 64, &data[0], sizeof(data));
+
+    BTASSERT(play_buf(&pcm16_stream, &source_buf[0], size) == length);
+    BTASSERTM(&sink_buf[0], &expected[0], 2 * length);
+
+    return (0);
+}
+
+static int test_raw_dac12(struct harness_t *harness_p)
+{
+    uint16_t data[1500];
+    int i;
+
+    for (i = 0; i < membersof(data); i += 2) {
+        data[i] = (0x1000 | (i & 0xfff));
+        data[i + 1] = (0xfff - (i & 0xfff));
+        expected[i] = (data[i] & 0xffc0);
+        expected[i + 1] = (data[i + 1] & 0xffc0);
+    }
+
+    /* Keep the six most significant bits, and the channel tag. */
+    BTASSERT(audio_stream_set_bits_per_sample(&dac12_stream, 6) == 0);
+    BTASSERT(play_buf(&dac12_stream, &data[0], sizeof(data))
+             == membersof(data));
+    BTASSERTM(&sink_buf[0], &expected[0], sizeof(data));
+    BTASSERT(audio_stream_set_bits_per_sample(&dac12_stream, 12) == 0);
+
+    return (0);
+}
+
+static int test_bad_format(struct harness_t *harness_p)
+{
+    uint8_t data[16];
+    size_t size;
+
+    memset(&data[0], 0, sizeof(data));
+
+    /* MPEG layer 3 is not supported. */
+    size = create_wav(&source_buf[0], 0x55, 2, 0, 1, &data[0], sizeof(data));
+
+    BTASSERT(play_buf(&pcm16_stream, &source_buf[0], size) == -EPROTO);
+
+    /* Truncated header. */
+    BTASSERT(play_buf(&pcm16_stream, &source_buf[0], 30) == -EPROTO);
+
+    return (0);
+}
+
+/**
+ * A source that returns a frame of raw data each time the source
+ * semaphore is given, until no data is left.
+ */
+static ssize_t blocking_read(void *arg_p, void *buf_p, size_t size)
+{
+    sem_take(&source_sem, NULL);
+    size = MIN(size, source_left);
+    memset(buf_p, 0, size);
+    source_left -= size;
+
+    return (size);
+}
+
+static int test_underrun_and_close(struct harness_t *harness_p)
+{
+    struct audio_stream_frame_t *frame_p;
+    unsigned long long underruns_before;
+    unsigned long long level_before;
+    int res;
+
+    underruns_before = counter_get("underruns");
+    level_before = counter_get("level");
+    source_left = (10 * CONFIG_AUDIO_STREAM_FRAME_SAMPLES);
+    BTASSERT(audio_stream_open(&pcm16_stream, blocking_read, NULL) == 0);
+    BTASSERT(audio_stream_open(&pcm16_stream, blocking_read, NULL) == -EBUSY);
+
+    /* Not an underrun as nothing has been played yet. */
+    BTASSERT(audio_stream_read_frame(&pcm16_stream, &frame_p) == -EAGAIN);
+    BTASSERT(counter_get("underruns") == underruns_before);
+
+    /* Read a full frame of raw samples. */
+    sem_give(&source_sem, 1);
+
+    do {
+        res = audio_stream_read_frame(&pcm16_stream, &frame_p);
+        thrd_sleep_ms(1);
+    } while (res == -EAGAIN);
+
+    BTASSERT(res == CONFIG_AUDIO_STREAM_FRAME_SAMPLES);
+    BTASSERT(audio_stream_release_frame(&pcm16_stream, frame_p) == 0);
+
+    /* The reader thread is waiting for more data. */
+    BTASSERT(audio_stream_read_frame(&pcm16_stream, &frame_p) == -EAGAIN);
+    BTASSERT(audio_stream_read_frame(&pcm16_stream, &frame_p) == -EAGAIN);
+    BTASSERT(counter_get("underruns") == underruns_before + 2);
+    BTASSERT(counter_get("level") == level_before);
+
+    /* Close the stream while the reader thread is reading. */
+    source_left = 0;
+    sem_give(&source_sem, 1);
+    BTASSERT(audio_stream_close(&pcm16_stream) == 0);
+    BTASSERT(audio_stream_read_frame(&pcm16_stream, &frame_p) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_start, "test_start" },
+        { test_wav_pcm16, "test_wav_pcm16" },
+        { test_wav_pcm8_mono_dac12, "test_wav_pcm8_mono_dac12" },
+        { test_wav_pcm16_stereo_dac12, "test_wav_pcm16_stereo_dac12" },
+        { test_wav_ima_adpcm, "test_wav_ima_adpcm" },
+        { test_raw_dac12, "test_raw_dac12" },
+        { test_bad_format, "test_bad_format" },
+        { test_underrun_and_close, "test_underrun_and_close" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
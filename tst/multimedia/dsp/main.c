@@ -0,0 +1,442 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static uint32_t seed = 1;
+
+static int16_t random_sample(void)
+{
+    seed = (1103515245 * seed + 12345);
+
+    return (seed >> 16);
+}
+
+static int16_t saturate(int32_t value)
+{
+    if (value > 32767) {
+        return (32767);
+    } else if (value < -32768) {
+        return (-32768);
+    }
+
+    return (value);
+}
+
+static int test_mix(struct harness_t *harness_p)
+{
+    int16_t dst[37];
+    int16_t src[37];
+    int16_t expected[37];
+    int16_t gains[] = { 32767, 16384, 0, -1, -32768 };
+    int i;
+    int j;
+
+    for (j = 0; j < membersof(gains); j++) {
+        for (i = 0; i < membersof(dst); i++) {
+            dst[i] = random_sample();
+            src[i] = random_sample();
+        }
+
+        /* Extreme values. */
+        dst[3] = -1;
+        src[3] = -32768;
+        dst[12] = 32767;
+        src[12] = 32767;
+
+        for (i = 0; i < membersof(dst); i++) {
+            expected[i] = saturate(dst[i]
+                                   + saturate((src[i] * gains[j]) >> 15));
+        }
+
+        BTASSERT(dsp_mix(&dst[0], &src[0], gains[j], membersof(dst)) == 0);
+        BTASSERTM(&dst[0], &expected[0], sizeof(dst));
+    }
+
+    return (0);
+}
+
+static int test_gain(struct harness_t *harness_p)
+{
+    int16_t samples[21];
+    int16_t expected[21];
+    int i;
+
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = random_sample();
+    }
+
+    samples[0] = -32768;
+
+    for (i = 0; i < membersof(samples); i++) {
+        expected[i] = saturate((samples[i] * -32768) >> 15);
+    }
+
+    BTASSERT(dsp_gain(&samples[0], -32768, membersof(samples)) == 0);
+    BTASSERTM(&samples[0], &expected[0], sizeof(samples));
+    BTASSERT(samples[0] == 32767);
+
+    return (0);
+}
+
+static int test_oscillator_bank(struct harness_t *harness_p)
+{
+    struct dsp_oscillator_bank_t bank;
+    struct dsp_oscillator_t oscillators[3];
+    int16_t wavetable[4] = { 0, 32767, 0, -32768 };
+    int16_t samples[130];
+    int i;
+
+    BTASSERT(dsp_oscillator_bank_init(&bank,
+                                      &wavetable[0],
+                                      3,
+                                      8000,
+                                      &oscillators[0],
+                                      membersof(oscillators)) == -EINVAL);
+    BTASSERT(dsp_oscillator_bank_init(&bank,
+                                      &wavetable[0],
+                                      membersof(wavetable),
+                                      8000,
+                                      &oscillators[0],
+                                      membersof(oscillators)) == 0);
+    BTASSERT(dsp_oscillator_bank_set(&bank, 0, 4000.0f, 32767) == -EINVAL);
+
+    /* All oscillators are silent. */
+    BTASSERT(dsp_oscillator_bank_render(&bank,
+                                        &samples[0],
+                                        membersof(samples)) == 0);
+
+    for (i = 0; i < membersof(samples); i++) {
+        BTASSERT(samples[i] == 0);
+    }
+
+    /* One sample per wavetable entry. */
+    BTASSERT(dsp_oscillator_bank_set(&bank, 0, 2000.0f, 16384) == 0);
+    BTASSERT(dsp_oscillator_bank_render_one(&bank, 0, &samples[0], 8) == 0);
+    BTASSERT(samples[0] == 0);
+    BTASSERT(samples[1] == 16383);
+    BTASSERT(samples[2] == 0);
+    BTASSERT(samples[3] == -16384);
+    BTASSERT(samples[4] == 0);
+    BTASSERT(samples[5] == 16383);
+
+    /* Two oscillators in phase saturates, over several blocks. */
+    BTASSERT(dsp_oscillator_bank_init(&bank,
+                                      &wavetable[0],
+                                      membersof(wavetable),
+                                      8000,
+                                      &oscillators[0],
+                                      membersof(oscillators)) == 0);
+    BTASSERT(dsp_oscillator_bank_set(&bank, 0, 2000.0f, 32767) == 0);
+    BTASSERT(dsp_oscillator_bank_set(&bank, 2, 2000.0f, 32767) == 0);
+    BTASSERT(dsp_oscillator_bank_render(&bank,
+                                        &samples[0],
+                                        membersof(samples)) == 0);
+
+    for (i = 0; i < membersof(samples); i += 4) {
+        BTASSERT(samples[i] == 0);
+        BTASSERT(samples[i + 1] == 32767);
+    }
+
+    for (i = 2; i < membersof(samples) - 2; i += 4) {
+        BTASSERT(samples[i] == 0);
+        BTASSERT(samples[i + 1] == -32768);
+    }
+
+    return (0);
+}
+
+static int test_envelope(struct harness_t *harness_p)
+{
+    struct dsp_envelope_t envelope;
+    int16_t samples[16];
+    int i;
+
+    BTASSERT(dsp_envelope_init(&envelope, 4, 4, 16384, 4) == 0);
+    BTASSERT(dsp_envelope_is_active(&envelope) == 0);
+
+    /* An idle envelope silences the samples. */
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = 32767;
+    }
+
+    BTASSERT(dsp_envelope_apply(&envelope,
+                                &samples[0],
+                                membersof(samples)) == 0);
+
+    for (i = 0; i < membersof(samples); i++) {
+        BTASSERT(samples[i] == 0);
+    }
+
+    /* Attack, decay and sustain. */
+    BTASSERT(dsp_envelope_start(&envelope) == 0);
+    BTASSERT(dsp_envelope_is_active(&envelope) == 1);
+
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = 32767;
+    }
+
+    BTASSERT(dsp_envelope_apply(&envelope,
+                                &samples[0],
+                                membersof(samples)) == membersof(samples));
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(samples[i] < samples[i + 1]);
+    }
+
+    BTASSERT(samples[4] == 32766);
+
+    for (i = 4; i < 8; i++) {
+        BTASSERT(samples[i] > samples[i + 1]);
+    }
+
+    for (i = 8; i < membersof(samples); i++) {
+        BTASSERT(samples[i] == 16383);
+    }
+
+    /* Release. */
+    BTASSERT(dsp_envelope_release(&envelope) == 0);
+
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = 32767;
+    }
+
+    BTASSERT(dsp_envelope_apply(&envelope, &samples[0], 8) == 3);
+    BTASSERT(dsp_envelope_is_active(&envelope) == 0);
+    BTASSERT(samples[0] == 16383);
+    BTASSERT(samples[1] < samples[0]);
+    BTASSERT(samples[2] < samples[1]);
+
+    for (i = 3; i < 8; i++) {
+        BTASSERT(samples[i] == 0);
+    }
+
+    return (0);
+}
+
+static int test_fir(struct harness_t *harness_p)
+{
+    struct dsp_fir_t fir;
+    int16_t coefficients[33];
+    int16_t state[DSP_FIR_STATE_LENGTH(33)];
+    int16_t src[300];
+    int16_t dst[300];
+    int16_t expected[300];
+    size_t sizes[] = { 1, 100, 37, 8, 154 };
+    size_t offset;
+    int32_t sum;
+    int i;
+    int j;
+
+    /* The impulse response. */
+    coefficients[0] = 16384;
+    coefficients[1] = 8192;
+    coefficients[2] = -4096;
+
+    BTASSERT(dsp_fir_init(&fir,
+                          &coefficients[0],
+                          3,
+                          &state[0],
+                          DSP_FIR_STATE_LENGTH(3) - 1) == -EINVAL);
+    BTASSERT(dsp_fir_init(&fir,
+                          &coefficients[0],
+                          3,
+                          &state[0],
+                          membersof(state)) == 0);
+    memset(&src[0], 0, sizeof(src));
+    src[0] = 32767;
+    BTASSERT(dsp_fir_filter(&fir, &dst[0], &src[0], 5) == 0);
+    BTASSERT(dst[0] == 16383);
+    BTASSERT(dst[1] == 8191);
+    BTASSERT(dst[2] == -4096);
+    BTASSERT(dst[3] == 0);
+    BTASSERT(dst[4] == 0);
+
+    /* Compare to a direct convolution, in chunks of different
+       sizes. */
+    for (i = 0; i < membersof(coefficients); i++) {
+        coefficients[i] = (random_sample() / 20);
+    }
+
+    for (i = 0; i < membersof(src); i++) {
+        src[i] = random_sample();
+    }
+
+    for (i = 0; i < membersof(src); i++) {
+        sum = 0;
+
+        for (j = 0; (j < membersof(coefficients)) && (j <= i); j++) {
+            sum += (coefficients[j] * src[i - j]);
+        }
+
+        expected[i] = saturate(sum >> 15);
+    }
+
+    BTASSERT(dsp_fir_init(&fir,
+                          &coefficients[0],
+                          membersof(coefficients),
+                          &state[0],
+                          membersof(state)) == 0);
+    offset = 0;
+
+    for (i = 0; i < membersof(sizes); i++) {
+        BTASSERT(dsp_fir_filter(&fir,
+                                &dst[offset],
+                                &src[offset],
+                                sizes[i]) == 0);
+        offset += sizes[i];
+    }
+
+    BTASSERT(offset == membersof(src));
+    BTASSERTM(&dst[0], &expected[0], sizeof(dst));
+
+    /* In place. */
+    BTASSERT(dsp_fir_init(&fir,
+                          &coefficients[0],
+                          membersof(coefficients),
+                          &state[0],
+                          membersof(state)) == 0);
+    BTASSERT(dsp_fir_filter(&fir, &src[0], &src[0], membersof(src)) == 0);
+    BTASSERTM(&src[0], &expected[0], sizeof(src));
+
+    return (0);
+}
+
+static int test_biquad(struct harness_t *harness_p)
+{
+    struct dsp_biquad_t biquad;
+    int16_t samples[64];
+    int i;
+
+    BTASSERT(dsp_biquad_init(&biquad, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f)
+             == -EINVAL);
+
+    /* Pass through. */
+    BTASSERT(dsp_biquad_init(&biquad, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f) == 0);
+
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = random_sample();
+    }
+
+    samples[0] = -32768;
+    BTASSERT(dsp_biquad_filter(&biquad, &samples[0], &samples[0], 1) == 0);
+    BTASSERT(samples[0] == -32768);
+
+    /* A one pole low pass filter, y[n] = 0.5 * x[n] + 0.5 * y[n - 1],
+       has unity gain at DC. */
+    BTASSERT(dsp_biquad_init(&biquad, 0.5f, 0.0f, 0.0f, -0.5f, 0.0f) == 0);
+
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = 10000;
+    }
+
+    BTASSERT(dsp_biquad_filter(&biquad,
+                               &samples[0],
+                               &samples[0],
+                               membersof(samples)) == 0);
+    BTASSERT(samples[0] == 5000);
+    BTASSERT(samples[1] == 7500);
+    BTASSERT(samples[2] == 8750);
+    BTASSERT(samples[membersof(samples) - 1] >= 9998);
+    BTASSERT(samples[membersof(samples) - 1] <= 10000);
+
+    return (0);
+}
+
+static int test_resampler(struct harness_t *harness_p)
+{
+    struct dsp_resampler_t resampler;
+    int16_t src[8];
+    int16_t dst[32];
+    int i;
+
+    for (i = 0; i < membersof(src); i++) {
+        src[i] = (1000 * (i + 1));
+    }
+
+    BTASSERT(dsp_resampler_init(&resampler, 1, 100000) == -EINVAL);
+
+    /* Upsample twice. The output is delayed one input sample. */
+    BTASSERT(dsp_resampler_init(&resampler, 8000, 16000) == 0);
+    BTASSERT(dsp_resampler_process(&resampler,
+                                   &dst[0],
+                                   15,
+                                   &src[0],
+                                   membersof(src)) == -ENOMEM);
+    BTASSERT(dsp_resampler_process(&resampler,
+                                   &dst[0],
+                                   membersof(dst),
+                                   &src[0],
+                                   4) == 8);
+    BTASSERT(dsp_resampler_process(&resampler,
+                                   &dst[8],
+                                   membersof(dst) - 8,
+                                   &src[4],
+                                   4) == 8);
+
+    for (i = 0; i < 16; i++) {
+        BTASSERT(dst[i] == 500 * i);
+    }
+
+    /* Downsample three times. */
+    BTASSERT(dsp_resampler_init(&resampler, 48000, 16000) == 0);
+    BTASSERT(dsp_resampler_process(&resampler,
+                                   &dst[0],
+                                   membersof(dst),
+                                   &src[0],
+                                   membersof(src)) == 3);
+    BTASSERT(dst[0] == 0);
+    BTASSERT(dst[1] == 3000);
+    BTASSERT(dst[2] == 6000);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_mix, "test_mix" },
+        { test_gain, "test_gain" },
+        { test_oscillator_bank, "test_oscillator_bank" },
+        { test_envelope, "test_envelope" },
+        { test_fir, "test_fir" },
+        { test_biquad, "test_biquad" },
+        { test_resampler, "test_resampler" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
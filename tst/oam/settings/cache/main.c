@@ -0,0 +1,198 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static THRD_STACK(committer_stack, 1024);
+
+static int32_t nvm_read_int32(void)
+{
+    int32_t int32;
+
+    int32 = 0;
+    nvm_read(&int32, SETTING_INT32_ADDR, sizeof(int32));
+
+    return (int32);
+}
+
+static int test_reset(struct harness_t *harness_p)
+{
+    int32_t int32;
+
+    BTASSERTI(settings_reset(), ==, 0);
+
+    /* The defaults are both cached and written. */
+    BTASSERTI(settings_read(&int32,
+                            SETTING_INT32_ADDR,
+                            SETTING_INT32_SIZE), ==, SETTING_INT32_SIZE);
+    BTASSERTI(int32, ==, SETTING_INT32_VALUE);
+    BTASSERTI(nvm_read_int32(), ==, SETTING_INT32_VALUE);
+
+    return (0);
+}
+
+static int test_read_write_by_name(struct harness_t *harness_p)
+{
+    int32_t int32;
+    char string[SETTING_STRING_SIZE];
+
+    int32 = 0;
+    BTASSERTI(settings_read_by_name("int32",
+                                    &int32,
+                                    sizeof(int32)), ==, sizeof(int32));
+    BTASSERTI(int32, ==, SETTING_INT32_VALUE);
+
+    memset(&string[0], 0, sizeof(string));
+    BTASSERTI(settings_read_by_name("max_name_length_40_123456789012345678901",
+                                    &string[0],
+                                    sizeof(string)), ==, sizeof(string));
+    BTASSERTI(string[0], ==, '\0');
+
+    int32 = 5;
+    BTASSERTI(settings_write_by_name("int32",
+                                     &int32,
+                                     sizeof(int32)), ==, sizeof(int32));
+    int32 = 0;
+    BTASSERTI(settings_read_by_name("int32",
+                                    &int32,
+                                    sizeof(int32)), ==, sizeof(int32));
+    BTASSERTI(int32, ==, 5);
+
+    /* Missing settings and too big values. */
+    BTASSERTI(settings_read_by_name("missing",
+                                    &int32,
+                                    sizeof(int32)), ==, -1);
+    BTASSERTI(settings_read_by_name("int3",
+                                    &int32,
+                                    sizeof(int32)), ==, -1);
+    BTASSERTI(settings_write_by_name("string",
+                                     "hello",
+                                     6), ==, -1);
+
+    BTASSERTI(settings_commit(), ==, 0);
+
+    return (0);
+}
+
+static int test_commit(struct harness_t *harness_p)
+{
+    int32_t int32;
+    char string[SETTING_STRING_SIZE];
+
+    /* Write two settings. Nothing is written to the non-volatile
+       memory until committed. */
+    int32 = 1234;
+    BTASSERTI(settings_write(SETTING_INT32_ADDR,
+                             &int32,
+                             SETTING_INT32_SIZE), ==, SETTING_INT32_SIZE);
+    BTASSERTI(settings_write(SETTING_STRING_ADDR,
+                             "ab",
+                             3), ==, 3);
+
+    int32 = 0;
+    BTASSERTI(settings_read(&int32,
+                            SETTING_INT32_ADDR,
+                            SETTING_INT32_SIZE), ==, SETTING_INT32_SIZE);
+    BTASSERTI(int32, ==, 1234);
+    BTASSERTI(nvm_read_int32(), ==, 5);
+
+    /* Both settings are written. */
+    BTASSERTI(settings_commit(), ==, 0);
+    BTASSERTI(nvm_read_int32(), ==, 1234);
+    BTASSERTI(nvm_read(&string[0],
+                       SETTING_STRING_ADDR,
+                       3), ==, 3);
+    BTASSERTM(&string[0], "ab", 3);
+
+    /* Nothing to commit. */
+    BTASSERTI(settings_commit(), ==, 0);
+
+    return (0);
+}
+
+static int test_out_of_range(struct harness_t *harness_p)
+{
+    uint8_t buf[2];
+
+    BTASSERTI(settings_read(&buf[0],
+                            CONFIG_SETTINGS_AREA_SIZE - 1,
+                            2), ==, -EINVAL);
+    BTASSERTI(settings_write(CONFIG_SETTINGS_AREA_SIZE,
+                             &buf[0],
+                             1), ==, -EINVAL);
+
+    return (0);
+}
+
+static int test_committer(struct harness_t *harness_p)
+{
+    int32_t int32;
+
+    BTASSERTI(settings_start_committer(&committer_stack[0],
+                                       sizeof(committer_stack)), ==, 0);
+
+    /* Each write restarts the commit delay. */
+    int32 = 7;
+    BTASSERTI(settings_write(SETTING_INT32_ADDR,
+                             &int32,
+                             SETTING_INT32_SIZE), ==, SETTING_INT32_SIZE);
+    thrd_sleep_ms(50);
+    int32 = 8;
+    BTASSERTI(settings_write(SETTING_INT32_ADDR,
+                             &int32,
+                             SETTING_INT32_SIZE), ==, SETTING_INT32_SIZE);
+    thrd_sleep_ms(50);
+    BTASSERTI(nvm_read_int32(), ==, 1234);
+
+    thrd_sleep_ms(200);
+    BTASSERTI(nvm_read_int32(), ==, 8);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_reset, "test_reset" },
+        { test_read_write_by_name, "test_read_write_by_name" },
+        { test_commit, "test_commit" },
+        { test_out_of_range, "test_out_of_range" },
+        { test_committer, "test_committer" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
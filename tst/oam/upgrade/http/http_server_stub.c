@@ -105,6 +105,12 @@ int http_server_response_write(struct http_server_connection_t *connection_p,
         BTASSERT(response_p->content.size == 23);
         break;
 
+    case 3:
+        BTASSERT(response_p->code == http_server_response_code_200_ok_t);
+        BTASSERT(strcmp(response_p->content.buf_p,
+                        "write successful") == 0);
+        break;
+
     default:
         return (-1);
     }
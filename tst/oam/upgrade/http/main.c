@@ -34,6 +34,9 @@ extern int http_server_stub_request(const char *path_p,
                                     struct http_server_connection_t *connection_p,
                                     struct http_server_request_t *request_p);
 
+extern char upgrade_stub_binary[];
+extern size_t upgrade_stub_binary_size;
+
 static int test_init(struct harness_t *self_p)
 {
     BTASSERT(upgrade_http_init(80) == 0);
@@ -103,6 +106,50 @@ static int test_request_bootloader_enter(struct harness_t *self_p)
     return (0);
 }
 
+static int test_request_upload(struct harness_t *self_p)
+{
+    struct http_server_connection_t connection;
+    struct http_server_request_t request;
+    struct queue_t queue;
+    char queue_buf[64];
+    struct chan_reader_t reader;
+    char reader_buf[32];
+    char *line_p;
+
+    /* The last header line and the start of the body are received
+       in one segment. The HTTP server reads the headers through a
+       reader, leaving the start of the body in the reader buffer. */
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(queue_write(&queue, "Content-Length: 10\r\n\r\n0123", 26) == 26);
+    BTASSERT(chan_reader_init(&reader,
+                              &queue,
+                              &reader_buf[0],
+                              sizeof(reader_buf)) == 0);
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 20);
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 2);
+    BTASSERT(chan_reader_buffered(&reader) == 4);
+
+    /* The rest of the body. */
+    BTASSERT(queue_write(&queue, "456789", 6) == 6);
+
+    connection.chan_p = &reader;
+    request.action = http_server_request_action_post_t;
+    request.headers.content_type.present = 1;
+    strcpy(&request.headers.content_type.value[0],
+           "application/octet-stream");
+    request.headers.content_length.present = 1;
+    request.headers.content_length.value = 10;
+    request.headers.expect.present = 0;
+
+    BTASSERT(http_server_stub_request("/oam/upgrade/upload",
+                                      &connection,
+                                      &request) == 0);
+    BTASSERTI(upgrade_stub_binary_size, ==, 10);
+    BTASSERTM(&upgrade_stub_binary[0], "0123456789", 10);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_t harness;
@@ -110,6 +157,7 @@ int main()
         { test_init, "test_init" },
         { test_request_application_enter, "test_request_application_enter" },
         { test_request_bootloader_enter, "test_request_bootloader_enter" },
+        { test_request_upload, "test_request_upload" },
         { NULL, NULL }
     };
 
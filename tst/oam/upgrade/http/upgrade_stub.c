@@ -86,18 +86,31 @@ int upgrade_application_is_valid(int quick)
     return (-1);
 }
 
+/* Uploaded binary. */
+char upgrade_stub_binary[32];
+size_t upgrade_stub_binary_size;
+
 int upgrade_binary_upload_begin()
 {
-    return (-1);
+    upgrade_stub_binary_size = 0;
+
+    return (0);
 }
 
 int upgrade_binary_upload(const void *buf_p,
                           size_t size)
 {
-    return (-1);
+    if (upgrade_stub_binary_size + size > sizeof(upgrade_stub_binary)) {
+        return (-1);
+    }
+
+    memcpy(&upgrade_stub_binary[upgrade_stub_binary_size], buf_p, size);
+    upgrade_stub_binary_size += size;
+
+    return (0);
 }
 
 int upgrade_binary_upload_end()
 {
-    return (-1);
+    return (0);
 }
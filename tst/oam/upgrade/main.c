@@ -30,6 +30,133 @@
 
 #include "simba.h"
 
+#define LZ_DATA                                         \
+    "Simba upgrade file data. "                         \
+    "Simba upgrade file data. "                         \
+    "Simba upgrade file data. "                         \
+    "Simba upgrade file data. "                         \
+    "The end."
+
+/* bin/upgrade.py -e lz -w 8 -d foo, of LZ_DATA. */
+static const uint8_t lz_ubin[] = {
+    0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x6c,
+    0xdd, 0x8e, 0x7d, 0x62, 0xb6, 0xd6, 0x82, 0x12, 0x1a, 0x01, 0xc9, 0x2f,
+    0x07, 0xc8, 0x22, 0xf1, 0x65, 0x1b, 0x87, 0x1e, 0x01, 0x08, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xda, 0x39, 0xa3, 0xee, 0x5e, 0x6b, 0x4b, 0x0d,
+    0x32, 0x55, 0xbf, 0xef, 0x95, 0x60, 0x18, 0x90, 0xaf, 0xd8, 0x07, 0x09,
+    0x66, 0x6f, 0x6f, 0x00, 0x08, 0x6b, 0x48, 0x45, 0xff, 0x53, 0x69, 0x6d,
+    0x62, 0x61, 0x20, 0x75, 0x70, 0xff, 0x67, 0x72, 0x61, 0x64, 0x65, 0x20,
+    0x66, 0x69, 0xff, 0x6c, 0x65, 0x20, 0x64, 0x61, 0x74, 0x61, 0x2e, 0xfd,
+    0x20, 0x18, 0x48, 0x54, 0x68, 0x65, 0x20, 0x65, 0x6e, 0x03, 0x64, 0x2e
+};
+/* bin/upgrade.py -d foo, of base_create(). */
+static const uint8_t base_ubin[] = {
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0xc8,
+    0x60, 0x71, 0xe0, 0x33, 0x8c, 0x68, 0xd8, 0xfb, 0xc6, 0xce, 0x92, 0xfe,
+    0x6b, 0xa2, 0x08, 0xfe, 0xa2, 0xb6, 0x8c, 0xf1, 0x66, 0x6f, 0x6f, 0x00,
+    0x74, 0xa2, 0x21, 0x7e, 0x00, 0x07, 0x0e, 0x15, 0x1c, 0x23, 0x2a, 0x31,
+    0x38, 0x3f, 0x46, 0x4d, 0x54, 0x5b, 0x62, 0x69, 0x70, 0x77, 0x7e, 0x85,
+    0x8c, 0x93, 0x9a, 0xa1, 0xa8, 0xaf, 0xb6, 0xbd, 0xc4, 0xcb, 0xd2, 0xd9,
+    0xe0, 0xe7, 0xee, 0xf5, 0xfc, 0x03, 0x0a, 0x11, 0x18, 0x1f, 0x26, 0x2d,
+    0x34, 0x3b, 0x42, 0x49, 0x50, 0x57, 0x5e, 0x65, 0x6c, 0x73, 0x7a, 0x81,
+    0x88, 0x8f, 0x96, 0x9d, 0xa4, 0xab, 0xb2, 0xb9, 0xc0, 0xc7, 0xce, 0xd5,
+    0xdc, 0xe3, 0xea, 0xf1, 0xf8, 0xff, 0x06, 0x0d, 0x14, 0x1b, 0x22, 0x29,
+    0x30, 0x37, 0x3e, 0x45, 0x4c, 0x53, 0x5a, 0x61, 0x68, 0x6f, 0x76, 0x7d,
+    0x84, 0x8b, 0x92, 0x99, 0xa0, 0xa7, 0xae, 0xb5, 0xbc, 0xc3, 0xca, 0xd1,
+    0xd8, 0xdf, 0xe6, 0xed, 0xf4, 0xfb, 0x02, 0x09, 0x10, 0x17, 0x1e, 0x25,
+    0x2c, 0x33, 0x3a, 0x41, 0x48, 0x4f, 0x56, 0x5d, 0x64, 0x6b, 0x72, 0x79,
+    0x80, 0x87, 0x8e, 0x95, 0x9c, 0xa3, 0xaa, 0xb1, 0xb8, 0xbf, 0xc6, 0xcd,
+    0xd4, 0xdb, 0xe2, 0xe9, 0xf0, 0xf7, 0xfe, 0x05, 0x0c, 0x13, 0x1a, 0x21,
+    0x28, 0x2f, 0x36, 0x3d, 0x44, 0x4b, 0x52, 0x59, 0x60, 0x67, 0x6e, 0x75,
+    0x7c, 0x83, 0x8a, 0x91, 0x98, 0x9f, 0xa6, 0xad, 0xb4, 0xbb, 0xc2, 0xc9,
+    0xd0, 0xd7, 0xde, 0xe5, 0xec, 0xf3, 0xfa, 0x01, 0x08, 0x0f, 0x16, 0x1d,
+    0x24, 0x2b, 0x32, 0x39, 0x40, 0x47, 0x4e, 0x55, 0x5c, 0x63, 0x6a, 0x71
+};
+/* bin/upgrade.py -e delta-lz -w 8 -d foo -b <base>, of
+   delta_create(). */
+static const uint8_t delta_ubin[] = {
+    0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x01, 0x04,
+    0x08, 0x1b, 0x2e, 0x33, 0x2d, 0x70, 0xcf, 0xbd, 0xa0, 0xc0, 0x68, 0x33,
+    0x21, 0x59, 0xed, 0x3a, 0xab, 0xd5, 0xc4, 0x85, 0x03, 0x08, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xc8, 0x60, 0x71, 0xe0, 0x33, 0x8c, 0x68, 0xd8, 0xfb,
+    0xc6, 0xce, 0x92, 0xfe, 0x6b, 0xa2, 0x08, 0xfe, 0xa2, 0xb6, 0x8c, 0xf1,
+    0x66, 0x6f, 0x6f, 0x00, 0x85, 0x17, 0x16, 0xc2, 0xff, 0x00, 0x14, 0x02,
+    0x08, 0x69, 0x6e, 0x73, 0x65, 0xff, 0x72, 0x74, 0x65, 0x64, 0x00, 0x7a,
+    0x01, 0x01, 0xff, 0x10, 0x00, 0x39, 0x03, 0x8f, 0x03, 0x00, 0x10, 0xff,
+    0x02, 0x24, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x07, 0x65, 0x64, 0x20,
+    0x08, 0x18
+};
+static uint8_t buf[512];
+
+/**
+ * Read the installed application, excluding the trailing SHA1 and
+ * size.
+ */
+static ssize_t application_read(void)
+{
+    FILE *file_p;
+    size_t size;
+
+    file_p = fopen("upgrade_application.bin", "rb");
+
+    if (file_p == NULL) {
+        return (-1);
+    }
+
+    size = fread(&buf[0], 1, sizeof(buf), file_p);
+    fclose(file_p);
+
+    return (size - 24);
+}
+
+static void base_create(uint8_t *dst_p)
+{
+    int i;
+
+    for (i = 0; i < 200; i++) {
+        dst_p[i] = (7 * i);
+    }
+}
+
+/**
+ * The base with inserted, modified, moved and appended data.
+ */
+static void delta_create(uint8_t *dst_p)
+{
+    uint8_t base[200];
+
+    base_create(&base[0]);
+    memcpy(&dst_p[0], &base[0], 20);
+    memcpy(&dst_p[20], "inserted", 8);
+    memcpy(&dst_p[28], &base[20], 180);
+    dst_p[150] ^= 0x10;
+    memcpy(&dst_p[208], &base[0], 16);
+    memcpy(&dst_p[224], "appended appended appended appended ", 36);
+}
+
+/**
+ * Upload given upgrade binary file in chunks of given size.
+ */
+static int upload(const uint8_t *ubin_p, size_t size, size_t chunk_size)
+{
+    size_t offset;
+
+    if (upgrade_binary_upload_begin() != 0) {
+        return (-1);
+    }
+
+    for (offset = 0; offset < size; offset += chunk_size) {
+        if (upgrade_binary_upload(&ubin_p[offset],
+                                  MIN(chunk_size, size - offset)) != 0) {
+            upgrade_binary_upload_end();
+
+            return (-1);
+        }
+    }
+
+    return (upgrade_binary_upload_end());
+}
+
 static int test_bootloader(struct harness_t *self_p)
 {
     BTASSERT(upgrade_bootloader_enter() == -1);
@@ -42,6 +169,37 @@ static int test_bootloader(struct harness_t *self_p)
 }
 
 static int test_binary_upload(struct harness_t *self_p)
+{
+    uint8_t header_data_size_2[64] = {
+        /* Version. */
+        0, 0, 0, 1,
+        /* Header size. */
+        0, 0, 0, 40,
+        /* Data size. */
+        0, 0, 0, 2,
+        /* Data SHA1. */
+        0xda, 0x23, 0x61, 0x4e, 0x02, 0x46, 0x9a, 0x0d,
+        0x7c, 0x7b, 0xd1, 0xbd, 0xab, 0x5c, 0x9c, 0x47,
+        0x4b, 0x19, 0x04, 0xdc,
+        /* Data description. */
+        'f', 'o', 'o', '\0',
+        /* Header CRC. */
+        0xba, 0x9e, 0x1d, 0x80,
+        /* Data. */
+        'a', 'b'
+    };
+
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 42) == 0);
+    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+    BTASSERT(application_read() == 2);
+    BTASSERT(memcmp(&buf[0], "ab", 2) == 0);
+
+    return (0);
+}
+
+static int test_binary_upload_bad_sha1(struct harness_t *self_p)
 {
     uint8_t header_data_size_2[64] = {
         /* Version. */
@@ -64,7 +222,55 @@ static int test_binary_upload(struct harness_t *self_p)
 
     BTASSERT(upgrade_binary_upload_begin() == 0);
     BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 42) == 0);
-    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    return (0);
+}
+
+static int test_binary_upload_lz(struct harness_t *self_p)
+{
+    BTASSERT(upgrade_application_erase() == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 0);
+
+    /* Streamed one byte at a time. */
+    BTASSERT(upload(&lz_ubin[0], sizeof(lz_ubin), 1) == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+    BTASSERT(application_read() == (ssize_t)sizeof(LZ_DATA) - 1);
+    BTASSERT(memcmp(&buf[0], LZ_DATA, sizeof(LZ_DATA) - 1) == 0);
+
+    return (0);
+}
+
+static int test_binary_upload_delta(struct harness_t *self_p)
+{
+    uint8_t expected[260];
+
+    /* Install the base. */
+    BTASSERT(upload(&base_ubin[0], sizeof(base_ubin), 64) == 0);
+    base_create(&expected[0]);
+    BTASSERT(application_read() == 200);
+    BTASSERT(memcmp(&buf[0], &expected[0], 200) == 0);
+
+    /* Upgrade it using a delta. */
+    BTASSERT(upload(&delta_ubin[0], sizeof(delta_ubin), 7) == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+    delta_create(&expected[0]);
+    BTASSERT(application_read() == 260);
+    BTASSERT(memcmp(&buf[0], &expected[0], 260) == 0);
+
+    return (0);
+}
+
+static int test_binary_upload_delta_bad_base(struct harness_t *self_p)
+{
+    /* The installed application is not the delta base. */
+    BTASSERT(upload(&delta_ubin[0], sizeof(delta_ubin), 64) == -1);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    /* No application installed. */
+    BTASSERT(upgrade_application_erase() == 0);
+    BTASSERT(upload(&delta_ubin[0], sizeof(delta_ubin), 64) == -1);
+    BTASSERT(upgrade_application_is_valid(0) == 0);
 
     return (0);
 }
@@ -73,7 +279,7 @@ static int test_binary_upload_bad_version(struct harness_t *self_p)
 {
     uint8_t buf[42] = {
         /* Version. */
-        0, 0, 0, 2,
+        0, 0, 0, 3,
         /* Header size. */
         0, 0, 0, 40,
         /* Data size. */
@@ -85,7 +291,7 @@ static int test_binary_upload_bad_version(struct harness_t *self_p)
         /* Data description. */
         'f', 'o', 'o', '\0',
         /* Header CRC. */
-        0x91, 0x9e, 0x50, 0x12,
+        0xfc, 0x7b, 0x71, 0xf4,
         /* Data. */
         'a', 'b'
     };
@@ -177,16 +383,158 @@ static int test_binary_upload_long_header(struct harness_t *self_p)
     return (0);
 }
 
+#define UBIN_HEADER_SIZE                                   40
+#define UBIN_CHUNK_SIZE                                  1024
+
+static uint8_t ubin[UBIN_HEADER_SIZE + CONFIG_FLASH_LINUX_DEVICE_SIZE + 1];
+static uint8_t programmer_buf[2 * UBIN_CHUNK_SIZE];
+static THRD_STACK(programmer_stack, 2048);
+
+static void write_u32(uint8_t *dst_p, uint32_t value)
+{
+    dst_p[0] = (value >> 24);
+    dst_p[1] = (value >> 16);
+    dst_p[2] = (value >> 8);
+    dst_p[3] = value;
+}
+
+/**
+ * Create an upgrade binary file with given data size.
+ */
+static size_t ubin_create(size_t size)
+{
+    struct sha1_t sha1;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        ubin[UBIN_HEADER_SIZE + i] = i;
+    }
+
+    write_u32(&ubin[0], 1);
+    write_u32(&ubin[4], UBIN_HEADER_SIZE);
+    write_u32(&ubin[8], size);
+    sha1_init(&sha1);
+    sha1_update(&sha1, &ubin[UBIN_HEADER_SIZE], size);
+    sha1_digest(&sha1, &ubin[12]);
+    memcpy(&ubin[32], "foo", 4);
+    write_u32(&ubin[36], crc_32(0, &ubin[0], 36));
+
+    return (UBIN_HEADER_SIZE + size);
+}
+
+/**
+ * Upload given upgrade binary file in chunks, where each chunk takes
+ * 20 ms to transfer, and return the upload time in milliseconds.
+ */
+static int upload_timed(size_t size, unsigned long *time_ms_p)
+{
+    struct time_t start;
+    struct time_t stop;
+    size_t offset;
+
+    time_get(&start);
+
+    if (upgrade_binary_upload_begin() != 0) {
+        return (-1);
+    }
+
+    for (offset = 0; offset < size; offset += UBIN_CHUNK_SIZE) {
+        thrd_sleep_ms(20);
+
+        if (upgrade_binary_upload(&ubin[offset],
+                                  MIN(UBIN_CHUNK_SIZE, size - offset)) != 0) {
+            upgrade_binary_upload_end();
+
+            return (-1);
+        }
+    }
+
+    if (upgrade_binary_upload_end() != 0) {
+        return (-1);
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    *time_ms_p = (stop.seconds * 1000 + stop.nanoseconds / 1000000);
+
+    return (0);
+}
+
+static int test_binary_upload_programmer(struct harness_t *self_p)
+{
+    size_t size;
+    unsigned long sync_ms;
+    unsigned long overlapped_ms;
+
+    size = ubin_create(8 * UBIN_CHUNK_SIZE);
+
+    /* Program each chunk before the next is transferred. */
+    BTASSERT(upgrade_application_erase() == 0);
+    BTASSERT(upload_timed(size, &sync_ms) == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    /* Program chunks while the next chunk is transferred. */
+    BTASSERT(upgrade_start_programmer(&programmer_buf[0],
+                                      sizeof(programmer_buf),
+                                      programmer_stack,
+                                      sizeof(programmer_stack)) == 0);
+    BTASSERT(upgrade_start_programmer(&programmer_buf[0],
+                                      sizeof(programmer_buf),
+                                      programmer_stack,
+                                      sizeof(programmer_stack)) == -EALREADY);
+    BTASSERT(upgrade_application_erase() == 0);
+    BTASSERT(upload_timed(size, &overlapped_ms) == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    std_printf(OSTR("Upload time of %u bytes: "
+                    "synchronous %lu ms, overlapped %lu ms\r\n"),
+               size,
+               sync_ms,
+               overlapped_ms);
+
+    BTASSERT(4 * overlapped_ms < 3 * sync_ms);
+
+    /* A bad SHA1 is detected once all data is programmed. */
+    ubin[UBIN_HEADER_SIZE + 100] ^= 1;
+    BTASSERT(upload(&ubin[0], size, UBIN_CHUNK_SIZE) == -1);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    return (0);
+}
+
+static int test_binary_upload_too_big(struct harness_t *self_p)
+{
+    size_t size;
+
+    /* The data does not fit in the flash device. */
+    size = ubin_create(CONFIG_FLASH_LINUX_DEVICE_SIZE + 1);
+    BTASSERT(upload(&ubin[0], size, UBIN_CHUNK_SIZE) == -1);
+
+    /* The largest possible data. */
+    size = ubin_create(CONFIG_FLASH_LINUX_DEVICE_SIZE);
+    BTASSERT(upload(&ubin[0], size, UBIN_CHUNK_SIZE) == 0);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_t harness;
     struct harness_testcase_t harness_testcases[] = {
         { test_bootloader, "test_bootloader" },
         { test_binary_upload, "test_binary_upload" },
+        { test_binary_upload_bad_sha1, "test_binary_upload_bad_sha1" },
+        { test_binary_upload_lz, "test_binary_upload_lz" },
+        { test_binary_upload_delta, "test_binary_upload_delta" },
+        { test_binary_upload_delta_bad_base,
+          "test_binary_upload_delta_bad_base" },
         { test_binary_upload_bad_version, "test_binary_upload_bad_version" },
         { test_binary_upload_bad_crc, "test_binary_upload_bad_crc" },
         { test_binary_upload_short_header, "test_binary_upload_short_header" },
         { test_binary_upload_long_header, "test_binary_upload_long_header" },
+        { test_binary_upload_programmer, "test_binary_upload_programmer" },
+        { test_binary_upload_too_big, "test_binary_upload_too_big" },
         { NULL, NULL }
     };
 
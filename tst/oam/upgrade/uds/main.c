@@ -588,6 +588,261 @@ static int test_request_transfer_exit(struct harness_t *self_p)
     return (0);
 }
 
+/* Size of the upgrade binary file transferred in the overlapped
+   programming tests. */
+#define UBIN_BLOCK_SIZE                          1024
+#define UBIN_BLOCKS                                16
+#define UBIN_HEADER_SIZE                           40
+
+static uint8_t ubin[UBIN_BLOCKS * UBIN_BLOCK_SIZE];
+static uint8_t programmer_buf[2 * UBIN_BLOCK_SIZE];
+static THRD_STACK(programmer_stack, 2048);
+static THRD_STACK(tester_0_stack, 2048);
+static THRD_STACK(tester_1_stack, 2048);
+static struct upgrade_uds_t overlapped_uds;
+static struct queue_t tester_qin;
+static struct queue_t tester_qout;
+static uint8_t tester_inbuf[UBIN_BLOCK_SIZE + 64];
+static uint8_t tester_outbuf[64];
+
+static void write_u32(uint8_t *dst_p, uint32_t value)
+{
+    dst_p[0] = (value >> 24);
+    dst_p[1] = (value >> 16);
+    dst_p[2] = (value >> 8);
+    dst_p[3] = value;
+}
+
+/**
+ * Create an upgrade binary file.
+ */
+static void ubin_create(void)
+{
+    struct sha1_t sha1;
+    size_t i;
+
+    for (i = UBIN_HEADER_SIZE; i < sizeof(ubin); i++) {
+        ubin[i] = i;
+    }
+
+    write_u32(&ubin[0], 1);
+    write_u32(&ubin[4], UBIN_HEADER_SIZE);
+    write_u32(&ubin[8], sizeof(ubin) - UBIN_HEADER_SIZE);
+    sha1_init(&sha1);
+    sha1_update(&sha1,
+                &ubin[UBIN_HEADER_SIZE],
+                sizeof(ubin) - UBIN_HEADER_SIZE);
+    sha1_digest(&sha1, &ubin[12]);
+    memcpy(&ubin[32], "foo", 4);
+    write_u32(&ubin[36], crc_32(0, &ubin[0], 36));
+}
+
+static void write_request_download(void *chan_p)
+{
+    uint8_t request[] = {
+        0, 0, 0, 12, 0x34,
+        0x00,
+        0x04, 0x04,
+        0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x40, 0x00
+    };
+
+    chan_write(chan_p, &request[0], sizeof(request));
+}
+
+static void write_transfer_data(void *chan_p,
+                                uint8_t block_sequence_counter,
+                                const uint8_t *buf_p,
+                                size_t size)
+{
+    uint8_t header[6];
+
+    write_u32(&header[0], size + 2);
+    header[4] = 0x36;
+    header[5] = block_sequence_counter;
+    chan_write(chan_p, &header[0], sizeof(header));
+    chan_write(chan_p, buf_p, size);
+}
+
+static void write_request_transfer_exit(void *chan_p)
+{
+    uint8_t request[] = {
+        0, 0, 0, 1, 0x37
+    };
+
+    chan_write(chan_p, &request[0], sizeof(request));
+}
+
+/**
+ * A tester transferring the upgrade binary file in blocks. Each block
+ * takes 20 ms to transfer on the bus.
+ */
+static void *tester_main(void *arg_p)
+{
+    uint8_t response[10];
+    int i;
+
+    write_request_download(&tester_qin);
+    queue_read(&tester_qout, &response[0], 10);
+
+    for (i = 0; i < UBIN_BLOCKS; i++) {
+        thrd_sleep_ms(20);
+        write_transfer_data(&tester_qin,
+                            i + 1,
+                            &ubin[i * UBIN_BLOCK_SIZE],
+                            UBIN_BLOCK_SIZE);
+        queue_read(&tester_qout, &response[0], 6);
+    }
+
+    write_request_transfer_exit(&tester_qin);
+    queue_read(&tester_qout, &response[0], 5);
+
+    return (NULL);
+}
+
+static int transfer(struct upgrade_uds_t *uds_p, void *stack_p)
+{
+    int i;
+
+    BTASSERT(thrd_spawn(tester_main,
+                        NULL,
+                        0,
+                        stack_p,
+                        sizeof(tester_0_stack)) != NULL);
+
+    for (i = 0; i < UBIN_BLOCKS + 2; i++) {
+        BTASSERT(upgrade_uds_handle_service(uds_p) == 0);
+    }
+
+    return (0);
+}
+
+static int test_transfer_time(struct harness_t *self_p)
+{
+    struct time_t start;
+    struct time_t stop;
+    struct time_t sync;
+    struct time_t overlapped;
+
+    queue_init(&tester_qin, &tester_inbuf[0], sizeof(tester_inbuf));
+    queue_init(&tester_qout, &tester_outbuf[0], sizeof(tester_outbuf));
+    BTASSERT(upgrade_uds_init(&overlapped_uds,
+                              &tester_qin,
+                              &tester_qout) == 0);
+    ubin_create();
+
+    /* Program each block before responding. */
+    time_get(&start);
+    BTASSERT(transfer(&overlapped_uds, tester_0_stack) == 0);
+    time_get(&stop);
+    time_subtract(&sync, &stop, &start);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    /* Program blocks while the next block is transferred. */
+    BTASSERT(upgrade_start_programmer(&programmer_buf[0],
+                                      sizeof(programmer_buf),
+                                      programmer_stack,
+                                      sizeof(programmer_stack)) == 0);
+    time_get(&start);
+    BTASSERT(transfer(&overlapped_uds, tester_1_stack) == 0);
+    time_get(&stop);
+    time_subtract(&overlapped, &stop, &start);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    std_printf(OSTR("Transfer time of %d blocks of %d bytes: "
+                    "synchronous %lu ms, overlapped %lu ms\r\n"),
+               UBIN_BLOCKS,
+               UBIN_BLOCK_SIZE,
+               sync.seconds * 1000 + sync.nanoseconds / 1000000,
+               overlapped.seconds * 1000 + overlapped.nanoseconds / 1000000);
+
+    BTASSERT(4 * (overlapped.seconds * 1000
+                  + overlapped.nanoseconds / 1000000)
+             < 3 * (sync.seconds * 1000 + sync.nanoseconds / 1000000));
+
+    return (0);
+}
+
+static int test_transfer_data_overlapped(struct harness_t *self_p)
+{
+    int32_t length;
+    uint8_t response[7];
+    uint32_t max_size;
+    int i;
+
+    ubin_create();
+
+    write_request_download(&tester_qin);
+    BTASSERT(upgrade_uds_handle_service(&overlapped_uds) == 0);
+    BTASSERT(queue_read(&tester_qout,
+                        &length,
+                        sizeof(length)) == sizeof(length));
+    BTASSERT(ntohl(length) == 6);
+    BTASSERT(queue_read(&tester_qout, &response[0], 2) == 2);
+    BTASSERT(response[0] == 0x74);
+    BTASSERT(response[1] == 0x40);
+    BTASSERT(queue_read(&tester_qout,
+                        &max_size,
+                        sizeof(max_size)) == sizeof(max_size));
+    BTASSERT(ntohl(max_size) == 4096);
+
+    for (i = 0; i < UBIN_BLOCKS; i++) {
+        write_transfer_data(&tester_qin,
+                            i + 1,
+                            &ubin[i * UBIN_BLOCK_SIZE],
+                            UBIN_BLOCK_SIZE);
+        BTASSERT(upgrade_uds_handle_service(&overlapped_uds) == 0);
+        BTASSERT(queue_read(&tester_qout, &response[0], 6) == 6);
+        BTASSERT(response[4] == 0x76);
+        BTASSERT(response[5] == i + 1);
+    }
+
+    /* The exit response is sent once all blocks are programmed. */
+    write_request_transfer_exit(&tester_qin);
+    BTASSERT(upgrade_uds_handle_service(&overlapped_uds) == 0);
+    BTASSERT(queue_read(&tester_qout, &response[0], 5) == 5);
+    BTASSERT(response[4] == 0x77);
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    return (0);
+}
+
+static int test_transfer_data_overlapped_failure(struct harness_t *self_p)
+{
+    uint8_t response[10];
+    int i;
+
+    ubin_create();
+    ubin[UBIN_HEADER_SIZE] ^= 1;
+
+    write_request_download(&tester_qin);
+    BTASSERT(upgrade_uds_handle_service(&overlapped_uds) == 0);
+    BTASSERT(queue_read(&tester_qout, &response[0], 10) == 10);
+
+    for (i = 0; i < UBIN_BLOCKS; i++) {
+        write_transfer_data(&tester_qin,
+                            i + 1,
+                            &ubin[i * UBIN_BLOCK_SIZE],
+                            UBIN_BLOCK_SIZE);
+        BTASSERT(upgrade_uds_handle_service(&overlapped_uds) == 0);
+        BTASSERT(queue_read(&tester_qout, &response[0], 6) == 6);
+        BTASSERT(response[4] == 0x76);
+    }
+
+    /* The bad SHA1 is detected once all data has been programmed. */
+    write_request_transfer_exit(&tester_qin);
+    BTASSERT(upgrade_uds_handle_service(&overlapped_uds) == -1);
+    BTASSERT(queue_read(&tester_qout, &response[0], 7) == 7);
+    BTASSERT(response[4] == 0x7f);
+    BTASSERT(response[5] == 0x37);
+    BTASSERT(response[6] == 0x72);
+
+    /* The installed application is kept. */
+    BTASSERT(upgrade_application_is_valid(0) == 1);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_t harness;
@@ -601,6 +856,10 @@ int main()
         { test_request_download, "test_request_download" },
         { test_transfer_data, "test_transfer_data" },
         { test_request_transfer_exit, "test_request_transfer_exit" },
+        { test_transfer_time, "test_transfer_time" },
+        { test_transfer_data_overlapped, "test_transfer_data_overlapped" },
+        { test_transfer_data_overlapped_failure,
+          "test_transfer_data_overlapped_failure" },
         { NULL, NULL }
     };
 
@@ -199,6 +199,61 @@ int __attribute__ ((weak)) STUB(upgrade_application_is_valid)(int quick)
     return (res);
 }
 
+int mock_write_upgrade_start_programmer(void *buf_p,
+                                        size_t size,
+                                        void *stack_p,
+                                        size_t stack_size,
+                                        int res)
+{
+    harness_mock_write("upgrade_start_programmer(buf_p)",
+                       buf_p,
+                       size);
+
+    harness_mock_write("upgrade_start_programmer(size)",
+                       &size,
+                       sizeof(size));
+
+    harness_mock_write("upgrade_start_programmer(stack_p)",
+                       stack_p,
+                       stack_size);
+
+    harness_mock_write("upgrade_start_programmer(stack_size)",
+                       &stack_size,
+                       sizeof(stack_size));
+
+    harness_mock_write("upgrade_start_programmer(): return (res)",
+                       &res,
+                       sizeof(res));
+
+    return (0);
+}
+
+int __attribute__ ((weak)) STUB(upgrade_start_programmer)(void *buf_p,
+                                                          size_t size,
+                                                          void *stack_p,
+                                                          size_t stack_size)
+{
+    int res;
+
+    harness_mock_assert("upgrade_start_programmer(buf_p)",
+                        buf_p);
+
+    harness_mock_assert("upgrade_start_programmer(size)",
+                        &size);
+
+    harness_mock_assert("upgrade_start_programmer(stack_p)",
+                        stack_p);
+
+    harness_mock_assert("upgrade_start_programmer(stack_size)",
+                        &stack_size);
+
+    harness_mock_read("upgrade_start_programmer(): return (res)",
+                      &res,
+                      sizeof(res));
+
+    return (res);
+}
+
 int mock_write_upgrade_binary_upload_begin(int res)
 {
     harness_mock_write("upgrade_binary_upload_begin(): return (res)",
@@ -50,6 +50,12 @@ int mock_write_upgrade_application_erase(int res);
 int mock_write_upgrade_application_is_valid(int quick,
                                             int res);
 
+int mock_write_upgrade_start_programmer(void *buf_p,
+                                        size_t size,
+                                        void *stack_p,
+                                        size_t stack_size,
+                                        int res);
+
 int mock_write_upgrade_binary_upload_begin(int res);
 
 int mock_write_upgrade_binary_upload(const void *buf_p,
@@ -33,6 +33,25 @@
 #define ID_FOO 0x0
 #define ID_BAR 0x1
 
+static THRD_STACK(writer_stack, 1024);
+static struct bus_t writer_bus;
+static int writer_res;
+
+static void *writer_main(void *arg_p)
+{
+    uint32_t values[2];
+
+    values[0] = 1;
+    values[1] = 2;
+
+    /* Blocks until the listener queue has been read. */
+    writer_res = bus_write(&writer_bus, ID_FOO, &values[0], sizeof(values));
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
 static int test_init(struct harness_t *harness)
 {
     /* This function may be called multiple times. */
@@ -165,6 +184,182 @@ static int test_multiple_ids(struct harness_t *harness)
     return (0);
 }
 
+static int test_snapshot(struct harness_t *harness)
+{
+    struct bus_t bus;
+    struct bus_listener_t chans[4];
+    struct queue_t queues[3];
+    struct event_t event;
+    char bufs[3][32];
+    void *snapshot_buf[6];
+    int foo;
+    int value;
+    uint32_t bar, mask;
+
+    BTASSERT(bus_init(&bus) == 0);
+    BTASSERT(bus_set_snapshot_buffer(&bus,
+                                     &snapshot_buf[0],
+                                     sizeof(snapshot_buf)) == 0);
+    BTASSERT(queue_init(&queues[0], bufs[0], sizeof(bufs[0])) == 0);
+    BTASSERT(queue_init(&queues[1], bufs[1], sizeof(bufs[1])) == 0);
+    BTASSERT(queue_init(&queues[2], bufs[2], sizeof(bufs[2])) == 0);
+    BTASSERT(event_init(&event) == 0);
+    BTASSERT(bus_listener_init(&chans[0], ID_FOO, &queues[0]) == 0);
+    BTASSERT(bus_listener_init(&chans[1], ID_BAR, &event) == 0);
+    BTASSERT(bus_listener_init(&chans[2], ID_FOO, &queues[1]) == 0);
+    BTASSERT(bus_listener_init(&chans[3], -1, &queues[2]) == 0);
+
+    /* No receiver is attached. */
+    foo = 5;
+    BTASSERT(bus_write(&bus, ID_FOO, &foo, sizeof(foo)) == 0);
+
+    /* Attach three listeners. The snapshot buffer is full. */
+    BTASSERT(bus_attach(&bus, &chans[0]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[1]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[2]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[3]) == -ENOMEM);
+
+    /* Snapshots can not be enabled with listeners attached. */
+    BTASSERT(bus_set_snapshot_buffer(&bus,
+                                     &snapshot_buf[0],
+                                     sizeof(snapshot_buf)) == -EBUSY);
+
+    /* Both foo listeners receive the message. */
+    BTASSERT(bus_write(&bus, ID_FOO, &foo, sizeof(foo)) == 2);
+    value = 0;
+    BTASSERT(queue_read(&queues[0], &value, sizeof(value)) == sizeof(value));
+    BTASSERT(value == 5);
+    value = 0;
+    BTASSERT(queue_read(&queues[1], &value, sizeof(value)) == sizeof(value));
+    BTASSERT(value == 5);
+
+    bar = 0x80;
+    BTASSERT(bus_write(&bus, ID_BAR, &bar, sizeof(bar)) == 1);
+    mask = 0xffffffff;
+    BTASSERT(event_read(&event, &mask, sizeof(mask)) == sizeof(mask));
+    BTASSERT(mask == 0x80);
+
+    /* Nobody listens for -1. */
+    BTASSERT(bus_write(&bus, -1, &foo, sizeof(foo)) == 0);
+
+    /* Detach a foo listener and attach the -1 listener. */
+    BTASSERT(bus_detatch(&bus, &chans[0]) == 0);
+    BTASSERT(bus_detatch(&bus, &chans[0]) == -1);
+    BTASSERT(bus_attach(&bus, &chans[3]) == 0);
+    BTASSERT(bus_write(&bus, ID_FOO, &foo, sizeof(foo)) == 1);
+    BTASSERT(queue_size(&queues[0]) == 0);
+    value = 0;
+    BTASSERT(queue_read(&queues[1], &value, sizeof(value)) == sizeof(value));
+    BTASSERT(value == 5);
+    BTASSERT(bus_write(&bus, -1, &foo, sizeof(foo)) == 1);
+    value = 0;
+    BTASSERT(queue_read(&queues[2], &value, sizeof(value)) == sizeof(value));
+    BTASSERT(value == 5);
+
+    /* Detach all listeners. */
+    BTASSERT(bus_detatch(&bus, &chans[3]) == 0);
+    BTASSERT(bus_detatch(&bus, &chans[1]) == 0);
+    BTASSERT(bus_detatch(&bus, &chans[2]) == 0);
+    BTASSERT(bus_write(&bus, ID_FOO, &foo, sizeof(foo)) == 0);
+
+    return (0);
+}
+
+static int test_snapshot_blocked_writer(struct harness_t *harness)
+{
+    struct bus_listener_t chans[2];
+    struct queue_t queue;
+    struct event_t event;
+    char buf[4];
+    void *snapshot_buf[4];
+    uint32_t values[2];
+    uint32_t mask;
+
+    BTASSERT(bus_init(&writer_bus) == 0);
+    BTASSERT(bus_set_snapshot_buffer(&writer_bus,
+                                     &snapshot_buf[0],
+                                     sizeof(snapshot_buf)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(event_init(&event) == 0);
+    BTASSERT(bus_listener_init(&chans[0], ID_FOO, &queue) == 0);
+    BTASSERT(bus_listener_init(&chans[1], ID_BAR, &event) == 0);
+    BTASSERT(bus_attach(&writer_bus, &chans[0]) == 0);
+
+    /* The writer blocks as the message does not fit in the queue. */
+    writer_res = -1;
+    BTASSERT(thrd_spawn(writer_main,
+                        NULL,
+                        -1,
+                        writer_stack,
+                        sizeof(writer_stack)) != NULL);
+    thrd_sleep_ms(10);
+    BTASSERT(writer_res == -1);
+
+    /* Attach and write while the writer is blocked. */
+    BTASSERT(bus_attach(&writer_bus, &chans[1]) == 0);
+    mask = 0x1;
+    BTASSERT(bus_write(&writer_bus, ID_BAR, &mask, sizeof(mask)) == 1);
+    mask = 0xffffffff;
+    BTASSERT(event_read(&event, &mask, sizeof(mask)) == sizeof(mask));
+    BTASSERT(mask == 0x1);
+
+    /* Unblock the writer. */
+    BTASSERT(queue_read(&queue, &values[0], sizeof(values))
+             == sizeof(values));
+    BTASSERT(values[0] == 1);
+    BTASSERT(values[1] == 2);
+
+    /* The writer has left the listener when detach returns. */
+    BTASSERT(bus_detatch(&writer_bus, &chans[0]) == 0);
+    BTASSERT(writer_res == 1);
+    BTASSERT(bus_detatch(&writer_bus, &chans[1]) == 0);
+
+    return (0);
+}
+
+static int test_non_blocking(struct harness_t *harness)
+{
+    struct bus_t bus;
+    struct bus_listener_t chans[2];
+    struct queue_t queues[2];
+    char bufs[2][9];
+    int foo;
+    int values[2];
+
+    BTASSERT(bus_init(&bus) == 0);
+    BTASSERT(bus_set_delivery(&bus, BUS_DELIVERY_NON_BLOCKING) == 0);
+    BTASSERT(queue_init(&queues[0], &bufs[0][0], 5) == 0);
+    BTASSERT(queue_init(&queues[1], &bufs[1][0], 9) == 0);
+    BTASSERT(bus_listener_init(&chans[0], ID_FOO, &queues[0]) == 0);
+    BTASSERT(bus_listener_init(&chans[1], ID_FOO, &queues[1]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[0]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[1]) == 0);
+
+    /* Both queues have room for the first message. */
+    foo = 1;
+    BTASSERT(bus_write(&bus, ID_FOO, &foo, sizeof(foo)) == 2);
+
+    /* The first queue is full. The message is dropped instead of
+       blocking the writer. */
+    foo = 2;
+    BTASSERT(bus_write(&bus, ID_FOO, &foo, sizeof(foo)) == 1);
+    BTASSERT(chans[0].dropped == 1);
+    BTASSERT(chans[1].dropped == 0);
+
+    BTASSERT(queue_read(&queues[0], &values[0], sizeof(foo))
+             == sizeof(foo));
+    BTASSERT(values[0] == 1);
+    BTASSERT(queue_read(&queues[1], &values[0], sizeof(values))
+             == sizeof(values));
+    BTASSERT(values[0] == 1);
+    BTASSERT(values[1] == 2);
+
+    BTASSERT(bus_detatch(&bus, &chans[0]) == 0);
+    BTASSERT(bus_detatch(&bus, &chans[1]) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_t harness;
@@ -173,6 +368,9 @@ int main()
         { test_attach_detach, "test_attach_detach" },
         { test_write_read, "test_write_read" },
         { test_multiple_ids, "test_multiple_ids" },
+        { test_snapshot, "test_snapshot" },
+        { test_snapshot_blocked_writer, "test_snapshot_blocked_writer" },
+        { test_non_blocking, "test_non_blocking" },
         { NULL, NULL }
     };
 
@@ -175,6 +175,73 @@ static int test_list(struct harness_t *harness_p)
     return (0);
 }
 
+static int test_list_poll(struct harness_t *harness_p)
+{
+    struct chan_list_t list;
+    void *workspace[3];
+    void *chans[3];
+    struct queue_t queues[3];
+    char bufs[3][4];
+    struct time_t timeout;
+    char value;
+    int i;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(queue_init(&queues[i], &bufs[i][0], sizeof(bufs[i])) == 0);
+    }
+
+    /* Data written before the channel is added is ready. */
+    value = 0;
+    BTASSERT(queue_write(&queues[0], &value, 1) == 1);
+
+    BTASSERT(chan_list_init(&list, &workspace[0], sizeof(workspace)) == 0);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(chan_list_add(&list, &queues[i]) == 0);
+    }
+
+    BTASSERT(chan_list_poll(&list, &timeout) == &queues[0]);
+
+    /* Level-triggered, ready until read empty. */
+    BTASSERT(chan_list_poll(&list, &timeout) == &queues[0]);
+    BTASSERT(queue_read(&queues[0], &value, 1) == 1);
+    BTASSERT(chan_list_poll(&list, &timeout) == NULL);
+
+    /* Ready channels in write order. */
+    BTASSERT(queue_write(&queues[2], &value, 1) == 1);
+    BTASSERT(queue_write(&queues[1], &value, 1) == 1);
+    BTASSERT(queue_write(&queues[2], &value, 1) == 1);
+    BTASSERT(chan_list_poll_many(&list, &chans[0], 3, &timeout) == 2);
+    BTASSERT(chans[0] == &queues[2]);
+    BTASSERT(chans[1] == &queues[1]);
+
+    /* A removed channel is no longer ready. */
+    BTASSERT(chan_list_remove(&list, &queues[2]) == 0);
+    BTASSERT(chan_list_poll_many(&list, &chans[0], 3, &timeout) == 1);
+    BTASSERT(chans[0] == &queues[1]);
+    BTASSERT(queue_read(&queues[1], &value, 1) == 1);
+    BTASSERT(queue_read(&queues[2], &value, 1) == 1);
+    BTASSERT(queue_read(&queues[2], &value, 1) == 1);
+    BTASSERT(chan_list_add(&list, &queues[2]) == 0);
+
+    /* Edge-triggered, ready once per write. */
+    BTASSERT(chan_list_set_mode(&list, CHAN_LIST_MODE_EDGE_TRIGGERED) == 0);
+    BTASSERT(queue_write(&queues[1], &value, 1) == 1);
+    BTASSERT(chan_list_poll(&list, &timeout) == &queues[1]);
+    BTASSERT(chan_list_poll(&list, &timeout) == NULL);
+    BTASSERT(queue_write(&queues[1], &value, 1) == 1);
+    BTASSERT(chan_list_poll(&list, &timeout) == &queues[1]);
+    BTASSERT(queue_size(&queues[1]) == 2);
+
+    BTASSERT(chan_list_destroy(&list) == 0);
+    BTASSERT(queues[1].base.list_p == NULL);
+
+    return (0);
+}
+
 static int test_getc(struct harness_t *harness_p)
 {
     struct chan_t chan;
@@ -284,6 +351,7 @@ int main()
         { test_filter, "test_filter" },
         { test_null_channels, "test_null_channels" },
         { test_list, "test_list" },
+        { test_list_poll, "test_list_poll" },
         { test_getc, "test_getc" },
         { test_putc, "test_putc" },
         { NULL, NULL }
@@ -0,0 +1,197 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct queue_t queue;
+static char queue_buf[128];
+
+static void input(const char *str_p)
+{
+    chan_write(&queue, str_p, strlen(str_p));
+}
+
+static int test_read(struct harness_t *harness_p)
+{
+    struct chan_reader_t reader;
+    char reader_buf[8];
+    char buf[32];
+
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(chan_reader_init(&reader,
+                              &queue,
+                              &reader_buf[0],
+                              sizeof(reader_buf)) == 0);
+
+    /* All available data that fits is read into the buffer. */
+    input("0123456789abcdefghij");
+    BTASSERT(chan_reader_getc(&reader) == '0');
+    BTASSERT(chan_reader_buffered(&reader) == 7);
+    BTASSERT(chan_size(&queue) == 12);
+
+    BTASSERT(chan_reader_read(&reader, &buf[0], 3) == 3);
+    BTASSERTM(&buf[0], "123", 3);
+
+    /* Partly buffered and partly read directly from the channel. */
+    BTASSERT(chan_reader_read(&reader, &buf[0], 12) == 12);
+    BTASSERTM(&buf[0], "456789abcdef", 12);
+    BTASSERT(chan_reader_buffered(&reader) == 0);
+
+    /* The reader is a channel. */
+    BTASSERT(chan_size(&reader) == 4);
+    BTASSERT(chan_read(&reader, &buf[0], 4) == 4);
+    BTASSERTM(&buf[0], "ghij", 4);
+    BTASSERT(chan_size(&reader) == 0);
+
+    return (0);
+}
+
+static int test_readline(struct harness_t *harness_p)
+{
+    struct chan_reader_t reader;
+    char reader_buf[16];
+    char *line_p;
+
+    BTASSERT(chan_reader_init(&reader,
+                              &queue,
+                              &reader_buf[0],
+                              sizeof(reader_buf)) == 0);
+
+    input("foo\nbar\r\n\n");
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 4);
+    BTASSERTM(line_p, "foo\n", 4);
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 5);
+    BTASSERTM(line_p, "bar\r\n", 5);
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 1);
+    BTASSERTM(line_p, "\n", 1);
+
+    /* A line split over several fills. */
+    input("hello");
+    input(" world\n");
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 12);
+    BTASSERTM(line_p, "hello world\n", 12);
+
+    /* Read until another delimiter. */
+    input("$GPGGA,1*47\r\n");
+    BTASSERT(chan_reader_read_until(&reader, ',', &line_p) == 7);
+    BTASSERTM(line_p, "$GPGGA,", 7);
+    BTASSERT(chan_reader_read_until(&reader, '*', &line_p) == 2);
+    BTASSERTM(line_p, "1*", 2);
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 4);
+    BTASSERTM(line_p, "47\r\n", 4);
+
+    /* Line too long for the buffer. Nothing is consumed. */
+    input("0123456789abcdefghij\n");
+    BTASSERT(chan_reader_readline(&reader, &line_p) == -ENOMEM);
+    BTASSERT(chan_reader_buffered(&reader) == 16);
+    BTASSERT(chan_reader_skip(&reader, 16) == 16);
+    BTASSERT(chan_reader_readline(&reader, &line_p) == 5);
+    BTASSERTM(line_p, "ghij\n", 5);
+    BTASSERT(chan_reader_buffered(&reader) == 0);
+
+    return (0);
+}
+
+static int test_peek_skip(struct harness_t *harness_p)
+{
+    struct chan_reader_t reader;
+    char reader_buf[8];
+    char *buf_p;
+
+    BTASSERT(chan_reader_init(&reader,
+                              &queue,
+                              &reader_buf[0],
+                              sizeof(reader_buf)) == 0);
+
+    input("abcdefghijklmnop");
+
+    /* Peek does not consume. */
+    BTASSERT(chan_reader_peek(&reader, &buf_p, 2) == 8);
+    BTASSERTM(buf_p, "abcdefgh", 8);
+    BTASSERT(chan_reader_getc(&reader) == 'a');
+
+    /* Peeking more than buffered moves the data to the beginning of
+       the buffer. */
+    BTASSERT(chan_reader_skip(&reader, 3) == 3);
+    BTASSERT(chan_reader_peek(&reader, &buf_p, 8) == 8);
+    BTASSERTM(buf_p, "efghijkl", 8);
+
+    /* Skip more than buffered. */
+    BTASSERT(chan_reader_skip(&reader, 10) == 10);
+    BTASSERT(chan_reader_getc(&reader) == 'o');
+    BTASSERT(chan_reader_getc(&reader) == 'p');
+    BTASSERT(chan_reader_buffered(&reader) == 0);
+    BTASSERT(chan_size(&queue) == 0);
+
+    return (0);
+}
+
+static int test_write_control(struct harness_t *harness_p)
+{
+    struct chan_reader_t reader;
+    char reader_buf[8];
+    char buf[4];
+
+    BTASSERT(chan_reader_init(&reader,
+                              &queue,
+                              &reader_buf[0],
+                              sizeof(reader_buf)) == 0);
+
+    /* Writes are forwarded to the underlying channel. */
+    BTASSERT(chan_write(&reader, "foo", 3) == 3);
+    BTASSERT(chan_size(&queue) == 3);
+    BTASSERT(chan_read(&reader, &buf[0], 3) == 3);
+    BTASSERTM(&buf[0], "foo", 3);
+
+    BTASSERT(chan_control(&reader, CHAN_CONTROL_NON_BLOCKING_READ) == 0);
+    BTASSERT(chan_reader_getc(&reader) == -EAGAIN);
+    BTASSERT(chan_control(&reader, CHAN_CONTROL_BLOCKING_READ) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_read, "test_read" },
+        { test_readline, "test_readline" },
+        { test_peek_skip, "test_peek_skip" },
+        { test_write_control, "test_write_control" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
@@ -0,0 +1,174 @@
+/**
+ * @section License
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2017, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct spsc_queue_t queue;
+static char queue_buf[8];
+static THRD_STACK(producer_stack, 1024);
+
+static void *producer_main(void *arg_p)
+{
+    char buf[16];
+    int i;
+    size_t n;
+
+    thrd_set_name("producer");
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+
+    /* Write in chunks as space becomes available. */
+    i = 0;
+
+    while (i < sizeof(buf)) {
+        n = spsc_queue_write(&queue, &buf[i], MIN(3, sizeof(buf) - i));
+        i += n;
+
+        if (n == 0) {
+            thrd_sleep_ms(1);
+        }
+    }
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_init(struct harness_t *harness_p)
+{
+    BTASSERT(spsc_queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(spsc_queue_size(&queue) == 0);
+    BTASSERT(spsc_queue_unused_size(&queue) == 8);
+
+    return (0);
+}
+
+static int test_write_read(struct harness_t *harness_p)
+{
+    char buf[8];
+    int i;
+
+    /* Write and read more than the buffer size, wrapping around. */
+    for (i = 0; i < 4; i++) {
+        BTASSERT(spsc_queue_write(&queue, "abcde", 5) == 5);
+        BTASSERT(spsc_queue_size(&queue) == 5);
+        BTASSERT(spsc_queue_unused_size(&queue) == 3);
+        BTASSERT(spsc_queue_read(&queue, &buf[0], 5) == 5);
+        BTASSERT(memcmp(&buf[0], "abcde", 5) == 0);
+    }
+
+    /* Data that does not fit is discarded. */
+    BTASSERT(spsc_queue_write(&queue, "0123456789", 10) == 8);
+    BTASSERT(spsc_queue_write(&queue, "a", 1) == 0);
+    BTASSERT(spsc_queue_size(&queue) == 8);
+    BTASSERT(spsc_queue_read(&queue, &buf[0], 8) == 8);
+    BTASSERT(memcmp(&buf[0], "01234567", 8) == 0);
+
+    /* Write from isr context. */
+    sys_lock();
+    BTASSERT(spsc_queue_write_isr(&queue, "xy", 2) == 2);
+    sys_unlock();
+    BTASSERT(chan_read(&queue, &buf[0], 2) == 2);
+    BTASSERT(memcmp(&buf[0], "xy", 2) == 0);
+
+    /* The channel interface. */
+    BTASSERT(chan_write(&queue, "z", 1) == 1);
+    BTASSERT(chan_size(&queue) == 1);
+    BTASSERT(chan_read(&queue, &buf[0], 1) == 1);
+    BTASSERT(buf[0] == 'z');
+
+    return (0);
+}
+
+static int test_blocking_read(struct harness_t *harness_p)
+{
+    char buf[16];
+    int i;
+
+    BTASSERT(thrd_spawn(producer_main,
+                        NULL,
+                        -1,
+                        producer_stack,
+                        sizeof(producer_stack)) != NULL);
+
+    /* More data than fits in the queue buffer. */
+    BTASSERT(spsc_queue_read(&queue, &buf[0], sizeof(buf)) == sizeof(buf));
+
+    for (i = 0; i < sizeof(buf); i++) {
+        BTASSERTI(buf[i], ==, i);
+    }
+
+    BTASSERT(spsc_queue_size(&queue) == 0);
+
+    return (0);
+}
+
+static int test_poll(struct harness_t *harness_p)
+{
+    struct chan_list_t list;
+    void *workspace[1];
+    struct time_t timeout;
+    char value;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+
+    BTASSERT(chan_list_init(&list, &workspace[0], sizeof(workspace)) == 0);
+    BTASSERT(chan_list_add(&list, &queue) == 0);
+    BTASSERT(chan_list_poll(&list, &timeout) == NULL);
+    BTASSERT(spsc_queue_write(&queue, "a", 1) == 1);
+    BTASSERT(chan_list_poll(&list, &timeout) == &queue);
+    BTASSERT(spsc_queue_read(&queue, &value, 1) == 1);
+    BTASSERT(chan_list_poll(&list, &timeout) == NULL);
+    BTASSERT(chan_list_destroy(&list) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_t harness;
+    struct harness_testcase_t harness_testcases[] = {
+        { test_init, "test_init" },
+        { test_write_read, "test_write_read" },
+        { test_blocking_read, "test_blocking_read" },
+        { test_poll, "test_poll" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_init(&harness);
+    harness_run(&harness, harness_testcases);
+
+    return (0);
+}
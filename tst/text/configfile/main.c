@@ -470,6 +470,168 @@ static int test_get_complex(struct harness_t *harness_p)
     return (0);
 }         
 
+static int test_index(struct harness_t *harness_p)
+{
+    struct configfile_t configfile;
+    struct configfile_property_t properties[8];
+    char buf[] =
+        "; last modified 1 April 2001 by John Doe\n"
+        "[owner]\n"
+        "name = John Doe\n"
+        "organization: Acme Widgets Inc.\r\n"
+        "\n"
+        "[database]\n"
+        "; use IP address in case network name resolution is not working\n"
+        "server = 192.0.2.62\n"
+        "port = 143\n"
+        "ratio = -0.5\n"
+        "port = 144\n"
+        "malformed\n"
+        "[owner]\n"
+        "phone = 555\n"
+        "ignored = no newline";
+    char value[32];
+    long long_value;
+    float float_value;
+
+    BTASSERT(configfile_init(&configfile, buf, sizeof(buf)) == 0);
+    BTASSERTI(configfile_index(&configfile,
+                               &properties[0],
+                               membersof(properties)), ==, 7);
+
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "name",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "John Doe") == 0);
+
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "organization",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "Acme Widgets Inc.") == 0);
+
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "phone",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "555") == 0);
+
+    /* The first of duplicated properties is used. */
+    BTASSERT(configfile_get_long(&configfile,
+                                 "database",
+                                 "port",
+                                 &long_value) == 0);
+    BTASSERT(long_value == 143);
+
+    BTASSERT(configfile_get_float(&configfile,
+                                  "database",
+                                  "ratio",
+                                  &float_value) == 0);
+    BTASSERT(float_value == -0.5f);
+
+    BTASSERT(configfile_get_long(&configfile,
+                                 "database",
+                                 "server",
+                                 &long_value) == -1);
+
+    /* Missing properties. */
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "server",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "database",
+                            "malformed",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "ignored",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get_long(&configfile,
+                                 "clothes",
+                                 "skirt",
+                                 &long_value) == -1);
+
+    /* Value too long. */
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "phone",
+                            &value[0],
+                            3) == NULL);
+
+    return (0);
+}
+
+static int test_index_iterate(struct harness_t *harness_p)
+{
+    struct configfile_t configfile;
+    struct configfile_property_t properties[8];
+    struct configfile_property_t *property_p;
+    char buf[] =
+        "[a]\n"
+        "x = 1\n"
+        "[b]\n"
+        "y = 2\n"
+        "[a]\n"
+        "z = 3\n";
+
+    BTASSERT(configfile_init(&configfile, buf, sizeof(buf)) == 0);
+    BTASSERTI(configfile_index(&configfile,
+                               &properties[0],
+                               membersof(properties)), ==, 3);
+
+    /* Both sections named 'a' are iterated. */
+    property_p = configfile_get_next(&configfile, "a", NULL);
+    BTASSERT(property_p != NULL);
+    BTASSERT(strcmp(property_p->name_p, "x") == 0);
+    BTASSERT(strcmp(property_p->value_p, "1") == 0);
+    property_p = configfile_get_next(&configfile, "a", property_p);
+    BTASSERT(property_p != NULL);
+    BTASSERT(strcmp(property_p->name_p, "z") == 0);
+    BTASSERT(strcmp(property_p->value_p, "3") == 0);
+    BTASSERT(configfile_get_next(&configfile, "a", property_p) == NULL);
+
+    property_p = configfile_get_next(&configfile, "b", NULL);
+    BTASSERT(property_p != NULL);
+    BTASSERT(strcmp(property_p->name_p, "y") == 0);
+    BTASSERT(configfile_get_next(&configfile, "b", property_p) == NULL);
+
+    BTASSERT(configfile_get_next(&configfile, "c", NULL) == NULL);
+
+    return (0);
+}
+
+static int test_index_full(struct harness_t *harness_p)
+{
+    struct configfile_t configfile;
+    struct configfile_property_t properties[2];
+    char buf[] =
+        "[a]\n"
+        "x = 1\n"
+        "y = 2\n"
+        "z = 3\n";
+    long value;
+
+    BTASSERT(configfile_init(&configfile, buf, sizeof(buf)) == 0);
+    BTASSERTI(configfile_index(&configfile,
+                               &properties[0],
+                               membersof(properties)), ==, -ENOMEM);
+
+    /* Only the first properties are indexed. */
+    BTASSERT(configfile_get_long(&configfile, "a", "y", &value) == 0);
+    BTASSERT(value == 2);
+    BTASSERT(configfile_get_long(&configfile, "a", "z", &value) == -1);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_t harness;
@@ -487,6 +649,9 @@ int main()
         { test_get_value_too_long, "test_get_value_too_long" },
         { test_get_complex, "test_get_complex" },
         { test_set, "test_set" },
+        { test_index, "test_index" },
+        { test_index_iterate, "test_index_iterate" },
+        { test_index_full, "test_index_full" },
         { NULL, NULL }
     };
 
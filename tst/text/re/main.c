@@ -357,6 +357,85 @@ int test_complex(struct harness_t *harness_p)
     return (0);
 }
 
+int test_automaton(struct harness_t *harness_p)
+{
+    struct {
+        const char *pattern_p;
+        char flags;
+        const char *buf_p;
+        ssize_t res;
+    } datas[] = {
+        { "foo", 0, "foobar", 3 },
+        { "foo", 0, "fob", -1 },
+        { "a*ab?", 0, "aab", 3 },
+        { "a?a?a?aaa", 0, "aaaa", 4 },
+        { "[ab]*b", 0, "abab", 4 },
+        { "[ab]*b", 0, "aaaa", -1 },
+        { "\\d+\\.?\\d*", 0, "3.14,", 4 },
+        { "\\w+\\s*=\\s*\\d{2}", 0, "foo_1 = 42;", 10 },
+        {
+            "\\$GP[A-Z]{3},\\d*\\.?\\d*,",
+            0,
+            "$GPGGA,123519.00,4807.038,N",
+            17
+        },
+        { "\\$GP[A-Z]{3},\\d*\\.?\\d*,", 0, "$GPGGA;123519", -1 },
+        { "\\$GP[A-Z]{3},\\d*\\.?\\d*,", 0, "$GNRMC,1,", -1 },
+        { ".*GGA", 0, "$GPGGA,1", 6 },
+        { ".*GGA", 0, "$GPRMC,1", -1 },
+        { "a.b", 0, "a\nb", -1 },
+        { "a.b", RE_DOTALL, "a\nb", 3 },
+        { "FOO[a-z]+", RE_IGNORECASE, "fooBAR1", 6 },
+        { "x*", 0, "", 0 },
+        { "x*y?", 0, "z", 0 }
+    };
+    char re_interpreter[64];
+    char re[512];
+    size_t size;
+    int i;
+
+    /* The automaton does not fit in the small buffer, so the same
+       pattern is matched by both engines. */
+    for (i = 0; i < membersof(datas); i++) {
+        size = strlen(datas[i].buf_p);
+        BTASSERT(re_compile(re_interpreter,
+                            datas[i].pattern_p,
+                            datas[i].flags,
+                            sizeof(re_interpreter)) != NULL);
+        BTASSERT(re_compile(re,
+                            datas[i].pattern_p,
+                            datas[i].flags,
+                            sizeof(re)) != NULL);
+        BTASSERT(re_match(re_interpreter,
+                          datas[i].buf_p,
+                          size,
+                          NULL,
+                          NULL) == datas[i].res, "%d", i);
+        BTASSERT(re_match(re,
+                          datas[i].buf_p,
+                          size,
+                          NULL,
+                          NULL) == datas[i].res, "%d", i);
+    }
+
+    /* Non-greedy repetitions are left to the interpreter. */
+    BTASSERT(re_compile(re, "<.*?>", 0, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, "<p>foo</p>", 10, NULL, NULL) == 3);
+
+    /* Exponential time for the backtracking interpreter, linear time
+       for the automaton. */
+    BTASSERT(re_compile(re, "a*a*a*a*a*a*a*a*a*a*a*a*b", 0, sizeof(re))
+             != NULL);
+    BTASSERT(re_match(re,
+                      "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+                      50,
+                      NULL,
+                      NULL) == -1);
+    BTASSERT(re_match(re, "aaab", 4, NULL, NULL) == 4);
+
+    return (0);
+}
+
 int test_compile(struct harness_t *harness_p)
 {
     char re[64];
@@ -395,6 +474,7 @@ int main()
         { test_alternatives, "test_alternatives" },
         { test_greed, "test_greed" },
         { test_complex, "test_complex" },
+        { test_automaton, "test_automaton" },
         { test_compile, "test_compile" },
         { NULL, NULL }
     };
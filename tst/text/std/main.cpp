@@ -157,6 +157,113 @@ static int test_snprintf(struct harness_t *harness_p)
     return (0);
 }
 
+static int test_sprintf_long_spans(struct harness_t *harness_p)
+{
+    char buf[256];
+    struct queue_t queue;
+    uint8_t queue_buf[256];
+    char literal[101];
+
+    /* Padding wider than the internal padding strings. */
+    BTASSERT(std_sprintf(buf, FSTR("%40d|"), -12) == 41);
+    BTASSERT(strcmp(buf, "                                     -12|") == 0);
+    BTASSERT(std_sprintf(buf, FSTR("%040d|"), -12) == 41);
+    BTASSERT(strcmp(buf, "-000000000000000000000000000000000000012|") == 0);
+    BTASSERT(std_sprintf(buf, FSTR("|%-20s|"), "foo") == 22);
+    BTASSERT(strcmp(buf, "|foo                 |") == 0);
+
+    /* Digit pairs. */
+    BTASSERT(std_sprintf(buf, FSTR("%d %d %d %d %u"),
+                         0, 9, 10, 99, 1234567) == 17);
+    BTASSERT(strcmp(buf, "0 9 10 99 1234567") == 0);
+    BTASSERT(std_sprintf(buf, FSTR("%ld %ld"), 100L, -2147483647L) == 15);
+    BTASSERT(strcmp(buf, "100 -2147483647") == 0);
+
+    /* A literal span longer than the output buffer is written
+       directly to the channel. */
+    memset(&literal[0], 'a', sizeof(literal) - 1);
+    literal[sizeof(literal) - 1] = '\0';
+    queue_init(&queue, &queue_buf[0], sizeof(queue_buf));
+    BTASSERT(std_fprintf(&queue, FSTR("%d%s%d"), 1, &literal[0], 2) == 102);
+    BTASSERT(queue_read(&queue, &buf[0], 102) == 102);
+    BTASSERTM(&buf[0], "1aaaaaaaaa", 10);
+    BTASSERTM(&buf[1], &literal[0], 100);
+    BTASSERT(buf[101] == '2');
+
+    /* Truncated spans. */
+    memset(buf, -1, sizeof(buf));
+    BTASSERT(std_snprintf(buf, 6, FSTR("foo%sbar"), "fie") == 9);
+    BTASSERTM(&buf[0], "foofie\xff", 7);
+
+    return (0);
+}
+
+static int test_format(struct harness_t *harness_p)
+{
+    struct std_format_t format;
+    struct std_format_item_t items[4];
+    char buf[128];
+    struct queue_t queue;
+    uint8_t queue_buf[64];
+
+    /* Conversions and a trailing literal. */
+    BTASSERT(std_format_init(&format,
+                             &items[0],
+                             membersof(items),
+                             FSTR("t=%lu %-4s: %03d\r\n")) == 0);
+    BTASSERT(format.length == 4);
+    BTASSERT(std_format_sprintf(&format, buf, 1234L, "foo", 7) == 18);
+    BTASSERT(strcmp(buf, "t=1234 foo : 007\r\n") == 0);
+
+    memset(buf, -1, sizeof(buf));
+    BTASSERT(std_format_snprintf(&format, buf, 5, 1234L, "foo", 7) == 18);
+    BTASSERTM(&buf[0], "t=123\xff", 6);
+
+    queue_init(&queue, &queue_buf[0], sizeof(queue_buf));
+    BTASSERT(std_format_fprintf(&format, &queue, 5L, "ab", -1) == 15);
+    BTASSERT(queue_read(&queue, &buf[0], 15) == 15);
+    BTASSERTM(&buf[0], "t=5 ab  : -01\r\n", 15);
+
+    /* No trailing literal. */
+    BTASSERT(std_format_init(&format,
+                             &items[0],
+                             membersof(items),
+                             FSTR("%x")) == 0);
+    BTASSERT(format.length == 1);
+    BTASSERT(std_format_sprintf(&format, buf, 0xbeef) == 4);
+    BTASSERT(strcmp(buf, "beef") == 0);
+
+    /* Only a literal. */
+    BTASSERT(std_format_init(&format,
+                             &items[0],
+                             membersof(items),
+                             FSTR("foo")) == 0);
+    BTASSERT(format.length == 1);
+    BTASSERT(std_format_sprintf(&format, buf) == 3);
+    BTASSERT(strcmp(buf, "foo") == 0);
+
+    /* Empty format string. */
+    BTASSERT(std_format_init(&format,
+                             &items[0],
+                             membersof(items),
+                             FSTR("")) == 0);
+    BTASSERT(format.length == 0);
+    BTASSERT(std_format_sprintf(&format, buf) == 0);
+    BTASSERT(strcmp(buf, "") == 0);
+
+    /* Too many conversions. */
+    BTASSERT(std_format_init(&format,
+                             &items[0],
+                             membersof(items),
+                             FSTR("%d%d%d%d")) == 0);
+    BTASSERT(std_format_init(&format,
+                             &items[0],
+                             membersof(items),
+                             FSTR("%d%d%d%d.")) == -ENOMEM);
+
+    return (0);
+}
+
 static int test_vprintf(struct harness_t *harness_p)
 {
     BTASSERT(test_vprintf_wrapper(FSTR("vprintf: %i\r\n"), 1) == 12);
@@ -698,6 +805,8 @@ int main()
     struct harness_testcase_t harness_testcases[] = {
         { test_sprintf, "test_sprintf" },
         { test_snprintf, "test_snprintf" },
+        { test_sprintf_long_spans, "test_sprintf_long_spans" },
+        { test_format, "test_format" },
         { test_vprintf, "test_vprintf" },
         { test_vfprintf, "test_vfprintf" },
         { test_strtol, "test_strtol" },